@@ -127,6 +127,42 @@ const char FAPP_COMMAND_RELEASE [] = "release";
 #define FAPP_SAVE_STR           "Parameters saved"
 #define FAPP_SAVE_FAILED_STR    "Parameters saving failed!"
 #define FAPP_BOOT_STR           "Press any key to stop (%s): %3d"
+#define FAPP_ROUTE_HEADER       " Destination     Netmask         Gateway         Iface  MTU   Metric Type"
+#define FAPP_ROUTE_FORMAT       " %-15s %-15s %-15s %-6s %-5u %-6u %s"
+#define FAPP_ROUTE_ERR          "Error: Route is not changed!"
+#define FAPP_ARP_HEADER         " IP address      MAC address        Type"
+#define FAPP_ARP_FORMAT         " %-15s %-18s %s"
+#define FAPP_ARP_ERR            "Error: ARP cache is not changed!"
+#define FAPP_NETSTAT_GROUP_FORMAT   "%s:"
+#define FAPP_NETSTAT_FORMAT         "  %-18s : %u"
+#define FAPP_SOCKETS_HEADER         " Sock Type Local address:port / Foreign address:port  State"
+#define FAPP_SOCKETS_FORMAT         " %-4d %-4s %s:%u / %s:%u  %s"
+#define FAPP_SOCKETS_TCP_FORMAT_1   "           rtt %u/%u ms, rto %u ms, cwnd %u, ssthresh %u, wnd %u/%u, mss %u/%u"
+#define FAPP_SOCKETS_TCP_FORMAT_2   "           unacked %u, retr %u, fast retr %u, dupack %u, ooo %u, sndbuf %u/%u, rcvbuf %u/%u"
+#define FAPP_TRACE_MASK_FORMAT      "Trace mask: 0x%08X"
+#define FAPP_TRACE_FORMAT           "%10u %-5s %-4s len %-5u flow %08X seq %08X ack %08X info %08X"
+#define FAPP_TRACE_HEX_FORMAT       "%08X %02X%02X%04X %08X %08X %08X %08X"
+#define FAPP_CAPTURE_FORMAT         " %-18s : %u"
+#define FAPP_LATENCY_HEADER         " Stage      Samples    p50, us    p99, us    max, us"
+#define FAPP_LATENCY_FORMAT         " %-10s %7u %8u.%u %8u.%u %8u.%u"
+#define FAPP_LOCKS_HEADER           " Call site              Locks  Hold, us   Max, us Bottom, us  Waits  Wait, us"
+#define FAPP_LOCKS_FORMAT           " %-20s %7u %9u %7u.%u %10u %6u %9u"
+#define FAPP_HEAP_HEADER            " Pool        Used HighWater     Free  Largest  Blocks"
+#define FAPP_HEAP_FORMAT            " %-7s %8u %9u %8u %8u %7u"
+#define FAPP_HEAP_BUCKET_FORMAT     "   %7u - %-7u : %u"
+#define FAPP_HEAP_SITES_HEADER      " Call site            Pool       Live     Peak   Allocs    Frees  Fails Rate/s"
+#define FAPP_HEAP_SITES_FORMAT      " %-20s %-6s %8u %8u %8u %8u %6u %6u"
+#define FAPP_UBENCH_INFO            "#ubench,fnet=%s,cpu=%s,cycles_per_us=%u"
+#define FAPP_UBENCH_HEADER          "#ubench,name,variant,n,iterations,min_cycles,avg_cycles,max_cycles,avg_ns"
+#define FAPP_UBENCH_FORMAT          "ubench,%s,%s,%u,%u,%u,%u,%u,%u"
+
+/* FNET_CFG_LATENCY_CYCLES counts to microseconds, with one decimal place.*/
+#define FAPP_CYCLES_US(cycles)      ((cycles) / FNET_CFG_LATENCY_CYCLES_PER_US), \
+                                    ((((cycles) % FNET_CFG_LATENCY_CYCLES_PER_US) * 10) / FNET_CFG_LATENCY_CYCLES_PER_US)
+
+/* FNET_CFG_LATENCY_CYCLES counts to nanoseconds. Divided first, not to overflow 32 bits.*/
+#define FAPP_CYCLES_NS(cycles)      (((cycles) / FNET_CFG_LATENCY_CYCLES_PER_US) * 1000 \
+                                    + ((((cycles) % FNET_CFG_LATENCY_CYCLES_PER_US) * 1000) / FNET_CFG_LATENCY_CYCLES_PER_US))
 
 #define FAPP_PARAMS_LOAD_STR    "\n\nParameters loaded from Flash.\n"
 
@@ -150,6 +186,9 @@ static void fapp_go (fnet_shell_desc_t desc, unsigned long address);
 #if FAPP_CFG_REINIT_CMD 
 void fapp_reinit_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
 #endif
+#if FAPP_CFG_UBENCH_CMD && FNET_CFG_UBENCH
+static void fapp_ubench_print( const struct fnet_ubench_result *result, void *cookie );
+#endif
 #if FAPP_CFG_DEBUG_CMD 
 void fapp_debug_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
 #endif
@@ -173,6 +212,36 @@ const struct fnet_shell_command fapp_cmd_table [] =
 #if FAPP_CFG_INFO_CMD
     { FNET_SHELL_CMD_TYPE_NORMAL, "info",       0, 0, (void *)fapp_info_cmd,    "Show detailed status", ""},
 #endif
+#if FAPP_CFG_ROUTE_CMD && FNET_CFG_IP4
+    { FNET_SHELL_CMD_TYPE_NORMAL, "route",      0, 6, (void *)fapp_route_cmd,   "Show/change IPv4 routing table", "[add <net> <mask> <gateway> [<mtu> [<metric>]]|del <net> <mask> [<gateway>]]"},
+#endif
+#if FAPP_CFG_ARP_CMD && FNET_CFG_IP4
+    { FNET_SHELL_CMD_TYPE_NORMAL, "arp",        0, 3, (void *)fapp_arp_cmd,     "Show/change ARP cache", "[add <ip> <mac>|del <ip>]"},
+#endif
+#if FAPP_CFG_NETSTAT_CMD && FNET_CFG_STATS
+    { FNET_SHELL_CMD_TYPE_NORMAL, "netstat",    0, 1, (void *)fapp_netstat_cmd, "Show/clear protocol statistics", "[-s|-z]"},
+#endif
+#if FAPP_CFG_SOCKETS_CMD
+    { FNET_SHELL_CMD_TYPE_NORMAL, "sockets",    0, 0, (void *)fapp_sockets_cmd, "List sockets", ""},
+#endif
+#if FAPP_CFG_TRACE_CMD && FNET_CFG_TRACE
+    { FNET_SHELL_CMD_TYPE_NORMAL, "trace",      0, 2, (void *)fapp_trace_cmd,   "Control/dump the packet trace", "[on [0x<mask>]|off|clear|dump|hex|pcapng]"},
+#endif
+#if FAPP_CFG_CAPTURE_CMD && FNET_CFG_CAPTURE
+    { FNET_SHELL_CMD_TYPE_NORMAL, "capture",    0, 9, (void *)fapp_capture_cmd, "Control the frame capture", "[on [type <n>][proto <n>][port <n>][host <ip>]\n\r\t|off|clear]"},
+#endif
+#if FAPP_CFG_LATENCY_CMD && FNET_CFG_LATENCY
+    { FNET_SHELL_CMD_TYPE_NORMAL, "latency",    0, 1, (void *)fapp_latency_cmd, "Show/clear the latency histograms", "[clear]"},
+#endif
+#if FAPP_CFG_LOCKS_CMD && FNET_CFG_LOCK_PROFILE
+    { FNET_SHELL_CMD_TYPE_NORMAL, "locks",      0, 1, (void *)fapp_locks_cmd,   "Show/clear the lock profile", "[hold|max|bottom|wait|clear]"},
+#endif
+#if FAPP_CFG_HEAP_CMD
+    { FNET_SHELL_CMD_TYPE_NORMAL, "heap",       0, 1, (void *)fapp_heap_cmd,    "Show/clear the heap profile", "[live|peak|allocs|clear]"},
+#endif
+#if FAPP_CFG_UBENCH_CMD && FNET_CFG_UBENCH
+    { FNET_SHELL_CMD_TYPE_NORMAL, "ubench",     0, 7, (void *)fapp_ubench_cmd,  "Run the micro-benchmarks", "[all|<name>] [iter <n>] [n <n>] [size <n>]"},
+#endif
 #if FAPP_CFG_DHCP_CMD && FNET_CFG_DHCP && FNET_CFG_IP4
     { FNET_SHELL_CMD_TYPE_NORMAL, "dhcp",       0, 1, (void *)fapp_dhcp_cmd,    "Start DHCP client", "[release]"},
 #endif
@@ -216,8 +285,8 @@ const struct fnet_shell_command fapp_cmd_table [] =
     { FNET_SHELL_CMD_TYPE_NORMAL, "reboot",     0, 0, (void *)fapp_reset_cmd,   "Reset the board", ""},
 #endif  
 #if FAPP_CFG_BENCH_CMD   
-    { FNET_SHELL_CMD_TYPE_NORMAL, "benchrx",    0, 2, (void *)fapp_benchrx_cmd, "Receiver Benchmark", "[tcp|udp [multicast ip]"},
-    { FNET_SHELL_CMD_TYPE_NORMAL, "benchtx",    1, 5, (void *)fapp_benchtx_cmd, "Transmitter Benchmark", "<remote ip>[tcp|udp[<message size>\r\n\t[<number of messages>[<number of iterations>]]]"},
+    { FNET_SHELL_CMD_TYPE_NORMAL, "benchrx",    0, 7, (void *)fapp_benchrx_cmd, "Receiver Benchmark", "[tcp|udp [<multicast ip>]|rr]\r\n\t[sndbuf <size>] [rcvbuf <size>] [csv]"},
+    { FNET_SHELL_CMD_TYPE_NORMAL, "benchtx",    1, 14, (void *)fapp_benchtx_cmd, "Transmitter Benchmark", "<remote ip>[tcp|udp|rr|crr[<message size>\r\n\t[<number of messages>[<number of iterations>]]]]\r\n\t[streams <n>] [response <size>] [sndbuf <size>] [rcvbuf <size>] [csv]"},
 #endif
 #if FAPP_CFG_REINIT_CMD   /* Used to test FNET release/init only. */
     { FNET_SHELL_CMD_TYPE_NORMAL, "reinit",     0, 0, (void *)fapp_reinit_cmd,  "Reinit application", ""},
@@ -673,6 +742,12 @@ void fapp_info_print( fnet_shell_desc_t desc )
     {
         fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "TX Packets", statistics.tx_packet);
         fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "RX Packets", statistics.rx_packet);
+        if(statistics.rx_irq)
+        {
+            fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "RX Interrupts", statistics.rx_irq);
+            fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "RX Polls", statistics.rx_poll);
+            fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "RX Budget Exhausted", statistics.rx_budget_exhausted);
+        }
     }
     
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Free Heap", fnet_free_mem_status());
@@ -719,6 +794,843 @@ void fapp_info_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
 }
 #endif
 
+/************************************************************************
+* NAME: fapp_route_cmd
+*
+* DESCRIPTION: Shows or changes the IPv4 routing table.
+************************************************************************/
+#if FAPP_CFG_ROUTE_CMD && FNET_CFG_IP4
+void fapp_route_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    fnet_netif_ip4_route_info_t route_info;
+    fnet_ip4_addr_t             net;
+    fnet_ip4_addr_t             netmask;
+    fnet_ip4_addr_t             gateway = INADDR_ANY;
+    unsigned long               mtu = 0;
+    unsigned long               metric = 0;
+    char                        net_str[FNET_IP4_ADDR_STR_SIZE];
+    char                        netmask_str[FNET_IP4_ADDR_STR_SIZE];
+    char                        gateway_str[FNET_IP4_ADDR_STR_SIZE];
+    char                        name[FNET_NETIF_NAMELEN];
+    char                        *p;
+    int                         i;
+    unsigned int                n;
+
+    if(argc == 1) /* Print the routing table.*/
+    {
+        fnet_shell_println(desc, FAPP_ROUTE_HEADER);
+
+        for(n = 0; fnet_netif_get_ip4_route(n, &route_info) == FNET_TRUE; n++)
+        {
+            fnet_inet_ntoa(*(struct in_addr *)(&route_info.net), net_str);
+            fnet_inet_ntoa(*(struct in_addr *)(&route_info.netmask), netmask_str);
+            fnet_inet_ntoa(*(struct in_addr *)(&route_info.gateway), gateway_str);
+            fnet_netif_get_name(route_info.netif, name, FNET_NETIF_NAMELEN);
+
+            fnet_shell_println(desc, FAPP_ROUTE_FORMAT, net_str, netmask_str, 
+                               (route_info.gateway == INADDR_ANY) ? "on-link" : gateway_str, 
+                               name, route_info.mtu, route_info.metric, 
+                               (route_info.type == FNET_NETIF_IP4_ROUTE_TYPE_STATIC) ? "static" : "connected");
+        }
+        return;
+    }
+
+    if(argc < 4)
+        goto ERROR_PARAM;
+
+    /* Network and netmask.*/
+    if(fnet_inet_aton(argv[2], (struct in_addr *)&net) == FNET_ERR)
+    {
+        i = 2;
+        goto ERROR_PARAM_I;
+    }
+
+    if(fnet_inet_aton(argv[3], (struct in_addr *)&netmask) == FNET_ERR)
+    {
+        i = 3;
+        goto ERROR_PARAM_I;
+    }
+
+    if((argc > 4) && (fnet_inet_aton(argv[4], (struct in_addr *)&gateway) == FNET_ERR))
+    {
+        i = 4;
+        goto ERROR_PARAM_I;
+    }
+
+    if(fnet_strcasecmp(argv[1], "add") == 0)
+    {
+        if(argc < 5)
+            goto ERROR_PARAM;
+
+        if(argc > 5)
+        {
+            mtu = fnet_strtoul(argv[5], &p, 0);
+            if(p == argv[5])
+            {
+                i = 5;
+                goto ERROR_PARAM_I;
+            }
+        }
+
+        if(argc > 6)
+        {
+            metric = fnet_strtoul(argv[6], &p, 0);
+            if(p == argv[6])
+            {
+                i = 6;
+                goto ERROR_PARAM_I;
+            }
+        }
+
+        if(fnet_netif_add_ip4_route(FNET_NULL, net, netmask, gateway, mtu, metric) == FNET_ERR)
+            fnet_shell_println(desc, FAPP_ROUTE_ERR);
+    }
+    else if((fnet_strcasecmp(argv[1], "del") == 0) && (argc < 6))
+    {
+        if(fnet_netif_del_ip4_route(net, netmask, gateway) == FNET_ERR)
+            fnet_shell_println(desc, FAPP_ROUTE_ERR);
+    }
+    else
+    {
+        goto ERROR_PARAM;
+    }
+
+    return;
+
+ERROR_PARAM_I:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[i]);
+    return;
+
+ERROR_PARAM:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_arp_cmd
+*
+* DESCRIPTION: Shows or changes the ARP cache of the default interface.
+************************************************************************/
+#if FAPP_CFG_ARP_CMD && FNET_CFG_IP4
+void fapp_arp_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    fnet_netif_ip4_arp_info_t   arp_info;
+    fnet_ip4_addr_t             ipaddr;
+    fnet_mac_addr_t             macaddr;
+    char                        ip_str[FNET_IP4_ADDR_STR_SIZE];
+    char                        mac_str[FNET_MAC_ADDR_STR_SIZE];
+    unsigned int                n;
+
+    if(argc == 1) /* Print the ARP cache.*/
+    {
+        fnet_shell_println(desc, FAPP_ARP_HEADER);
+
+        for(n = 0; fnet_netif_get_ip4_arp_entry(fapp_default_netif, n, &arp_info) == FNET_TRUE; n++)
+        {
+            fnet_inet_ntoa(*(struct in_addr *)(&arp_info.ip4_addr), ip_str);
+            fnet_mac_to_str(arp_info.hw_addr, mac_str);
+
+            fnet_shell_println(desc, FAPP_ARP_FORMAT, ip_str, mac_str, 
+                               (arp_info.is_static == FNET_TRUE) ? "static" : "dynamic");
+        }
+        return;
+    }
+
+    if((argc < 3) || (fnet_inet_aton(argv[2], (struct in_addr *)&ipaddr) == FNET_ERR))
+        goto ERROR_PARAM;
+
+    if((fnet_strcasecmp(argv[1], "add") == 0) && (argc == 4))
+    {
+        if(fnet_str_to_mac(argv[3], macaddr) == FNET_ERR)
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[3]);
+            return;
+        }
+
+        if(fnet_netif_add_ip4_arp_entry(fapp_default_netif, ipaddr, macaddr) == FNET_ERR)
+            fnet_shell_println(desc, FAPP_ARP_ERR);
+    }
+    else if((fnet_strcasecmp(argv[1], "del") == 0) && (argc == 3))
+    {
+        if(fnet_netif_del_ip4_arp_entry(fapp_default_netif, ipaddr) == FNET_ERR)
+            fnet_shell_println(desc, FAPP_ARP_ERR);
+    }
+    else
+    {
+        goto ERROR_PARAM;
+    }
+
+    return;
+
+ERROR_PARAM:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+}
+#endif
+
+#if FAPP_NETSTAT
+/* Protocol statistics names (RFC1213/RFC4293 style).*/
+#define FAPP_NETSTAT_OFFSET(field)          ((unsigned short)(unsigned long)&(((struct fnet_stats *)0)->field))
+#define FAPP_NETSTAT_COUNTER(name, field)   {name, FAPP_NETSTAT_OFFSET(field)}
+#define FAPP_NETSTAT_IP(group, ip)  \
+    {group, FAPP_NETSTAT_GROUP}, \
+    FAPP_NETSTAT_COUNTER("InReceives", ip.in_receives), \
+    FAPP_NETSTAT_COUNTER("InHdrErrors", ip.in_hdr_errors), \
+    FAPP_NETSTAT_COUNTER("InAddrErrors", ip.in_addr_errors), \
+    FAPP_NETSTAT_COUNTER("InUnknownProtos", ip.in_unknown_protos), \
+    FAPP_NETSTAT_COUNTER("InDiscards", ip.in_discards), \
+    FAPP_NETSTAT_COUNTER("InDelivers", ip.in_delivers), \
+    FAPP_NETSTAT_COUNTER("ForwDatagrams", ip.forw_datagrams), \
+    FAPP_NETSTAT_COUNTER("OutRequests", ip.out_requests), \
+    FAPP_NETSTAT_COUNTER("OutDiscards", ip.out_discards), \
+    FAPP_NETSTAT_COUNTER("OutNoRoutes", ip.out_no_routes), \
+    FAPP_NETSTAT_COUNTER("ReasmReqds", ip.reasm_reqds), \
+    FAPP_NETSTAT_COUNTER("ReasmOKs", ip.reasm_oks), \
+    FAPP_NETSTAT_COUNTER("ReasmFails", ip.reasm_fails), \
+    FAPP_NETSTAT_COUNTER("ReasmTimeouts", ip.reasm_timeouts), \
+    FAPP_NETSTAT_COUNTER("FragOKs", ip.frag_oks), \
+    FAPP_NETSTAT_COUNTER("FragFails", ip.frag_fails), \
+    FAPP_NETSTAT_COUNTER("FragCreates", ip.frag_creates)
+#define FAPP_NETSTAT_ICMP(group, icmp)  \
+    {group, FAPP_NETSTAT_GROUP}, \
+    FAPP_NETSTAT_COUNTER("InMsgs", icmp.in_msgs), \
+    FAPP_NETSTAT_COUNTER("InErrors", icmp.in_errors), \
+    FAPP_NETSTAT_COUNTER("InDestUnreachs", icmp.in_dest_unreachs), \
+    FAPP_NETSTAT_COUNTER("InEchos", icmp.in_echos), \
+    FAPP_NETSTAT_COUNTER("OutMsgs", icmp.out_msgs), \
+    FAPP_NETSTAT_COUNTER("OutDestUnreachs", icmp.out_dest_unreachs), \
+    FAPP_NETSTAT_COUNTER("OutEchoReps", icmp.out_echo_reps)
+
+const struct fapp_netstat_entry fapp_netstat_table[] =
+{
+    {"eth", FAPP_NETSTAT_GROUP},
+    FAPP_NETSTAT_COUNTER("InFrames", eth.in_frames),
+    FAPP_NETSTAT_COUNTER("InDiscards", eth.in_discards),
+    FAPP_NETSTAT_COUNTER("OutFrames", eth.out_frames),
+    FAPP_NETSTAT_COUNTER("OutDiscards", eth.out_discards),
+#if FNET_CFG_IP4
+    {"arp", FAPP_NETSTAT_GROUP},
+    FAPP_NETSTAT_COUNTER("InRequests", arp.in_requests),
+    FAPP_NETSTAT_COUNTER("InReplies", arp.in_replies),
+    FAPP_NETSTAT_COUNTER("OutRequests", arp.out_requests),
+    FAPP_NETSTAT_COUNTER("OutReplies", arp.out_replies),
+    FAPP_NETSTAT_COUNTER("Misses", arp.misses),
+    FAPP_NETSTAT_COUNTER("Drops", arp.drops),
+    FAPP_NETSTAT_IP("ip", ip),
+    FAPP_NETSTAT_ICMP("icmp", icmp),
+#endif
+#if FNET_CFG_IP6
+    FAPP_NETSTAT_IP("ip6", ip6),
+    FAPP_NETSTAT_ICMP("icmp6", icmp6),
+#endif
+#if FNET_CFG_UDP
+    {"udp", FAPP_NETSTAT_GROUP},
+    FAPP_NETSTAT_COUNTER("InDatagrams", udp.in_datagrams),
+    FAPP_NETSTAT_COUNTER("NoPorts", udp.no_ports),
+    FAPP_NETSTAT_COUNTER("InErrors", udp.in_errors),
+    FAPP_NETSTAT_COUNTER("OutDatagrams", udp.out_datagrams),
+#endif
+#if FNET_CFG_TCP
+    {"tcp", FAPP_NETSTAT_GROUP},
+    FAPP_NETSTAT_COUNTER("ActiveOpens", tcp.active_opens),
+    FAPP_NETSTAT_COUNTER("PassiveOpens", tcp.passive_opens),
+    FAPP_NETSTAT_COUNTER("AttemptFails", tcp.attempt_fails),
+    FAPP_NETSTAT_COUNTER("EstabResets", tcp.estab_resets),
+    FAPP_NETSTAT_COUNTER("InSegs", tcp.in_segs),
+    FAPP_NETSTAT_COUNTER("InErrs", tcp.in_errs),
+    FAPP_NETSTAT_COUNTER("OutSegs", tcp.out_segs),
+    FAPP_NETSTAT_COUNTER("RetransSegs", tcp.retrans_segs),
+    FAPP_NETSTAT_COUNTER("OutRsts", tcp.out_rsts),
+#endif
+    {"mem", FAPP_NETSTAT_GROUP},
+    FAPP_NETSTAT_COUNTER("NetbufFails", mem.netbuf_fails),
+    FAPP_NETSTAT_COUNTER("HeapFails", mem.heap_fails),
+    FAPP_NETSTAT_COUNTER("NetbufFree", mem.netbuf_free),
+    FAPP_NETSTAT_COUNTER("HeapFree", mem.heap_free),
+    FAPP_NETSTAT_COUNTER("NetbufHighWater", mem.netbuf_high_water),
+    FAPP_NETSTAT_COUNTER("HeapHighWater", mem.heap_high_water),
+    {0, 0} /* End of the table.*/
+};
+#endif /* FAPP_NETSTAT */
+
+/************************************************************************
+* NAME: fapp_netstat_cmd
+*
+* DESCRIPTION: Shows or clears the protocol statistics.
+************************************************************************/
+#if FAPP_CFG_NETSTAT_CMD && FNET_CFG_STATS
+void fapp_netstat_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    static struct fnet_stats            stats; /* Too big for the shell stack.*/
+    const struct fapp_netstat_entry     *entry;
+
+    if((argc == 1) || (fnet_strcmp(argv[1], "-s") == 0)) /* Print the statistics.*/
+    {
+        fnet_stats_get(&stats);
+
+        for(entry = fapp_netstat_table; entry->name; entry++)
+        {
+            if(entry->offset == FAPP_NETSTAT_GROUP)
+                fnet_shell_println(desc, FAPP_NETSTAT_GROUP_FORMAT, entry->name);
+            else
+                fnet_shell_println(desc, FAPP_NETSTAT_FORMAT, entry->name,
+                                   *(unsigned long *)((char *)&stats + entry->offset));
+        }
+    }
+    else if(fnet_strcmp(argv[1], "-z") == 0) /* Clear the statistics.*/
+    {
+        fnet_stats_clear();
+    }
+    else
+    {
+        fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+    }
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_sockets_cmd
+*
+* DESCRIPTION: Lists all sockets, with the TCP connection details.
+************************************************************************/
+#if FAPP_CFG_SOCKETS_CMD
+static const char *const fapp_sockets_tcp_state[] =
+{
+    "CLOSED", "SYN_SENT", "SYN_RCVD", "LISTEN", "ESTABLISHED", "FIN_WAIT_1",
+    "FIN_WAIT_2", "CLOSE_WAIT", "CLOSING", "LAST_ACK", "TIME_WAIT"
+};
+
+void fapp_sockets_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    SOCKET              s;
+    int                 type;
+    int                 len;
+    struct sockaddr     local_addr;
+    struct sockaddr     foreign_addr;
+    struct tcp_info     info;
+    const char          *type_str;
+    const char          *state_str;
+    char                local_str[FNET_IP_ADDR_STR_SIZE];
+    char                foreign_str[FNET_IP_ADDR_STR_SIZE];
+
+    FNET_COMP_UNUSED_ARG(argc);
+    FNET_COMP_UNUSED_ARG(argv);
+
+    fnet_shell_println(desc, FAPP_SOCKETS_HEADER);
+
+    for(s = 0; s < FNET_CFG_SOCKET_MAX; s++)
+    {
+        len = sizeof(type);
+        if(getsockopt(s, SOL_SOCKET, SO_TYPE, (char *)&type, &len) == SOCKET_ERROR)
+            continue; /* Not used.*/
+
+        len = sizeof(local_addr);
+        if(getsockname(s, &local_addr, &len) == SOCKET_ERROR)
+            continue;
+        fnet_inet_ntop(local_addr.sa_family, local_addr.sa_data, local_str, sizeof(local_str));
+
+        len = sizeof(foreign_addr);
+        if(getpeername(s, &foreign_addr, &len) == SOCKET_ERROR)
+        {
+            fnet_memset_zero(&foreign_addr, sizeof(foreign_addr));
+            fnet_strcpy(foreign_str, "*");
+        }
+        else
+        {
+            fnet_inet_ntop(foreign_addr.sa_family, foreign_addr.sa_data, foreign_str, sizeof(foreign_str));
+        }
+
+        len = sizeof(info);
+        if((type == SOCK_STREAM) && (getsockopt(s, IPPROTO_TCP, TCP_INFO, (char *)&info, &len) != SOCKET_ERROR))
+        {
+            type_str = "tcp";
+            state_str = (info.tcpi_state < (sizeof(fapp_sockets_tcp_state)/sizeof(fapp_sockets_tcp_state[0]))) ?
+                        fapp_sockets_tcp_state[info.tcpi_state] : "?";
+        }
+        else
+        {
+            type_str = (type == SOCK_DGRAM) ? "udp" : ((type == SOCK_RAW) ? "raw" : "tcp");
+            state_str = "";
+        }
+
+        fnet_shell_println(desc, FAPP_SOCKETS_FORMAT, s, type_str, 
+                           local_str, fnet_ntohs(local_addr.sa_port), 
+                           foreign_str, fnet_ntohs(foreign_addr.sa_port), state_str);
+
+        if(*state_str) /* TCP connection details.*/
+        {
+            fnet_shell_println(desc, FAPP_SOCKETS_TCP_FORMAT_1, info.tcpi_srtt, info.tcpi_rttvar, info.tcpi_rto,
+                               info.tcpi_snd_cwnd, info.tcpi_snd_ssthresh, info.tcpi_snd_wnd, info.tcpi_rcv_wnd, 
+                               info.tcpi_snd_mss, info.tcpi_rcv_mss);
+            fnet_shell_println(desc, FAPP_SOCKETS_TCP_FORMAT_2, info.tcpi_unacked, info.tcpi_retransmits, 
+                               info.tcpi_fast_retransmits, info.tcpi_dupacks, info.tcpi_rcv_ooo,
+                               info.tcpi_snd_buf, info.tcpi_snd_buf_size, info.tcpi_rcv_buf, info.tcpi_rcv_buf_size);
+        }
+    }
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_trace_cmd
+*
+* DESCRIPTION: Controls the packet trace and dumps its records.
+*              "pcapng" prints the pcap-ng file as hex, 
+*              to be converted back by "xxd -r -p".
+************************************************************************/
+#if FAPP_CFG_TRACE_CMD && FNET_CFG_TRACE
+static const char *const fapp_trace_layer_str[] =
+{
+    "eth", "arp", "ip", "ip6", "icmp", "icmp6", "igmp", "udp", "tcp"
+};
+
+static const char *const fapp_trace_event_str[] =
+{
+    "rx", "tx", "fw", "drop"
+};
+
+static void fapp_trace_pcapng_write( void *cookie, const void *data, unsigned long size )
+{
+    const unsigned char *p = (const unsigned char *)data;
+
+    while(size--)
+        fnet_shell_printf((fnet_shell_desc_t)cookie, "%02X", *p++);
+    
+    fnet_shell_println((fnet_shell_desc_t)cookie, "");
+}
+
+void fapp_trace_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    struct fnet_trace_rec   rec;
+    unsigned long           n;
+    unsigned long           mask;
+    char                    *p = 0;
+
+    if((argc == 1) || (fnet_strcmp(argv[1], "dump") == 0)) /* Decode the records.*/
+    {
+        for(n = 0; fnet_trace_get(n, &rec) == FNET_OK; n++)
+        {
+            fnet_shell_println(desc, FAPP_TRACE_FORMAT, rec.timestamp,
+                               (rec.layer < (sizeof(fapp_trace_layer_str)/sizeof(fapp_trace_layer_str[0]))) ? fapp_trace_layer_str[rec.layer] : "?",
+                               (rec.event < (sizeof(fapp_trace_event_str)/sizeof(fapp_trace_event_str[0]))) ? fapp_trace_event_str[rec.event] : "?",
+                               rec.length, rec.flow, rec.seq, rec.ack, rec.info);
+        }
+    }
+    else if(fnet_strcmp(argv[1], "hex") == 0) /* Raw records.*/
+    {
+        for(n = 0; fnet_trace_get(n, &rec) == FNET_OK; n++)
+        {
+            fnet_shell_println(desc, FAPP_TRACE_HEX_FORMAT, rec.timestamp, rec.layer, rec.event, rec.length,
+                               rec.flow, rec.seq, rec.ack, rec.info);
+        }
+    }
+    else if(fnet_strcmp(argv[1], "pcapng") == 0)
+    {
+        fnet_trace_pcapng(fapp_trace_pcapng_write, (void *)desc);
+    }
+    else if(fnet_strcmp(argv[1], "clear") == 0)
+    {
+        fnet_trace_clear();
+    }
+    else if(fnet_strcmp(argv[1], "off") == 0)
+    {
+        fnet_trace_set_mask(0);
+    }
+    else if(fnet_strcmp(argv[1], "on") == 0)
+    {
+        mask = FNET_CFG_TRACE_LAYERS;
+        
+        if(argc == 3)
+        {
+            mask = fnet_strtoul(argv[2], &p, 16);
+            if(*p)
+            {
+                fnet_shell_println(desc, FAPP_PARAM_ERR, argv[2]);
+                return;
+            }
+        }
+        
+        fnet_trace_set_mask(mask);
+        fnet_shell_println(desc, FAPP_TRACE_MASK_FORMAT, fnet_trace_get_mask());
+    }
+    else
+    {
+        fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+    }
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_capture_cmd
+*
+* DESCRIPTION: Starts, stops or clears the frame capture.
+*              Without arguments, shows the capture counters.
+************************************************************************/
+#if FAPP_CFG_CAPTURE_CMD && FNET_CFG_CAPTURE
+void fapp_capture_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    struct fnet_capture_filter  filter;
+    struct fnet_capture_stats   stats;
+    unsigned long               value;
+    char                        *p = 0;
+    int                         i;
+
+    if(argc == 1) /* Show the counters.*/
+    {
+        fnet_capture_get_stats(&stats);
+        
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "Frames", stats.frames);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "Captured", stats.captured);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "  Received", stats.captured_rx);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "  Sent", stats.captured_tx);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "Filtered out", stats.filtered);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "Overwritten", stats.overwritten);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "Copied bytes", stats.bytes);
+        fnet_shell_println(desc, FAPP_CAPTURE_FORMAT, "File size", stats.file_size);
+    }
+    else if(fnet_strcmp(argv[1], "on") == 0)
+    {
+        fnet_memset_zero(&filter, sizeof(filter));
+
+        for(i = 2; i < argc; i += 2)
+        {
+            if(i + 1 == argc)
+                goto ERROR_PARAMETER;
+
+            if(fnet_strcmp(argv[i], "host") == 0)
+            {
+                if(fnet_inet_ptos(argv[i + 1], &filter.host) == FNET_ERR)
+                    goto ERROR_VALUE;
+                continue;
+            }
+            
+            value = fnet_strtoul(argv[i + 1], &p, 0);
+            if(*p)
+                goto ERROR_VALUE;
+
+            if(fnet_strcmp(argv[i], "type") == 0)
+                filter.type = (unsigned short)value;
+            else if(fnet_strcmp(argv[i], "proto") == 0)
+                filter.protocol = (unsigned char)value;
+            else if(fnet_strcmp(argv[i], "port") == 0)
+                filter.port = (unsigned short)value;
+            else
+                goto ERROR_PARAMETER;
+        }
+
+        fnet_capture_start(&filter);
+    }
+    else if(fnet_strcmp(argv[1], "off") == 0)
+    {
+        fnet_capture_stop();
+    }
+    else if(fnet_strcmp(argv[1], "clear") == 0)
+    {
+        fnet_capture_clear();
+    }
+    else
+    {
+        i = 1;
+        goto ERROR_PARAMETER;
+    }
+    
+    return;
+    
+ERROR_VALUE:
+    i++;
+ERROR_PARAMETER:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[i]);
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_latency_cmd
+*
+* DESCRIPTION: Shows the median, 99th percentile and maximum latency 
+*              of the Rx/Tx processing stages, or clears them.
+************************************************************************/
+#if FAPP_CFG_LATENCY_CMD && FNET_CFG_LATENCY
+static const char *const fapp_latency_stage_str[FNET_LATENCY_STAGES] =
+{
+    "isr",          /* FNET_LATENCY_ISR_BOTTOM */
+    "rx eth",       /* FNET_LATENCY_RX_ETH */
+    "rx ip",        /* FNET_LATENCY_RX_IP */
+    "rx ip low",    /* FNET_LATENCY_RX_IP_LOW */
+    "rx tcp",       /* FNET_LATENCY_RX_TCP */
+    "rx udp",       /* FNET_LATENCY_RX_UDP */
+    "rx socket",    /* FNET_LATENCY_RX_SOCKET */
+    "tx send",      /* FNET_LATENCY_TX_SEND */
+    "tx ip",        /* FNET_LATENCY_TX_IP */
+    "tx eth",       /* FNET_LATENCY_TX_ETH */
+    "tx driver"     /* FNET_LATENCY_TX_DRIVER */
+};
+
+void fapp_latency_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    struct fnet_latency_stats   stats;
+    int                         i;
+
+    if(argc == 1) /* Show the statistics.*/
+    {
+        fnet_shell_println(desc, FAPP_LATENCY_HEADER);
+
+        for(i = 0; i < FNET_LATENCY_STAGES; i++)
+        {
+            if(fnet_latency_get((fnet_latency_stage_t)i, &stats) == FNET_OK)
+            {
+                fnet_shell_println(desc, FAPP_LATENCY_FORMAT, fapp_latency_stage_str[i], stats.count,
+                                   FAPP_CYCLES_US(stats.p50), FAPP_CYCLES_US(stats.p99), FAPP_CYCLES_US(stats.max));
+            }
+        }
+    }
+    else if(fnet_strcmp(argv[1], "clear") == 0)
+    {
+        fnet_latency_clear();
+    }
+    else
+    {
+        fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+    }
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_locks_cmd
+*
+* DESCRIPTION: Shows the lock call sites, sorted by the total hold time 
+*              or by the given time, or clears them.
+************************************************************************/
+#if FAPP_CFG_LOCKS_CMD && FNET_CFG_LOCK_PROFILE
+#define FAPP_LOCKS_MAX  (16) /* Number of the shown call sites.*/
+
+void fapp_locks_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    static struct fnet_lock_profile_site    sites[FAPP_LOCKS_MAX];
+    fnet_lock_profile_sort_t                sort = FNET_LOCK_PROFILE_SORT_HOLD_TOTAL;
+    char                                    site_str[24];
+    const char                              *file;
+    int                                     n;
+    int                                     i;
+
+    if(argc == 2)
+    {
+        if(fnet_strcmp(argv[1], "clear") == 0)
+        {
+            fnet_lock_profile_clear();
+            return;
+        }
+        else if(fnet_strcmp(argv[1], "hold") == 0)
+            sort = FNET_LOCK_PROFILE_SORT_HOLD_TOTAL;
+        else if(fnet_strcmp(argv[1], "max") == 0)
+            sort = FNET_LOCK_PROFILE_SORT_HOLD_MAX;
+        else if(fnet_strcmp(argv[1], "bottom") == 0)
+            sort = FNET_LOCK_PROFILE_SORT_BOTTOM_TOTAL;
+        else if(fnet_strcmp(argv[1], "wait") == 0)
+            sort = FNET_LOCK_PROFILE_SORT_WAIT_TOTAL;
+        else
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+            return;
+        }
+    }
+
+    n = fnet_lock_profile_get(sites, FAPP_LOCKS_MAX, sort);
+
+    fnet_shell_println(desc, FAPP_LOCKS_HEADER);
+
+    for(i = 0; i < n; i++)
+    {
+        if(sites[i].file)
+        {
+            /* File name, without its path.*/
+            if(((file = fnet_strrchr(sites[i].file, '/')) != 0) || ((file = fnet_strrchr(sites[i].file, '\\')) != 0))
+                file++;
+            else
+                file = sites[i].file;
+
+            fnet_snprintf(site_str, sizeof(site_str), "%s:%u", file, sites[i].line);
+        }
+        else
+        {
+            fnet_snprintf(site_str, sizeof(site_str), "(other)");
+        }
+
+        fnet_shell_println(desc, FAPP_LOCKS_FORMAT, site_str, sites[i].locks,
+                           sites[i].hold.total_us, FAPP_CYCLES_US(sites[i].hold.max),
+                           sites[i].bottom.total_us, sites[i].wait.count, sites[i].wait.total_us);
+    }
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_heap_cmd
+*
+* DESCRIPTION: Shows the heap usage and fragmentation. With the heap 
+*              profiler, shows the allocation call sites, sorted by 
+*              the allocated bytes or by the given counter.
+*              Or restarts the measurement.
+************************************************************************/
+#if FAPP_CFG_HEAP_CMD
+#define FAPP_HEAP_SITES_MAX     (16) /* Number of the shown call sites.*/
+
+void fapp_heap_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    static const char *const                pool_str[] = {"main", "netbuf"};
+    static struct fnet_heap_profile_map     map;
+#if FNET_CFG_HEAP_PROFILE
+    static struct fnet_heap_profile_site    sites[FAPP_HEAP_SITES_MAX];
+    char                                    site_str[24];
+    const char                              *file;
+    int                                     n;
+#endif
+    fnet_heap_profile_sort_t                sort = FNET_HEAP_PROFILE_SORT_LIVE;
+    int                                     pool;
+    int                                     i;
+
+    if(argc == 2)
+    {
+        if(fnet_strcmp(argv[1], "clear") == 0)
+        {
+            fnet_heap_profile_clear();
+            return;
+        }
+        else if(fnet_strcmp(argv[1], "live") == 0)
+            sort = FNET_HEAP_PROFILE_SORT_LIVE;
+        else if(fnet_strcmp(argv[1], "peak") == 0)
+            sort = FNET_HEAP_PROFILE_SORT_PEAK;
+        else if(fnet_strcmp(argv[1], "allocs") == 0)
+            sort = FNET_HEAP_PROFILE_SORT_ALLOCS;
+        else
+        {
+            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+            return;
+        }
+    }
+
+    /* Memory pools.*/
+    fnet_shell_println(desc, FAPP_HEAP_HEADER);
+
+    for(pool = FNET_HEAP_PROFILE_POOL_MAIN; pool <= FNET_HEAP_PROFILE_POOL_NETBUF; pool++)
+    {
+        if(fnet_heap_profile_map((fnet_heap_profile_pool_t)pool, &map) == FNET_OK)
+        {
+            fnet_shell_println(desc, FAPP_HEAP_FORMAT, pool_str[pool], map.used, map.high_water, 
+                               map.free, map.largest, map.blocks);
+
+            /* Free block sizes.*/
+            for(i = 0; i < FNET_HEAP_PROFILE_BUCKETS; i++)
+            {
+                if(map.histogram[i])
+                    fnet_shell_println(desc, FAPP_HEAP_BUCKET_FORMAT, 1UL << i, (2UL << i) - 1, map.histogram[i]);
+            }
+        }
+    }
+
+#if FNET_CFG_HEAP_PROFILE
+    /* Call sites.*/
+    n = fnet_heap_profile_get(sites, FAPP_HEAP_SITES_MAX, sort);
+
+    fnet_shell_println(desc, FAPP_HEAP_SITES_HEADER);
+
+    for(i = 0; i < n; i++)
+    {
+        if(sites[i].file)
+        {
+            /* File name, without its path.*/
+            if(((file = fnet_strrchr(sites[i].file, '/')) != 0) || ((file = fnet_strrchr(sites[i].file, '\\')) != 0))
+                file++;
+            else
+                file = sites[i].file;
+
+            fnet_snprintf(site_str, sizeof(site_str), "%s:%u", file, sites[i].line);
+        }
+        else
+        {
+            fnet_snprintf(site_str, sizeof(site_str), "(other)");
+        }
+
+        fnet_shell_println(desc, FAPP_HEAP_SITES_FORMAT, site_str, pool_str[sites[i].netbuf ? 1 : 0], 
+                           sites[i].live, sites[i].peak, sites[i].allocs, sites[i].frees, sites[i].fails, sites[i].rate);
+    }
+#else
+    FNET_COMP_UNUSED_ARG(sort);
+#endif
+}
+#endif
+
+/************************************************************************
+* NAME: fapp_ubench_print
+*
+* DESCRIPTION: Prints a micro-benchmark result, as a CSV line.
+************************************************************************/
+#if FAPP_CFG_UBENCH_CMD && FNET_CFG_UBENCH
+static void fapp_ubench_print( const struct fnet_ubench_result *result, void *cookie )
+{
+    fnet_shell_println((fnet_shell_desc_t)cookie, FAPP_UBENCH_FORMAT, result->name, result->variant, 
+                       result->n, result->iterations, result->min, result->avg, result->max,
+                       FAPP_CYCLES_NS(result->avg));
+}
+
+/************************************************************************
+* NAME: fapp_ubench_cmd
+*
+* DESCRIPTION: Runs the micro-benchmarks. The results are printed 
+*              in CSV format, to be compared between the releases 
+*              and the configurations.
+************************************************************************/
+void fapp_ubench_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+{
+    struct fnet_ubench_params   params;
+    const char                  *name = 0;
+    unsigned long               value;
+    char                        *p;
+    int                         i = 1;
+
+    fnet_memset_zero(&params, sizeof(params));
+
+    /* Benchmark name.*/
+    if((argc > 1) && (argc % 2 == 0))
+    {
+        if(fnet_strcmp(argv[1], "all") != 0)
+            name = argv[1];
+        i++;
+    }
+
+    for(; i < argc; i += 2)
+    {
+        if(i + 1 == argc)
+            goto ERROR_PARAMETER;
+
+        value = fnet_strtoul(argv[i + 1], &p, 0);
+        if(*p || (value == 0))
+            goto ERROR_VALUE;
+
+        if(fnet_strcmp(argv[i], "iter") == 0)
+            params.iterations = value;
+        else if(fnet_strcmp(argv[i], "n") == 0)
+            params.n = value;
+        else if(fnet_strcmp(argv[i], "size") == 0)
+            params.size = value;
+        else
+            goto ERROR_PARAMETER;
+    }
+
+    fnet_shell_println(desc, FAPP_UBENCH_INFO, FNET_VERSION, FNET_CPU_STR, FNET_CFG_LATENCY_CYCLES_PER_US);
+    fnet_shell_println(desc, FAPP_UBENCH_HEADER);
+
+    if(fnet_ubench_run(name, &params, fapp_ubench_print, (void *)desc) == FNET_ERR)
+    {
+        i = 1;
+        goto ERROR_PARAMETER;
+    }
+
+    return;
+
+ERROR_VALUE:
+    i++;
+ERROR_PARAMETER:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[i]);
+}
+#endif
+
 /************************************************************************
 * NAME: fapp_shell_init
 *
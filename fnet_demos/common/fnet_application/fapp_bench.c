@@ -60,7 +60,7 @@
 #define FAPP_BENCH_UDP_END_BUFFER_LENGTH    (1) 
 #define FAPP_UDP_TIMEOUT_MS                 (8000)
 
-/* Socket Tx&Rx buffer sizes. */
+/* Default socket Tx&Rx buffer sizes. */
 #define FAPP_BENCH_SOCKET_BUF_SIZE          (FAPP_BENCH_PACKET_SIZE_MAX)
 #define FAPP_BENCH_BUFFER_SIZE              (FAPP_BENCH_PACKET_SIZE_MAX)
 
@@ -76,8 +76,51 @@
 /* Time between keepalive probes.*/
 #define FAPP_BENCH_TCP_KEEPIDLE             (5) /*sec*/
 
+/* Request/response transaction timeout.*/
+#define FAPP_BENCH_RR_TIMEOUT_MS            (5000)
+
+#if FAPP_CFG_BENCH_CYCLES
+/* Longest interval measured by the cycle counter, half of its period.*/
+#define FAPP_BENCH_CYCLES_MS_MAX            ((0xFFFFFFFFUL / FNET_CFG_LATENCY_CYCLES_PER_US) / 2000)
+#endif
 
 #define FAPP_BENCH_COMPLETED_STR            "Test completed."
+#define FAPP_BENCH_CSV_HEADER               "#bench,mode,dir,streams,size,resp_size,sndbuf,rcvbuf,transactions,bytes,remote_bytes,time_us,kbit_s,trans_s,min_us,avg_us,p50_us,p90_us,p99_us,max_us"
+#define FAPP_BENCH_CSV_FORMAT               "bench,%s,%s,%d,%d,%d,%u,%u,%u,%u,%u,%u,%u.%u,%u,%u,%u,%u,%u,%u,%u"
+
+/************************************************************************
+*    Benchmark modes.
+*************************************************************************/
+typedef enum
+{
+    FAPP_BENCH_MODE_TCP = 0,    /* TCP bulk transfer, over one or more streams.*/
+    FAPP_BENCH_MODE_UDP = 1,    /* UDP bulk transfer.*/
+    FAPP_BENCH_MODE_RR = 2,     /* TCP request/response transactions, over one connection.*/
+    FAPP_BENCH_MODE_CRR = 3     /* TCP connect/request/response/close transactions.*/
+} fapp_bench_mode_t;
+
+static const char *const fapp_bench_mode_str[] = {"tcp", "udp", "rr", "crr"};
+
+/************************************************************************
+*    Time stamp.
+*************************************************************************/
+struct fapp_bench_stamp
+{
+    unsigned long ticks;
+#if FAPP_CFG_BENCH_CYCLES
+    unsigned long cycles;
+#endif
+};
+
+/************************************************************************
+*    TCP stream.
+*************************************************************************/
+struct fapp_bench_stream
+{
+    SOCKET          socket;
+    int             offset;     /* Sent bytes of the current message.*/
+    int             messages;   /* Sent messages.*/
+};
 
 /************************************************************************
 *    Benchmark server control structure.
@@ -86,201 +129,451 @@ struct fapp_bench_t
 {
     SOCKET socket_listen;                   /* Listening socket.*/
     SOCKET socket_foreign;                  /* Foreign socket.*/
+    struct fapp_bench_stream streams[FAPP_BENCH_STREAMS_MAX]; /* TCP streams.*/
     
     char buffer[FAPP_BENCH_BUFFER_SIZE];    /* Transmit circular buffer */    
  	
- 	unsigned long first_time;
- 	unsigned long last_time;
+ 	struct fapp_bench_stamp first_time;
+ 	struct fapp_bench_stamp last_time;
  	unsigned long bytes;
  	unsigned long remote_bytes;
+ 	
+ 	/* Request/response transactions.*/
+ 	unsigned long transactions;
+ 	unsigned long latency[FAPP_BENCH_LATENCY_SAMPLES]; /* Latencies of the last transactions, in us.*/
+ 	unsigned long latency_min;
+ 	unsigned long latency_max;
+ 	unsigned long latency_total;
 }; 
 
 static struct fapp_bench_t fapp_bench;
 
 /**************************************************************************/ /*!
- * TX benchmark parameters
+ * Benchmark parameters
  ******************************************************************************/
-struct fapp_bench_tx_params
+struct fapp_bench_params
 {
     fnet_shell_desc_t desc;
-    struct sockaddr foreign_addr;
-    int packet_size;
-    int packet_number;
+    fapp_bench_mode_t mode;
+    struct sockaddr foreign_addr;           /* TX only.*/
+    fnet_ip4_addr_t multicast_address;      /* UDP RX only, optional.*/
+    int packet_size;                        /* Message or request size.*/
+    int packet_number;                      /* Number of messages or transactions.*/
     int iteration_number;
+    int response_size;                      /* RR and CRR only.*/
+    int stream_number;                      /* TCP TX only.*/
+    unsigned long sndbuf;                   /* Socket TX buffer size.*/
+    unsigned long rcvbuf;                   /* Socket RX buffer size.*/
+    int csv;                                /* Print the results in CSV format.*/
 };
 
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
-static void fapp_bench_print_results (fnet_shell_desc_t desc);
-static void fapp_bench_tcp_rx (fnet_shell_desc_t desc, fnet_address_family_t family);
-static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t family, fnet_ip4_addr_t multicast_address);
-static void fapp_bench_tcp_tx (struct fapp_bench_tx_params *params);
-static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params);
+static void fapp_bench_stamp (struct fapp_bench_stamp *stamp);
+static unsigned long fapp_bench_interval_us (const struct fapp_bench_stamp *start, const struct fapp_bench_stamp *end);
+static unsigned long fapp_bench_rate (unsigned long value, unsigned long scale, unsigned long us);
+static void fapp_bench_reset (void);
+static void fapp_bench_latency_add (unsigned long us);
+static unsigned long fapp_bench_latency_percentile (unsigned long n, int percent);
+static void fapp_bench_print_results (struct fapp_bench_params *params, int tx);
+static int fapp_bench_socket_options (SOCKET s, struct fapp_bench_params *params, fnet_socket_type_t type);
+static SOCKET fapp_bench_tcp_listen (struct fapp_bench_params *params);
+static SOCKET fapp_bench_tcp_connect (struct fapp_bench_params *params);
+static void fapp_bench_tcp_rx (struct fapp_bench_params *params);
+static void fapp_bench_udp_rx (struct fapp_bench_params *params);
+static void fapp_bench_rr_rx (struct fapp_bench_params *params);
+static void fapp_bench_tcp_tx (struct fapp_bench_params *params);
+static void fapp_bench_udp_tx (struct fapp_bench_params *params);
+static int fapp_bench_rr_transaction (struct fapp_bench_params *params, SOCKET s);
+static void fapp_bench_rr_tx (struct fapp_bench_params *params);
+static int fapp_bench_options (fnet_shell_desc_t desc, int argc, char ** argv, int i, struct fapp_bench_params *params);
+
+/************************************************************************
+* NAME: fapp_bench_stamp
+*
+* DESCRIPTION: Takes the time stamp. 
+************************************************************************/
+static void fapp_bench_stamp (struct fapp_bench_stamp *stamp)
+{
+    stamp->ticks = fnet_timer_ticks();
+#if FAPP_CFG_BENCH_CYCLES
+    stamp->cycles = FNET_CFG_LATENCY_CYCLES();
+#endif
+}
+
+/************************************************************************
+* NAME: fapp_bench_interval_us
+*
+* DESCRIPTION: Returns the time between the stamps, in microseconds. 
+*              The short intervals are measured by the cycle counter,
+*              the long ones by the timer ticks.
+************************************************************************/
+static unsigned long fapp_bench_interval_us (const struct fapp_bench_stamp *start, const struct fapp_bench_stamp *end)
+{
+    unsigned long ms = fnet_timer_get_interval(start->ticks, end->ticks) * FNET_TIMER_PERIOD_MS;
+
+#if FAPP_CFG_BENCH_CYCLES
+    if(ms < FAPP_BENCH_CYCLES_MS_MAX)
+        return ((end->cycles - start->cycles) / FNET_CFG_LATENCY_CYCLES_PER_US);
+#endif
+
+    return (ms * 1000);
+}
+
+/************************************************************************
+* NAME: fapp_bench_rate
+*
+* DESCRIPTION: Returns value*scale/us. Both operands are halved 
+*              until the product fits into 32 bits.
+************************************************************************/
+static unsigned long fapp_bench_rate (unsigned long value, unsigned long scale, unsigned long us)
+{
+    while(value > (0xFFFFFFFFUL / scale))
+    {
+        value >>= 1;
+        us >>= 1;
+    }
+
+    return ((us == 0) ? 0 : ((value * scale) / us));
+}
+
+/************************************************************************
+* NAME: fapp_bench_reset
+*
+* DESCRIPTION: Resets the results. 
+************************************************************************/
+static void fapp_bench_reset (void)
+{
+    fapp_bench.bytes = 0;
+    fapp_bench.remote_bytes = 0;
+    fapp_bench.transactions = 0;
+    fapp_bench.latency_min = 0;
+    fapp_bench.latency_max = 0;
+    fapp_bench.latency_total = 0;
+}
+
+/************************************************************************
+* NAME: fapp_bench_latency_add
+*
+* DESCRIPTION: Adds the latency of a completed transaction. 
+************************************************************************/
+static void fapp_bench_latency_add (unsigned long us)
+{
+    fapp_bench.latency[fapp_bench.transactions % FAPP_BENCH_LATENCY_SAMPLES] = us;
+
+    if((fapp_bench.transactions == 0) || (us < fapp_bench.latency_min))
+        fapp_bench.latency_min = us;
+    if(us > fapp_bench.latency_max)
+        fapp_bench.latency_max = us;
+
+    fapp_bench.latency_total += us;
+    fapp_bench.transactions++;
+}
+
+/************************************************************************
+* NAME: fapp_bench_latency_percentile
+*
+* DESCRIPTION: Returns the percentile of the n latency samples,
+*              which are sorted in ascending order. 
+************************************************************************/
+static unsigned long fapp_bench_latency_percentile (unsigned long n, int percent)
+{
+    unsigned long i = (n * (unsigned long)percent) / 100;
+
+    if(i >= n)
+        i = n - 1;
+
+    return fapp_bench.latency[i];
+}
 
 /************************************************************************
 * NAME: fapp_bench_print_results
 *
 * DESCRIPTION: Print Benchmark results. 
 ************************************************************************/
-static void fapp_bench_print_results (fnet_shell_desc_t desc)
+static void fapp_bench_print_results (struct fapp_bench_params *params, int tx)
 {
-/* Print benchmark results.*/
-    unsigned long interval = fnet_timer_get_interval(fapp_bench.first_time, fapp_bench.last_time);
+    fnet_shell_desc_t   desc = params->desc;
+    unsigned long       interval = fapp_bench_interval_us(&fapp_bench.first_time, &fapp_bench.last_time);
+    unsigned long       kbps = fapp_bench_rate(fapp_bench.bytes, 80000, interval);          /* In 0.1 Kbit/s.*/
+    unsigned long       remote_kbps = fapp_bench_rate(fapp_bench.remote_bytes, 80000, interval);
+    unsigned long       tps = fapp_bench_rate(fapp_bench.transactions, 1000000, interval);  /* Transactions/s.*/
+    unsigned long       samples = fapp_bench.transactions;
+    unsigned long       avg = 0;
+    unsigned long       p50 = 0;
+    unsigned long       p90 = 0;
+    unsigned long       p99 = 0;
+    unsigned long       tmp;
+    unsigned long       i;
+    unsigned long       j;
+
+    if(samples)
+    {
+        if(samples > FAPP_BENCH_LATENCY_SAMPLES)
+            samples = FAPP_BENCH_LATENCY_SAMPLES;
+
+        /* Sort the latency samples, by insertion.*/
+        for(i = 1; i < samples; i++)
+        {
+            tmp = fapp_bench.latency[i];
+
+            for(j = i; (j > 0) && (fapp_bench.latency[j - 1] > tmp); j--)
+                fapp_bench.latency[j] = fapp_bench.latency[j - 1];
+
+            fapp_bench.latency[j] = tmp;
+        }
+
+        avg = fapp_bench.latency_total / fapp_bench.transactions;
+        p50 = fapp_bench_latency_percentile(samples, 50);
+        p90 = fapp_bench_latency_percentile(samples, 90);
+        p99 = fapp_bench_latency_percentile(samples, 99);
+    }
+
+    if(params->csv)
+    {
+        fnet_shell_println(desc, FAPP_BENCH_CSV_FORMAT, fapp_bench_mode_str[params->mode], tx ? "tx" : "rx",
+                           params->stream_number, params->packet_size, params->response_size, 
+                           params->sndbuf, params->rcvbuf, fapp_bench.transactions,
+                           fapp_bench.bytes, fapp_bench.remote_bytes, interval, kbps / 10, kbps % 10, tps,
+                           fapp_bench.latency_min, avg, p50, p90, p99, fapp_bench.latency_max);
+        return;
+    }
     
     fnet_shell_println(desc, "Results:");
     
     if(fapp_bench.remote_bytes == 0)
     {
-        fnet_shell_println(desc, "\t%d bytes in %d.%d seconds = %d Kbits/sec\n", fapp_bench.bytes, 
-            ((interval*FNET_TIMER_PERIOD_MS)/1000),
-            ((interval*FNET_TIMER_PERIOD_MS)%1000)/100,
-            (interval == 0) ? -1 : (int)((fapp_bench.bytes*8/**(1000*//FNET_TIMER_PERIOD_MS/*)*/)/interval)/*/1000*/); 
+        fnet_shell_println(desc, "\t%u bytes in %u.%03u seconds = %u.%u Kbits/sec", fapp_bench.bytes, 
+            interval / 1000000, (interval % 1000000) / 1000, kbps / 10, kbps % 10); 
     }
     else /* UDP TX only */
     {
-        fnet_shell_println(desc, "\t%d [%d] bytes in %d.%d seconds = %d [%d] Kbits/sec\n", fapp_bench.bytes, fapp_bench.remote_bytes, 
-            ((interval*FNET_TIMER_PERIOD_MS)/1000),
-            ((interval*FNET_TIMER_PERIOD_MS)%1000)/100,
-            (interval == 0) ? -1 : (int)((fapp_bench.bytes*8/**(1000*//FNET_TIMER_PERIOD_MS/*)*/)/interval)/*/1000*/,
-            (interval == 0) ? -1 : (int)((fapp_bench.remote_bytes*8/**(1000*//FNET_TIMER_PERIOD_MS/*)*/)/interval)/*/1000*/);     
-    
+        fnet_shell_println(desc, "\t%u [%u] bytes in %u.%03u seconds = %u.%u [%u.%u] Kbits/sec", fapp_bench.bytes, fapp_bench.remote_bytes, 
+            interval / 1000000, (interval % 1000000) / 1000, kbps / 10, kbps % 10, remote_kbps / 10, remote_kbps % 10);     
     }
+
+    if(fapp_bench.transactions)
+    {
+        fnet_shell_println(desc, "\t%u transactions = %u transactions/sec", fapp_bench.transactions, tps);
+        fnet_shell_println(desc, "\tLatency, us: min %u, avg %u, p50 %u, p90 %u, p99 %u, max %u", 
+            fapp_bench.latency_min, avg, p50, p90, p99, fapp_bench.latency_max);
+    }
+
+    fnet_shell_println(desc, "");
 }
 
 /************************************************************************
-* NAME: fapp_bench_tcp_rx
+* NAME: fapp_bench_socket_options
 *
-* DESCRIPTION: Start Benchmark TCP server. 
+* DESCRIPTION: Sets the benchmark socket options. 
+************************************************************************/
+static int fapp_bench_socket_options (SOCKET s, struct fapp_bench_params *params, fnet_socket_type_t type)
+{
+    const struct linger     linger_option ={1, /*l_onoff*/
+                                            4  /*l_linger*/};
+    const int               keepalive_option = 1;
+    const int               keepcnt_option = FAPP_BENCH_TCP_KEEPCNT;
+    const int               keepintvl_option = FAPP_BENCH_TCP_KEEPINTVL;
+    const int               keepidle_option = FAPP_BENCH_TCP_KEEPIDLE;
+    int                     result = FNET_OK;
+
+    if( /* Set socket buffer size. */
+        (setsockopt(s, SOL_SOCKET, SO_RCVBUF, (char *) &params->rcvbuf, sizeof(params->rcvbuf))== SOCKET_ERROR) ||
+        (setsockopt(s, SOL_SOCKET, SO_SNDBUF, (char *) &params->sndbuf, sizeof(params->sndbuf))== SOCKET_ERROR) 
+      )
+    {
+        result = FNET_ERR;
+    }
+    else if((type == SOCK_STREAM) && 
+        ( /* Setup linger option. */
+        (setsockopt (s, SOL_SOCKET, SO_LINGER, (char *)&linger_option, sizeof(linger_option)) == SOCKET_ERROR) ||
+        /* Enable keepalive_option option. */
+        (setsockopt (s, SOL_SOCKET, SO_KEEPALIVE, (char *)&keepalive_option, sizeof(keepalive_option)) == SOCKET_ERROR) ||
+        /* Keepalive probe retransmit limit. */
+        (setsockopt (s, IPPROTO_TCP, TCP_KEEPCNT, (char *)&keepcnt_option, sizeof(keepcnt_option)) == SOCKET_ERROR) ||
+        /* Keepalive retransmit interval.*/
+        (setsockopt (s, IPPROTO_TCP, TCP_KEEPINTVL, (char *)&keepintvl_option, sizeof(keepintvl_option)) == SOCKET_ERROR) ||
+        /* Time between keepalive probes.*/
+        (setsockopt (s, IPPROTO_TCP, TCP_KEEPIDLE, (char *)&keepidle_option, sizeof(keepidle_option)) == SOCKET_ERROR)
+        ))
+    {
+        result = FNET_ERR;
+    }
+
+    if(result == FNET_ERR)
+        FNET_DEBUG("BENCH: Socket setsockopt error.\n");
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fapp_bench_tcp_listen
+*
+* DESCRIPTION: Creates the listening TCP socket of the benchmark servers. 
 ************************************************************************/
-static void fapp_bench_tcp_rx (fnet_shell_desc_t desc, fnet_address_family_t family)
+static SOCKET fapp_bench_tcp_listen (struct fapp_bench_params *params)
 {
     struct sockaddr     local_addr;
-    int                 received;
-    char                ip_str[FNET_IP_ADDR_STR_SIZE];
-    struct linger       linger_option ={1, /*l_onoff*/
-                                        4  /*l_linger*/};
-    unsigned long       bufsize_option = FAPP_BENCH_SOCKET_BUF_SIZE;
-    int                 keepalive_option = 1;
-    int                 keepcnt_option = FAPP_BENCH_TCP_KEEPCNT;
-    int                 keepintvl_option = FAPP_BENCH_TCP_KEEPINTVL;
-    int                 keepidle_option = FAPP_BENCH_TCP_KEEPIDLE;
-    struct sockaddr     foreign_addr;
-    int                 addr_len;
-    int                 exit_flag = 0;
-	
-    
-    fapp_bench.socket_foreign = SOCKET_INVALID;
-    
+    SOCKET              s;
+
 	/* Create listen socket */
-    if((fapp_bench.socket_listen = socket(family, SOCK_STREAM, 0)) == SOCKET_INVALID)
+    if((s = socket(AF_SUPPORTED, SOCK_STREAM, 0)) == SOCKET_INVALID)
     {
         FNET_DEBUG("BENCH: Socket creation error.");
-        goto ERROR_1;
+        return SOCKET_INVALID;
     }
     
     /* Bind socket.*/
     fnet_memset_zero(&local_addr, sizeof(local_addr));
     
     local_addr.sa_port = FAPP_BENCH_PORT;    
-    local_addr.sa_family = family;
+    local_addr.sa_family = AF_SUPPORTED;
     
-    if(bind(fapp_bench.socket_listen, &local_addr, sizeof(local_addr)) == SOCKET_ERROR)
+    if(bind(s, &local_addr, sizeof(local_addr)) == SOCKET_ERROR)
     {
         FNET_DEBUG("BENCH: Socket bind error.");
-        goto ERROR_2;
+        goto ERROR;
     }
 
-    /* Set Socket options. */
-    if( /* Setup linger option. */
-        (setsockopt (fapp_bench.socket_listen, SOL_SOCKET, SO_LINGER, (char *)&linger_option, sizeof(linger_option)) == SOCKET_ERROR) ||
-        /* Set socket buffer size. */
-        (setsockopt(fapp_bench.socket_listen, SOL_SOCKET, SO_RCVBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-        (setsockopt(fapp_bench.socket_listen, SOL_SOCKET, SO_SNDBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-        /* Enable keepalive_option option. */
-        (setsockopt (fapp_bench.socket_listen, SOL_SOCKET, SO_KEEPALIVE, (char *)&keepalive_option, sizeof(keepalive_option)) == SOCKET_ERROR) ||
-        /* Keepalive probe retransmit limit. */
-        (setsockopt (fapp_bench.socket_listen, IPPROTO_TCP, TCP_KEEPCNT, (char *)&keepcnt_option, sizeof(keepcnt_option)) == SOCKET_ERROR) ||
-        /* Keepalive retransmit interval.*/
-        (setsockopt (fapp_bench.socket_listen, IPPROTO_TCP, TCP_KEEPINTVL, (char *)&keepintvl_option, sizeof(keepintvl_option)) == SOCKET_ERROR) ||
-        /* Time between keepalive probes.*/
-        (setsockopt (fapp_bench.socket_listen, IPPROTO_TCP, TCP_KEEPIDLE, (char *)&keepidle_option, sizeof(keepidle_option)) == SOCKET_ERROR)
-      )
-    {
-        FNET_DEBUG("BENCH: Socket setsockopt error.\n");
-        goto ERROR_2;		
-    }
+    /* Set Socket options, inherited by the accepted sockets. */
+    if(fapp_bench_socket_options(s, params, SOCK_STREAM) == FNET_ERR)
+        goto ERROR;
     
     /* Listen. */
-    if(listen(fapp_bench.socket_listen, 1) == SOCKET_ERROR)
+    if(listen(s, FAPP_BENCH_STREAMS_MAX) == SOCKET_ERROR)
     {
         FNET_DEBUG("BENCH: Socket listen error.\n");
-        goto ERROR_2;
+        goto ERROR;
     }
+
+    return s;
+
+ERROR:
+    closesocket(s);
+    return SOCKET_INVALID;
+}
+
+/************************************************************************
+* NAME: fapp_bench_tcp_rx
+*
+* DESCRIPTION: Start Benchmark TCP server. 
+*              It receives up to FAPP_BENCH_STREAMS_MAX streams at once.
+*              The test ends, when all streams are closed.
+************************************************************************/
+static void fapp_bench_tcp_rx (struct fapp_bench_params *params)
+{
+    fnet_shell_desc_t   desc = params->desc;
+    int                 received;
+    char                ip_str[FNET_IP_ADDR_STR_SIZE];
+    struct sockaddr     foreign_addr;
+    int                 addr_len;
+    SOCKET              s;
+    int                 exit_flag = 0;
+    int                 active;
+    int                 is_first;
+    int                 i;
+	
+    for(i = 0; i < FAPP_BENCH_STREAMS_MAX; i++)
+        fapp_bench.streams[i].socket = SOCKET_INVALID;
+    
+    if((fapp_bench.socket_listen = fapp_bench_tcp_listen(params)) == SOCKET_INVALID)
+        goto ERROR_1;
     
     /* ------ Start test.----------- */
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     fnet_shell_println(desc, " TCP RX Test");
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
-    fapp_netif_addr_print(desc, family, fapp_default_netif, FNET_FALSE);
+    fapp_netif_addr_print(desc, AF_SUPPORTED, fapp_default_netif, FNET_FALSE);
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Local Port", FNET_NTOHS(FAPP_BENCH_PORT));
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Max. streams", FAPP_BENCH_STREAMS_MAX);
     fnet_shell_println(desc, FAPP_TOCANCEL_STR);
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     
+    if(params->csv)
+        fnet_shell_println(desc, FAPP_BENCH_CSV_HEADER);
+    
     while(exit_flag == 0)
     {
         fnet_shell_println(desc, "Waiting.");
         
-        fapp_bench.bytes = 0;
-        fapp_bench.remote_bytes = 0;
-        if(fapp_bench.socket_foreign != SOCKET_INVALID)
-        {
-            closesocket(fapp_bench.socket_foreign);
-            fapp_bench.socket_foreign = SOCKET_INVALID;
-        }
+        fapp_bench_reset();
+        params->stream_number = 0;
+        active = 0;
+        is_first = 1;
         
-        while((fapp_bench.socket_foreign == SOCKET_INVALID) && (exit_flag == 0))
+        while(exit_flag == 0)
         {
-            /*Accept*/
-            addr_len = sizeof(foreign_addr);
-            fapp_bench.socket_foreign = accept(fapp_bench.socket_listen, &foreign_addr, &addr_len);
-            
-   
-            exit_flag = fnet_shell_ctrlc (desc);
-                    
-            if(fapp_bench.socket_foreign != SOCKET_INVALID)
+            /* Accept new streams.*/
+            if(active < FAPP_BENCH_STREAMS_MAX)
             {
-   
-                fnet_shell_println(desc,"Receiving from %s:%d", fnet_inet_ntop(foreign_addr.sa_family, (char*)(foreign_addr.sa_data), ip_str, sizeof(ip_str)), fnet_ntohs(foreign_addr.sa_port));
-                          
-                fapp_bench.first_time = fnet_timer_ticks();
+                addr_len = sizeof(foreign_addr);
+                s = accept(fapp_bench.socket_listen, &foreign_addr, &addr_len);
+                
+                if(s != SOCKET_INVALID)
+                {
+                    for(i = 0; fapp_bench.streams[i].socket != SOCKET_INVALID; i++)
+                    {}
+
+                    fapp_bench.streams[i].socket = s;
+                    active++;
+                    params->stream_number++;
+
+                    if(!params->csv)
+                        fnet_shell_println(desc,"Receiving from %s:%d", fnet_inet_ntop(foreign_addr.sa_family, (char*)(foreign_addr.sa_data), ip_str, sizeof(ip_str)), fnet_ntohs(foreign_addr.sa_port));
+                    
+                    if(is_first)
+                    {
+                        fapp_bench_stamp(&fapp_bench.first_time);
+                        is_first = 0;
+                    }
+                }
+            }
 
-                while(1) /* Receiving data.*/
+            /* Receiving data.*/
+            for(i = 0; i < FAPP_BENCH_STREAMS_MAX; i++)
+            {
+                if(fapp_bench.streams[i].socket != SOCKET_INVALID)
                 {
-                    received = recv(fapp_bench.socket_foreign, (char*)(&fapp_bench.buffer[0]), FAPP_BENCH_BUFFER_SIZE, 0);
+                    received = recv(fapp_bench.streams[i].socket, (char*)(&fapp_bench.buffer[0]), FAPP_BENCH_BUFFER_SIZE, 0);
                     
-                    if ((received == SOCKET_ERROR) || exit_flag)
+                    if(received == SOCKET_ERROR) /* The stream is closed.*/
                     {              
-                        fapp_bench.last_time = fnet_timer_ticks();
-                        
-                        /* Print benchmark results.*/
-                        fapp_bench_print_results (desc);           			
-                        break;
+                        closesocket(fapp_bench.streams[i].socket);
+                        fapp_bench.streams[i].socket = SOCKET_INVALID;
+                        active--;
+                        fapp_bench_stamp(&fapp_bench.last_time);
                     }
                     else
                     {
                         fapp_bench.bytes += received;
                     }
-                    
-                    exit_flag = fnet_shell_ctrlc (desc); /* Check [Ctrl+c]*/
+                }
+            }
+
+            exit_flag = fnet_shell_ctrlc (desc); /* Check [Ctrl+c]*/
+            
+            if(is_first == 0)
+            {
+                if(exit_flag)
+                    fapp_bench_stamp(&fapp_bench.last_time);
+
+                if(exit_flag || (active == 0))
+                {
+                    /* Print benchmark results.*/
+                    fapp_bench_print_results (params, FNET_FALSE);           			
+                    break;
                 }
             }
         }
     }
 
-    closesocket(fapp_bench.socket_foreign);
+    for(i = 0; i < FAPP_BENCH_STREAMS_MAX; i++)
+    {
+        if(fapp_bench.streams[i].socket != SOCKET_INVALID)
+            closesocket(fapp_bench.streams[i].socket);
+    }
     
-ERROR_2:
     closesocket(fapp_bench.socket_listen);
 
 ERROR_1:
@@ -293,10 +586,11 @@ ERROR_1:
 *
 * DESCRIPTION: Start Benchmark UDP server. 
 ************************************************************************/
-static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t family, fnet_ip4_addr_t multicast_address /* optional, set to 0*/)
+static void fapp_bench_udp_rx (struct fapp_bench_params *params)
 {
+    fnet_shell_desc_t       desc = params->desc;
+    fnet_ip4_addr_t         multicast_address = params->multicast_address; /* optional, set to 0*/
 	struct sockaddr         local_addr;
-	const unsigned long     bufsize_option = FAPP_BENCH_SOCKET_BUF_SIZE;
 	int                     received;
 	char                    ip_str[FNET_IP_ADDR_STR_SIZE];
 	struct sockaddr         addr;
@@ -306,7 +600,7 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
 	
 
 	/* Create listen socket */
-    if((fapp_bench.socket_listen = socket(family, SOCK_DGRAM, 0)) == SOCKET_INVALID)
+    if((fapp_bench.socket_listen = socket(AF_SUPPORTED, SOCK_DGRAM, 0)) == SOCKET_INVALID)
     {
         FNET_DEBUG("BENCH: Socket creation error.\n");
         goto ERROR_1;
@@ -316,7 +610,7 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
     fnet_memset_zero(&local_addr, sizeof(local_addr));
     
     local_addr.sa_port = FAPP_BENCH_PORT;    
-    local_addr.sa_family = family;
+    local_addr.sa_family = AF_SUPPORTED;
     
     if(bind(fapp_bench.socket_listen, &local_addr, sizeof(local_addr)) == SOCKET_ERROR)
     {
@@ -326,13 +620,8 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
 
 
 	/* Set socket options. */    
-	if( 
-		/* Set socket buffer size. */
-		(setsockopt(fapp_bench.socket_listen, SOL_SOCKET, SO_RCVBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-		(setsockopt(fapp_bench.socket_listen, SOL_SOCKET, SO_SNDBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) 
-	)
+	if(fapp_bench_socket_options(fapp_bench.socket_listen, params, SOCK_DGRAM) == FNET_ERR)
 	{
-    	FNET_DEBUG("BENCH: Socket setsockopt error.\n");
         goto ERROR_2;		
 	}
     
@@ -357,7 +646,7 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     fnet_shell_println(desc, " UDP RX Test" );
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
-    fapp_netif_addr_print(desc, family, fapp_default_netif, FNET_FALSE);
+    fapp_netif_addr_print(desc, AF_SUPPORTED, fapp_default_netif, FNET_FALSE);
     if(multicast_address)
     {
         fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_S, "Multicast Group", fnet_inet_ntoa(*(struct in_addr *)(&multicast_address), ip_str) );    
@@ -366,13 +655,14 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
     fnet_shell_println(desc, FAPP_TOCANCEL_STR);
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
   
+    if(params->csv)
+        fnet_shell_println(desc, FAPP_BENCH_CSV_HEADER);
     
     while(exit_flag == 0) /* Main loop */
     {
         fnet_shell_println(desc, "Waiting.");
         
-        fapp_bench.bytes = 0;
-        fapp_bench.remote_bytes = 0;
+        fapp_bench_reset();
         addr_len = sizeof(addr);
         is_first = 1;
         
@@ -387,14 +677,15 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
             {   
       
                 /* Reset timeout. */
-                fapp_bench.last_time = fnet_timer_ticks();
+                fapp_bench_stamp(&fapp_bench.last_time);
                 
                 if(is_first)
                 {
                     if( received > FAPP_BENCH_UDP_END_BUFFER_LENGTH )
                     {
-                        fnet_shell_println(desc,"Receiving from %s:%d",  fnet_inet_ntop(addr.sa_family, (char*)(addr.sa_data), ip_str, sizeof(ip_str)), fnet_ntohs(addr.sa_port));
-                        fapp_bench.first_time = fnet_timer_ticks();
+                        if(!params->csv)
+                            fnet_shell_println(desc,"Receiving from %s:%d",  fnet_inet_ntop(addr.sa_family, (char*)(addr.sa_data), ip_str, sizeof(ip_str)), fnet_ntohs(addr.sa_port));
+                        fapp_bench_stamp(&fapp_bench.first_time);
                         is_first = 0;
                     }
                 }
@@ -412,7 +703,7 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
                         
                         
                         /* Print benchmark results.*/
-                        fapp_bench_print_results (desc);           		
+                        fapp_bench_print_results (params, FNET_FALSE);           		
     					
                         break;    	
                     }
@@ -430,10 +721,10 @@ static void fapp_bench_udp_rx (fnet_shell_desc_t desc, fnet_address_family_t fam
                 }
                 /* Check timeout. */
                 if((is_first == 0) &&
-                    (fnet_timer_get_interval(fapp_bench.last_time, fnet_timer_ticks()) > (FAPP_UDP_TIMEOUT_MS/FNET_TIMER_PERIOD_MS)))
+                    (fnet_timer_get_interval(fapp_bench.last_time.ticks, fnet_timer_ticks()) > (FAPP_UDP_TIMEOUT_MS/FNET_TIMER_PERIOD_MS)))
                 {
                     fnet_shell_println(desc, "BENCH: Exit on timeout.");
-                    fapp_bench_print_results (desc);            
+                    fapp_bench_print_results (params, FNET_FALSE);            
                     break;
                 }
             }
@@ -451,71 +742,251 @@ ERROR_1:
 }
 
 /************************************************************************
-* NAME: fapp_benchrx_cmd
+* NAME: fapp_bench_rr_rx
 *
-* DESCRIPTION: Start RX Benchmark server. 
+* DESCRIPTION: Start Benchmark TCP request/response server. 
+*              Every request starts with a header of its own size and 
+*              of the response size (32-bit, network byte order). 
+*              The request is read whole, then the response is sent.
+*              The connections are served one by one.
 ************************************************************************/
-void fapp_benchrx_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
+static void fapp_bench_rr_rx (struct fapp_bench_params *params)
 {
-    fnet_address_family_t family;
+    fnet_shell_desc_t   desc = params->desc;
+    unsigned long       header[FAPP_BENCH_RR_HEADER_SIZE/sizeof(unsigned long)];
+    struct sockaddr     foreign_addr;
+    int                 addr_len;
+    unsigned long       request_size;
+    unsigned long       response_size;
+    unsigned long       done;
+    unsigned long       size;
+    int                 result;
+    unsigned long       connections = 0;
+    int                 exit_flag = 0;
 
-    family = AF_SUPPORTED;            
-        
-    /* TCP */
-    if((argc == 1)||(argc == 2 && fnet_strcasecmp("tcp", argv[1]) == 0)) 
-    {
-        fapp_bench_tcp_rx(desc, family);
-    }
-    /* UDP */
-    else if(((argc == 2) || (argc == 3)) && fnet_strcasecmp("udp", argv[1]) == 0) 
+    fapp_bench_reset();
+
+    if((fapp_bench.socket_listen = fapp_bench_tcp_listen(params)) == SOCKET_INVALID)
+        goto ERROR_1;
+
+    /* ------ Start test.----------- */
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+    fnet_shell_println(desc, " TCP RR Server");
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+    fapp_netif_addr_print(desc, AF_SUPPORTED, fapp_default_netif, FNET_FALSE);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Local Port", FNET_NTOHS(FAPP_BENCH_PORT));
+    fnet_shell_println(desc, FAPP_TOCANCEL_STR);
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+
+    while(exit_flag == 0)
     {
-        fnet_ip4_addr_t multicast_address = 0;
-        
-        if(argc == 3) /* Multicast group address.*/
+        addr_len = sizeof(foreign_addr);
+        fapp_bench.socket_foreign = accept(fapp_bench.socket_listen, &foreign_addr, &addr_len);
+
+        if(fapp_bench.socket_foreign != SOCKET_INVALID)
         {
-            if((fnet_inet_aton(argv[2], (struct in_addr *) &multicast_address) == FNET_ERR) || !FNET_IP4_ADDR_IS_MULTICAST(multicast_address))
+            connections++;
+
+            while(exit_flag == 0) /* Transactions.*/
             {
-                fnet_shell_println(desc, FAPP_PARAM_ERR, argv[2]);
-                return;
+                /* Request header.*/
+                for(done = 0; (done < FAPP_BENCH_RR_HEADER_SIZE) && (exit_flag == 0); done += (unsigned long)result)
+                {
+                    if((result = recv(fapp_bench.socket_foreign, (char *)header + done, (int)(FAPP_BENCH_RR_HEADER_SIZE - done), 0)) == SOCKET_ERROR)
+                        goto CLOSE;
+
+                    exit_flag = fnet_shell_ctrlc (desc);
+                }
+
+                if(exit_flag)
+                    break;
+
+                request_size = fnet_ntohl(header[0]);
+                response_size = fnet_ntohl(header[1]);
+
+                if(request_size < FAPP_BENCH_RR_HEADER_SIZE)
+                    goto CLOSE; /* Wrong request.*/
+
+                /* Rest of the request.*/
+                for(done = FAPP_BENCH_RR_HEADER_SIZE; (done < request_size) && (exit_flag == 0); done += (unsigned long)result)
+                {
+                    size = request_size - done;
+                    if(size > FAPP_BENCH_BUFFER_SIZE)
+                        size = FAPP_BENCH_BUFFER_SIZE;
+
+                    if((result = recv(fapp_bench.socket_foreign, &fapp_bench.buffer[0], (int)size, 0)) == SOCKET_ERROR)
+                        goto CLOSE;
+
+                    exit_flag = fnet_shell_ctrlc (desc);
+                }
+
+                /* Response.*/
+                for(done = 0; (done < response_size) && (exit_flag == 0); done += (unsigned long)result)
+                {
+                    size = response_size - done;
+                    if(size > FAPP_BENCH_BUFFER_SIZE)
+                        size = FAPP_BENCH_BUFFER_SIZE;
+
+                    if((result = send(fapp_bench.socket_foreign, &fapp_bench.buffer[0], (int)size, 0)) == SOCKET_ERROR)
+                        goto CLOSE;
+
+                    exit_flag = fnet_shell_ctrlc (desc);
+                }
+
+                fapp_bench.transactions++;
+                fapp_bench.bytes += request_size + response_size;
             }
+CLOSE:
+            closesocket(fapp_bench.socket_foreign);
         }
-        
-        fapp_bench_udp_rx(desc, family, multicast_address);
-    }
-    else
-    {
-        fnet_shell_println(desc, FAPP_PARAM_ERR, argv[1]);
+
+        if(exit_flag == 0)
+            exit_flag = fnet_shell_ctrlc (desc);
     }
+
+    fnet_shell_println(desc, "Served %u connections, %u transactions, %u bytes.", connections, fapp_bench.transactions, fapp_bench.bytes);
+
+    closesocket(fapp_bench.socket_listen);
+
+ERROR_1:
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
 }
 
-////////////////////////////////////////////// TX //////////////////////////////////////
 /************************************************************************
-* NAME: fapp_bench_tcp_tx
+* NAME: fapp_benchrx_cmd
 *
-* DESCRIPTION: Start TX TCP Benchmark. 
+* DESCRIPTION: Start RX Benchmark server. 
 ************************************************************************/
-static void fapp_bench_tcp_tx (struct fapp_bench_tx_params *params)
+void fapp_benchrx_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
 {
-    int                     send_result;
-    char                    ip_str[FNET_IP_ADDR_STR_SIZE];
-    const struct linger     linger_option ={1, /*l_onoff*/
-                                            4  /*l_linger*/};
-    const unsigned long     bufsize_option = FAPP_BENCH_SOCKET_BUF_SIZE;
-    const int               keepalive_option = 1;
-    const int               keepcnt_option = FAPP_BENCH_TCP_KEEPCNT;
-    const int               keepintvl_option = FAPP_BENCH_TCP_KEEPINTVL;
-    const int               keepidle_option = FAPP_BENCH_TCP_KEEPIDLE;
-    struct sockaddr         foreign_addr;
-    int                     exit_flag = 0;
-    int                     sock_err ;
-    int                     option_len;
-    fnet_shell_desc_t       desc = params->desc;
+    struct fapp_bench_params    bench_params;
+    int                         i = 1;
+
+    fnet_memset_zero(&bench_params, sizeof(bench_params));
+    bench_params.desc = desc;
+    bench_params.mode = FAPP_BENCH_MODE_TCP;
+    
+    if(argc > 1)
+    {
+        /* TCP */
+        if(fnet_strcasecmp("tcp", argv[1]) == 0) 
+        {
+            i++;
+        }
+        /* UDP */
+        else if(fnet_strcasecmp("udp", argv[1]) == 0) 
+        {
+            bench_params.mode = FAPP_BENCH_MODE_UDP;
+            i++;
+            
+            if((argc > 2) && (fnet_inet_aton(argv[2], (struct in_addr *) &bench_params.multicast_address) == FNET_OK)) /* Multicast group address.*/
+            {
+                if(!FNET_IP4_ADDR_IS_MULTICAST(bench_params.multicast_address))
+                {
+                    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[2]);
+                    return;
+                }
+                i++;
+            }
+        }
+        /* TCP request/response */
+        else if(fnet_strcasecmp("rr", argv[1]) == 0) 
+        {
+            bench_params.mode = FAPP_BENCH_MODE_RR;
+            i++;
+        }
+    }
+
+    if(fapp_bench_options(desc, argc, argv, i, &bench_params) == FNET_ERR)
+        return;
+
+#if FAPP_CFG_BENCH_CYCLES
+    FNET_CFG_LATENCY_CYCLES_INIT();
+#endif
+
+    switch(bench_params.mode)
+    {
+        case FAPP_BENCH_MODE_UDP:
+            fapp_bench_udp_rx(&bench_params);
+            break;
+        case FAPP_BENCH_MODE_RR:
+            fapp_bench_rr_rx(&bench_params);
+            break;
+        default:
+            fapp_bench_tcp_rx(&bench_params);
+            break;
+    }
+}
+
+////////////////////////////////////////////// TX //////////////////////////////////////
+/************************************************************************
+* NAME: fapp_bench_tcp_connect
+*
+* DESCRIPTION: Creates the TCP socket and connects it to the server. 
+************************************************************************/
+static SOCKET fapp_bench_tcp_connect (struct fapp_bench_params *params)
+{
+    struct sockaddr         foreign_addr;
     fnet_socket_state_t     connection_state;
-    int                     packet_size = params->packet_size;
-    int                     cur_packet_number;
-    int                     buffer_offset;
-    int                     iterations = params->iteration_number;
-    fnet_address_family_t   family = params->foreign_addr.sa_family; 
+    int                     option_len;
+    SOCKET                  s;
+
+    /* Create socket */
+    if((s = socket(params->foreign_addr.sa_family, SOCK_STREAM, 0)) == SOCKET_INVALID)
+    {
+        FNET_DEBUG("BENCH: Socket creation error.\n");
+        return SOCKET_INVALID;
+    }
+    
+    /* Set Socket options. */
+    if(fapp_bench_socket_options(s, params, SOCK_STREAM) == FNET_ERR)
+    {
+        closesocket(s);
+        return SOCKET_INVALID;
+    }
+
+    /* Connect to the server.*/
+    foreign_addr = params->foreign_addr;
+    
+    connect(s, (struct sockaddr *)(&foreign_addr), sizeof(foreign_addr)); 
+    
+    do
+    {
+        option_len = sizeof(connection_state); 
+        getsockopt(s, SOL_SOCKET, SO_STATE, (char*)&connection_state, &option_len);
+    }
+    while (connection_state == SS_CONNECTING);
+    
+    if(connection_state != SS_CONNECTED)
+    {
+        closesocket(s);
+        return SOCKET_INVALID;
+    } 
+
+    return s;
+}
+
+/************************************************************************
+* NAME: fapp_bench_tcp_tx
+*
+* DESCRIPTION: Start TX TCP Benchmark. 
+*              The messages are sent over the parallel streams, 
+*              in round-robin.
+************************************************************************/
+static void fapp_bench_tcp_tx (struct fapp_bench_params *params)
+{
+    int                         send_result;
+    char                        ip_str[FNET_IP_ADDR_STR_SIZE];
+    int                         exit_flag = 0;
+    int                         sock_err ;
+    int                         option_len;
+    fnet_shell_desc_t           desc = params->desc;
+    int                         packet_size = params->packet_size;
+    int                         iterations = params->iteration_number;
+    int                         streams = params->stream_number;
+    struct fapp_bench_stream    *stream;
+    int                         done;
+    int                         i;
 	
     if(packet_size > FAPP_BENCH_BUFFER_SIZE) /* Check max size.*/
 	     packet_size = FAPP_BENCH_BUFFER_SIZE;
@@ -527,125 +998,105 @@ static void fapp_bench_tcp_tx (struct fapp_bench_tx_params *params)
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     fnet_shell_println(desc, " TCP TX Test" );
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
-    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_S, "Remote IP Addr", fnet_inet_ntop(family, params->foreign_addr.sa_data, ip_str, sizeof(ip_str)));
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_S, "Remote IP Addr", fnet_inet_ntop(params->foreign_addr.sa_family, params->foreign_addr.sa_data, ip_str, sizeof(ip_str)));
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Remote Port", fnet_ntohs(params->foreign_addr.sa_port));
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Message Size", params->packet_size);
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Num. of messages", params->packet_number);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Num. of streams", params->stream_number);
     fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Num. of iterations", params->iteration_number);
     fnet_shell_println(desc, FAPP_TOCANCEL_STR);
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     
+    if(params->csv)
+        fnet_shell_println(desc, FAPP_BENCH_CSV_HEADER);
     
     while(iterations--)
     {
-        /* Create socket */
-        if((fapp_bench.socket_foreign = socket(family, SOCK_STREAM, 0)) == SOCKET_INVALID)
-        {
-            FNET_DEBUG("BENCH: Socket creation error.\n");
-            iterations = 0;
-            goto ERROR_1;
-        }
-        
-        /* Set Socket options. */
-        if( /* Setup linger option. */
-            (setsockopt (fapp_bench.socket_foreign, SOL_SOCKET, SO_LINGER, (char *)&linger_option, sizeof(linger_option)) == SOCKET_ERROR) ||
-            /* Set socket buffer size. */
-            (setsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_RCVBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-            (setsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_SNDBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-            /* Enable keepalive_option option. */
-            (setsockopt (fapp_bench.socket_foreign, SOL_SOCKET, SO_KEEPALIVE, (char *)&keepalive_option, sizeof(keepalive_option)) == SOCKET_ERROR) ||
-            /* Keepalive probe retransmit limit. */
-            (setsockopt (fapp_bench.socket_foreign, IPPROTO_TCP, TCP_KEEPCNT, (char *)&keepcnt_option, sizeof(keepcnt_option)) == SOCKET_ERROR) ||
-            /* Keepalive retransmit interval.*/
-            (setsockopt (fapp_bench.socket_foreign, IPPROTO_TCP, TCP_KEEPINTVL, (char *)&keepintvl_option, sizeof(keepintvl_option)) == SOCKET_ERROR) ||
-            /* Time between keepalive probes.*/
-            (setsockopt (fapp_bench.socket_foreign, IPPROTO_TCP, TCP_KEEPIDLE, (char *)&keepidle_option, sizeof(keepidle_option)) == SOCKET_ERROR)
-          )
-        {
-            FNET_DEBUG("BENCH: Socket setsockopt error.\n");
-            iterations = 0;
-            goto ERROR_2;		
-        }
-    
-        /* Connect to the server.*/
-        fnet_shell_println(desc,"Connecting.");
+        /* Connect the streams.*/
+        if(!params->csv)
+            fnet_shell_println(desc,"Connecting.");
 
-        foreign_addr = params->foreign_addr;
-        
-        connect(fapp_bench.socket_foreign, (struct sockaddr *)(&foreign_addr), sizeof(foreign_addr)); 
-        
-        do
+        for(i = 0; i < streams; i++)
         {
-            option_len = sizeof(connection_state); 
-            getsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_STATE, (char*)&connection_state, &option_len);
+            stream = &fapp_bench.streams[i];
+            stream->offset = 0;
+            stream->messages = 0;
+
+            if((stream->socket = fapp_bench_tcp_connect(params)) == SOCKET_INVALID)
+            {
+                fnet_shell_println(desc, "Connection failed.");
+                iterations = 0;
+                streams = i; /* Close the connected ones.*/
+                goto ERROR_2;
+            }
         }
-        while (connection_state == SS_CONNECTING);
-        
-        if(connection_state != SS_CONNECTED)
-        {
-           fnet_shell_println(desc, "Connection failed.");
-           iterations = 0;
-           goto ERROR_2;
-        } 
         
         /* Sending.*/
-        fnet_shell_println(desc,"Sending."); 
-        fapp_bench.bytes = 0;
-        fapp_bench.remote_bytes = 0;
-        cur_packet_number = 0;
-        buffer_offset = 0;
+        if(!params->csv)
+            fnet_shell_println(desc,"Sending."); 
+        fapp_bench_reset();
         
-        fapp_bench.first_time = fnet_timer_ticks();
+        fapp_bench_stamp(&fapp_bench.first_time);
         
         while(1)
         {
-            send_result = send( fapp_bench.socket_foreign, (char*)(&fapp_bench.buffer[buffer_offset]), (packet_size-buffer_offset), 0);
-            fapp_bench.last_time = fnet_timer_ticks();
-             
-            if ( send_result == SOCKET_ERROR )
-            {              
-                option_len = sizeof(sock_err); 
-                getsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_ERROR, (char*)&sock_err, &option_len);
-                fnet_shell_println(desc, "Socket error = %d", sock_err);
-                
-                iterations = 0;
-                #if 0
-                    /* Print benchmark results.*/
-                    fapp_bench_print_results (desc);           			
-                #endif
-                break;
-            }
-            else if(send_result)
+            done = FNET_TRUE;
+
+            for(i = 0; i < streams; i++)
             {
-                fapp_bench.bytes += send_result;
-                buffer_offset += send_result;
-                
-                if(buffer_offset == packet_size)
+                stream = &fapp_bench.streams[i];
+
+                if(stream->messages < params->packet_number)
                 {
-                    cur_packet_number ++;
-                    buffer_offset = 0;
+                    done = FNET_FALSE;
+
+                    send_result = send( stream->socket, (char*)(&fapp_bench.buffer[stream->offset]), (packet_size - stream->offset), 0);
+                     
+                    if ( send_result == SOCKET_ERROR )
+                    {              
+                        option_len = sizeof(sock_err); 
+                        getsockopt(stream->socket, SOL_SOCKET, SO_ERROR, (char*)&sock_err, &option_len);
+                        fnet_shell_println(desc, "Socket error = %d", sock_err);
+                        
+                        iterations = 0;
+                        goto ERROR_2;
+                    }
+                    else if(send_result)
+                    {
+                        fapp_bench.bytes += send_result;
+                        stream->offset += send_result;
+                        
+                        if(stream->offset == packet_size)
+                        {
+                            stream->messages ++;
+                            stream->offset = 0;
+                        }
+                    }
                 }
+            }
+
+            fapp_bench_stamp(&fapp_bench.last_time);
                 
-                exit_flag = fnet_shell_ctrlc(desc); /* Check [Ctrl+c]*/
+            exit_flag = fnet_shell_ctrlc(desc); /* Check [Ctrl+c]*/
                 
-                if((cur_packet_number >= params->packet_number)|| exit_flag)
-                { 
-                    if(exit_flag)
-                    {
-                        fnet_shell_println(desc, FAPP_SHELL_CANCELED_CTRL_C);
-                        iterations = 0;
-                    }
-                    /* Print benchmark results.*/
-                    fapp_bench_print_results (desc);
-                    break;
+            if(done || exit_flag)
+            { 
+                if(exit_flag)
+                {
+                    fnet_shell_println(desc, FAPP_SHELL_CANCELED_CTRL_C);
+                    iterations = 0;
                 }
+                /* Print benchmark results.*/
+                fapp_bench_print_results (params, FNET_TRUE);
+                break;
             }
         }
 
 ERROR_2:
-        closesocket(fapp_bench.socket_foreign);
+        for(i = 0; i < streams; i++)
+            closesocket(fapp_bench.streams[i].socket);
     }
-ERROR_1:
+
     fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
 }
 
@@ -654,15 +1105,12 @@ ERROR_1:
 *
 * DESCRIPTION: Start TX TCP Benchmark. 
 ************************************************************************/
-static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params)
+static void fapp_bench_udp_tx (struct fapp_bench_params *params)
 {
 	int                     send_result;
 	char                    ip_str[FNET_IP_ADDR_STR_SIZE];
 	int                     i;
 	int                     received;
-    const struct linger     linger_option ={1, /*l_onoff*/
-                                            4  /*l_linger*/};
-    const unsigned long     bufsize_option = FAPP_BENCH_SOCKET_BUF_SIZE;
     struct sockaddr         foreign_addr;
     int                     exit_flag = 0;
     int                     sock_err;
@@ -691,6 +1139,9 @@ static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params)
     fnet_shell_println(desc, FAPP_TOCANCEL_STR);
     fnet_shell_println(desc, FAPP_DELIMITER_STR);
     
+    if(params->csv)
+        fnet_shell_println(desc, FAPP_BENCH_CSV_HEADER);
+    
     while(iterations--)
     {
         /* Create socket */
@@ -702,20 +1153,15 @@ static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params)
         }
         
         /* Set Socket options. */
-        if( /* Setup linger option. */
-            (setsockopt (fapp_bench.socket_foreign, SOL_SOCKET, SO_LINGER, (char *)&linger_option, sizeof(linger_option)) == SOCKET_ERROR) ||
-            /* Set socket buffer size. */
-            (setsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_RCVBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) ||
-            (setsockopt(fapp_bench.socket_foreign, SOL_SOCKET, SO_SNDBUF, (char *) &bufsize_option, sizeof(bufsize_option))== SOCKET_ERROR) 
-          )
+        if(fapp_bench_socket_options(fapp_bench.socket_foreign, params, SOCK_DGRAM) == FNET_ERR)
         {
-            FNET_DEBUG("BENCH: Socket setsockopt error.\n");
             iterations = 0;
             goto ERROR_2;		
         }
         
         /* Bind to the server.*/
-        fnet_shell_println(desc,"Connecting.");
+        if(!params->csv)
+            fnet_shell_println(desc,"Connecting.");
 
         foreign_addr = params->foreign_addr;
         
@@ -727,17 +1173,17 @@ static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params)
         } 
     
         /* Sending.*/
-        fnet_shell_println(desc,"Sending."); 
-        fapp_bench.bytes = 0;
-        fapp_bench.remote_bytes = 0;
+        if(!params->csv)
+            fnet_shell_println(desc,"Sending."); 
+        fapp_bench_reset();
         cur_packet_number = 0;
         
-        fapp_bench.first_time = fnet_timer_ticks();
+        fapp_bench_stamp(&fapp_bench.first_time);
         
         while(1)
         {
             send_result = send( fapp_bench.socket_foreign, (char*)(&fapp_bench.buffer[0]), packet_size, 0);
-            fapp_bench.last_time = fnet_timer_ticks();
+            fapp_bench_stamp(&fapp_bench.last_time);
             
             
             if ( send_result == SOCKET_ERROR )
@@ -794,7 +1240,7 @@ static void fapp_bench_udp_tx (struct fapp_bench_tx_params *params)
         }
         
         /* Print benchmark results.*/
-        fapp_bench_print_results (desc);
+        fapp_bench_print_results (params, FNET_TRUE);
 
 ERROR_2:
         closesocket(fapp_bench.socket_foreign);
@@ -804,6 +1250,218 @@ ERROR_1:
     fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
 }
 
+/************************************************************************
+* NAME: fapp_bench_rr_transaction
+*
+* DESCRIPTION: Sends a request and receives its response. 
+************************************************************************/
+static int fapp_bench_rr_transaction (struct fapp_bench_params *params, SOCKET s)
+{
+    unsigned long   header[FAPP_BENCH_RR_HEADER_SIZE/sizeof(unsigned long)];
+    unsigned long   request_size = (unsigned long)params->packet_size;
+    unsigned long   response_size = (unsigned long)params->response_size;
+    unsigned long   start = fnet_timer_ticks();
+    unsigned long   timeout = fnet_timer_ms2ticks(FAPP_BENCH_RR_TIMEOUT_MS);
+    unsigned long   done;
+    unsigned long   size;
+    int             result;
+
+    /* Request header.*/
+    header[0] = fnet_htonl(request_size);
+    header[1] = fnet_htonl(response_size);
+    fnet_memcpy(&fapp_bench.buffer[0], header, FAPP_BENCH_RR_HEADER_SIZE);
+
+    /* Request.*/
+    for(done = 0; done < request_size; done += (unsigned long)result)
+    {
+        if(((result = send(s, &fapp_bench.buffer[done], (int)(request_size - done), 0)) == SOCKET_ERROR)
+            || (fnet_timer_get_interval(start, fnet_timer_ticks()) > timeout))
+            return FNET_ERR;
+    }
+
+    /* Response.*/
+    for(done = 0; done < response_size; done += (unsigned long)result)
+    {
+        size = response_size - done;
+        if(size > FAPP_BENCH_BUFFER_SIZE)
+            size = FAPP_BENCH_BUFFER_SIZE;
+
+        if(((result = recv(s, &fapp_bench.buffer[0], (int)size, 0)) == SOCKET_ERROR)
+            || (fnet_timer_get_interval(start, fnet_timer_ticks()) > timeout))
+            return FNET_ERR;
+    }
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fapp_bench_rr_tx
+*
+* DESCRIPTION: Start TCP request/response Benchmark. 
+*              In the CRR mode, every transaction has its own connection.
+************************************************************************/
+static void fapp_bench_rr_tx (struct fapp_bench_params *params)
+{
+    char                    ip_str[FNET_IP_ADDR_STR_SIZE];
+    fnet_shell_desc_t       desc = params->desc;
+    int                     iterations = params->iteration_number;
+    struct fapp_bench_stamp start;
+    struct fapp_bench_stamp end;
+    int                     crr = (params->mode == FAPP_BENCH_MODE_CRR);
+    int                     exit_flag = 0;
+
+    fapp_bench.socket_foreign = SOCKET_INVALID;
+
+    /* ------ Start test.----------- */
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+    fnet_shell_println(desc, crr ? " TCP CRR Test" : " TCP RR Test");
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_S, "Remote IP Addr", fnet_inet_ntop(params->foreign_addr.sa_family, params->foreign_addr.sa_data, ip_str, sizeof(ip_str)));
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Remote Port", fnet_ntohs(params->foreign_addr.sa_port));
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Request Size", params->packet_size);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Response Size", params->response_size);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Num. of transactions", params->packet_number);
+    fnet_shell_println(desc, FAPP_SHELL_INFO_FORMAT_D, "Num. of iterations", params->iteration_number);
+    fnet_shell_println(desc, FAPP_TOCANCEL_STR);
+    fnet_shell_println(desc, FAPP_DELIMITER_STR);
+
+    if(params->csv)
+        fnet_shell_println(desc, FAPP_BENCH_CSV_HEADER);
+
+    while(iterations--)
+    {
+        fapp_bench_reset();
+
+        if(!crr)
+        {
+            if(!params->csv)
+                fnet_shell_println(desc,"Connecting.");
+
+            if((fapp_bench.socket_foreign = fapp_bench_tcp_connect(params)) == SOCKET_INVALID)
+            {
+                fnet_shell_println(desc, "Connection failed.");
+                break;
+            }
+        }
+
+        if(!params->csv)
+            fnet_shell_println(desc,"Sending requests."); 
+
+        fapp_bench_stamp(&fapp_bench.first_time);
+
+        while(fapp_bench.transactions < (unsigned long)params->packet_number)
+        {
+            fapp_bench_stamp(&start);
+
+            if(crr && ((fapp_bench.socket_foreign = fapp_bench_tcp_connect(params)) == SOCKET_INVALID))
+            {
+                fnet_shell_println(desc, "Connection failed.");
+                iterations = 0;
+                break;
+            }
+
+            if(fapp_bench_rr_transaction(params, fapp_bench.socket_foreign) == FNET_ERR)
+            {
+                fnet_shell_println(desc, "Transaction failed.");
+                iterations = 0;
+                break;
+            }
+
+            if(crr)
+            {
+                closesocket(fapp_bench.socket_foreign);
+                fapp_bench.socket_foreign = SOCKET_INVALID;
+            }
+
+            fapp_bench_stamp(&end);
+            fapp_bench_latency_add(fapp_bench_interval_us(&start, &end));
+            fapp_bench.bytes += (unsigned long)(params->packet_size + params->response_size);
+                
+            exit_flag = fnet_shell_ctrlc(desc); /* Check [Ctrl+c]*/
+
+            if(exit_flag)
+            {
+                fnet_shell_println(desc, FAPP_SHELL_CANCELED_CTRL_C);
+                iterations = 0;
+                break;
+            }
+        }
+
+        fapp_bench_stamp(&fapp_bench.last_time);
+
+        if(fapp_bench.socket_foreign != SOCKET_INVALID)
+        {
+            closesocket(fapp_bench.socket_foreign);
+            fapp_bench.socket_foreign = SOCKET_INVALID;
+        }
+
+        /* Print benchmark results.*/
+        if(fapp_bench.transactions)
+            fapp_bench_print_results (params, FNET_TRUE);
+    }
+
+    fnet_shell_println(desc, FAPP_BENCH_COMPLETED_STR);
+}
+
+/************************************************************************
+* NAME: fapp_bench_options
+*
+* DESCRIPTION: Parses the optional "<name> <value>" parameters, 
+*              starting from argv[i]. 
+************************************************************************/
+static int fapp_bench_options (fnet_shell_desc_t desc, int argc, char ** argv, int i, struct fapp_bench_params *params)
+{
+    unsigned long   value;
+    char            *p;
+
+    params->sndbuf = FAPP_BENCH_SOCKET_BUF_SIZE;
+    params->rcvbuf = FAPP_BENCH_SOCKET_BUF_SIZE;
+
+    for(; i < argc; i++)
+    {
+        if(fnet_strcasecmp("csv", argv[i]) == 0)
+        {
+            params->csv = FNET_TRUE;
+            continue;
+        }
+
+        if(i + 1 == argc)
+            goto ERROR_PARAMETER;
+
+        value = fnet_strtoul(argv[i + 1], &p, 0);
+        if(*p || ((value == 0) && fnet_strcasecmp("response", argv[i]))) /* Only the response may be empty.*/
+        {
+            i++;
+            goto ERROR_PARAMETER;
+        }
+
+        if(fnet_strcasecmp("streams", argv[i]) == 0)
+        {
+            if(value > FAPP_BENCH_STREAMS_MAX)
+            {
+                i++;
+                goto ERROR_PARAMETER;
+            }
+            params->stream_number = (int)value;
+        }
+        else if(fnet_strcasecmp("response", argv[i]) == 0)
+            params->response_size = (int)value;
+        else if(fnet_strcasecmp("sndbuf", argv[i]) == 0)
+            params->sndbuf = value;
+        else if(fnet_strcasecmp("rcvbuf", argv[i]) == 0)
+            params->rcvbuf = value;
+        else
+            goto ERROR_PARAMETER;
+
+        i++;
+    }
+
+    return FNET_OK;
+
+ERROR_PARAMETER:
+    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[i]);
+    return FNET_ERR;
+}
 
 /************************************************************************
 * NAME: fapp_benchtx_cmd
@@ -812,9 +1470,14 @@ ERROR_1:
 ************************************************************************/
 void fapp_benchtx_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
 {
-    struct fapp_bench_tx_params bench_params;
+    struct fapp_bench_params    bench_params;
+    int                         *positional[3];
+    int                         value;
+    char                        *p;
+    int                         i = 2;
+    int                         n = 0;
 
-    fnet_memset_zero(&bench_params.foreign_addr, sizeof(bench_params.foreign_addr));
+    fnet_memset_zero(&bench_params, sizeof(bench_params));
        
     if(fnet_inet_ptos(argv[1], &bench_params.foreign_addr) == FNET_OK)
     {
@@ -822,60 +1485,84 @@ void fapp_benchtx_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
 
         bench_params.foreign_addr.sa_port = FAPP_BENCH_PORT;
         
+        bench_params.mode = FAPP_BENCH_MODE_TCP;
         bench_params.packet_size = FAPP_BENCH_TX_PACKET_SIZE_DEFAULT;
         bench_params.packet_number = FAPP_BENCH_TX_PACKET_NUMBER_DEFAULT;
         bench_params.iteration_number = FAPP_BENCH_TX_ITERATION_NUMBER_DEFAULT;
+        bench_params.stream_number = 1;
         
-        if(argc > 3)
+        /* Mode.*/
+        if(argc > 2)
         {
-            char *p = 0;
-            
-            /* Packet size.*/
-            bench_params.packet_size = (int)fnet_strtoul(argv[3], &p, 0);
-            if ((bench_params.packet_size == 0) || (bench_params.packet_size > FAPP_BENCH_PACKET_SIZE_MAX))
+            if(fnet_strcasecmp("tcp", argv[2]) == 0)
+                i++;
+            else if(fnet_strcasecmp("udp", argv[2]) == 0)
             {
-                fnet_shell_println(desc, FAPP_PARAM_ERR, argv[3]); /* Print error mesage. */
-                return;
+                bench_params.mode = FAPP_BENCH_MODE_UDP;
+                i++;
             }
-            
-            /* Number of packets.*/
-            if(argc > 4)
+            else if((fnet_strcasecmp("rr", argv[2]) == 0) || (fnet_strcasecmp("crr", argv[2]) == 0))
             {
-                bench_params.packet_number = (int)fnet_strtoul(argv[4], &p, 0);
-                if (bench_params.packet_number == 0)
-                {
-                    fnet_shell_println(desc, FAPP_PARAM_ERR, argv[4]); /* Print error mesage. */
-                    return;
-                }
-                
-                /* Number of iterations.*/
-                if(argc > 5)
-                {
-                    bench_params.iteration_number = (int)fnet_strtoul(argv[5], &p, 0);
-                    if ((bench_params.iteration_number < 1) || (bench_params.iteration_number > FAPP_BENCH_TX_ITERATION_NUMBER_MAX) )
-                    {
-                        fnet_shell_println(desc, FAPP_PARAM_ERR, argv[5]); /* Print error mesage. */
-                        return;
-                    }
-                }
+                bench_params.mode = (fnet_strcasecmp("rr", argv[2]) == 0) ? FAPP_BENCH_MODE_RR : FAPP_BENCH_MODE_CRR;
+                bench_params.packet_size = FAPP_BENCH_RR_SIZE_DEFAULT;
+                bench_params.packet_number = FAPP_BENCH_RR_NUMBER_DEFAULT;
+                bench_params.response_size = FAPP_BENCH_RR_SIZE_DEFAULT;
+                i++;
             }
-        } 
-        
-        /* TCP */
-        if((argc == 2)||(argc >= 3 && fnet_strcasecmp("tcp", argv[2]) == 0)) 
+        }
+
+        /* Message size, number of messages and number of iterations.*/
+        positional[0] = &bench_params.packet_size;
+        positional[1] = &bench_params.packet_number;
+        positional[2] = &bench_params.iteration_number;
+
+        for(; (i < argc) && (n < 3); i++, n++)
         {
-            fapp_bench_tcp_tx (&bench_params);
+            value = (int)fnet_strtoul(argv[i], &p, 0);
+            if(*p)
+                break; /* Not a number, an option.*/
+
+            if((value < 1) 
+                || ((n == 0) && (value > FAPP_BENCH_PACKET_SIZE_MAX)) 
+                || ((n == 2) && (value > FAPP_BENCH_TX_ITERATION_NUMBER_MAX)))
+            {
+                fnet_shell_println(desc, FAPP_PARAM_ERR, argv[i]); /* Print error mesage. */
+                return;
+            }
+
+            *positional[n] = value;
         }
-        /* UDP */
-        else if(argc >= 3 && fnet_strcasecmp("udp", argv[2]) == 0) 
+        
+        if(fapp_bench_options(desc, argc, argv, i, &bench_params) == FNET_ERR)
+            return;
+
+        if((bench_params.mode == FAPP_BENCH_MODE_RR) || (bench_params.mode == FAPP_BENCH_MODE_CRR)) 
         {
-            fapp_bench_udp_tx (&bench_params);
+            if(bench_params.packet_size < FAPP_BENCH_RR_HEADER_SIZE)
+                bench_params.packet_size = FAPP_BENCH_RR_HEADER_SIZE;
         }
         else
         {
-            fnet_shell_println(desc, FAPP_PARAM_ERR, argv[2]);
+            bench_params.response_size = 0; /* No response in the bulk modes.*/
+        }
+
+#if FAPP_CFG_BENCH_CYCLES
+        FNET_CFG_LATENCY_CYCLES_INIT();
+#endif
+
+        switch(bench_params.mode)
+        {
+            case FAPP_BENCH_MODE_UDP:
+                fapp_bench_udp_tx (&bench_params);
+                break;
+            case FAPP_BENCH_MODE_RR:
+            case FAPP_BENCH_MODE_CRR:
+                fapp_bench_rr_tx (&bench_params);
+                break;
+            default:
+                fapp_bench_tcp_tx (&bench_params);
+                break;
         }
-                
     }
     else
     {
@@ -886,17 +1573,3 @@ void fapp_benchtx_cmd( fnet_shell_desc_t desc, int argc, char ** argv )
 
 
 #endif /* FAPP_CFG_BENCH_CMD */
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -60,6 +60,11 @@
 #define FAPP_BENCH_TX_PACKET_NUMBER_DEFAULT     (10000)
 #define FAPP_BENCH_TX_ITERATION_NUMBER_DEFAULT  (1)
 #define FAPP_BENCH_TX_ITERATION_NUMBER_MAX      (10000)
+#define FAPP_BENCH_STREAMS_MAX                  (4)         /* Maximum number of parallel TCP streams.*/
+#define FAPP_BENCH_LATENCY_SAMPLES              (512)       /* Number of latency samples, used for the percentiles.*/
+#define FAPP_BENCH_RR_HEADER_SIZE               (8)         /* Request header: request size and response size (32-bit, network byte order).*/
+#define FAPP_BENCH_RR_SIZE_DEFAULT              (64)        /* Default request and response size.*/
+#define FAPP_BENCH_RR_NUMBER_DEFAULT            (1000)      /* Default number of transactions.*/
 
 
 void fapp_benchrx_cmd( fnet_shell_desc_t desc, int argc, char ** );
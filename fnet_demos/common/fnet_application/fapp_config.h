@@ -309,6 +309,12 @@
     #define FAPP_CFG_BENCH_CMD          (0)
 #endif 
 
+/* Short benchmark intervals and latencies are measured 
+ * by the CPU cycle counter (FNET_CFG_LATENCY_CYCLES()), if it is available.*/
+#ifndef FAPP_CFG_BENCH_CYCLES
+    #define FAPP_CFG_BENCH_CYCLES       (FNET_MK || FNET_STM32)
+#endif 
+
 /************************************************************************
 *    "reinit" command. Used to test FNET release/init only.
 *************************************************************************/
@@ -344,6 +350,76 @@
     #define FAPP_CFG_UNBIND_CMD         (0)
 #endif
 
+/************************************************************************
+*    "route" command.
+*************************************************************************/
+#ifndef FAPP_CFG_ROUTE_CMD
+    #define FAPP_CFG_ROUTE_CMD          (0)
+#endif
+
+/************************************************************************
+*    "arp" command.
+*************************************************************************/
+#ifndef FAPP_CFG_ARP_CMD
+    #define FAPP_CFG_ARP_CMD            (0)
+#endif
+
+/************************************************************************
+*    "netstat" command.
+*************************************************************************/
+#ifndef FAPP_CFG_NETSTAT_CMD
+    #define FAPP_CFG_NETSTAT_CMD        (0)
+#endif
+
+/************************************************************************
+*    "sockets" command.
+*************************************************************************/
+#ifndef FAPP_CFG_SOCKETS_CMD
+    #define FAPP_CFG_SOCKETS_CMD        (0)
+#endif
+
+/************************************************************************
+*    "trace" command.
+*************************************************************************/
+#ifndef FAPP_CFG_TRACE_CMD
+    #define FAPP_CFG_TRACE_CMD          (0)
+#endif
+
+/************************************************************************
+*    "capture" command.
+*************************************************************************/
+#ifndef FAPP_CFG_CAPTURE_CMD
+    #define FAPP_CFG_CAPTURE_CMD        (0)
+#endif
+
+/************************************************************************
+*    "latency" command.
+*************************************************************************/
+#ifndef FAPP_CFG_LATENCY_CMD
+    #define FAPP_CFG_LATENCY_CMD        (0)
+#endif
+
+/************************************************************************
+*    "locks" command.
+*************************************************************************/
+#ifndef FAPP_CFG_LOCKS_CMD
+    #define FAPP_CFG_LOCKS_CMD          (0)
+#endif
+
+/************************************************************************
+*    "heap" command.
+*************************************************************************/
+#ifndef FAPP_CFG_HEAP_CMD
+    #define FAPP_CFG_HEAP_CMD           (0)
+#endif
+
+/************************************************************************
+*    "ubench" command.
+*************************************************************************/
+#ifndef FAPP_CFG_UBENCH_CMD
+    #define FAPP_CFG_UBENCH_CMD         (0)
+#endif
+
 /************************************************************************
 *    "ping" command.
 *************************************************************************/
@@ -450,6 +526,11 @@
     #define FAPP_CFG_TFTPS_AFTER_WRITE_REQUEST_SCRIPT   ""
 #endif
 
+/* File name of the frame capture (FNET_CFG_CAPTURE), read from the TFTP server.*/
+#ifndef FAPP_CFG_TFTPS_CAPTURE_FILE
+    #define FAPP_CFG_TFTPS_CAPTURE_FILE     "capture.pcap"
+#endif
+
 
 /************************************************************************
 *    TFTP data handlers
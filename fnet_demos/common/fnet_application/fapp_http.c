@@ -106,6 +106,14 @@ int fapp_http_cgi_graph_handle(char * query, long *cookie);
 #if FNET_CFG_HTTP_POST
 int fapp_http_cgi_post_handle(char * query, long *cookie);
 #endif
+#if FAPP_NETSTAT
+static int fapp_http_cgi_netstat_handle(char * query, long *cookie);
+static unsigned long fapp_http_cgi_netstat_respond(char * buffer, unsigned long buffer_size, char * eof, long *cookie);
+#endif
+#if FNET_CFG_CAPTURE
+static int fapp_http_cgi_capture_handle(char * query, long *cookie);
+static unsigned long fapp_http_cgi_capture_respond(char * buffer, unsigned long buffer_size, char * eof, long *cookie);
+#endif
 
 /* CGI table */
 static const struct fnet_http_cgi fapp_cgi_table[] =
@@ -115,9 +123,18 @@ static const struct fnet_http_cgi fapp_cgi_table[] =
 #if FNET_CFG_HTTP_POST    
     {"post.cgi", fapp_http_cgi_post_handle, fapp_http_string_buffer_respond},   
 #endif    
+#if FAPP_NETSTAT
+    {"netstat.cgi", fapp_http_cgi_netstat_handle, fapp_http_cgi_netstat_respond},
+#endif
+#if FNET_CFG_CAPTURE
+    {"capture.cgi", fapp_http_cgi_capture_handle, fapp_http_cgi_capture_respond},
+#endif
     {0, 0, 0} /* End of the table. */
 };
 static char fapp_http_cgi_buffer[CGI_MAX]; /* CGI Temporary buffer. */
+#if FAPP_NETSTAT
+static struct fnet_stats fapp_http_cgi_netstat; /* Statistics snapshot. */
+#endif
 
 #endif /* FNET_CFG_HTTP_CGI */
 
@@ -356,6 +373,104 @@ static int fapp_http_cgi_post_handle(char * query, long *cookie)
 }
 #endif
 
+#if FAPP_NETSTAT
+/************************************************************************
+* NAME: fapp_http_cgi_netstat_handle
+*
+* DESCRIPTION: Takes the protocol statistics snapshot.
+*************************************************************************/
+static int fapp_http_cgi_netstat_handle(char * query, long *cookie)
+{
+    FNET_COMP_UNUSED_ARG(query);
+
+    fnet_stats_get(&fapp_http_cgi_netstat);
+
+    *cookie = 0; /* Index of the next fapp_netstat_table[] entry.*/
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fapp_http_cgi_netstat_respond
+*
+* DESCRIPTION: Sends the statistics snapshot as a JSON object, 
+*              entry by entry, ({"ip":{"InReceives":1,...},...}).
+*************************************************************************/
+static unsigned long fapp_http_cgi_netstat_respond(char * buffer, unsigned long buffer_size, char * eof, long *cookie)
+{
+    unsigned long                   result = 0;
+    unsigned long                   size;
+    const struct fapp_netstat_entry *entry;
+
+    *eof = 0;
+
+    while(buffer && (result < buffer_size))
+    {
+        entry = &fapp_netstat_table[*cookie];
+
+        /* Write the entry to the temprorary buffer. */
+        if(entry->name == 0)
+            fnet_snprintf(fapp_http_cgi_buffer, sizeof(fapp_http_cgi_buffer), "}})");
+        else if(entry->offset == FAPP_NETSTAT_GROUP)
+            fnet_snprintf(fapp_http_cgi_buffer, sizeof(fapp_http_cgi_buffer), "%s\"%s\":{", (*cookie == 0) ? "({" : "},", entry->name);
+        else
+            fnet_snprintf(fapp_http_cgi_buffer, sizeof(fapp_http_cgi_buffer), "%s\"%s\":%u", 
+                          (entry[-1].offset == FAPP_NETSTAT_GROUP) ? "" : ",", entry->name,
+                          *(unsigned long *)((char *)&fapp_http_cgi_netstat + entry->offset));
+
+        size = fnet_strlen(fapp_http_cgi_buffer);
+        if(size > (buffer_size - result))
+            break; /* Next iteration.*/
+
+        fnet_memcpy(&buffer[result], fapp_http_cgi_buffer, size);
+        result += size;
+
+        if(entry->name == 0)
+        {
+            *eof = 1; /* The end.*/
+            break;
+        }
+        (*cookie)++;
+    }
+
+    return result;
+}
+#endif /* FAPP_NETSTAT */
+
+#if FNET_CFG_CAPTURE
+/************************************************************************
+* NAME: fapp_http_cgi_capture_handle
+*
+* DESCRIPTION: Stops the frame capture, to keep its file consistent
+*              while it is sent.
+*************************************************************************/
+static int fapp_http_cgi_capture_handle(char * query, long *cookie)
+{
+    FNET_COMP_UNUSED_ARG(query);
+
+    fnet_capture_stop();
+
+    *cookie = 0; /* Offset in the capture file.*/
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fapp_http_cgi_capture_respond
+*
+* DESCRIPTION: Sends the frame capture as a pcap file.
+*************************************************************************/
+static unsigned long fapp_http_cgi_capture_respond(char * buffer, unsigned long buffer_size, char * eof, long *cookie)
+{
+    unsigned long result = fnet_capture_read((unsigned long)*cookie, buffer, buffer_size);
+
+    *cookie += result;
+    *eof = (result < buffer_size);
+
+    return result;
+}
+#endif /* FNET_CFG_CAPTURE */
+
 #endif /*FNET_CFG_HTTP_CGI*/
 
 
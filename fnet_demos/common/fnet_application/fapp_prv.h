@@ -83,11 +83,36 @@ void fapp_reset_cmd( fnet_shell_desc_t desc, int argc, char ** argv );
 void fapp_go_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
 void fapp_bind_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
 void fapp_unbind_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_route_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_arp_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_netstat_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_sockets_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_trace_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_capture_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_latency_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_locks_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_heap_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
+void fapp_ubench_cmd ( fnet_shell_desc_t desc, int argc, char ** argv );
 void fapp_netif_addr_print(fnet_shell_desc_t desc, fnet_address_family_t family, fnet_netif_desc_t netif, int print_type);
 
 extern fnet_netif_desc_t fapp_default_netif;
 extern const struct fnet_shell_command fapp_cmd_table [];
 
+/* Protocol statistics names, used by the "netstat" command and the HTTP CGI. */
+#define FAPP_NETSTAT    (FNET_CFG_STATS && (FAPP_CFG_NETSTAT_CMD || (FAPP_CFG_HTTP_CMD && FNET_CFG_HTTP && FNET_CFG_HTTP_CGI)))
+
+#if FAPP_NETSTAT
+#define FAPP_NETSTAT_GROUP      (0xFFFFu) /* The entry starts a counter group.*/
+
+struct fapp_netstat_entry
+{
+    const char      *name;      /* Counter name, or group name.*/
+    unsigned short  offset;     /* Counter offset in the fnet_stats, or FAPP_NETSTAT_GROUP.*/
+};
+
+extern const struct fapp_netstat_entry fapp_netstat_table[]; /* Terminated by the zero name.*/
+#endif
+
 /* Boot mode structure. */
 struct boot_mode
 {
@@ -104,6 +104,11 @@ static fapp_tftp_handler_control_t fapp_tftps_handler_control;
 
 static fnet_tftp_srv_desc_t fapp_tftp_srv_desc = 0; /* TFTP server descriptor. */
 
+#if FNET_CFG_CAPTURE
+static int fapp_tftps_capture;                  /* The frame capture is being read. */
+static unsigned long fapp_tftps_capture_offset; /* Offset in the capture file. */
+#endif
+
 #endif /* FAPP_CFG_TFTPS_CMD*/
 
 
@@ -909,7 +914,24 @@ static int fapp_tftps_request_handler(fnet_tftp_request_t request_type,
       
     FNET_COMP_UNUSED_ARG(mode);
     FNET_COMP_UNUSED_ARG(error_message); 
+
+#if FNET_CFG_CAPTURE
+    fapp_tftps_capture = FNET_FALSE;
     
+    /* Check Filename for the frame capture download. */
+    if((request_type == FNET_TFTP_REQUEST_READ) && (fnet_strcmp(FAPP_CFG_TFTPS_CAPTURE_FILE, filename) == 0))
+    {
+        fnet_capture_stop(); /* Keep the file consistent while it is read. */
+
+        fnet_shell_println(desc, FAPP_TFTP_TX_HEADER_STR, filename, "pcap", 
+                           fnet_inet_ntop(address->sa_family, (char*)(address->sa_data), ip_str, sizeof(ip_str)) ); 
+
+        fapp_tftps_capture = FNET_TRUE;
+        fapp_tftps_capture_offset = 0;
+        result = FNET_OK;
+    }
+    else
+#endif    
     /* Check Filename for firmware (up)load. */
     if(fnet_strcmp(fapp_params_tftp_config.file_name, filename) == 0)
     {
@@ -990,6 +1012,20 @@ static int fapp_tftps_data_handler(fnet_tftp_request_t request,
                 }
             }
     }
+#if FNET_CFG_CAPTURE
+    /* REQUEST_READ of the frame capture */
+    else if(fapp_tftps_capture)
+    {
+        result = (int)fnet_capture_read(fapp_tftps_capture_offset, data_ptr, data_size);
+        fapp_tftps_capture_offset += result;
+        
+        /* Check EOF. */    
+        if(result < FNET_TFTP_DATA_SIZE_MAX)
+        {
+            fnet_shell_println(desc, FAPP_TFTP_COMPLETED_STR, fapp_tftps_capture_offset);  
+        }
+    }
+#endif
     /* REQUEST_READ */
     else 
     {
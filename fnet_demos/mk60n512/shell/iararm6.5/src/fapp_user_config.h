@@ -54,6 +54,10 @@
 /*  "unbind" command.*/
 #define FAPP_CFG_UNBIND_CMD             (1)
 
+/*  "route" command.*/
+#define FAPP_CFG_ROUTE_CMD              (1)
+#define FAPP_CFG_ARP_CMD                (1)
+
 /* Reading of the configuration parameters from the Flash 
  * memory during the application bootup.*/
 #define FAPP_CFG_PARAMS_READ_FLASH      (1)
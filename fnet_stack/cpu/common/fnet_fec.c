@@ -63,17 +63,37 @@
 
 #define FNET_FEC_ALIGN_DIV(div, x)     (((fnet_uint32)(x) + ((fnet_uint32)(div)-1))  & (~((fnet_uint32)(div)-1)))
 
+#define FNET_FEC_RX_TIMER_PERIOD           (FNET_TIMER_PERIOD_MS) /* ms */
+
+#if FNET_CFG_CPU_ETH_RX_COALESCE
+/* Rx interrupts per timer period, above which the coalescing threshold grows.*/
+#define FNET_FEC_RX_COALESCE_IRQ_HIGH      ((FNET_CFG_CPU_ETH_RX_COALESCE_IRQ_RATE*FNET_FEC_RX_TIMER_PERIOD)/1000)
+/* Maximum coalescing threshold, the half of the Rx ring.*/
+#define FNET_FEC_RX_COALESCE_MAX           (FNET_FEC_RX_BUF_NUM/2)
+#endif
+
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
 int fnet_fec_init(fnet_netif_t *netif);
 void fnet_fec_release(fnet_netif_t *netif);
 void fnet_fec_input(fnet_netif_t *netif);
+static int fnet_fec_input_budget(fnet_netif_t *netif, int budget);
+static void fnet_fec_rx_poll(fnet_netif_t *netif);
+static void fnet_fec_rx_continue(fnet_fec_if_t *ethif);
+static void fnet_fec_rx_event(void *cookie);
+static void fnet_fec_rx_timer(void *cookie);
+static int fnet_fec_rx_batch_ready(fnet_fec_if_t *ethif);
+static int fnet_fec_rx_ready(fnet_fec_if_t *ethif, int frames);
 static void fnet_fec_rx_buf_next( fnet_fec_if_t *ethif);
 
 /* FEC rx frame interrup handler. */
 static void fnet_fec_isr_rx_handler_top(void *cookie);
 static void fnet_fec_isr_rx_handler_bottom(void *cookie);
+#if FNET_CFG_ETH_TX_QUEUE
+static void fnet_fec_isr_tx_handler_top(void *cookie);
+static void fnet_fec_isr_tx_handler_bottom(void *cookie);
+#endif
 
 static void fnet_fec_get_mac_addr(fnet_fec_if_t *ethif, fnet_mac_addr_t *mac_addr);
 
@@ -156,6 +176,9 @@ int fnet_fec_init(fnet_netif_t *netif)
     		ethif->reg = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;  /* Set FEC module base refister pointer.*/
     		ethif->reg_phy = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;
     		ethif->vector_number = FNET_CFG_CPU_ETH0_VECTOR_NUMBER;       /* Set RX Frame interrupt number.*/
+        #if FNET_CFG_ETH_TX_QUEUE
+    		ethif->tx_vector_number = FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER; /* Set TX Frame interrupt number.*/
+        #endif
          	ethif->phy_addr = FNET_CFG_CPU_ETH0_PHY_ADDR;                 /* Set default PHY address */
     		break;
         #endif    		
@@ -164,6 +187,9 @@ int fnet_fec_init(fnet_netif_t *netif)
     		ethif->reg = (volatile fnet_fec_reg_t *)FNET_FEC1_BASE_ADDR;  /* Set FEC module base refister pointer.*/
     		ethif->reg_phy = (volatile fnet_fec_reg_t *)FNET_FEC0_BASE_ADDR;
     		ethif->vector_number = FNET_CFG_CPU_ETH1_VECTOR_NUMBER;       /* Set RX Frame interrupt number.*/
+        #if FNET_CFG_ETH_TX_QUEUE
+    		ethif->tx_vector_number = FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER; /* Set TX Frame interrupt number.*/
+        #endif
          	ethif->phy_addr = FNET_CFG_CPU_ETH1_PHY_ADDR;                 /* Set default PHY address */    		
     		break;
        #endif    		
@@ -223,9 +249,33 @@ int fnet_fec_init(fnet_netif_t *netif)
     
     /* Install RX Frame interrupt handler.*/
     result = fnet_isr_vector_init(ethif->vector_number, fnet_fec_isr_rx_handler_top, fnet_fec_isr_rx_handler_bottom, FNET_CFG_CPU_ETH_VECTOR_PRIORITY, (void *)netif);
+
+#if FNET_CFG_ETH_TX_QUEUE
+    /* Install TX Frame interrupt handler, if present. 
+     * It is unmasked only when the Tx ring is full.*/
+    if((result == FNET_OK) && ethif->tx_vector_number)
+    {
+        result = fnet_isr_vector_init(ethif->tx_vector_number, fnet_fec_isr_tx_handler_top, fnet_fec_isr_tx_handler_bottom, FNET_CFG_CPU_ETH_VECTOR_PRIORITY, (void *)netif);
+    }
+#endif
         
     if( result == FNET_OK)
     {
+        /* Rx event, processing the Rx ring left by the interrupt, 
+         * pass by pass. If it is not created, the interrupt processes 
+         * the whole ring.*/
+        ethif->rx_pending = FNET_FALSE;
+        ethif->rx_event = fnet_event_init(fnet_fec_rx_event, netif);
+
+    #if FNET_CFG_CPU_ETH_RX_COALESCE
+        /* Start without Rx coalescing. 
+         * If the timer is not created, the coalescing is never activated.*/
+        ethif->rx_coalesce = 1;
+        ethif->rx_coalesce_irq = 0;
+    #endif
+        ethif->rx_timer = fnet_timer_new((FNET_FEC_RX_TIMER_PERIOD / FNET_TIMER_PERIOD_MS), 
+                                            fnet_fec_rx_timer, netif);
+
         /* Reset all multicast (hash table registers).*/
         ethif->reg->GAUR = 0;
         ethif->reg->GALR = 0;
@@ -419,6 +469,15 @@ void fnet_fec_release(fnet_netif_t *netif)
     ethif->reg->EIR = 0xFFFFFFFF;   /* Clear any pending FEC interrupt flags. */
     
     fnet_isr_vector_release(ethif->vector_number);
+#if FNET_CFG_ETH_TX_QUEUE
+    if(ethif->tx_vector_number)
+        fnet_isr_vector_release(ethif->tx_vector_number);
+#endif
+
+    fnet_timer_free(ethif->rx_timer);
+
+    if(ethif->rx_event != (fnet_event_desc_t)FNET_ERR)
+        fnet_isr_vector_release((unsigned int)ethif->rx_event);
 
     fnet_eth_release(netif); /* Common Ethernet-interface release.*/
 }
@@ -452,21 +511,45 @@ void fnet_fec_resume(fnet_netif_t *netif)
 /************************************************************************
 * NAME: fnet_fec_input
 *
-* DESCRIPTION: Ethernet input function.
+* DESCRIPTION: Ethernet input function. 
+*              Processes all received frames.
 *************************************************************************/
 void fnet_fec_input(fnet_netif_t *netif)
+{
+    while(fnet_fec_input_budget(netif, FNET_CFG_CPU_ETH_RX_BUDGET) == FNET_TRUE)
+    {}
+}
+
+/************************************************************************
+* NAME: fnet_fec_input_budget
+*
+* DESCRIPTION: Ethernet input function. 
+*              Processes up to "budget" received frames (one poll pass).
+*
+* RETURNS: FNET_TRUE if the budget is exhausted and there are 
+*          more frames in the Rx ring, otherwise FNET_FALSE.
+*************************************************************************/
+static int fnet_fec_input_budget(fnet_netif_t *netif, int budget)
 {
     fnet_fec_if_t * ethif = ((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
     fnet_eth_header_t * ethheader;
     fnet_netbuf_t * nb=0;
+    int result;
 
     fnet_mac_addr_t local_mac_addr;
 
+    ((fnet_eth_if_t *)(netif->if_ptr))->statistics.rx_poll++;
+
     fnet_cpu_cache_invalidate();
 	
 	/* While buffer !(empty or rx in progress)*/
     while(!(ethif->rx_buf_desc_cur->status & FNET_HTONS(FNET_FEC_RX_BD_E)) )
     {
+        if(budget == 0)
+        {
+            break;
+        }
+        budget--;
 
 #if !FNET_CFG_CPU_ETH_MIB       
         ((fnet_eth_if_t *)(netif->if_ptr))->statistics.rx_packet++;
@@ -531,6 +614,205 @@ void fnet_fec_input(fnet_netif_t *netif)
 NEXT_FRAME: 
         fnet_fec_rx_buf_next(ethif);
    }; /* while */
+   
+   /* End of the RX batch.*/
+   fnet_eth_gro_flush(netif);
+
+   if(ethif->rx_buf_desc_cur->status & FNET_HTONS(FNET_FEC_RX_BD_E))
+   {
+        result = FNET_FALSE; /* Rx ring is empty.*/
+   }
+   else
+   {
+        ((fnet_eth_if_t *)(netif->if_ptr))->statistics.rx_budget_exhausted++;
+        result = FNET_TRUE;
+   }
+
+   return result;
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_poll
+*
+* DESCRIPTION: Polls the Rx ring, one pass of FNET_CFG_CPU_ETH_RX_BUDGET 
+*              frames. If frames remain, the Rx interrupt stays masked
+*              and the rest is left to the Rx event 
+*              (see fnet_fec_rx_continue()). 
+*              Otherwise the Rx interrupt is re-enabled, and the ring 
+*              is re-checked for a frame received meanwhile.
+*              The Rx interrupt must be masked, and the stack locked,
+*              by the caller.
+*************************************************************************/
+static void fnet_fec_rx_poll(fnet_netif_t *netif)
+{
+    fnet_fec_if_t *ethif = ((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
+
+    while(1)
+    {
+        if(fnet_fec_input_budget(netif, FNET_CFG_CPU_ETH_RX_BUDGET) == FNET_FALSE)
+        {
+            /* Rx ring is empty, re-enable the Rx interrupt.*/
+            ethif->reg->EIMR |= FNET_FEC_EIMR_RXF;
+
+            if(fnet_fec_rx_ready(ethif, 1) == 0)
+            {
+                ethif->rx_pending = FNET_FALSE;
+                break;
+            }
+
+            /* A frame is received meanwhile.*/
+            ethif->reg->EIMR &= (unsigned long)(~FNET_FEC_EIMR_RXF);
+        }
+
+        if(ethif->rx_event != (fnet_event_desc_t)FNET_ERR)
+        {
+            /* Defer the rest to the Rx event.*/
+            ethif->rx_pending = FNET_TRUE;
+            break;
+        }
+
+        /* No Rx event. Let pending handlers 
+         * (timers, other interfaces) run before the next pass.*/
+        fnet_isr_unlock();
+        fnet_isr_lock();
+    }
+
+    /* Send frames queued while the Tx ring was full 
+     * (the Tx completion is also detected here, if there is 
+     * no Tx interrupt).*/
+    fnet_eth_output_complete(netif);
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_continue
+*
+* DESCRIPTION: Pends the Rx event, if frames are left in the Rx ring.
+*              It is called after the stack lock is released, so the 
+*              next pass is executed by the next release of the stack 
+*              lock (any socket call, timer or interrupt), not at once.
+*              Applications run between the passes.
+*************************************************************************/
+static void fnet_fec_rx_continue(fnet_fec_if_t *ethif)
+{
+    if(ethif->rx_pending
+#if FNET_CFG_OS_THREAD
+        /* Do not keep the stack thread busy, while waiting for the batch.
+         * Frames left behind are picked up by the timer.*/
+        && fnet_fec_rx_batch_ready(ethif)
+#endif
+      )
+    {
+        fnet_event_pend(ethif->rx_event);
+    }
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_event
+*
+* DESCRIPTION: Rx event handler. Continues the Rx ring processing, 
+*              deferred by the Rx interrupt, one pass at a time.
+*************************************************************************/
+static void fnet_fec_rx_event(void *cookie)
+{
+    fnet_netif_t    *netif = (fnet_netif_t *)cookie;
+    fnet_fec_if_t   *ethif = ((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
+
+    fnet_isr_lock();
+
+    if(ethif->rx_pending && fnet_fec_rx_batch_ready(ethif))
+        fnet_fec_rx_poll(netif);
+
+    fnet_isr_unlock();
+
+    fnet_fec_rx_continue(ethif);
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_batch_ready
+*
+* DESCRIPTION: Returns FNET_TRUE if the Rx ring may be processed, 
+*              i.e. Rx coalescing is not active, or enough frames 
+*              are accumulated for the batch.
+*************************************************************************/
+static int fnet_fec_rx_batch_ready(fnet_fec_if_t *ethif)
+{
+#if FNET_CFG_CPU_ETH_RX_COALESCE
+    if((ethif->rx_coalesce > 1) && (fnet_fec_rx_ready(ethif, ethif->rx_coalesce) < ethif->rx_coalesce))
+        return FNET_FALSE;
+#else
+    FNET_COMP_UNUSED_ARG(ethif);
+#endif
+
+    return FNET_TRUE;
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_ready
+*
+* DESCRIPTION: Returns number of filled Rx buffers, up to "frames".
+*************************************************************************/
+static int fnet_fec_rx_ready(fnet_fec_if_t *ethif, int frames)
+{
+    fnet_fec_buf_desc_t *buf_desc = ethif->rx_buf_desc_cur;
+    int                 result = 0;
+
+    fnet_cpu_cache_invalidate();
+
+    while((result < frames) && !(buf_desc->status & FNET_HTONS(FNET_FEC_RX_BD_E)))
+    {
+        result++;
+
+        if (buf_desc->status & FNET_HTONS(FNET_FEC_RX_BD_W))
+            buf_desc = ethif->rx_buf_desc;
+        else
+            buf_desc++;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_fec_rx_timer
+*
+* DESCRIPTION: Rx timer. Picks up frames left in the Rx ring, 
+*              if the stack is not entered meanwhile, or held back 
+*              by the coalescing threshold. 
+*              It also adjusts the coalescing threshold to the Rx 
+*              interrupt rate (adaptive Rx coalescing).
+*************************************************************************/
+static void fnet_fec_rx_timer(void *cookie)
+{
+    fnet_netif_t    *netif = (fnet_netif_t *)cookie;
+    fnet_eth_if_t   *eth_if = (fnet_eth_if_t *)(netif->if_ptr);
+    fnet_fec_if_t   *ethif = eth_if->if_cpu_ptr;
+#if FNET_CFG_CPU_ETH_RX_COALESCE
+    unsigned long   irq_num;
+
+    irq_num = eth_if->statistics.rx_irq - ethif->rx_coalesce_irq;
+    ethif->rx_coalesce_irq = eth_if->statistics.rx_irq;
+
+    if(irq_num > FNET_FEC_RX_COALESCE_IRQ_HIGH)
+    {
+        if(ethif->rx_coalesce < FNET_FEC_RX_COALESCE_MAX)
+            ethif->rx_coalesce++;
+    }
+    else if(irq_num < (FNET_FEC_RX_COALESCE_IRQ_HIGH/2))
+    {
+        if(ethif->rx_coalesce > 1)
+            ethif->rx_coalesce--;
+    }
+#endif /* FNET_CFG_CPU_ETH_RX_COALESCE */
+
+    /* Pick up the frames, left in the Rx ring.*/
+    fnet_isr_lock();
+    if(ethif->rx_pending || fnet_fec_rx_ready(ethif, 1))
+    {
+        ethif->reg->EIMR &= (unsigned long)(~FNET_FEC_EIMR_RXF);
+        fnet_fec_rx_poll(netif);
+    }
+    fnet_isr_unlock();
+
+    fnet_fec_rx_continue(ethif);
 }
 
 /************************************************************************
@@ -746,6 +1028,37 @@ void fnet_fec_output(fnet_netif_t *netif, unsigned short type, const fnet_mac_ad
     fnet_netbuf_free_chain(nb);   
 }
 
+/************************************************************************
+* NAME: fnet_fec_output_ready
+*
+* DESCRIPTION: Returns FNET_TRUE if the next Tx buffer is free, 
+*              so fnet_fec_output() will not wait for it.
+*              Otherwise, enables the Tx Frame interrupt, to be notified 
+*              about the completion.
+*************************************************************************/
+int fnet_fec_output_ready(fnet_netif_t *netif)
+{
+    fnet_fec_if_t   *ethif = ((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
+    int             result;
+
+    fnet_cpu_cache_invalidate();
+    
+    if(ethif->tx_buf_desc_cur->status & FNET_HTONS(FNET_FEC_TX_BD_R))
+    {
+    #if FNET_CFG_ETH_TX_QUEUE
+        if(ethif->tx_vector_number)
+            ethif->reg->EIMR |= FNET_FEC_EIMR_TXF;
+    #endif
+        result = FNET_FALSE;
+    }
+    else
+    {
+        result = FNET_TRUE;
+    }
+
+    return result;
+}
+
 /************************************************************************
 * NAME: fnet_eth_output_frame
 *
@@ -881,11 +1194,10 @@ int fnet_fec_get_statistics(fnet_netif_t *netif, struct fnet_netif_statistics *
     
     if(netif && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
     {
+        *statistics = ((fnet_eth_if_t *)(netif->if_ptr))->statistics;
     #if FNET_CFG_CPU_ETH_MIB 
         statistics->tx_packet = ethif->reg->RMON_T_PACKETS; 
         statistics->rx_packet = ethif->reg->RMON_R_PACKETS;
-    #else 
-        *statistics = ((fnet_eth_if_t *)(netif->if_ptr))->statistics;
     #endif        
         result = FNET_OK;
     }
@@ -901,33 +1213,85 @@ int fnet_fec_get_statistics(fnet_netif_t *netif, struct fnet_netif_statistics *
 * NAME: fnet_fec_isr_rx_handler_top
 *
 * DESCRIPTION: Top Ethernet receive frame interrupt handler. 
-*              Clear event flag
+*              Clear event flag and mask the Rx interrupt, 
+*              until the Rx ring is polled empty.
 *************************************************************************/
 static void fnet_fec_isr_rx_handler_top (void *cookie) 
 {
-    fnet_fec_if_t *ethif = ((fnet_eth_if_t *)(((fnet_netif_t *)cookie)->if_ptr))->if_cpu_ptr;
+    fnet_eth_if_t *eth_if = (fnet_eth_if_t *)(((fnet_netif_t *)cookie)->if_ptr);
+    fnet_fec_if_t *ethif = eth_if->if_cpu_ptr;
     
     /* Clear FEC RX Event from the Event Register (by writing 1).*/
     ethif->reg->EIR = FNET_FEC_EIR_RXF;
+    /* Mask the Rx interrupt. It is re-enabled by fnet_fec_rx_poll(),
+     * when the Rx ring is empty.*/
+    ethif->reg->EIMR &= (unsigned long)(~FNET_FEC_EIMR_RXF);
+
+    eth_if->statistics.rx_irq++;
 }
 
 /************************************************************************
 * NAME: fnet_fec_isr_rx_handler_bottom
 *
 * DESCRIPTION: This function implements the Ethernet receive 
-*              frame interrupt handler. 
+*              frame interrupt handler (scheduled Rx poll). 
 *************************************************************************/
 static void fnet_fec_isr_rx_handler_bottom (void *cookie) 
 {
     fnet_netif_t *netif = (fnet_netif_t *)cookie;
+    fnet_fec_if_t *ethif = ((fnet_eth_if_t *)(netif->if_ptr))->if_cpu_ptr;
 	
 	fnet_isr_lock();
 
-    fnet_fec_input(netif);
+    /* Under load, wait until enough frames are accumulated,
+     * to process them in one batch. The Rx interrupt stays masked,
+     * the batch is picked up by the Rx event or the timer.*/
+    if((ethif->rx_event != (fnet_event_desc_t)FNET_ERR) && (fnet_fec_rx_batch_ready(ethif) == FNET_FALSE))
+    {
+        ethif->rx_pending = FNET_TRUE;
+    }
+    else
+    {
+        fnet_fec_rx_poll(netif);
+    }
     
     fnet_isr_unlock();
+
+    fnet_fec_rx_continue(ethif);
+}
+
+
+#if FNET_CFG_ETH_TX_QUEUE
+/************************************************************************
+* NAME: fnet_fec_isr_tx_handler_top
+*
+* DESCRIPTION: Top Ethernet transmit frame interrupt handler. 
+*              Clear event flag and mask the Tx interrupt. 
+*              It is re-enabled by fnet_fec_output_ready(), 
+*              when the Tx ring is full again.
+*************************************************************************/
+static void fnet_fec_isr_tx_handler_top (void *cookie) 
+{
+    fnet_fec_if_t *ethif = ((fnet_eth_if_t *)(((fnet_netif_t *)cookie)->if_ptr))->if_cpu_ptr;
+    
+    ethif->reg->EIR = FNET_FEC_EIR_TXF;
+    ethif->reg->EIMR &= (unsigned long)(~FNET_FEC_EIMR_TXF);
 }
 
+/************************************************************************
+* NAME: fnet_fec_isr_tx_handler_bottom
+*
+* DESCRIPTION: Ethernet transmit frame interrupt handler. 
+*              Passes the queued frames to the freed Tx buffers, 
+*              in one batch.
+*************************************************************************/
+static void fnet_fec_isr_tx_handler_bottom (void *cookie) 
+{
+    fnet_isr_lock();
+    fnet_eth_output_complete((fnet_netif_t *)cookie);
+    fnet_isr_unlock();
+}
+#endif /* FNET_CFG_ETH_TX_QUEUE */
 
 /************************************************************************
 * MII Staff 
@@ -480,6 +480,16 @@ typedef struct
     unsigned char            phy_addr;
     unsigned char            tx_buf_desc_num;    /* Number of allocated Tx Buffer Descriptors.*/    
     unsigned char            rx_buf_desc_num;    /* Number of allocated Tx Buffer Descriptors.*/  
+    int                      rx_pending;         /* Rx interrupt is masked, frames are left in the Rx ring.*/
+    fnet_event_desc_t        rx_event;           /* Continues the Rx ring processing, FNET_ERR if it is not created.*/
+    fnet_timer_desc_t        rx_timer;           /* Picks up the Rx ring, if the stack is not entered (and adapts Rx coalescing).*/
+#if FNET_CFG_CPU_ETH_RX_COALESCE
+    unsigned long            rx_coalesce_irq;    /* Rx interrupt counter value at the last timer event.*/
+    int                      rx_coalesce;        /* Current Rx coalescing threshold (in frames).*/
+#endif
+#if FNET_CFG_ETH_TX_QUEUE
+    unsigned int             tx_vector_number;   /* Vector number of the Ethernet Transmit Frame interrupt (0 if not used).*/
+#endif
 #if FNET_CFG_MULTICAST    
     fnet_uint32              GALR_double;
     fnet_uint32              GAUR_double;
@@ -512,6 +522,7 @@ int fnet_fec_set_hw_addr(fnet_netif_t *netif, unsigned char * hw_addr);
 int fnet_fec_is_connected(fnet_netif_t *netif);
 int fnet_fec_get_statistics(struct fnet_netif *netif, struct fnet_netif_statistics * statistics);
 void fnet_fec_output(fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr, fnet_netbuf_t* nb);
+int fnet_fec_output_ready(fnet_netif_t *netif);
 
 /* Ethernet IO initialization.*/
 void fnet_eth_io_init(void) ;
@@ -403,6 +403,39 @@ void fnet_cpu_flash_write(unsigned char *dest, unsigned char *data);
  ******************************************************************************/
 void fnet_cpu_isr(void);
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Starts the CPU cycle counter.
+ *
+ * @see fnet_cpu_cycles()
+ *
+ ******************************************************************************
+ *
+ * It is implemented only for the Cortex-M platforms (Kinetis and STM32),
+ * using the DWT cycle counter. @n
+ * It is called by the stack initialization, if @ref FNET_CFG_LATENCY 
+ * or @ref FNET_CFG_LOCK_PROFILE is @c 1.
+ *
+ ******************************************************************************/
+void fnet_cpu_cycles_init(void);
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Returns the CPU cycle counter.
+ *
+ * @return This function returns the free-running 32-bit cycle counter.
+ *
+ * @see fnet_cpu_cycles_init()
+ *
+ ******************************************************************************
+ *
+ * It is implemented only for the Cortex-M platforms (Kinetis and STM32),
+ * using the DWT cycle counter. @n
+ * It is the default @ref FNET_CFG_LATENCY_CYCLES.
+ *
+ ******************************************************************************/
+unsigned long fnet_cpu_cycles(void);
+
 /***************************************************************************/ /*!
  * @def FNET_CPU_INSTRUCTION_ADDR
  *
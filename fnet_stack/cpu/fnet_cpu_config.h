@@ -618,6 +618,30 @@
 #endif
 #endif    
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+ * @brief    Vector number of the Ethernet Transmit Frame interrupt.
+ *           It is used only if the Ethernet Tx queue is enabled 
+ *           (@ref FNET_CFG_ETH_TX_QUEUE).@n
+ *           If it is @c 0, the Tx queue is drained on the next 
+ *           output or receive event only.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER
+    #define FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER      (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER
+ * @brief    Vector number of the Ethernet Transmit Frame interrupt 
+ *           of the second Ethernet module. 
+ *           See @ref FNET_CFG_CPU_ETH0_TX_VECTOR_NUMBER.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER
+    #define FNET_CFG_CPU_ETH1_TX_VECTOR_NUMBER      (0)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_CPU_ETH_VECTOR_PRIORITY
  * @brief    Default Interrupt priority level for the Ethernet module. 
@@ -668,6 +692,60 @@
     #error "FNET_CFG_CPU_ETH_RX_BUFS_MAX is less than 2, minimal required value is 2 - see errata MCF5235"
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_RX_BUDGET
+ * @brief    Maximum number of Ethernet frames processed by one Rx poll pass.@n
+ *           The Rx interrupt is masked while the Rx ring is polled. 
+ *           The Rx interrupt processes one pass. If frames remain, 
+ *           the Rx interrupt stays masked, and the rest is processed 
+ *           pass by pass, one pass by every following release of the stack 
+ *           lock (socket calls, timers, other interrupts), so the application 
+ *           is not starved. A driver timer picks up the Rx ring, 
+ *           if the stack is not entered. 
+ *           The Rx interrupt is re-enabled when the Rx ring is empty.
+ *           @n @n NOTE: It is supported by the FEC/ENET driver only.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_RX_BUDGET
+    #define FNET_CFG_CPU_ETH_RX_BUDGET          (8)
+#endif
+
+#if (FNET_CFG_CPU_ETH_RX_BUDGET < 1)
+    #error "FNET_CFG_CPU_ETH_RX_BUDGET must be 1 or more."
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_RX_COALESCE
+ * @brief    Adaptive Rx interrupt coalescing:
+ *               - @c 1 = is enabled. A periodic timer measures the Rx 
+ *                        interrupt rate. Above @ref FNET_CFG_CPU_ETH_RX_COALESCE_IRQ_RATE
+ *                        the Rx processing is deferred until several frames 
+ *                        are accumulated in the Rx ring (up to half of the ring),
+ *                        so they are handled in one batch. 
+ *                        The Rx interrupt stays masked meanwhile.
+ *                        Frames left behind are picked up by the timer, 
+ *                        that adds up to 100 ms latency at the end of a burst.
+ *               - @c 0 = is disabled. Every Rx interrupt is processed immediately.
+ *           @n @n NOTE: It is supported by the FEC/ENET driver only and 
+ *           has effect if @ref FNET_CFG_CPU_ETH_RX_BUFS_MAX is 4 or more.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_RX_COALESCE
+    #define FNET_CFG_CPU_ETH_RX_COALESCE        (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CPU_ETH_RX_COALESCE_IRQ_RATE
+ * @brief    Rx interrupt rate (interrupts per second), above which 
+ *           the adaptive Rx coalescing threshold is increased. 
+ *           Below the half of this rate, the threshold is decreased.@n
+ *           Used only if @ref FNET_CFG_CPU_ETH_RX_COALESCE is set to @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CPU_ETH_RX_COALESCE_IRQ_RATE
+    #define FNET_CFG_CPU_ETH_RX_COALESCE_IRQ_RATE   (1000)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_CPU_ETH_ATONEGOTIATION_TIMEOUT
  * @brief    Defines Ethernet Autonegotiation Timeout (in ms), 
@@ -443,7 +443,7 @@ void fnet_lpceth_interrupt_handler_bottom() {
 		//}
 		//processingRxPacket = 1;
 		if (LPC_EMAC->RxConsumeIndex == LPC_EMAC->RxProduceIndex) {
-			return; // buffer is full
+			break; // buffer is full
 		}
 #if LPC_DEBUG_LEDS
 		led1_on();
@@ -488,6 +488,8 @@ void fnet_lpceth_interrupt_handler_bottom() {
 		led1_off();
 #endif
 	}
+	/* End of the RX batch.*/
+	fnet_eth_gro_flush(&fnet_eth0_if);
 }
 /*
  * This acts as the receive handler, trigged by an interrupt on reception of an Ethernet frame
@@ -89,4 +89,26 @@ unsigned long fnet_mk_periph_clk_khz(void)
     return (FNET_CPU_CLOCK_KHZ / (((FNET_MK_SIM_CLKDIV1 & FNET_MK_SIM_CLKDIV1_OUTDIV2_MASK) >> 24)+ 1));
 }
 
+/************************************************************************
+* NAME: fnet_cpu_cycles_init
+*
+* DESCRIPTION: Starts the DWT cycle counter.
+*************************************************************************/
+void fnet_cpu_cycles_init(void)
+{
+    FNET_MK_DEMCR |= FNET_MK_DEMCR_TRCENA_MASK;
+    FNET_MK_DWT_CYCCNT = 0;
+    FNET_MK_DWT_CTRL |= FNET_MK_DWT_CTRL_CYCCNTENA_MASK;
+}
+
+/************************************************************************
+* NAME: fnet_cpu_cycles
+*
+* DESCRIPTION: Returns the DWT cycle counter.
+*************************************************************************/
+unsigned long fnet_cpu_cycles(void)
+{
+    return FNET_MK_DWT_CYCCNT;
+}
+
 #endif /*FNET_MK*/
@@ -86,6 +86,15 @@ unsigned long fnet_mk_periph_clk_khz(void);
 #define FNET_MK_PERIPH_CLOCK_KHZ       fnet_mk_periph_clk_khz()     
 #define FNET_MK_PERIPH_CLOCK_MHZ       (fnet_mk_periph_clk_khz()/1000)  
 
+/************************************************************************
+* Cortex-M4 DWT cycle counter.
+*************************************************************************/
+#define FNET_MK_DEMCR                       (*(fnet_vuint32 *)0xE000EDFCu)
+#define FNET_MK_DEMCR_TRCENA_MASK           (0x01000000u)
+#define FNET_MK_DWT_CTRL                    (*(fnet_vuint32 *)0xE0001000u)
+#define FNET_MK_DWT_CTRL_CYCCNTENA_MASK     (0x00000001u)
+#define FNET_MK_DWT_CYCCNT                  (*(fnet_vuint32 *)0xE0001004u)
+
 
 /* ----------------------------------------------------------------------------
    -- UART
@@ -59,8 +59,9 @@ fnet_eth_if_t fnet_mk_eth0_if =
 #if FNET_CFG_MULTICAST
     ,      
     fnet_fec_multicast_join,
-    fnet_fec_multicast_leave,
+    fnet_fec_multicast_leave
 #endif /* FNET_CFG_MULTICAST */     
+    ,fnet_fec_output_ready      /* Tx queue support.*/
 };
 
 fnet_netif_t fnet_eth0_if =
@@ -48,4 +48,27 @@ int fnet_cpu_isr_install(unsigned int vector_number, unsigned int priority)
   return FNET_OK;
 }
 #endif
+
+/************************************************************************
+* NAME: fnet_cpu_cycles_init
+*
+* DESCRIPTION: Starts the DWT cycle counter.
+*************************************************************************/
+void fnet_cpu_cycles_init(void)
+{
+    FNET_STM32_DEMCR |= FNET_STM32_DEMCR_TRCENA_MASK;
+    FNET_STM32_DWT_CYCCNT = 0;
+    FNET_STM32_DWT_CTRL |= FNET_STM32_DWT_CTRL_CYCCNTENA_MASK;
+}
+
+/************************************************************************
+* NAME: fnet_cpu_cycles
+*
+* DESCRIPTION: Returns the DWT cycle counter.
+*************************************************************************/
+unsigned long fnet_cpu_cycles(void)
+{
+    return FNET_STM32_DWT_CYCCNT;
+}
+
 #endif /*FNET_STM32*/
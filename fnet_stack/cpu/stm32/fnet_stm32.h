@@ -78,6 +78,15 @@ fnet_uint32 fnet_mk_irq_disable(void);
 /* Ensure that the Thumb bit is set.*/
 //#define FNET_CPU_INSTRUCTION_ADDR(addr)    ((addr)|0x1)
 
+/************************************************************************
+* Cortex-M4 DWT cycle counter.
+*************************************************************************/
+#define FNET_STM32_DEMCR                    (*(fnet_vuint32 *)0xE000EDFCu)
+#define FNET_STM32_DEMCR_TRCENA_MASK        (0x01000000u)
+#define FNET_STM32_DWT_CTRL                 (*(fnet_vuint32 *)0xE0001000u)
+#define FNET_STM32_DWT_CTRL_CYCCNTENA_MASK  (0x00000001u)
+#define FNET_STM32_DWT_CYCCNT               (*(fnet_vuint32 *)0xE0001004u)
+
 /************************************************************************
 * Kinetis peripheral clock in KHZ.
 *************************************************************************/
@@ -123,6 +123,27 @@
 //    #define FNET_CFG_CPU_FLASH_PROGRAM_SIZE         (4)
 #endif 
 
+/*****************************************************************************
+ *  Size of the software Tx queue of the Ethernet driver (in frames).
+ *  If no Tx descriptor is free, the frame is queued and sent later
+ *  by the FNET thread, instead of waiting for the MAC.
+ *  0 = the driver waits up to 50 ms for a free Tx descriptor.
+ ******************************************************************************/ 
+#ifndef FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+    #define FNET_CFG_CPU_ETH_TX_QUEUE_SIZE          (8)
+#endif 
+
+/*****************************************************************************
+ *  Number of spare Rx buffers used for zero-copy reception.
+ *  A received frame is passed to the stack in place, and the Rx descriptor 
+ *  gets a spare buffer instead. When all spare buffers are in use, 
+ *  the frame is copied. 
+ *  0 = every received frame is copied.
+ ******************************************************************************/ 
+#ifndef FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+    #define FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS       (4)
+#endif 
+
 #endif /* FNET_STM32 */
 
 #endif /* _FNET_STM32_CONFIG_H_ */
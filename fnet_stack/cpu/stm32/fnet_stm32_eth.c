@@ -52,6 +52,15 @@
 #include "fnet_stm32_eth.h"
 #include "fnet_eth_prv.h"
 
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static int fnet_stm32_output_frame_low(fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr, fnet_netbuf_t* nb, systime_t timeout);
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+static fnet_netbuf_t *fnet_stm32_input_zerocopy(MACReceiveDescriptor *rd, void *data_ptr, int len);
+static void fnet_stm32_input_zerocopy_free(void *cookie);
+#endif
+
 /************************************************************************
 * Network interface API structure.
 *************************************************************************/
@@ -83,6 +92,14 @@ const fnet_netif_api_t fnet_stm32_mac_api =
 *     Ethernet Control data structure 
 ******************************************************************************/
 
+/* Driver data, not kept by the ChibiOS MACDriver.*/
+static fnet_stm32_eth_if_t fnet_stm32_eth0_cpu_if;
+
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+/* Spare Rx buffers, exchanged with the Rx descriptor buffers.*/
+static fnet_uint32 fnet_stm32_rx_buf[FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS][(STM32_MAC_BUFFERS_SIZE + 3)/4];
+#endif
+
 fnet_eth_if_t fnet_stm32_eth0_if =
 {
     //&fnet_stm32_eth0_if    /* if_cpu_ptr: CPU-specific control data structure of the if. */
@@ -122,14 +139,52 @@ fnet_netif_t fnet_eth0_if =
 *************************************************************************/
 int fnet_stm32_init(fnet_netif_t *netif)
 {
-  (void) netif;
-
   uint8_t mac_addr[6]= { 0x12,0x34,0x56,0x78,0x9A,0xBC };
   static MACConfig mac_config;
   mac_config.mac_address = mac_addr;
 
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+  fnet_stm32_eth0_cpu_if.tx_queue_head = 0;
+  fnet_stm32_eth0_cpu_if.tx_queue_count = 0;
+#endif
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+  {
+     int i;
+     
+     /* Note: buffers lent to netbufs must be returned before the interface is restarted.*/
+     for(i = 0; i < FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS; i++)
+     {
+        fnet_stm32_eth0_cpu_if.rx_slot[i].buf = (unsigned char *)fnet_stm32_rx_buf[i];
+        fnet_stm32_eth0_cpu_if.rx_slot[i].in_use = 0;
+     }
+  }
+#endif
+
   // Init mac.
   macStart(&ETHD1, &mac_config);
+
+#if FNET_CFG_CPU_ETH_HW_RX_IP_CHECKSUM || FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM
+  /* Enable Rx checksum offload. Frames with a wrong IPv4 header 
+   * or TCP/UDP/ICMP checksum are dropped by the DMA (DMAOMR[DTCEFD] is 0).*/
+  ETH->MACCR |= ETH_MACCR_IPCO;
+#endif
+
+  /* Tx checksum insertion is configured for ChibiOS by STM32_MAC_IP_CHECKSUM_OFFLOAD 
+   * (Tx descriptor CIC field): 1 = IPv4 header, 3 = IPv4 header and protocol.*/
+  netif->features = FNET_NETIF_FEATURE_NONE
+  #if FNET_CFG_CPU_ETH_HW_TX_IP_CHECKSUM && (STM32_MAC_IP_CHECKSUM_OFFLOAD >= 1)
+                    |FNET_NETIF_FEATURE_HW_TX_IP_CHECKSUM
+  #endif
+  #if FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM && (STM32_MAC_IP_CHECKSUM_OFFLOAD == 3)
+                    |FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM
+  #endif
+  #if FNET_CFG_CPU_ETH_HW_RX_IP_CHECKSUM
+                    |FNET_NETIF_FEATURE_HW_RX_IP_CHECKSUM
+  #endif
+  #if FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM
+                    |FNET_NETIF_FEATURE_HW_RX_PROTOCOL_CHECKSUM
+  #endif
+                    ;
   
   // Start fnet thread. This thread processes the incoming packages and timers.
   fnetThdStart();
@@ -140,6 +195,16 @@ void fnet_stm32_release(fnet_netif_t *netif) {
    (void) netif;
 
    macStop(&ETHD1);
+
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+   /* Drop the queued frames.*/
+   while(fnet_stm32_eth0_cpu_if.tx_queue_count)
+   {
+      fnet_netbuf_free_chain(fnet_stm32_eth0_cpu_if.tx_queue[fnet_stm32_eth0_cpu_if.tx_queue_head].nb);
+      fnet_stm32_eth0_cpu_if.tx_queue_head = (fnet_stm32_eth0_cpu_if.tx_queue_head + 1) % FNET_CFG_CPU_ETH_TX_QUEUE_SIZE;
+      fnet_stm32_eth0_cpu_if.tx_queue_count--;
+   }
+#endif
 }
 
 /************************************************************************
@@ -153,26 +218,104 @@ void fnet_stm32_input(void) {
    fnet_eth_header_t * ethheader;
    fnet_netbuf_t * nb = 0;
    size_t size;
+   unsigned short type;
 
    while (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) == RDY_OK) {
+
+#if FNET_CFG_CPU_ETH_HW_RX_IP_CHECKSUM || FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM
+      /* Frame with a checksum error, not dropped by the DMA.*/
+      if ((rd.physdesc->rdes0 & STM32_RDES0_FT)
+          && (rd.physdesc->rdes0 & (STM32_RDES0_IPHCE | STM32_RDES0_PCE))) {
+         macReleaseReceiveDescriptor(&rd);
+         continue;
+      }
+#endif
+
       ethheader = (fnet_eth_header_t *) rd.physdesc->rdes2; /* Point to the ethernet header.*/
       size = rd.size - rd.offset;
+      type = ethheader->type;
 
       fnet_eth_trace("\nRX", ethheader); /* Print ETH header.*/
 
-      nb = fnet_netbuf_from_buf(
+      ((fnet_eth_if_t *)(fnet_eth0_if.if_ptr))->statistics.rx_packet++;
+
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+      /* Pass the descriptor buffer to the stack in place. 
+       * The descriptor gets a spare buffer and is released immediately.*/
+      nb = fnet_stm32_input_zerocopy(&rd,
             (void *) ((unsigned long) ethheader
                   + sizeof(fnet_eth_header_t)),
-            (size - sizeof(fnet_eth_header_t)), FNET_TRUE);
+            (int)(size - sizeof(fnet_eth_header_t)));
+
+      if (nb == 0)
+#endif
+      {
+         nb = fnet_netbuf_from_buf(
+               (void *) ((unsigned long) ethheader
+                     + sizeof(fnet_eth_header_t)),
+               (size - sizeof(fnet_eth_header_t)), FNET_TRUE);
+      }
 
       macReleaseReceiveDescriptor(&rd);
 
       if (nb) {
-         fnet_eth_prot_input(&fnet_eth0_if, nb, ethheader->type);
+         fnet_eth_prot_input(&fnet_eth0_if, nb, type);
       }
    }
+
+   /* End of the RX batch.*/
+   fnet_eth_gro_flush(&fnet_eth0_if);
 }
 
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+/************************************************************************
+* NAME: fnet_stm32_input_zerocopy
+*
+* DESCRIPTION: Creates a netbuf referencing the received frame in place,
+*              and gives a spare buffer to the Rx descriptor.
+*              Returns 0 if no spare buffer is available.
+*************************************************************************/
+static fnet_netbuf_t *fnet_stm32_input_zerocopy(MACReceiveDescriptor *rd, void *data_ptr, int len)
+{
+   fnet_stm32_rx_slot_t *slot = 0;
+   fnet_netbuf_t *nb = 0;
+   unsigned char *buf;
+   int i;
+
+   for (i = 0; i < FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS; i++) {
+      if (fnet_stm32_eth0_cpu_if.rx_slot[i].in_use == 0) {
+         slot = &fnet_stm32_eth0_cpu_if.rx_slot[i];
+         break;
+      }
+   }
+
+   if (slot) {
+      nb = fnet_netbuf_from_ref(data_ptr, len, fnet_stm32_input_zerocopy_free, slot, FNET_FALSE);
+
+      if (nb) {
+         /* Exchange the buffers.*/
+         buf = (unsigned char *)rd->physdesc->rdes2;
+         rd->physdesc->rdes2 = (uint32_t)slot->buf;
+         slot->buf = buf;
+         slot->in_use = 1;
+      }
+   }
+
+   return nb;
+}
+
+/************************************************************************
+* NAME: fnet_stm32_input_zerocopy_free
+*
+* DESCRIPTION: Called when the stack does not reference 
+*              the lent Rx buffer anymore. It becomes spare again.
+*************************************************************************/
+static void fnet_stm32_input_zerocopy_free(void *cookie)
+{
+   ((fnet_stm32_rx_slot_t *)cookie)->in_use = 0;
+}
+#endif /* FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS */
+
 /************************************************************************
 * NAME: fnet_stm32_get_mac_addr
 *
@@ -262,42 +405,147 @@ int fnet_stm32_is_connected(fnet_netif_t *netif) {
 
 int fnet_stm32_get_statistics(struct fnet_netif *netif, struct fnet_netif_statistics * statistics) 
 {
-  (void) netif;
-  (void) statistics;
-  return FNET_OK;
+  int result;
+
+  if(netif && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
+  {
+     *statistics = ((fnet_eth_if_t *)(netif->if_ptr))->statistics;
+     result = FNET_OK;
+  }
+  else
+  {
+     result = FNET_ERR;
+  }
+
+  return result;
+}
+
+/************************************************************************
+* NAME: fnet_stm32_output_frame_low
+*
+* DESCRIPTION: Copies the frame into a Tx descriptor buffer and 
+*              passes it to the MAC. 
+*              Returns FNET_ERR if no Tx descriptor is free within "timeout".
+*************************************************************************/
+static int fnet_stm32_output_frame_low(fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr, fnet_netbuf_t* nb, systime_t timeout)
+{
+   MACTransmitDescriptor td;
+   int result;
+
+   if(macWaitTransmitDescriptor(&ETHD1, &td, timeout) == RDY_OK) {
+
+      fnet_eth_header_t *ethHeader = (fnet_eth_header_t *)td.physdesc->tdes2;
+
+      fnet_netbuf_to_buf(nb, 0, FNET_NETBUF_COPYALL, (void *)((unsigned long)ethHeader + FNET_ETH_HDR_SIZE));
+
+      fnet_memcpy (ethHeader->destination_addr, dest_addr, sizeof(fnet_mac_addr_t));
+
+      fnet_stm32_get_hw_addr(netif, (unsigned char *)&ethHeader->source_addr);
+
+      ethHeader->type=fnet_htons(type);
+
+      td.offset = nb->total_length + FNET_ETH_HDR_SIZE;
+
+      macReleaseTransmitDescriptor(&td);
+
+      ((fnet_eth_if_t *)(netif->if_ptr))->statistics.tx_packet++;
+
+      result = FNET_OK;
+   }
+   else
+   {
+      result = FNET_ERR;
+   }
+
+   return result;
 }
 
 /************************************************************************
 * NAME: fnet_stm32_output
 *
 * DESCRIPTION: Ethernet low-level output function.
+*              It does not wait for the MAC. If no Tx descriptor is free, 
+*              the frame is put to the software Tx queue.
 *************************************************************************/
 void fnet_stm32_eth_output( fnet_netif_t *netif, unsigned short type,
       const fnet_mac_addr_t dest_addr, fnet_netbuf_t* nb)
 {
-   MACTransmitDescriptor td;
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+   fnet_stm32_tx_entry_t *entry;
+#endif
 
    if((nb!=0) && (nb->total_length<=netif->mtu))
    {
-      if(macWaitTransmitDescriptor(&ETHD1, &td, MS2ST(50)) == RDY_OK) {
-
-         fnet_eth_header_t *ethHeader = (fnet_eth_header_t *)td.physdesc->tdes2;
-
-         fnet_netbuf_to_buf(nb, 0, FNET_NETBUF_COPYALL, (void *)((unsigned long)ethHeader + FNET_ETH_HDR_SIZE));
-
-         fnet_memcpy (ethHeader->destination_addr, dest_addr, sizeof(fnet_mac_addr_t));
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+      /* Keep the frame order.*/
+      fnet_stm32_output_flush();
+
+      if((fnet_stm32_eth0_cpu_if.tx_queue_count == 0)
+         && (fnet_stm32_output_frame_low(netif, type, dest_addr, nb, TIME_IMMEDIATE) == FNET_OK))
+      {
+         /* Sent.*/
+      }
+      else if(fnet_stm32_eth0_cpu_if.tx_queue_count < FNET_CFG_CPU_ETH_TX_QUEUE_SIZE)
+      {
+         entry = &fnet_stm32_eth0_cpu_if.tx_queue[(fnet_stm32_eth0_cpu_if.tx_queue_head + fnet_stm32_eth0_cpu_if.tx_queue_count) % FNET_CFG_CPU_ETH_TX_QUEUE_SIZE];
+         entry->nb = nb;
+         entry->type = type;
+         fnet_memcpy(entry->dest_addr, dest_addr, sizeof(fnet_mac_addr_t));
+         fnet_stm32_eth0_cpu_if.tx_queue_count++;
+         return; /* The queue owns the netbuf now.*/
+      }
+      else
+      {
+         /* The queue is full, drop the frame.*/
+      }
+#else
+      fnet_stm32_output_frame_low(netif, type, dest_addr, nb, MS2ST(50));
+#endif
+   }
 
-         fnet_stm32_get_hw_addr(netif, (unsigned char *)&ethHeader->source_addr);
+   fnet_netbuf_free_chain(nb);
+}
 
-         ethHeader->type=fnet_htons(type);
+/************************************************************************
+* NAME: fnet_stm32_output_flush
+*
+* DESCRIPTION: Passes the queued frames to the MAC, 
+*              while there are free Tx descriptors.
+*              Called from the output function and the FNET thread.
+*************************************************************************/
+void fnet_stm32_output_flush(void)
+{
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+   fnet_stm32_tx_entry_t *entry;
 
-         td.offset = nb->total_length + FNET_ETH_HDR_SIZE;
+   while(fnet_stm32_eth0_cpu_if.tx_queue_count)
+   {
+      entry = &fnet_stm32_eth0_cpu_if.tx_queue[fnet_stm32_eth0_cpu_if.tx_queue_head];
 
-         macReleaseTransmitDescriptor(&td);
+      if(fnet_stm32_output_frame_low(&fnet_eth0_if, entry->type, entry->dest_addr, entry->nb, TIME_IMMEDIATE) == FNET_ERR)
+      {
+         break; /* No free Tx descriptor.*/
       }
+
+      fnet_netbuf_free_chain(entry->nb);
+      fnet_stm32_eth0_cpu_if.tx_queue_head = (fnet_stm32_eth0_cpu_if.tx_queue_head + 1) % FNET_CFG_CPU_ETH_TX_QUEUE_SIZE;
+      fnet_stm32_eth0_cpu_if.tx_queue_count--;
    }
+#endif
+}
 
-   fnet_netbuf_free_chain(nb);
+/************************************************************************
+* NAME: fnet_stm32_output_pending
+*
+* DESCRIPTION: Returns FNET_TRUE if there are frames in the Tx queue.
+*************************************************************************/
+int fnet_stm32_output_pending(void)
+{
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+   return (fnet_stm32_eth0_cpu_if.tx_queue_count ? FNET_TRUE : FNET_FALSE);
+#else
+   return FNET_FALSE;
+#endif
 }
 
 // Perhaps try their eth driver if the stack works out well
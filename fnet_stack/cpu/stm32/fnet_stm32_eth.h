@@ -59,9 +59,31 @@
 #include "fnet_stdlib.h"
 
 
+/* Software Tx queue entry.*/
 typedef struct
 {
+    fnet_netbuf_t       *nb;            /* Frame payload.*/
+    unsigned short      type;           /* Ethernet type (host byte order).*/
+    fnet_mac_addr_t     dest_addr;      /* Destination MAC address.*/
+} fnet_stm32_tx_entry_t;
 
+/* Zero-copy Rx buffer slot.*/
+typedef struct
+{
+    unsigned char       *buf;           /* Spare buffer, or the buffer lent to a netbuf.*/
+    int                 in_use;         /* The buffer is lent to a netbuf.*/
+} fnet_stm32_rx_slot_t;
+
+typedef struct
+{
+#if FNET_CFG_CPU_ETH_TX_QUEUE_SIZE
+    fnet_stm32_tx_entry_t   tx_queue[FNET_CFG_CPU_ETH_TX_QUEUE_SIZE];  /* Frames waiting for a Tx descriptor.*/
+    int                     tx_queue_head;                              /* Index of the oldest queued frame.*/
+    int                     tx_queue_count;                             /* Number of queued frames.*/
+#endif
+#if FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS
+    fnet_stm32_rx_slot_t    rx_slot[FNET_CFG_CPU_ETH_RX_ZEROCOPY_BUFS];
+#endif
 } fnet_stm32_eth_if_t; // fnet_fec_if_t
 
 /* CPU-specific configuration.*/
@@ -132,6 +154,8 @@ typedef struct
 int fnet_stm32_init(fnet_netif_t *netif);
 void fnet_stm32_release(fnet_netif_t *netif);
 void fnet_stm32_input(void);
+void fnet_stm32_output_flush(void);
+int fnet_stm32_output_pending(void);
 int fnet_stm32_get_hw_addr(fnet_netif_t *netif, unsigned char * hw_addr);
 int fnet_stm32_set_hw_addr(fnet_netif_t *netif, unsigned char * hw_addr);
 int fnet_stm32_is_connected(fnet_netif_t *netif);
@@ -36,6 +36,7 @@ FNETSRC +=		$(FNET_STACK)/cpu/fnet_cpu.c \
                         $(FNET_STACK)/cpu/stm32/fnet_stm32.c \
 			$(FNET_STACK)/cpu/stm32/fnet_stm32_eth.c \
 			$(FNET_STACK)/cpu/stm32/fnet_stm32_serial.c \
+			$(FNET_STACK)/os/fnet_os_thread.c \
 			$(FNET_STACK)/os/ChibiOS/fnet_chibios.c \
 			$(FNET_STACK)/os/brtos/fnet_brtos.c \
 			$(FNET_STACK)/os/freertos/fnet_freertos.c \
@@ -78,6 +79,13 @@ FNETSRC +=		$(FNET_STACK)/cpu/fnet_cpu.c \
 			$(FNET_STACK)/stack/fnet_prot.c \
 			$(FNET_STACK)/stack/fnet_raw.c \
 			$(FNET_STACK)/stack/fnet_socket.c \
+			$(FNET_STACK)/stack/fnet_stats.c \
+			$(FNET_STACK)/stack/fnet_trace.c \
+			$(FNET_STACK)/stack/fnet_capture.c \
+			$(FNET_STACK)/stack/fnet_latency.c \
+			$(FNET_STACK)/stack/fnet_lock_profile.c \
+			$(FNET_STACK)/stack/fnet_heap_profile.c \
+			$(FNET_STACK)/stack/fnet_ubench.c \
 			$(FNET_STACK)/stack/fnet_stack.c \
 			$(FNET_STACK)/stack/fnet_stdlib.c \
 			$(FNET_STACK)/stack/fnet_tcp.c \
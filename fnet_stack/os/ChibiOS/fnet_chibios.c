@@ -52,7 +52,8 @@
 /************************************************************************
 * NAME: fnet_thread
 *
-* DESCRIPTION: FNET thread. Wait for incoming packages.
+* DESCRIPTION: FNET thread. Waits for incoming packages 
+*              and sends frames queued by the Ethernet driver.
 *************************************************************************/
 #define PERIODIC_TIMER_ID       1
 #define FRAME_RECEIVED_ID       2
@@ -61,6 +62,161 @@
 #define FNET_THREAD_PRIORITY    NORMALPRIO
 #endif
 
+#if FNET_CFG_OS_THREAD
+
+#define THREAD_SIGNAL_ID        4
+
+static WORKING_AREA(wa_fnet_stack_thread, FNET_CFG_OS_THREAD_STACK_SIZE);
+static Thread *fnet_stack_thread_ptr;
+static volatile unsigned int fnet_stack_timer_period_ms; /* 0, until fnet_os_timer_init().*/
+
+/************************************************************************
+* NAME: fnet_stack_thread
+*
+* DESCRIPTION: Stack thread. Executes all protocol processing:
+*              incoming frames, timers and posted messages.
+*************************************************************************/
+static msg_t fnet_stack_thread(void *arg) {
+   (void) arg;
+   EventListener el1;
+   systime_t tick_time;
+   systime_t period;
+   systime_t elapsed;
+   systime_t timeout;
+   eventmask_t mask;
+
+   chRegSetThreadName("FNET stack thread");
+
+   chEvtRegisterMask(macGetReceiveEventSource(&ETHD1), &el1, FRAME_RECEIVED_ID);
+   chEvtAddEvents(FRAME_RECEIVED_ID);
+
+   tick_time = chTimeNow();
+
+   while (!chThdShouldTerminate()) {
+      period = MS2ST(fnet_stack_timer_period_ms);
+      elapsed = chTimeNow() - tick_time;
+
+      /* Wake up for the next timer period, 
+       * or poll the driver Tx queue, while it is not empty.*/
+      if (fnet_stm32_output_pending())
+         timeout = MS2ST(1);
+      else if (period == 0)
+         timeout = TIME_INFINITE;
+      else if (elapsed < period)
+         timeout = period - elapsed;
+      else
+         timeout = TIME_IMMEDIATE;
+
+      mask = chEvtWaitAnyTimeout(ALL_EVENTS, timeout);
+
+      if (period) {
+         while ((systime_t)(chTimeNow() - tick_time) >= period) {
+            tick_time += period;
+            fnet_os_thread_tick();
+         }
+      } else {
+         tick_time = chTimeNow();
+      }
+
+      fnet_os_mutex_lock();
+      if (mask & FRAME_RECEIVED_ID) {
+         fnet_stm32_input();
+      }
+      fnet_os_thread_dispatch();
+      fnet_stm32_output_flush();
+      fnet_os_mutex_unlock();
+   }
+   return RDY_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_start
+*
+* DESCRIPTION: Creates the stack thread.
+*************************************************************************/
+int fnet_os_thread_start(void)
+{
+   fnet_stack_thread_ptr = chThdCreateStatic(wa_fnet_stack_thread, sizeof(wa_fnet_stack_thread), FNET_THREAD_PRIORITY, fnet_stack_thread, NULL);
+   return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_stop
+*
+* DESCRIPTION: Requests the stack thread to exit.
+*************************************************************************/
+void fnet_os_thread_stop(void)
+{
+   if (fnet_stack_thread_ptr) {
+      chThdTerminate(fnet_stack_thread_ptr);
+      chEvtSignal(fnet_stack_thread_ptr, THREAD_SIGNAL_ID);
+      fnet_stack_thread_ptr = NULL;
+   }
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal
+*
+* DESCRIPTION: Wakes up the stack thread. Thread context.
+*************************************************************************/
+void fnet_os_thread_signal(void)
+{
+   if (fnet_stack_thread_ptr) {
+      chEvtSignal(fnet_stack_thread_ptr, THREAD_SIGNAL_ID);
+   }
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal_isr
+*
+* DESCRIPTION: Wakes up the stack thread. Interrupt context.
+*************************************************************************/
+void fnet_os_thread_signal_isr(void)
+{
+   if (fnet_stack_thread_ptr) {
+      chSysLockFromIsr();
+      chEvtSignalI(fnet_stack_thread_ptr, THREAD_SIGNAL_ID);
+      chSysUnlockFromIsr();
+   }
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_is_self
+*
+* DESCRIPTION: Returns FNET_TRUE if it is called by the stack thread.
+*************************************************************************/
+int fnet_os_thread_is_self(void)
+{
+   return ((fnet_stack_thread_ptr != NULL) && (chThdSelf() == fnet_stack_thread_ptr)) ? FNET_TRUE : FNET_FALSE;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_lock
+*
+* DESCRIPTION: Serializes the mailbox producers, while a slot is claimed.
+*              Used only on cores without FNET_OS_THREAD_CAS.
+*************************************************************************/
+void fnet_os_thread_mbox_lock(void)
+{
+   chSysLock();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_unlock
+*
+* DESCRIPTION:
+*************************************************************************/
+void fnet_os_thread_mbox_unlock(void)
+{
+   chSysUnlock();
+}
+
+/* The stack thread is started by fnet_init().*/
+void fnetThdStart(void) {
+}
+
+#else /* !FNET_CFG_OS_THREAD */
+
 static WORKING_AREA(wa_fnet_receive_thread, 1024);
 
 static msg_t fnet_receive_thread(void *arg) {
@@ -73,10 +229,15 @@ static msg_t fnet_receive_thread(void *arg) {
    chEvtAddEvents(FRAME_RECEIVED_ID);
 
    while (TRUE) {
-      eventmask_t mask = chEvtWaitAny(ALL_EVENTS );
+      /* Poll the driver Tx queue, while it is not empty.*/
+      eventmask_t mask = chEvtWaitAnyTimeout(ALL_EVENTS, 
+                                             fnet_stm32_output_pending() ? MS2ST(1) : TIME_INFINITE);
+      fnet_os_mutex_lock();
       if (mask & FRAME_RECEIVED_ID) {
          fnet_stm32_input();
       }
+      fnet_stm32_output_flush();
+      fnet_os_mutex_unlock();
    }
    return RDY_OK;
 }
@@ -87,6 +248,8 @@ void fnetThdStart(void) {
    chThdCreateStatic(wa_fnet_receive_thread, sizeof(wa_fnet_receive_thread), FNET_THREAD_PRIORITY, fnet_receive_thread, NULL);
 }
 
+#endif /* FNET_CFG_OS_THREAD */
+
 #if FNET_CFG_OS_EVENT
 
 static BSEMAPHORE_DECL(FnetSemaphore, 0);
@@ -142,6 +305,10 @@ int fnet_os_mutex_init(void)
    return FNET_OK;
 }
 
+#if FNET_CFG_LOCK_PROFILE
+    #undef fnet_os_mutex_lock /* The function is profiled by fnet_os_mutex_lock_site().*/
+#endif
+
 /************************************************************************
 * NAME: fnet_os_mutex_lock;
 *
@@ -186,6 +353,34 @@ void fnet_os_mutex_release(void)
 
 #ifdef FNET_CFG_OS_TIMER
 
+#if FNET_CFG_OS_THREAD
+
+/************************************************************************
+* NAME: fnet_os_timer_init
+*
+* DESCRIPTION: Starts the timer. The timer periods are counted 
+*              by the stack thread.
+*************************************************************************/
+int fnet_os_timer_init( unsigned int period_ms )
+{
+   fnet_stack_timer_period_ms = period_ms;
+   fnet_os_thread_signal();
+   return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_timer_release
+*
+* DESCRIPTION: Stops the timer.
+*
+*************************************************************************/
+void fnet_os_timer_release( void )
+{
+   fnet_stack_timer_period_ms = 0;
+}
+
+#else /* !FNET_CFG_OS_THREAD */
+
 static WORKING_AREA(wa_fnet_timer_thread, 1024);
 EvTimer fnetEventTimer;
 
@@ -233,6 +428,8 @@ void fnet_os_timer_release( void )
    evtStop(&fnetEventTimer);
 }
 
+#endif /* FNET_CFG_OS_THREAD */
+
 #endif /* FNET_CFG_OS_TIMER */
 
 #endif /* FNET_CFG_OS && FNET_CFG_OS_CHIBIOS */
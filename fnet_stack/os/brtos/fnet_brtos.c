@@ -134,6 +134,10 @@ int fnet_os_mutex_init(void)
 		 return FNET_ERR;
 }
 
+#if FNET_CFG_LOCK_PROFILE
+    #undef fnet_os_mutex_lock /* The function is profiled by fnet_os_mutex_lock_site().*/
+#endif
+
 /************************************************************************
 * NAME: fnet_os_mutex_lock;
 *
@@ -164,5 +168,136 @@ void fnet_os_mutex_release(void)
 	
 }
 
+#if FNET_CFG_OS_THREAD
+
+#ifndef FNET_BRTOS_THREAD_PRIORITY
+    #define FNET_BRTOS_THREAD_PRIORITY  (10)    /* Must be lower than FNET_BRTOS_MUTEX_PRIORITY. */
+#endif
+
+/************************************************************************
+*     Global Data Structures
+*************************************************************************/
+BRTOS_Sem       *FnetThreadSemaphore;
+static BRTOS_TH FnetThreadId;
+static volatile int FnetThreadStarted;
+static volatile int FnetThreadExit;
+
+/************************************************************************
+* NAME: fnet_os_thread_task
+*
+* DESCRIPTION: Stack thread. Executes all protocol processing:
+*              interrupt bottom halves (including the timer)
+*              and posted messages.
+*              A BRTOS task may not return, it stays blocked after 
+*              fnet_os_thread_stop().
+*************************************************************************/
+static void fnet_os_thread_task(void)
+{
+	for(;;)
+	{
+		(void)OSSemPend(FnetThreadSemaphore, 0); /* No timeout.*/
+
+		if(!FnetThreadExit)
+		{
+			fnet_os_mutex_lock();
+			fnet_os_thread_dispatch();
+			fnet_os_mutex_unlock();
+		}
+	}
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_start
+*
+* DESCRIPTION: Creates the stack thread.
+*************************************************************************/
+int fnet_os_thread_start(void)
+{
+	FnetThreadExit = FNET_FALSE;
+
+	if(FnetThreadStarted)
+		return FNET_OK;
+
+	if (OSSemCreate(0, &FnetThreadSemaphore) != ALLOC_EVENT_OK)
+		return FNET_ERR;
+
+	if (InstallTask(&fnet_os_thread_task, "FNET stack", FNET_CFG_OS_THREAD_STACK_SIZE, 
+	                FNET_BRTOS_THREAD_PRIORITY, &FnetThreadId) != OK)
+		return FNET_ERR;
+
+	FnetThreadStarted = FNET_TRUE;
+	return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_stop
+*
+* DESCRIPTION: Stops processing in the stack thread.
+*              The thread is woken up, to leave its pending dispatch.
+*************************************************************************/
+void fnet_os_thread_stop(void)
+{
+	FnetThreadExit = FNET_TRUE;
+	fnet_os_thread_signal();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal
+*
+* DESCRIPTION: Wakes up the stack thread.
+*************************************************************************/
+void fnet_os_thread_signal(void)
+{
+	if(FnetThreadStarted)
+		(void)OSSemPost(FnetThreadSemaphore);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal_isr
+*
+* DESCRIPTION: Wakes up the stack thread. Interrupt context 
+*              (inside of fnet_os_isr()).
+*************************************************************************/
+void fnet_os_thread_signal_isr(void)
+{
+	fnet_os_thread_signal();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_is_self
+*
+* DESCRIPTION: Returns FNET_TRUE if it is called by the stack thread.
+*************************************************************************/
+int fnet_os_thread_is_self(void)
+{
+	if(FnetThreadStarted && (currentTask == FnetThreadId))
+		return FNET_TRUE;
+	else
+		return FNET_FALSE;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_lock
+*
+* DESCRIPTION: Serializes the mailbox producers, while a slot is claimed.
+*              Used only on cores without FNET_OS_THREAD_CAS.
+*************************************************************************/
+void fnet_os_thread_mbox_lock(void)
+{
+	UserEnterCritical();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_unlock
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_thread_mbox_unlock(void)
+{
+	UserExitCritical();
+}
+
+#endif /* FNET_CFG_OS_THREAD */
+
 
 #endif /* FNET_CFG_OS && FNET_CFG_OS_BRTOS */
@@ -49,6 +49,12 @@
     void fnet_os_mutex_lock(void);
     void fnet_os_mutex_unlock(void);
     void fnet_os_mutex_release(void);
+    #if FNET_CFG_LOCK_PROFILE
+        /* Profiled lock, records its call site. 
+         * The fnet_os_mutex_lock() function is implemented by the OS port.*/
+        void fnet_os_mutex_lock_site(const char *file, int line);
+        #define fnet_os_mutex_lock()    fnet_os_mutex_lock_site(__FILE__, __LINE__)
+    #endif
 #else
     #define fnet_os_mutex_init()        FNET_OK
     #define fnet_os_mutex_lock()        {}
@@ -77,6 +83,36 @@
     void fnet_os_timer_release(void);
 #endif
 
+#if FNET_CFG_OS_THREAD
+    /* Message, handed over to the stack thread. 
+     * It is owned by the caller, and must be kept until "done" is set.*/
+    typedef struct fnet_os_thread_msg
+    {
+        void            (*handler)(void *cookie);                       /* Executed by the stack thread.*/
+        void            *cookie;                                        /* Handler parameter.*/
+        void            (*complete)(struct fnet_os_thread_msg *msg);    /* Optional. Called by the stack thread after handler().*/
+        volatile int    done;                                           /* Set to FNET_TRUE after handler() is executed.*/
+    } fnet_os_thread_msg_t;
+
+    int fnet_os_thread_init(void);
+    void fnet_os_thread_release(void);
+    int fnet_os_thread_post(fnet_os_thread_msg_t *msg);
+    void fnet_os_thread_dispatch(void);
+    void fnet_os_thread_tick(void);
+
+    /* OS-specific part of the stack thread.*/
+    int fnet_os_thread_start(void);
+    void fnet_os_thread_stop(void);
+    void fnet_os_thread_signal(void);
+    void fnet_os_thread_signal_isr(void);
+    int fnet_os_thread_is_self(void);
+    void fnet_os_thread_mbox_lock(void);
+    void fnet_os_thread_mbox_unlock(void);
+#else
+    #define fnet_os_thread_init()       FNET_OK
+    #define fnet_os_thread_release()    {}
+#endif
+
 #ifdef FNET_CFG_OS_CHIBIOS
     void fnetThdStart(void);
 #endif
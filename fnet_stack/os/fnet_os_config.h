@@ -195,6 +195,53 @@
 	#define FNET_CFG_OS_TIMER   (0)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_OS_THREAD
+ * @brief    Stack thread execution model:
+ *               - @c 1 = is enabled. @n
+ *                        All protocol processing (interrupt bottom halves, 
+ *                        timers and posted messages) is executed by a single 
+ *                        OS thread. Interrupt bottom halves of drivers are 
+ *                        deferred to it, applications hand work over 
+ *                        to it by fnet_os_thread_post(), without blocking.@n
+ *                        It requires @ref FNET_CFG_OS_MUTEX.
+ *               - @b @c 0 = is disabled (Default value). 
+ ******************************************************************************/
+#ifndef FNET_CFG_OS_THREAD
+	#define FNET_CFG_OS_THREAD   (0)
+#endif
+
+#if FNET_CFG_OS_THREAD && !FNET_CFG_OS_MUTEX
+    #error "FNET_CFG_OS_THREAD requires FNET_CFG_OS_MUTEX."
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_OS_THREAD_MBOX_SIZE
+ * @brief    Size of the stack thread mailbox, in messages. @n
+ *           It must be a power of two. 
+ *           fnet_os_thread_post() fails, when the mailbox is full. @n
+ *           The mailbox is lock-free on Cortex-M3/M4 (GCC), where producers 
+ *           claim slots by an atomic compare-and-swap. On other cores 
+ *           the claim takes a short port critical section.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_OS_THREAD_MBOX_SIZE
+	#define FNET_CFG_OS_THREAD_MBOX_SIZE   (16)
+#endif
+
+#if (FNET_CFG_OS_THREAD_MBOX_SIZE < 2) || (FNET_CFG_OS_THREAD_MBOX_SIZE & (FNET_CFG_OS_THREAD_MBOX_SIZE - 1))
+    #error "FNET_CFG_OS_THREAD_MBOX_SIZE must be a power of two."
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_OS_THREAD_STACK_SIZE
+ * @brief    Stack size of the stack thread, in bytes.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_OS_THREAD_STACK_SIZE
+	#define FNET_CFG_OS_THREAD_STACK_SIZE   (2048)
+#endif
+
 /*! @} */
 
 #endif /* _FNET_OS_CONFIG_H_ */
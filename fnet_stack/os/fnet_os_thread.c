@@ -0,0 +1,241 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_os_thread.c
+*
+* @author Andrey Butok
+*
+* @brief Stack thread execution model. OS-independent part. @n
+*        Experimental. Not supported.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_OS && FNET_CFG_OS_THREAD
+
+#include "fnet_isr.h"
+#include "fnet_timer_prv.h"
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_OS_THREAD_MBOX_MASK    (FNET_CFG_OS_THREAD_MBOX_SIZE - 1)
+
+/* Atomic compare-and-swap of the mailbox head. 
+ * It returns non-zero, if *ptr was equal to old_value and is replaced.
+ * Cores without it fall back to fnet_os_thread_mbox_lock().*/
+#ifndef FNET_OS_THREAD_CAS
+    #if defined(__GNUC__) && (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)) /* Cortex-M3/M4, LDREX/STREX.*/
+        #define FNET_OS_THREAD_CAS(ptr, old_value, new_value)   __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+    #endif
+#endif
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+/* Mailbox. It has one consumer, the stack thread, which does not lock it.
+ * A producer claims a slot by the atomic increment of the head,
+ * and publishes its message by storing the pointer to the slot.
+ * An empty slot is FNET_NULL.*/
+static fnet_os_thread_msg_t * volatile  fnet_os_thread_mbox[FNET_CFG_OS_THREAD_MBOX_SIZE];
+static volatile unsigned long           fnet_os_thread_mbox_head;   /* Claimed by producers.*/
+static volatile unsigned long           fnet_os_thread_mbox_tail;   /* Written by the stack thread.*/
+
+static volatile int             fnet_os_thread_tick_pended; /* Timer tick is not processed yet.*/
+
+/************************************************************************
+* NAME: fnet_os_thread_init
+*
+* DESCRIPTION: Initializes the mailbox and starts the stack thread.
+*************************************************************************/
+int fnet_os_thread_init(void)
+{
+    int i;
+
+    for(i = 0; i < FNET_CFG_OS_THREAD_MBOX_SIZE; i++)
+        fnet_os_thread_mbox[i] = FNET_NULL;
+
+    fnet_os_thread_mbox_head = 0;
+    fnet_os_thread_mbox_tail = 0;
+    fnet_os_thread_tick_pended = FNET_FALSE;
+
+    return fnet_os_thread_start();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_release
+*
+* DESCRIPTION: Stops the stack thread.
+*              Messages left in the mailbox are not executed.
+*************************************************************************/
+void fnet_os_thread_release(void)
+{
+    fnet_os_thread_stop();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_claim
+*
+* DESCRIPTION: Claims a free mailbox slot.
+*
+* RETURNS: FNET_OK and the slot index, or FNET_ERR if the mailbox is full.
+*************************************************************************/
+static int fnet_os_thread_mbox_claim(unsigned long *index)
+{
+    unsigned long head;
+#ifdef FNET_OS_THREAD_CAS
+
+    do
+    {
+        head = fnet_os_thread_mbox_head;
+
+        if((head - fnet_os_thread_mbox_tail) >= FNET_CFG_OS_THREAD_MBOX_SIZE)
+            return FNET_ERR;
+    }
+    while(!FNET_OS_THREAD_CAS(&fnet_os_thread_mbox_head, head, head + 1));
+
+#else
+    int result = FNET_OK;
+
+    fnet_os_thread_mbox_lock();
+
+    head = fnet_os_thread_mbox_head;
+
+    if((head - fnet_os_thread_mbox_tail) < FNET_CFG_OS_THREAD_MBOX_SIZE)
+        fnet_os_thread_mbox_head = head + 1;
+    else
+        result = FNET_ERR;
+
+    fnet_os_thread_mbox_unlock();
+
+    if(result == FNET_ERR)
+        return FNET_ERR;
+#endif /* FNET_OS_THREAD_CAS */
+
+    *index = head;
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_post
+*
+* DESCRIPTION: Hands the message over to the stack thread.
+*              It does not wait for its execution. Task context only.
+*              The caller may poll msg->done, or use msg->complete().
+*
+* RETURNS: FNET_OK, or FNET_ERR if the mailbox is full.
+*************************************************************************/
+int fnet_os_thread_post(fnet_os_thread_msg_t *msg)
+{
+    int             result;
+    unsigned long   index;
+
+    if(msg && msg->handler)
+    {
+        msg->done = FNET_FALSE;
+
+        result = fnet_os_thread_mbox_claim(&index);
+
+        if(result == FNET_OK)
+        {
+            fnet_os_thread_mbox[index & FNET_OS_THREAD_MBOX_MASK] = msg; /* Publish it.*/
+            fnet_os_thread_signal();
+        }
+    }
+    else
+    {
+        result = FNET_ERR;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_tick
+*
+* DESCRIPTION: Counts a timer period.
+*              Called by an OS-timer based stack thread,
+*              the timers are processed by the next dispatch.
+*************************************************************************/
+void fnet_os_thread_tick(void)
+{
+    fnet_timer_ticks_inc();
+    fnet_os_thread_tick_pended = FNET_TRUE;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_dispatch
+*
+* DESCRIPTION: Executes timers, posted messages and pended interrupt
+*              bottom halves. Called only by the stack thread,
+*              with the stack mutex taken.
+*************************************************************************/
+void fnet_os_thread_dispatch(void)
+{
+    fnet_os_thread_msg_t    *msg;
+    int                     completed = FNET_FALSE;
+
+    fnet_isr_lock();
+
+    if(fnet_os_thread_tick_pended)
+    {
+        fnet_os_thread_tick_pended = FNET_FALSE;
+        fnet_timer_handler_bottom(FNET_NULL);
+    }
+
+    while(fnet_os_thread_mbox_tail != fnet_os_thread_mbox_head)
+    {
+        msg = fnet_os_thread_mbox[fnet_os_thread_mbox_tail & FNET_OS_THREAD_MBOX_MASK];
+        
+        if(msg == FNET_NULL)
+            break;  /* Claimed, but not published yet. Its producer signals the thread after publishing.*/
+        
+        fnet_os_thread_mbox[fnet_os_thread_mbox_tail & FNET_OS_THREAD_MBOX_MASK] = FNET_NULL;
+        fnet_os_thread_mbox_tail++; /* Free the slot.*/
+
+        msg->handler(msg->cookie);
+        msg->done = FNET_TRUE;
+
+        if(msg->complete)
+            msg->complete(msg);
+
+        completed = FNET_TRUE;
+    }
+
+    fnet_isr_unlock(); /* Executes the pended bottom halves.*/
+
+    if(completed)
+        fnet_os_event_raise(); /* Wake up the waiting applications.*/
+}
+
+#endif /* FNET_CFG_OS && FNET_CFG_OS_THREAD */
@@ -111,6 +111,10 @@ int fnet_os_mutex_init(void)
 		return FNET_OK;
 }
 
+#if FNET_CFG_LOCK_PROFILE
+    #undef fnet_os_mutex_lock /* The function is profiled by fnet_os_mutex_lock_site().*/
+#endif
+
 /************************************************************************
 * NAME: fnet_os_mutex_lock;
 *
@@ -142,4 +146,203 @@ void fnet_os_mutex_release(void)
 }
 #endif /* FNET_CFG_OS_MUTEX */
 
+#if FNET_CFG_OS_THREAD
+
+#include	"task.h"
+
+/* Requires INCLUDE_xTaskGetCurrentTaskHandle in FreeRTOSConfig.h.*/
+
+#ifndef FNET_FREERTOS_THREAD_PRIORITY
+    #define FNET_FREERTOS_THREAD_PRIORITY   (tskIDLE_PRIORITY + 2)
+#endif
+
+/************************************************************************
+*     Globals
+*************************************************************************/
+static xTaskHandle              FNetThread = NULL;
+static xSemaphoreHandle         FNetThreadSemaphore = NULL;
+static volatile int             FNetThreadExit;
+static volatile portTickType    FNetThreadPeriod;   /* Timer period in OS ticks. 0, until fnet_os_timer_init().*/
+
+/************************************************************************
+* NAME: fnet_os_thread_task
+*
+* DESCRIPTION: Stack thread. Executes all protocol processing:
+*              interrupt bottom halves, timers and posted messages.
+*************************************************************************/
+static void fnet_os_thread_task(void *params)
+{
+    portTickType    tick_time = xTaskGetTickCount();
+    portTickType    period;
+    portTickType    elapsed;
+    portTickType    timeout;
+
+    (void)params;
+
+    while(!FNetThreadExit)
+    {
+        period = FNetThreadPeriod;
+        elapsed = xTaskGetTickCount() - tick_time;
+
+        /* Wake up for the next timer period.*/
+        if(period == 0)
+            timeout = portMAX_DELAY;
+        else if(elapsed < period)
+            timeout = period - elapsed;
+        else
+            timeout = 0;
+
+        xSemaphoreTake(FNetThreadSemaphore, timeout);
+
+        if(period)
+        {
+            while((portTickType)(xTaskGetTickCount() - tick_time) >= period)
+            {
+                tick_time += period;
+                fnet_os_thread_tick();
+            }
+        }
+        else
+        {
+            tick_time = xTaskGetTickCount();
+        }
+
+        fnet_os_mutex_lock();
+        fnet_os_thread_dispatch();
+        fnet_os_mutex_unlock();
+    }
+
+    FNetThread = NULL;
+    vTaskDelete(NULL);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_start
+*
+* DESCRIPTION: Creates the stack thread.
+*************************************************************************/
+int fnet_os_thread_start(void)
+{
+    if (FNetThreadSemaphore == NULL)
+    {
+        vSemaphoreCreateBinary(FNetThreadSemaphore);
+
+        if (FNetThreadSemaphore == NULL)
+            return FNET_ERR;
+    }
+
+    xSemaphoreTake(FNetThreadSemaphore, 0); /* Created given, make it empty.*/
+    FNetThreadExit = FNET_FALSE;
+
+    if (xTaskCreate(fnet_os_thread_task, (signed char *)"FNET stack", 
+                    (FNET_CFG_OS_THREAD_STACK_SIZE/sizeof(portSTACK_TYPE)), NULL, 
+                    FNET_FREERTOS_THREAD_PRIORITY, &FNetThread) != pdPASS)
+        return FNET_ERR;
+    else
+        return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_stop
+*
+* DESCRIPTION: Requests the stack thread to exit.
+*************************************************************************/
+void fnet_os_thread_stop(void)
+{
+    FNetThreadExit = FNET_TRUE;
+    xSemaphoreGive(FNetThreadSemaphore);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal
+*
+* DESCRIPTION: Wakes up the stack thread. Task context.
+*************************************************************************/
+void fnet_os_thread_signal(void)
+{
+    xSemaphoreGive(FNetThreadSemaphore);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal_isr
+*
+* DESCRIPTION: Wakes up the stack thread. Interrupt context.
+*************************************************************************/
+void fnet_os_thread_signal_isr(void)
+{
+    portBASE_TYPE   woken = pdFALSE;
+
+    xSemaphoreGiveFromISR(FNetThreadSemaphore, &woken);
+
+    portEND_SWITCHING_ISR(woken);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_is_self
+*
+* DESCRIPTION: Returns FNET_TRUE if it is called by the stack thread.
+*************************************************************************/
+int fnet_os_thread_is_self(void)
+{
+    if((FNetThread != NULL) && (xTaskGetCurrentTaskHandle() == FNetThread))
+        return FNET_TRUE;
+    else
+        return FNET_FALSE;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_lock
+*
+* DESCRIPTION: Serializes the mailbox producers, while a slot is claimed.
+*              Used only on cores without FNET_OS_THREAD_CAS.
+*************************************************************************/
+void fnet_os_thread_mbox_lock(void)
+{
+    taskENTER_CRITICAL();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_unlock
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_thread_mbox_unlock(void)
+{
+    taskEXIT_CRITICAL();
+}
+
+#if FNET_CFG_OS_TIMER
+
+/************************************************************************
+* NAME: fnet_os_timer_init
+*
+* DESCRIPTION: Starts the timer. The timer periods are counted 
+*              by the stack thread.
+*************************************************************************/
+int fnet_os_timer_init( unsigned int period_ms )
+{
+    FNetThreadPeriod = (portTickType)(period_ms / portTICK_RATE_MS);
+
+    if(FNetThreadPeriod == 0)
+        FNetThreadPeriod = 1;
+
+    xSemaphoreGive(FNetThreadSemaphore);
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_timer_release
+*
+* DESCRIPTION: Stops the timer.
+*************************************************************************/
+void fnet_os_timer_release( void )
+{
+    FNetThreadPeriod = 0;
+}
+
+#endif /* FNET_CFG_OS_TIMER */
+
+#endif /* FNET_CFG_OS_THREAD */
+
 #endif
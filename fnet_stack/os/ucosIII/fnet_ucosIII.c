@@ -71,4 +71,213 @@ void fnet_os_timer_release( void )
 
 #endif /* FNET_CFG_OS_TIMER */
 
+#if FNET_CFG_OS_MUTEX || FNET_CFG_OS_THREAD
+#include    "os.h"
+#endif
+
+#if FNET_CFG_OS_MUTEX
+
+static OS_MUTEX FnetMutex;
+
+/************************************************************************
+* NAME: fnet_os_mutex_init
+*
+* DESCRIPTION: uCOS-III mutexes may be nested by the owner.
+*************************************************************************/
+int fnet_os_mutex_init(void)
+{
+	OS_ERR err;
+
+	OSMutexCreate(&FnetMutex, "FNET", &err);
+	
+	return (err == OS_ERR_NONE) ? FNET_OK : FNET_ERR;
+}
+
+#if FNET_CFG_LOCK_PROFILE
+    #undef fnet_os_mutex_lock /* The function is profiled by fnet_os_mutex_lock_site().*/
+#endif
+
+/************************************************************************
+* NAME: fnet_os_mutex_lock
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_mutex_lock(void)
+{
+	OS_ERR err;
+	CPU_TS ts;
+
+	OSMutexPend(&FnetMutex, 0, OS_OPT_PEND_BLOCKING, &ts, &err);
+}
+
+/************************************************************************
+* NAME: fnet_os_mutex_unlock
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_mutex_unlock(void)
+{
+	OS_ERR err;
+
+	OSMutexPost(&FnetMutex, OS_OPT_POST_NONE, &err);
+}
+
+/************************************************************************
+* NAME: fnet_os_mutex_release
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_mutex_release(void)
+{
+	OS_ERR err;
+
+	OSMutexDel(&FnetMutex, OS_OPT_DEL_ALWAYS, &err);
+}
+
+#endif /* FNET_CFG_OS_MUTEX */
+
+#if FNET_CFG_OS_THREAD
+
+#ifndef FNET_UCOSIII_THREAD_PRIORITY
+    #define FNET_UCOSIII_THREAD_PRIORITY    (5)
+#endif
+
+#define FNET_UCOSIII_THREAD_STACK_SIZE      (FNET_CFG_OS_THREAD_STACK_SIZE/sizeof(CPU_STK))
+
+static OS_TCB       FnetThreadTCB;
+static CPU_STK      FnetThreadStack[FNET_UCOSIII_THREAD_STACK_SIZE];
+static OS_SEM       FnetThreadSemaphore;
+static volatile int FnetThreadStarted;
+static volatile int FnetThreadExit;
+
+/************************************************************************
+* NAME: fnet_os_thread_task
+*
+* DESCRIPTION: Stack thread. Executes all protocol processing:
+*              interrupt bottom halves (including the timer)
+*              and posted messages.
+*************************************************************************/
+static void fnet_os_thread_task(void *p_arg)
+{
+	OS_ERR err;
+	CPU_TS ts;
+
+	(void)p_arg;
+
+	while(!FnetThreadExit)
+	{
+		OSSemPend(&FnetThreadSemaphore, 0, OS_OPT_PEND_BLOCKING, &ts, &err);
+
+		if(!FnetThreadExit)
+		{
+			fnet_os_mutex_lock();
+			fnet_os_thread_dispatch();
+			fnet_os_mutex_unlock();
+		}
+	}
+
+	FnetThreadStarted = FNET_FALSE;
+	OSTaskDel((OS_TCB *)0, &err);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_start
+*
+* DESCRIPTION: Creates the stack thread.
+*************************************************************************/
+int fnet_os_thread_start(void)
+{
+	OS_ERR err;
+
+	FnetThreadExit = FNET_FALSE;
+
+	OSSemCreate(&FnetThreadSemaphore, "FNET stack", 0, &err);
+	if(err != OS_ERR_NONE)
+		return FNET_ERR;
+
+	OSTaskCreate(&FnetThreadTCB, "FNET stack", fnet_os_thread_task, (void *)0, 
+	             FNET_UCOSIII_THREAD_PRIORITY, &FnetThreadStack[0], 
+	             FNET_UCOSIII_THREAD_STACK_SIZE/10, FNET_UCOSIII_THREAD_STACK_SIZE, 
+	             0, 0, (void *)0, (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR), &err);
+	if(err != OS_ERR_NONE)
+		return FNET_ERR;
+
+	FnetThreadStarted = FNET_TRUE;
+	return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_stop
+*
+* DESCRIPTION: Requests the stack thread to exit.
+*************************************************************************/
+void fnet_os_thread_stop(void)
+{
+	FnetThreadExit = FNET_TRUE;
+	fnet_os_thread_signal();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal
+*
+* DESCRIPTION: Wakes up the stack thread. Task or interrupt context.
+*************************************************************************/
+void fnet_os_thread_signal(void)
+{
+	OS_ERR err;
+
+	if(FnetThreadStarted)
+		OSSemPost(&FnetThreadSemaphore, OS_OPT_POST_1, &err);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_signal_isr
+*
+* DESCRIPTION: Wakes up the stack thread. Interrupt context.
+*************************************************************************/
+void fnet_os_thread_signal_isr(void)
+{
+	fnet_os_thread_signal();
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_is_self
+*
+* DESCRIPTION: Returns FNET_TRUE if it is called by the stack thread.
+*************************************************************************/
+int fnet_os_thread_is_self(void)
+{
+	if(FnetThreadStarted && (OSTCBCurPtr == &FnetThreadTCB))
+		return FNET_TRUE;
+	else
+		return FNET_FALSE;
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_lock
+*
+* DESCRIPTION: Serializes the mailbox producers, while a slot is claimed (tasks only).
+*              Used only on cores without FNET_OS_THREAD_CAS.
+*************************************************************************/
+void fnet_os_thread_mbox_lock(void)
+{
+	OS_ERR err;
+
+	OSSchedLock(&err);
+}
+
+/************************************************************************
+* NAME: fnet_os_thread_mbox_unlock
+*
+* DESCRIPTION: 
+*************************************************************************/
+void fnet_os_thread_mbox_unlock(void)
+{
+	OS_ERR err;
+
+	OSSchedUnlock(&err);
+}
+
+#endif /* FNET_CFG_OS_THREAD */
+
 #endif /* FNET_CFG_OS && FNET_CFG_OS_UCOSIII && FNET_MCF */
@@ -56,6 +56,11 @@
     #define FNET_CFG_OS_TIMER   (0)
 #endif
 
+/* The stack thread needs the mutex.*/
+#if !defined(FNET_CFG_OS_MUTEX) && defined(FNET_CFG_OS_THREAD)
+    #define FNET_CFG_OS_MUTEX   FNET_CFG_OS_THREAD
+#endif
+
 /* @} */
 
 #endif /* _FNET_UCOSIII_CONFIG_H_ */
@@ -53,6 +53,9 @@
 #include "fnet.h"
 #include "fnet_fs_root.h"
 
+/* Size of the buffer used by fnet_sendfile() for file systems without direct access.*/
+#define FNET_FS_SENDFILE_BUF_SIZE   (64)
+
 /* Mount point list */
 struct fnet_fs_mount_point fnet_fs_mount_list[FNET_CFG_FS_MOUNT_MAX];
 
@@ -695,5 +698,104 @@ int fnet_fs_finfo (FNET_FS_FILE file, struct fnet_fs_dirent *info)
     return result;
 }
 
+/************************************************************************
+* NAME: fnet_fs_fmap
+*
+* DESCRIPTION: Returns pointer to the file content, if the FS 
+*              supports direct access.
+*************************************************************************/
+const void *fnet_fs_fmap(FNET_FS_FILE file, unsigned long offset, unsigned long *size)
+{
+    const void *result = 0;
+    struct fnet_fs_desc *filep = (struct fnet_fs_desc *) file;
+    
+    if(filep && size)
+    {
+        fnet_os_mutex_lock();
+        if(filep->mount && filep->mount->fs 
+            && filep->mount->fs->file_operations
+            && filep->mount->fs->file_operations->fmap)
+        {
+            result = filep->mount->fs->file_operations->fmap(filep, offset, size);    
+        }
+        fnet_os_mutex_unlock();	
+    }
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_sendfile
+*
+* DESCRIPTION: Sends the file content on a connected socket. 
+*              If possible, the content is not copied.
+*************************************************************************/
+int fnet_sendfile(SOCKET s, FNET_FS_FILE file, unsigned long offset, int len)
+{
+    int                 result = 0;
+    struct fnet_fs_desc *filep = (struct fnet_fs_desc *) file;
+    unsigned long       size = (unsigned long)len;
+    const void          *data;
+    char                buf[FNET_FS_SENDFILE_BUF_SIZE];
+    unsigned long       pos;
+    int                 res;
+    
+    if((filep == 0) || (len < 0))
+    {
+        fnet_error_set(FNET_ERR_INVAL);
+        return SOCKET_ERROR;
+    }
+    
+    if(len)
+    {
+        if((data = fnet_fs_fmap(file, offset, &size)) != 0)
+        /* Direct access, send by reference.*/
+        {
+            result = fnet_send_ref(s, data, (int)size, 0, FNET_NULL, FNET_NULL);
+        }
+        else if(filep->mount && filep->mount->fs 
+            && filep->mount->fs->file_operations
+            && (filep->mount->fs->file_operations->fmap == 0)
+            && filep->mount->fs->file_operations->fread)
+        /* No direct access, read and send.*/
+        {
+            fnet_os_mutex_lock();
+            pos = filep->pos; /* Keep the position indicator.*/
+            
+            while(result < len)
+            {
+                size = (unsigned long)(len - result);
+                if(size > sizeof(buf))
+                    size = sizeof(buf);
+                
+                filep->pos = offset + (unsigned long)result;
+                size = filep->mount->fs->file_operations->fread(filep, buf, size);
+                
+                if(size == 0)
+                    break;
+                    
+                res = send(s, buf, (int)size, 0);
+                
+                if(res == SOCKET_ERROR)
+                {
+                    if(result == 0)
+                        result = SOCKET_ERROR;
+                    break;
+                }
+
+                result += res;
+
+                if((unsigned long)res < size) /* Send buffer is full.*/
+                    break;
+            }
+
+            filep->pos = pos;
+            fnet_os_mutex_unlock();	
+        }
+        /* else Offset is beyond the end of the file, nothing to send.*/
+    }
+    
+    return result;
+}
+
 #endif /* FNET_CFG_FS */
 
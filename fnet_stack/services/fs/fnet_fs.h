@@ -48,6 +48,7 @@
 #define _FNET_FS_H_
 
 #include "fnet_config.h"
+#include "fnet_socket.h"
 
 #if FNET_CFG_FS || defined(__DOXYGEN__)
 
@@ -83,6 +84,10 @@
 * <td>Move/get a file pointer.</td>
 * </tr>
 * <tr>
+* <td>@ref fnet_fs_fmap(), @ref fnet_sendfile()</td>
+* <td>Access/send a file content without copying.</td>
+* </tr>
+* <tr>
 * <td>@ref fnet_fs_opendir(), @ref fnet_fs_closedir()</td>
 * <td>Open/close a directory.</td>
 * </tr>
@@ -675,6 +680,65 @@ long fnet_fs_ftell (FNET_FS_FILE file);
  ******************************************************************************/
 int fnet_fs_finfo (FNET_FS_FILE file, struct fnet_fs_dirent *dirent);
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Gets direct access to a file content.
+ *
+ * @param file      File descriptor.
+ *
+ * @param offset    Offset of the content from the beginning of the file.
+ *
+ * @param size      Pointer to the number of bytes to access. @n
+ *                  On return, it is limited by the end of the file.
+ *
+ * @return This function returns:
+ *   - Pointer to the file content placed at the @c offset, if no error occurs.
+ *   - @c 0 if the file system does not support direct access,
+ *     or the @c offset is beyond the end of the file.
+ *
+ * @see fnet_sendfile()
+ *
+ ******************************************************************************
+ *
+ * This function returns a pointer to the file content, stored in memory 
+ * by the file system (for example, the @ref fnet_fs_rom image), so it can 
+ * be used without copying. @n
+ * The position indicator of the @c file is not changed.
+ *
+ ******************************************************************************/
+const void *fnet_fs_fmap(FNET_FS_FILE file, unsigned long offset, unsigned long *size);
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Sends a file content on a connected socket.
+ *
+ * @param s         Descriptor, identifying a connected socket.
+ *
+ * @param file      File descriptor.
+ *
+ * @param offset    Offset of the content from the beginning of the file.
+ *
+ * @param len       Number of bytes to send.
+ *
+ * @return This function returns:
+ *   - The total number of bytes sent, if no error occurs. 
+ *     It can be less than the number indicated by @c len.
+ *   - @ref SOCKET_ERROR if an error occurs. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see fnet_fs_fmap(), fnet_send_ref()
+ *
+ ******************************************************************************
+ *
+ * If the file system supports direct access to the file content 
+ * (see @ref fnet_fs_fmap()), the data is referenced in place by 
+ * the @ref fnet_send_ref(), so it is never copied to RAM.
+ * Otherwise, the data is read and sent by the @ref send(). @n
+ * The position indicator of the @c file is not changed.
+ *
+ ******************************************************************************/
+int fnet_sendfile(SOCKET s, FNET_FS_FILE file, unsigned long offset, int len);
+
 
 /*! @} */
 
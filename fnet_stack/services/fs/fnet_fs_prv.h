@@ -88,6 +88,7 @@ struct fnet_fs_file_operations
     unsigned long (*fread) (struct fnet_fs_desc *file, char * buf, unsigned long bytes); 
     int (*fseek) (struct fnet_fs_desc *file, long offset, fnet_fs_seek_origin_t origin);
     int (*finfo) (struct fnet_fs_desc *file, struct fnet_fs_dirent *dirent);
+    const void * (*fmap) (struct fnet_fs_desc *file, unsigned long offset, unsigned long *bytes); /* Optional. Direct access to the file content. */
 };
 
 /* Dir operations. */
@@ -61,6 +61,7 @@ unsigned long fnet_fs_rom_fread (struct fnet_fs_desc *file, char * buf, unsigned
 int fnet_fs_rom_mount( void *arg );
 int fnet_fs_rom_fseek (struct fnet_fs_desc *file, long offset, fnet_fs_seek_origin_t origin) ;
 int fnet_fs_rom_finfo (struct fnet_fs_desc *file, struct fnet_fs_dirent *info);
+const void * fnet_fs_rom_fmap (struct fnet_fs_desc *file, unsigned long offset, unsigned long *bytes);
 static const struct fnet_fs_rom_node * fnet_fs_rom_find(const struct fnet_fs_rom_node * file_table, const char *name);
 static void fnet_fs_rom_fill_dirent(struct fnet_fs_rom_node * node, struct fnet_fs_dirent* dirent);
 
@@ -77,7 +78,8 @@ static const struct fnet_fs_file_operations fnet_fs_rom_file_operations =
     fnet_fs_rom_fopen,
     fnet_fs_rom_fread,
     fnet_fs_rom_fseek,
-    fnet_fs_rom_finfo
+    fnet_fs_rom_finfo,
+    fnet_fs_rom_fmap
 };
 
 /* FS operations */
@@ -423,4 +425,30 @@ int fnet_fs_rom_finfo (struct fnet_fs_desc *file, struct fnet_fs_dirent *dirent)
     return result;
 }
 
+/************************************************************************
+* NAME: fnet_fs_rom_fmap
+*
+* DESCRIPTION: Returns pointer to the file content placed at the offset.
+*              The number of bytes is limited by the end of the file.
+*************************************************************************/
+const void * fnet_fs_rom_fmap (struct fnet_fs_desc *file, unsigned long offset, unsigned long *bytes)
+{
+    const void *result = 0;
+    struct fnet_fs_rom_node * current;
+    
+    if(file && file->id && bytes)
+    {
+        current = (struct fnet_fs_rom_node *)(file->id); 
+        if(current->data && (offset < current->data_size))
+        {
+            if(*bytes > (current->data_size - offset))
+                *bytes = current->data_size - offset;
+                
+            result = &current->data[offset];
+        }
+    }
+    
+    return result;
+}
+
 #endif
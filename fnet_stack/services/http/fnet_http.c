@@ -534,8 +534,14 @@ static void fnet_http_state_machine( void *http_if_p )
                     if(send_size > http->send_max)
                         send_size = (int)http->send_max;
                     
-                    if((res = send(session->socket_foreign, session->buffer
-                                  + session->response.buffer_sent, send_size, 0)) != SOCKET_ERROR)
+                    if(session->response.send_file_ref) /* File data, without copying.*/
+                        res = fnet_sendfile(session->socket_foreign, session->send_param.file_desc, 
+                                            session->response.send_file_offset, send_size);
+                    else
+                        res = send(session->socket_foreign, session->buffer 
+                                   + session->response.buffer_sent, send_size, 0);
+                    
+                    if(res != SOCKET_ERROR)
                     {
                         if(res)
                         {
@@ -543,6 +549,9 @@ static void fnet_http_state_machine( void *http_if_p )
 
                             session->state_time = fnet_timer_ticks();              /* reset timeout */
                             session->response.buffer_sent += res;
+                            
+                            if(session->response.send_file_ref)
+                                session->response.send_file_offset += res;
                         }
                         break; /* => SENDING */ 
                     }
@@ -1011,8 +1020,17 @@ int fnet_http_default_handle (struct fnet_http_if * http, struct fnet_http_uri *
 unsigned long fnet_http_default_send (struct fnet_http_if * http)
 {
     struct fnet_http_session_if *session =  http->session_active;
+    unsigned long               result = http->send_max;
 
-    return fnet_fs_fread(session->buffer, sizeof(session->buffer), session->send_param.file_desc);
+    /* If the file content is accessible directly (ROM FS), it is sent in place.*/
+    if(fnet_fs_fmap(session->send_param.file_desc, session->response.send_file_offset, &result))
+        session->response.send_file_ref = 1;
+    else if(session->response.send_file_ref)
+        result = 0; /* End of file.*/
+    else
+        result = fnet_fs_fread(session->buffer, sizeof(session->buffer), session->send_param.file_desc);
+    
+    return result;
 }
 
 /************************************************************************
@@ -172,6 +172,8 @@ struct fnet_http_response
     unsigned long                           buffer_sent;                /* A number of bytes were sent.*/
     int                                     status_line_state;
     long                                    cookie;
+    char                                    send_file_ref;              /* File data are sent in place by fnet_sendfile(), the buffer is not used.*/
+    unsigned long                           send_file_offset;           /* File offset of the next data to be sent by fnet_sendfile().*/
     
 #if FNET_CFG_HTTP_VERSION_MAJOR /* HTTP/1.x*/    
     const struct fnet_http_content_type     *send_file_content_type; /* MIME Content-Type.*/
@@ -57,6 +57,8 @@
 #include "fnet_error.h"
 #include "fnet_debug.h"
 #include "fnet_isr.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
 
 
 
@@ -71,12 +73,27 @@
 *************************************************************************/
 
 static void fnet_arp_timer( void *cookie );
+static unsigned int fnet_arp_hash( fnet_ip4_addr_t ipaddr );
+static fnet_arp_entry_t *fnet_arp_find( fnet_arp_if_t *arpif, fnet_ip4_addr_t ipaddr );
+static void fnet_arp_lru_move( fnet_arp_if_t *arpif, fnet_arp_entry_t *entry, int to_head );
+static fnet_arp_entry_t *fnet_arp_new_entry( fnet_arp_if_t *arpif, fnet_ip4_addr_t ipaddr );
+static void fnet_arp_del_entry( fnet_arp_if_t *arpif, fnet_arp_entry_t *entry );
+static void fnet_arp_confirm_entry( fnet_arp_entry_t *entry, const fnet_mac_addr_t ethaddr );
 static fnet_arp_entry_t *fnet_arp_add_entry( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, 
                                             const fnet_mac_addr_t ethaddr );
 static fnet_arp_entry_t *fnet_arp_update_entry( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr,
                                             fnet_mac_addr_t ethaddr );
+static void fnet_arp_hold_send( fnet_netif_t *netif, fnet_arp_entry_t *entry );
+static void fnet_arp_hold_free( fnet_arp_entry_t *entry );
+static void fnet_arp_send_request( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t dest_addr );
 static void fnet_arp_ip_duplicated(void *cookie);
 
+/* Binary trace of an ARP packet.*/
+#define FNET_ARP_TRACE(event, arp_hdr)  \
+    FNET_TRACE(FNET_TRACE_LAYER_ARP, (event), fnet_ntohl((arp_hdr)->sender_prot_addr ^ (arp_hdr)->targer_prot_addr), \
+               fnet_ntohl((arp_hdr)->sender_prot_addr), fnet_ntohl((arp_hdr)->targer_prot_addr), \
+               fnet_ntohs((arp_hdr)->op), sizeof(fnet_arp_header_t))
+
 #if FNET_CFG_DEBUG_TRACE_ARP
     static void fnet_arp_trace(char *str, fnet_arp_header_t *arp_hdr);
 #else
@@ -95,11 +112,24 @@ int fnet_arp_init( fnet_netif_t *netif )
     int            i;
     int            result= FNET_ERR;
 
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; i++)
-      fnet_memset_zero(&(arpif->arp_table[i]), sizeof(fnet_arp_entry_t));
+    fnet_memset_zero(arpif->arp_table, sizeof(arpif->arp_table));
+    fnet_memset_zero(arpif->arp_hash, sizeof(arpif->arp_hash));
+
+    /* All entries are free and linked into the LRU list.*/
+    for (i = 0; i < FNET_CFG_ARP_TABLE_SIZE; i++)
+    {
+        if(i > 0)
+            arpif->arp_table[i].lru_prev = &arpif->arp_table[i - 1];
+        
+        if(i < (FNET_CFG_ARP_TABLE_SIZE - 1))
+            arpif->arp_table[i].lru_next = &arpif->arp_table[i + 1];
+    }
+    
+    arpif->arp_lru_head = &arpif->arp_table[0];
+    arpif->arp_lru_tail = &arpif->arp_table[FNET_CFG_ARP_TABLE_SIZE - 1];
 
     arpif->arp_tmr = fnet_timer_new((FNET_ARP_TIMER_PERIOD / FNET_TIMER_PERIOD_MS), 
-                        fnet_arp_timer, arpif);
+                        fnet_arp_timer, netif);
 
     if(arpif->arp_tmr)
     {
@@ -120,106 +150,279 @@ int fnet_arp_init( fnet_netif_t *netif )
 void fnet_arp_release( fnet_netif_t *netif )
 {
     fnet_arp_if_t *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    int i;
 
     fnet_timer_free(arpif->arp_tmr);
 
     arpif->arp_tmr = 0;
+
+    for (i = 0; i < FNET_CFG_ARP_TABLE_SIZE; i++)
+        fnet_arp_hold_free(&arpif->arp_table[i]);
 }
 
 /************************************************************************
 * NAME: fnet_arp_timer
 *
-* DESCRIPTION: ARP timer.
+* DESCRIPTION: ARP timer. 
+*              Repeats requests for unresolved entries, refreshes 
+*              entries in use by unicast requests before they expire, 
+*              and deletes expired entries.
 *************************************************************************/
 static void fnet_arp_timer( void *cookie )
 {
-    fnet_arp_if_t *arpif =  (fnet_arp_if_t *)cookie;
-    int i;
+    fnet_netif_t        *netif = (fnet_netif_t *)cookie;
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    fnet_arp_entry_t    *entry;
+    unsigned long       current_time = fnet_timer_ticks();
+    unsigned long       age;
+    int                 i;
 
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; i++)
+    for (i = 0; i < FNET_CFG_ARP_TABLE_SIZE; i++)
     {
-        if((arpif->arp_table[i].prot_addr)
-             && ((fnet_timer_ticks() - arpif->arp_table[i].cr_time))
-                              > (unsigned long)(FNET_ARP_TIMEOUT / FNET_TIMER_PERIOD_MS))
+        entry = &arpif->arp_table[i];
+        
+        if((entry->prot_addr == 0) || entry->is_static)
+            continue;
+
+        if(fnet_memcmp(entry->hard_addr, fnet_eth_null_addr, sizeof(fnet_mac_addr_t)) == 0)
         {
-            if(arpif->arp_table[i].hold)
-                fnet_netbuf_free_chain(arpif->arp_table[i].hold);
+            /* Unresolved entry. */
+            if(fnet_timer_get_interval(entry->hold_time, current_time) >= fnet_timer_ms2ticks(FNET_ARP_REQUEST_INTERVAL))
+            {
+                if(entry->request_count >= FNET_ARP_MAX_REQUESTS)
+                {
+                    /* No reply, give up and drop waiting packets.*/
+                    fnet_arp_del_entry(arpif, entry);
+                }
+                else
+                {
+                    entry->request_count++;
+                    entry->hold_time = current_time;
+                    fnet_arp_request(netif, entry->prot_addr);
+                }
+            }
+        }
+        else
+        {
+            age = fnet_timer_get_interval(entry->cr_time, current_time);
 
-            fnet_memset_zero(&(arpif->arp_table[i]), sizeof(fnet_arp_entry_t));
+            if(age > fnet_timer_ms2ticks(FNET_ARP_TIMEOUT))
+            {
+                fnet_arp_del_entry(arpif, entry);
+            }
+            else if(age > fnet_timer_ms2ticks(FNET_ARP_TIMEOUT - FNET_ARP_REFRESH_TIME))
+            {
+                if(entry->refresh == FNET_FALSE)
+                {
+                    entry->refresh = FNET_TRUE;
+                    
+                    /* Destination caches bypass the ARP lookup. 
+                     * Invalidate them, so the next packet marks the entry as used.*/
+                    if(entry->used == FNET_FALSE)
+                        FNET_NETIF_DST_INVALIDATE();
+                }
+                else if(entry->used && (entry->request_count < FNET_ARP_MAX_REQUESTS)
+                        && (fnet_timer_get_interval(entry->hold_time, current_time) >= fnet_timer_ms2ticks(FNET_ARP_REQUEST_INTERVAL)))
+                {
+                    /* Refresh the entry in use, before it expires.*/
+                    entry->request_count++;
+                    entry->hold_time = current_time;
+                    fnet_arp_send_request(netif, entry->prot_addr, entry->hard_addr);
+                }
+            }
         }
     }
+}
 
+/************************************************************************
+* NAME: fnet_arp_hash
+*
+* DESCRIPTION: Returns the hash bucket index of the IP address.
+*************************************************************************/
+static unsigned int fnet_arp_hash( fnet_ip4_addr_t ipaddr )
+{
+    unsigned long key = (unsigned long)ipaddr;
+    
+    /* Fold all address bytes, it does not depend on the byte order.*/
+    key ^= (key >> 16);
+    key ^= (key >> 8);
+    
+    return (unsigned int)((key & 0xFFu) % FNET_CFG_ARP_HASH_SIZE);
 }
 
 /************************************************************************
-* NAME: fnet_arp_add_entry
+* NAME: fnet_arp_find
 *
-* DESCRIPTION: Adds entry to the ARP table.
+* DESCRIPTION: Looks for the ARP table entry of the IP address.
 *************************************************************************/
-static fnet_arp_entry_t *fnet_arp_add_entry( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, 
-                                        const fnet_mac_addr_t ethaddr )
+static fnet_arp_entry_t *fnet_arp_find( fnet_arp_if_t *arpif, fnet_ip4_addr_t ipaddr )
 {
-    fnet_arp_if_t *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
-    int i, j;
-    unsigned long max_time;
+    fnet_arp_entry_t *entry = arpif->arp_hash[fnet_arp_hash(ipaddr)];
+    
+    while(entry && (entry->prot_addr != ipaddr))
+        entry = entry->hash_next;
+    
+    return entry;
+}
 
-    /* Find an entry to update. */
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; ++i)
+/************************************************************************
+* NAME: fnet_arp_lru_move
+*
+* DESCRIPTION: Moves the entry to the head (the most recently used) 
+*              or to the tail (the first to be reused) of the LRU list.
+*************************************************************************/
+static void fnet_arp_lru_move( fnet_arp_if_t *arpif, fnet_arp_entry_t *entry, int to_head )
+{
+    if((to_head == FNET_TRUE) && (arpif->arp_lru_head == entry))
+        return;
+    
+    /* Unlink.*/
+    if(entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        arpif->arp_lru_head = entry->lru_next;
+    
+    if(entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        arpif->arp_lru_tail = entry->lru_prev;
+    
+    /* Link.*/
+    if(to_head == FNET_TRUE)
     {
-        /* Check if the source IP address of the incoming packet matches
-         * the IP address in this ARP table entry.*/
-        if(ipaddr == arpif->arp_table[i].prot_addr)
-        {
-            /* Update this and return. */
-            fnet_memcpy(arpif->arp_table[i].hard_addr, ethaddr, sizeof(fnet_mac_addr_t));
-            arpif->arp_table[i].cr_time = fnet_timer_ticks();
-            goto ADDED;
-        }
+        entry->lru_prev = FNET_NULL;
+        entry->lru_next = arpif->arp_lru_head;
+        
+        if(arpif->arp_lru_head)
+            arpif->arp_lru_head->lru_prev = entry;
+        else
+            arpif->arp_lru_tail = entry;
+        
+        arpif->arp_lru_head = entry;
+    }
+    else
+    {
+        entry->lru_next = FNET_NULL;
+        entry->lru_prev = arpif->arp_lru_tail;
+        
+        if(arpif->arp_lru_tail)
+            arpif->arp_lru_tail->lru_next = entry;
+        else
+            arpif->arp_lru_head = entry;
+        
+        arpif->arp_lru_tail = entry;
     }
+}
 
-    /* If we get here, no existing ARP table entry was found. */
+/************************************************************************
+* NAME: fnet_arp_new_entry
+*
+* DESCRIPTION: Takes a free entry, or the least recently used 
+*              dynamic entry, for the IP address.
+*              Returns FNET_NULL if all entries are static.
+*************************************************************************/
+static fnet_arp_entry_t *fnet_arp_new_entry( fnet_arp_if_t *arpif, fnet_ip4_addr_t ipaddr )
+{
+    fnet_arp_entry_t    *entry;
+    unsigned int        hash;
 
-    /* Find an unused entry in the ARP table. */
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; ++i)
+    /* Free entries are at the tail of the LRU list.*/
+    entry = arpif->arp_lru_tail;
+    
+    while(entry && entry->is_static)
+        entry = entry->lru_prev;
+    
+    if(entry)
     {
-        if(arpif->arp_table[i].prot_addr == 0)
-        {
-            break;
-        }
+        /* Throw away the least recently used entry.*/
+        if(entry->prot_addr)
+            fnet_arp_del_entry(arpif, entry);
+        
+        entry->prot_addr = ipaddr;
+        entry->cr_time = fnet_timer_ticks();
+        
+        hash = fnet_arp_hash(ipaddr);
+        entry->hash_next = arpif->arp_hash[hash];
+        arpif->arp_hash[hash] = entry;
+        
+        fnet_arp_lru_move(arpif, entry, FNET_TRUE);
     }
+    
+    return entry;
+}
 
-    /* If no unused entry is found, we try to find the oldest entry and throw it away.*/
-    if(i == FNET_ARP_TABLE_SIZE)
-    {
-        max_time = 0;
-        j = 0;
+/************************************************************************
+* NAME: fnet_arp_del_entry
+*
+* DESCRIPTION: Frees the ARP table entry and its waiting packets.
+*************************************************************************/
+static void fnet_arp_del_entry( fnet_arp_if_t *arpif, fnet_arp_entry_t *entry )
+{
+    fnet_arp_entry_t    **bucket = &arpif->arp_hash[fnet_arp_hash(entry->prot_addr)];
+    fnet_arp_entry_t    *lru_prev;
+
+    while(*bucket && (*bucket != entry))
+        bucket = &((*bucket)->hash_next);
+    
+    if(*bucket)
+        *bucket = entry->hash_next;
+    
+    fnet_arp_hold_free(entry);
+    
+    /* The free entry will be reused first.*/
+    fnet_arp_lru_move(arpif, entry, FNET_FALSE);
+    
+    lru_prev = entry->lru_prev;
+    fnet_memset_zero(entry, sizeof(fnet_arp_entry_t));
+    entry->lru_prev = lru_prev;
+    
+    FNET_NETIF_DST_INVALIDATE();
+}
 
-        for (i = 0; i < FNET_ARP_TABLE_SIZE; ++i)
+/************************************************************************
+* NAME: fnet_arp_confirm_entry
+*
+* DESCRIPTION: Updates the hardware address of the entry 
+*              and restarts its lifetime.
+*************************************************************************/
+static void fnet_arp_confirm_entry( fnet_arp_entry_t *entry, const fnet_mac_addr_t ethaddr )
+{
+    /* Static entries are not changed by ARP packets.*/
+    if(entry->is_static == FNET_FALSE)
+    {
+        if(fnet_memcmp(entry->hard_addr, ethaddr, sizeof(fnet_mac_addr_t)))
         {
-            if((fnet_timer_ticks() - arpif->arp_table[i].cr_time) > max_time)
-            {
-                max_time = fnet_timer_ticks() - arpif->arp_table[i].cr_time;
-                j = i;
-            }
+            /* Destination caches hold the old address.*/
+            FNET_NETIF_DST_INVALIDATE();
+            
+            fnet_memcpy(entry->hard_addr, ethaddr, sizeof(fnet_mac_addr_t));
         }
-
-        i = j;
+        
+        entry->cr_time = fnet_timer_ticks();
+        entry->request_count = 0;
+        entry->used = FNET_FALSE;
+        entry->refresh = FNET_FALSE;
     }
+}
 
-    /* Now, it is the ARP table entry which we will fill with the new information. */
-    if(arpif->arp_table[i].hold)
-    {
-        fnet_netbuf_free_chain(arpif->arp_table[i].hold);
-        arpif->arp_table[i].hold = 0;
-        arpif->arp_table[i].hold_time = 0;
-    }
+/************************************************************************
+* NAME: fnet_arp_add_entry
+*
+* DESCRIPTION: Adds entry to the ARP table.
+*************************************************************************/
+static fnet_arp_entry_t *fnet_arp_add_entry( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, 
+                                        const fnet_mac_addr_t ethaddr )
+{
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    fnet_arp_entry_t    *entry;
 
-    arpif->arp_table[i].prot_addr = ipaddr;
-    fnet_memcpy(arpif->arp_table[i].hard_addr, ethaddr, sizeof(fnet_mac_addr_t));
-    
-    arpif->arp_table[i].cr_time = fnet_timer_ticks();
-ADDED:
-    return ( &arpif->arp_table[i]);
+    if((entry = fnet_arp_find(arpif, ipaddr)) == 0)
+        entry = fnet_arp_new_entry(arpif, ipaddr);
+
+    if(entry)
+        fnet_arp_confirm_entry(entry, ethaddr);
+
+    return entry;
 }
 
 
@@ -231,24 +434,13 @@ ADDED:
 static fnet_arp_entry_t *fnet_arp_update_entry( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, 
                                             fnet_mac_addr_t ethaddr )
 {
-    fnet_arp_if_t *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
-    int i;
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
+    fnet_arp_entry_t    *entry;
 
-    /* Find an entry to update. */
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; ++i)
-    {
-        /* Check if the source IP address of the incoming packet matches
-         * the IP address in this ARP table entry.*/
-        if(ipaddr == arpif->arp_table[i].prot_addr)
-        {
-            /* Update this and return. */
-            fnet_memcpy(arpif->arp_table[i].hard_addr, ethaddr, sizeof(fnet_mac_addr_t));
-            arpif->arp_table[i].cr_time = fnet_timer_ticks();
-            return ( &arpif->arp_table[i]);
-        }
-    }
+    if((entry = fnet_arp_find(arpif, ipaddr)) != 0)
+        fnet_arp_confirm_entry(entry, ethaddr);
 
-    return FNET_NULL;
+    return entry;
 }
 
 /************************************************************************
@@ -259,70 +451,116 @@ static fnet_arp_entry_t *fnet_arp_update_entry( fnet_netif_t *netif, fnet_ip4_ad
 *************************************************************************/
 fnet_mac_addr_t *fnet_arp_lookup( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr )
 {
-    fnet_arp_if_t   *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
-    int             i;
-    fnet_mac_addr_t *result = FNET_NULL;
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
+    fnet_arp_entry_t    *entry;
+    fnet_mac_addr_t     *result = FNET_NULL;
 
-    /* Find an entry. */
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; ++i)
+    if((entry = fnet_arp_find(arpif, ipaddr)) != 0)
     {
-        if(ipaddr == arpif->arp_table[i].prot_addr)
+        if(fnet_memcmp(entry->hard_addr, fnet_eth_null_addr, sizeof(fnet_mac_addr_t)))
         {
-            if(fnet_memcmp(arpif->arp_table[i].hard_addr, 
-                            fnet_eth_null_addr, sizeof(fnet_mac_addr_t)))
-            {
-                result = &arpif->arp_table[i].hard_addr;
-            }
-            /* Else => not found */
-            break;
+            entry->used = FNET_TRUE;
+            fnet_arp_lru_move(arpif, entry, FNET_TRUE);
+            
+            result = &entry->hard_addr;
         }
+        /* Else => not resolved yet */
     }
-//NOTFOUND:
+
     return result;
 }
 
 /************************************************************************
 * NAME: fnet_arp_resolve
 *
-* DESCRIPTION: This function finds the first unused or the oldest
-*              ARP table entry and makes a new entry
-*              to prepare it for an ARP reply.
+* DESCRIPTION: This function queues the packet to the unresolved 
+*              ARP table entry, creating it if needed, 
+*              and sends an ARP request.
 *************************************************************************/
 void fnet_arp_resolve( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, fnet_netbuf_t *nb )
 {
-    fnet_arp_if_t *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
-    int i;
-    fnet_arp_entry_t *entry;
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if); //PFI
+    fnet_arp_entry_t    *entry;
+    fnet_netbuf_t       *nb_old;
+
+    FNET_STATS_INC(arp.misses);
 
-    for (i = 0; i < FNET_ARP_TABLE_SIZE; i++)
+    if((entry = fnet_arp_find(arpif, ipaddr)) == 0)
+        entry = fnet_arp_new_entry(arpif, ipaddr);
+
+    if(entry == 0)
     {
-        if(ipaddr == arpif->arp_table[i].prot_addr)
-        {
-            break;
-        }
+        /* All entries are static.*/
+        FNET_STATS_INC(arp.drops);
+        fnet_netbuf_free_chain(nb);
+        return;
     }
+    
+    fnet_arp_lru_move(arpif, entry, FNET_TRUE);
 
-    /* If no unused entry is found, create it. */
-    if(i == FNET_ARP_TABLE_SIZE)
-        entry = fnet_arp_add_entry(netif, ipaddr, fnet_eth_null_addr);
-    else
-        entry = &arpif->arp_table[i];
-
-    if(entry->hold)
+    /* If the queue is full, the oldest packet is discarded.*/
+    if(entry->hold_count >= FNET_CFG_ARP_HOLD_QUEUE)
     {
-        fnet_netbuf_free_chain(entry->hold);
+        nb_old = entry->hold;
+        entry->hold = nb_old->next_chain;
+        entry->hold_count--;
+        
+        FNET_STATS_INC(arp.drops);
+        fnet_netbuf_free_chain(nb_old);
     }
 
-    if((i == FNET_ARP_TABLE_SIZE)||
-        ((entry->hold)&&(((fnet_timer_ticks()-entry->hold_time)*FNET_TIMER_PERIOD_MS)>1000))||
-        (!entry->hold))
+    nb->next_chain = 0;
+    fnet_netbuf_add_chain(&entry->hold, nb);
+    entry->hold_count++;
+
+    /* Send a request, if it was not sent recently.*/
+    if((entry->request_count == 0) 
+       || ((entry->request_count < FNET_ARP_MAX_REQUESTS) 
+           && (fnet_timer_get_interval(entry->hold_time, fnet_timer_ticks()) >= fnet_timer_ms2ticks(FNET_ARP_REQUEST_INTERVAL))))
     {
+        entry->request_count++;
         entry->hold_time = fnet_timer_ticks();
-        entry->hold = nb;
         fnet_arp_request(netif, ipaddr);
     }
-    else
-        entry->hold = nb;
+}
+
+/************************************************************************
+* NAME: fnet_arp_hold_send
+*
+* DESCRIPTION: Sends the packets waiting for the resolved entry.
+*************************************************************************/
+static void fnet_arp_hold_send( fnet_netif_t *netif, fnet_arp_entry_t *entry )
+{
+    fnet_netbuf_t *nb;
+
+    while((nb = entry->hold) != 0)
+    {
+        entry->hold = nb->next_chain;
+        nb->next_chain = 0;
+        
+        fnet_eth_output_low(netif, FNET_ETH_TYPE_IP4, entry->hard_addr, nb);
+    }
+    
+    entry->hold_count = 0;
+}
+
+/************************************************************************
+* NAME: fnet_arp_hold_free
+*
+* DESCRIPTION: Frees the packets waiting for the entry.
+*************************************************************************/
+static void fnet_arp_hold_free( fnet_arp_entry_t *entry )
+{
+    fnet_netbuf_t *nb;
+
+    while((nb = entry->hold) != 0)
+    {
+        entry->hold = nb->next_chain;
+        FNET_STATS_INC(arp.drops);
+        fnet_netbuf_free_chain(nb);
+    }
+    
+    entry->hold_count = 0;
 }
 
 /************************************************************************
@@ -350,6 +588,12 @@ void fnet_arp_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
         }
         
         fnet_arp_trace("RX", arp_hdr); /* Print ARP header. */
+        FNET_ARP_TRACE(FNET_TRACE_EVENT_RX, arp_hdr);
+
+        if(arp_hdr->op == FNET_HTONS(FNET_ARP_OP_REQUEST))
+            FNET_STATS_INC(arp.in_requests);
+        else if(arp_hdr->op == FNET_HTONS(FNET_ARP_OP_REPLY))
+            FNET_STATS_INC(arp.in_replies);
         
         fnet_netif_get_hw_addr(netif, local_addr, sizeof(fnet_mac_addr_t));
 
@@ -374,10 +618,7 @@ void fnet_arp_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
                 if(entry && entry->hold)
                 {
                     /* Send waiting data.*/
-                    ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, FNET_ETH_TYPE_IP4, entry->hard_addr, entry->hold);
-
-                    entry->hold = 0;
-                    entry->hold_time = 0;
+                    fnet_arp_hold_send(netif, entry);
                 }
             }
             else
@@ -398,8 +639,10 @@ void fnet_arp_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
                 arp_hdr->sender_prot_addr = netif->ip4_addr.address;
                 
                 fnet_arp_trace("TX Reply", arp_hdr); /* Print ARP header. */
+                FNET_ARP_TRACE(FNET_TRACE_EVENT_TX, arp_hdr);
                 
-                ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, FNET_ETH_TYPE_ARP, fnet_eth_broadcast, nb);
+                FNET_STATS_INC(arp.out_replies);
+                fnet_eth_output_low(netif, FNET_ETH_TYPE_ARP, fnet_eth_broadcast, nb);
                 return;
             }
         }
@@ -411,9 +654,20 @@ void fnet_arp_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
 /************************************************************************
 * NAME: fnet_arp_request
 *
-* DESCRIPTION: Sends ARP request.
+* DESCRIPTION: Sends broadcast ARP request.
 *************************************************************************/
 void fnet_arp_request( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr )
+{
+    fnet_arp_send_request(netif, ipaddr, fnet_eth_broadcast);
+}
+
+/************************************************************************
+* NAME: fnet_arp_send_request
+*
+* DESCRIPTION: Sends ARP request to the destination hardware address.
+*              It is broadcast, or unicast to refresh the entry.
+*************************************************************************/
+static void fnet_arp_send_request( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t dest_addr )
 {
     fnet_arp_header_t *arp_hdr;
     fnet_mac_addr_t sender_addr;
@@ -438,8 +692,10 @@ void fnet_arp_request( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr )
         arp_hdr->sender_prot_addr = netif->ip4_addr.address; /* Protocol address of sender of this packet.*/
 
         fnet_arp_trace("TX", arp_hdr); /* Print ARP header. */        
+        FNET_ARP_TRACE(FNET_TRACE_EVENT_TX, arp_hdr);
         
-        ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, FNET_ETH_TYPE_ARP, fnet_eth_broadcast, nb);
+        FNET_STATS_INC(arp.out_requests);
+        fnet_eth_output_low(netif, FNET_ETH_TYPE_ARP, dest_addr, nb);
     }
 }
 
@@ -471,19 +727,99 @@ void fnet_arp_drain(fnet_netif_t *netif)
    fnet_isr_lock();
    
    /* ARP table drain.*/
-   for(i=0;i<FNET_ARP_TABLE_SIZE;i++)
+   for(i=0;i<FNET_CFG_ARP_TABLE_SIZE;i++)
    {
-      if(arpif->arp_table[i].hold)
-      {
-         fnet_netbuf_free_chain(arpif->arp_table[i].hold);
-         arpif->arp_table[i].hold=0;
-         arpif->arp_table[i].hold_time=0;
-      }
+      fnet_arp_hold_free(&arpif->arp_table[i]);
    }
   
    fnet_isr_unlock();
 }
 
+/************************************************************************
+* NAME: fnet_arp_add_static
+*
+* DESCRIPTION: Adds the static entry to the ARP table,
+*              or makes the existing entry static.
+*************************************************************************/
+int fnet_arp_add_static( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t ethaddr )
+{
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    fnet_arp_entry_t    *entry;
+    int                 result = FNET_ERR;
+
+    if((ipaddr != INADDR_ANY) 
+        && fnet_memcmp(ethaddr, fnet_eth_null_addr, sizeof(fnet_mac_addr_t)))
+    {
+        if((entry = fnet_arp_find(arpif, ipaddr)) == 0)
+            entry = fnet_arp_new_entry(arpif, ipaddr);
+
+        if(entry)
+        {
+            entry->is_static = FNET_FALSE;
+            fnet_arp_confirm_entry(entry, ethaddr);
+            entry->is_static = FNET_TRUE;
+            
+            if(entry->hold)
+            {
+                /* Send waiting data.*/
+                fnet_arp_hold_send(netif, entry);
+            }
+            
+            result = FNET_OK;
+        }
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_arp_del
+*
+* DESCRIPTION: Deletes the static or dynamic entry from the ARP table.
+*************************************************************************/
+int fnet_arp_del( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr )
+{
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    fnet_arp_entry_t    *entry;
+    int                 result = FNET_ERR;
+
+    if((entry = fnet_arp_find(arpif, ipaddr)) != 0)
+    {
+        fnet_arp_del_entry(arpif, entry);
+        result = FNET_OK;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_arp_get_entry
+*
+* DESCRIPTION: Retrieves the n-th used entry of the ARP table,
+*              from the most recently used.
+*************************************************************************/
+int fnet_arp_get_entry( fnet_netif_t *netif, unsigned int n, fnet_netif_ip4_arp_info_t *arp_info )
+{
+    fnet_arp_if_t       *arpif = &(((fnet_eth_if_t *)(netif->if_ptr))->arp_if);
+    fnet_arp_entry_t    *entry;
+    int                 result = FNET_FALSE;
+
+    for(entry = arpif->arp_lru_head; entry && entry->prot_addr; entry = entry->lru_next)
+    {
+        if(n == 0)
+        {
+            arp_info->ip4_addr = entry->prot_addr;
+            fnet_memcpy(arp_info->hw_addr, entry->hard_addr, sizeof(fnet_mac_addr_t));
+            arp_info->is_static = entry->is_static;
+            result = FNET_TRUE;
+            break;
+        }
+        n--;
+    }
+
+    return result;
+}
+
 
 /************************************************************************
 * NAME: fnet_arp_trace
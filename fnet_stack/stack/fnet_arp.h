@@ -67,8 +67,13 @@
 #define FNET_ARP_OP_REQUEST     (1)         /* ARP request.*/
 #define FNET_ARP_OP_REPLY       (2)         /* ARP reply.*/
 
-#define FNET_ARP_TIMER_PERIOD   (300000)    /* in ms (=5min).*/
-#define FNET_ARP_TIMEOUT    	(1200000)   /* in ms (=20min).*/
+#define FNET_ARP_TIMER_PERIOD   (1000)      /* in ms (=1sec).*/
+#define FNET_ARP_TIMEOUT        (FNET_CFG_ARP_EXPIRE_TIMEOUT*1000UL) /* in ms.*/
+#define FNET_ARP_REFRESH_TIME   (30000)     /* in ms. An entry in use is refreshed,
+                                             * during this time before expiration.*/
+#define FNET_ARP_REQUEST_INTERVAL (1000)    /* in ms. Minimum time between requests.*/
+#define FNET_ARP_MAX_REQUESTS   (3)         /* Number of requests without reply, 
+                                             * before the entry is given up.*/
 
 /**************************************************************************/ /*!
  * @internal
@@ -89,27 +94,35 @@ typedef struct
 } fnet_arp_header_t;
 FNET_COMP_PACKED_END
 
-#define FNET_ARP_TABLE_SIZE     (10)    /* The number of entries in the ARP table.*/
-
-
 /**************************************************************************/ /*!
  * @internal
  * @brief    ARP table entry structure.
  ******************************************************************************/
-typedef struct
+typedef struct fnet_arp_entry
 {
-    fnet_mac_addr_t hard_addr;  /**< Hardware address.*/
-    fnet_ip4_addr_t prot_addr;   /**< Protocol address.*/
-    unsigned long cr_time;      /**< Time of entry creation.*/
-    fnet_netbuf_t *hold;        /**< Last packet until resolved/timeout.*/
-    unsigned long hold_time;    /**< Time of the last request.*/
+    fnet_mac_addr_t hard_addr;          /**< Hardware address. Null address, if unresolved.*/
+    fnet_ip4_addr_t prot_addr;          /**< Protocol address. 0, if the entry is free.*/
+    unsigned long cr_time;              /**< Time of entry creation or of the last confirmation.*/
+    fnet_netbuf_t *hold;                /**< Queue of packets until resolved/timeout.*/
+    unsigned long hold_time;            /**< Time of the last request.*/
+    unsigned char hold_count;           /**< Number of packets in the hold queue.*/
+    unsigned char request_count;        /**< Number of requests sent without reply.*/
+    unsigned char used;                 /**< FNET_TRUE if it is used since the last confirmation.*/
+    unsigned char refresh;              /**< FNET_TRUE if the refresh time is started.*/
+    unsigned char is_static;            /**< FNET_TRUE if it is static entry, it never expires.*/
+    struct fnet_arp_entry *hash_next;   /**< Next entry in the hash bucket.*/
+    struct fnet_arp_entry *lru_prev;    /**< More recently used entry.*/
+    struct fnet_arp_entry *lru_next;    /**< Less recently used entry.*/
 } fnet_arp_entry_t;
 
 typedef struct
 {
-    fnet_arp_entry_t arp_table[FNET_ARP_TABLE_SIZE]; /* ARP cach.*/
-    fnet_timer_desc_t arp_tmr;                       /* ARP timer.*/
-    fnet_event_desc_t arp_event;                     /* ARP event - duplicate address event.*/
+    fnet_arp_entry_t arp_table[FNET_CFG_ARP_TABLE_SIZE];   /* ARP cache.*/
+    fnet_arp_entry_t *arp_hash[FNET_CFG_ARP_HASH_SIZE];    /* Hash buckets of the ARP cache.*/
+    fnet_arp_entry_t *arp_lru_head;                        /* The most recently used entry.*/
+    fnet_arp_entry_t *arp_lru_tail;                        /* The least recently used or free entry.*/
+    fnet_timer_desc_t arp_tmr;                             /* ARP timer.*/
+    fnet_event_desc_t arp_event;                           /* ARP event - duplicate address event.*/
 } fnet_arp_if_t;
 
 /************************************************************************
@@ -122,6 +135,9 @@ fnet_mac_addr_t *fnet_arp_lookup( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr );
 void fnet_arp_resolve( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, fnet_netbuf_t *nb );
 void fnet_arp_input( fnet_netif_t *netif, fnet_netbuf_t *nb );
 void fnet_arp_drain( fnet_netif_t *netif );
+int fnet_arp_add_static( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t ethaddr );
+int fnet_arp_del( fnet_netif_t *netif, fnet_ip4_addr_t ipaddr );
+int fnet_arp_get_entry( fnet_netif_t *netif, unsigned int n, fnet_netif_ip4_arp_info_t *arp_info );
 
 #endif
 
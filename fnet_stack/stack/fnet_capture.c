@@ -0,0 +1,489 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_capture.c
+*
+* @author Andrey Butok
+*
+* @brief FNET in-memory frame capture.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_CAPTURE
+
+#include "fnet_capture_prv.h"
+#include "fnet_eth_prv.h"
+#include "fnet_ip_prv.h"
+#include "fnet_netbuf.h"
+#include "fnet_isr.h"
+
+#if FNET_CFG_CAPTURE_SNAPLEN <= FNET_ETH_HDR_SIZE
+    #error "FNET_CFG_CAPTURE_SNAPLEN must be bigger than the Ethernet header."
+#endif
+
+#if (FNET_CFG_CAPTURE_SIZE & (FNET_CFG_CAPTURE_SIZE - 1)) || (FNET_CFG_CAPTURE_SIZE == 0)
+    #error "FNET_CFG_CAPTURE_SIZE must be a power of two."
+#endif
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_CAPTURE_BUF_MASK       (FNET_CFG_CAPTURE_SIZE - 1)
+
+#define FNET_CAPTURE_PCAP_MAGIC     (0xA1B2C3D4UL)
+#define FNET_CAPTURE_PCAP_ETHERNET  (1)     /* LINKTYPE_ETHERNET.*/
+#define FNET_CAPTURE_FILTER_SIZE    (64)    /* IPv4 header with options, plus ports.*/
+
+/* pcap file header. It is written in the byte order of the target.*/
+struct fnet_capture_pcap_hdr
+{
+    unsigned long   magic;
+    unsigned short  major;
+    unsigned short  minor;
+    long            thiszone;
+    unsigned long   sigfigs;
+    unsigned long   snaplen;
+    unsigned long   linktype;
+};
+
+/* pcap record header.*/
+struct fnet_capture_pcap_rec
+{
+    unsigned long   ts_sec;
+    unsigned long   ts_usec;
+    unsigned long   incl_len;
+    unsigned long   orig_len;
+};
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static int fnet_capture_filter_match( fnet_netbuf_t *nb, unsigned short type );
+static void fnet_capture_put( unsigned long position, const void *data, unsigned long size );
+static void fnet_capture_get( unsigned long position, void *data, unsigned long size );
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+int fnet_capture_started;
+
+static unsigned char                fnet_capture_buf[FNET_CFG_CAPTURE_SIZE];
+static unsigned long                fnet_capture_head;      /* Written bytes.*/
+static unsigned long                fnet_capture_tail;      /* Start of the oldest record.*/
+static int                          fnet_capture_filter_on;
+static struct fnet_capture_filter   fnet_capture_filter;    /* Port and type are in network byte order.*/
+static struct fnet_capture_stats    fnet_capture_stats;
+
+static const struct fnet_capture_pcap_hdr fnet_capture_pcap_hdr =
+{
+    FNET_CAPTURE_PCAP_MAGIC, 
+    2, 4,                           /* Version 2.4.*/
+    0, 0, 
+    FNET_CFG_CAPTURE_SNAPLEN, 
+    FNET_CAPTURE_PCAP_ETHERNET
+};
+
+/************************************************************************
+* NAME: fnet_capture_frame
+*
+* DESCRIPTION: Copies the frame to the buffer, as a pcap record,
+*              overwriting the oldest records. 
+*              The frame is truncated to FNET_CFG_CAPTURE_SNAPLEN.
+*************************************************************************/
+void fnet_capture_frame( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short type, const fnet_mac_addr_t dest_addr )
+{
+    struct fnet_capture_pcap_rec    rec;
+    fnet_eth_header_t               ethheader;
+    unsigned long                   rec_size;
+    unsigned long                   data_size;
+    unsigned long                   chunk;
+    unsigned long                   position;
+    unsigned long                   timestamp;
+    struct fnet_capture_pcap_rec    oldest;
+
+    fnet_capture_stats.frames++;
+
+    if(fnet_capture_filter_on && (fnet_capture_filter_match(nb, type) == FNET_FALSE))
+    {
+        fnet_capture_stats.filtered++;
+        return;
+    }
+
+    /* Ethernet header. The received frame addresses are not known.*/
+    fnet_memset_zero(&ethheader, sizeof(ethheader));
+    if(dest_addr)
+    {
+        fnet_memcpy(ethheader.destination_addr, dest_addr, sizeof(fnet_mac_addr_t));
+        if(netif->api->get_hw_addr)
+            netif->api->get_hw_addr(netif, ethheader.source_addr);
+    }
+    ethheader.type = type;
+
+    /* Record header.*/
+    timestamp = fnet_timer_ms();
+    rec.ts_sec = timestamp / 1000;
+    rec.ts_usec = (timestamp % 1000) * 1000;
+    rec.orig_len = FNET_ETH_HDR_SIZE + nb->total_length;
+    rec.incl_len = (rec.orig_len > FNET_CFG_CAPTURE_SNAPLEN) ? FNET_CFG_CAPTURE_SNAPLEN : rec.orig_len;
+    rec_size = sizeof(rec) + rec.incl_len;
+
+    if(rec_size > FNET_CFG_CAPTURE_SIZE)
+        return; /* FNET_CFG_CAPTURE_SIZE is too small.*/
+
+    /* Free space, by removing the oldest records.*/
+    while((FNET_CFG_CAPTURE_SIZE - (fnet_capture_head - fnet_capture_tail)) < rec_size)
+    {
+        fnet_capture_get(fnet_capture_tail, &oldest, sizeof(oldest));
+        fnet_capture_tail += sizeof(oldest) + oldest.incl_len;
+        fnet_capture_stats.overwritten++;
+    }
+
+    fnet_capture_put(fnet_capture_head, &rec, sizeof(rec));
+    fnet_capture_put(fnet_capture_head + sizeof(rec), &ethheader, FNET_ETH_HDR_SIZE);
+
+    /* Frame data, it may wrap around the buffer end.*/
+    data_size = rec.incl_len - FNET_ETH_HDR_SIZE;
+    position = (fnet_capture_head + sizeof(rec) + FNET_ETH_HDR_SIZE) & FNET_CAPTURE_BUF_MASK;
+    chunk = FNET_CFG_CAPTURE_SIZE - position;
+    if(chunk > data_size)
+        chunk = data_size;
+
+    fnet_netbuf_to_buf(nb, 0, (int)chunk, &fnet_capture_buf[position]);
+    if(chunk < data_size)
+        fnet_netbuf_to_buf(nb, (int)chunk, (int)(data_size - chunk), &fnet_capture_buf[0]);
+
+    fnet_capture_head += rec_size;
+
+    fnet_capture_stats.captured++;
+    if(dest_addr)
+        fnet_capture_stats.captured_tx++;
+    else
+        fnet_capture_stats.captured_rx++;
+    fnet_capture_stats.bytes += rec_size;
+}
+
+/************************************************************************
+* NAME: fnet_capture_filter_match
+*
+* DESCRIPTION: Checks the frame against the capture filter.
+*              Only the fixed IPv6 header is inspected.
+*
+* RETURNS: FNET_TRUE if the frame is to be captured.
+*************************************************************************/
+static int fnet_capture_filter_match( fnet_netbuf_t *nb, unsigned short type )
+{
+    unsigned char   hdr[FNET_CAPTURE_FILTER_SIZE];
+    unsigned long   size;
+    unsigned long   hdr_length;
+    unsigned char   protocol;
+    unsigned char   *src_ip;
+    unsigned char   *dest_ip;
+    unsigned short  ports[2];
+    int             addr_size;
+    int             fragment;
+
+    if(fnet_capture_filter.type && (fnet_capture_filter.type != type))
+        return FNET_FALSE;
+
+    if((fnet_capture_filter.protocol == 0) && (fnet_capture_filter.port == 0) 
+        && (fnet_capture_filter.host.sa_family == 0))
+        return FNET_TRUE;
+
+    size = (nb->total_length < sizeof(hdr)) ? nb->total_length : sizeof(hdr);
+    fnet_netbuf_to_buf(nb, 0, (int)size, hdr);
+
+    if((type == FNET_HTONS(FNET_ETH_TYPE_IP4)) && (size >= 20))
+    {
+        hdr_length = (unsigned long)(hdr[0] & 0x0F) * 4;
+        protocol = hdr[9];
+        src_ip = &hdr[12];
+        dest_ip = &hdr[16];
+        addr_size = sizeof(fnet_ip4_addr_t);
+        fragment = ((hdr[6] & 0x1F) | hdr[7]) != 0;
+    }
+    else if((type == FNET_HTONS(FNET_ETH_TYPE_IP6)) && (size >= 40))
+    {
+        hdr_length = 40;
+        protocol = hdr[6];
+        src_ip = &hdr[8];
+        dest_ip = &hdr[24];
+        addr_size = sizeof(fnet_ip6_addr_t);
+        fragment = FNET_FALSE;
+    }
+    else
+    {
+        return FNET_FALSE; /* Not IP.*/
+    }
+
+    if(fnet_capture_filter.protocol && (fnet_capture_filter.protocol != protocol))
+        return FNET_FALSE;
+
+    if(fnet_capture_filter.host.sa_family)
+    {
+        if((fnet_capture_filter.host.sa_family != ((addr_size == sizeof(fnet_ip4_addr_t)) ? AF_INET : AF_INET6))
+            || ((fnet_memcmp(fnet_capture_filter.host.sa_data, src_ip, addr_size) != 0)
+                && (fnet_memcmp(fnet_capture_filter.host.sa_data, dest_ip, addr_size) != 0)))
+            return FNET_FALSE;
+    }
+
+    if(fnet_capture_filter.port)
+    {
+        if(((protocol != FNET_IP_PROTOCOL_TCP) && (protocol != FNET_IP_PROTOCOL_UDP))
+            || fragment || ((hdr_length + sizeof(ports)) > size))
+            return FNET_FALSE;
+
+        fnet_memcpy(ports, &hdr[hdr_length], sizeof(ports));
+        if((ports[0] != fnet_capture_filter.port) && (ports[1] != fnet_capture_filter.port))
+            return FNET_FALSE;
+    }
+
+    return FNET_TRUE;
+}
+
+/************************************************************************
+* NAME: fnet_capture_put
+*
+* DESCRIPTION: Writes data to the buffer, wrapping around its end.
+*************************************************************************/
+static void fnet_capture_put( unsigned long position, const void *data, unsigned long size )
+{
+    const unsigned char *ptr = (const unsigned char *)data;
+
+    while(size--)
+        fnet_capture_buf[position++ & FNET_CAPTURE_BUF_MASK] = *ptr++;
+}
+
+/************************************************************************
+* NAME: fnet_capture_get
+*
+* DESCRIPTION: Reads data from the buffer, wrapping around its end.
+*************************************************************************/
+static void fnet_capture_get( unsigned long position, void *data, unsigned long size )
+{
+    unsigned char *ptr = (unsigned char *)data;
+
+    while(size--)
+        *ptr++ = fnet_capture_buf[position++ & FNET_CAPTURE_BUF_MASK];
+}
+
+/************************************************************************
+* NAME: fnet_capture_start
+*
+* DESCRIPTION: Sets the filter and starts the capture.
+*************************************************************************/
+int fnet_capture_start( const struct fnet_capture_filter *filter )
+{
+    fnet_isr_lock();
+
+    if(filter)
+    {
+        fnet_capture_filter = *filter;
+        fnet_capture_filter.type = fnet_htons(filter->type);
+        fnet_capture_filter.port = fnet_htons(filter->port);
+        fnet_capture_filter_on = (filter->type || filter->protocol || filter->port || filter->host.sa_family);
+    }
+    else
+    {
+        fnet_capture_filter_on = FNET_FALSE;
+    }
+
+    fnet_capture_started = FNET_TRUE;
+
+    fnet_isr_unlock();
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_capture_stop
+*
+* DESCRIPTION: Stops the capture.
+*************************************************************************/
+void fnet_capture_stop( void )
+{
+    fnet_capture_started = FNET_FALSE;
+}
+
+/************************************************************************
+* NAME: fnet_capture_clear
+*
+* DESCRIPTION: Removes all captured frames and resets the counters.
+*************************************************************************/
+void fnet_capture_clear( void )
+{
+    fnet_isr_lock();
+
+    fnet_capture_tail = fnet_capture_head;
+    fnet_memset_zero(&fnet_capture_stats, sizeof(fnet_capture_stats));
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_capture_get_stats
+*
+* DESCRIPTION: Returns the capture counters.
+*************************************************************************/
+int fnet_capture_get_stats( struct fnet_capture_stats *stats )
+{
+    int result;
+
+    if(stats)
+    {
+        fnet_isr_lock();
+
+        *stats = fnet_capture_stats;
+        stats->file_size = sizeof(fnet_capture_pcap_hdr) + (fnet_capture_head - fnet_capture_tail);
+
+        fnet_isr_unlock();
+
+        result = FNET_OK;
+    }
+    else
+    {
+        result = FNET_ERR;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_capture_read
+*
+* DESCRIPTION: Copies a part of the pcap file. 
+*              The file is the pcap header, followed by the records
+*              from the oldest one.
+*************************************************************************/
+unsigned long fnet_capture_read( unsigned long offset, void *buffer, unsigned long size )
+{
+    unsigned char   *ptr = (unsigned char *)buffer;
+    unsigned long   result = 0;
+    unsigned long   chunk;
+    unsigned long   used;
+
+    if(ptr == 0)
+        return 0;
+
+    fnet_isr_lock();
+
+    /* File header.*/
+    if(offset < sizeof(fnet_capture_pcap_hdr))
+    {
+        chunk = sizeof(fnet_capture_pcap_hdr) - offset;
+        if(chunk > size)
+            chunk = size;
+
+        fnet_memcpy(ptr, (const unsigned char *)&fnet_capture_pcap_hdr + offset, chunk);
+        result = chunk;
+        offset += chunk;
+    }
+
+    /* Records.*/
+    offset -= sizeof(fnet_capture_pcap_hdr);
+    used = fnet_capture_head - fnet_capture_tail;
+
+    if(offset < used)
+    {
+        chunk = used - offset;
+        if(chunk > (size - result))
+            chunk = size - result;
+
+        fnet_capture_get(fnet_capture_tail + offset, &ptr[result], chunk);
+        result += chunk;
+    }
+
+    fnet_isr_unlock();
+
+    return result;
+}
+
+#else /* FNET_CFG_CAPTURE */
+
+/************************************************************************
+* NAME: fnet_capture_start
+*
+* DESCRIPTION: The capture is disabled.
+*************************************************************************/
+int fnet_capture_start( const struct fnet_capture_filter *filter )
+{
+    FNET_COMP_UNUSED_ARG(filter);
+
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fnet_capture_stop
+*
+* DESCRIPTION: The capture is disabled.
+*************************************************************************/
+void fnet_capture_stop( void )
+{
+}
+
+/************************************************************************
+* NAME: fnet_capture_clear
+*
+* DESCRIPTION: The capture is disabled.
+*************************************************************************/
+void fnet_capture_clear( void )
+{
+}
+
+/************************************************************************
+* NAME: fnet_capture_get_stats
+*
+* DESCRIPTION: The capture is disabled.
+*************************************************************************/
+int fnet_capture_get_stats( struct fnet_capture_stats *stats )
+{
+    FNET_COMP_UNUSED_ARG(stats);
+
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fnet_capture_read
+*
+* DESCRIPTION: The capture is disabled.
+*************************************************************************/
+unsigned long fnet_capture_read( unsigned long offset, void *buffer, unsigned long size )
+{
+    FNET_COMP_UNUSED_ARG(offset);
+    FNET_COMP_UNUSED_ARG(buffer);
+    FNET_COMP_UNUSED_ARG(size);
+
+    return 0;
+}
+
+#endif /* FNET_CFG_CAPTURE */
@@ -0,0 +1,181 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_capture.h
+*
+* @author Andrey Butok
+*
+* @brief FNET in-memory frame capture API.
+*
+***************************************************************************/
+
+#ifndef _FNET_CAPTURE_H_
+
+#define _FNET_CAPTURE_H_
+
+#include "fnet_config.h"
+#include "fnet_socket.h"
+
+/*! @addtogroup fnet_capture
+* The Capture API copies the received and sent Ethernet frames to 
+* a statically allocated circular buffer, as pcap file records, 
+* so the traffic of a deployed board can be inspected without a tap. @n
+* It is available only if @ref FNET_CFG_CAPTURE is set to @c 1. @n
+* A frame is truncated to @ref FNET_CFG_CAPTURE_SNAPLEN bytes, 
+* which bounds the capture cost. The oldest frames are overwritten. @n
+* The frames may be selected by a simple filter, 
+* defined by the @ref fnet_capture_filter structure. @n
+* The pcap file is read by @ref fnet_capture_read(), for example 
+* by a TFTP server or HTTP CGI handler. @n
+* @n
+* The stack sees the received frames without their Ethernet header, 
+* so their MAC addresses are written as zeros.
+*/
+
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Capture filter. 
+ *
+ * A frame is captured if it matches all non-zero fields.
+ * The @c protocol, @c port and @c host fields match only IPv4 and IPv6 packets.
+ ******************************************************************************/
+struct fnet_capture_filter
+{
+    unsigned short  type;       /**< @brief Ethernet type, in host byte order 
+                                 * (for example @c 0x0806 for ARP).*/
+    unsigned char   protocol;   /**< @brief IP protocol number, or IPv6 next header 
+                                 * of the fixed header.*/
+    unsigned short  port;       /**< @brief TCP or UDP source or destination port, 
+                                 * in host byte order.*/
+    struct sockaddr host;       /**< @brief Source or destination IP address. @n
+                                 * It is not used if its @c sa_family is zero.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Capture counters, returned by the @ref fnet_capture_get_stats().
+ ******************************************************************************/
+struct fnet_capture_stats
+{
+    unsigned long   frames;         /**< @brief Frames seen while the capture was started.*/
+    unsigned long   captured;       /**< @brief Frames copied to the buffer.*/
+    unsigned long   captured_rx;    /**< @brief Received frames copied to the buffer. @n
+                                     * With a filter set, both @c captured_rx and
+                                     * @c captured_tx grow for a two-way flow.*/
+    unsigned long   captured_tx;    /**< @brief Sent frames copied to the buffer.*/
+    unsigned long   filtered;       /**< @brief Frames rejected by the filter.*/
+    unsigned long   overwritten;    /**< @brief Frames overwritten by newer ones.*/
+    unsigned long   bytes;          /**< @brief Bytes copied to the buffer, with the record headers.*/
+    unsigned long   file_size;      /**< @brief Current size of the pcap file.*/
+};
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Starts the frame capture.
+ *
+ * @param filter  Capture filter. @n
+ *                If it is @c 0, all frames are captured.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the capture is disabled by @ref FNET_CFG_CAPTURE.
+ *
+ * @see fnet_capture_stop()
+ *
+ ******************************************************************************
+ *
+ * The frames, captured before, are kept.
+ *
+ ******************************************************************************/
+int fnet_capture_start( const struct fnet_capture_filter *filter );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Stops the frame capture.
+ *
+ * @see fnet_capture_start()
+ *
+ ******************************************************************************
+ *
+ * The captured frames are kept, until @ref fnet_capture_clear() is called.
+ *
+ ******************************************************************************/
+void fnet_capture_stop( void );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Removes all captured frames and resets the counters.
+ *
+ ******************************************************************************/
+void fnet_capture_clear( void );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the capture counters.
+ *
+ * @param stats   Structure that receives the counters.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the capture is disabled by @ref FNET_CFG_CAPTURE.
+ *
+ ******************************************************************************/
+int fnet_capture_get_stats( struct fnet_capture_stats *stats );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Reads the pcap file of the captured frames.
+ *
+ * @param offset  Offset in the file.
+ *
+ * @param buffer  Buffer that receives the file data.
+ *
+ * @param size    Size of the buffer.
+ *
+ * @return This function returns the number of copied bytes. @n
+ *         It is less than @c size at the end of the file.
+ *
+ ******************************************************************************
+ *
+ * The file has the classic pcap format, with the Ethernet link type,
+ * in the byte order of the target. @n
+ * The file is read in parts, by increasing offsets. 
+ * The capture should be stopped by @ref fnet_capture_stop() before, 
+ * otherwise the frames overwritten during the reading 
+ * make the file inconsistent.
+ *
+ ******************************************************************************/
+unsigned long fnet_capture_read( unsigned long offset, void *buffer, unsigned long size );
+
+/*! @} */
+
+#endif /* _FNET_CAPTURE_H_ */
@@ -0,0 +1,73 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_capture_prv.h
+*
+* @author Andrey Butok
+*
+* @brief Private. FNET in-memory frame capture.
+*
+***************************************************************************/
+
+#ifndef _FNET_CAPTURE_PRV_H_
+
+#define _FNET_CAPTURE_PRV_H_
+
+#include "fnet_config.h"
+#include "fnet_capture.h"
+#include "fnet_netif_prv.h"
+
+#if FNET_CFG_CAPTURE
+
+/************************************************************************
+*     Global Data Structures
+*************************************************************************/
+extern int fnet_capture_started;
+
+/* Captures the Ethernet frame, without its header. 
+ * type is in network byte order, in both directions.
+ * dest_addr is 0 for a received frame.*/
+#define FNET_CAPTURE(netif, nb, type, dest_addr) \
+    (fnet_capture_started ? fnet_capture_frame((netif), (nb), (type), (dest_addr)) : (void)0)
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+void fnet_capture_frame( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short type, const fnet_mac_addr_t dest_addr );
+
+#else
+
+#define FNET_CAPTURE(netif, nb, type, dest_addr)    ((void)0)
+
+#endif /* FNET_CFG_CAPTURE */
+
+#endif /* _FNET_CAPTURE_PRV_H_ */
@@ -48,6 +48,39 @@
 #include "fnet_stdlib.h"
 #include "fnet.h"
 #include "fnet_prot.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
+#include "fnet_latency_prv.h"
+#include "fnet_capture_prv.h"
+#if FNET_CFG_ETH_GRO
+    #include "fnet_tcp.h"
+    #include "fnet_checksum.h"
+#endif
+
+#if FNET_CFG_ETH_GRO
+/************************************************************************
+*     TCP segment, that may be merged by the receive-side coalescing.
+*************************************************************************/
+typedef struct
+{
+    fnet_tcp_header_t   *tcp_header;    /* Pointer to the TCP header.*/
+    unsigned long       header_length;  /* Size of the IP and TCP headers.*/
+    unsigned long       data_length;    /* Size of the TCP data.*/
+} fnet_eth_gro_segment_t;
+
+/* Size of the IP header of the segment. IPv4 options are not merged.*/
+#define FNET_ETH_GRO_IP_HEADER_SIZE(protocol)   (((protocol) == FNET_HTONS(FNET_ETH_TYPE_IP4)) ? sizeof(fnet_ip_header_t) : sizeof(fnet_ip6_header_t))
+
+static int fnet_eth_gro_segment( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol, fnet_eth_gro_segment_t *segment );
+static int fnet_eth_gro_match( fnet_eth_if_t *ethif, fnet_netbuf_t *nb, unsigned short protocol, fnet_eth_gro_segment_t *segment );
+static int fnet_eth_gro_input( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol );
+#endif /* FNET_CFG_ETH_GRO */
+
+static void fnet_eth_prot_input_low( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol );
+static void fnet_eth_output_driver( fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr, fnet_netbuf_t *nb );
+#if FNET_CFG_ETH_TX_QUEUE
+static void fnet_eth_output_flush( fnet_netif_t *netif );
+#endif
 
 /************************************************************************
 *     Global Data Structures
@@ -222,29 +255,319 @@ static void fnet_eth_timer( void *cookie );
 * DESCRIPTION: Eth. network-layer input function.
 *************************************************************************/
 void fnet_eth_prot_input( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol )
+{
+    if(netif && nb)
+    {
+        FNET_STATS_INC(eth.in_frames);
+        FNET_TRACE(FNET_TRACE_LAYER_ETH, FNET_TRACE_EVENT_RX, 0, 0, 0, fnet_ntohs(protocol), nb->total_length);
+        FNET_CAPTURE(netif, nb, protocol, 0);
+        FNET_LATENCY_RX_STAMP(nb);
+        FNET_LATENCY_RX(FNET_LATENCY_RX_ETH, nb);
+
+    #if FNET_CFG_ETH_GRO
+        /* Receive-side coalescing of TCP segments.*/
+        if(fnet_eth_gro_input(netif, nb, protocol) == FNET_TRUE)
+            return; /* Held or merged.*/
+    #endif
+    
+        fnet_eth_prot_input_low(netif, nb, protocol);
+    }
+}
+
+/************************************************************************
+* NAME: fnet_eth_prot_input_low
+*
+* DESCRIPTION: Passes the received frame to the network-layer protocol.
+*************************************************************************/
+static void fnet_eth_prot_input_low( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol )
 {
     int i;
     
-    if(netif && nb)
+    /* Find Network-layer protocol.*/
+    for(i=0; i<FNET_ETH_PROT_IF_LIST_SIZE; i++)
+    {
+        if( protocol == fnet_eth_prot_if_list[i].protocol)
+        {
+            /* Call the protocol-input function.*/
+            fnet_eth_prot_if_list[i].input(netif, nb); 
+            break;
+        }
+    }
+    
+    if(i == FNET_ETH_PROT_IF_LIST_SIZE)
+    { 
+        /* No procol found */
+        FNET_STATS_INC(eth.in_discards);
+        FNET_TRACE(FNET_TRACE_LAYER_ETH, FNET_TRACE_EVENT_DROP, 0, 0, 0, fnet_ntohs(protocol), nb->total_length);
+        fnet_netbuf_free_chain(nb); 
+    }
+}
+
+#if FNET_CFG_ETH_GRO
+/************************************************************************
+* NAME: fnet_eth_gro_segment
+*
+* DESCRIPTION: Checks if the received frame is a TCP segment with data, 
+*              addressed to this interface, that may be merged with 
+*              the segments of the same flow. Checks its checksums.
+*
+* RETURNS: FNET_TRUE and fills the segment parameters, if it can be merged.
+*          Otherwise FNET_FALSE.
+*************************************************************************/
+static int fnet_eth_gro_segment( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol, fnet_eth_gro_segment_t *segment )
+{
+    unsigned long       ip_length;
+    unsigned long       ip_header_length;
+    unsigned long       tcp_header_length;
+    unsigned short      tcp_flags;
+    char                *src_ip;
+    char                *dest_ip;
+    int                 addr_size;
+    
+    /* The whole frame must reside in one net_buf, without link-layer padding.*/
+    if(nb->length != nb->total_length)
+        return FNET_FALSE;
+    
+#if FNET_CFG_IP4
+    if(protocol == FNET_HTONS(FNET_ETH_TYPE_IP4))
+    {
+        fnet_ip_header_t *ip_header = nb->data_ptr;
+
+        ip_header_length = sizeof(fnet_ip_header_t);
+        
+        if((nb->length < ip_header_length)
+            || (FNET_IP_HEADER_GET_VERSION(ip_header) != 4)
+            || ((FNET_IP_HEADER_GET_HEADER_LENGTH(ip_header) << 2) != ip_header_length) /* No options.*/
+            || (ip_header->protocol != FNET_IP_PROTOCOL_TCP)
+            || (ip_header->flags_fragment_offset & ~FNET_HTONS(FNET_IP_DF))        /* Not a fragment.*/
+            || (ip_header->desination_addr != netif->ip4_addr.address)             /* Local unicast only.*/
+            || (ip_header->desination_addr == INADDR_ANY)
+            || (fnet_checksum_buf((char *)ip_header, (int)ip_header_length) != 0) )
+        {
+            return FNET_FALSE;
+        }
+        
+        ip_length = fnet_ntohs(ip_header->total_length);
+        src_ip = (char *)&ip_header->source_addr;
+        dest_ip = (char *)&ip_header->desination_addr;
+        addr_size = sizeof(fnet_ip4_addr_t);
+    }
+    else
+#endif /* FNET_CFG_IP4 */
+#if FNET_CFG_IP6
+    if(protocol == FNET_HTONS(FNET_ETH_TYPE_IP6))
     {
-        /* Find Network-layer protocol.*/
-        for(i=0; i<FNET_ETH_PROT_IF_LIST_SIZE; i++)
+        fnet_ip6_header_t *ip6_header = nb->data_ptr;
+        
+        ip_header_length = sizeof(fnet_ip6_header_t);
+        
+        if((nb->length < ip_header_length)
+            || (FNET_IP6_HEADER_GET_VERSION(ip6_header) != FNET_IP6_VERSION)
+            || (ip6_header->next_header != FNET_IP_PROTOCOL_TCP)                   /* No extension headers.*/
+            || (fnet_netif_is_my_ip6_addr(netif, &ip6_header->destination_addr) == FNET_FALSE) ) /* Local unicast only.*/
+        {
+            return FNET_FALSE;
+        }
+        
+        ip_length = ip_header_length + fnet_ntohs(ip6_header->length);
+        src_ip = (char *)&ip6_header->source_addr;
+        dest_ip = (char *)&ip6_header->destination_addr;
+        addr_size = sizeof(fnet_ip6_addr_t);
+    }
+    else
+#endif /* FNET_CFG_IP6 */
+    {
+        return FNET_FALSE;
+    }
+    
+    if((ip_length != nb->total_length) 
+        || (nb->length < (ip_header_length + sizeof(fnet_tcp_header_t))))
+    {
+        return FNET_FALSE;
+    }
+        
+    segment->tcp_header = (fnet_tcp_header_t *)((char *)nb->data_ptr + ip_header_length);
+    tcp_header_length = (unsigned long)((fnet_ntohs(segment->tcp_header->hdrlength__flags) >> 12) << 2);
+    tcp_flags = (unsigned short)(fnet_ntohs(segment->tcp_header->hdrlength__flags) & 0x3f);
+    
+    /* Only ACK or PSH segments with data are merged.*/
+    if((tcp_header_length < sizeof(fnet_tcp_header_t))
+        || ((ip_header_length + tcp_header_length) >= ip_length) 
+        || ((tcp_flags & FNET_TCP_SGT_ACK) == 0)
+        || (tcp_flags & ~(FNET_TCP_SGT_ACK | FNET_TCP_SGT_PSH)) )
+    {
+        return FNET_FALSE;
+    }
+    
+    /* Checksum.*/
+    if(((nb->flags & FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM) == 0)
+        && (fnet_checksum_pseudo_buf((char *)segment->tcp_header, (unsigned short)(ip_length - ip_header_length), 
+                                    FNET_HTONS((unsigned short)FNET_IP_PROTOCOL_TCP), src_ip, dest_ip, addr_size) != 0) )
+    {
+        return FNET_FALSE;
+    }
+    
+    segment->header_length = ip_header_length + tcp_header_length;
+    segment->data_length = ip_length - segment->header_length;
+    
+    return FNET_TRUE;
+}
+
+/************************************************************************
+* NAME: fnet_eth_gro_match
+*
+* DESCRIPTION: Checks if the segment is the next in-order segment 
+*              of the held flow, with the same acknowledgment, window
+*              and options.
+*
+* RETURNS: FNET_TRUE if the segment may be appended to the held one.
+*          Otherwise FNET_FALSE.
+*************************************************************************/
+static int fnet_eth_gro_match( fnet_eth_if_t *ethif, fnet_netbuf_t *nb, unsigned short protocol, fnet_eth_gro_segment_t *segment )
+{
+    fnet_tcp_header_t   *gro_tcp_header;
+    unsigned long       gro_header_length;
+    int                 result = FNET_FALSE;
+    
+    if((ethif->gro_nb) && (ethif->gro_protocol == protocol)
+        && ((ethif->gro_nb->total_length + segment->data_length) <= FNET_CFG_ETH_GRO_MAX_SIZE)
+        && (fnet_ntohl(segment->tcp_header->sequence_number) == ethif->gro_next_seq))
+    {
+        gro_tcp_header = (fnet_tcp_header_t *)((char *)ethif->gro_nb->data_ptr + FNET_ETH_GRO_IP_HEADER_SIZE(protocol));
+        gro_header_length = FNET_ETH_GRO_IP_HEADER_SIZE(protocol) + (unsigned long)((fnet_ntohs(gro_tcp_header->hdrlength__flags) >> 12) << 2);
+        
+        if((gro_header_length == segment->header_length)
+            && (gro_tcp_header->ack_number == segment->tcp_header->ack_number)
+            && (gro_tcp_header->window == segment->tcp_header->window)
+            && (gro_tcp_header->source_port == segment->tcp_header->source_port)
+            && (gro_tcp_header->destination_port == segment->tcp_header->destination_port)
+            /* The same IP addresses (the IP header is fixed-size, without options).*/
+        #if FNET_CFG_IP4
+            && ((protocol != FNET_HTONS(FNET_ETH_TYPE_IP4)) 
+                || ((((fnet_ip_header_t *)ethif->gro_nb->data_ptr)->source_addr == ((fnet_ip_header_t *)nb->data_ptr)->source_addr)
+                    && (((fnet_ip_header_t *)ethif->gro_nb->data_ptr)->desination_addr == ((fnet_ip_header_t *)nb->data_ptr)->desination_addr)))
+        #endif
+        #if FNET_CFG_IP6
+            && ((protocol != FNET_HTONS(FNET_ETH_TYPE_IP6)) 
+                || (FNET_IP6_ADDR_EQUAL(&((fnet_ip6_header_t *)ethif->gro_nb->data_ptr)->source_addr, &((fnet_ip6_header_t *)nb->data_ptr)->source_addr)
+                    && FNET_IP6_ADDR_EQUAL(&((fnet_ip6_header_t *)ethif->gro_nb->data_ptr)->destination_addr, &((fnet_ip6_header_t *)nb->data_ptr)->destination_addr)))
+        #endif
+            /* The same TCP options.*/
+            && (fnet_memcmp((char *)gro_tcp_header + sizeof(fnet_tcp_header_t), (char *)segment->tcp_header + sizeof(fnet_tcp_header_t),
+                            (int)(segment->header_length - FNET_ETH_GRO_IP_HEADER_SIZE(protocol) - sizeof(fnet_tcp_header_t))) == 0) )
+        {
+            result = FNET_TRUE;
+        }
+    }
+    
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_eth_gro_input
+*
+* DESCRIPTION: Receive-side coalescing of TCP segments.
+*              Holds a TCP segment and appends the data of the following 
+*              in-order segments of the same flow to it.
+*
+* RETURNS: FNET_TRUE if the frame is held or merged.
+*          FNET_FALSE if it must be passed to the network layer.
+*************************************************************************/
+static int fnet_eth_gro_input( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol )
+{
+    fnet_eth_if_t           *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+    fnet_eth_gro_segment_t  segment;
+    fnet_tcp_header_t       *gro_tcp_header;
+    int                     push;
+    int                     result = FNET_FALSE;
+    
+    if(fnet_eth_gro_segment(netif, nb, protocol, &segment) == FNET_TRUE)
+    {
+        push = ((fnet_ntohs(segment.tcp_header->hdrlength__flags) & FNET_TCP_SGT_PSH) != 0);
+    
+        if(fnet_eth_gro_match(ethif, nb, protocol, &segment) == FNET_TRUE)
+        {
+            /* Append the data of the segment to the held one.*/
+            fnet_netbuf_trim(&nb, (int)segment.header_length);
+            ethif->gro_nb = fnet_netbuf_concat(ethif->gro_nb, nb);
+            ethif->gro_next_seq += segment.data_length;
+            
+        #if FNET_CFG_IP4
+            if(protocol == FNET_HTONS(FNET_ETH_TYPE_IP4))
+                ((fnet_ip_header_t *)ethif->gro_nb->data_ptr)->total_length = fnet_htons((unsigned short)ethif->gro_nb->total_length);
+        #endif
+        #if FNET_CFG_IP6
+            if(protocol == FNET_HTONS(FNET_ETH_TYPE_IP6))
+                ((fnet_ip6_header_t *)ethif->gro_nb->data_ptr)->length = fnet_htons((unsigned short)(ethif->gro_nb->total_length - sizeof(fnet_ip6_header_t)));
+        #endif
+        
+            if(push)
+            {
+                gro_tcp_header = (fnet_tcp_header_t *)((char *)ethif->gro_nb->data_ptr + FNET_ETH_GRO_IP_HEADER_SIZE(protocol));
+                gro_tcp_header->hdrlength__flags |= FNET_HTONS(FNET_TCP_SGT_PSH);
+                
+                fnet_eth_gro_flush(netif);
+            }
+            
+            result = FNET_TRUE;
+        }
+        else
         {
-            if( protocol == fnet_eth_prot_if_list[i].protocol)
+            fnet_eth_gro_flush(netif);
+            
+            /* The checksum is already checked.*/
+            nb->flags |= FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM;
+            
+            if(push == 0)
             {
-                /* Call the protocol-input function.*/
-                fnet_eth_prot_if_list[i].input(netif, nb); 
-                break;
+                /* Hold it, till the end of the RX batch.*/
+                ethif->gro_nb = nb;
+                ethif->gro_protocol = protocol;
+                ethif->gro_next_seq = fnet_ntohl(segment.tcp_header->sequence_number) + segment.data_length;
+                
+                result = FNET_TRUE;
             }
         }
+    }
+    else
+    {
+        /* Keep the order of the frames.*/
+        fnet_eth_gro_flush(netif);
+    }
+    
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_eth_gro_flush
+*
+* DESCRIPTION: Passes the held TCP segment to the network layer.
+*              Ethernet drivers call it at the end of each RX batch.
+*************************************************************************/
+void fnet_eth_gro_flush( fnet_netif_t *netif )
+{
+    fnet_eth_if_t       *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+    fnet_netbuf_t       *nb = ethif->gro_nb;
+    
+    if(nb)
+    {
+        ethif->gro_nb = 0;
         
-        if(i == FNET_ETH_PROT_IF_LIST_SIZE)
-        { 
-            /* No procol found */
-            fnet_netbuf_free_chain(nb); 
+    #if FNET_CFG_IP4
+        if(ethif->gro_protocol == FNET_HTONS(FNET_ETH_TYPE_IP4))
+        {
+            /* The total length may be changed, update the header checksum.*/
+            fnet_ip_header_t *ip_header = nb->data_ptr;
+            
+            ip_header->checksum = 0;
+            ip_header->checksum = fnet_checksum_buf((char *)ip_header, sizeof(fnet_ip_header_t));
         }
+    #endif
+    
+        fnet_eth_prot_input_low(netif, nb, ethif->gro_protocol);
     }
 }
+#endif /* FNET_CFG_ETH_GRO */
 
 /************************************************************************
 * NAME: fnet_eth_init
@@ -255,10 +578,9 @@ int fnet_eth_init( fnet_netif_t *netif)
 {
     int result;
 
-#if !FNET_CFG_CPU_ETH_MIB 
-    /* Clear Ethernet statistics. */
+    /* Clear Ethernet statistics. 
+     * Driver counters are kept in software also when the MIB is present.*/
     fnet_memset_zero(&((fnet_eth_if_t *)(netif->if_ptr))->statistics, sizeof(struct fnet_netif_statistics));
-#endif 
 
 #if FNET_CFG_IP4   
     result = fnet_arp_init(netif); /* Init ARP for this interface.*/
@@ -342,6 +664,22 @@ void fnet_eth_release( fnet_netif_t *netif)
 
     fnet_timer_free(((fnet_eth_if_t *)(netif->if_ptr))->eth_timer);
 
+#if FNET_CFG_ETH_GRO
+    fnet_netbuf_free_chain(((fnet_eth_if_t *)(netif->if_ptr))->gro_nb);
+    ((fnet_eth_if_t *)(netif->if_ptr))->gro_nb = 0;
+#endif
+
+#if FNET_CFG_ETH_TX_QUEUE
+    /* Drop the queued frames.*/
+    while(((fnet_eth_if_t *)(netif->if_ptr))->tx_queue)
+    {
+        fnet_netbuf_del_chain(&((fnet_eth_if_t *)(netif->if_ptr))->tx_queue, ((fnet_eth_if_t *)(netif->if_ptr))->tx_queue);
+    }
+    ((fnet_eth_if_t *)(netif->if_ptr))->tx_queue_packets = 0;
+    ((fnet_eth_if_t *)(netif->if_ptr))->tx_queue_bytes = 0;
+    ((fnet_eth_if_t *)(netif->if_ptr))->tx_queue_busy = FNET_FALSE;
+#endif
+
 #if FNET_CFG_IP4    
     fnet_arp_release(netif);
 #endif
@@ -402,6 +740,170 @@ static void fnet_eth_timer( void *cookie )
     }
 }
 
+/************************************************************************
+* NAME: fnet_eth_output_low
+*
+* DESCRIPTION: Sends the frame to the already resolved destination 
+*              MAC address.
+*************************************************************************/
+void fnet_eth_output_low( fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr,
+                          fnet_netbuf_t *nb )
+{
+#if FNET_CFG_ETH_TX_QUEUE
+    fnet_eth_if_t       *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+    fnet_netbuf_t       *nb_header;
+    fnet_eth_header_t   *ethheader;
+#endif /* FNET_CFG_ETH_TX_QUEUE */
+
+    FNET_CAPTURE(netif, nb, fnet_htons(type), dest_addr);
+    FNET_LATENCY_TX(FNET_LATENCY_TX_ETH, nb);
+
+#if FNET_CFG_ETH_TX_QUEUE
+    if(ethif->output_ready)
+    {
+        /* Keep the frame order.*/
+        fnet_eth_output_flush(netif);
+
+        if(ethif->tx_queue || (ethif->output_ready(netif) == FNET_FALSE))
+        {
+            /* The driver is busy, queue the frame. 
+             * Its Ethernet header keeps the type and the destination address.*/
+            if((ethif->tx_queue_packets < FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS)
+                && ((ethif->tx_queue_bytes + nb->total_length) <= FNET_CFG_ETH_TX_QUEUE_MAX_BYTES)
+                && ((nb_header = fnet_netbuf_new(sizeof(fnet_eth_header_t), FNET_FALSE)) != 0))
+            {
+                ethheader = (fnet_eth_header_t *)nb_header->data_ptr;
+                fnet_memcpy(ethheader->destination_addr, dest_addr, sizeof(fnet_mac_addr_t));
+                ethheader->type = type;
+
+                ethif->tx_queue_packets++;
+                ethif->tx_queue_bytes += nb->total_length;
+
+                fnet_netbuf_add_chain(&ethif->tx_queue, fnet_netbuf_concat(nb_header, nb));
+            }
+            else
+            {
+                FNET_STATS_INC(eth.out_discards);
+                fnet_netbuf_free_chain(nb); /* Queue overflow.*/
+            }
+
+            return;
+        }
+    }
+#endif /* FNET_CFG_ETH_TX_QUEUE */
+
+    fnet_eth_output_driver(netif, type, dest_addr, nb);
+}
+
+/************************************************************************
+* NAME: fnet_eth_output_driver
+*
+* DESCRIPTION: Passes the frame to the driver.
+*************************************************************************/
+static void fnet_eth_output_driver( fnet_netif_t *netif, unsigned short type, const fnet_mac_addr_t dest_addr,
+                                    fnet_netbuf_t *nb )
+{
+#if FNET_CFG_LATENCY
+    /* The driver may free the frame, save its stamp.*/
+    unsigned long   latency_stamp = nb->timestamp;
+    int             latency_tx = (nb->flags & FNET_NETBUF_FLAG_TX_TIMESTAMP);
+#endif
+
+    FNET_STATS_INC(eth.out_frames);
+    FNET_TRACE(FNET_TRACE_LAYER_ETH, FNET_TRACE_EVENT_TX, fnet_trace_hash(dest_addr, sizeof(fnet_mac_addr_t)), 0, 0, type, nb->total_length);
+    ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, type, dest_addr, nb);
+
+#if FNET_CFG_LATENCY
+    if(latency_tx)
+        FNET_LATENCY_SINCE(FNET_LATENCY_TX_DRIVER, latency_stamp);
+#endif
+}
+
+#if FNET_CFG_ETH_TX_QUEUE
+/************************************************************************
+* NAME: fnet_eth_output_flush
+*
+* DESCRIPTION: Passes the queued frames to the driver, 
+*              while it has free Tx buffers.
+*************************************************************************/
+static void fnet_eth_output_flush( fnet_netif_t *netif )
+{
+    fnet_eth_if_t       *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+    fnet_netbuf_t       *nb;
+    fnet_eth_header_t   ethheader;
+
+    while(ethif->tx_queue && (ethif->output_ready(netif) == FNET_TRUE))
+    {
+        nb = ethif->tx_queue;
+        ethif->tx_queue = nb->next_chain;
+        nb->next_chain = 0;
+
+        fnet_memcpy(&ethheader, nb->data_ptr, sizeof(fnet_eth_header_t));
+        fnet_netbuf_trim(&nb, sizeof(fnet_eth_header_t));
+
+        ethif->tx_queue_packets--;
+
+        if(nb)
+        {
+            ethif->tx_queue_bytes -= nb->total_length;
+            fnet_eth_output_driver(netif, ethheader.type, ethheader.destination_addr, nb);
+        }
+    }
+}
+
+/************************************************************************
+* NAME: fnet_eth_output_complete
+*
+* DESCRIPTION: Called by the driver, when it has completed 
+*              a transmission. Sends the queued frames and lets the 
+*              upper layer resume, when the queue is half empty.
+*************************************************************************/
+void fnet_eth_output_complete( fnet_netif_t *netif )
+{
+    fnet_eth_if_t *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+
+    if(ethif->output_ready)
+    {
+        fnet_eth_output_flush(netif);
+
+        if(ethif->tx_queue_busy
+            && (ethif->tx_queue_packets <= (FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS/2))
+            && (ethif->tx_queue_bytes <= (FNET_CFG_ETH_TX_QUEUE_MAX_BYTES/2)) )
+        {
+            ethif->tx_queue_busy = FNET_FALSE;
+            fnet_prot_output_resume(netif);
+        }
+    }
+}
+
+/************************************************************************
+* NAME: fnet_eth_output_busy
+*
+* DESCRIPTION: Returns FNET_TRUE if the Tx queue can not take 
+*              one more full-sized frame. 
+*              The upper layer will be notified by fnet_prot_output_resume().
+*************************************************************************/
+int fnet_eth_output_busy( fnet_netif_t *netif )
+{
+    fnet_eth_if_t   *ethif = (fnet_eth_if_t *)(netif->if_ptr);
+    int             result;
+
+    if(ethif->output_ready 
+        && ((ethif->tx_queue_packets >= FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS)
+            || ((ethif->tx_queue_bytes + netif->mtu) > FNET_CFG_ETH_TX_QUEUE_MAX_BYTES)) )
+    {
+        ethif->tx_queue_busy = FNET_TRUE;
+        result = FNET_TRUE;
+    }
+    else
+    {
+        result = FNET_FALSE;
+    }
+
+    return result;
+}
+#endif /* FNET_CFG_ETH_TX_QUEUE */
+
 /************************************************************************
 * NAME: fnet_eth_ip4_output
 *
@@ -447,7 +949,7 @@ void fnet_eth_output_ip4(fnet_netif_t *netif, fnet_ip4_addr_t dest_ip_addr, fnet
     }
 
     /* Send Ethernet frame. */
-    ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, FNET_ETH_TYPE_IP4, destination_addr, nb);
+    fnet_eth_output_low(netif, FNET_ETH_TYPE_IP4, destination_addr, nb);
 EXIT:
     return;    
 }
@@ -523,6 +1025,7 @@ void fnet_eth_output_ip6(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip_addr,  fne
                 if(neighbor == FNET_NULL)
                 /* No Router exists.*/
                 {
+                    FNET_STATS_INC(ip6.out_no_routes);
                     fnet_netbuf_free_chain(nb); /* Discard datagram */  
                     goto EXIT;
                 }
@@ -549,7 +1052,7 @@ void fnet_eth_output_ip6(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip_addr,  fne
         /* Queue packet for later transmit.
          */
         {
-            fnet_nd6_neighbor_enqueue_waiting_netbuf(neighbor, nb);
+            fnet_nd6_neighbor_enqueue_waiting_netbuf(netif, neighbor, nb);
             goto EXIT;
         } 
         
@@ -568,7 +1071,7 @@ void fnet_eth_output_ip6(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip_addr,  fne
     }
         
     /* Send Ethernet frame. */
-    ((fnet_eth_if_t *)(netif->if_ptr))->output(netif, FNET_ETH_TYPE_IP6, dest_mac_addr_ptr, nb);    
+    fnet_eth_output_low(netif, FNET_ETH_TYPE_IP6, dest_mac_addr_ptr, nb);    
     
 EXIT:
     return;    
@@ -103,6 +103,7 @@ typedef struct fnet_eth_if
     void                ( *multicast_join)(fnet_netif_t *netif, fnet_mac_addr_t multicast_addr);
     void                ( *multicast_leave)(fnet_netif_t *netif, fnet_mac_addr_t multicast_addr);
 #endif /* FNET_CFG_MULTICAST */
+    int                 ( *output_ready)(fnet_netif_t *netif);  /* Optional. Returns FNET_TRUE if output() will not wait for a free Tx buffer.*/
     /* Internal parameters.*/
     int                 connection_flag;
     fnet_timer_desc_t   eth_timer;    /* Optional ETH timer.*/
@@ -112,9 +113,18 @@ typedef struct fnet_eth_if
 #if FNET_CFG_IP6   
     fnet_nd6_if_t       nd6_if;
 #endif 
-#if !FNET_CFG_CPU_ETH_MIB     
-    struct fnet_netif_statistics statistics;
-#endif    
+    struct fnet_netif_statistics statistics; /* Software counters. Packet counters are taken from the MIB, if present.*/
+#if FNET_CFG_ETH_GRO
+    fnet_netbuf_t       *gro_nb;        /* Held TCP segment, the following segments of its flow are merged into.*/
+    unsigned short      gro_protocol;   /* Ethernet type of the held segment (network byte order).*/
+    unsigned long       gro_next_seq;   /* Sequence number expected in the next segment of the flow.*/
+#endif
+#if FNET_CFG_ETH_TX_QUEUE
+    fnet_netbuf_t       *tx_queue;          /* Queued frames (chains), each starts with its Ethernet header.*/
+    unsigned long       tx_queue_packets;   /* Number of queued frames.*/
+    unsigned long       tx_queue_bytes;     /* Number of queued bytes.*/
+    int                 tx_queue_busy;      /* FNET_TRUE if the busy state was reported to the upper layer.*/
+#endif
 } fnet_eth_if_t;
 
 
@@ -151,6 +161,20 @@ void fnet_eth_output_low( fnet_netif_t *netif, unsigned short type, const fnet_m
                           fnet_netbuf_t *nb );
 void fnet_eth_prot_input( fnet_netif_t *netif, fnet_netbuf_t *nb, unsigned short protocol ); 
 
+#if FNET_CFG_ETH_GRO
+    void fnet_eth_gro_flush( fnet_netif_t *netif );
+#else
+    #define fnet_eth_gro_flush(netif)
+#endif
+
+#if FNET_CFG_ETH_TX_QUEUE
+    void fnet_eth_output_complete( fnet_netif_t *netif );
+    int fnet_eth_output_busy( fnet_netif_t *netif );
+#else
+    #define fnet_eth_output_complete(netif)
+    #define fnet_eth_output_busy(netif)     (FNET_FALSE)
+#endif
+
 #if FNET_CFG_MULTICAST
     #if FNET_CFG_IP4 
         void fnet_eth_multicast_leave_ip4(fnet_netif_t *netif, fnet_ip4_addr_t multicast_addr );
@@ -0,0 +1,376 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_heap_profile.c
+*
+* @author Andrey Butok
+*
+* @brief FNET heap profiler.
+*
+***************************************************************************/
+
+#include "fnet.h"
+#include "fnet_heap_profile_prv.h"
+#include "fnet_netbuf.h"
+#include "fnet_isr.h"
+
+#if FNET_CFG_HEAP_PROFILE
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_HEAP_PROFILE_SITES_MASK    (FNET_CFG_HEAP_PROFILE_SITES - 1)
+
+#if (FNET_CFG_HEAP_PROFILE_SITES & FNET_HEAP_PROFILE_SITES_MASK)
+    #error "FNET_CFG_HEAP_PROFILE_SITES must be a power of two."
+#endif
+
+/* Call site record.*/
+typedef struct
+{
+    const char      *file;
+    unsigned long   line;
+    int             netbuf;
+    unsigned long   allocs;
+    unsigned long   frees;
+    unsigned long   fails;
+    unsigned long   live;
+    unsigned long   peak;
+} fnet_heap_profile_entry_t;
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static fnet_heap_profile_entry_t *fnet_heap_profile_find( const char *file, int line, int netbuf );
+static unsigned long fnet_heap_profile_key( const struct fnet_heap_profile_site *site, fnet_heap_profile_sort_t sort );
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+static fnet_heap_profile_entry_t fnet_heap_profile_table[FNET_CFG_HEAP_PROFILE_SITES];
+static fnet_heap_profile_entry_t fnet_heap_profile_other; /* Call sites, which do not fit into the table.*/
+static unsigned long fnet_heap_profile_start;             /* Time of the last clear, in seconds.*/
+
+/************************************************************************
+* NAME: fnet_heap_profile_init
+*
+* DESCRIPTION: Resets the records. Called by the heap initialization,
+*              no block is allocated yet.
+*************************************************************************/
+void fnet_heap_profile_init( void )
+{
+    fnet_memset_zero(fnet_heap_profile_table, sizeof(fnet_heap_profile_table));
+    fnet_memset_zero(&fnet_heap_profile_other, sizeof(fnet_heap_profile_other));
+    fnet_heap_profile_start = fnet_timer_seconds();
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_find
+*
+* DESCRIPTION: Returns the record of the call site. Adds it, if it is new.
+*              The table is open-addressed.
+*************************************************************************/
+static fnet_heap_profile_entry_t *fnet_heap_profile_find( const char *file, int line, int netbuf )
+{
+    fnet_heap_profile_entry_t   *entry;
+    unsigned long               index = ((unsigned long)file + (unsigned long)line * 31) & FNET_HEAP_PROFILE_SITES_MASK;
+    int                         i;
+
+    for(i = 0; i < FNET_CFG_HEAP_PROFILE_SITES; i++)
+    {
+        entry = &fnet_heap_profile_table[index];
+
+        if(entry->file == 0) /* Free.*/
+        {
+            entry->file = file;
+            entry->line = (unsigned long)line;
+            entry->netbuf = netbuf;
+            return entry;
+        }
+
+        if((entry->file == file) && (entry->line == (unsigned long)line))
+            return entry;
+
+        index = (index + 1) & FNET_HEAP_PROFILE_SITES_MASK;
+    }
+
+    return &fnet_heap_profile_other;
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_malloc
+*
+* DESCRIPTION: Counts the allocation of the call site, 
+*              and tags the block by its record.
+*************************************************************************/
+void fnet_heap_profile_malloc( fnet_mempool_desc_t mempool, void *ap, int netbuf, const char *file, int line )
+{
+    fnet_heap_profile_entry_t   *entry;
+    unsigned long               size;
+
+    fnet_isr_lock();
+
+    entry = fnet_heap_profile_find(file, line, netbuf);
+
+    if(ap)
+    {
+        fnet_mempool_get_tag(mempool, ap, &size); /* Block size.*/
+        fnet_mempool_set_tag(mempool, ap, entry);
+
+        entry->allocs++;
+        entry->live += size;
+
+        if(entry->live > entry->peak)
+            entry->peak = entry->live;
+    }
+    else
+    {
+        entry->fails++;
+    }
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_free
+*
+* DESCRIPTION: Counts the free of the block by the call site 
+*              of its allocation.
+*************************************************************************/
+void fnet_heap_profile_free( fnet_mempool_desc_t mempool, void *ap )
+{
+    fnet_heap_profile_entry_t   *entry;
+    unsigned long               size;
+
+    if(ap)
+    {
+        fnet_isr_lock();
+
+        entry = (fnet_heap_profile_entry_t *)fnet_mempool_get_tag(mempool, ap, &size);
+
+        /* Ignore the blocks, not tagged by the profiler.*/
+        if(((entry >= &fnet_heap_profile_table[0]) && (entry < &fnet_heap_profile_table[FNET_CFG_HEAP_PROFILE_SITES]))
+            || (entry == &fnet_heap_profile_other))
+        {
+            entry->frees++;
+            entry->live -= size;
+        }
+
+        fnet_isr_unlock();
+    }
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_key
+*
+* DESCRIPTION: Returns the sort key of the record.
+*************************************************************************/
+static unsigned long fnet_heap_profile_key( const struct fnet_heap_profile_site *site, fnet_heap_profile_sort_t sort )
+{
+    unsigned long result;
+
+    switch(sort)
+    {
+        case FNET_HEAP_PROFILE_SORT_PEAK:
+            result = site->peak;
+            break;
+        case FNET_HEAP_PROFILE_SORT_ALLOCS:
+            result = site->allocs;
+            break;
+        case FNET_HEAP_PROFILE_SORT_LIVE:
+        default:
+            result = site->live;
+            break;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_get
+*
+* DESCRIPTION: Returns the records, sorted in descending order.
+*              They are insertion sorted into the array, 
+*              the ones beyond its end are dropped.
+*************************************************************************/
+int fnet_heap_profile_get( struct fnet_heap_profile_site *sites, int n, fnet_heap_profile_sort_t sort )
+{
+    fnet_heap_profile_entry_t       entry;
+    struct fnet_heap_profile_site   site;
+    unsigned long                   seconds;
+    unsigned long                   key;
+    int                             count = 0;
+    int                             i;
+    int                             j;
+
+    if((sites == 0) || (n <= 0))
+        return 0;
+
+    seconds = fnet_timer_seconds() - fnet_heap_profile_start;
+
+    for(i = 0; i <= FNET_CFG_HEAP_PROFILE_SITES; i++)
+    {
+        fnet_isr_lock();
+        entry = (i < FNET_CFG_HEAP_PROFILE_SITES) ? fnet_heap_profile_table[i] : fnet_heap_profile_other;
+        fnet_isr_unlock();
+
+        if((entry.allocs == 0) && (entry.fails == 0) && (entry.live == 0))
+            continue; /* Not used.*/
+
+        site.file = (i < FNET_CFG_HEAP_PROFILE_SITES) ? entry.file : 0;
+        site.line = entry.line;
+        site.netbuf = entry.netbuf;
+        site.allocs = entry.allocs;
+        site.frees = entry.frees;
+        site.fails = entry.fails;
+        site.rate = seconds ? (entry.allocs / seconds) : entry.allocs;
+        site.live = entry.live;
+        site.peak = entry.peak;
+
+        key = fnet_heap_profile_key(&site, sort);
+
+        for(j = count; (j > 0) && (fnet_heap_profile_key(&sites[j - 1], sort) < key); j--)
+        {
+            if(j < n)
+                sites[j] = sites[j - 1];
+        }
+
+        if(j < n)
+        {
+            sites[j] = site;
+
+            if(count < n)
+                count++;
+        }
+    }
+
+    return count;
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_clear
+*
+* DESCRIPTION: Resets the counters. The allocated bytes are kept, 
+*              as the blocks are still tagged by their records.
+*************************************************************************/
+void fnet_heap_profile_clear( void )
+{
+    fnet_heap_profile_entry_t   *entry;
+    int                         i;
+
+    fnet_isr_lock();
+
+    for(i = 0; i <= FNET_CFG_HEAP_PROFILE_SITES; i++)
+    {
+        entry = (i < FNET_CFG_HEAP_PROFILE_SITES) ? &fnet_heap_profile_table[i] : &fnet_heap_profile_other;
+
+        entry->allocs = 0;
+        entry->frees = 0;
+        entry->fails = 0;
+        entry->peak = entry->live;
+    }
+
+    fnet_heap_profile_start = fnet_timer_seconds();
+
+    fnet_mem_high_water_reset();
+
+    fnet_isr_unlock();
+}
+
+#else /* FNET_CFG_HEAP_PROFILE */
+
+/************************************************************************
+* NAME: fnet_heap_profile_get
+*
+* DESCRIPTION: The profiler is disabled.
+*************************************************************************/
+int fnet_heap_profile_get( struct fnet_heap_profile_site *sites, int n, fnet_heap_profile_sort_t sort )
+{
+    FNET_COMP_UNUSED_ARG(sites);
+    FNET_COMP_UNUSED_ARG(n);
+    FNET_COMP_UNUSED_ARG(sort);
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fnet_heap_profile_clear
+*
+* DESCRIPTION: Restarts the high-water marks only.
+*************************************************************************/
+void fnet_heap_profile_clear( void )
+{
+    fnet_mem_high_water_reset();
+}
+
+#endif /* FNET_CFG_HEAP_PROFILE */
+
+/************************************************************************
+* NAME: fnet_heap_profile_map
+*
+* DESCRIPTION: Returns the allocated and free memory of the pool, 
+*              and the histogram of its free blocks.
+*************************************************************************/
+int fnet_heap_profile_map( fnet_heap_profile_pool_t pool, struct fnet_heap_profile_map *map )
+{
+    int result = FNET_OK;
+
+    if(map == 0)
+        return FNET_ERR;
+
+    fnet_isr_lock();
+
+    switch(pool)
+    {
+        case FNET_HEAP_PROFILE_POOL_MAIN:
+            map->used = fnet_mem_used();
+            map->high_water = fnet_mem_high_water();
+            map->free = fnet_free_mem_status();
+            map->largest = fnet_malloc_max();
+            map->blocks = fnet_free_mem_histogram(map->histogram, FNET_HEAP_PROFILE_BUCKETS);
+            break;
+        case FNET_HEAP_PROFILE_POOL_NETBUF:
+            map->used = fnet_mem_used_netbuf();
+            map->high_water = fnet_mem_high_water_netbuf();
+            map->free = fnet_free_mem_status_netbuf();
+            map->largest = fnet_malloc_max_netbuf();
+            map->blocks = fnet_free_mem_histogram_netbuf(map->histogram, FNET_HEAP_PROFILE_BUCKETS);
+            break;
+        default:
+            result = FNET_ERR;
+            break;
+    }
+
+    fnet_isr_unlock();
+
+    return result;
+}
@@ -0,0 +1,183 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_heap_profile.h
+*
+* @author Andrey Butok
+*
+* @brief FNET heap profiler API.
+*
+***************************************************************************/
+
+#ifndef _FNET_HEAP_PROFILE_H_
+
+#define _FNET_HEAP_PROFILE_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_heap_profile
+* The Heap Profiler API helps to size the heap (@ref FNET_CFG_HEAP_SIZE) 
+* from the real traffic. @n
+* The @ref fnet_heap_profile_map() shows the allocated memory, its 
+* high-water mark and the fragmentation of the free memory. 
+* It is always available. @n
+* The @ref fnet_heap_profile_get() shows the allocations of every call site 
+* of @c fnet_malloc() and @c fnet_malloc_netbuf(). 
+* It is available only if @ref FNET_CFG_HEAP_PROFILE is set to @c 1. 
+* It is an instrumented build mode, so all code using 
+* the allocation functions must be recompiled. @n
+* A call site record is kept in the header of every allocated block, 
+* so the profiler does not search for it on free. @n
+* The sizes include the block headers and the alignment 
+* of the memory pool.
+*/
+
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Memory pools.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_HEAP_PROFILE_POOL_MAIN = 0,    /**< @brief Main heap, used by @c fnet_malloc().*/
+    FNET_HEAP_PROFILE_POOL_NETBUF = 1   /**< @brief Net buffer heap, used by @c fnet_malloc_netbuf(). @n
+                                         * It is the main heap, if it is not split.*/
+} fnet_heap_profile_pool_t;
+
+/**************************************************************************/ /*!
+ * @brief Sort order of the @ref fnet_heap_profile_get() records.
+ * The records are sorted in descending order.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_HEAP_PROFILE_SORT_LIVE = 0,    /**< @brief By the allocated bytes.*/
+    FNET_HEAP_PROFILE_SORT_PEAK = 1,    /**< @brief By the peak of the allocated bytes.*/
+    FNET_HEAP_PROFILE_SORT_ALLOCS = 2   /**< @brief By the number of allocations.*/
+} fnet_heap_profile_sort_t;
+
+/**************************************************************************/ /*!
+ * @brief Number of the histogram buckets of the @ref fnet_heap_profile_map. 
+ * The bucket @c n counts the free blocks from 2^n to 2^(n+1)-1 bytes. 
+ * The last bucket counts also the larger blocks.
+ ******************************************************************************/
+#define FNET_HEAP_PROFILE_BUCKETS   (24)
+
+/**************************************************************************/ /*!
+ * @brief Memory pool map, returned by the @ref fnet_heap_profile_map().
+ ******************************************************************************/
+struct fnet_heap_profile_map
+{
+    unsigned long   used;           /**< @brief Allocated bytes.*/
+    unsigned long   high_water;     /**< @brief High-water mark of the allocated bytes.*/
+    unsigned long   free;           /**< @brief Free bytes.*/
+    unsigned long   largest;        /**< @brief Largest free block, in bytes.*/
+    unsigned long   blocks;         /**< @brief Number of the free blocks.*/
+    unsigned long   histogram[FNET_HEAP_PROFILE_BUCKETS]; /**< @brief Log2 histogram of the free block sizes.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Allocation call site record, returned by the @ref fnet_heap_profile_get().
+ ******************************************************************************/
+struct fnet_heap_profile_site
+{
+    const char      *file;      /**< @brief Source file of the call site. @n
+                                 * It is @c 0 for the call sites, 
+                                 * which did not fit into the table 
+                                 * (@ref FNET_CFG_HEAP_PROFILE_SITES).*/
+    unsigned long   line;       /**< @brief Source line of the call site.*/
+    int             netbuf;     /**< @brief @c 1 for @c fnet_malloc_netbuf(), 
+                                 * @c 0 for @c fnet_malloc().*/
+    unsigned long   allocs;     /**< @brief Number of the allocations.*/
+    unsigned long   frees;      /**< @brief Number of the freed blocks.*/
+    unsigned long   fails;      /**< @brief Number of the failed allocations.*/
+    unsigned long   rate;       /**< @brief Allocations per second.*/
+    unsigned long   live;       /**< @brief Allocated bytes, not freed yet.*/
+    unsigned long   peak;       /**< @brief Peak of the allocated bytes.*/
+};
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the map of a memory pool.
+ *
+ * @param pool    Memory pool, defined by @ref fnet_heap_profile_pool_t.
+ *
+ * @param map     Structure that receives the map.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the @c pool is invalid.
+ *
+ ******************************************************************************
+ *
+ * It walks the free list of the memory pool, so the stack is locked 
+ * for a time proportional to the number of the free blocks.
+ *
+ ******************************************************************************/
+int fnet_heap_profile_map( fnet_heap_profile_pool_t pool, struct fnet_heap_profile_map *map );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the call site records, sorted in descending order.
+ *
+ * @param sites   Array that receives the records.
+ *
+ * @param n       Size of the @c sites array.
+ *
+ * @param sort    Sort order, defined by @ref fnet_heap_profile_sort_t.
+ *
+ * @return This function returns the number of the retrieved records, 
+ *         up to @c n. @n
+ *         It is @c 0 if the profiler is disabled by @ref FNET_CFG_HEAP_PROFILE.
+ *
+ ******************************************************************************
+ *
+ * If there are more records than @c n, the first @c n records 
+ * of the sort order are retrieved.
+ *
+ ******************************************************************************/
+int fnet_heap_profile_get( struct fnet_heap_profile_site *sites, int n, fnet_heap_profile_sort_t sort );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Restarts the measurement.
+ *
+ ******************************************************************************
+ *
+ * It resets the allocation counters and restarts the peaks 
+ * and the high-water marks from the currently allocated bytes.
+ *
+ ******************************************************************************/
+void fnet_heap_profile_clear( void );
+
+/*! @} */
+
+#endif /* _FNET_HEAP_PROFILE_H_ */
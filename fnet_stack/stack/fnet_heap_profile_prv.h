@@ -0,0 +1,69 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_heap_profile_prv.h
+*
+* @author Andrey Butok
+*
+* @brief Private. FNET heap profiler.
+*
+***************************************************************************/
+
+#ifndef _FNET_HEAP_PROFILE_PRV_H_
+
+#define _FNET_HEAP_PROFILE_PRV_H_
+
+#include "fnet_config.h"
+#include "fnet_heap_profile.h"
+#include "fnet_mempool.h"
+
+#if FNET_CFG_HEAP_PROFILE
+
+#define FNET_HEAP_PROFILE_MALLOC(mempool, ap, netbuf, file, line)   fnet_heap_profile_malloc((mempool), (ap), (netbuf), (file), (line))
+#define FNET_HEAP_PROFILE_FREE(mempool, ap)                         fnet_heap_profile_free((mempool), (ap))
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+void fnet_heap_profile_init( void );
+void fnet_heap_profile_malloc( fnet_mempool_desc_t mempool, void *ap, int netbuf, const char *file, int line );
+void fnet_heap_profile_free( fnet_mempool_desc_t mempool, void *ap );
+
+#else
+
+#define FNET_HEAP_PROFILE_MALLOC(mempool, ap, netbuf, file, line)   ((void)0)
+#define FNET_HEAP_PROFILE_FREE(mempool, ap)                         ((void)0)
+#define fnet_heap_profile_init()                                    ((void)0)
+
+#endif /* FNET_CFG_HEAP_PROFILE */
+
+#endif /* _FNET_HEAP_PROFILE_PRV_H_ */
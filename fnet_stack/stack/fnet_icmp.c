@@ -54,6 +54,8 @@
 #include "fnet_socket.h"
 #include "fnet_socket_prv.h"
 #include "fnet_checksum.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
 
 
 /************************************************************************
@@ -85,6 +87,7 @@ fnet_prot_if_t fnet_icmp_prot_if =
     0,                      /* protocol drain function.*/
 #if FNET_CFG_IP6    
     0,                      /* Protocol IPv6 input function.*/
+    0,                      /* Protocol IPv6 input control function.*/
 #endif /* FNET_CFG_IP6 */      
     0                       /* Socket API */
 };
@@ -107,8 +110,11 @@ static void fnet_icmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
     
     if((netif != 0) && (nb != 0) )
     {
+        FNET_STATS_INC(icmp.in_msgs);
+
         if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_icmp_header_t))) == 0) /* The header must reside in contiguous area of memory. */
         {
+            FNET_STATS_INC(icmp.in_errors);
             goto DISCARD;
         }
 
@@ -124,10 +130,13 @@ static void fnet_icmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
             || fnet_ip_addr_is_broadcast(src_ip, netif)
             || FNET_IP4_ADDR_IS_MULTICAST(src_ip))
         {
+            FNET_STATS_INC(icmp.in_errors);
             goto DISCARD;
         }
         
         fnet_icmp_trace("RX", hdr); 
+        FNET_TRACE(FNET_TRACE_LAYER_ICMP, FNET_TRACE_EVENT_RX, fnet_ntohl(src_ip), 0, 0, 
+                   ((unsigned long)hdr->type << 8) | hdr->code, nb->total_length);
         
         switch(hdr->type)
         {
@@ -135,6 +144,8 @@ static void fnet_icmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
              * ICMP Request Processing
              **************************/
             case FNET_ICMP_ECHO:
+                FNET_STATS_INC(icmp.in_echos);
+
                 if((nb->total_length < sizeof(fnet_icmp_echo_header_t)) ||
                 /* An ICMP Echo Request destined to an IP broadcast or IP
                 * multicast address MAY be silently discarded.(RFC1122)*/
@@ -145,6 +156,7 @@ static void fnet_icmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
 
                 hdr->type = FNET_ICMP_ECHOREPLY;
 
+                FNET_STATS_INC(icmp.out_echo_reps);
                 fnet_icmp_output(netif, dest_ip, src_ip, nb);
                 break;
 #if 0 /* Optional functionality.*/                
@@ -200,6 +212,8 @@ static void fnet_icmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
              * ICMP Error Processing
              **************************/
             case FNET_ICMP_UNREACHABLE:
+                FNET_STATS_INC(icmp.in_dest_unreachs);
+
                 switch(hdr->code)
                 {
                     case FNET_ICMP_UNREACHABLE_NET:           /* net unreachable */
@@ -329,7 +343,7 @@ static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip,
 #if FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM 
     if( netif 
             && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
-            && (fnet_ip_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
+            && (fnet_ip_will_fragment(netif, FNET_NULL, dest_ip, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
     {
         nb->flags |= FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM;
     }
@@ -337,7 +351,10 @@ static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip,
 #endif
         hdr->checksum = fnet_checksum(nb, (int)nb->total_length);
 
-    fnet_ip_output(netif, src_ip, dest_ip, FNET_IP_PROTOCOL_ICMP, FNET_ICMP_TOS, FNET_ICMP_TTL, nb, 0, 0, 0);
+    FNET_STATS_INC(icmp.out_msgs);
+    FNET_TRACE(FNET_TRACE_LAYER_ICMP, FNET_TRACE_EVENT_TX, fnet_ntohl(dest_ip), 0, 0, 
+               ((unsigned long)hdr->type << 8) | hdr->code, nb->total_length);
+    fnet_ip_output(netif, src_ip, dest_ip, FNET_IP_PROTOCOL_ICMP, FNET_ICMP_TOS, FNET_ICMP_TTL, nb, 0, 0, 0, FNET_NULL);
 }
 
 /************************************************************************
@@ -346,7 +363,7 @@ static void fnet_icmp_output( fnet_netif_t *netif, fnet_ip4_addr_t src_ip,
 * DESCRIPTION: Sends ICMP error message.
 *************************************************************************/
 void fnet_icmp_error( fnet_netif_t *netif, unsigned char type, 
-                        unsigned char code, fnet_netbuf_t *nb )
+                        unsigned char code, unsigned long param, fnet_netbuf_t *nb )
 {
     fnet_ip_header_t        *ipheader;
     fnet_netbuf_t           *nb_header;
@@ -398,8 +415,8 @@ void fnet_icmp_error( fnet_netif_t *netif, unsigned char type,
             icmpheader->fields.ptr = fnet_htons((unsigned short)code);
             code = 0;
         }
-        else if((type == FNET_ICMP_PARAMPROB) && (code == FNET_ICMP_UNREACHABLE_NEEDFRAG) && netif)
-            icmpheader->fields.mtu = fnet_htons((unsigned short)netif->mtu);
+        else if((type == FNET_ICMP_UNREACHABLE) && (code == FNET_ICMP_UNREACHABLE_NEEDFRAG))
+            icmpheader->fields.mtu = fnet_htons((unsigned short)param); /* Next-hop MTU.*/
 
         icmpheader->header.type = type;
         icmpheader->header.code = code;
@@ -409,6 +426,14 @@ void fnet_icmp_error( fnet_netif_t *netif, unsigned char type,
 
         nb = fnet_netbuf_concat(nb_header, nb);
 
+        /* A forwarded datagram is not addressed to this host, 
+         * so the error is sent from the address of the interface.*/
+        if(destination_addr != netif->ip4_addr.address)
+            destination_addr = netif->ip4_addr.address;
+
+        if(type == FNET_ICMP_UNREACHABLE)
+            FNET_STATS_INC(icmp.out_dest_unreachs);
+
         fnet_icmp_output(netif, destination_addr, source_addr, nb);
 
         return;
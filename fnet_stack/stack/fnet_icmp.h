@@ -183,7 +183,7 @@ extern struct fnet_prot_if fnet_icmp_prot_if;
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
-void fnet_icmp_error( fnet_netif_t *netif, unsigned char type, unsigned char code, fnet_netbuf_t *nb );
+void fnet_icmp_error( fnet_netif_t *netif, unsigned char type, unsigned char code, unsigned long param, fnet_netbuf_t *nb );
 
 #endif /* FNET_CFG_IP4 */
 
@@ -53,6 +53,8 @@
 #include "fnet_socket.h"
 #include "fnet_socket_prv.h"
 #include "fnet_checksum.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
 
 
 /************************************************************************
@@ -78,6 +80,7 @@ fnet_prot_if_t fnet_icmp6_prot_if =
     0,                      /* Protocol input control function.*/     
     0,                      /* protocol drain function.*/
     fnet_icmp6_input,       /* Protocol input function, from IPv6.*/
+    0,                      /* Protocol input control function, from IPv6.*/
     0                       /* Socket API */
 };
 
@@ -95,9 +98,12 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
 
     if((netif != 0) && (nb != 0))
     {
+        FNET_STATS_INC(icmp6.in_msgs);
+
         /* The header must reside in contiguous area of memory. */
         if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_icmp6_header_t))) == 0) 
         {
+            FNET_STATS_INC(icmp6.in_errors);
             goto DISCARD;
         }
 
@@ -117,7 +123,16 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
         sum = fnet_checksum_pseudo_start( nb, FNET_HTONS((unsigned short)FNET_IP_PROTOCOL_ICMP6), (unsigned short)nb->total_length );
         sum = fnet_checksum_pseudo_end( sum, (char *)src_ip, (char *)dest_ip, sizeof(fnet_ip6_addr_t) );
         if(sum)
+        {
+            FNET_STATS_INC(icmp6.in_errors);
             goto DISCARD;
+        }
+
+        FNET_TRACE(FNET_TRACE_LAYER_ICMP6, FNET_TRACE_EVENT_RX, fnet_trace_hash(src_ip, sizeof(fnet_ip6_addr_t)), 0, 0, 
+                   ((unsigned long)hdr->type << 8) | hdr->code, nb->total_length);
+
+        if(hdr->type == FNET_ICMP6_TYPE_DEST_UNREACH)
+            FNET_STATS_INC(icmp6.in_dest_unreachs);
 
     	/************************************************************
     	* Process incoming ICMPv6 packets.
@@ -154,6 +169,8 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
              * receives Echo Requests and originates corresponding Echo Replies.             
              **************************/
             case FNET_ICMP6_TYPE_ECHO_REQ:
+                FNET_STATS_INC(icmp6.in_echos);
+                FNET_STATS_INC(icmp6.out_echo_reps);
                 hdr->type = FNET_ICMP6_TYPE_ECHO_REPLY;
                 
                 /* RFC4443: the source address of the reply MUST be a unicast 
@@ -173,7 +190,9 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
                 if(netif->pmtu) /* If PMTU is enabled for the interface.*/
                 {
                     unsigned long           pmtu;
-                    fnet_icmp6_err_header_t *icmp6_err = nb->data_ptr;
+                    fnet_icmp6_err_header_t *icmp6_err;
+                    fnet_ip6_header_t       *ip6_header;
+                    fnet_prot_if_t          *protocol;
                     
                     /* The header must reside in contiguous area of memory. */
                     if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_icmp6_err_header_t))) == 0) 
@@ -183,6 +202,8 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
 
                     nb = tmp_nb;
                     
+                    icmp6_err = nb->data_ptr;
+                    
                     /* RFC 1981.Upon receipt of such a
                      * message, the source node reduces its assumed PMTU for the path based
                      * on the MTU of the constricting hop as reported in the Packet Too Big
@@ -194,6 +215,24 @@ static void fnet_icmp6_input(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_
                     if(netif->pmtu > pmtu)        
                     {
                         fnet_netif_set_pmtu(netif, pmtu);
+                        
+                        /* Notify the upper-layer protocol of the invoking packet,
+                         * so it may resend its data in smaller packets.
+                         * The invoking IPv6 header and the first 8 bytes of 
+                         * the upper-layer header must reside in contiguous area of memory.*/
+                        if((nb->total_length >= (sizeof(fnet_icmp6_err_header_t) + sizeof(fnet_ip6_header_t) + 8))
+                            && ((tmp_nb = fnet_netbuf_pullup(nb, (int)(sizeof(fnet_icmp6_err_header_t) + sizeof(fnet_ip6_header_t) + 8))) != 0))
+                        {
+                            nb = tmp_nb;
+                            
+                            ip6_header = (fnet_ip6_header_t *)((char *)nb->data_ptr + sizeof(fnet_icmp6_err_header_t));
+                            
+                            if(((protocol = fnet_prot_find(AF_INET6, SOCK_UNSPEC, ip6_header->next_header)) != 0) 
+                                && protocol->prot_control_input_ip6)
+                            {
+                                protocol->prot_control_input_ip6(FNET_PROT_NOTIFY_MSGSIZE, ip6_header);
+                            }
+                        }
                     }                
                 }
                 goto DISCARD;
@@ -226,7 +265,10 @@ void fnet_icmp6_output( fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_a
     hdr->checksum = fnet_checksum_pseudo_start(nb, FNET_HTONS((unsigned short)FNET_IP_PROTOCOL_ICMP6), (unsigned short)nb->total_length);
     checksum_p = &hdr->checksum;
 
-    fnet_ip6_output(netif, src_ip, dest_ip, FNET_IP_PROTOCOL_ICMP6, hop_limit, nb, checksum_p);
+    FNET_STATS_INC(icmp6.out_msgs);
+    FNET_TRACE(FNET_TRACE_LAYER_ICMP6, FNET_TRACE_EVENT_TX, fnet_trace_hash(dest_ip, sizeof(fnet_ip6_addr_t)), 0, 0, 
+               ((unsigned long)hdr->type << 8) | hdr->code, nb->total_length);
+    fnet_ip6_output(netif, src_ip, dest_ip, FNET_IP_PROTOCOL_ICMP6, hop_limit, nb, checksum_p, FNET_NULL);
 }
 
 /************************************************************************
@@ -294,7 +336,9 @@ void fnet_icmp6_error( fnet_netif_t *netif, unsigned char type, unsigned char co
          }
          else
          {
-            if(FNET_IP6_ADDR_IS_MULTICAST(dest_ip))
+            if(FNET_IP6_ADDR_IS_MULTICAST(dest_ip)
+                /* A forwarded packet is not addressed to this host.*/
+                || (fnet_netif_is_my_ip6_addr(netif, dest_ip) == FNET_FALSE))
                 /* We may not use multicast address as source. Get real source address. */
                 dest_ip = (fnet_ip6_addr_t *)fnet_ip6_select_src_addr(netif, src_ip /*dest*/); 
          
@@ -332,6 +376,9 @@ void fnet_icmp6_error( fnet_netif_t *netif, unsigned char type, unsigned char co
         
         origin_nb = fnet_netbuf_concat(nb_header, origin_nb);
         
+        if(type == FNET_ICMP6_TYPE_DEST_UNREACH)
+            FNET_STATS_INC(icmp6.out_dest_unreachs);
+
         fnet_icmp6_output( netif, dest_ip/*ipsrc*/, src_ip/*ipdest*/, 0, origin_nb);        
             
         return;
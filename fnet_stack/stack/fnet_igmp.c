@@ -51,6 +51,7 @@
 #include "fnet_timer.h"
 #include "fnet_prot.h"
 #include "fnet_checksum.h"
+#include "fnet_trace_prv.h"
 
 /* TBD Random delay timers */
 
@@ -88,6 +89,7 @@ fnet_prot_if_t fnet_igmp_prot_if =
     0,                      /* protocol drain function.*/
 #if FNET_CFG_IP6    
     0,                      /* Protocol IPv6 input function.*/
+    0,                      /* Protocol IPv6 input control function.*/
 #endif /* FNET_CFG_IP6 */    
     0                       /* Socket API */
 };
@@ -130,6 +132,7 @@ static void fnet_igmp_input( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fnet_i
         }
         
         fnet_igmp_trace("RX", hdr); 
+        FNET_TRACE(FNET_TRACE_LAYER_IGMP, FNET_TRACE_EVENT_RX, fnet_ntohl(hdr->group_addr), 0, 0, hdr->type, nb->total_length);
 
         /**************************
         * IGMP QUERY Processing
@@ -214,7 +217,7 @@ void fnet_igmp_join( fnet_netif_t *netif, fnet_ip4_addr_t  group_addr )
         /* RFC 1112: A Report is sent with an IP destination address equal to the
          * host group address being reported, and with an IP time-to-live of 1.
          */
-        fnet_ip_output(netif, INADDR_ANY, group_addr /*dest_addr*/, FNET_IP_PROTOCOL_IGMP, FNET_IGMP_TOS, FNET_IGMP_TTL, nb_header, 0, 0, 0);
+        fnet_ip_output(netif, INADDR_ANY, group_addr /*dest_addr*/, FNET_IP_PROTOCOL_IGMP, FNET_IGMP_TOS, FNET_IGMP_TTL, nb_header, 0, 0, 0, FNET_NULL);
     }
 }
 
@@ -254,7 +257,7 @@ void fnet_igmp_leave( fnet_netif_t *netif, fnet_ip4_addr_t  group_addr )
          * host group address being reported, and with an IP time-to-live of 1.
          */
         
-        fnet_ip_output(netif, INADDR_ANY, dest_ip /*dest_addr*/, FNET_IP_PROTOCOL_IGMP, FNET_IGMP_TOS, FNET_IGMP_TTL, nb_header, 0, 0, 0);
+        fnet_ip_output(netif, INADDR_ANY, dest_ip /*dest_addr*/, FNET_IP_PROTOCOL_IGMP, FNET_IGMP_TOS, FNET_IGMP_TTL, nb_header, 0, 0, 0, FNET_NULL);
     }
 #endif /* FNET_CFG_IGMP_VERSION */
 }
@@ -58,17 +58,25 @@
 #include "fnet_netbuf.h"
 #include "fnet_netif_prv.h"
 #include "fnet_prot.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
+#include "fnet_latency_prv.h"
 #include "fnet_stdlib.h"
 #include "fnet_loop.h"
 #include "fnet_igmp.h"
 #include "fnet_prot.h"
 #include "fnet_raw.h"
+#include "fnet_eth_prv.h"
 
 #if FNET_CFG_IP4 
 
 #if FNET_CFG_IP4_FRAGMENTATION
-    static fnet_ip_frag_list_t *ip_frag_list_head;
+    static fnet_ip_frag_list_t *ip_frag_list_head;   /* The oldest reassembly list.*/
+    static fnet_ip_frag_list_t *ip_frag_list_tail;   /* The youngest reassembly list.*/
+    static fnet_ip_frag_list_t *ip_frag_hash_table[FNET_CFG_IP4_FRAG_HASH_SIZE];
+    static unsigned long ip_frag_memory;             /* Bytes held by all fragments.*/
     static fnet_timer_desc_t ip_timer_ptr;
+    fnet_ip_frag_stats_t fnet_ip_frag_stats;
 #endif
 
 static fnet_ip_queue_t   ip_queue;
@@ -81,19 +89,33 @@ static fnet_event_desc_t ip_event;
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
-static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb, int do_not_route);
+static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_ip4_addr_t next_hop, fnet_netbuf_t* nb, fnet_netif_dst_t *dst);
+static int fnet_ip_fragment( fnet_netif_t *netif, fnet_ip4_addr_t dest_ip, fnet_ip4_addr_t next_hop, fnet_netbuf_t *nb, unsigned long mtu, fnet_netif_dst_t *dst );
+static fnet_netif_t *fnet_ip_route_prv( fnet_netif_dst_t *dst, fnet_ip4_addr_t dest_ip, unsigned long *mtu, fnet_ip4_addr_t *next_hop );
+static fnet_ip4_addr_t fnet_ip_next_hop( fnet_netif_t *netif, fnet_ip4_addr_t dest_ip, int do_not_route, fnet_netif_dst_t *dst, unsigned long *mtu );
+#if FNET_CFG_IP4_FORWARDING
+    static int fnet_ip_forward( fnet_netif_t *netif, fnet_netbuf_t *nb );
+#endif
 void fnet_ip_input_low( void *cookie );
+static int fnet_ip_addr_is_local( fnet_netif_t *netif, fnet_ip4_addr_t addr );
+#if FNET_CFG_IP4_FORWARDING
+    static int fnet_ip_addr_is_own( fnet_ip4_addr_t addr );
+#endif
 
 #if FNET_CFG_IP4_FRAGMENTATION
     fnet_netbuf_t *fnet_ip_reassembly( fnet_netbuf_t ** nb_ptr );
-    static void fnet_ip_frag_list_add( fnet_ip_frag_list_t ** head, fnet_ip_frag_list_t *fl );
-    static void fnet_ip_frag_list_del( fnet_ip_frag_list_t ** head, fnet_ip_frag_list_t *fl );
-    static void fnet_ip_frag_add( fnet_ip_frag_header_t ** head, fnet_ip_frag_header_t *frag, fnet_ip_frag_header_t *frag_prev );
-    static void fnet_ip_frag_del( fnet_ip_frag_header_t ** head, fnet_ip_frag_header_t *frag );
+    static void fnet_ip_frag_list_add( fnet_ip_frag_list_t *fl, unsigned long hash );
+    static void fnet_ip_frag_list_del( fnet_ip_frag_list_t *fl );
+    static unsigned long fnet_ip_frag_hash( fnet_ip4_addr_t source_addr, fnet_ip4_addr_t desination_addr, unsigned short id, unsigned char protocol );
     static void fnet_ip_frag_list_free( fnet_ip_frag_list_t *list );
     static void fnet_ip_timer( void *cookie );
 #endif
 
+/* Binary trace of an IPv4 datagram.*/
+#define FNET_IP_TRACE(event, hdr)   \
+    FNET_TRACE(FNET_TRACE_LAYER_IP, (event), fnet_ntohl((hdr)->source_addr ^ (hdr)->desination_addr), \
+               fnet_ntohs((hdr)->id), 0, (hdr)->protocol, fnet_ntohs((hdr)->total_length))
+
 #if FNET_CFG_DEBUG_TRACE_IP
     void fnet_ip_trace(char *str, fnet_ip_header_t *ip_hdr);
 #else
@@ -113,6 +135,10 @@ int fnet_ip_init( void )
 #if FNET_CFG_IP4_FRAGMENTATION
 
     ip_frag_list_head = 0;
+    ip_frag_list_tail = 0;
+    ip_frag_memory = 0;
+    fnet_memset_zero(ip_frag_hash_table, sizeof(ip_frag_hash_table));
+    fnet_memset_zero(&fnet_ip_frag_stats, sizeof(fnet_ip_frag_stats));
     ip_timer_ptr = fnet_timer_new((FNET_IP_TIMER_PERIOD / FNET_TIMER_PERIOD_MS), fnet_ip_timer, 0);
 
     if(ip_timer_ptr)
@@ -154,35 +180,127 @@ void fnet_ip_release( void )
 }
 
 /************************************************************************
-* NAME: fnet_ip_route
+* NAME: fnet_ip_route_prv
 *
-* DESCRIPTION: This function performs IP routing 
-*              on an outgoing IP packet. 
+* DESCRIPTION: This function performs IP routing by the longest-prefix 
+*              match in the routing table. If the destination cache entry
+*              is present, it is used and refilled if it is not valid 
+*              any more. The path MTU and the next-hop address are 
+*              returned by the mtu and next_hop parameters.
 *************************************************************************/
-fnet_netif_t *fnet_ip_route( fnet_ip4_addr_t dest_ip )
+static fnet_netif_t *fnet_ip_route_prv( fnet_netif_dst_t *dst /*optional*/, fnet_ip4_addr_t dest_ip, unsigned long *mtu /*optional*/, fnet_ip4_addr_t *next_hop /*optional*/ )
 {
     fnet_netif_t    *netif;
-    fnet_netif_t    *res_netif = fnet_netif_get_default() ;
+    unsigned long   route_mtu;
+    fnet_ip4_addr_t route_next_hop;
 
-    for (netif = fnet_netif_list; netif != 0; netif = netif->next)
+    if(dst && FNET_NETIF_DST_IS_VALID(dst))
     {
-        if((dest_ip & netif->ip4_addr.subnetmask) == (netif->ip4_addr.address & netif->ip4_addr.subnetmask))
+        netif = dst->netif;
+        route_mtu = dst->mtu;
+        route_next_hop = dst->ip4_next_hop;
+    }
+    else
+    {
+        netif = fnet_netif_ip4_route_lookup(dest_ip, &route_next_hop, &route_mtu);
+
+#if FNET_CFG_LOOPBACK    
+        /* Anything sent to one of the host's own IP address is sent to the loopback interface.*/
+        if(netif && (dest_ip == netif->ip4_addr.address))
         {
-            res_netif = netif;
-            break;
+            netif = FNET_LOOP_IF;
+            route_mtu = netif->mtu;
+            route_next_hop = dest_ip;
+        }
+#endif /* FNET_CFG_LOOPBACK */
+
+        if(dst)
+        {
+            dst->netif = netif;
+            dst->generation = fnet_netif_dst_generation;
+            dst->ll_addr_valid = FNET_FALSE;
+            dst->mtu = route_mtu;
+            dst->ip4_next_hop = route_next_hop;
         }
     }
 
-#if FNET_CFG_LOOPBACK    
-    /* Anything sent to one of the host's own IP address is sent to the loopback interface.*/
-    if(dest_ip == res_netif->ip4_addr.address)
+    if(netif)
     {
-        res_netif = FNET_LOOP_IF;
+        if(mtu)
+            *mtu = route_mtu;
+        
+        if(next_hop)
+            *next_hop = route_next_hop;
     }
-#endif /* FNET_CFG_LOOPBACK */
 
+    return netif;
+}
+
+/************************************************************************
+* NAME: fnet_ip_route
+*
+* DESCRIPTION: This function performs IP routing 
+*              on an outgoing IP packet. 
+*************************************************************************/
+fnet_netif_t *fnet_ip_route( fnet_ip4_addr_t dest_ip )
+{
+    return fnet_ip_route_prv(FNET_NULL, dest_ip, FNET_NULL, FNET_NULL);
+}
+
+/************************************************************************
+* NAME: fnet_ip_dst_route
+*
+* DESCRIPTION: This function performs IP routing, using the destination
+*              cache entry of a connected socket. 
+*              The entry is refilled if it is not valid any more.
+*************************************************************************/
+fnet_netif_t *fnet_ip_dst_route( fnet_netif_dst_t *dst /*optional*/, fnet_ip4_addr_t dest_ip )
+{
+    return fnet_ip_route_prv(dst, dest_ip, FNET_NULL, FNET_NULL);
+}
+
+/************************************************************************
+* NAME: fnet_ip_next_hop
+*
+* DESCRIPTION: This function returns the next-hop address of 
+*              an outgoing unicast IP packet, sent to the interface 
+*              resolved by the caller, and the path MTU (optional).
+*              The destination cache entry is used if it is valid 
+*              for this interface. If the interface is not the routed 
+*              one, its own MTU is used.
+*              It is done once per datagram, not per fragment.
+*************************************************************************/
+static fnet_ip4_addr_t fnet_ip_next_hop( fnet_netif_t *netif, fnet_ip4_addr_t dest_ip, int do_not_route, 
+                                         fnet_netif_dst_t *dst /*optional*/, unsigned long *mtu /*optional*/ )
+{
+    fnet_ip4_addr_t next_hop = dest_ip;
+    fnet_ip4_addr_t route_next_hop;
+    unsigned long   route_mtu;
+
+    if(dst && FNET_NETIF_DST_IS_VALID(dst) && (dst->netif == netif))
+    {
+        route_next_hop = dst->ip4_next_hop;
+        route_mtu = dst->mtu;
+    }
+    else if(fnet_netif_ip4_route_lookup(dest_ip, &route_next_hop, &route_mtu) != netif)
+    {
+        /* The interface is not the routed one (it is forced by the caller),
+         * so use its subnet and its default router.*/
+        if((dest_ip & netif->ip4_addr.subnetmask) == (netif->ip4_addr.address & netif->ip4_addr.subnetmask))
+            route_next_hop = dest_ip;
+        else
+            route_next_hop = netif->ip4_addr.gateway;
 
-    return res_netif;
+        route_mtu = netif->mtu;
+    }
+
+    if(do_not_route == 0) /* Otherwise, sent directly to the destination.*/
+        next_hop = route_next_hop;
+
+    if(mtu)
+        *mtu = route_mtu;
+
+    return next_hop;
 }
 
 /************************************************************************
@@ -190,12 +308,16 @@ fnet_netif_t *fnet_ip_route( fnet_ip4_addr_t dest_ip )
 *
 * DESCRIPTION: This function returns FNET_TRUE if the protocol message 
 *              will be fragmented by IPv4, and FNET_FALSE otherwise.
+*              The MTU of the route to the destination is used.
 *************************************************************************/
-int fnet_ip_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_size)
+int fnet_ip_will_fragment( fnet_netif_t *netif, fnet_netif_dst_t *dst /*optional*/, fnet_ip4_addr_t dest_ip, unsigned long protocol_message_size)
 {
-    int res;
+    int             res;
+    unsigned long   mtu;
+
+    (void)fnet_ip_next_hop(netif, dest_ip, FNET_FALSE, dst, &mtu);
 
-    if((protocol_message_size + sizeof(fnet_ip_header_t)) > netif->mtu)
+    if((protocol_message_size + sizeof(fnet_ip_header_t)) > mtu)
         res = FNET_TRUE;
     else
         res = FNET_FALSE;
@@ -216,20 +338,34 @@ int fnet_ip_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_s
 int fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fnet_ip4_addr_t dest_ip,
                     unsigned char protocol, unsigned char tos,     unsigned char ttl,
                     fnet_netbuf_t *nb,      int DF, int do_not_route,
-                    FNET_COMP_PACKED_VAR unsigned short *checksum )
+                    FNET_COMP_PACKED_VAR unsigned short *checksum, fnet_netif_dst_t *dst /*optional*/ )
 {
     static unsigned short   ip_id = 0;
     fnet_netbuf_t           *nb_header;
     fnet_ip_header_t        *ipheader;
     unsigned long           total_length;
     int                     error_code;
+    unsigned long           mtu;
+    fnet_ip4_addr_t         next_hop;
+
+    FNET_STATS_INC(ip.out_requests);
 
     if(netif == 0)
-        if((netif = fnet_ip_route(dest_ip)) == 0) /* No route */
+    {
+        if((netif = fnet_ip_route_prv(dst, dest_ip, &mtu, &next_hop)) == 0) /* No route */
         {
+            FNET_STATS_INC(ip.out_no_routes);
             error_code = FNET_ERR_NETUNREACH;
             goto DROP;
         }
+        
+        if(do_not_route)
+            next_hop = dest_ip;
+    }
+    else
+    {
+        next_hop = fnet_ip_next_hop(netif, dest_ip, do_not_route, dst, &mtu);
+    }
 
     /* If source address not specified, use address of outgoing interface */
     if(src_ip == INADDR_ANY)
@@ -239,6 +375,7 @@ int fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fnet_ip4_add
 
     if((nb->total_length + sizeof(fnet_ip_header_t)) > FNET_IP_MAX_PACKET)
     {
+        FNET_STATS_INC(ip.out_discards);
         error_code = FNET_ERR_MSGSIZE;
         goto DROP;
     }
@@ -246,6 +383,7 @@ int fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fnet_ip4_add
     /* Construct IP header */
     if((nb_header = fnet_netbuf_new(sizeof(fnet_ip_header_t), FNET_TRUE)) == 0)
     {
+        FNET_STATS_INC(ip.out_discards);
         error_code = FNET_ERR_NOMEM;   
         goto DROP;
     }
@@ -276,134 +414,202 @@ int fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fnet_ip4_add
     
     nb = fnet_netbuf_concat(nb_header, nb);
 
-    if(total_length > netif->mtu) /* IP Fragmentation. */ 
-    {
-#if FNET_CFG_IP4_FRAGMENTATION
+    /* The link-layer address cached by the socket belongs to the routed 
+     * next hop, so it is neither used nor updated by a do-not-route send.*/
+    if(do_not_route)
+        dst = FNET_NULL;
 
-        int first_frag_length, frag_length; /* The number of data in each fragment. */
-        int offset;
-        int error = 0;
-        fnet_netbuf_t *tmp_nb;
-        fnet_netbuf_t *nb_prev;
-        fnet_netbuf_t ** nb_next_ptr = &nb->next_chain;
-        int new_header_length, header_length = FNET_IP_HEADER_GET_HEADER_LENGTH(ipheader) << 2;
-        fnet_ip_header_t *new_ipheader;
+    if(total_length > mtu) /* IP Fragmentation. */ 
+    {
+        return fnet_ip_fragment(netif, dest_ip, next_hop, nb, mtu, dst);
+    }
+    else
+    {
+        fnet_ip_netif_output(netif, dest_ip, next_hop, nb, dst);
+    }
 
-        frag_length = (int)(netif->mtu - header_length) & ~7; /* rounded down to an 8-byte boundary.*/
-        first_frag_length = frag_length;
+    return (FNET_OK);
 
-        if((ipheader->flags_fragment_offset & FNET_HTONS(FNET_IP_DF)) ||   /* The fragmentation is prohibited. */
-        (frag_length < 8))                                    /* The MTU is too small.*/
-        {
-            error_code = FNET_ERR_MSGSIZE;   
-            goto DROP; 
-        }
+DROP:
+    fnet_netbuf_free_chain(nb);           /* Discard datagram */ 
+           
+    return (error_code);
+    
+}
 
-        /* The header (and options) must reside in contiguous area of memory.*/
-        if((tmp_nb = fnet_netbuf_pullup(nb, header_length)) == 0)
-        {
-            error_code = FNET_ERR_NOMEM;   
-            goto DROP;
-        }
+/************************************************************************
+* NAME: fnet_ip_fragment
+*
+* DESCRIPTION: This function fragments the datagram to the MTU, 
+*              and sends the fragments. It is used for the local and 
+*              the forwarded datagrams, so the datagram may be a fragment 
+*              already. The IP options are not copied to the next fragments.
+*              The datagram is always consumed.
+*
+* RETURNS: FNET_OK=OK
+*          FNET_ERR_MSGSIZE=Size error
+*          FNET_ERR_NOMEM=No memory
+*************************************************************************/
+static int fnet_ip_fragment( fnet_netif_t *netif, fnet_ip4_addr_t dest_ip, fnet_ip4_addr_t next_hop, 
+                             fnet_netbuf_t *nb, unsigned long mtu, fnet_netif_dst_t *dst )
+{
+#if FNET_CFG_IP4_FRAGMENTATION
 
-        nb = tmp_nb;
+    int first_frag_length, frag_length; /* The number of data in each fragment. */
+    int offset;
+    int error = 0;
+    int error_code;
+    fnet_netbuf_t *tmp_nb;
+    fnet_netbuf_t *nb_prev;
+    fnet_netbuf_t ** nb_next_ptr;
+    int header_length;
+    unsigned long total_length;
+    unsigned short frag_offset;     /* Offset of the datagram, if it is a fragment already.*/
+    unsigned short frag_mf;         /* MF flag of the datagram, if it is a fragment already.*/
+    fnet_ip_header_t *ipheader;
+    fnet_ip_header_t *new_ipheader;
+
+    /* The header (and options) must reside in contiguous area of memory.*/
+    if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_ip_header_t))) == 0)
+    {
+        FNET_STATS_INC(ip.frag_fails);
+        error_code = FNET_ERR_NOMEM;   
+        goto DROP;
+    }
+    nb = tmp_nb;
+    ipheader = nb->data_ptr;
+    header_length = FNET_IP_HEADER_GET_HEADER_LENGTH(ipheader) << 2;
 
-        ipheader = nb->data_ptr;
+    frag_length = (int)(mtu - header_length) & ~7; /* rounded down to an 8-byte boundary.*/
+    first_frag_length = frag_length;
 
-        nb_prev = nb;
-        
-        total_length = fnet_ntohs(ipheader->total_length);
+    if((ipheader->flags_fragment_offset & FNET_HTONS(FNET_IP_DF)) ||   /* The fragmentation is prohibited. */
+    (frag_length < 8))                                    /* The MTU is too small.*/
+    {
+        FNET_STATS_INC(ip.frag_fails);
+        error_code = FNET_ERR_MSGSIZE;   
+        goto DROP; 
+    }
 
-        /* Go through the whole data segment after first fragment.*/
-        for (offset = (header_length + frag_length); offset < total_length; offset += frag_length)
-        {
-            fnet_netbuf_t *nb_tmp;
+    if((tmp_nb = fnet_netbuf_pullup(nb, header_length)) == 0)
+    {
+        FNET_STATS_INC(ip.frag_fails);
+        error_code = FNET_ERR_NOMEM;   
+        goto DROP;
+    }
 
-            nb = fnet_netbuf_new(header_length, FNET_FALSE); /* Allocate a new header.*/
+    nb = tmp_nb;
+    nb_next_ptr = &nb->next_chain;
 
-            if(nb == 0)
-            {
-                error++;
-                goto FRAG_END;
-            }
+    ipheader = nb->data_ptr;
 
-            fnet_memcpy(nb->data_ptr, ipheader, (unsigned int)header_length); /* Copy IP header.*/
-            new_ipheader = nb->data_ptr;
-            new_header_length = sizeof(fnet_ip_header_t);
+    nb_prev = nb;
+    
+    total_length = fnet_ntohs(ipheader->total_length);
+    frag_offset = fnet_ntohs(ipheader->flags_fragment_offset) & FNET_IP_OFFSET_MASK;
+    frag_mf = ipheader->flags_fragment_offset & FNET_HTONS(FNET_IP_MF);
 
-            FNET_IP_HEADER_SET_HEADER_LENGTH(new_ipheader, new_header_length >> 2); 
-            new_ipheader->flags_fragment_offset = fnet_htons((unsigned short)((offset - header_length) >> 3));
+    /* Go through the whole data segment after first fragment.*/
+    for (offset = (header_length + frag_length); offset < total_length; offset += frag_length)
+    {
+        fnet_netbuf_t *nb_tmp;
 
-            if(offset + frag_length >= total_length)  
-                frag_length = (int)(total_length - offset); 
-            else
-                new_ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
+        nb = fnet_netbuf_new(sizeof(fnet_ip_header_t), FNET_FALSE); /* Allocate a new header, without options.*/
 
-            /* Copy the data from the original packet into the fragment.*/
-            if((nb_tmp = fnet_netbuf_copy(nb_prev, offset, frag_length, 0)) == 0)
-            {
-                error++;
-                fnet_netbuf_free_chain(nb);
-                goto FRAG_END;
-            }
+        if(nb == 0)
+        {
+            error++;
+            goto FRAG_END;
+        }
 
-            nb = fnet_netbuf_concat(nb, nb_tmp);
+        fnet_memcpy(nb->data_ptr, ipheader, sizeof(fnet_ip_header_t)); /* Copy IP header.*/
+        new_ipheader = nb->data_ptr;
 
-            new_ipheader->total_length = fnet_htons((unsigned short)nb->total_length); 
+        FNET_IP_HEADER_SET_HEADER_LENGTH(new_ipheader, sizeof(fnet_ip_header_t) >> 2); 
+        new_ipheader->flags_fragment_offset = fnet_htons((unsigned short)(frag_offset + ((offset - header_length) >> 3)));
 
-            *nb_next_ptr = nb;
-            nb_next_ptr = &nb->next_chain;
+        if(offset + frag_length >= total_length)  
+        {
+            frag_length = (int)(total_length - offset); 
+            new_ipheader->flags_fragment_offset |= frag_mf; /* The last one keeps MF of the datagram.*/
         }
+        else
+            new_ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
 
-        /* Update the first fragment.*/
-        nb = nb_prev;
-        fnet_netbuf_trim(&nb, header_length + first_frag_length - fnet_ntohs(ipheader->total_length));
-        ipheader->total_length = fnet_htons((unsigned short)nb->total_length);
-        ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
-
-FRAG_END:
-        for (nb = nb_prev; nb; nb = nb_prev)    /* Send each fragment.*/
+        /* Copy the data from the original packet into the fragment.*/
+        if((nb_tmp = fnet_netbuf_copy(nb_prev, offset, frag_length, 0)) == 0)
         {
-            nb_prev = nb->next_chain;
-            nb->next_chain = 0;
-
-            if(error == 0)
-            {
-                fnet_ip_trace("TX", nb->data_ptr); /* Print IP header. */
-                fnet_ip_netif_output(netif, dest_ip, nb, do_not_route);
-            }
-            else
-                fnet_netbuf_free_chain(nb);
+            error++;
+            fnet_netbuf_free_chain(nb);
+            goto FRAG_END;
         }
 
-#else
+        nb = fnet_netbuf_concat(nb, nb_tmp);
 
-        error_code = FNET_ERR_MSGSIZE;   /* Discard datagram.*/
-        goto DROP; 
-
-#endif  /* FNET_CFG_IP4_FRAGMENTATION */
+        new_ipheader->total_length = fnet_htons((unsigned short)nb->total_length); 
 
+        *nb_next_ptr = nb;
+        nb_next_ptr = &nb->next_chain;
     }
+
+    /* Update the first fragment.*/
+    nb = nb_prev;
+    fnet_netbuf_trim(&nb, header_length + first_frag_length - fnet_ntohs(ipheader->total_length));
+    ipheader->total_length = fnet_htons((unsigned short)nb->total_length);
+    ipheader->flags_fragment_offset |= FNET_HTONS(FNET_IP_MF);
+
+FRAG_END:
+    if(error == 0)
+        FNET_STATS_INC(ip.frag_oks);
     else
+        FNET_STATS_INC(ip.frag_fails);
+
+    for (nb = nb_prev; nb; nb = nb_prev)    /* Send each fragment.*/
     {
-        fnet_ip_netif_output(netif, dest_ip, nb, do_not_route);
+        nb_prev = nb->next_chain;
+        nb->next_chain = 0;
+
+        if(error == 0)
+        {
+            FNET_STATS_INC(ip.frag_creates);
+            fnet_ip_trace("TX", nb->data_ptr); /* Print IP header. */
+            fnet_ip_netif_output(netif, dest_ip, next_hop, nb, dst);
+        }
+        else
+            fnet_netbuf_free_chain(nb);
     }
 
     return (FNET_OK);
 
+#else
+
+    int error_code;
+
+    FNET_COMP_UNUSED_ARG(netif);
+    FNET_COMP_UNUSED_ARG(dest_ip);
+    FNET_COMP_UNUSED_ARG(next_hop);
+    FNET_COMP_UNUSED_ARG(mtu);
+    FNET_COMP_UNUSED_ARG(dst);
+
+    FNET_STATS_INC(ip.frag_fails);
+    error_code = FNET_ERR_MSGSIZE;   /* Discard datagram.*/
+    goto DROP; 
+
+#endif  /* FNET_CFG_IP4_FRAGMENTATION */
+
 DROP:
     fnet_netbuf_free_chain(nb);           /* Discard datagram */ 
            
     return (error_code);
-    
 }
 
 /************************************************************************
 * NAME: fnet_ip_netif_output
 *
-* DESCRIPTION:
+* DESCRIPTION: Sends the datagram to the interface. The next-hop address
+*              is resolved by the caller.
 *************************************************************************/
-static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_netbuf_t* nb, int do_not_route)
+static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_ip_addr, fnet_ip4_addr_t next_hop, fnet_netbuf_t* nb, fnet_netif_dst_t *dst)
 {
     fnet_ip_header_t        *ipheader = (fnet_ip_header_t *)nb->data_ptr;
     
@@ -417,6 +623,9 @@ static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_
 #endif    
         ipheader->checksum = fnet_checksum(nb, FNET_IP_HEADER_GET_HEADER_LENGTH(ipheader) << 2); /* IP checksum*/
 
+    FNET_IP_TRACE(FNET_TRACE_EVENT_TX, ipheader);
+    FNET_LATENCY_TX(FNET_LATENCY_TX_IP, nb);
+
      
     if( /* Datagrams sent to a broadcast address */
         (fnet_ip_addr_is_broadcast (dest_ip_addr, netif)
@@ -438,11 +647,32 @@ static void fnet_ip_netif_output(struct fnet_netif *netif, fnet_ip4_addr_t dest_
     }
     else
     {
-        if(!((do_not_route) || ((dest_ip_addr & netif->ip4_addr.subnetmask) == (netif->ip4_addr.address & netif->ip4_addr.subnetmask))))
+#if (FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1)
+        /* Use the next-hop address, cached by the socket.*/
+        if(dst && (dst->netif == netif) && FNET_NETIF_DST_IS_VALID(dst) 
+            && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
         {
-            /* Use the default router as the address to send.*/
-            dest_ip_addr = netif->ip4_addr.gateway;
+            if(dst->ll_addr_valid == FNET_FALSE)
+            {
+                fnet_mac_addr_t *ll_addr = fnet_arp_lookup(netif, next_hop);
+                
+                if(ll_addr)
+                {
+                    fnet_memcpy(dst->ll_addr, *ll_addr, sizeof(fnet_mac_addr_t));
+                    dst->ll_addr_valid = FNET_TRUE;
+                }
+            }
+            
+            if(dst->ll_addr_valid)
+            {
+                fnet_eth_output_low(netif, FNET_ETH_TYPE_IP4, dst->ll_addr, nb);
+                return;
+            }
         }
+#endif /* FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1 */
+
+        /* Use the next-hop address to send.*/
+        dest_ip_addr = next_hop;
     }
    
     /* Send to Interface.*/
@@ -458,9 +688,12 @@ void fnet_ip_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
 {
     if(netif && nb)
     {
+        FNET_STATS_INC(ip.in_receives);
+        FNET_LATENCY_RX(FNET_LATENCY_RX_IP, nb);
 
         if(fnet_ip_queue_append(&ip_queue, netif, nb) != FNET_OK)
         {
+            FNET_STATS_INC(ip.in_discards);
             fnet_netbuf_free_chain(nb);
             return;
         }
@@ -470,6 +703,138 @@ void fnet_ip_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
     }
 }
 
+/************************************************************************
+* NAME: fnet_ip_forward
+*
+* DESCRIPTION: This function forwards the datagram, that is not addressed
+*              to this host, to the next hop selected by the routing table.
+*              The received netbuf is reused, only the TTL and 
+*              the header checksum are updated.
+*
+* RETURNS: FNET_FALSE if the datagram must be processed by this host.
+*          FNET_TRUE if the datagram is forwarded or discarded.
+*************************************************************************/
+#if FNET_CFG_IP4_FORWARDING
+static int fnet_ip_forward( fnet_netif_t *netif, fnet_netbuf_t *nb )
+{
+    fnet_ip_header_t    *hdr = nb->data_ptr;
+    fnet_ip4_addr_t     destination_addr = hdr->desination_addr;
+    fnet_ip4_addr_t     source_addr = hdr->source_addr;
+    fnet_netif_t        *out_netif;
+    fnet_ip4_addr_t     next_hop;
+    unsigned long       mtu;
+    unsigned long       total_length = fnet_ntohs(hdr->total_length);
+    unsigned long       header_length = (unsigned long)FNET_IP_HEADER_GET_HEADER_LENGTH(hdr) << 2;
+    unsigned long       checksum;
+    unsigned short      ttl_word;
+
+    /* Datagrams for this host and invalid datagrams are processed 
+     * (or discarded) by the input routine.*/
+    if((destination_addr == netif->ip4_addr.address)
+        || fnet_ip_addr_is_broadcast(destination_addr, netif)
+        || FNET_IP4_ADDR_IS_MULTICAST(destination_addr)
+        || fnet_ip_addr_is_own(destination_addr)
+        || (nb->total_length < total_length)
+        || (FNET_IP_HEADER_GET_VERSION(hdr) != 4)
+        || (header_length < sizeof(fnet_ip_header_t))
+    #if FNET_CFG_CPU_ETH_HW_RX_IP_CHECKSUM
+        || (((netif->features & FNET_NETIF_FEATURE_HW_RX_IP_CHECKSUM) == 0)
+            && (fnet_checksum(nb, (int)header_length) != 0))
+    #else
+        || (fnet_checksum(nb, (int)header_length) != 0)
+    #endif
+      )
+    {
+        return FNET_FALSE;
+    }
+
+    /* RFC1812 5.3.7: Do not forward datagrams received as a link-layer 
+     * broadcast/multicast, datagrams with a source address that does 
+     * not define a single host, nor loopback and Class E datagrams.*/
+    if((nb->flags & (FNET_NETBUF_FLAG_BROADCAST | FNET_NETBUF_FLAG_MULTICAST))
+        || (source_addr == INADDR_ANY)
+        || (source_addr == INADDR_BROADCAST)
+        || FNET_IP4_ADDR_IS_MULTICAST(source_addr)
+        || FNET_IP4_CLASS_E(source_addr)
+        || FNET_IP4_CLASS_E(destination_addr)
+        || (FNET_IP4_ADDR1(source_addr) == 127)
+        || (FNET_IP4_ADDR1(destination_addr) == 127))
+    {
+        FNET_STATS_INC(ip.in_addr_errors);
+        goto DROP;
+    }
+
+    if(nb->total_length > total_length) 
+    {
+        /* Logical size and the physical size of the packet should be the same.*/
+        fnet_netbuf_trim(&nb, (int)(total_length - nb->total_length)); 
+    }
+
+    /* RFC1812 5.3.1: The TTL is decremented, if it reaches zero 
+     * the datagram is discarded and ICMP Time Exceeded is sent.*/
+    if(hdr->ttl <= 1)
+    {
+        FNET_STATS_INC(ip.in_hdr_errors);
+        fnet_icmp_error(netif, FNET_ICMP_TIMXCEED, FNET_ICMP_TIMXCEED_INTRANS, 0, nb);
+        return FNET_TRUE;
+    }
+
+    out_netif = fnet_netif_ip4_route_lookup(destination_addr, &next_hop, &mtu);
+    
+    if((out_netif == FNET_NULL)
+    #if FNET_CFG_LOOPBACK
+        || (out_netif == FNET_LOOP_IF)
+    #endif
+      )
+    {
+        FNET_STATS_INC(ip.out_no_routes);
+        fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_NET, 0, nb);
+        return FNET_TRUE;
+    }
+
+    /* RFC1812 5.2.6: A datagram, bigger than the next-hop MTU, 
+     * is fragmented. If its DF flag is set, the next-hop MTU
+     * is reported to the source.*/
+    if((total_length > mtu) && (hdr->flags_fragment_offset & FNET_HTONS(FNET_IP_DF)))
+    {
+        FNET_STATS_INC(ip.frag_fails);
+        fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_NEEDFRAG, mtu, nb);
+        return FNET_TRUE;
+    }
+
+    /* RFC1624: Incremental update of the header checksum, 
+     * HC' = ~(~HC + ~m + m'), where m is the TTL/Protocol word.*/
+    ttl_word = (unsigned short)((hdr->ttl << 8) | hdr->protocol);
+    hdr->ttl--;
+    checksum = (unsigned long)(unsigned short)~fnet_ntohs(hdr->checksum) 
+               + (unsigned long)(unsigned short)~ttl_word 
+               + (unsigned long)(unsigned short)(ttl_word - 0x0100);
+    checksum = (checksum & 0xffff) + (checksum >> 16);
+    checksum += (checksum >> 16);
+    hdr->checksum = fnet_htons((unsigned short)~checksum);
+
+    /* The link-layer flags of the received frame are not valid for the output.*/
+    nb->flags = FNET_NETBUF_FLAG_NONE;
+
+    fnet_ip_trace("FW", hdr); /* Print IP header. */
+    FNET_IP_TRACE(FNET_TRACE_EVENT_FW, hdr);
+
+    /* Send to the next hop. The link-layer address is resolved by ARP.*/
+    FNET_STATS_INC(ip.forw_datagrams);
+
+    if(total_length > mtu)
+        fnet_ip_fragment(out_netif, destination_addr, next_hop, nb, mtu, FNET_NULL);
+    else
+        out_netif->api->output_ip4(out_netif, next_hop, nb);
+
+    return FNET_TRUE;
+
+DROP:
+    fnet_netbuf_free_chain(nb);
+    return FNET_TRUE;
+}
+#endif /* FNET_CFG_IP4_FORWARDING */
+
 /************************************************************************
 * NAME: fnet_ip_input_low
 *
@@ -495,16 +860,23 @@ void fnet_ip_input_low( void *cookie )
     while((nb = fnet_ip_queue_read(&ip_queue, &netif)) != 0)
     {
         nb->next_chain = 0;
+        FNET_LATENCY_RX(FNET_LATENCY_RX_IP_LOW, nb);
 
         /* The header must reside in contiguous area of memory. */
         if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_ip_header_t)))  == 0 )
         {
+            FNET_STATS_INC(ip.in_discards);
             fnet_netbuf_free_chain(nb);
             continue;
         }
 
         nb = tmp_nb;
 
+    #if FNET_CFG_IP4_FORWARDING
+        if(fnet_ip_forward(netif, nb) == FNET_TRUE)
+            continue; /* Forwarded or discarded.*/
+    #endif
+
         hdr = nb->data_ptr;
         destination_addr = hdr->desination_addr;
         source_addr = hdr->source_addr;
@@ -512,6 +884,7 @@ void fnet_ip_input_low( void *cookie )
         header_length = (unsigned long)FNET_IP_HEADER_GET_HEADER_LENGTH(hdr) << 2;
         
         fnet_ip_trace("RX", hdr); /* Print IP header. */
+        FNET_IP_TRACE(FNET_TRACE_EVENT_RX, hdr);
         
         if((nb->total_length >= total_length)                           /* Check the amount of data*/
             && (nb->total_length >= sizeof(fnet_ip_header_t)) 
@@ -524,12 +897,7 @@ void fnet_ip_input_low( void *cookie )
     #else
             && (fnet_checksum(nb, (int)header_length) == 0)             /* Checksum*/
     #endif
-            && ((destination_addr == netif->ip4_addr.address)           /* It is final destination*/                            
-                || fnet_ip_addr_is_broadcast(destination_addr, netif) 
-    #if FNET_CFG_MULTICAST                
-                || (FNET_IP4_ADDR_IS_MULTICAST(destination_addr))
-    #endif                
-                ) 
+            && fnet_ip_addr_is_local(netif, destination_addr)           /* It is final destination*/                            
         )
         {   
             if(nb->total_length > total_length) 
@@ -548,6 +916,7 @@ void fnet_ip_input_low( void *cookie )
                 hdr = nb->data_ptr;
                 header_length = (unsigned long)FNET_IP_HEADER_GET_HEADER_LENGTH(hdr) << 2;
     #else
+                FNET_STATS_INC(ip.reasm_fails);
                 fnet_netbuf_free_chain(nb);
                 continue;
     #endif
@@ -566,6 +935,7 @@ void fnet_ip_input_low( void *cookie )
     #endif
             if(nb->total_length > FNET_IP_MAX_PACKET)
             {
+                FNET_STATS_INC(ip.in_discards);
                 fnet_netbuf_free_chain(nb); /* Discard datagram */
                 continue;
             }
@@ -585,18 +955,28 @@ void fnet_ip_input_low( void *cookie )
             /* Find transport protocol.*/
             if((protocol = fnet_prot_find(AF_INET, SOCK_UNSPEC, hdr->protocol)) != FNET_NULL)
             {
+                FNET_STATS_INC(ip.in_delivers);
                 protocol->prot_input_ip4(netif, source_addr, destination_addr, nb, ip4_nb);
                 /* After that nb may point to wrong place. Do not use it.*/
             }
             else 
             /* No protocol found.*/                                  
             {
+                FNET_STATS_INC(ip.in_unknown_protos);
                 fnet_netbuf_free_chain(nb);
-                fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_PROTOCOL, ip4_nb);
+                fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_PROTOCOL, 0, ip4_nb);
             }
         }
         else
         {
+        #if FNET_CFG_STATS
+            /* The address check is repeated only for the discarded datagrams.*/
+            if(fnet_ip_addr_is_local(netif, destination_addr))
+                FNET_STATS_INC(ip.in_hdr_errors);
+            else
+                FNET_STATS_INC(ip.in_addr_errors);
+        #endif
+            FNET_IP_TRACE(FNET_TRACE_EVENT_DROP, hdr);
             fnet_netbuf_free_chain(nb);
         }
     } /* while end */
@@ -604,39 +984,102 @@ void fnet_ip_input_low( void *cookie )
     fnet_isr_unlock();
 }
 
+/************************************************************************
+* NAME: fnet_ip_addr_is_local
+*
+* DESCRIPTION: Checks if the received datagram is addressed to this host.
+*************************************************************************/
+static int fnet_ip_addr_is_local( fnet_netif_t *netif, fnet_ip4_addr_t addr )
+{
+    return ((addr == netif->ip4_addr.address)
+            || fnet_ip_addr_is_broadcast(addr, netif) 
+    #if FNET_CFG_IP4_FORWARDING
+            || fnet_ip_addr_is_own(addr) /* Address of other interface.*/
+    #endif
+    #if FNET_CFG_MULTICAST                
+            || (FNET_IP4_ADDR_IS_MULTICAST(addr))
+    #endif                
+           );
+}
+
+#if FNET_CFG_IP4_FORWARDING
+/************************************************************************
+* NAME: fnet_ip_addr_is_own
+*
+* DESCRIPTION: Checks if the address belongs to one of the interfaces.
+*              It is called by the input routine for every datagram,
+*              with the interrupts locked, so the interface list 
+*              is walked without the OS mutex.
+*************************************************************************/
+static int fnet_ip_addr_is_own( fnet_ip4_addr_t addr )
+{
+    fnet_netif_t *netif;
+
+    for (netif = fnet_netif_list; netif != 0; netif = netif->next)
+    {
+        if(addr == netif->ip4_addr.address)
+            return FNET_TRUE;
+    }
+
+    return FNET_FALSE;
+}
+#endif /* FNET_CFG_IP4_FORWARDING */
 
 /************************************************************************
 * NAME: fnet_ip_reassembly
 *
 * DESCRIPTION: This function attempts to assemble a complete datagram.
+*              Only the IP header of a fragment is made contiguous, 
+*              the fragment data is kept in its net_buf chain.
 *************************************************************************/
 #if FNET_CFG_IP4_FRAGMENTATION
 
 fnet_netbuf_t *fnet_ip_reassembly( fnet_netbuf_t ** nb_ptr )
 {
     fnet_ip_frag_list_t     *frag_list_ptr;
-    fnet_ip_frag_header_t   *frag_ptr, *cur_frag_ptr;
+    fnet_ip_frag_header_t   *frag_ptr;
+    fnet_ip_frag_header_t   *prev_frag_ptr;
+    fnet_ip_frag_header_t   *cur_frag_ptr;
     fnet_netbuf_t           *nb = *nb_ptr;
     fnet_netbuf_t           *tmp_nb;
     fnet_ip_header_t        *iphdr;
-    int                     i;
-    int                     offset;
     unsigned long           hdr_length;
+    unsigned long           offset;
+    unsigned long           length;
+    unsigned long           end;
+    unsigned long           i;
+    unsigned long           hash;
+    int                     mf;
     
-    /* For this algorithm the all datagram must reside in contiguous area of memory.*/
-    if((tmp_nb = fnet_netbuf_pullup(nb, (int)nb->total_length)) == 0) 
+    fnet_ip_frag_stats.reqds++;
+
+    iphdr = nb->data_ptr;
+    hdr_length = (unsigned long)FNET_IP_HEADER_GET_HEADER_LENGTH(iphdr) << 2;
+
+    /* Only the IP header must reside in contiguous area of memory.*/
+    if((tmp_nb = fnet_netbuf_pullup(nb, (int)hdr_length)) == 0) 
     {
         goto DROP_FRAG;
     }
 
-
     *nb_ptr = tmp_nb;
     nb = tmp_nb;
     
     iphdr = nb->data_ptr;
 
-    /* Liner search of the list to locate the appropriate datagram for the current fragment.*/
-    for (frag_list_ptr = ip_frag_list_head; frag_list_ptr != 0; frag_list_ptr = frag_list_ptr->next)
+    offset = (unsigned long)fnet_ntohs(FNET_IP_HEADER_GET_OFFSET(iphdr)) << 3; /* Convert offset to bytes.*/
+    length = nb->total_length - hdr_length;
+    end = offset + length;
+    mf = (iphdr->flags_fragment_offset & FNET_HTONS(FNET_IP_MF)) ? FNET_TRUE : FNET_FALSE;
+
+    /* Fragments (except the last) must be multiples of 8 bytes.*/
+    if((length == 0) || (mf && (length & 0x07)) || ((end + hdr_length) > FNET_IP_MAX_PACKET))
+        goto DROP_FRAG;
+
+    /* Hash search of the datagram for the current fragment.*/
+    hash = fnet_ip_frag_hash(iphdr->source_addr, iphdr->desination_addr, iphdr->id, iphdr->protocol);
+    
+    for (frag_list_ptr = ip_frag_hash_table[hash]; frag_list_ptr != 0; frag_list_ptr = frag_list_ptr->hash_next)
     {
         if((frag_list_ptr->id == iphdr->id) && (frag_list_ptr->protocol == iphdr->protocol)
                && (frag_list_ptr->source_addr == iphdr->source_addr)
@@ -644,108 +1087,134 @@ fnet_netbuf_t *fnet_ip_reassembly( fnet_netbuf_t ** nb_ptr )
             break;
     }
 
-    
-    cur_frag_ptr = (fnet_ip_frag_header_t *)iphdr;
-
-    /* Exclude the standard IP header and options.*/
-    hdr_length = (unsigned long)FNET_IP_HEADER_GET_HEADER_LENGTH(iphdr) << 2;
-    fnet_netbuf_trim(&nb, (int)hdr_length);
-    cur_frag_ptr->total_length = (unsigned short)(fnet_ntohs(cur_frag_ptr->total_length) - hdr_length); /* Host endian.*/
-
-
     if(frag_list_ptr == 0)                                                  /* The first fragment of the new datagram.*/
     {
         if((frag_list_ptr = fnet_malloc(sizeof(fnet_ip_frag_list_t))) == 0) /* Create list.*/
             goto DROP_FRAG;
 
-        fnet_ip_frag_list_add(&ip_frag_list_head, frag_list_ptr);
-
-        frag_list_ptr->ttl = FNET_IP_FRAG_TTL;
+        frag_list_ptr->timestamp = fnet_timer_ticks();
+        frag_list_ptr->length = 0;
+        frag_list_ptr->received = 0;
+        frag_list_ptr->memory = 0;
+        frag_list_ptr->ttl = 0;
         frag_list_ptr->id = iphdr->id;
         frag_list_ptr->protocol = iphdr->protocol;
         frag_list_ptr->source_addr = iphdr->source_addr;
         frag_list_ptr->desination_addr = iphdr->desination_addr;
         frag_list_ptr->frag_ptr = 0;
-        frag_ptr = 0;
+        frag_list_ptr->frag_last_ptr = 0;
 
-        if(iphdr->flags_fragment_offset & FNET_HTONS(FNET_IP_MF)) 
-            cur_frag_ptr->mf |= 1;
+        fnet_ip_frag_list_add(frag_list_ptr, hash);
+    }
+    else
+    {
+        /* Data beyond the end of the datagram.*/
+        if(frag_list_ptr->length && (end > frag_list_ptr->length))
+            goto DROP_FRAG;
+        
+        /* The last fragment may not end before the received data.*/
+        if((mf == FNET_FALSE) && (frag_list_ptr->frag_last_ptr) 
+            && ((frag_list_ptr->frag_last_ptr->offset + frag_list_ptr->frag_last_ptr->total_length) > end))
+            goto DROP_FRAG;
+    }
 
-        cur_frag_ptr->offset = (unsigned short)(fnet_ntohs(cur_frag_ptr->offset) << 3); /* Convert offset to bytes (Host endian).*/ 
+    if(mf == FNET_FALSE)
+    {
+        if(frag_list_ptr->length && (frag_list_ptr->length != end))
+            goto DROP_FRAG;
         
-       
-        cur_frag_ptr->nb = nb;
+        frag_list_ptr->length = end;
     }
-    else
+    
+    if(offset == 0)
+        frag_list_ptr->ttl = iphdr->ttl;
+
+    /* Find position in the fragment list. The in-order fragment is appended at once.*/
+    prev_frag_ptr = frag_list_ptr->frag_last_ptr;
+
+    if(prev_frag_ptr && (prev_frag_ptr->offset > offset))
     {
-        if(iphdr->flags_fragment_offset & FNET_HTONS(FNET_IP_MF))
-            cur_frag_ptr->mf |= 1;
+        prev_frag_ptr = 0;
+        
+        for(frag_ptr = frag_list_ptr->frag_ptr; (frag_ptr != 0) && (frag_ptr->offset <= offset); frag_ptr = frag_ptr->next)
+            prev_frag_ptr = frag_ptr;
+    }
 
-        cur_frag_ptr->offset = (unsigned short)(fnet_ntohs(cur_frag_ptr->offset) << 3); /* Convert offset to bytes.*/
+    frag_ptr = prev_frag_ptr ? prev_frag_ptr->next : frag_list_ptr->frag_ptr;
 
-        cur_frag_ptr->nb = nb;
+    /* Trims or discards the beginning of the incoming fragment.*/
+    if(prev_frag_ptr && ((prev_frag_ptr->offset + prev_frag_ptr->total_length) > offset))
+    {
+        i = prev_frag_ptr->offset + prev_frag_ptr->total_length - offset;
 
-        /* Find position in reassembly list.*/
-        frag_ptr = frag_list_ptr->frag_ptr;
-        do
-        {
-            if(frag_ptr->offset > cur_frag_ptr->offset)
-                break;
+        if(i >= length) /* Duplicate.*/
+            goto DROP_FRAG;
 
-            frag_ptr = frag_ptr->next;
-        } 
-        while (frag_ptr != frag_list_ptr->frag_ptr);
+        if(fnet_netbuf_cut_center(nb_ptr, (int)hdr_length, (int)i) == 0)
+            goto DROP_FRAG;
         
-        /* Trims or discards icoming fragments.*/
-        if(frag_ptr != frag_list_ptr->frag_ptr)
-        {
-            if((i = frag_ptr->prev->offset + frag_ptr->prev->total_length - cur_frag_ptr->prev->offset) != 0)
-            {
-                if(i > cur_frag_ptr->total_length)
-                    goto DROP_FRAG;
+        offset += i;
+        length -= i;
+    }
 
-                fnet_netbuf_trim(&nb, i);
-                cur_frag_ptr->total_length -= i;
-                cur_frag_ptr->offset += i;
-            }
-        }
-        
-        /* Trims or discards existing fragments.*/
-        while((frag_ptr != frag_list_ptr->frag_ptr)
-                  && ((cur_frag_ptr->offset + cur_frag_ptr->total_length) > frag_ptr->offset))
+    /* Trims the end of the incoming fragment or discards existing fragments.*/
+    while((frag_ptr != 0) && (end > frag_ptr->offset))
+    {
+        if((frag_ptr->offset + frag_ptr->total_length) > end)
         {
-            i = (cur_frag_ptr->offset + cur_frag_ptr->total_length) - frag_ptr->offset;
-
-            if(i < frag_ptr->total_length)
-            {
-                frag_ptr->total_length -= i;
-                frag_ptr->offset += i;
-                fnet_netbuf_trim((fnet_netbuf_t **)&frag_ptr->nb, i);
-                break;
-            }
-
-            frag_ptr = frag_ptr->next;
-            fnet_netbuf_free_chain(frag_ptr->prev->nb);
-            fnet_ip_frag_del((fnet_ip_frag_header_t **)&frag_list_ptr->frag_ptr, frag_ptr->prev);
+            i = end - frag_ptr->offset;
+            fnet_netbuf_trim(nb_ptr, -(int)i);
+            length -= i;
+            end -= i;
+            break;
         }
+
+        /* The existing fragment is covered by the incoming one.*/
+        cur_frag_ptr = frag_ptr;
+        frag_ptr = frag_ptr->next;
+        
+        frag_list_ptr->received -= cur_frag_ptr->total_length;
+        frag_list_ptr->memory -= cur_frag_ptr->nb->total_length;
+        ip_frag_memory -= cur_frag_ptr->nb->total_length;
+        fnet_netbuf_free_chain(cur_frag_ptr->nb);
     }
 
     /* Insert fragment to the list.*/
-    fnet_ip_frag_add((fnet_ip_frag_header_t **)(&frag_list_ptr->frag_ptr), cur_frag_ptr, frag_ptr->prev);
-
-    offset = 0;
-    frag_ptr = frag_list_ptr->frag_ptr;
+    nb = *nb_ptr;
+    cur_frag_ptr = (fnet_ip_frag_header_t *)nb->data_ptr;
+    cur_frag_ptr->total_length = (unsigned short)length;
+    cur_frag_ptr->offset = (unsigned short)offset;
+    cur_frag_ptr->nb = nb;
+    cur_frag_ptr->next = frag_ptr;
+
+    if(prev_frag_ptr)
+        prev_frag_ptr->next = cur_frag_ptr;
+    else
+        frag_list_ptr->frag_ptr = cur_frag_ptr;
 
-    do
+    if(frag_ptr == 0)
+        frag_list_ptr->frag_last_ptr = cur_frag_ptr;
+    
+    frag_list_ptr->received += length;
+    frag_list_ptr->memory += nb->total_length;
+    ip_frag_memory += nb->total_length;
+    
+    /* Keep the reassembly memory limit, by discarding the oldest datagrams.*/
+    while(ip_frag_memory > FNET_CFG_IP4_FRAG_MEMORY)
     {
-        if(frag_ptr->offset != offset)
+        fnet_ip_frag_stats.evictions++;
+        
+        if(ip_frag_list_head == frag_list_ptr)
+        {
+            fnet_ip_frag_list_free(frag_list_ptr);
             goto NEXT_FRAG;
+        }
+        
+        fnet_ip_frag_list_free(ip_frag_list_head);
+    }
 
-        offset += frag_ptr->total_length;
-        frag_ptr = frag_ptr->next;
-    } while (frag_ptr != frag_list_ptr->frag_ptr);
-
-    if(frag_ptr->prev->mf & 1)
+    /* Wait for the remaining holes to be filled.*/
+    if((frag_list_ptr->length == 0) || (frag_list_ptr->received != frag_list_ptr->length))
         goto NEXT_FRAG;
 
     /* Reconstruct datagram.*/
@@ -753,38 +1222,61 @@ fnet_netbuf_t *fnet_ip_reassembly( fnet_netbuf_t ** nb_ptr )
     nb = frag_ptr->nb;
     frag_ptr = frag_ptr->next;
 
-    while(frag_ptr != frag_list_ptr->frag_ptr)
+    while(frag_ptr != 0)
     {
-        nb = fnet_netbuf_concat(nb, frag_ptr->nb);
-
+        cur_frag_ptr = frag_ptr;
         frag_ptr = frag_ptr->next;
+        
+        /* Exclude the IP header and options of the subsequent fragments.*/
+        tmp_nb = cur_frag_ptr->nb;
+        fnet_netbuf_trim(&tmp_nb, FNET_IP_HEADER_GET_HEADER_LENGTH(cur_frag_ptr) << 2);
+        nb = fnet_netbuf_concat(nb, tmp_nb);
     }
 
     /* Reconstruct datagram header.*/
-    iphdr = (fnet_ip_header_t *)frag_list_ptr->frag_ptr;
-    nb->total_length += FNET_IP_HEADER_GET_HEADER_LENGTH(iphdr) << 2;
-    nb->length += FNET_IP_HEADER_GET_HEADER_LENGTH(iphdr) << 2;
-    nb->data_ptr = (unsigned char *)nb->data_ptr - (FNET_IP_HEADER_GET_HEADER_LENGTH(iphdr) << 2);
-
+    iphdr = (fnet_ip_header_t *)nb->data_ptr;
     iphdr->total_length = fnet_htons((unsigned short)nb->total_length);
-
+    iphdr->flags_fragment_offset = 0;
+    iphdr->ttl = frag_list_ptr->ttl;
+    iphdr->protocol = frag_list_ptr->protocol;
+    iphdr->checksum = 0;
     iphdr->source_addr = frag_list_ptr->source_addr;
     iphdr->desination_addr = frag_list_ptr->desination_addr;
-    iphdr->protocol = frag_list_ptr->protocol;
-    iphdr->tos &= ~1;
 
-    fnet_ip_frag_list_del(&ip_frag_list_head, frag_list_ptr);
+    ip_frag_memory -= frag_list_ptr->memory;
+    fnet_ip_frag_list_del(frag_list_ptr);
     fnet_free(frag_list_ptr);
+    
+    fnet_ip_frag_stats.oks++;
 
     return (nb);
 
 DROP_FRAG:
-    fnet_netbuf_free_chain(nb);
+    fnet_ip_frag_stats.drops++;
+    fnet_netbuf_free_chain(*nb_ptr);
 NEXT_FRAG:
     return (FNET_NULL);
 }
 #endif /* FNET_CFG_IP4_FRAGMENTATION */
 
+/************************************************************************
+* NAME: fnet_ip_frag_hash
+*
+* DESCRIPTION: Returns the hash bucket of a datagram awaiting reassembly.
+*************************************************************************/
+#if FNET_CFG_IP4_FRAGMENTATION
+static unsigned long fnet_ip_frag_hash( fnet_ip4_addr_t source_addr, fnet_ip4_addr_t desination_addr, unsigned short id, unsigned char protocol )
+{
+    unsigned long hash;
+    
+    hash = source_addr ^ desination_addr ^ ((unsigned long)id << 8) ^ protocol;
+    hash ^= (hash >> 16);
+    hash ^= (hash >> 8);
+    
+    return (hash % FNET_CFG_IP4_FRAG_HASH_SIZE);
+}
+#endif /* FNET_CFG_IP4_FRAGMENTATION */
+
 /************************************************************************
 * NAME: fnet_ip_timer
 *
@@ -794,26 +1286,18 @@ NEXT_FRAG:
 
 static void fnet_ip_timer(void *cookie)
 {
-    fnet_ip_frag_list_t *frag_list_ptr;
-    fnet_ip_frag_list_t *tmp_frag_list_ptr;
+    unsigned long ttl = fnet_timer_ms2ticks(FNET_IP_FRAG_TTL);
 
     FNET_COMP_UNUSED_ARG(cookie);
     
     fnet_isr_lock();
-    frag_list_ptr = ip_frag_list_head;
-
-    while(frag_list_ptr != 0)
+    
+    /* The lists are kept in arrival order, so only the oldest ones may be expired.*/
+    while((ip_frag_list_head != 0) 
+        && (fnet_timer_get_interval(ip_frag_list_head->timestamp, fnet_timer_ticks()) >= ttl))
     {
-        frag_list_ptr->ttl--;
-
-        if(frag_list_ptr->ttl == 0)
-        {
-            tmp_frag_list_ptr = frag_list_ptr->next;
-            fnet_ip_frag_list_free(frag_list_ptr);
-            frag_list_ptr = tmp_frag_list_ptr;
-        }
-        else
-            frag_list_ptr = frag_list_ptr->next;
+        fnet_ip_frag_stats.timeouts++;
+        fnet_ip_frag_list_free(ip_frag_list_head);
     }
 
     fnet_isr_unlock();
@@ -864,14 +1348,15 @@ static void fnet_ip_frag_list_free( fnet_ip_frag_list_t *list )
 
     if(list)
     {
-        while((volatile fnet_ip_frag_header_t *)(list->frag_ptr) != 0)
+        while(list->frag_ptr != 0)
         {
             nb = list->frag_ptr->nb;
-            fnet_ip_frag_del((fnet_ip_frag_header_t **)(&list->frag_ptr), list->frag_ptr);
+            list->frag_ptr = list->frag_ptr->next;
             fnet_netbuf_free_chain(nb);
         }
 
-        fnet_ip_frag_list_del(&ip_frag_list_head, list);
+        ip_frag_memory -= list->memory;
+        fnet_ip_frag_list_del(list);
         fnet_free(list);
     }
 
@@ -882,18 +1367,24 @@ static void fnet_ip_frag_list_free( fnet_ip_frag_list_t *list )
 /************************************************************************
 * NAME: fnet_ip_frag_list_add
 *
-* DESCRIPTION: Adds frag list to the general frag list.
+* DESCRIPTION: Adds frag list to the tail of the general frag list 
+*              and to the hash bucket.
 *************************************************************************/
 #if FNET_CFG_IP4_FRAGMENTATION
-static void fnet_ip_frag_list_add( fnet_ip_frag_list_t ** head, fnet_ip_frag_list_t *fl )
+static void fnet_ip_frag_list_add( fnet_ip_frag_list_t *fl, unsigned long hash )
 {
-    fl->next = *head;
+    fl->prev = ip_frag_list_tail;
+    fl->next = 0;
 
-    if(fl->next != 0)
-        fl->next->prev = fl;
+    if(fl->prev != 0)
+        fl->prev->next = fl;
+    else
+        ip_frag_list_head = fl;
+    
+    ip_frag_list_tail = fl;
 
-    fl->prev = 0;
-    *head = fl;
+    fl->hash_next = ip_frag_hash_table[hash];
+    ip_frag_hash_table[hash] = fl;
 }
 
 #endif /* FNET_CFG_IP4_FRAGMENTATION */
@@ -901,71 +1392,37 @@ static void fnet_ip_frag_list_add( fnet_ip_frag_list_t ** head, fnet_ip_frag_lis
 /************************************************************************
 * NAME: fnet_ip_frag_list_del
 *
-* DESCRIPTION: Deletes frag list from the general frag list.
+* DESCRIPTION: Deletes frag list from the general frag list
+*              and from the hash bucket.
 *************************************************************************/
 #if FNET_CFG_IP4_FRAGMENTATION
-static void fnet_ip_frag_list_del( fnet_ip_frag_list_t ** head, fnet_ip_frag_list_t *fl )
+static void fnet_ip_frag_list_del( fnet_ip_frag_list_t *fl )
 {
+    fnet_ip_frag_list_t **hash_ptr;
+    
     if(fl->prev == 0)
-        *head=fl->next;
+        ip_frag_list_head = fl->next;
     else
         fl->prev->next = fl->next;
 
-    if(fl->next != 0)
+    if(fl->next == 0)
+        ip_frag_list_tail = fl->prev;
+    else
         fl->next->prev = fl->prev;
-}
-
-#endif /* FNET_CFG_IP4_FRAGMENTATION */
-
-/************************************************************************
-* NAME: fnet_ip_frag_add
-*
-* DESCRIPTION: Adds frag to the frag list.
-*************************************************************************/
-#if FNET_CFG_IP4_FRAGMENTATION
-static void fnet_ip_frag_add( fnet_ip_frag_header_t ** head, fnet_ip_frag_header_t *frag,
-                       fnet_ip_frag_header_t *frag_prev )
-{
-    if(frag_prev && ( *head))
+    
+    hash_ptr = &ip_frag_hash_table[fnet_ip_frag_hash(fl->source_addr, fl->desination_addr, fl->id, fl->protocol)];
+    
+    while(*hash_ptr != 0)
     {
-        frag->next = frag_prev->next;
-        frag->prev = frag_prev;
-        frag_prev->next->prev = frag;
-        frag_prev->next = frag;
-
-        if((*head)->offset > frag->offset)
+        if(*hash_ptr == fl)
         {
-            *head = frag;
+            *hash_ptr = fl->hash_next;
+            break;
         }
-    }
-    else
-    {
-        frag->next = frag;
-        frag->prev = frag;
-        *head = frag;
+        hash_ptr = &(*hash_ptr)->hash_next;
     }
 }
-#endif /* FNET_CFG_IP4_FRAGMENTATION */
 
-/************************************************************************
-* NAME: fnet_ip_frag_del
-*
-* DESCRIPTION: Deletes frag from the frag list.
-*************************************************************************/
-#if FNET_CFG_IP4_FRAGMENTATION
-static void fnet_ip_frag_del( fnet_ip_frag_header_t ** head, fnet_ip_frag_header_t *frag )
-{
-    if(frag->prev == frag)
-        *head=0;
-    else
-    {
-        frag->prev->next = frag->next;
-        frag->next->prev = frag->prev;
-
-        if(*head == frag)
-            *head=frag->next;
-    }
-}
 #endif /* FNET_CFG_IP4_FRAGMENTATION */
 
 
@@ -1100,26 +1557,26 @@ int fnet_ip_addr_is_broadcast( fnet_ip4_addr_t addr, fnet_netif_t *netif )
 }
 
 
-//TBD ???
-/*Todo path MTU discovery feature
- *Todo get MTU from a routing table, depending on destination MTU*/
-unsigned long fnet_ip_maximum_packet( fnet_ip4_addr_t dest_ip ) 
+/************************************************************************
+* NAME: fnet_ip_maximum_packet
+*
+* DESCRIPTION: This function returns the maximum size of the upper 
+*              protocol packet, that may be sent to the destination. 
+*              If the fragmentation is disabled, it is limited by 
+*              the MTU of the route.
+*************************************************************************/
+unsigned long fnet_ip_maximum_packet( fnet_netif_dst_t *dst /*optional*/, fnet_ip4_addr_t dest_ip ) 
 {
-    unsigned int result;
+    unsigned long result;
 
 #if FNET_CFG_IP4_FRAGMENTATION == 0
 
-    {
-        fnet_netif_t *netif;
-
-        if((netif = fnet_ip_route(dest_ip)) == 0) /* No route*/
-            result = FNET_IP_MAX_PACKET;
-        else
-            result = netif->mtu;
-    }
+    if(fnet_ip_route_prv(dst, dest_ip, &result, FNET_NULL) == 0) /* No route*/
+        result = FNET_IP_MAX_PACKET;
 
 #else
 
+    FNET_COMP_UNUSED_ARG(dst);
     FNET_COMP_UNUSED_ARG(dest_ip);
 
     result = FNET_IP_MAX_PACKET;
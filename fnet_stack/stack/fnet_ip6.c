@@ -63,6 +63,10 @@
 #include "fnet_igmp.h"
 #include "fnet_prot.h"
 #include "fnet_raw.h"
+#include "fnet_eth_prv.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
+#include "fnet_latency_prv.h"
     
 /******************************************************************
 * Ext. header handler results.
@@ -82,27 +86,50 @@ typedef struct fnet_ip6_ext_header
     fnet_ip6_ext_header_handler_result_t (*handler)(fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb); /* Extension header handler.*/
     
 } fnet_ip6_ext_header_t;
+
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+/******************************************************************
+* Destination cache entry.
+*******************************************************************/
+typedef struct fnet_ip6_dst_cache_entry
+{
+    fnet_ip6_addr_t     dest_addr;  /* Destination address (the key).*/
+    fnet_netif_dst_t    dst;        /* Interface, source address, MTU and next hop.*/
+} fnet_ip6_dst_cache_entry_t;
+
+static fnet_ip6_dst_cache_entry_t   fnet_ip6_dst_cache[FNET_CFG_IP6_DST_CACHE_SIZE];
+static unsigned int                 fnet_ip6_dst_cache_next;    /* Next entry to be replaced.*/
+#endif
  
 /******************************************************************
 * Function Prototypes
 *******************************************************************/
-static void fnet_ip6_netif_output(struct fnet_netif *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t* nb);
+static void fnet_ip6_netif_output(struct fnet_netif *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t* nb, fnet_netif_dst_t *dst);
 static int fnet_ip6_ext_header_process(fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb);
+static void fnet_ip6_dst_fill(fnet_netif_dst_t *dst, fnet_netif_t *netif, fnet_ip6_addr_t *src_ip);
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+    static fnet_netif_dst_t *fnet_ip6_dst_cache_get(fnet_ip6_addr_t *dest_ip);
+#endif
 static fnet_ip6_ext_header_handler_result_t fnet_ip6_ext_header_handler_fragment_header(fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb);
 static fnet_ip6_ext_header_handler_result_t fnet_ip6_ext_header_handler_routing_header(fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb);
 static fnet_ip6_ext_header_handler_result_t fnet_ip6_ext_header_handler_options (fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb);
 static fnet_ip6_ext_header_handler_result_t fnet_ip6_ext_header_handler_no_next_header (fnet_netif_t *netif, unsigned char **next_header_p, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t **nb_p, fnet_netbuf_t *ip6_nb);
 
 #if FNET_CFG_IP6_FRAGMENTATION
-    static void fnet_ip6_frag_list_add( fnet_ip6_frag_list_t ** head, fnet_ip6_frag_list_t *fl );
-    static void fnet_ip6_frag_list_del( fnet_ip6_frag_list_t ** head, fnet_ip6_frag_list_t *fl );
-    static void fnet_ip6_frag_add( fnet_ip6_frag_header_t ** head, fnet_ip6_frag_header_t *frag,  fnet_ip6_frag_header_t *frag_prev );
-    static void fnet_ip6_frag_del( fnet_ip6_frag_header_t ** head, fnet_ip6_frag_header_t *frag );
+    static void fnet_ip6_frag_list_add( fnet_ip6_frag_list_t *fl, unsigned long hash );
+    static void fnet_ip6_frag_list_del( fnet_ip6_frag_list_t *fl );
+    static unsigned long fnet_ip6_frag_hash( fnet_ip6_addr_t *source_addr, fnet_ip6_addr_t *destination_addr, unsigned long id, unsigned char next_header );
     static void fnet_ip6_frag_list_free( fnet_ip6_frag_list_t *list );
     static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t ** nb_ptr, fnet_netbuf_t *ip6_nb, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip );
     static void fnet_ip6_timer(void *cookie);
 #endif
 
+/* Binary trace of an IPv6 packet.*/
+#define FNET_IP6_TRACE(event, hdr)  \
+    FNET_TRACE(FNET_TRACE_LAYER_IP6, (event), \
+               fnet_trace_hash(&(hdr)->source_addr, sizeof(fnet_ip6_addr_t)) ^ fnet_trace_hash(&(hdr)->destination_addr, sizeof(fnet_ip6_addr_t)), \
+               0, 0, (hdr)->next_header, fnet_ntohs((hdr)->length) + sizeof(fnet_ip6_header_t))
+
 /******************************************************************
 * Extension Header Handler List
 *******************************************************************/
@@ -150,8 +177,12 @@ static fnet_ip_queue_t ip6_queue;
 static fnet_event_desc_t ip6_event;
 
 #if FNET_CFG_IP6_FRAGMENTATION
-    static fnet_ip6_frag_list_t *ip6_frag_list_head;
+    static fnet_ip6_frag_list_t *ip6_frag_list_head;  /* The oldest reassembly list.*/
+    static fnet_ip6_frag_list_t *ip6_frag_list_tail;  /* The youngest reassembly list.*/
+    static fnet_ip6_frag_list_t *ip6_frag_hash_table[FNET_CFG_IP6_FRAG_HASH_SIZE];
+    static unsigned long ip6_frag_memory;             /* Bytes held by all fragments.*/
     static fnet_timer_desc_t ip6_timer_ptr;
+    fnet_ip_frag_stats_t fnet_ip6_frag_stats;
 #endif
 
 
@@ -168,6 +199,10 @@ const fnet_ip6_addr_t fnet_ip6_addr_linklocal_prefix = FNET_IP6_ADDR_LINKLOCAL_P
 
 
 static void fnet_ip6_input_low( void *cookie );
+#if FNET_CFG_IP6_FORWARDING
+    static int fnet_ip6_forward( fnet_netif_t *netif, fnet_netbuf_t *nb );
+    static int fnet_ip6_addr_is_own( fnet_ip6_addr_t *addr );
+#endif
 
 
 /************************************************************************
@@ -182,7 +217,17 @@ int fnet_ip6_init( void )
 #if FNET_CFG_IP6_FRAGMENTATION
 
     ip6_frag_list_head = 0;
+    ip6_frag_list_tail = 0;
+    ip6_frag_memory = 0;
+    fnet_memset_zero(ip6_frag_hash_table, sizeof(ip6_frag_hash_table));
+    fnet_memset_zero(&fnet_ip6_frag_stats, sizeof(fnet_ip6_frag_stats));
     
+#endif
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+    fnet_memset_zero(fnet_ip6_dst_cache, sizeof(fnet_ip6_dst_cache));
+    fnet_ip6_dst_cache_next = 0;
+#endif
+#if FNET_CFG_IP6_FRAGMENTATION
     ip6_timer_ptr = fnet_timer_new((FNET_IP6_TIMER_PERIOD / FNET_TIMER_PERIOD_MS), fnet_ip6_timer, 0);
 
     if(ip6_timer_ptr)
@@ -214,6 +259,9 @@ void fnet_ip6_release( void )
     fnet_timer_free(ip6_timer_ptr);
     ip6_timer_ptr = 0;
 #endif
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+    fnet_memset_zero(fnet_ip6_dst_cache, sizeof(fnet_ip6_dst_cache));
+#endif
 }
 
 /************************************************************************
@@ -485,8 +533,12 @@ void fnet_ip6_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
 {
     if(netif && nb)
     {
+        FNET_STATS_INC(ip6.in_receives);
+        FNET_LATENCY_RX(FNET_LATENCY_RX_IP, nb);
+
         if(fnet_ip_queue_append(&ip6_queue, netif, nb) != FNET_OK)
         {
+            FNET_STATS_INC(ip6.in_discards);
             fnet_netbuf_free_chain(nb);
             return;
         }
@@ -496,6 +548,125 @@ void fnet_ip6_input( fnet_netif_t *netif, fnet_netbuf_t *nb )
     }    
 }
 
+/************************************************************************
+* NAME: fnet_ip6_forward
+*
+* DESCRIPTION: This function forwards the IPv6 datagram, that is not 
+*              addressed to this host, to the next hop.
+*              The received netbuf is reused, only the Hop Limit is updated.
+*              The next hop is resolved by Neighbor Discovery.
+*
+* RETURNS: FNET_FALSE if the datagram must be processed by this host.
+*          FNET_TRUE if the datagram is forwarded or discarded.
+*************************************************************************/
+#if FNET_CFG_IP6_FORWARDING
+static int fnet_ip6_forward( fnet_netif_t *netif, fnet_netbuf_t *nb )
+{
+    fnet_ip6_header_t       *hdr = nb->data_ptr;
+    fnet_netif_t            *out_netif;
+    const fnet_ip6_addr_t   *src_ip;
+    unsigned long           mtu;
+
+    /* Datagrams for this host and invalid datagrams are processed 
+     * (or discarded) by the input routine.*/
+    if((nb->total_length < sizeof(fnet_ip6_header_t))
+        || (nb->total_length < (sizeof(fnet_ip6_header_t) + fnet_ntohs(hdr->length)))
+        || (FNET_IP6_HEADER_GET_VERSION(hdr) != 6)
+        || FNET_IP6_ADDR_IS_MULTICAST(&hdr->destination_addr)
+        || fnet_ip6_addr_is_own(&hdr->destination_addr))
+    {
+        return FNET_FALSE;
+    }
+
+    /* RFC4291: Routers must not forward any packets with link-local 
+     * or loopback addresses, nor packets received as a link-layer
+     * broadcast/multicast.*/
+    if((nb->flags & (FNET_NETBUF_FLAG_BROADCAST | FNET_NETBUF_FLAG_MULTICAST))
+        || FNET_IP6_ADDR_IS_MULTICAST(&hdr->source_addr)
+        || FNET_IP6_ADDR_IS_UNSPECIFIED(&hdr->source_addr)
+        || FNET_IP6_ADDR_IS_LOOPBACK(&hdr->source_addr)
+        || FNET_IP6_ADDR_IS_LINKLOCAL(&hdr->destination_addr)
+        || FNET_IP6_ADDR_IS_LOOPBACK(&hdr->destination_addr)
+        || FNET_IP6_ADDR_IS_UNSPECIFIED(&hdr->destination_addr))
+    {
+        FNET_STATS_INC(ip6.in_addr_errors);
+        fnet_netbuf_free_chain(nb);
+        return FNET_TRUE;
+    }
+
+    /* RFC4443 3.1: The source address is beyond the scope of the destination.*/
+    if(FNET_IP6_ADDR_IS_LINKLOCAL(&hdr->source_addr))
+    {
+        FNET_STATS_INC(ip6.in_addr_errors);
+        fnet_icmp6_error(netif, FNET_ICMP6_TYPE_DEST_UNREACH, FNET_ICMP6_CODE_DU_BEYOND_SCOPE, 0, nb);
+        return FNET_TRUE;
+    }
+
+    /* RFC2460 3: The Hop Limit is decremented by 1 by each node that 
+     * forwards the packet. The packet is discarded if Hop Limit is 
+     * decremented to zero.*/
+    if(hdr->hop_limit <= 1)
+    {
+        FNET_STATS_INC(ip6.in_hdr_errors);
+        fnet_icmp6_error(netif, FNET_ICMP6_TYPE_TIME_EXCEED, FNET_ICMP6_CODE_TE_HOP_LIMIT, 0, nb);
+        return FNET_TRUE;
+    }
+
+    /* The outgoing interface and its source address, used by Neighbor Discovery.*/
+    if(((out_netif = fnet_ip6_route(FNET_NULL, &hdr->destination_addr)) == FNET_NULL)
+    #if FNET_CFG_LOOPBACK
+        || (out_netif == FNET_LOOP_IF)
+    #endif
+        || ((src_ip = fnet_ip6_select_src_addr(out_netif, &hdr->destination_addr)) == FNET_NULL))
+    {
+        FNET_STATS_INC(ip6.out_no_routes);
+        fnet_icmp6_error(netif, FNET_ICMP6_TYPE_DEST_UNREACH, FNET_ICMP6_CODE_DU_NO_ROUTE, 0, nb);
+        return FNET_TRUE;
+    }
+
+    /* RFC2460 5: Routers do not fragment, Packet Too Big is sent instead.*/
+    mtu = out_netif->nd6_if_ptr ? out_netif->nd6_if_ptr->mtu : out_netif->mtu;
+
+    if(nb->total_length > mtu)
+    {
+        FNET_STATS_INC(ip6.frag_fails);
+        fnet_icmp6_error(netif, FNET_ICMP6_TYPE_PACKET_TOOBIG, 0, mtu, nb);
+        return FNET_TRUE;
+    }
+
+    hdr->hop_limit--;
+
+    /* The link-layer flags of the received frame are not valid for the output.*/
+    nb->flags = FNET_NETBUF_FLAG_NONE;
+
+    FNET_STATS_INC(ip6.forw_datagrams);
+    out_netif->api->output_ip6(out_netif, (fnet_ip6_addr_t *)src_ip, &hdr->destination_addr, nb);
+
+    return FNET_TRUE;
+}
+
+/************************************************************************
+* NAME: fnet_ip6_addr_is_own
+*
+* DESCRIPTION: Checks if the address belongs to one of the interfaces.
+*              It is called by the input routine for every datagram,
+*              with the interrupts locked, so the interface list 
+*              is walked without the OS mutex.
+*************************************************************************/
+static int fnet_ip6_addr_is_own( fnet_ip6_addr_t *addr )
+{
+    fnet_netif_t *netif;
+
+    for (netif = fnet_netif_list; netif != 0; netif = netif->next)
+    {
+        if(fnet_netif_is_my_ip6_addr(netif, addr) == FNET_TRUE)
+            return FNET_TRUE;
+    }
+
+    return FNET_FALSE;
+}
+#endif /* FNET_CFG_IP6_FORWARDING */
+
 /************************************************************************
 * NAME: fnet_ip6_input_low
 *
@@ -521,17 +692,20 @@ static void fnet_ip6_input_low( void *cookie )
         fnet_netbuf_t   *ip6_nb = FNET_NULL;
         
         nb->next_chain = 0;
+        FNET_LATENCY_RX(FNET_LATENCY_RX_IP_LOW, nb);
 
         /* RFC 4862: By disabling IP operation, 
          * silently drop any IP packets received on the interface.*/
         if(netif->nd6_if_ptr && netif->nd6_if_ptr->ip6_disabled)
         {
+            FNET_STATS_INC(ip6.in_discards);
             goto DROP;
         }  
 
         /* The header must reside in contiguous area of memory. */
         if((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_ip6_header_t))) == 0) 
         {
+            FNET_STATS_INC(ip6.in_discards);
             goto DROP;
         }
         nb = tmp_nb; 
@@ -543,11 +717,18 @@ static void fnet_ip6_input_low( void *cookie )
         
         payload_length = fnet_ntohs(hdr->length);
 
+        FNET_IP6_TRACE(FNET_TRACE_EVENT_RX, hdr);
+
         if(nb->total_length > (sizeof(fnet_ip6_header_t)+ payload_length))
         {
             /* Logical size and the physical size of the packet should be the same.*/
             fnet_netbuf_trim(&nb, (int)sizeof(fnet_ip6_header_t) + (int)payload_length - (int)nb->total_length ); 
         }
+
+    #if FNET_CFG_IP6_FORWARDING
+        if(fnet_ip6_forward(netif, nb) == FNET_TRUE)
+            continue; /* Forwarded or discarded.*/
+    #endif
  
         /*******************************************************************
          * Start IPv6 header  processing.
@@ -558,7 +739,11 @@ static void fnet_ip6_input_low( void *cookie )
             && (!FNET_IP6_ADDR_IS_MULTICAST(&hdr->source_addr))             /* Validate source address. */
             && (fnet_netif_is_my_ip6_addr(netif, &hdr->destination_addr)    /* Validate destination address. */
                 || fnet_netif_is_my_ip6_solicited_multicast_addr(netif, &hdr->destination_addr)
-                || FNET_IP6_ADDR_EQUAL(&fnet_ip6_addr_linklocal_allnodes, &hdr->destination_addr) )
+                || FNET_IP6_ADDR_EQUAL(&fnet_ip6_addr_linklocal_allnodes, &hdr->destination_addr) 
+    #if FNET_CFG_IP6_FORWARDING
+                || fnet_ip6_addr_is_own(&hdr->destination_addr) /* Address of other interface.*/
+    #endif
+                )
           )
         { 
             unsigned char   *next_header = &hdr->next_header;
@@ -567,7 +752,10 @@ static void fnet_ip6_input_low( void *cookie )
             ip6_nb = fnet_netbuf_copy(nb, 0, ((nb->total_length > FNET_IP6_DEFAULT_MTU) ? FNET_IP6_DEFAULT_MTU : FNET_NETBUF_COPYALL), 
                                         0); /* Used mainly for ICMP errors .*/
             if(ip6_nb == FNET_NULL)
+            {
+                FNET_STATS_INC(ip6.in_discards);
                 goto DROP;
+            }
     
 
     #if FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM
@@ -611,12 +799,14 @@ static void fnet_ip6_input_low( void *cookie )
             /* Find transport protocol.*/
             if((protocol = fnet_prot_find(AF_INET6, SOCK_UNSPEC, *next_header)) != FNET_NULL)
             {
+                FNET_STATS_INC(ip6.in_delivers);
                 protocol->prot_input_ip6(netif, source_addr, destination_addr, nb, ip6_nb);
                 /* After that nb may point to wrong place. Do not use it.*/
             }
             else 
             /* No protocol found.*/                                  
             {
+                FNET_STATS_INC(ip6.in_unknown_protos);
                 fnet_netbuf_free_chain(nb);
                 /* RFC 2460 4:If, as a result of processing a header, a node is required to proceed
                  * to the next header but the Next Header value in the current header is
@@ -633,6 +823,14 @@ static void fnet_ip6_input_low( void *cookie )
         }
         else
         {
+        #if FNET_CFG_STATS
+            if((FNET_IP6_HEADER_GET_VERSION(hdr) == 6)
+                && (nb->total_length >= (sizeof(fnet_ip6_header_t) + payload_length)))
+                FNET_STATS_INC(ip6.in_addr_errors);
+            else
+                FNET_STATS_INC(ip6.in_hdr_errors);
+        #endif
+            FNET_IP6_TRACE(FNET_TRACE_EVENT_DROP, hdr);
     DROP:   
             fnet_netbuf_free_chain(ip6_nb);   
             fnet_netbuf_free_chain(nb);
@@ -965,6 +1163,58 @@ unsigned long fnet_ip6_mtu( fnet_netif_t *netif)
     return mtu;
 }
 
+/************************************************************************
+* NAME: fnet_ip6_dst_fill
+*
+* DESCRIPTION: This function refills the destination cache entry
+*              with the chosen interface and source address. 
+*************************************************************************/
+static void fnet_ip6_dst_fill(fnet_netif_dst_t *dst, fnet_netif_t *netif, fnet_ip6_addr_t *src_ip)
+{
+    dst->netif = netif;
+    dst->generation = fnet_netif_dst_generation;
+    dst->ll_addr_valid = FNET_FALSE;
+    dst->mtu = fnet_ip6_mtu(netif);
+    FNET_IP6_ADDR_COPY(src_ip, &dst->ip6_src);
+}
+
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+/************************************************************************
+* NAME: fnet_ip6_dst_cache_get
+*
+* DESCRIPTION: This function looks up the destination cache entry
+*              of the destination address. If there is no valid entry,
+*              the oldest one is reset and returned, to be refilled 
+*              by the caller.
+*************************************************************************/
+static fnet_netif_dst_t *fnet_ip6_dst_cache_get(fnet_ip6_addr_t *dest_ip)
+{
+    fnet_ip6_dst_cache_entry_t  *entry;
+    unsigned int                i;
+    
+    for(i = 0; i < FNET_CFG_IP6_DST_CACHE_SIZE; i++)
+    {
+        entry = &fnet_ip6_dst_cache[i];
+        
+        if(FNET_NETIF_DST_IS_VALID(&entry->dst) && FNET_IP6_ADDR_EQUAL(&entry->dest_addr, dest_ip))
+        {
+            return &entry->dst;
+        }
+    }
+    
+    /* Not found, replace the oldest entry.*/
+    entry = &fnet_ip6_dst_cache[fnet_ip6_dst_cache_next];
+    
+    if(++fnet_ip6_dst_cache_next >= FNET_CFG_IP6_DST_CACHE_SIZE)
+        fnet_ip6_dst_cache_next = 0;
+    
+    FNET_NETIF_DST_RESET(&entry->dst);
+    FNET_IP6_ADDR_COPY(dest_ip, &entry->dest_addr);
+    
+    return &entry->dst;
+}
+#endif /* FNET_CFG_IP6_DST_CACHE_SIZE */
+
 /************************************************************************
 * NAME: fnet_ip6_route
 *
@@ -974,6 +1224,9 @@ unsigned long fnet_ip6_mtu( fnet_netif_t *netif)
 fnet_netif_t *fnet_ip6_route(fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip)
 {
     fnet_netif_t        *netif = FNET_NULL;
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+    fnet_netif_dst_t    *dst = FNET_NULL;
+#endif
   
 
     /* Validate destination address. */
@@ -993,6 +1246,14 @@ fnet_netif_t *fnet_ip6_route(fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr
         if((src_ip == FNET_NULL) || FNET_IP6_ADDR_IS_UNSPECIFIED(src_ip))
         /* Determine a source address. */
         {
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+            dst = fnet_ip6_dst_cache_get(dest_ip);
+            
+            if(FNET_NETIF_DST_IS_VALID(dst))
+            {
+                return dst->netif;
+            }
+#endif            
             src_ip = (fnet_ip6_addr_t *)fnet_ip6_select_src_addr(FNET_NULL, dest_ip);
         }
 
@@ -1000,12 +1261,40 @@ fnet_netif_t *fnet_ip6_route(fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr
         {
             /* Determine an output interface. */
             netif = fnet_netif_get_by_ip6_addr(src_ip);
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+            if(dst && netif)
+            {
+                fnet_ip6_dst_fill(dst, netif, src_ip);
+            }
+#endif
         } 
     }
 
     return netif;
 }
 
+/************************************************************************
+* NAME: fnet_ip6_dst_route
+*
+* DESCRIPTION: This function returns the outgoing interface, using 
+*              the destination cache entry of a connected socket.
+*************************************************************************/
+fnet_netif_t *fnet_ip6_dst_route(fnet_netif_dst_t *dst /*optional*/, fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip)
+{
+    fnet_netif_t *netif;
+    
+    if(dst && FNET_NETIF_DST_IS_VALID(dst))
+    {
+        netif = dst->netif;
+    }
+    else
+    {
+        netif = fnet_ip6_route(src_ip, dest_ip);
+    }
+    
+    return netif;
+}
+
 /************************************************************************
 * NAME: fnet_ip6_will_fragment
 *
@@ -1043,6 +1332,34 @@ int fnet_ip6_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_
     return res;
 }
 
+/************************************************************************
+* NAME: fnet_ip6_maximum_packet
+*
+* DESCRIPTION: This function returns the maximum size of the upper 
+*              protocol packet, that may be sent to the destination 
+*              without fragmentation. It is limited by the Path MTU.
+*************************************************************************/
+unsigned long fnet_ip6_maximum_packet( fnet_netif_dst_t *dst /*optional*/, fnet_ip6_addr_t *dest_ip ) 
+{
+    unsigned long   mtu;
+    fnet_netif_t    *netif;
+    
+    if(dst && FNET_NETIF_DST_IS_VALID(dst))
+    {
+        mtu = dst->mtu;
+    }
+    else if((netif = fnet_ip6_route(FNET_NULL, dest_ip)) != FNET_NULL)
+    {
+        mtu = fnet_ip6_mtu(netif);
+    }
+    else
+    {
+        mtu = FNET_IP6_DEFAULT_MTU;
+    }
+    
+    return (mtu - sizeof(fnet_ip6_header_t));
+}
+
 /************************************************************************
 * NAME: fnet_ip6_output
 *
@@ -1054,17 +1371,20 @@ int fnet_ip6_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_
 *          FNET_ERR_NOMEM=No memory
 *************************************************************************/
 int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip,
-                    unsigned char protocol, unsigned char hop_limit /*optional*/, fnet_netbuf_t *nb, FNET_COMP_PACKED_VAR unsigned short *checksum)
+                    unsigned char protocol, unsigned char hop_limit /*optional*/, fnet_netbuf_t *nb, FNET_COMP_PACKED_VAR unsigned short *checksum,
+                    fnet_netif_dst_t *dst /*optional*/)
 {
     int                 error_code;
     fnet_netbuf_t       *nb_header;
     fnet_ip6_header_t   *ip6_header;
     unsigned long       mtu;
 
+    FNET_STATS_INC(ip6.out_requests);
 
     /* Check maximum packet size. */
     if((nb->total_length + sizeof(fnet_ip6_header_t)) > FNET_IP6_MAX_PACKET)
     {
+        FNET_STATS_INC(ip6.out_discards);
         error_code = FNET_ERR_MSGSIZE;
         goto DROP;
     }    
@@ -1074,10 +1394,31 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
      * of IPv6 packets or in IPv6 Routing Headers.*/ 
     if((dest_ip == FNET_NULL) || FNET_IP6_ADDR_IS_UNSPECIFIED(dest_ip))
     {
+        FNET_STATS_INC(ip6.out_discards);
         error_code = FNET_ERR_DESTADDRREQ;   
         goto DROP;        
     }
     
+#if FNET_CFG_IP6_DST_CACHE_SIZE
+    /* Use the common destination cache, if neither the socket cache
+     * nor the source address and interface are specified.*/
+    if((dst == FNET_NULL) && (src_ip == FNET_NULL) && (netif == FNET_NULL))
+    {
+        dst = fnet_ip6_dst_cache_get(dest_ip);
+    }
+#endif
+
+    /* Use the destination cache entry of the socket.*/
+    if(dst && FNET_NETIF_DST_IS_VALID(dst) && ((netif == FNET_NULL) || (netif == dst->netif)))
+    {
+        netif = dst->netif;
+        
+        if(src_ip == FNET_NULL)
+        {
+            src_ip = &dst->ip6_src;
+        }
+    }
+    
 
     /* 
      * The specified source address may
@@ -1095,6 +1436,7 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
             
         if(src_ip == FNET_NULL)
         {
+            FNET_STATS_INC(ip6.out_no_routes);
             error_code = FNET_ERR_NETUNREACH;
             goto DROP;
         } 
@@ -1107,15 +1449,23 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
 
         if(netif == FNET_NULL) /* Ther is no any initializaed IF.*/
         {
+            FNET_STATS_INC(ip6.out_no_routes);
             error_code = FNET_ERR_NETUNREACH;
             goto DROP;
         }
     } 
     
+    /* Refill the destination cache entry.*/
+    if(dst && (FNET_NETIF_DST_IS_VALID(dst) == FNET_FALSE))
+    {
+        fnet_ip6_dst_fill(dst, netif, src_ip);
+    }
+    
     /* RFC 4862: By disabling IP operation, the node will then not 
      * send any IP packets from the interface.*/
     if(netif->nd6_if_ptr && netif->nd6_if_ptr->ip6_disabled)
     {
+        FNET_STATS_INC(ip6.out_discards);
         error_code = FNET_ERR_IPDISABLED;
         goto DROP;
     }      
@@ -1127,6 +1477,7 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
     /****** Construct IP header. ******/
     if((nb_header = fnet_netbuf_new(sizeof(fnet_ip6_header_t), FNET_TRUE)) == 0)
     {
+        FNET_STATS_INC(ip6.out_discards);
         error_code = FNET_ERR_NOMEM;   
         goto DROP;
     }
@@ -1147,8 +1498,15 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
 
     FNET_IP6_ADDR_COPY(src_ip, &ip6_header->source_addr);
     FNET_IP6_ADDR_COPY(dest_ip, &ip6_header->destination_addr);
+
+    FNET_IP6_TRACE(FNET_TRACE_EVENT_TX, ip6_header);
+    FNET_LATENCY_TX(FNET_LATENCY_TX_IP, nb);
     
-    mtu = fnet_ip6_mtu(netif); 
+    /* The cached MTU is valid until the next interface change.*/
+    if(dst && (dst->netif == netif) && FNET_NETIF_DST_IS_VALID(dst))
+        mtu = dst->mtu;
+    else
+        mtu = fnet_ip6_mtu(netif); 
 
     if(
 #if FNET_CFG_IP6_PMTU_DISCOVERY
@@ -1196,6 +1554,7 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
 
         if(frag_length < 8)             /* The MTU is too small.*/
         {
+            FNET_STATS_INC(ip6.frag_fails);
             error_code = FNET_ERR_MSGSIZE; 
             fnet_netbuf_free_chain(nb_header);            
             goto DROP; 
@@ -1203,6 +1562,7 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
         
         if((nb_frag_header = fnet_netbuf_new(sizeof(fnet_ip6_fragment_header_t), FNET_TRUE)) == 0)
         {
+            FNET_STATS_INC(ip6.frag_fails);
             error_code = FNET_ERR_NOMEM; 
             fnet_netbuf_free_chain(nb_header);   
             goto DROP;
@@ -1217,6 +1577,7 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
         /* The header (and options) must reside in contiguous area of memory.*/
         if((tmp_nb = fnet_netbuf_pullup(nb,  header_length)) == 0)
         {
+            FNET_STATS_INC(ip6.frag_fails);
             error_code = FNET_ERR_NOMEM;   
             goto DROP;
         }
@@ -1292,6 +1653,11 @@ int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*
         ip6_header->length = fnet_htons((unsigned short)(nb->total_length - sizeof(fnet_ip6_header_t)) );
         
 FRAG_END:
+        if(error == 0)
+            FNET_STATS_INC(ip6.frag_oks);
+        else
+            FNET_STATS_INC(ip6.frag_fails);
+
         for (nb = nb_prev; nb; nb = nb_prev)    /* Send each fragment.*/
         {
             nb_prev = nb->next_chain;
@@ -1299,7 +1665,8 @@ FRAG_END:
 
             if(error == 0)
             {
-                fnet_ip6_netif_output(netif, src_ip, dest_ip, nb);
+                FNET_STATS_INC(ip6.frag_creates);
+                fnet_ip6_netif_output(netif, src_ip, dest_ip, nb, dst);
             }
             else
                 fnet_netbuf_free_chain(nb);
@@ -1307,6 +1674,7 @@ FRAG_END:
 
 #else
 
+        FNET_STATS_INC(ip6.frag_fails);
         error_code = FNET_ERR_MSGSIZE;   /* Discard datagram.*/
         goto DROP; 
 
@@ -1316,7 +1684,7 @@ FRAG_END:
     else
     {
         nb = fnet_netbuf_concat(nb_header, nb);
-        fnet_ip6_netif_output(netif, src_ip, dest_ip, nb);
+        fnet_ip6_netif_output(netif, src_ip, dest_ip, nb, dst);
     }
     
 
@@ -1333,7 +1701,7 @@ DROP:
 *
 * DESCRIPTION:
 *************************************************************************/
-static void fnet_ip6_netif_output(struct fnet_netif *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t* nb)
+static void fnet_ip6_netif_output(struct fnet_netif *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t* nb, fnet_netif_dst_t *dst)
 {
     
 #if FNET_CFG_LOOPBACK    
@@ -1362,6 +1730,42 @@ static void fnet_ip6_netif_output(struct fnet_netif *netif, fnet_ip6_addr_t *src
             }
         } 
 #endif /* FNET_CFG_LOOPBACK && FNET_CFG_LOOPBACK_MULTICAST */
+
+#if (FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1)
+        /* Use the next-hop address, cached by the socket.
+         * Only a REACHABLE neighbor is cached, any ND change invalidates it.*/
+        if(dst && (dst->netif == netif) && FNET_NETIF_DST_IS_VALID(dst) 
+            && (netif->api->type == FNET_NETIF_TYPE_ETHERNET)
+            && !FNET_IP6_ADDR_IS_MULTICAST(dest_ip))
+        {
+            if(dst->ll_addr_valid == FNET_FALSE)
+            {
+                fnet_ip6_addr_t             *next_hop = dest_ip;
+                fnet_nd6_neighbor_entry_t   *neighbor;
+                
+                fnet_nd6_redirect_addr(netif, &next_hop);
+                
+                neighbor = fnet_nd6_neighbor_cache_get(netif, next_hop);
+                
+                if((neighbor == FNET_NULL) && (fnet_nd6_addr_is_onlink(netif, next_hop) == FNET_FALSE))
+                {
+                    neighbor = fnet_nd6_default_router_get(netif);
+                }
+                
+                if(neighbor && (neighbor->state == FNET_ND6_NEIGHBOR_STATE_REACHABLE))
+                {
+                    fnet_memcpy(dst->ll_addr, neighbor->ll_addr, sizeof(fnet_mac_addr_t));
+                    dst->ll_addr_valid = FNET_TRUE;
+                }
+            }
+            
+            if(dst->ll_addr_valid)
+            {
+                fnet_eth_output_low(netif, FNET_ETH_TYPE_IP6, dst->ll_addr, nb);
+                return;
+            }
+        }
+#endif /* FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1 */
     }
     netif->api->output_ip6(netif, src_ip,  dest_ip, nb); /* IPv6 Transmit function.*/
 }
@@ -1405,20 +1809,22 @@ void fnet_ip6_get_solicited_multicast_addr(fnet_ip6_addr_t *ip_addr, fnet_ip6_ad
 #if FNET_CFG_IP6_FRAGMENTATION  //PFI create general library fo list, linked lists etc.
 static void fnet_ip6_frag_list_free( fnet_ip6_frag_list_t *list )
 {
-    fnet_netbuf_t *nb;
+    fnet_ip6_frag_header_t *frag_ptr;
 
     fnet_isr_lock();
 
     if(list)
     {
-        while((volatile fnet_ip6_frag_header_t *)(list->frag_ptr) != 0)
+        while(list->frag_ptr != 0)
         {
-            nb = list->frag_ptr->nb;
-            fnet_ip6_frag_del((fnet_ip6_frag_header_t **)(&list->frag_ptr), list->frag_ptr);
-            fnet_netbuf_free_chain(nb);
+            frag_ptr = list->frag_ptr;
+            list->frag_ptr = frag_ptr->next;
+            fnet_netbuf_free_chain(frag_ptr->nb);
+            fnet_free(frag_ptr);
         }
 
-        fnet_ip6_frag_list_del(&ip6_frag_list_head, list);
+        ip6_frag_memory -= list->memory;
+        fnet_ip6_frag_list_del(list);
         fnet_free(list);
     }
 
@@ -1430,18 +1836,24 @@ static void fnet_ip6_frag_list_free( fnet_ip6_frag_list_t *list )
 /************************************************************************
 * NAME: fnet_ip6_frag_list_add
 *
-* DESCRIPTION: Adds frag list to the general frag list.
+* DESCRIPTION: Adds frag list to the tail of the general frag list 
+*              and to the hash bucket.
 *************************************************************************/
 #if FNET_CFG_IP6_FRAGMENTATION
-static void fnet_ip6_frag_list_add( fnet_ip6_frag_list_t ** head, fnet_ip6_frag_list_t *fl )
+static void fnet_ip6_frag_list_add( fnet_ip6_frag_list_t *fl, unsigned long hash )
 {
-    fl->next = *head;
+    fl->prev = ip6_frag_list_tail;
+    fl->next = 0;
 
-    if(fl->next != 0)
-        fl->next->prev = fl;
+    if(fl->prev != 0)
+        fl->prev->next = fl;
+    else
+        ip6_frag_list_head = fl;
+    
+    ip6_frag_list_tail = fl;
 
-    fl->prev = 0;
-    *head = fl;
+    fl->hash_next = ip6_frag_hash_table[hash];
+    ip6_frag_hash_table[hash] = fl;
 }
 
 #endif /* FNET_CFG_IP6_FRAGMENTATION */
@@ -1449,71 +1861,58 @@ static void fnet_ip6_frag_list_add( fnet_ip6_frag_list_t ** head, fnet_ip6_frag_
 /************************************************************************
 * NAME: fnet_ip6_frag_list_del
 *
-* DESCRIPTION: Deletes frag list from the general frag list.
+* DESCRIPTION: Deletes frag list from the general frag list
+*              and from the hash bucket.
 *************************************************************************/
 #if FNET_CFG_IP6_FRAGMENTATION
-static void fnet_ip6_frag_list_del( fnet_ip6_frag_list_t ** head, fnet_ip6_frag_list_t *fl )
+static void fnet_ip6_frag_list_del( fnet_ip6_frag_list_t *fl )
 {
+    fnet_ip6_frag_list_t **hash_ptr;
+    
     if(fl->prev == 0)
-        *head=fl->next;
+        ip6_frag_list_head = fl->next;
     else
         fl->prev->next = fl->next;
 
-    if(fl->next != 0)
+    if(fl->next == 0)
+        ip6_frag_list_tail = fl->prev;
+    else
         fl->next->prev = fl->prev;
-}
-#endif /* FNET_CFG_IP6_FRAGMENTATION */
-
-/************************************************************************
-* NAME: fnet_ip6_frag_add
-*
-* DESCRIPTION: Adds frag to the frag list.
-*************************************************************************/
-#if FNET_CFG_IP6_FRAGMENTATION
-static void fnet_ip6_frag_add( fnet_ip6_frag_header_t ** head, fnet_ip6_frag_header_t *frag,
-                       fnet_ip6_frag_header_t *frag_prev )
-{
-    if(frag_prev && ( *head))
+    
+    hash_ptr = &ip6_frag_hash_table[fnet_ip6_frag_hash(&fl->source_addr, &fl->destination_addr, fl->id, fl->next_header)];
+    
+    while(*hash_ptr != 0)
     {
-        frag->next = frag_prev->next;
-        frag->prev = frag_prev;
-        frag_prev->next->prev = frag;
-        frag_prev->next = frag;
-
-        if((*head)->offset > frag->offset)
+        if(*hash_ptr == fl)
         {
-            *head = frag;
+            *hash_ptr = fl->hash_next;
+            break;
         }
-    }
-    else
-    {
-        frag->next = frag;
-        frag->prev = frag;
-        *head = frag;
+        hash_ptr = &(*hash_ptr)->hash_next;
     }
 }
 #endif /* FNET_CFG_IP6_FRAGMENTATION */
 
 /************************************************************************
-* NAME: fnet_ip6_frag_del
+* NAME: fnet_ip6_frag_hash
 *
-* DESCRIPTION: Deletes frag from the frag list.
+* DESCRIPTION: Returns the hash bucket of a packet awaiting reassembly.
 *************************************************************************/
 #if FNET_CFG_IP6_FRAGMENTATION
-static void fnet_ip6_frag_del( fnet_ip6_frag_header_t ** head, fnet_ip6_frag_header_t *frag )
+static unsigned long fnet_ip6_frag_hash( fnet_ip6_addr_t *source_addr, fnet_ip6_addr_t *destination_addr, unsigned long id, unsigned char next_header )
 {
-    if(frag->prev == frag)
-        *head=0;
-    else
+    unsigned long   hash = id ^ next_header;
+    int             i;
+    
+    for(i = 0; i < 4; i++)
     {
-        frag->prev->next = frag->next;
-        frag->next->prev = frag->prev;
-
-        if(*head == frag)
-            *head=frag->next;
+        hash ^= source_addr->addr32[i] ^ destination_addr->addr32[i];
     }
     
-    fnet_free(frag);
+    hash ^= (hash >> 16);
+    hash ^= (hash >> 8);
+    
+    return (hash % FNET_CFG_IP6_FRAG_HASH_SIZE);
 }
 #endif /* FNET_CFG_IP6_FRAGMENTATION */
 
@@ -1521,27 +1920,33 @@ static void fnet_ip6_frag_del( fnet_ip6_frag_header_t ** head, fnet_ip6_frag_hea
 * NAME: fnet_ip6_reassembly
 *
 * DESCRIPTION: This function attempts to assemble a complete datagram.
+*              Only the Fragment header is made contiguous, 
+*              the fragment data is kept in its net_buf chain.
 *************************************************************************/
 #if FNET_CFG_IP6_FRAGMENTATION
 static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t ** nb_p, fnet_netbuf_t *ip6_nb, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip )
 {
     fnet_ip6_frag_list_t        *frag_list_ptr;
     fnet_ip6_frag_header_t      *frag_ptr;
+    fnet_ip6_frag_header_t      *prev_frag_ptr;
     fnet_ip6_frag_header_t      *cur_frag_ptr;
     fnet_netbuf_t               *nb = *nb_p;
     fnet_netbuf_t               *tmp_nb;
     fnet_ip6_header_t           *iphdr = (fnet_ip6_header_t *)ip6_nb->data_ptr;
-    int                         i;
     unsigned char               next_header;
     unsigned long               id;
-    unsigned short              offset;
-    unsigned char               mf;
-    unsigned short              total_length;
+    unsigned long               offset;
+    unsigned long               length;
+    unsigned long               end;
+    unsigned long               hash;
+    int                         mf;
     fnet_ip6_fragment_header_t  *ip6_fragment_header;
     
+    fnet_ip6_frag_stats.reqds++;
   
-    /* For this algorithm the all datagram must reside in contiguous area of memory.*/
-    if((tmp_nb = fnet_netbuf_pullup(nb, (int)nb->total_length)) == 0) 
+    /* Only the Fragment header must reside in contiguous area of memory.*/
+    if((nb->total_length <= sizeof(fnet_ip6_fragment_header_t)) 
+        || ((tmp_nb = fnet_netbuf_pullup(nb, sizeof(fnet_ip6_fragment_header_t))) == 0)) 
     {
         goto DROP_FRAG_1;
     }
@@ -1549,24 +1954,23 @@ static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t **
     *nb_p = tmp_nb;
     nb = tmp_nb;
     
-    
     /* Process fragment header.*/
     ip6_fragment_header = nb->data_ptr;
     next_header = ip6_fragment_header->next_header;
     id = ip6_fragment_header->id;
-    offset = (unsigned short)FNET_IP6_FRAGMENT_OFFSET(ip6_fragment_header->offset_more);
-    mf = (unsigned char)FNET_IP6_FRAGMENT_MF(ip6_fragment_header->offset_more);
-     
+    offset = FNET_IP6_FRAGMENT_OFFSET(ip6_fragment_header->offset_more);
+    mf = (int)FNET_IP6_FRAGMENT_MF(ip6_fragment_header->offset_more);
     
     fnet_netbuf_trim(nb_p, sizeof(fnet_ip6_fragment_header_t));
     nb = *nb_p;
     
-    total_length = (unsigned short)nb->length;
+    length = nb->total_length;
+    end = offset + length;
     
     if(mf)
     {
         /* Fragments (except the last) must be multiples of 8 bytes */
-        if ((total_length & 0x07) != 0)
+        if ((length & 0x07) != 0)
         {
             /* If the length of a fragment, as derived from the fragment packets
              * Payload Length field, is not a multiple of 8 octets and the M flag
@@ -1580,19 +1984,13 @@ static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t **
         }
     }
     
-
-    /* Create fragment header.*/
-    if((cur_frag_ptr = fnet_malloc(sizeof(fnet_ip6_frag_header_t))) == 0) 
+    if(end > FNET_IP6_MAX_PACKET)
         goto DROP_FRAG_1;
-    
-    cur_frag_ptr->mf = mf;
-    cur_frag_ptr->offset = offset; 
-    cur_frag_ptr->nb = nb;
-    cur_frag_ptr->total_length = total_length;
 
-
-    /* Liner search of the list to locate the appropriate datagram for the current fragment.*/
-    for (frag_list_ptr = ip6_frag_list_head; frag_list_ptr != 0; frag_list_ptr = frag_list_ptr->next)
+    /* Hash search of the packet for the current fragment.*/
+    hash = fnet_ip6_frag_hash(src_ip, dest_ip, id, next_header);
+    
+    for (frag_list_ptr = ip6_frag_hash_table[hash]; frag_list_ptr != 0; frag_list_ptr = frag_list_ptr->hash_next)
     {
         if( (frag_list_ptr->id == id) 
             && (frag_list_ptr->next_header == next_header)
@@ -1606,66 +2004,78 @@ static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t **
     {
         /* Create list.*/
         if((frag_list_ptr = fnet_malloc(sizeof(fnet_ip6_frag_list_t))) == 0) 
-            goto DROP_FRAG_2;
-
-        fnet_ip6_frag_list_add(&ip6_frag_list_head, frag_list_ptr);
+            goto DROP_FRAG_1;
 
-        frag_list_ptr->ttl = FNET_IP6_FRAG_TTL;
+        frag_list_ptr->timestamp = fnet_timer_ticks();
+        frag_list_ptr->length = 0;
+        frag_list_ptr->received = 0;
+        frag_list_ptr->memory = 0;
         frag_list_ptr->id = id;
         frag_list_ptr->next_header = next_header;
         FNET_IP6_ADDR_COPY(src_ip, &frag_list_ptr->source_addr);
         FNET_IP6_ADDR_COPY(dest_ip, &frag_list_ptr->destination_addr);
+        frag_list_ptr->netif = netif;
         frag_list_ptr->frag_ptr = 0;
-        frag_ptr = 0;
+        frag_list_ptr->frag_last_ptr = 0;
+        
+        fnet_ip6_frag_list_add(frag_list_ptr, hash);
     }
     else
     {
-        /* Find position in reassembly list.*/
-        frag_ptr = frag_list_ptr->frag_ptr;
-        do
-        {
-            if(frag_ptr->offset > cur_frag_ptr->offset)
-                break;
-
-            frag_ptr = frag_ptr->next;
-        } 
-        while (frag_ptr != frag_list_ptr->frag_ptr);
+        /* Data beyond the end of the packet.*/
+        if(frag_list_ptr->length && (end > frag_list_ptr->length))
+            goto DROP_FRAG_1;
         
-        /* Trims or discards icoming fragments.*/
-        if(frag_ptr != frag_list_ptr->frag_ptr)
-        {
-            if((i = frag_ptr->prev->offset + frag_ptr->prev->total_length - cur_frag_ptr->prev->offset) != 0)
-            {
-                if(i > cur_frag_ptr->total_length)
-                    goto DROP_FRAG_2;
+        /* The last fragment may not end before the received data.*/
+        if((mf == 0) && (frag_list_ptr->frag_last_ptr) 
+            && ((frag_list_ptr->frag_last_ptr->offset + frag_list_ptr->frag_last_ptr->total_length) > end))
+            goto DROP_FRAG_1;
+    }
+    
+    if(mf == 0)
+    {
+        if(frag_list_ptr->length && (frag_list_ptr->length != end))
+            goto DROP_FRAG_1;
+        
+        frag_list_ptr->length = end;
+    }
+    
+    /* Find position in the fragment list. The in-order fragment is appended at once.*/
+    prev_frag_ptr = frag_list_ptr->frag_last_ptr;
 
-                fnet_netbuf_trim(nb_p, i);
-                nb = *nb_p;
-                cur_frag_ptr->total_length -= i;
-                cur_frag_ptr->offset += i;
-            }
-        }
+    if(prev_frag_ptr && (prev_frag_ptr->offset > offset))
+    {
+        prev_frag_ptr = 0;
         
-        /* Trims or discards existing fragments.*/
-        while((frag_ptr != frag_list_ptr->frag_ptr)
-                  && ((cur_frag_ptr->offset + cur_frag_ptr->total_length) > frag_ptr->offset))
-        {
-            i = (cur_frag_ptr->offset + cur_frag_ptr->total_length) - frag_ptr->offset;
+        for(frag_ptr = frag_list_ptr->frag_ptr; (frag_ptr != 0) && (frag_ptr->offset <= offset); frag_ptr = frag_ptr->next)
+            prev_frag_ptr = frag_ptr;
+    }
 
-            if(i < frag_ptr->total_length)
-            {
-                frag_ptr->total_length -= i;
-                frag_ptr->offset += i;
-                fnet_netbuf_trim((fnet_netbuf_t **)&frag_ptr->nb, i);
-                break;
-            }
+    frag_ptr = prev_frag_ptr ? prev_frag_ptr->next : frag_list_ptr->frag_ptr;
 
-            frag_ptr = frag_ptr->next;
-            fnet_netbuf_free_chain(frag_ptr->prev->nb);
-            fnet_ip6_frag_del((fnet_ip6_frag_header_t **)&frag_list_ptr->frag_ptr, frag_ptr->prev);
-        }
+    /* RFC 5722: If any of the fragments being reassembled overlap with any
+     * other fragments being reassembled for the same packet, reassembly of
+     * that packet must be abandoned and all the fragments that have been
+     * received for that packet must be discarded. 
+     * Exact duplicates are discarded alone.*/
+    if( (prev_frag_ptr && ((prev_frag_ptr->offset + prev_frag_ptr->total_length) > offset))
+        || (frag_ptr && (end > frag_ptr->offset)) )
+    {
+        if((prev_frag_ptr == 0) || (prev_frag_ptr->offset != offset) || (prev_frag_ptr->total_length != length))
+            fnet_ip6_frag_list_free(frag_list_ptr);
+
+        goto DROP_FRAG_1;
     }
     
+    /* Create fragment header.*/
+    if((cur_frag_ptr = fnet_malloc(sizeof(fnet_ip6_frag_header_t))) == 0) 
+        goto DROP_FRAG_1;
+    
+    cur_frag_ptr->offset = (unsigned short)offset; 
+    cur_frag_ptr->total_length = (unsigned short)length;
+    cur_frag_ptr->nb = nb;
+    cur_frag_ptr->next = frag_ptr;
+    
     if(offset == 0) /* First fragment */
     {
         frag_list_ptr->hdr_length = iphdr->length;
@@ -1674,35 +2084,46 @@ static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t **
     }
 
     /* Insert fragment to the list.*/
-    fnet_ip6_frag_add((fnet_ip6_frag_header_t **)(&frag_list_ptr->frag_ptr), cur_frag_ptr, frag_ptr ? frag_ptr->prev : 0); 
+    if(prev_frag_ptr)
+        prev_frag_ptr->next = cur_frag_ptr;
+    else
+        frag_list_ptr->frag_ptr = cur_frag_ptr;
+
+    if(frag_ptr == 0)
+        frag_list_ptr->frag_last_ptr = cur_frag_ptr;
+
+    frag_list_ptr->received += length;
+    frag_list_ptr->memory += nb->total_length;
+    ip6_frag_memory += nb->total_length;
     
+    /* Keep the reassembly memory limit, by discarding the oldest packets.*/
+    while(ip6_frag_memory > FNET_CFG_IP6_FRAG_MEMORY)
     {
-        int offset = 0;
-        frag_ptr = frag_list_ptr->frag_ptr;
-
-        do
+        fnet_ip6_frag_stats.evictions++;
+        
+        if(ip6_frag_list_head == frag_list_ptr)
         {
-            if(frag_ptr->offset != offset)
-                goto NEXT_FRAG;
-
-            offset += frag_ptr->total_length;
-            frag_ptr = frag_ptr->next;
-        } while (frag_ptr != frag_list_ptr->frag_ptr);
+            fnet_ip6_frag_list_free(frag_list_ptr);
+            goto NEXT_FRAG;
+        }
+        
+        fnet_ip6_frag_list_free(ip6_frag_list_head);
     }
-
-    if(frag_ptr->prev->mf & 1)
-        goto NEXT_FRAG;//????
+    
+    /* Wait for the remaining holes to be filled.*/
+    if((frag_list_ptr->length == 0) || (frag_list_ptr->received != frag_list_ptr->length))
+        goto NEXT_FRAG;
 
     /* Reconstruct datagram.*/
-    frag_ptr = frag_list_ptr->frag_ptr;
-    nb = frag_ptr->nb;
-    frag_ptr = frag_ptr->next;
-
-    while(frag_ptr != frag_list_ptr->frag_ptr)
+    nb = 0;
+    
+    while(frag_list_ptr->frag_ptr != 0)
     {
+        frag_ptr = frag_list_ptr->frag_ptr;
+        frag_list_ptr->frag_ptr = frag_ptr->next;
+        
         nb = fnet_netbuf_concat(nb, frag_ptr->nb);
-
-        frag_ptr = frag_ptr->next;
+        fnet_free(frag_ptr);
     }
 
     /* Reconstruct datagram header.*/
@@ -1710,113 +2131,102 @@ static fnet_netbuf_t *fnet_ip6_reassembly(fnet_netif_t *netif, fnet_netbuf_t **
     iphdr->length = fnet_htons((unsigned short)nb->total_length);
     iphdr->next_header = frag_list_ptr->next_header;
 
-    while(frag_list_ptr->frag_ptr != 0)
-    {
-       fnet_ip6_frag_del((fnet_ip6_frag_header_t **)(&frag_list_ptr->frag_ptr), frag_list_ptr->frag_ptr);
-    }
-
-    fnet_ip6_frag_list_del(&ip6_frag_list_head, frag_list_ptr);
+    ip6_frag_memory -= frag_list_ptr->memory;
+    fnet_ip6_frag_list_del(frag_list_ptr);
     fnet_free(frag_list_ptr);
+    
+    fnet_ip6_frag_stats.oks++;
 
     return (nb);
     
-DROP_FRAG_2:
-    fnet_free(cur_frag_ptr);
 DROP_FRAG_1:
     fnet_netbuf_free_chain(ip6_nb);
 DROP_FRAG_0:    
-    fnet_netbuf_free_chain(nb);
+    fnet_ip6_frag_stats.drops++;
+    fnet_netbuf_free_chain(*nb_p);
     return (FNET_NULL);
 
 NEXT_FRAG:
     fnet_netbuf_free_chain(ip6_nb);
     return (FNET_NULL);    
 }
-#endif /* FNET_CFG_IP4_FRAGMENTATION */
+#endif /* FNET_CFG_IP6_FRAGMENTATION */
 
 /************************************************************************
-* NAME: fnet_ip_timer
+* NAME: fnet_ip6_timer
 *
-* DESCRIPTION: IP timer function.
+* DESCRIPTION: IPv6 timer function.
 *************************************************************************/
 #if FNET_CFG_IP6_FRAGMENTATION
 static void fnet_ip6_timer(void *cookie)
 {
-    fnet_ip6_frag_list_t *frag_list_ptr;
-    fnet_ip6_frag_list_t *tmp_frag_list_ptr;
+    fnet_ip6_frag_list_t    *frag_list_ptr;
+    unsigned long           ttl = fnet_timer_ms2ticks(FNET_IP6_FRAG_TTL);
 
     FNET_COMP_UNUSED_ARG(cookie);
     
     fnet_isr_lock();
-    frag_list_ptr = ip6_frag_list_head;
 
-    while(frag_list_ptr != 0)
+    /* The lists are kept in arrival order, so only the oldest ones may be expired.*/
+    while(((frag_list_ptr = ip6_frag_list_head) != 0) 
+        && (fnet_timer_get_interval(frag_list_ptr->timestamp, fnet_timer_ticks()) >= ttl))
     {
-        frag_list_ptr->ttl--;
-
-        if(frag_list_ptr->ttl == 0)
+        /* If the first fragment (i.e., the one
+         * with a Fragment Offset of zero) has been received, an ICMP Time
+         * Exceeded -- Fragment Reassembly Time Exceeded message should be
+         * sent to the source of that fragment.
+         */
+        if( frag_list_ptr->frag_ptr && (frag_list_ptr->frag_ptr->offset == 0) )
         {
-            /* If the first fragment (i.e., the one
-             * with a Fragment Offset of zero) has been received, an ICMP Time
-             * Exceeded -- Fragment Reassembly Time Exceeded message should be
-             * sent to the source of that fragment.
-             */
-            if( frag_list_ptr->frag_ptr && (frag_list_ptr->frag_ptr->offset == 0) )
+             fnet_netbuf_t              *nb_header;
+             fnet_netbuf_t              *nb;
+             fnet_ip6_header_t          *ip6_header;
+             fnet_ip6_fragment_header_t *ip6_fragment_header;
+            /*************************************
+             * Reconstact PCB for ICMP error.
+             *************************************/         
+            nb_header = fnet_netbuf_new(sizeof(fnet_ip6_header_t) + sizeof(fnet_ip6_fragment_header_t), FNET_FALSE); /* Allocate a new header.*/
+
+            if(nb_header == FNET_NULL)
             {
-                 fnet_netbuf_t              *nb_header;
-                 fnet_netbuf_t              *nb;
-                 fnet_ip6_header_t          *ip6_header;
-                 fnet_ip6_fragment_header_t *ip6_fragment_header;
-                /*************************************
-                 * Reconstact PCB for ICMP error.
-                 *************************************/         
-                nb_header = fnet_netbuf_new(sizeof(fnet_ip6_header_t) + sizeof(fnet_ip6_fragment_header_t), FNET_FALSE); /* Allocate a new header.*/
-
-                if(nb_header == FNET_NULL)
-                {
-                    goto FREE_LIST;
-                }
-                nb = fnet_netbuf_copy(frag_list_ptr->frag_ptr->nb, 0, FNET_NETBUF_COPYALL, 0);
-                if(nb == FNET_NULL)
-                {
-                    fnet_netbuf_free(nb_header);
-                    goto FREE_LIST;                
-                }  
-                
-                nb = fnet_netbuf_concat(nb_header, nb); 
-                
-                ip6_header = nb->data_ptr;
-                ip6_fragment_header = (fnet_ip6_fragment_header_t*)((unsigned long)ip6_header + sizeof(fnet_ip6_header_t));
-                
-                /* IPv6 header.*/
-                ip6_header->version__tclass = FNET_IP6_VERSION<<4; //PFI copy/save header
-                ip6_header->tclass__flowl = 0;
-                ip6_header->flowl = 0;
-                ip6_header->length = frag_list_ptr->hdr_length; 
-                ip6_header->next_header = FNET_IP6_TYPE_FRAGMENT_HEADER;
-                ip6_header->hop_limit = frag_list_ptr->hdr_hop_limit;
-                FNET_IP6_ADDR_COPY(&frag_list_ptr->source_addr, &ip6_header->source_addr);
-                FNET_IP6_ADDR_COPY(&frag_list_ptr->destination_addr, &ip6_header->destination_addr);
-                
-                /* Fragment header.*/
-                
-                ip6_fragment_header->next_header = frag_list_ptr->next_header;
-                ip6_fragment_header->_reserved=0;   
-                ip6_fragment_header->offset_more = fnet_htons(frag_list_ptr->frag_ptr->mf);
-                ip6_fragment_header->id = frag_list_ptr->id;
-                
-                fnet_icmp6_error( frag_list_ptr->netif, FNET_ICMP6_TYPE_TIME_EXCEED, FNET_ICMP6_CODE_TE_FRG_REASSEMBLY, 
-                            0, nb ); //TBD not tested.
+                goto FREE_LIST;
             }
+            nb = fnet_netbuf_copy(frag_list_ptr->frag_ptr->nb, 0, FNET_NETBUF_COPYALL, 0);
+            if(nb == FNET_NULL)
+            {
+                fnet_netbuf_free(nb_header);
+                goto FREE_LIST;                
+            }  
             
-        FREE_LIST:     
-            tmp_frag_list_ptr = frag_list_ptr->next;
-            fnet_ip6_frag_list_free(frag_list_ptr);
-            frag_list_ptr = tmp_frag_list_ptr;
-
+            nb = fnet_netbuf_concat(nb_header, nb); 
+            
+            ip6_header = nb->data_ptr;
+            ip6_fragment_header = (fnet_ip6_fragment_header_t*)((unsigned long)ip6_header + sizeof(fnet_ip6_header_t));
+            
+            /* IPv6 header.*/
+            ip6_header->version__tclass = FNET_IP6_VERSION<<4; //PFI copy/save header
+            ip6_header->tclass__flowl = 0;
+            ip6_header->flowl = 0;
+            ip6_header->length = frag_list_ptr->hdr_length; 
+            ip6_header->next_header = FNET_IP6_TYPE_FRAGMENT_HEADER;
+            ip6_header->hop_limit = frag_list_ptr->hdr_hop_limit;
+            FNET_IP6_ADDR_COPY(&frag_list_ptr->source_addr, &ip6_header->source_addr);
+            FNET_IP6_ADDR_COPY(&frag_list_ptr->destination_addr, &ip6_header->destination_addr);
+            
+            /* Fragment header.*/
+            
+            ip6_fragment_header->next_header = frag_list_ptr->next_header;
+            ip6_fragment_header->_reserved=0;   
+            ip6_fragment_header->offset_more = FNET_HTONS(FNET_IP6_FRAGMENT_MF_MASK);
+            ip6_fragment_header->id = frag_list_ptr->id;
+            
+            fnet_icmp6_error( frag_list_ptr->netif, FNET_ICMP6_TYPE_TIME_EXCEED, FNET_ICMP6_CODE_TE_FRG_REASSEMBLY, 
+                        0, nb ); //TBD not tested.
         }
-        else
-            frag_list_ptr = frag_list_ptr->next;
+        
+    FREE_LIST:
+        fnet_ip6_frag_stats.timeouts++;
+        fnet_ip6_frag_list_free(frag_list_ptr);
     }
 
     fnet_isr_unlock();
@@ -54,6 +54,7 @@
 #include "fnet_ip6.h"
 #include "fnet_netif.h"
 #include "fnet_netif_prv.h"
+#include "fnet_ip_prv.h"
 
 /************************************************************************
 *    Definitions.
@@ -84,7 +85,7 @@
  * fragment of that packet, reassembly of that packet must be
  * abandoned and all the fragments that have been received for that
  * packet must be discarded.*/
-#define FNET_IP6_FRAG_TTL        (60000/FNET_IP6_TIMER_PERIOD) /* TTL for fragments to complete a datagram (60sec)*/
+#define FNET_IP6_FRAG_TTL        (60000) /* Time for fragments to complete a datagram, in ms (60sec)*/
 
 
 /* RFC4484:
@@ -354,12 +355,10 @@ FNET_COMP_PACKED_END
 FNET_COMP_PACKED_BEGIN
 typedef struct fnet_ip6_frag_header
 {
-    unsigned char   mf                        FNET_COMP_PACKED;
-    unsigned short  total_length             FNET_COMP_PACKED;   /**< data-payload total length (Host endian)*/
-    unsigned short  offset                   FNET_COMP_PACKED;   /**< offset field (measured in 8-byte order). (Host endian)*/
-    fnet_netbuf_t   *nb                       FNET_COMP_PACKED;
-    struct fnet_ip6_frag_header *next       FNET_COMP_PACKED;   /**< Pointer to the next fragment.*/
-    struct fnet_ip6_frag_header *prev       FNET_COMP_PACKED;   /**< Pointer to the previous fragment.*/
+    unsigned short  total_length            FNET_COMP_PACKED;   /**< length of the fragment data (Host endian)*/
+    unsigned short  offset                  FNET_COMP_PACKED;   /**< offset of the fragment data, in bytes. (Host endian)*/
+    fnet_netbuf_t   *nb                     FNET_COMP_PACKED;   /**< Fragment net_buf chain.*/
+    struct fnet_ip6_frag_header *next       FNET_COMP_PACKED;   /**< Pointer to the next fragment, in offset order.*/
 } fnet_ip6_frag_header_t;
 FNET_COMP_PACKED_END
 
@@ -370,9 +369,13 @@ FNET_COMP_PACKED_END
 FNET_COMP_PACKED_BEGIN
 typedef struct fnet_ip6_frag_list
 {
-    struct fnet_ip6_frag_list   *next      FNET_COMP_PACKED;   /**< Pointer to the next reassembly list.*/
-    struct fnet_ip6_frag_list   *prev      FNET_COMP_PACKED;   /**< Pointer to the previous reassembly list.*/
-    unsigned char               ttl                 FNET_COMP_PACKED;   /**< TTL for reassembly.*/
+    struct fnet_ip6_frag_list   *next               FNET_COMP_PACKED;   /**< Pointer to the next (younger) reassembly list.*/
+    struct fnet_ip6_frag_list   *prev               FNET_COMP_PACKED;   /**< Pointer to the previous (older) reassembly list.*/
+    struct fnet_ip6_frag_list   *hash_next          FNET_COMP_PACKED;   /**< Pointer to the next reassembly list in the same hash bucket.*/
+    unsigned long               timestamp           FNET_COMP_PACKED;   /**< Arrival time of the first fragment (in timer ticks).*/
+    unsigned long               length              FNET_COMP_PACKED;   /**< Packet data length, known after the last fragment arrival (0 = unknown).*/
+    unsigned long               received            FNET_COMP_PACKED;   /**< Number of the received data bytes (fragments never overlap).*/
+    unsigned long               memory              FNET_COMP_PACKED;   /**< Number of bytes held by the fragments.*/
     unsigned char               next_header         FNET_COMP_PACKED;   /**< protocol.*/
     unsigned long               id                  FNET_COMP_PACKED;   /**< identification.*/
     fnet_ip6_addr_t             source_addr         FNET_COMP_PACKED;   /**< source address.*/
@@ -381,9 +384,15 @@ typedef struct fnet_ip6_frag_list
 	unsigned char               hdr_hop_limit       FNET_COMP_PACKED;							                            
 	fnet_netif_t                *netif;
     fnet_ip6_frag_header_t      *frag_ptr           FNET_COMP_PACKED;   /**< Pointer to the first fragment of the list.*/
+    fnet_ip6_frag_header_t      *frag_last_ptr      FNET_COMP_PACKED;   /**< Pointer to the last fragment of the list.*/
 } fnet_ip6_frag_list_t;
 FNET_COMP_PACKED_END
 
+#if FNET_CFG_IP6_FRAGMENTATION
+    /* IPv6 reassembly counters.*/
+    extern fnet_ip_frag_stats_t fnet_ip6_frag_stats;
+#endif
+
 
 /************************************************************************
 *     Function Prototypes
@@ -398,10 +407,13 @@ int fnet_ip6_common_prefix_length(fnet_ip6_addr_t *ip_addr_1, fnet_ip6_addr_t *i
 unsigned long fnet_ip6_policy_label(fnet_ip6_addr_t *addr);
 const fnet_ip6_addr_t *fnet_ip6_select_src_addr(fnet_netif_t *netif /* Optional.*/, fnet_ip6_addr_t *dest_addr); 
 int fnet_ip6_output(fnet_netif_t *netif /*optional*/, fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip,
-                    unsigned char protocol, unsigned char hop_limit /*optional*/, fnet_netbuf_t *nb, FNET_COMP_PACKED_VAR unsigned short *checksum); 
+                    unsigned char protocol, unsigned char hop_limit /*optional*/, fnet_netbuf_t *nb, FNET_COMP_PACKED_VAR unsigned short *checksum,
+                    fnet_netif_dst_t *dst /*optional*/); 
 void fnet_ip6_drain(void);
 unsigned long fnet_ip6_mtu(fnet_netif_t *netif);      
 fnet_netif_t *fnet_ip6_route(fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip);    
+fnet_netif_t *fnet_ip6_dst_route(fnet_netif_dst_t *dst /*optional*/, fnet_ip6_addr_t *src_ip /*optional*/, fnet_ip6_addr_t *dest_ip);
 int fnet_ip6_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_size);          
+unsigned long fnet_ip6_maximum_packet( fnet_netif_dst_t *dst /*optional*/, fnet_ip6_addr_t *dest_ip );
 
 #endif /* _FNET_IP6_PRV_H_ */
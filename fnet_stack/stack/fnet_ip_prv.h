@@ -94,7 +94,7 @@
 #define FNET_IP_OFFSET_MASK     (0x1fff)    /* mask for fragmenting bits */
 
 #define FNET_IP_TIMER_PERIOD    (500)
-#define FNET_IP_FRAG_TTL        (10000/FNET_IP_TIMER_PERIOD) /* TTL for fragments to complete a datagram (10sec)*/
+#define FNET_IP_FRAG_TTL        (10000) /* Time for fragments to complete a datagram, in ms (10sec)*/
 
 /* Maximum size of IP input queue.*/
 #define FNET_IP_QUEUE_COUNT_MAX (FNET_CFG_IP_MAX_PACKET/2)
@@ -170,18 +170,18 @@ FNET_COMP_PACKED_END
 /**************************************************************************/ /*!
  * @internal
  * @brief    Structure of IP fragment header.
+ *           It overlays the IP header, kept at the beginning of the fragment.
  ******************************************************************************/
 FNET_COMP_PACKED_BEGIN
 typedef struct fnet_ip_frag_header
 {
     unsigned char version__header_length    FNET_COMP_PACKED;   /**< version =4 & header length (x4) (>=5)*/    
-    unsigned char mf                        FNET_COMP_PACKED;
-    unsigned short total_length             FNET_COMP_PACKED;   /**< data-payload total length (Host endian)*/
+    unsigned char tos                       FNET_COMP_PACKED;   /**< type of service */
+    unsigned short total_length             FNET_COMP_PACKED;   /**< length of the fragment data (Host endian)*/
     unsigned short id                       FNET_COMP_PACKED;   /**< identification*/
-    unsigned short offset                   FNET_COMP_PACKED;   /**< offset field (measured in 8-byte order). (Host endian)*/
-    fnet_netbuf_t *nb                       FNET_COMP_PACKED;
-    struct fnet_ip_frag_header *next        FNET_COMP_PACKED;   /**< Pointer to the next fragment.*/
-    struct fnet_ip_frag_header *prev        FNET_COMP_PACKED;   /**< Pointer to the previous fragment.*/
+    unsigned short offset                   FNET_COMP_PACKED;   /**< offset of the fragment data, in bytes. (Host endian)*/
+    fnet_netbuf_t *nb                       FNET_COMP_PACKED;   /**< Fragment net_buf chain.*/
+    struct fnet_ip_frag_header *next        FNET_COMP_PACKED;   /**< Pointer to the next fragment, in offset order.*/
 } fnet_ip_frag_header_t;
 FNET_COMP_PACKED_END
 
@@ -199,14 +199,20 @@ FNET_COMP_PACKED_END
 FNET_COMP_PACKED_BEGIN
 typedef struct fnet_ip_frag_list
 {
-    struct fnet_ip_frag_list *next  FNET_COMP_PACKED;   /**< Pointer to the next reassembly list.*/
-    struct fnet_ip_frag_list *prev  FNET_COMP_PACKED;   /**< Pointer to the previous reassembly list.*/
-    unsigned char ttl               FNET_COMP_PACKED;   /**< TTL for reassembly.*/
-    unsigned char protocol          FNET_COMP_PACKED;   /**< protocol.*/
-    unsigned short id               FNET_COMP_PACKED;   /**< identification.*/
-    fnet_ip4_addr_t source_addr     FNET_COMP_PACKED;   /**< source address.*/
-    fnet_ip4_addr_t desination_addr FNET_COMP_PACKED;   /**< destination address.*/
-    fnet_ip_frag_header_t *frag_ptr FNET_COMP_PACKED;   /**< Pointer to the first fragment of the list.*/
+    struct fnet_ip_frag_list *next      FNET_COMP_PACKED;   /**< Pointer to the next (younger) reassembly list.*/
+    struct fnet_ip_frag_list *prev      FNET_COMP_PACKED;   /**< Pointer to the previous (older) reassembly list.*/
+    struct fnet_ip_frag_list *hash_next FNET_COMP_PACKED;   /**< Pointer to the next reassembly list in the same hash bucket.*/
+    unsigned long timestamp             FNET_COMP_PACKED;   /**< Arrival time of the first fragment (in timer ticks).*/
+    unsigned long length                FNET_COMP_PACKED;   /**< Datagram data length, known after the last fragment arrival (0 = unknown).*/
+    unsigned long received              FNET_COMP_PACKED;   /**< Number of the received data bytes (fragments never overlap).*/
+    unsigned long memory                FNET_COMP_PACKED;   /**< Number of bytes held by the fragments.*/
+    unsigned char ttl                   FNET_COMP_PACKED;   /**< TTL of the first fragment.*/
+    unsigned char protocol              FNET_COMP_PACKED;   /**< protocol.*/
+    unsigned short id                   FNET_COMP_PACKED;   /**< identification.*/
+    fnet_ip4_addr_t source_addr         FNET_COMP_PACKED;   /**< source address.*/
+    fnet_ip4_addr_t desination_addr     FNET_COMP_PACKED;   /**< destination address.*/
+    fnet_ip_frag_header_t *frag_ptr     FNET_COMP_PACKED;   /**< Pointer to the first fragment of the list.*/
+    fnet_ip_frag_header_t *frag_last_ptr FNET_COMP_PACKED;  /**< Pointer to the last fragment of the list.*/
 } fnet_ip_frag_list_t;
 FNET_COMP_PACKED_END
 
@@ -235,6 +241,20 @@ typedef struct                            /* IP input queue.*/
     unsigned long count;                  /* Number of data in buffer.*/
 } fnet_ip_queue_t;
 
+typedef struct                            /* Reassembly counters.*/
+{
+    unsigned long reqds;                  /* Fragments received.*/
+    unsigned long oks;                    /* Datagrams successfully reassembled.*/
+    unsigned long drops;                  /* Fragments discarded (invalid, duplicate or no memory).*/
+    unsigned long timeouts;               /* Datagrams discarded on reassembly timeout.*/
+    unsigned long evictions;              /* Datagrams discarded to keep the reassembly memory limit.*/
+} fnet_ip_frag_stats_t;
+
+#if FNET_CFG_IP4 && FNET_CFG_IP4_FRAGMENTATION
+    /* IPv4 reassembly counters.*/
+    extern fnet_ip_frag_stats_t fnet_ip_frag_stats;
+#endif
+
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
@@ -244,15 +264,16 @@ int fnet_ip_addr_is_broadcast( fnet_ip4_addr_t addr, fnet_netif_t *netif );
 int fnet_ip_output( fnet_netif_t *netif,    fnet_ip4_addr_t src_ip, fnet_ip4_addr_t dest_ip,
                     unsigned char protocol, unsigned char tos,     unsigned char ttl,
                     fnet_netbuf_t *nb,      int DF,  int do_not_route,
-                    FNET_COMP_PACKED_VAR unsigned short *checksum );
+                    FNET_COMP_PACKED_VAR unsigned short *checksum, fnet_netif_dst_t *dst );
 void fnet_ip_input( fnet_netif_t *netif, fnet_netbuf_t *nb );
 fnet_netif_t *fnet_ip_route( fnet_ip4_addr_t dest_ip );
-unsigned long fnet_ip_maximum_packet( fnet_ip4_addr_t dest_ip );
+fnet_netif_t *fnet_ip_dst_route( fnet_netif_dst_t *dst, fnet_ip4_addr_t dest_ip );
+unsigned long fnet_ip_maximum_packet( fnet_netif_dst_t *dst, fnet_ip4_addr_t dest_ip );
 void fnet_ip_drain( void );
 
 int fnet_ip_queue_append( fnet_ip_queue_t *queue, fnet_netif_t *netif, fnet_netbuf_t *nb );
 fnet_netbuf_t *fnet_ip_queue_read( fnet_ip_queue_t *queue, fnet_netif_t ** netif );
-int fnet_ip_will_fragment( fnet_netif_t *netif, unsigned long protocol_message_size);
+int fnet_ip_will_fragment( fnet_netif_t *netif, fnet_netif_dst_t *dst, fnet_ip4_addr_t dest_ip, unsigned long protocol_message_size);
 
 #if FNET_CFG_MULTICAST
     fnet_ip_multicast_list_entry_t *fnet_ip_multicast_join( fnet_netif_t *netif, fnet_ip4_addr_t group_addr );
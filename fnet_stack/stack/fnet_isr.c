@@ -49,6 +49,8 @@
 #include "fnet_isr.h"
 #include "fnet_timer.h"
 #include "fnet_netbuf.h"
+#include "fnet_latency_prv.h"
+#include "fnet_lock_profile_prv.h"
 
 /************************************************************************
 *     Interrupt entry.
@@ -66,8 +68,39 @@ typedef struct fnet_isr_entry
                                                               *  or on SW unlock.*/
     unsigned int            pended;                          /* indicates interrupt pending */
     void                    *cookie;                         /* Handler Cookie. */
+#if FNET_CFG_LATENCY
+    unsigned int            stamped;                         /* timestamp is set by the top half.*/
+    unsigned long           timestamp;                       /* Time of the first not executed top half.*/
+#endif
 } fnet_isr_entry_t;
 
+/* In the stack thread execution model, bottom halves 
+ * are executed by the stack thread only.*/
+#if FNET_CFG_OS_THREAD
+    #define FNET_ISR_BOTTOM_ALLOWED()   (fnet_os_thread_is_self())
+#else
+    #define FNET_ISR_BOTTOM_ALLOWED()   (FNET_TRUE)
+#endif
+
+/* Latency of the bottom half. Its top-half time stamp 
+ * is used to stamp the received net_bufs, until the bottom half ends.*/
+#if FNET_CFG_LATENCY
+    #define FNET_ISR_LATENCY_BOTTOM(isr) \
+        do { \
+            if((isr)->stamped) \
+            { \
+                (isr)->stamped = 0; \
+                fnet_latency_isr_stamp = (isr)->timestamp; \
+                fnet_latency_isr_stamp_valid = FNET_TRUE; \
+                FNET_LATENCY_SINCE(FNET_LATENCY_ISR_BOTTOM, (isr)->timestamp); \
+            } \
+        } while(0)
+    #define FNET_ISR_LATENCY_BOTTOM_END()   (fnet_latency_isr_stamp_valid = FNET_FALSE)
+#else
+    #define FNET_ISR_LATENCY_BOTTOM(isr)    ((void)0)
+    #define FNET_ISR_LATENCY_BOTTOM_END()   ((void)0)
+#endif
+
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
@@ -82,6 +115,11 @@ static fnet_isr_entry_t *fnet_isr_table = 0;
 
 static fnet_event_desc_t fnet_event_desc_last = FNET_EVENT_VECTOR_NUMBER;
 
+#if FNET_CFG_LOCK_PROFILE
+static fnet_lock_profile_entry_t *fnet_isr_lock_owner;   /* Call site of the outermost lock.*/
+static unsigned long fnet_isr_lock_stamp;                /* Time of the outermost lock.*/
+#endif
+
 /************************************************************************
 * NAME: fnet_isr_handler
 *
@@ -106,9 +144,22 @@ void fnet_isr_handler( int vector_number )
     {
         if(isr_cur->vector_number == vector_number) /* we got it. */
         {
+        #if FNET_CFG_LATENCY
+            if(isr_cur->stamped == 0)
+            {
+                isr_cur->timestamp = FNET_LATENCY_STAMP();
+                isr_cur->stamped = 1;
+            }
+        #endif
+
             if(isr_cur->handler_top)
                 isr_cur->handler_top(isr_cur->cookie);         /* Call "top half" handler; */
 
+        #if FNET_CFG_OS_THREAD
+            /* Defer it to the stack thread.*/
+            isr_cur->pended = 1;
+            fnet_os_thread_signal_isr();
+        #else
             if(fnet_locked)
             {
                 isr_cur->pended = 1;
@@ -116,10 +167,14 @@ void fnet_isr_handler( int vector_number )
             else
             {
                 isr_cur->pended = 0;
+                FNET_ISR_LATENCY_BOTTOM(isr_cur);
 
                 if(isr_cur->handler_bottom)
                     isr_cur->handler_bottom(isr_cur->cookie); /* Call "bottom half" handler;*/
+
+                FNET_ISR_LATENCY_BOTTOM_END();
             }
+        #endif
 
             break;
         }
@@ -186,6 +241,9 @@ static int fnet_isr_register( unsigned int vector_number, void (*handler_top)(vo
         isr_temp->next = fnet_isr_table;
         isr_temp->pended = 0;
         isr_temp->cookie = cookie;
+    #if FNET_CFG_LATENCY
+        isr_temp->stamped = 0;
+    #endif
         fnet_isr_table = isr_temp;
         
         result = FNET_OK;
@@ -245,6 +303,26 @@ void fnet_isr_vector_release( unsigned int vector_number)
     }
 }
 
+#if FNET_CFG_LOCK_PROFILE
+/************************************************************************
+* NAME: fnet_isr_lock_site
+*
+* DESCRIPTION: Profiled fnet_isr_lock(). Counts the lock of the call site
+*              and stamps the outermost lock.
+*************************************************************************/
+void fnet_isr_lock_site( const char *file, int line )
+{
+    fnet_lock_profile_entry_t *entry = fnet_lock_profile_lock(file, line);
+
+    fnet_locked++;
+
+    if(fnet_locked == 1)
+    {
+        fnet_isr_lock_owner = entry;
+        fnet_isr_lock_stamp = FNET_LOCK_PROFILE_STAMP();
+    }
+}
+#else
 /************************************************************************
 * NAME: fnet_isr_lock
 *
@@ -255,6 +333,7 @@ void fnet_isr_lock( void )
 {
     fnet_locked++;
 }
+#endif /* FNET_CFG_LOCK_PROFILE */
 
 /************************************************************************
 * NAME: fnet_isr_unlock
@@ -300,6 +379,18 @@ void fnet_isr_unlock( void )
 void fnet_isr_unlock( void )
 {
     fnet_isr_entry_t *isr_temp;
+#if FNET_CFG_LOCK_PROFILE
+    fnet_lock_profile_entry_t   *owner = FNET_NULL;
+    unsigned long               stamp = 0;
+    int                         bottom = FNET_FALSE;
+
+    if((fnet_locked == 1) && fnet_isr_lock_owner) /* Release of the outermost lock.*/
+    {
+        owner = fnet_isr_lock_owner;
+        stamp = FNET_LOCK_PROFILE_STAMP();
+        fnet_lock_profile_add(&owner->hold, stamp - fnet_isr_lock_stamp);
+    }
+#endif
 	
 	/* This function operates as follows:
     * If local global "fnet_locked" == 0 then it simply returns.
@@ -312,7 +403,7 @@ void fnet_isr_unlock( void )
         
     --fnet_locked;
 
-    if(fnet_locked == 0)
+    if((fnet_locked == 0) && FNET_ISR_BOTTOM_ALLOWED())
     {
         isr_temp = fnet_isr_table;
 
@@ -321,14 +412,26 @@ void fnet_isr_unlock( void )
             if(isr_temp->pended)
             {
                 isr_temp->pended = 0;
+                FNET_ISR_LATENCY_BOTTOM(isr_temp);
+            #if FNET_CFG_LOCK_PROFILE
+                bottom = FNET_TRUE;
+            #endif
 
                 if(isr_temp->handler_bottom)
                     isr_temp->handler_bottom(isr_temp->cookie);
+
+                FNET_ISR_LATENCY_BOTTOM_END();
             }
 
             isr_temp = isr_temp->next;
         }
     }
+
+#if FNET_CFG_LOCK_PROFILE
+    /* Bottom halves, executed by the release.*/
+    if(bottom && owner)
+        fnet_lock_profile_add(&owner->bottom, FNET_LOCK_PROFILE_STAMP() - stamp);
+#endif
 }
 #endif
 
@@ -353,7 +456,7 @@ void fnet_event_raise( fnet_event_desc_t event_number )
             if(isr_temp->handler_top)
                 isr_temp->handler_top(isr_temp->cookie);
 
-            if(fnet_locked == 1)
+            if((fnet_locked == 1) && FNET_ISR_BOTTOM_ALLOWED())
             {
                 isr_temp->pended = 0;
 
@@ -361,7 +464,12 @@ void fnet_event_raise( fnet_event_desc_t event_number )
                     isr_temp->handler_bottom(isr_temp->cookie);
             }
             else
+            {
                 isr_temp->pended = 1;
+            #if FNET_CFG_OS_THREAD
+                fnet_os_thread_signal();
+            #endif
+            }
 
             break;
         }
@@ -372,6 +480,31 @@ void fnet_event_raise( fnet_event_desc_t event_number )
     fnet_isr_unlock();
 }
 
+/************************************************************************
+* NAME: fnet_event_pend
+*
+* DESCRIPTION: This function pends registered event. Unlike 
+*              fnet_event_raise(), the event is never executed at once,
+*              but by the next release of the outermost lock.
+*************************************************************************/
+void fnet_event_pend( fnet_event_desc_t event_number )
+{
+    unsigned int        vector_number = (unsigned int)(event_number);
+    fnet_isr_entry_t    *isr_temp;
+
+    for(isr_temp = fnet_isr_table; isr_temp; isr_temp = isr_temp->next)
+    {
+        if(isr_temp->vector_number == vector_number)
+        {
+            isr_temp->pended = 1;
+        #if FNET_CFG_OS_THREAD
+            fnet_os_thread_signal();
+        #endif
+            break;
+        }
+    }
+}
+
 /************************************************************************
 * NAME: fnet_isr_init
 *
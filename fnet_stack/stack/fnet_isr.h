@@ -60,9 +60,16 @@ typedef long fnet_event_desc_t;
 *************************************************************************/
 int fnet_isr_vector_init( unsigned int vector_number, void (*handler_top)(void *cookie), void (*handler_bottom)(void *cookie), unsigned int priority, void *cookie );
 fnet_event_desc_t fnet_event_init(void (*event_handler)(void *cookie), void *cookie);
-void fnet_event_raise(fnet_event_desc_t event_number);                                   
+void fnet_event_raise(fnet_event_desc_t event_number);
+void fnet_event_pend(fnet_event_desc_t event_number);                                   
 void fnet_isr_vector_release(unsigned int vector_number);
-void fnet_isr_lock(void);
+#if FNET_CFG_LOCK_PROFILE
+    /* Profiled lock, records its call site.*/
+    void fnet_isr_lock_site(const char *file, int line);
+    #define fnet_isr_lock()     fnet_isr_lock_site(__FILE__, __LINE__)
+#else
+    void fnet_isr_lock(void);
+#endif
 void fnet_isr_unlock(void);
 void fnet_isr_init(void);
 void fnet_isr_handler(int vector_number);
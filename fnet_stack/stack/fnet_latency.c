@@ -0,0 +1,203 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_latency.c
+*
+* @author Andrey Butok
+*
+* @brief FNET latency histograms.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_LATENCY
+
+#include "fnet_latency_prv.h"
+#include "fnet_isr.h"
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+typedef struct
+{
+    unsigned long   max;
+    unsigned long   histogram[FNET_LATENCY_BUCKETS];
+} fnet_latency_stage_stats_t;
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static unsigned long fnet_latency_percentile( const struct fnet_latency_stats *stats, unsigned long percent );
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+unsigned long fnet_latency_isr_stamp;
+int fnet_latency_isr_stamp_valid;
+
+static fnet_latency_stage_stats_t fnet_latency_stats[FNET_LATENCY_STAGES];
+
+/************************************************************************
+* NAME: fnet_latency_init
+*
+* DESCRIPTION: Starts the counter and resets the histograms.
+*************************************************************************/
+void fnet_latency_init( void )
+{
+    FNET_CFG_LATENCY_CYCLES_INIT();
+    fnet_latency_clear();
+}
+
+/************************************************************************
+* NAME: fnet_latency_add
+*
+* DESCRIPTION: Adds a value to the histogram of the stage.
+*              Its bucket is the index of the highest set bit.
+*************************************************************************/
+void fnet_latency_add( fnet_latency_stage_t stage, unsigned long cycles )
+{
+    fnet_latency_stage_stats_t  *stats = &fnet_latency_stats[stage];
+    unsigned long               value = cycles;
+    int                         bucket = 0;
+
+    if(value & 0xFFFF0000UL) { value >>= 16; bucket += 16; }
+    if(value & 0xFF00UL)     { value >>= 8;  bucket += 8; }
+    if(value & 0xF0UL)       { value >>= 4;  bucket += 4; }
+    if(value & 0xCUL)        { value >>= 2;  bucket += 2; }
+    if(value & 0x2UL)        { bucket += 1; }
+
+    stats->histogram[bucket]++;
+
+    if(cycles > stats->max)
+        stats->max = cycles;
+}
+
+/************************************************************************
+* NAME: fnet_latency_percentile
+*
+* DESCRIPTION: Returns the upper bound of the bucket, 
+*              which contains the percentile.
+*************************************************************************/
+static unsigned long fnet_latency_percentile( const struct fnet_latency_stats *stats, unsigned long percent )
+{
+    unsigned long   sum = 0;
+    unsigned long   rank;
+    unsigned long   result;
+    int             i;
+
+    if(stats->count == 0)
+        return 0;
+
+    /* Rank of the percentile, rounded up. Without overflow of count*percent.*/
+    rank = (stats->count / 100) * percent + ((stats->count % 100) * percent + 99) / 100;
+
+    for(i = 0; i < FNET_LATENCY_BUCKETS; i++)
+    {
+        sum += stats->histogram[i];
+        if(sum >= rank)
+            break;
+    }
+
+    result = (i >= (FNET_LATENCY_BUCKETS - 1)) ? 0xFFFFFFFFUL : ((2UL << i) - 1);
+
+    return (result > stats->max) ? stats->max : result;
+}
+
+/************************************************************************
+* NAME: fnet_latency_get
+*
+* DESCRIPTION: Returns the latency of the stage.
+*************************************************************************/
+int fnet_latency_get( fnet_latency_stage_t stage, struct fnet_latency_stats *stats )
+{
+    int i;
+
+    if((stats == 0) || ((unsigned int)stage >= FNET_LATENCY_STAGES))
+        return FNET_ERR;
+
+    fnet_isr_lock();
+
+    stats->max = fnet_latency_stats[stage].max;
+    fnet_memcpy(stats->histogram, fnet_latency_stats[stage].histogram, sizeof(stats->histogram));
+
+    fnet_isr_unlock();
+
+    stats->count = 0;
+    for(i = 0; i < FNET_LATENCY_BUCKETS; i++)
+        stats->count += stats->histogram[i];
+
+    stats->p50 = fnet_latency_percentile(stats, 50);
+    stats->p99 = fnet_latency_percentile(stats, 99);
+
+    return FNET_OK;
+}
+
+/************************************************************************
+* NAME: fnet_latency_clear
+*
+* DESCRIPTION: Resets all histograms.
+*************************************************************************/
+void fnet_latency_clear( void )
+{
+    fnet_isr_lock();
+
+    fnet_memset_zero(fnet_latency_stats, sizeof(fnet_latency_stats));
+
+    fnet_isr_unlock();
+}
+
+#else /* FNET_CFG_LATENCY */
+
+/************************************************************************
+* NAME: fnet_latency_get
+*
+* DESCRIPTION: The histograms are disabled.
+*************************************************************************/
+int fnet_latency_get( fnet_latency_stage_t stage, struct fnet_latency_stats *stats )
+{
+    FNET_COMP_UNUSED_ARG(stage);
+    FNET_COMP_UNUSED_ARG(stats);
+
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fnet_latency_clear
+*
+* DESCRIPTION: The histograms are disabled.
+*************************************************************************/
+void fnet_latency_clear( void )
+{
+}
+
+#endif /* FNET_CFG_LATENCY */
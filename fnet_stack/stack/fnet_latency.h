@@ -0,0 +1,133 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_latency.h
+*
+* @author Andrey Butok
+*
+* @brief FNET latency histograms API.
+*
+***************************************************************************/
+
+#ifndef _FNET_LATENCY_H_
+
+#define _FNET_LATENCY_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_latency
+* The Latency API gives the distribution of the time spent by the packets
+* on their way through the stack. @n
+* It is available only if @ref FNET_CFG_LATENCY is set to @c 1. @n
+* A received packet is stamped by the interrupt top half that signalled it.
+* Packets, received outside of an interrupt bottom half (by a driver thread 
+* or a driver poll service), are not stamped and not measured. @n
+* A sent packet is stamped by its transport layer (TCP or UDP). 
+* Every following stage adds the time elapsed since the stamp 
+* to its histogram, so the difference between two stages 
+* is the time spent between them. @n
+* The time is counted by @ref FNET_CFG_LATENCY_CYCLES. 
+* The histograms have log2 buckets, so their percentiles are the upper 
+* bounds of the buckets, less than twice the exact value.
+*/
+
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Measured stages.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_LATENCY_ISR_BOTTOM = 0,    /**< @brief Start of an interrupt bottom half, 
+                                     * since its top half (all interrupts).*/
+    FNET_LATENCY_RX_ETH = 1,        /**< @brief @c fnet_eth_prot_input(), since the top half.*/
+    FNET_LATENCY_RX_IP = 2,         /**< @brief @c fnet_ip_input() or @c fnet_ip6_input(), since the top half.*/
+    FNET_LATENCY_RX_IP_LOW = 3,     /**< @brief IP input, after the IP input queue, since the top half.*/
+    FNET_LATENCY_RX_TCP = 4,        /**< @brief @c fnet_tcp_input(), since the top half.*/
+    FNET_LATENCY_RX_UDP = 5,        /**< @brief @c fnet_udp_input(), since the top half.*/
+    FNET_LATENCY_RX_SOCKET = 6,     /**< @brief Appended to the socket receive buffer, since the top half.*/
+    FNET_LATENCY_TX_SEND = 7,       /**< @brief Duration of the @ref sendto() or @ref send() call.*/
+    FNET_LATENCY_TX_IP = 8,         /**< @brief IP output, since the transport layer.*/
+    FNET_LATENCY_TX_ETH = 9,        /**< @brief @c fnet_eth_output_low(), since the transport layer.*/
+    FNET_LATENCY_TX_DRIVER = 10     /**< @brief Handed over to the driver, since the transport layer.*/
+} fnet_latency_stage_t;
+
+/**************************************************************************/ /*!
+ * @brief Number of the measured stages.
+ ******************************************************************************/
+#define FNET_LATENCY_STAGES     (11)
+
+/**************************************************************************/ /*!
+ * @brief Number of the histogram buckets. 
+ * The bucket @c n counts the values from 2^n to 2^(n+1)-1.
+ ******************************************************************************/
+#define FNET_LATENCY_BUCKETS    (32)
+
+/**************************************************************************/ /*!
+ * @brief Latency of a stage, returned by the @ref fnet_latency_get(). @n
+ * The times are in the @ref FNET_CFG_LATENCY_CYCLES counts.
+ ******************************************************************************/
+struct fnet_latency_stats
+{
+    unsigned long   count;  /**< @brief Number of the measured packets.*/
+    unsigned long   p50;    /**< @brief Median (upper bound of its bucket).*/
+    unsigned long   p99;    /**< @brief 99th percentile (upper bound of its bucket).*/
+    unsigned long   max;    /**< @brief Maximum.*/
+    unsigned long   histogram[FNET_LATENCY_BUCKETS]; /**< @brief Log2 histogram.*/
+};
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the latency of a stage.
+ *
+ * @param stage   Stage, defined by @ref fnet_latency_stage_t.
+ *
+ * @param stats   Structure that receives the latency.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the @c stage is invalid, or the histograms 
+ *          are disabled by @ref FNET_CFG_LATENCY.
+ *
+ ******************************************************************************/
+int fnet_latency_get( fnet_latency_stage_t stage, struct fnet_latency_stats *stats );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Resets all histograms.
+ *
+ ******************************************************************************/
+void fnet_latency_clear( void );
+
+/*! @} */
+
+#endif /* _FNET_LATENCY_H_ */
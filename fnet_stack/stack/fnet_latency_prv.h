@@ -0,0 +1,98 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_latency_prv.h
+*
+* @author Andrey Butok
+*
+* @brief Private. FNET latency histograms.
+*
+***************************************************************************/
+
+#ifndef _FNET_LATENCY_PRV_H_
+
+#define _FNET_LATENCY_PRV_H_
+
+#include "fnet_config.h"
+#include "fnet_latency.h"
+#include "fnet_netbuf.h"
+
+#if FNET_CFG_LATENCY
+
+/************************************************************************
+*     Global Data Structures
+*************************************************************************/
+/* Top-half time stamp of the interrupt, whose bottom half is executed.
+ * It is valid only during the bottom half.*/
+extern unsigned long fnet_latency_isr_stamp;
+extern int fnet_latency_isr_stamp_valid;
+
+#define FNET_LATENCY_STAMP()    FNET_CFG_LATENCY_CYCLES()
+
+/* Stamps a received net_buf by the interrupt top half. 
+ * Frames, received outside of a bottom half (by a driver thread 
+ * or poll), have no valid stamp and are not measured.*/
+#define FNET_LATENCY_RX_STAMP(nb) \
+    (fnet_latency_isr_stamp_valid ? \
+        ((nb)->timestamp = fnet_latency_isr_stamp, (nb)->flags = ((nb)->flags & ~FNET_NETBUF_FLAG_TX_TIMESTAMP) | FNET_NETBUF_FLAG_RX_TIMESTAMP) : \
+        ((nb)->flags &= ~(FNET_NETBUF_FLAG_TX_TIMESTAMP | FNET_NETBUF_FLAG_RX_TIMESTAMP)))
+
+/* Stamps a sent net_buf by its transport layer.*/
+#define FNET_LATENCY_TX_STAMP(nb) \
+    ((nb)->timestamp = FNET_LATENCY_STAMP(), (nb)->flags = ((nb)->flags & ~FNET_NETBUF_FLAG_RX_TIMESTAMP) | FNET_NETBUF_FLAG_TX_TIMESTAMP)
+
+/* Adds the time since the stamp of a received/sent net_buf.*/
+#define FNET_LATENCY_RX(stage, nb) \
+    (((nb)->flags & FNET_NETBUF_FLAG_RX_TIMESTAMP) ? fnet_latency_add((stage), FNET_LATENCY_STAMP() - (nb)->timestamp) : (void)0)
+#define FNET_LATENCY_TX(stage, nb) \
+    (((nb)->flags & FNET_NETBUF_FLAG_TX_TIMESTAMP) ? fnet_latency_add((stage), FNET_LATENCY_STAMP() - (nb)->timestamp) : (void)0)
+
+/* Adds the time since the stamp.*/
+#define FNET_LATENCY_SINCE(stage, stamp)    fnet_latency_add((stage), FNET_LATENCY_STAMP() - (stamp))
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+void fnet_latency_init( void );
+void fnet_latency_add( fnet_latency_stage_t stage, unsigned long cycles );
+
+#else
+
+#define FNET_LATENCY_RX_STAMP(nb)           ((void)0)
+#define FNET_LATENCY_TX_STAMP(nb)           ((void)0)
+#define FNET_LATENCY_RX(stage, nb)          ((void)0)
+#define FNET_LATENCY_TX(stage, nb)          ((void)0)
+#define fnet_latency_init()                 ((void)0)
+
+#endif /* FNET_CFG_LATENCY */
+
+#endif /* _FNET_LATENCY_PRV_H_ */
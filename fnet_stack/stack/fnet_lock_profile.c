@@ -0,0 +1,353 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_lock_profile.c
+*
+* @author Andrey Butok
+*
+* @brief FNET lock profiler.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_LOCK_PROFILE
+
+#include "fnet_lock_profile_prv.h"
+#include "fnet_os.h"
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_LOCK_PROFILE_SITES_MASK    (FNET_CFG_LOCK_PROFILE_SITES - 1)
+
+#if (FNET_CFG_LOCK_PROFILE_SITES & FNET_LOCK_PROFILE_SITES_MASK)
+    #error "FNET_CFG_LOCK_PROFILE_SITES must be a power of two."
+#endif
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static fnet_lock_profile_entry_t *fnet_lock_profile_find( const char *file, int line );
+static void fnet_lock_profile_sum( fnet_lock_profile_sum_t *sum, unsigned long cycles );
+static void fnet_lock_profile_time( struct fnet_lock_profile_time *time, const fnet_lock_profile_sum_t *sum );
+static unsigned long fnet_lock_profile_key( const struct fnet_lock_profile_site *site, fnet_lock_profile_sort_t sort );
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+static fnet_lock_profile_entry_t fnet_lock_profile_table[FNET_CFG_LOCK_PROFILE_SITES];
+static fnet_lock_profile_entry_t fnet_lock_profile_other; /* Call sites, which do not fit into the table.*/
+
+/************************************************************************
+* NAME: fnet_lock_profile_init
+*
+* DESCRIPTION: Starts the counter and resets the records.
+*************************************************************************/
+void fnet_lock_profile_init( void )
+{
+    FNET_CFG_LATENCY_CYCLES_INIT();
+    fnet_lock_profile_clear();
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_find
+*
+* DESCRIPTION: Returns the record of the call site. Adds it, if it is new.
+*              The table is open-addressed. Interrupts must be disabled.
+*************************************************************************/
+static fnet_lock_profile_entry_t *fnet_lock_profile_find( const char *file, int line )
+{
+    fnet_lock_profile_entry_t   *entry;
+    unsigned long               index = ((unsigned long)file + (unsigned long)line * 31) & FNET_LOCK_PROFILE_SITES_MASK;
+    int                         i;
+
+    for(i = 0; i < FNET_CFG_LOCK_PROFILE_SITES; i++)
+    {
+        entry = &fnet_lock_profile_table[index];
+
+        if(entry->file == 0) /* Free.*/
+        {
+            entry->file = file;
+            entry->line = (unsigned long)line;
+            return entry;
+        }
+
+        if((entry->file == file) && (entry->line == (unsigned long)line))
+            return entry;
+
+        index = (index + 1) & FNET_LOCK_PROFILE_SITES_MASK;
+    }
+
+    return &fnet_lock_profile_other;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_sum
+*
+* DESCRIPTION: Adds the interval to the sum. Interrupts must be disabled.
+*************************************************************************/
+static void fnet_lock_profile_sum( fnet_lock_profile_sum_t *sum, unsigned long cycles )
+{
+    sum->count++;
+
+    if(cycles > sum->max)
+        sum->max = cycles;
+
+    sum->total_low += cycles;
+    if(sum->total_low < cycles) /* Carry.*/
+        sum->total_high++;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_lock
+*
+* DESCRIPTION: Counts the lock acquisition of the call site.
+*              Returns its record.
+*************************************************************************/
+fnet_lock_profile_entry_t *fnet_lock_profile_lock( const char *file, int line )
+{
+    fnet_lock_profile_entry_t   *entry;
+    fnet_cpu_irq_desc_t         irq_desc;
+
+    irq_desc = fnet_cpu_irq_disable();
+
+    entry = fnet_lock_profile_find(file, line);
+    entry->locks++;
+
+    fnet_cpu_irq_enable(irq_desc);
+
+    return entry;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_add
+*
+* DESCRIPTION: Adds the interval to the sum of a record.
+*************************************************************************/
+void fnet_lock_profile_add( fnet_lock_profile_sum_t *sum, unsigned long cycles )
+{
+    fnet_cpu_irq_desc_t irq_desc;
+
+    irq_desc = fnet_cpu_irq_disable();
+
+    fnet_lock_profile_sum(sum, cycles);
+
+    fnet_cpu_irq_enable(irq_desc);
+}
+
+#if FNET_CFG_OS_MUTEX
+/************************************************************************
+* NAME: fnet_os_mutex_lock_site
+*
+* DESCRIPTION: Takes the OS mutex and adds the wait time 
+*              to the record of the call site.
+*************************************************************************/
+#undef fnet_os_mutex_lock /* The OS port function.*/
+
+void fnet_os_mutex_lock_site( const char *file, int line )
+{
+    unsigned long       stamp;
+    fnet_cpu_irq_desc_t irq_desc;
+
+    stamp = FNET_LOCK_PROFILE_STAMP();
+
+    fnet_os_mutex_lock();
+
+    stamp = FNET_LOCK_PROFILE_STAMP() - stamp;
+
+    irq_desc = fnet_cpu_irq_disable();
+
+    fnet_lock_profile_sum(&fnet_lock_profile_find(file, line)->wait, stamp);
+
+    fnet_cpu_irq_enable(irq_desc);
+}
+#endif /* FNET_CFG_OS_MUTEX */
+
+/************************************************************************
+* NAME: fnet_lock_profile_time
+*
+* DESCRIPTION: Converts the sum. Its total is divided by 
+*              FNET_CFG_LATENCY_CYCLES_PER_US 16 bits at a time, 
+*              without the 64-bit arithmetic. 
+*              The divisor must be less than 2^16.
+*************************************************************************/
+static void fnet_lock_profile_time( struct fnet_lock_profile_time *time, const fnet_lock_profile_sum_t *sum )
+{
+    unsigned long   digits;
+    unsigned long   quotient;
+
+    time->count = sum->count;
+    time->max = sum->max;
+
+    if(sum->total_high >= FNET_CFG_LATENCY_CYCLES_PER_US)
+    {
+        time->total_us = 0xFFFFFFFFUL; /* Saturated.*/
+    }
+    else
+    {
+        digits = (sum->total_high << 16) | (sum->total_low >> 16);
+        quotient = digits / FNET_CFG_LATENCY_CYCLES_PER_US;
+        digits = ((digits % FNET_CFG_LATENCY_CYCLES_PER_US) << 16) | (sum->total_low & 0xFFFFUL);
+
+        time->total_us = (quotient << 16) + digits / FNET_CFG_LATENCY_CYCLES_PER_US;
+    }
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_key
+*
+* DESCRIPTION: Returns the sort key of the record.
+*************************************************************************/
+static unsigned long fnet_lock_profile_key( const struct fnet_lock_profile_site *site, fnet_lock_profile_sort_t sort )
+{
+    unsigned long result;
+
+    switch(sort)
+    {
+        case FNET_LOCK_PROFILE_SORT_HOLD_MAX:
+            result = site->hold.max;
+            break;
+        case FNET_LOCK_PROFILE_SORT_BOTTOM_TOTAL:
+            result = site->bottom.total_us;
+            break;
+        case FNET_LOCK_PROFILE_SORT_WAIT_TOTAL:
+            result = site->wait.total_us;
+            break;
+        case FNET_LOCK_PROFILE_SORT_HOLD_TOTAL:
+        default:
+            result = site->hold.total_us;
+            break;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_get
+*
+* DESCRIPTION: Returns the records, sorted in descending order.
+*              They are insertion sorted into the array, 
+*              the ones beyond its end are dropped.
+*************************************************************************/
+int fnet_lock_profile_get( struct fnet_lock_profile_site *sites, int n, fnet_lock_profile_sort_t sort )
+{
+    fnet_lock_profile_entry_t       entry;
+    struct fnet_lock_profile_site   site;
+    unsigned long                   key;
+    fnet_cpu_irq_desc_t             irq_desc;
+    int                             count = 0;
+    int                             i;
+    int                             j;
+
+    if((sites == 0) || (n <= 0))
+        return 0;
+
+    for(i = 0; i <= FNET_CFG_LOCK_PROFILE_SITES; i++)
+    {
+        irq_desc = fnet_cpu_irq_disable();
+        entry = (i < FNET_CFG_LOCK_PROFILE_SITES) ? fnet_lock_profile_table[i] : fnet_lock_profile_other;
+        fnet_cpu_irq_enable(irq_desc);
+
+        if((entry.locks == 0) && (entry.wait.count == 0))
+            continue; /* Not used.*/
+
+        site.file = (i < FNET_CFG_LOCK_PROFILE_SITES) ? entry.file : 0;
+        site.line = entry.line;
+        site.locks = entry.locks;
+        fnet_lock_profile_time(&site.hold, &entry.hold);
+        fnet_lock_profile_time(&site.bottom, &entry.bottom);
+        fnet_lock_profile_time(&site.wait, &entry.wait);
+
+        key = fnet_lock_profile_key(&site, sort);
+
+        for(j = count; (j > 0) && (fnet_lock_profile_key(&sites[j - 1], sort) < key); j--)
+        {
+            if(j < n)
+                sites[j] = sites[j - 1];
+        }
+
+        if(j < n)
+        {
+            sites[j] = site;
+
+            if(count < n)
+                count++;
+        }
+    }
+
+    return count;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_clear
+*
+* DESCRIPTION: Resets all records.
+*************************************************************************/
+void fnet_lock_profile_clear( void )
+{
+    fnet_cpu_irq_desc_t irq_desc;
+
+    irq_desc = fnet_cpu_irq_disable();
+
+    fnet_memset_zero(fnet_lock_profile_table, sizeof(fnet_lock_profile_table));
+    fnet_memset_zero(&fnet_lock_profile_other, sizeof(fnet_lock_profile_other));
+
+    fnet_cpu_irq_enable(irq_desc);
+}
+
+#else /* FNET_CFG_LOCK_PROFILE */
+
+/************************************************************************
+* NAME: fnet_lock_profile_get
+*
+* DESCRIPTION: The profiler is disabled.
+*************************************************************************/
+int fnet_lock_profile_get( struct fnet_lock_profile_site *sites, int n, fnet_lock_profile_sort_t sort )
+{
+    FNET_COMP_UNUSED_ARG(sites);
+    FNET_COMP_UNUSED_ARG(n);
+    FNET_COMP_UNUSED_ARG(sort);
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fnet_lock_profile_clear
+*
+* DESCRIPTION: The profiler is disabled.
+*************************************************************************/
+void fnet_lock_profile_clear( void )
+{
+}
+
+#endif /* FNET_CFG_LOCK_PROFILE */
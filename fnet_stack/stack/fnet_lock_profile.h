@@ -0,0 +1,140 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_lock_profile.h
+*
+* @author Andrey Butok
+*
+* @brief FNET lock profiler API.
+*
+***************************************************************************/
+
+#ifndef _FNET_LOCK_PROFILE_H_
+
+#define _FNET_LOCK_PROFILE_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_lock_profile
+* The Lock Profiler API shows, how long the stack is locked and by whom. @n
+* It is available only if @ref FNET_CFG_LOCK_PROFILE is set to @c 1. 
+* It is an instrumented build mode, so all code using the stack 
+* lock must be recompiled. @n
+* Every call site of the stack lock (@c fnet_isr_lock()) and 
+* of the OS mutex (@c fnet_os_mutex_lock(), if @ref FNET_CFG_OS_MUTEX is @c 1) 
+* has its own record, identified by its source file and line. It counts:
+*   - the lock acquisitions, including the nested ones.
+*   - the hold time of the outermost lock, until its release.
+*   - the time spent by the release, executing the interrupt bottom halves
+*     pended while the lock was held.
+*   - the time spent waiting for the OS mutex.
+*
+* The time is counted by @ref FNET_CFG_LATENCY_CYCLES.
+* The @ref fnet_lock_profile_get() returns the records sorted 
+* by the selected time.
+*/
+
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Sort order of the @ref fnet_lock_profile_get() records.
+ * The records are sorted in descending order.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_LOCK_PROFILE_SORT_HOLD_TOTAL = 0,  /**< @brief By the total hold time.*/
+    FNET_LOCK_PROFILE_SORT_HOLD_MAX = 1,    /**< @brief By the longest hold.*/
+    FNET_LOCK_PROFILE_SORT_BOTTOM_TOTAL = 2,/**< @brief By the total time of the bottom halves.*/
+    FNET_LOCK_PROFILE_SORT_WAIT_TOTAL = 3   /**< @brief By the total OS mutex wait time.*/
+} fnet_lock_profile_sort_t;
+
+/**************************************************************************/ /*!
+ * @brief Measured time intervals.
+ ******************************************************************************/
+struct fnet_lock_profile_time
+{
+    unsigned long   count;      /**< @brief Number of the intervals.*/
+    unsigned long   max;        /**< @brief Longest interval, in the @ref FNET_CFG_LATENCY_CYCLES counts.*/
+    unsigned long   total_us;   /**< @brief Sum of the intervals, in microseconds.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Lock call site record, returned by the @ref fnet_lock_profile_get().
+ ******************************************************************************/
+struct fnet_lock_profile_site
+{
+    const char                      *file;  /**< @brief Source file of the call site. @n
+                                             * It is @c 0 for the call sites, 
+                                             * which did not fit into the table 
+                                             * (@ref FNET_CFG_LOCK_PROFILE_SITES).*/
+    unsigned long                   line;   /**< @brief Source line of the call site.*/
+    unsigned long                   locks;  /**< @brief Number of the @c fnet_isr_lock() calls, 
+                                             * including the nested ones.*/
+    struct fnet_lock_profile_time   hold;   /**< @brief Hold time of the outermost stack lock. 
+                                             * It does not include the bottom halves.*/
+    struct fnet_lock_profile_time   bottom; /**< @brief Interrupt bottom halves, executed 
+                                             * by the release of the outermost stack lock.*/
+    struct fnet_lock_profile_time   wait;   /**< @brief Wait for the OS mutex.*/
+};
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the call site records, sorted in descending order.
+ *
+ * @param sites   Array that receives the records.
+ *
+ * @param n       Size of the @c sites array.
+ *
+ * @param sort    Sort order, defined by @ref fnet_lock_profile_sort_t.
+ *
+ * @return This function returns the number of the retrieved records, 
+ *         up to @c n. @n
+ *         It is @c 0 if the profiler is disabled by @ref FNET_CFG_LOCK_PROFILE.
+ *
+ ******************************************************************************
+ *
+ * If there are more records than @c n, the first @c n records 
+ * of the sort order are retrieved.
+ *
+ ******************************************************************************/
+int fnet_lock_profile_get( struct fnet_lock_profile_site *sites, int n, fnet_lock_profile_sort_t sort );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Resets all call site records.
+ *
+ ******************************************************************************/
+void fnet_lock_profile_clear( void );
+
+/*! @} */
+
+#endif /* _FNET_LOCK_PROFILE_H_ */
@@ -0,0 +1,89 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_lock_profile_prv.h
+*
+* @author Andrey Butok
+*
+* @brief Private. FNET lock profiler.
+*
+***************************************************************************/
+
+#ifndef _FNET_LOCK_PROFILE_PRV_H_
+
+#define _FNET_LOCK_PROFILE_PRV_H_
+
+#include "fnet_config.h"
+#include "fnet_lock_profile.h"
+
+#if FNET_CFG_LOCK_PROFILE
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_LOCK_PROFILE_STAMP()   FNET_CFG_LATENCY_CYCLES()
+
+/* Sum of the time intervals. The total is kept in two words, 
+ * as the 32-bit counter wraps in seconds.*/
+typedef struct
+{
+    unsigned long   count;
+    unsigned long   max;
+    unsigned long   total_low;
+    unsigned long   total_high;
+} fnet_lock_profile_sum_t;
+
+/* Call site record.*/
+typedef struct
+{
+    const char              *file;
+    unsigned long           line;
+    unsigned long           locks;
+    fnet_lock_profile_sum_t hold;
+    fnet_lock_profile_sum_t bottom;
+    fnet_lock_profile_sum_t wait;
+} fnet_lock_profile_entry_t;
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+void fnet_lock_profile_init( void );
+fnet_lock_profile_entry_t *fnet_lock_profile_lock( const char *file, int line );
+void fnet_lock_profile_add( fnet_lock_profile_sum_t *sum, unsigned long cycles );
+
+#else
+
+#define fnet_lock_profile_init()    ((void)0)
+
+#endif /* FNET_CFG_LOCK_PROFILE */
+
+#endif /* _FNET_LOCK_PROFILE_PRV_H_ */
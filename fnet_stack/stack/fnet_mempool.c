@@ -54,6 +54,8 @@ struct fnet_mempool
 {
     fnet_mempool_unit_header_t * free_ptr;
     unsigned char   unit_size;
+    unsigned long   used;       /* Allocated units.*/
+    unsigned long   used_max;   /* High-water mark of the allocated units.*/
 };
 
 #if FNET_DEBUG_MEMPOOL_CHECK
@@ -92,6 +94,8 @@ fnet_mempool_desc_t fnet_mempool_init( void *pool_ptr, unsigned long pool_size,
         mempool = (struct fnet_mempool *) pool_ptr;
         
         mempool->unit_size = (unsigned char)(alignment+1);
+        mempool->used = 0;
+        mempool->used_max = 0;
         
         
         p = (fnet_mempool_unit_header_t *)heap_ptr;
@@ -183,6 +187,8 @@ void fnet_mempool_free( fnet_mempool_desc_t mpool, void *ap )
             }
         }
 
+        mempool->used -= bp->size;
+
         if((fnet_mempool_unit_header_t *)((unsigned long)bp + bp->size*mempool->unit_size) == p->ptr)
         {
             bp->size += p->ptr->size;
@@ -262,6 +268,10 @@ void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, unsigned nbytes )
 
         mempool->free_ptr = best_p_prev;
         res = (void *)((unsigned long)best_p + mempool->unit_size);
+
+        mempool->used += nunits;
+        if(mempool->used > mempool->used_max)
+            mempool->used_max = mempool->used;
 #if 0 /* Clear mem.*/
         fnet_memset_zero( res, (nunits-1)* mempool->unit_size ); 
 #endif  
@@ -330,6 +340,10 @@ void *fnet_mempool_malloc(fnet_mempool_desc_t mpool, unsigned nbytes )
 
             mempool->free_ptr = prevp;
 
+            mempool->used += nunits;
+            if(mempool->used > mempool->used_max)
+                mempool->used_max = mempool->used;
+
             fnet_isr_unlock();
 
             return (void *)((unsigned long)p + mempool->unit_size);
@@ -424,6 +438,126 @@ unsigned long fnet_mempool_malloc_max( fnet_mempool_desc_t mpool )
     return (max * mempool->unit_size);
 }
 
+/************************************************************************
+* NAME: fnet_mempool_used
+*
+* DESCRIPTION: Returns the allocated memory, including the block headers.
+*              
+*************************************************************************/
+unsigned long fnet_mempool_used( fnet_mempool_desc_t mpool )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+
+    return (mempool->used * mempool->unit_size);
+}
+
+/************************************************************************
+* NAME: fnet_mempool_used_max
+*
+* DESCRIPTION: Returns the high-water mark of the allocated memory, 
+*              including the block headers.
+*              
+*************************************************************************/
+unsigned long fnet_mempool_used_max( fnet_mempool_desc_t mpool )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+
+    return (mempool->used_max * mempool->unit_size);
+}
+
+/************************************************************************
+* NAME: fnet_mempool_used_max_reset
+*
+* DESCRIPTION: Restarts the high-water mark from the allocated memory.
+*              
+*************************************************************************/
+void fnet_mempool_used_max_reset( fnet_mempool_desc_t mpool )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+
+    fnet_isr_lock();
+
+    mempool->used_max = mempool->used;
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_mempool_free_histogram
+*
+* DESCRIPTION: Walks the free list and counts the free blocks 
+*              by their size. The bucket n counts the blocks 
+*              from 2^n to 2^(n+1)-1 bytes, the last one counts 
+*              also the larger blocks.
+*              Returns the number of the free blocks.
+*************************************************************************/
+unsigned long fnet_mempool_free_histogram( fnet_mempool_desc_t mpool, unsigned long *histogram, int buckets )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+    fnet_mempool_unit_header_t *t_mem;
+    unsigned long blocks = 0;
+    unsigned long size;
+    int bucket;
+
+    fnet_memset_zero(histogram, sizeof(unsigned long) * (unsigned int)buckets);
+
+    fnet_isr_lock();
+
+    t_mem = mempool->free_ptr;
+
+    if(t_mem)
+    {
+        do
+        {
+            size = t_mem->size * mempool->unit_size;
+
+            for(bucket = 0; (size >>= 1) && (bucket < (buckets - 1)); bucket++)
+            {}
+
+            histogram[bucket]++;
+            blocks++;
+
+            t_mem = t_mem->ptr;
+        }
+        while(t_mem && (t_mem != mempool->free_ptr));
+    }
+
+    fnet_isr_unlock();
+
+    return blocks;
+}
+
+#if FNET_CFG_HEAP_PROFILE
+/************************************************************************
+* NAME: fnet_mempool_set_tag
+*
+* DESCRIPTION: Saves the tag into the header of the allocated block.
+*              Its free-list pointer is not used until the block is freed.
+*************************************************************************/
+void fnet_mempool_set_tag( fnet_mempool_desc_t mpool, void *ap, void *tag )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+
+    ((fnet_mempool_unit_header_t *)((unsigned long)ap - mempool->unit_size))->ptr = (fnet_mempool_unit_header_t *)tag;
+}
+
+/************************************************************************
+* NAME: fnet_mempool_get_tag
+*
+* DESCRIPTION: Returns the tag of the allocated block, 
+*              and its size including the header.
+*************************************************************************/
+void *fnet_mempool_get_tag( fnet_mempool_desc_t mpool, void *ap, unsigned long *size )
+{
+    struct fnet_mempool * mempool = (struct fnet_mempool *)mpool;
+    fnet_mempool_unit_header_t *bp = (fnet_mempool_unit_header_t *)((unsigned long)ap - mempool->unit_size);
+
+    *size = bp->size * mempool->unit_size;
+
+    return (void *)bp->ptr;
+}
+#endif /* FNET_CFG_HEAP_PROFILE */
+
 #if 0 /* For Debug needs.*/
 int fnet_mempool_check( fnet_mempool_desc_t mpool )
 {
@@ -86,6 +86,15 @@ void fnet_mempool_free( fnet_mempool_desc_t mempool, void *ap );
 void *fnet_mempool_malloc(fnet_mempool_desc_t mempool, unsigned nbytes );
 unsigned long fnet_mempool_free_mem_status( fnet_mempool_desc_t mempool);
 unsigned long fnet_mempool_malloc_max( fnet_mempool_desc_t mempool );
+unsigned long fnet_mempool_used( fnet_mempool_desc_t mempool );
+unsigned long fnet_mempool_used_max( fnet_mempool_desc_t mempool );
+void fnet_mempool_used_max_reset( fnet_mempool_desc_t mempool );
+unsigned long fnet_mempool_free_histogram( fnet_mempool_desc_t mempool, unsigned long *histogram, int buckets );
+
+#if FNET_CFG_HEAP_PROFILE
+void fnet_mempool_set_tag( fnet_mempool_desc_t mempool, void *ap, void *tag );
+void *fnet_mempool_get_tag( fnet_mempool_desc_t mempool, void *ap, unsigned long *size );
+#endif
 
 #if 0 /* For Debug needs.*/
 int fnet_mempool_check( fnet_mempool_desc_t mpool );
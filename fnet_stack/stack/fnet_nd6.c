@@ -64,6 +64,9 @@ static void fnet_nd6_neighbor_cache_timer(fnet_netif_t *netif);
 static void fnet_nd6_redirect_table_del(fnet_netif_t *if_ptr, const fnet_ip6_addr_t *target_addr);
 static fnet_nd6_redirect_entry_t *fnet_nd6_redirect_table_add(fnet_netif_t *if_ptr, const fnet_ip6_addr_t *destination_addr, const fnet_ip6_addr_t *target_addr);
 static int fnet_nd6_is_firsthop_router(fnet_netif_t *netif, fnet_ip6_addr_t *router_ip);
+static unsigned int fnet_nd6_neighbor_hash(const fnet_ip6_addr_t *ip_addr);
+static void fnet_nd6_neighbor_lru_move(fnet_nd6_if_t *nd6_if, fnet_nd6_neighbor_entry_t *neighbor_entry, int to_head);
+static void fnet_nd6_neighbor_free_waiting_netbuf(fnet_nd6_neighbor_entry_t *neighbor_entry);
 
 /************************************************************************
 * NAME: fnet_nd6_init
@@ -73,6 +76,7 @@ static int fnet_nd6_is_firsthop_router(fnet_netif_t *netif, fnet_ip6_addr_t *rou
 int fnet_nd6_init (fnet_netif_t *netif, fnet_nd6_if_t *nd6_if_ptr)
 {
     int result = FNET_ERR;
+    int i;
     
     if(netif && nd6_if_ptr)
     {
@@ -81,6 +85,21 @@ int fnet_nd6_init (fnet_netif_t *netif, fnet_nd6_if_t *nd6_if_ptr)
         /* Clear all parameters.*/
         fnet_memset_zero(nd6_if_ptr, sizeof(fnet_nd6_if_t));
 
+        /* --- Initialize Neighbor Cache. ----*/
+        
+        /* All entries are free and linked into the LRU list.*/
+        for(i=0; i < FNET_ND6_NEIGHBOR_CACHE_SIZE; i++)
+        {
+            if(i > 0)
+                nd6_if_ptr->neighbor_cache[i].lru_prev = &nd6_if_ptr->neighbor_cache[i-1];
+            
+            if(i < (FNET_ND6_NEIGHBOR_CACHE_SIZE - 1))
+                nd6_if_ptr->neighbor_cache[i].lru_next = &nd6_if_ptr->neighbor_cache[i+1];
+        }
+        
+        nd6_if_ptr->neighbor_lru_head = &nd6_if_ptr->neighbor_cache[0];
+        nd6_if_ptr->neighbor_lru_tail = &nd6_if_ptr->neighbor_cache[FNET_ND6_NEIGHBOR_CACHE_SIZE - 1];
+
         /* --- Initialize Prefix List. ----*/
         
         /* The link-local prefix is considered to be on the
@@ -122,9 +141,16 @@ int fnet_nd6_init (fnet_netif_t *netif, fnet_nd6_if_t *nd6_if_ptr)
 *************************************************************************/
 void fnet_nd6_release (fnet_netif_t *netif)
 {
+    int i;
+    
     if(netif && netif->nd6_if_ptr)
     {
         fnet_timer_free(netif->nd6_if_ptr->timer);  
+        
+        /* Free waiting queues.*/
+        for(i=0; i < FNET_ND6_NEIGHBOR_CACHE_SIZE; i++)
+            fnet_nd6_neighbor_free_waiting_netbuf(&netif->nd6_if_ptr->neighbor_cache[i]);
+        
         netif->nd6_if_ptr = 0;     
     }
 }
@@ -155,30 +181,95 @@ static void fnet_nd6_timer( void *cookie )
 
 }
 
+/************************************************************************
+* NAME: fnet_nd6_neighbor_hash
+*
+* DESCRIPTION: Returns the hash bucket index of the neighbor address.
+*               The interface identifier is used, as the prefix is 
+*               mostly the same for all neighbors.
+*************************************************************************/
+static unsigned int fnet_nd6_neighbor_hash(const fnet_ip6_addr_t *ip_addr)
+{
+    unsigned long key = ip_addr->addr32[2] ^ ip_addr->addr32[3];
+    
+    /* Fold all bytes, it does not depend on the byte order.*/
+    key ^= (key >> 16);
+    key ^= (key >> 8);
+    
+    return (unsigned int)((key & 0xFFu) % FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE);
+}
+
+/************************************************************************
+* NAME: fnet_nd6_neighbor_lru_move
+*
+* DESCRIPTION: Moves the entry to the head (the most recently used) 
+*               or to the tail (the first to be reused) of the LRU list.
+*************************************************************************/
+static void fnet_nd6_neighbor_lru_move(fnet_nd6_if_t *nd6_if, fnet_nd6_neighbor_entry_t *neighbor_entry, int to_head)
+{
+    if((to_head == FNET_TRUE) && (nd6_if->neighbor_lru_head == neighbor_entry))
+        return;
+    
+    /* Unlink.*/
+    if(neighbor_entry->lru_prev)
+        neighbor_entry->lru_prev->lru_next = neighbor_entry->lru_next;
+    else
+        nd6_if->neighbor_lru_head = neighbor_entry->lru_next;
+    
+    if(neighbor_entry->lru_next)
+        neighbor_entry->lru_next->lru_prev = neighbor_entry->lru_prev;
+    else
+        nd6_if->neighbor_lru_tail = neighbor_entry->lru_prev;
+    
+    /* Link.*/
+    if(to_head == FNET_TRUE)
+    {
+        neighbor_entry->lru_prev = FNET_NULL;
+        neighbor_entry->lru_next = nd6_if->neighbor_lru_head;
+        
+        if(nd6_if->neighbor_lru_head)
+            nd6_if->neighbor_lru_head->lru_prev = neighbor_entry;
+        else
+            nd6_if->neighbor_lru_tail = neighbor_entry;
+        
+        nd6_if->neighbor_lru_head = neighbor_entry;
+    }
+    else
+    {
+        neighbor_entry->lru_next = FNET_NULL;
+        neighbor_entry->lru_prev = nd6_if->neighbor_lru_tail;
+        
+        if(nd6_if->neighbor_lru_tail)
+            nd6_if->neighbor_lru_tail->lru_next = neighbor_entry;
+        else
+            nd6_if->neighbor_lru_head = neighbor_entry;
+        
+        nd6_if->neighbor_lru_tail = neighbor_entry;
+    }
+}
+
 /************************************************************************
 * NAME: fnet_nd6_neighbor_cache_get
 *
 * DESCRIPTION: Get entry from Neighbor cache that corresponds ip_addr.
 *               It returns NULL if no entry is found.
+*               The found entry becomes the most recently used.
 *************************************************************************/
 fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_get(fnet_netif_t *netif, fnet_ip6_addr_t *ip_addr)
 {
     fnet_nd6_if_t               *nd6_if = netif->nd6_if_ptr;
-    int                         i;
     fnet_nd6_neighbor_entry_t   *result = FNET_NULL;
 
     if (nd6_if)
     {
-        /* Find the entry in the cache. */
-        for(i=0; i < FNET_ND6_NEIGHBOR_CACHE_SIZE; i++)
-        {
-            if( (nd6_if->neighbor_cache[i].state != FNET_ND6_NEIGHBOR_STATE_NOTUSED) &&
-                FNET_IP6_ADDR_EQUAL(&nd6_if->neighbor_cache[i].ip_addr, ip_addr))
-            {
-                result = &nd6_if->neighbor_cache[i];
-                break;
-            }
-        }
+        /* Find the entry in the hash bucket. */
+        result = nd6_if->neighbor_hash[fnet_nd6_neighbor_hash(ip_addr)];
+        
+        while(result && !FNET_IP6_ADDR_EQUAL(&result->ip_addr, ip_addr))
+            result = result->hash_next;
+        
+        if(result)
+            fnet_nd6_neighbor_lru_move(nd6_if, result, FNET_TRUE);
     }
     return result;
 }
@@ -190,19 +281,34 @@ fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_get(fnet_netif_t *netif, fnet
 *************************************************************************/
 void fnet_nd6_neighbor_cache_del(fnet_netif_t *netif, fnet_nd6_neighbor_entry_t *neighbor_entry)
 {
-    if (neighbor_entry)
+    fnet_nd6_if_t               *nd6_if = netif->nd6_if_ptr;
+    fnet_nd6_neighbor_entry_t   **bucket;
+
+    if (nd6_if && neighbor_entry && (neighbor_entry->state != FNET_ND6_NEIGHBOR_STATE_NOTUSED))
     {
         /* Delete posible entry in the Redirect Table.*/
         fnet_nd6_redirect_table_del(netif, &neighbor_entry->ip_addr);
+        
+        /* Unlink from the hash bucket.*/
+        bucket = &nd6_if->neighbor_hash[fnet_nd6_neighbor_hash(&neighbor_entry->ip_addr)];
+        
+        while(*bucket && (*bucket != neighbor_entry))
+            bucket = &((*bucket)->hash_next);
+        
+        if(*bucket)
+            *bucket = neighbor_entry->hash_next;
+        
+        neighbor_entry->hash_next = FNET_NULL;
 
         neighbor_entry->state = FNET_ND6_NEIGHBOR_STATE_NOTUSED;
+        FNET_NETIF_DST_INVALIDATE();
         
         /* Free waiting queue.*/
-        if(neighbor_entry->waiting_netbuf) //TBD for bigger queue.
-        {
-            fnet_netbuf_free_chain(neighbor_entry->waiting_netbuf);
-        }
+        nd6_if->neighbor_stats.entry_drops += (unsigned long)neighbor_entry->waiting_count;
+        fnet_nd6_neighbor_free_waiting_netbuf(neighbor_entry);
         
+        /* The free entry will be reused first.*/
+        fnet_nd6_neighbor_lru_move(nd6_if, neighbor_entry, FNET_FALSE);
     }
 }
 
@@ -210,43 +316,48 @@ void fnet_nd6_neighbor_cache_del(fnet_netif_t *netif, fnet_nd6_neighbor_entry_t
 * NAME: fnet_nd6_neighbor_cache_add
 *
 * DESCRIPTION: Adds (TBD update) entry into the Neighbor cache.
+*               If the cache is full, the least recently used entry 
+*               is replaced, the default routers are kept if possible.
 *************************************************************************/
 fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_add(fnet_netif_t *netif, fnet_ip6_addr_t *ip_addr, fnet_nd6_ll_addr_t ll_addr, fnet_nd6_neighbor_state_t state)
 {
     fnet_nd6_if_t               *nd6_if = netif->nd6_if_ptr;
-    int                         i;
     fnet_nd6_neighbor_entry_t   *entry = FNET_NULL;
+    fnet_nd6_neighbor_entry_t   *lru_prev;
+    fnet_nd6_neighbor_entry_t   *lru_next;
+    unsigned int                hash;
 
     if (nd6_if)
     {
-        /* Find not used entry.*/
-        for(i=0; i < FNET_ND6_NEIGHBOR_CACHE_SIZE; i++)
+        /* Free entries are at the tail of the LRU list.*/
+        entry = nd6_if->neighbor_lru_tail;
+        
+        /* If no free entry is found, try to find the least recently used one, 
+         * that is not a router.*/
+        while(entry && (entry->state != FNET_ND6_NEIGHBOR_STATE_NOTUSED) && (entry->is_router == 1))
         {
-            if( (nd6_if->neighbor_cache[i].state == FNET_ND6_NEIGHBOR_STATE_NOTUSED))
-            {
-                entry = &nd6_if->neighbor_cache[i];
-                break;
-            }
+            entry = entry->lru_prev;
         }
         
-        /* If no free entry is found.*/
         if(entry == FNET_NULL)
-        { 
-            entry = &nd6_if->neighbor_cache[0];
-            /* Try to find the oldest entry.*/
-            for(i=0; i < FNET_ND6_NEIGHBOR_CACHE_SIZE; i++)
-            {
-                if(nd6_if->neighbor_cache[i].creation_time < entry->creation_time)
-                {
-                    entry = &nd6_if->neighbor_cache[i];
-                }
-            }
+        {
+            entry = nd6_if->neighbor_lru_tail;
+        }
+        
+        if(entry->state != FNET_ND6_NEIGHBOR_STATE_NOTUSED)
+        {
+            nd6_if->neighbor_stats.evicted++;
+            fnet_nd6_neighbor_cache_del(netif, entry);
         }
         
         /* Fill the informationn.*/
         
-        /* Clear enty structure.*/
+        /* Clear enty structure, except the LRU list links.*/
+        lru_prev = entry->lru_prev;
+        lru_next = entry->lru_next;
         fnet_memset_zero(entry, sizeof(fnet_nd6_neighbor_entry_t));
+        entry->lru_prev = lru_prev;
+        entry->lru_next = lru_next;
         
         FNET_IP6_ADDR_COPY(ip_addr, &entry->ip_addr);
         if(ll_addr != FNET_NULL)
@@ -256,6 +367,15 @@ fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_add(fnet_netif_t *netif, fnet
         entry->router_lifetime = 0;
         entry->state = state;
         
+        /* Link to the hash bucket.*/
+        hash = fnet_nd6_neighbor_hash(ip_addr);
+        entry->hash_next = nd6_if->neighbor_hash[hash];
+        nd6_if->neighbor_hash[hash] = entry;
+        
+        fnet_nd6_neighbor_lru_move(nd6_if, entry, FNET_TRUE);
+        
+        FNET_NETIF_DST_INVALIDATE();
+        
         //TBD Init timers reachable; last send
     }
     return entry;
@@ -301,6 +421,7 @@ static void fnet_nd6_neighbor_cache_timer(fnet_netif_t *netif)
                          * again. Invoking next-hop determination at this point ensures that
                          * alternate default routers are tried.
                          */                        
+                        nd6_if->neighbor_stats.failed++;
                         fnet_nd6_neighbor_cache_del(netif, neighbor_entry);
                         //TBD ICMP error to upper layer.
                     }
@@ -329,6 +450,7 @@ static void fnet_nd6_neighbor_cache_timer(fnet_netif_t *netif)
                 /* REACHABLE to STALE */
                 { 
                     neighbor_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                    FNET_NETIF_DST_INVALIDATE();
                 }
                 break;
            /* =========== DELAY ================ */    
@@ -345,6 +467,7 @@ static void fnet_nd6_neighbor_cache_timer(fnet_netif_t *netif)
 
                     
                     neighbor_entry->state = FNET_ND6_NEIGHBOR_STATE_PROBE;
+                    FNET_NETIF_DST_INVALIDATE();
                     neighbor_entry->solicitation_send_counter = 0;
                     /* 
                      * Upon entering the PROBE state, a node sends a unicast Neighbor
@@ -417,35 +540,92 @@ static void fnet_nd6_neighbor_cache_timer(fnet_netif_t *netif)
 *
 * DESCRIPTION: Put netbuf to the queue, waiting for address resolution to complete.
 *************************************************************************/
-void fnet_nd6_neighbor_enqueue_waiting_netbuf(fnet_nd6_neighbor_entry_t *neighbor_entry, fnet_netbuf_t *waiting_netbuf)
+void fnet_nd6_neighbor_enqueue_waiting_netbuf(fnet_netif_t *netif, fnet_nd6_neighbor_entry_t *neighbor_entry, fnet_netbuf_t *waiting_netbuf)
 {
+    fnet_netbuf_t *oldest_netbuf;
+    
     if (neighbor_entry && waiting_netbuf)
     {
         /* When a queue  overflows, the new arrival SHOULD replace the oldest entry.*/
-        //TBD for bigger queue.
-        if(neighbor_entry->waiting_netbuf != FNET_NULL)
+        if(neighbor_entry->waiting_count >= FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE)
         {
-            fnet_netbuf_free_chain(neighbor_entry->waiting_netbuf); /* Free the oldest one.*/
+            oldest_netbuf = neighbor_entry->waiting_netbuf;
+            neighbor_entry->waiting_netbuf = oldest_netbuf->next_chain;
+            neighbor_entry->waiting_count--;
+            
+            fnet_netbuf_free_chain(oldest_netbuf); /* Free the oldest one.*/
+            
+            if(netif->nd6_if_ptr)
+                netif->nd6_if_ptr->neighbor_stats.queue_drops++;
         }
         
-        neighbor_entry->waiting_netbuf = waiting_netbuf;
+        if(neighbor_entry->waiting_netbuf == FNET_NULL)
+            neighbor_entry->waiting_time = fnet_timer_ms();
+        
+        waiting_netbuf->next_chain = FNET_NULL;
+        fnet_netbuf_add_chain(&neighbor_entry->waiting_netbuf, waiting_netbuf);
+        neighbor_entry->waiting_count++;
     }
 }
 
 /************************************************************************
 * NAME: fnet_nd6_neighbor_send_waiting_netbuf
 *
-* DESCRIPTION: Sends waiting PCBs, if any.
+* DESCRIPTION: Sends waiting PCBs, if any. 
+*               The whole queue is sent, in the arrival order.
 *************************************************************************/
 void fnet_nd6_neighbor_send_waiting_netbuf(fnet_netif_t *netif, fnet_nd6_neighbor_entry_t *neighbor_entry)
 {
+    fnet_nd6_if_t   *nd6_if = netif->nd6_if_ptr;
+    fnet_netbuf_t   *waiting_netbuf;
+    fnet_netbuf_t   *queue;
+    unsigned long   resolve_time;
+    
     if (neighbor_entry->waiting_netbuf != FNET_NULL)
     {
-        /* Send.*/
-        netif->api->output_ip6(netif, FNET_NULL /* not needed.*/,  &neighbor_entry->ip_addr, neighbor_entry->waiting_netbuf); /* IPv6 Transmit function.*/
+        /* Address resolution latency.*/
+        if(nd6_if)
+        {
+            resolve_time = fnet_timer_get_interval(neighbor_entry->waiting_time, fnet_timer_ms());
+            
+            nd6_if->neighbor_stats.resolved++;
+            nd6_if->neighbor_stats.resolve_time_total += resolve_time;
+            if(resolve_time > nd6_if->neighbor_stats.resolve_time_max)
+                nd6_if->neighbor_stats.resolve_time_max = resolve_time;
+        }
         
+        /* Take the whole queue, the output may queue again.*/
+        queue = neighbor_entry->waiting_netbuf;
         neighbor_entry->waiting_netbuf = FNET_NULL;
+        neighbor_entry->waiting_count = 0;
+        
+        while((waiting_netbuf = queue) != FNET_NULL)
+        {
+            queue = waiting_netbuf->next_chain;
+            waiting_netbuf->next_chain = FNET_NULL;
+            
+            /* Send.*/
+            netif->api->output_ip6(netif, FNET_NULL /* not needed.*/,  &neighbor_entry->ip_addr, waiting_netbuf); /* IPv6 Transmit function.*/
+        }
+    }
+}
+
+/************************************************************************
+* NAME: fnet_nd6_neighbor_free_waiting_netbuf
+*
+* DESCRIPTION: Frees waiting PCBs, if any.
+*************************************************************************/
+static void fnet_nd6_neighbor_free_waiting_netbuf(fnet_nd6_neighbor_entry_t *neighbor_entry)
+{
+    fnet_netbuf_t *waiting_netbuf;
+    
+    while((waiting_netbuf = neighbor_entry->waiting_netbuf) != FNET_NULL)
+    {
+        neighbor_entry->waiting_netbuf = waiting_netbuf->next_chain;
+        fnet_netbuf_free_chain(waiting_netbuf);
     }
+    
+    neighbor_entry->waiting_count = 0;
 }
 
 /************************************************************************
@@ -459,6 +639,11 @@ void fnet_nd6_router_list_add( fnet_nd6_neighbor_entry_t *neighbor_entry, unsign
     {
         if(lifetime) 
         {
+            if(neighbor_entry->is_router == 0)
+            {
+                FNET_NETIF_DST_INVALIDATE();
+            }
+            
             neighbor_entry->is_router = 1;
             neighbor_entry->router_lifetime = lifetime;
             neighbor_entry->creation_time = fnet_timer_seconds();
@@ -485,6 +670,7 @@ void fnet_nd6_router_list_del( fnet_nd6_neighbor_entry_t *neighbor_entry )
     {
         neighbor_entry->is_router = 0;
         neighbor_entry->router_lifetime = 0;
+        FNET_NETIF_DST_INVALIDATE();
     }
 }
 
@@ -614,6 +800,7 @@ void fnet_nd6_prefix_list_del(fnet_nd6_prefix_entry_t *prefix_entry)
     if (prefix_entry)
     {
         prefix_entry->state = FNET_ND6_PREFIX_STATE_NOTUSED;
+        FNET_NETIF_DST_INVALIDATE();
     }
 }
 
@@ -666,6 +853,7 @@ fnet_nd6_prefix_entry_t *fnet_nd6_prefix_list_add(fnet_netif_t *if_ptr, const fn
         entry->lifetime = lifetime;
         entry->creation_time = fnet_timer_seconds();
         entry->state = FNET_ND6_PREFIX_STATE_USED;
+        FNET_NETIF_DST_INVALIDATE();
     }
     
     return entry;
@@ -753,6 +941,7 @@ static fnet_nd6_redirect_entry_t *fnet_nd6_redirect_table_add(fnet_netif_t *if_p
         FNET_IP6_ADDR_COPY(destination_addr, &entry->destination_addr);
         FNET_IP6_ADDR_COPY(target_addr, &entry->target_addr);
         entry->creation_time = fnet_timer_seconds();
+        FNET_NETIF_DST_INVALIDATE();
     }
     
     return entry;
@@ -776,6 +965,7 @@ static void fnet_nd6_redirect_table_del(fnet_netif_t *if_ptr, const fnet_ip6_add
             {
                 /* Clear it.*/
                 fnet_memset_zero(&nd6_if->redirect_table[i], sizeof(fnet_nd6_redirect_entry_t));
+                FNET_NETIF_DST_INVALIDATE();
             }
         }
     }
@@ -1048,6 +1238,7 @@ void fnet_nd6_neighbor_solicitation_receive(fnet_netif_t *netif, fnet_ip6_addr_t
                     {
                         FNET_ND6_LL_ADDR_COPY(nd_option_slla->addr, neighbor_cache_entry->ll_addr, netif->api->hw_addr_size);
                         neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                        FNET_NETIF_DST_INVALIDATE();
                     }
                     else
                     {
@@ -1368,12 +1559,14 @@ void fnet_nd6_neighbor_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_
             if (is_solicited)
             {
                 neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_REACHABLE;
+                FNET_NETIF_DST_INVALIDATE();
                 /* Reset Reachable Timer. */
                 neighbor_cache_entry->state_time = fnet_timer_ms();
             }
             else
             {
                 neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;            
+                FNET_NETIF_DST_INVALIDATE();
             }
               
             /* - It sets the IsRouter flag in the cache entry based on the Router
@@ -1412,6 +1605,7 @@ void fnet_nd6_neighbor_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_
                  if(neighbor_cache_entry->state == FNET_ND6_NEIGHBOR_STATE_REACHABLE) 
                  {
                     neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                    FNET_NETIF_DST_INVALIDATE();
                  }
                 /* b. Otherwise, the received advertisement should be ignored and
                  *    MUST NOT update the cache.
@@ -1438,6 +1632,7 @@ void fnet_nd6_neighbor_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_
                 if(is_solicited) 
                 {
                     neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_REACHABLE;
+                    FNET_NETIF_DST_INVALIDATE();
                     /* Reset Reachable Timer.*/
                     neighbor_cache_entry->state_time = fnet_timer_ms();
                 }
@@ -1449,6 +1644,7 @@ void fnet_nd6_neighbor_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_
                 else if(is_ll_addr_changed)
                 {
                     neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                    FNET_NETIF_DST_INVALIDATE();
                 }
                 /* - The IsRouter flag in the cache entry MUST be set based on the
                  *   Router flag in the received advertisement. In those cases
@@ -1606,6 +1802,8 @@ void fnet_nd6_router_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_t
                     netif->nd6_if_ptr->mtu = FNET_IP6_DEFAULT_MTU;
                 else
                     netif->nd6_if_ptr->mtu =  mtu; 
+                
+                FNET_NETIF_DST_INVALIDATE();
                       
             #if FNET_CFG_IP6_PMTU_DISCOVERY 
                 if(netif->pmtu /* If PMTU is enabled.*/ &&
@@ -1638,6 +1836,7 @@ void fnet_nd6_router_advertisement_receive(fnet_netif_t *netif, fnet_ip6_addr_t
                 {
                     FNET_ND6_LL_ADDR_COPY(nd_option_slla->addr, neighbor_cache_entry->ll_addr, netif->api->hw_addr_size);
                     neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                    FNET_NETIF_DST_INVALIDATE();
                 }
             }
             
@@ -1924,6 +2123,7 @@ void fnet_nd6_redirect_receive(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fne
             {
                 FNET_ND6_LL_ADDR_COPY(nd_option_tlla->addr, neighbor_cache_entry->ll_addr, netif->api->hw_addr_size);
                 neighbor_cache_entry->state = FNET_ND6_NEIGHBOR_STATE_STALE;
+                FNET_NETIF_DST_INVALIDATE();
             }
             /* else. If the link-layer address is the
              * same as that already in the cache, the cache entrys state remains
@@ -2050,6 +2250,7 @@ static void fnet_nd6_dad_timer(fnet_netif_t *netif )
                      * Once an address is determined to be unique,
                      * it may be assigned to an interface.*/
                     addr_info->state = FNET_NETIF_IP6_ADDR_STATE_PREFERRED;
+                    FNET_NETIF_DST_INVALIDATE();
                     
                 #if FNET_CFG_DEBUG_IP6
                     {
@@ -229,12 +229,14 @@ typedef struct fnet_nd6_neighbor_entry
     fnet_nd6_ll_addr_t          ll_addr;        /* Its link-layer address. Actual size is defiined by fnet_netif_api_t->hw_addr_size. */
     fnet_nd6_neighbor_state_t   state;          /* Neighbors reachability state.*/
     unsigned long               state_time;     /* Time of last state event.*/
-    fnet_netbuf_t               *waiting_netbuf;/* Pointer to any queued packetwaiting for address resolution to complete.*/
+    fnet_netbuf_t               *waiting_netbuf;/* Queue of packets waiting for address resolution to complete.*/
                                                 /* RFC 4861 7.2.2: While waiting for address resolution to complete, the sender MUST,
                                                  * for each neighbor, retain a small queue of packets waiting for
                                                  * address resolution to complete. The queue MUST hold at least one
                                                  * packet, and MAY contain more.
                                                  * When a queue  overflows, the new arrival SHOULD replace the oldest entry.*/    
+    int                         waiting_count;  /* Number of packets in the waiting queue.*/
+    unsigned long               waiting_time;   /* Time when the first packet was queued, in ms.*/
     int                         solicitation_send_counter;  /* Counter - how many soicitations where sent.*/
     fnet_ip6_addr_t             solicitation_src_ip_addr;   /* IP address used during AR solicitation messages. */    
     unsigned long               creation_time;              /* Time of entry creation, in seconds.*/    
@@ -248,6 +250,9 @@ typedef struct fnet_nd6_neighbor_entry
                                                     * Lifetime of 0 indicates that the router is not a
                                                     * default router and SHOULD NOT appear on the default router list.
                                                     * It is used only if "is_router" is 1.*/    
+    struct fnet_nd6_neighbor_entry  *hash_next;     /* Next entry in the hash bucket.*/
+    struct fnet_nd6_neighbor_entry  *lru_prev;      /* More recently used entry.*/
+    struct fnet_nd6_neighbor_entry  *lru_next;      /* Less recently used entry.*/
 } fnet_nd6_neighbor_entry_t;
 
 /***********************************************************************
@@ -641,6 +646,10 @@ typedef struct fnet_nd6_if
     * RFC4861 5.1: A list of routers to which packets may be sent.. 
     **************************************************************/    
     fnet_nd6_neighbor_entry_t  neighbor_cache[FNET_ND6_NEIGHBOR_CACHE_SIZE];
+    fnet_nd6_neighbor_entry_t  *neighbor_hash[FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE]; /* Hash buckets of the Neighbor Cache.*/
+    fnet_nd6_neighbor_entry_t  *neighbor_lru_head;  /* The most recently used entry.*/
+    fnet_nd6_neighbor_entry_t  *neighbor_lru_tail;  /* The least recently used or free entry.*/
+    fnet_netif_ip6_neighbor_stats_t neighbor_stats; /* Address resolution statistics.*/
 
     /*************************************************************
     * Prefix List.
@@ -693,7 +702,7 @@ int fnet_nd6_addr_is_onlink(struct fnet_netif *netif, fnet_ip6_addr_t *addr);
 fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_get(struct fnet_netif *netif, fnet_ip6_addr_t *ip_addr);
 void fnet_nd6_neighbor_cache_del(struct fnet_netif *netif, fnet_nd6_neighbor_entry_t *neighbor_entry);
 fnet_nd6_neighbor_entry_t *fnet_nd6_neighbor_cache_add(struct fnet_netif *netif, fnet_ip6_addr_t *ip_addr, fnet_nd6_ll_addr_t ll_addr, fnet_nd6_neighbor_state_t state);
-void fnet_nd6_neighbor_enqueue_waiting_netbuf(fnet_nd6_neighbor_entry_t *neighbor_entry, fnet_netbuf_t *waiting_netbuf);
+void fnet_nd6_neighbor_enqueue_waiting_netbuf(struct fnet_netif *netif, fnet_nd6_neighbor_entry_t *neighbor_entry, fnet_netbuf_t *waiting_netbuf);
 void fnet_nd6_neighbor_send_waiting_netbuf(struct fnet_netif *netif, fnet_nd6_neighbor_entry_t *neighbor_entry);
 void fnet_nd6_router_list_add( fnet_nd6_neighbor_entry_t *neighbor_entry, unsigned long lifetime );
 void fnet_nd6_router_list_del( fnet_nd6_neighbor_entry_t *neighbor_entry );
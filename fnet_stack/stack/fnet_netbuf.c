@@ -51,6 +51,8 @@
 #include "fnet_stdlib.h"
 #include "fnet_debug.h"
 #include "fnet_mempool.h"
+#include "fnet_stats_prv.h"
+#include "fnet_heap_profile_prv.h"
 
 
 #define FNET_HEAP_SPLIT     (0) /* If 1 the main heap will be splitted to two parts. 
@@ -67,6 +69,8 @@ static fnet_mempool_desc_t fnet_mempool_main = 0; /* Main memory pool. */
 
 fnet_netbuf_t *dm_nb;
 
+static void fnet_netbuf_data_release( void *data );
+
 /************************************************************************
 * NAME: fnet_netbuf_new
 *
@@ -184,6 +188,7 @@ fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, int offset, int len, int dra
     loc_nb->next_chain = (fnet_netbuf_t *)0;
     loc_nb->total_length = (unsigned long)len;
     loc_nb->flags = nb->flags;
+    FNET_NETBUF_COPY_TIMESTAMP(loc_nb, nb);
 
     if(tmp_nb->length > offset) /* If offset less than size of 1st net_buf.*/
     {
@@ -280,6 +285,90 @@ fnet_netbuf_t *fnet_netbuf_from_buf( void *data_ptr, int len, int drain )
     return (nb);
 }
 
+/************************************************************************
+* NAME: fnet_netbuf_from_ref
+*
+* DESCRIPTION: Creates a new net_buf, which references the external 
+*              data buffer without copying. The optional handler is 
+*              called when the data buffer is not referenced anymore.
+*************************************************************************/
+fnet_netbuf_t *fnet_netbuf_from_ref( const void *data_ptr, int len, void (*handler)(void *cookie), void *cookie, int drain )
+{
+    fnet_netbuf_t       *nb;
+    fnet_netbuf_ref_t   *ref;
+
+    if(len < 0)
+        return (fnet_netbuf_t *)0;
+
+    nb = (fnet_netbuf_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_t));
+
+    if((nb == 0) && drain)
+    {
+        fnet_prot_drain();
+        nb = (fnet_netbuf_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_t));
+    }
+
+    if(nb == 0)
+    {
+        return (fnet_netbuf_t *)0;
+    }
+
+    ref = (fnet_netbuf_ref_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_ref_t));
+
+    if((ref == 0) && drain )
+    {
+        fnet_prot_drain();
+        ref = (fnet_netbuf_ref_t *)fnet_malloc_netbuf(sizeof(fnet_netbuf_ref_t));
+    }
+
+    if(ref == 0)
+    {
+        fnet_free_netbuf(nb);
+        return (fnet_netbuf_t *)0;
+    }
+
+    ref->reference_counter = FNET_NETBUF_REF_EXTERNAL | 1;
+    ref->handler = handler;
+    ref->cookie = cookie;
+
+    nb->next = (fnet_netbuf_t *)0;
+    nb->next_chain = (fnet_netbuf_t *)0;
+    nb->data = ref;
+    nb->data_ptr = (void *)data_ptr;
+    nb->length = (unsigned long)len;
+    nb->total_length = (unsigned long)len;
+    nb->flags = 0;
+
+    return (nb);
+}
+
+/************************************************************************
+* NAME: fnet_netbuf_data_release
+*
+* DESCRIPTION: Decrements the reference counter of the data buffer.
+*              If nobody uses the data buffer, it is freed or, for 
+*              the external data buffer, its owner is notified. 
+*************************************************************************/
+static void fnet_netbuf_data_release( void *data )
+{
+    fnet_netbuf_ref_t *ref;
+
+    if((((int *)data)[0] & ~FNET_NETBUF_REF_EXTERNAL) == 1)    /* If nobody uses this data buffer. */
+    {
+        if(((int *)data)[0] & FNET_NETBUF_REF_EXTERNAL)
+        {
+            ref = (fnet_netbuf_ref_t *)data;
+
+            if(ref->handler)
+                ref->handler(ref->cookie);
+        }
+
+        fnet_free_netbuf(data);
+    }
+    else                                                        /* Else decrement reference counter */
+        ((int *)data)[0] = ((int *)data)[0] - 1;
+}
+
 /************************************************************************
 * NAME: fnet_netbuf_to_buf
 *
@@ -369,10 +458,7 @@ fnet_netbuf_t *fnet_netbuf_free( fnet_netbuf_t *nb )
     if(nb != 0)
     {
         
-        if(((int *)nb->data)[0] == 1)   /* If nobody uses this data buffer. */
-            fnet_free_netbuf(nb->data);
-        else                           /* else decrement reference counter */
-            ((int *)nb->data)[0] = ((int *)nb->data)[0] - 1;
+        fnet_netbuf_data_release(nb->data);
 
         tmp_nb = nb->next;
 
@@ -400,11 +486,7 @@ void fnet_netbuf_free_chain( fnet_netbuf_t *nb )
     {
         tmp_nb = nb->next;
         
-        if(((int *)nb->data)[0] == 1)   /* If nobody uses this data buffer. */
-            fnet_free_netbuf(nb->data);
-        else                            /* Else decrement reference counter */
-            ((int *)nb->data)[0] = ((int *)nb->data)[0] - 1;
-
+        fnet_netbuf_data_release(nb->data);
 
         fnet_free_netbuf(nb);
 
@@ -459,10 +541,7 @@ fnet_netbuf_t *fnet_netbuf_pullup( fnet_netbuf_t *nb, int len)
     offset = nb->length;
 
     /* Free old data buffer (for the first net_buf) */
-    if(((int *)nb->data)[0] == 1)   /* If nobody uses this data buffer. */
-        fnet_free_netbuf(nb->data);
-    else                            /* Else decrement reference counter */
-        ((int *)nb->data)[0] = ((int *)nb->data)[0] - 1;
+    fnet_netbuf_data_release(nb->data);
 
     /* Currently data buffer contains the contents of the first buffer */
     nb->data = &((int *)new_buf)[0];
@@ -519,13 +598,14 @@ void fnet_netbuf_trim( fnet_netbuf_t **nb_ptr, int len )
     fnet_netbuf_t   *nb;
     long            tot_len;
     long            total_rem;
-    fnet_netbuf_t   *tmp_nb;
-    
+    unsigned long   flags;
+#if FNET_CFG_LATENCY
+    unsigned long   timestamp;
+#endif    
 
     if(len == 0)
         return;
     
-    tmp_nb = (fnet_netbuf_t *) *nb_ptr;
     nb = (fnet_netbuf_t *) *nb_ptr;
     head_nb = nb;
 
@@ -533,6 +613,11 @@ void fnet_netbuf_trim( fnet_netbuf_t **nb_ptr, int len )
     if((nb->total_length < (len > 0 ? len : -len)) || nb == 0)
         return;
 
+    flags = nb->flags; /* The head net_buf may be freed.*/
+#if FNET_CFG_LATENCY
+    timestamp = nb->timestamp;
+#endif
+
     tot_len = (long)nb->length;
     total_rem = (long)nb->total_length;
 
@@ -551,7 +636,10 @@ void fnet_netbuf_trim( fnet_netbuf_t **nb_ptr, int len )
             nb->data_ptr = (unsigned char *)nb->data_ptr + /* Or change pointer. */
                             nb->length - (tot_len - len);
             nb->length = (unsigned long)(tot_len - len);
-            nb->flags = tmp_nb->flags; 
+            nb->flags = flags; 
+        #if FNET_CFG_LATENCY
+            nb->timestamp = timestamp;
+        #endif
         }
     }
     else /* Trim len bytes from the end of the buffer. */
@@ -642,7 +730,7 @@ fnet_netbuf_t *fnet_netbuf_cut_center( fnet_netbuf_t ** nb_ptr, int offset, int
         head_nb->total_length -= len;
 
         /* Split one net_uf into two.*/
-        if(((int *)nb->data)[0] == 1) /* If we can simply erase them (reference_counter == 1).*/
+        if(((int *)nb->data)[0] == 1) /* If we can simply erase them (reference_counter == 1, never for external data).*/
         {
             fnet_memcpy((unsigned char *)nb->data_ptr + nb->length - tot_len + offset,
                         (unsigned char *)nb->data_ptr + nb->length - tot_len + offset + len,
@@ -800,6 +888,7 @@ int fnet_heap_init( unsigned char *heap_ptr, unsigned long heap_size )
 {
     int result;
 
+    fnet_heap_profile_init();
 
 /* Init memory pools. */
 #if FNET_HEAP_SPLIT
@@ -827,6 +916,7 @@ int fnet_heap_init( unsigned char *heap_ptr, unsigned long heap_size )
 *************************************************************************/
 void fnet_free_netbuf( void *ap )
 {
+    FNET_HEAP_PROFILE_FREE(fnet_mempool_netbuf, ap);
     fnet_mempool_free(fnet_mempool_netbuf, ap);
 }
 
@@ -836,9 +926,20 @@ void fnet_free_netbuf( void *ap )
 * DESCRIPTION: Allocates memory in heap for TCP/IP
 *              
 *************************************************************************/
+#if FNET_CFG_HEAP_PROFILE
+void *fnet_malloc_netbuf_site( unsigned nbytes, const char *file, int line )
+#else
 void *fnet_malloc_netbuf( unsigned nbytes )
+#endif
 {
-    return fnet_mempool_malloc( fnet_mempool_netbuf, nbytes );
+    void *result = fnet_mempool_malloc( fnet_mempool_netbuf, nbytes );
+
+    if(result == 0)
+        FNET_STATS_INC(mem.netbuf_fails);
+
+    FNET_HEAP_PROFILE_MALLOC(fnet_mempool_netbuf, result, FNET_TRUE, file, line);
+
+    return result;
 }
 
 /************************************************************************
@@ -863,6 +964,39 @@ unsigned long fnet_malloc_max_netbuf( void )
     return fnet_mempool_malloc_max( fnet_mempool_netbuf  );
 }
 
+/************************************************************************
+* NAME: fnet_mem_used
+*
+* DESCRIPTION: Returns a quantity of allocated memory.
+*              
+*************************************************************************/
+unsigned long fnet_mem_used_netbuf( void )
+{
+    return fnet_mempool_used( fnet_mempool_netbuf );
+}
+
+/************************************************************************
+* NAME: fnet_mem_high_water
+*
+* DESCRIPTION: Returns the high-water mark of allocated memory.
+*              
+*************************************************************************/
+unsigned long fnet_mem_high_water_netbuf( void )
+{
+    return fnet_mempool_used_max( fnet_mempool_netbuf );
+}
+
+/************************************************************************
+* NAME: fnet_free_mem_histogram
+*
+* DESCRIPTION: Returns the histogram of the free block sizes.
+*              
+*************************************************************************/
+unsigned long fnet_free_mem_histogram_netbuf( unsigned long *histogram, int buckets )
+{
+    return fnet_mempool_free_histogram( fnet_mempool_netbuf, histogram, buckets );
+}
+
 /************************************************************************
 * NAME: fnet_mem_release
 *
@@ -883,6 +1017,7 @@ void fnet_mem_release_netbuf( void )
 *************************************************************************/
 void fnet_free( void *ap )
 {
+    FNET_HEAP_PROFILE_FREE(fnet_mempool_main, ap);
     fnet_mempool_free(fnet_mempool_main, ap);
 }
 
@@ -892,9 +1027,20 @@ void fnet_free( void *ap )
 * DESCRIPTION: Allocates memory in heap for TCP/IP
 *              
 *************************************************************************/
+#if FNET_CFG_HEAP_PROFILE
+void *fnet_malloc_site( unsigned nbytes, const char *file, int line )
+#else
 void *fnet_malloc( unsigned nbytes )
+#endif
 {
-    return fnet_mempool_malloc( fnet_mempool_main, nbytes );
+    void *result = fnet_mempool_malloc( fnet_mempool_main, nbytes );
+
+    if(result == 0)
+        FNET_STATS_INC(mem.heap_fails);
+
+    FNET_HEAP_PROFILE_MALLOC(fnet_mempool_main, result, FNET_FALSE, file, line);
+
+    return result;
 }
 
 /************************************************************************
@@ -919,6 +1065,53 @@ unsigned long fnet_malloc_max( void )
     return fnet_mempool_malloc_max( fnet_mempool_main  );
 }
 
+/************************************************************************
+* NAME: fnet_mem_used
+*
+* DESCRIPTION: Returns a quantity of allocated memory.
+*              
+*************************************************************************/
+unsigned long fnet_mem_used( void )
+{
+    return fnet_mempool_used( fnet_mempool_main );
+}
+
+/************************************************************************
+* NAME: fnet_mem_high_water
+*
+* DESCRIPTION: Returns the high-water mark of allocated memory.
+*              
+*************************************************************************/
+unsigned long fnet_mem_high_water( void )
+{
+    return fnet_mempool_used_max( fnet_mempool_main );
+}
+
+/************************************************************************
+* NAME: fnet_free_mem_histogram
+*
+* DESCRIPTION: Returns the histogram of the free block sizes.
+*              
+*************************************************************************/
+unsigned long fnet_free_mem_histogram( unsigned long *histogram, int buckets )
+{
+    return fnet_mempool_free_histogram( fnet_mempool_main, histogram, buckets );
+}
+
+/************************************************************************
+* NAME: fnet_mem_high_water_reset
+*
+* DESCRIPTION: Restarts the high-water marks from the allocated memory.
+*              
+*************************************************************************/
+void fnet_mem_high_water_reset( void )
+{
+    fnet_mempool_used_max_reset( fnet_mempool_main );
+#if FNET_HEAP_SPLIT
+    fnet_mempool_used_max_reset( fnet_mempool_netbuf );
+#endif
+}
+
 /************************************************************************
 * NAME: fnet_mem_release
 *
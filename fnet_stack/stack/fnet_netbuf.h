@@ -59,7 +59,9 @@ typedef enum
     FNET_NETBUF_FLAG_BROADCAST              = 0x02,     /* Send/received as link-level broadcast. */
     FNET_NETBUF_FLAG_MULTICAST              = 0x04,     /* Send/received as link-level multicast. */
     FNET_NETBUF_FLAG_HW_IP_CHECKSUM         = 0x10,     /* IPv4 header checksum is calculated/checked by HW.*/
-    FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM   = 0x20      /* Protocol (UDP, TCP, ICMP) checksum is calculated/checked by HW.*/
+    FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM   = 0x20,     /* Protocol (UDP, TCP, ICMP) checksum is calculated/checked by HW.*/
+    FNET_NETBUF_FLAG_RX_TIMESTAMP           = 0x40,     /* timestamp is set by the Rx interrupt (FNET_CFG_LATENCY).*/
+    FNET_NETBUF_FLAG_TX_TIMESTAMP           = 0x80      /* timestamp is set by the transport layer (FNET_CFG_LATENCY).*/
 } fnet_netbuf_flag_t;
 
 /**************************************************************************/ /*!
@@ -87,29 +89,78 @@ typedef struct fnet_netbuf
     unsigned long       length;         /**< amount of actual data in this net_buf */
     unsigned long       total_length;   /**< length of buffer + additionally chained buffers (only for first netbuf)*/
     unsigned long       flags;
+#if FNET_CFG_LATENCY
+    unsigned long       timestamp;      /**< time stamp of the first netbuf, valid with the *_TIMESTAMP flags */
+#endif
 } fnet_netbuf_t;
 
+#if FNET_CFG_LATENCY
+    #define FNET_NETBUF_COPY_TIMESTAMP(to, from)    ((to)->timestamp = (from)->timestamp)
+#else
+    #define FNET_NETBUF_COPY_TIMESTAMP(to, from)    ((void)0)
+#endif
+
 #define FNET_NETBUF_COPYALL   (-1)
 
+/**************************************************************************/ /*!
+ * @internal
+ * @brief    Flag of the reference counter, set for a data buffer 
+ *           owned by the application (see fnet_netbuf_from_ref()).
+ ******************************************************************************/
+#define FNET_NETBUF_REF_EXTERNAL    (0x40000000)
+
+/**************************************************************************/ /*!
+ * @internal
+ * @brief    Descriptor of an external data buffer. 
+ *           The first field is shared with the reference counter 
+ *           of the internal data buffers.
+ ******************************************************************************/
+typedef struct
+{
+    int     reference_counter;          /**< Reference counter, ORed with FNET_NETBUF_REF_EXTERNAL.*/
+    void    (*handler)(void *cookie);   /**< Optional handler, called when the data buffer is not referenced anymore.*/
+    void    *cookie;                    /**< Handler-specific parameter.*/
+} fnet_netbuf_ref_t;
+
 /* Memory management functions */
 int fnet_heap_init( unsigned char *heap_ptr, unsigned long heap_size );
 void fnet_free( void *ap );
-void *fnet_malloc( unsigned nbytes );
+#if FNET_CFG_HEAP_PROFILE
+    /* Profiled allocation, records its call site.*/
+    void *fnet_malloc_site( unsigned nbytes, const char *file, int line );
+    #define fnet_malloc(nbytes)     fnet_malloc_site((nbytes), __FILE__, __LINE__)
+#else
+    void *fnet_malloc( unsigned nbytes );
+#endif
 unsigned long fnet_free_mem_status( void );
 unsigned long fnet_malloc_max( void );
+unsigned long fnet_mem_used( void );
+unsigned long fnet_mem_high_water( void );
+unsigned long fnet_free_mem_histogram( unsigned long *histogram, int buckets );
 void fnet_mem_release( void );
 
 void fnet_free_netbuf( void *ap );
-void *fnet_malloc_netbuf( unsigned nbytes );
+#if FNET_CFG_HEAP_PROFILE
+    void *fnet_malloc_netbuf_site( unsigned nbytes, const char *file, int line );
+    #define fnet_malloc_netbuf(nbytes)  fnet_malloc_netbuf_site((nbytes), __FILE__, __LINE__)
+#else
+    void *fnet_malloc_netbuf( unsigned nbytes );
+#endif
 unsigned long fnet_free_mem_status_netbuf( void );
 unsigned long fnet_malloc_max_netbuf( void );
+unsigned long fnet_mem_used_netbuf( void );
+unsigned long fnet_mem_high_water_netbuf( void );
+unsigned long fnet_free_mem_histogram_netbuf( unsigned long *histogram, int buckets );
 void fnet_mem_release_netbuf( void );
 
+void fnet_mem_high_water_reset( void );
+
 /* Netbuf service routines */
 fnet_netbuf_t *fnet_netbuf_new( int len, int drain );
 fnet_netbuf_t *fnet_netbuf_free( fnet_netbuf_t *nb );
 fnet_netbuf_t *fnet_netbuf_copy( fnet_netbuf_t *nb, int offset, int len, int drain );
 fnet_netbuf_t *fnet_netbuf_from_buf( void *data_ptr, int len,int drain );
+fnet_netbuf_t *fnet_netbuf_from_ref( const void *data_ptr, int len, void (*handler)(void *cookie), void *cookie, int drain );
 fnet_netbuf_t *fnet_netbuf_concat( fnet_netbuf_t *nb1, fnet_netbuf_t *nb2 );
 void fnet_netbuf_to_buf( fnet_netbuf_t *nb, int offset, int len, void *data_ptr );
 fnet_netbuf_t *fnet_netbuf_pullup( fnet_netbuf_t *nb, int len);
@@ -70,17 +70,34 @@
 
 fnet_netif_t *fnet_netif_list;           /* The list of network interfaces. */
 
+unsigned long fnet_netif_dst_generation; /* Generation of the destination caches.*/
+
 static fnet_netif_t *fnet_netif_default; /* Default net_if. */
 
 /* Duplicated IP event handler.*/
 static fnet_netif_dupip_handler_t fnet_netif_dupip_handler;
 
+#if FNET_CFG_IP4
+/* Maximum number of connected routes, one per interface.*/
+#define FNET_NETIF_IP4_ROUTE_CONNECTED_MAX  (FNET_CFG_CPU_ETH0 + FNET_CFG_CPU_ETH1 + FNET_CFG_LOOPBACK)
+#define FNET_NETIF_IP4_ROUTE_MAX            (FNET_CFG_IP4_ROUTE_TABLE_SIZE + FNET_NETIF_IP4_ROUTE_CONNECTED_MAX)
+
+/* IPv4 routing table, sorted for the longest-prefix match.*/
+static fnet_netif_ip4_route_t fnet_netif_ip4_route_table[FNET_NETIF_IP4_ROUTE_MAX];
+static unsigned int fnet_netif_ip4_route_number;         /* Number of routes in the table.*/
+static unsigned int fnet_netif_ip4_route_static_number;  /* Number of static routes in the table.*/
+#endif /* FNET_CFG_IP4 */
+
 
 /************************************************************************
 *     Function Prototypes
 *************************************************************************/
 
 static void fnet_netif_assign_scope_id( fnet_netif_t *netif );
+#if FNET_CFG_IP4
+static void fnet_netif_ip4_route_connected( fnet_netif_t *netif );
+static void fnet_netif_ip4_route_release( fnet_netif_t *netif );
+#endif
 #if FNET_CFG_IP6 && FNET_CFG_IP6_PMTU_DISCOVERY 
 static void fnet_netif_pmtu_timer( void *cookie);
 #endif
@@ -97,6 +114,10 @@ int fnet_netif_init_all( void )
     fnet_isr_lock();
 
     fnet_netif_list = fnet_netif_default = 0;
+
+#if FNET_CFG_IP4
+    fnet_netif_ip4_route_number = fnet_netif_ip4_route_static_number = 0;
+#endif
     
     /***********************************
      * Initialize IFs.
@@ -211,6 +232,25 @@ void fnet_netif_drain( void )
     fnet_isr_unlock();
 }
 
+/************************************************************************
+* NAME: fnet_netif_output_busy
+*
+* DESCRIPTION: Returns FNET_TRUE if the interface can not take 
+*              more outgoing packets now. In this case, it calls
+*              fnet_prot_output_resume(), when it is ready again.
+*************************************************************************/
+int fnet_netif_output_busy( fnet_netif_t *netif )
+{
+    int result;
+
+    if(netif->api->type == FNET_NETIF_TYPE_ETHERNET)
+        result = fnet_eth_output_busy(netif);
+    else
+        result = FNET_FALSE;
+
+    return result;
+}
+
 /************************************************************************
 * NAME: net_if_find
 *
@@ -333,6 +373,8 @@ void fnet_netif_set_pmtu(fnet_netif_t *netif, unsigned long pmtu)
     netif->pmtu = pmtu;
             
     netif->pmtu_timestamp = fnet_timer_ms();
+    
+    FNET_NETIF_DST_INVALIDATE();
 }
 
 /************************************************************************
@@ -374,6 +416,8 @@ void fnet_netif_pmtu_release(fnet_netif_t *netif)
     fnet_timer_free(netif->pmtu_timer);
     
     netif->pmtu = 0;
+    
+    FNET_NETIF_DST_INVALIDATE();
 }
 
 #endif /* FNET_CFG_IP6 && FNET_CFG_IP6_PMTU_DISCOVERY */
@@ -425,6 +469,11 @@ int fnet_netif_init( fnet_netif_t *netif, unsigned char *hw_addr, unsigned int h
             
             /* Set HW Address.*/    
             fnet_netif_set_hw_addr(netif, hw_addr, hw_addr_size);
+
+            #if FNET_CFG_IP4
+                /* Route to the subnet of the interface.*/
+                fnet_netif_ip4_route_connected(netif);
+            #endif
                 
             /* Interface-Type specific initialisation. */ 
             switch(netif->api->type)
@@ -440,6 +489,7 @@ int fnet_netif_init( fnet_netif_t *netif, unsigned char *hw_addr, unsigned int h
             }
         }     
 
+        FNET_NETIF_DST_INVALIDATE();
                
         fnet_isr_unlock();
         
@@ -464,6 +514,9 @@ void fnet_netif_release( fnet_netif_t *netif )
              
         fnet_os_mutex_lock();
 
+        /* The input routine walks the list with the interrupts locked.*/
+        fnet_isr_lock();
+
         if(netif->prev == 0)
             fnet_netif_list = netif->next;
         else
@@ -472,6 +525,14 @@ void fnet_netif_release( fnet_netif_t *netif )
         if(netif->next != 0)
             netif->next->prev = netif->prev;
 
+        fnet_isr_unlock();
+
+    #if FNET_CFG_IP4
+        fnet_netif_ip4_route_release(netif);
+    #endif
+        
+        FNET_NETIF_DST_INVALIDATE();
+
         fnet_os_mutex_unlock();
     }
 }
@@ -487,6 +548,7 @@ void fnet_netif_set_default( fnet_netif_desc_t netif_desc )
     {
         fnet_os_mutex_lock();
         fnet_netif_default = netif_desc;
+        FNET_NETIF_DST_INVALIDATE();
         fnet_os_mutex_unlock();
     }
 }
@@ -546,6 +608,10 @@ void fnet_netif_set_ip4_addr( fnet_netif_desc_t netif_desc, fnet_ip4_addr_t ipad
 
         if(netif->api->set_addr_notify)
             netif->api->set_addr_notify(netif);
+
+        fnet_netif_ip4_route_connected(netif);
+        
+        FNET_NETIF_DST_INVALIDATE();
     }
 
     fnet_os_mutex_unlock();
@@ -571,6 +637,8 @@ void fnet_netif_set_ip4_subnet_mask( fnet_netif_desc_t netif_desc, fnet_ip4_addr
         netif->ip4_addr.subnet = netif->ip4_addr.address & netif->ip4_addr.subnetmask; // network and subnet address
         netif->ip4_addr.subnetbroadcast = netif->ip4_addr.address
                                           | (~netif->ip4_addr.subnetmask);     // subnet broadcast address
+        fnet_netif_ip4_route_connected(netif);
+        FNET_NETIF_DST_INVALIDATE();
         fnet_os_mutex_unlock();
     }
 }
@@ -591,6 +659,7 @@ void fnet_netif_set_ip4_gateway( fnet_netif_desc_t netif_desc, fnet_ip4_addr_t g
         fnet_os_mutex_lock();
         netif->ip4_addr.gateway = gw;
         netif->ip4_addr.is_automatic = 0;
+        FNET_NETIF_DST_INVALIDATE();
         fnet_os_mutex_unlock();
     }
 }
@@ -684,6 +753,490 @@ fnet_ip4_addr_t fnet_netif_get_ip4_dns( fnet_netif_desc_t netif_desc )
 }    
 #endif /* FNET_CFG_DNS && FNET_CFG_IP4*/
 
+#if FNET_CFG_IP4
+/************************************************************************
+* NAME: fnet_netif_ip4_prefix_length
+*
+* DESCRIPTION: This function returns the number of leading bits 
+*              set in the netmask.
+*************************************************************************/
+static unsigned char fnet_netif_ip4_prefix_length( fnet_ip4_addr_t netmask )
+{
+    unsigned long   mask = fnet_ntohl(netmask);
+    unsigned char   prefix_length = 0;
+
+    while(mask & 0x80000000UL)
+    {
+        prefix_length++;
+        mask <<= 1;
+    }
+
+    return prefix_length;
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_mask_cmp
+*
+* DESCRIPTION: Compares the netmask keys of the routing table order.
+*              The longest prefix is the first.
+*************************************************************************/
+static int fnet_netif_ip4_route_mask_cmp( unsigned char prefix_length, fnet_ip4_addr_t netmask, const fnet_netif_ip4_route_t *route )
+{
+    int result = 0;
+
+    if(prefix_length != route->prefix_length)
+        result = (prefix_length > route->prefix_length) ? -1 : 1;
+    else if(netmask != route->netmask)
+        result = (netmask > route->netmask) ? -1 : 1;
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_cmp
+*
+* DESCRIPTION: Compares two routes in the routing table order:
+*              prefix length, network address and metric.
+*************************************************************************/
+static int fnet_netif_ip4_route_cmp( const fnet_netif_ip4_route_t *route1, const fnet_netif_ip4_route_t *route2 )
+{
+    int result = fnet_netif_ip4_route_mask_cmp(route1->prefix_length, route1->netmask, route2);
+
+    if(result == 0)
+    {
+        if(route1->net != route2->net)
+            result = (route1->net < route2->net) ? -1 : 1;
+        else if(route1->metric != route2->metric)
+            result = (route1->metric < route2->metric) ? -1 : 1;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_insert
+*
+* DESCRIPTION: Inserts the route keeping the routing table sorted.
+*************************************************************************/
+static int fnet_netif_ip4_route_insert( const fnet_netif_ip4_route_t *route )
+{
+    int             result = FNET_ERR;
+    unsigned int    i;
+
+    if(fnet_netif_ip4_route_number < FNET_NETIF_IP4_ROUTE_MAX)
+    {
+        i = fnet_netif_ip4_route_number;
+
+        while((i > 0) && (fnet_netif_ip4_route_cmp(route, &fnet_netif_ip4_route_table[i-1]) < 0))
+        {
+            fnet_netif_ip4_route_table[i] = fnet_netif_ip4_route_table[i-1];
+            i--;
+        }
+
+        fnet_netif_ip4_route_table[i] = *route;
+        fnet_netif_ip4_route_number++;
+
+        FNET_NETIF_DST_INVALIDATE();
+        result = FNET_OK;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_remove
+*
+* DESCRIPTION: Removes the route from the routing table.
+*************************************************************************/
+static void fnet_netif_ip4_route_remove( unsigned int index )
+{
+    if(fnet_netif_ip4_route_table[index].type == FNET_NETIF_IP4_ROUTE_TYPE_STATIC)
+        fnet_netif_ip4_route_static_number--;
+
+    fnet_netif_ip4_route_number--;
+
+    for(; index < fnet_netif_ip4_route_number; index++)
+    {
+        fnet_netif_ip4_route_table[index] = fnet_netif_ip4_route_table[index+1];
+    }
+
+    FNET_NETIF_DST_INVALIDATE();
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_connected
+*
+* DESCRIPTION: Updates the connected route of the interface, 
+*              after its address or subnet mask is changed.
+*************************************************************************/
+static void fnet_netif_ip4_route_connected( fnet_netif_t *netif )
+{
+    fnet_netif_ip4_route_t  route;
+    unsigned int            i;
+
+    fnet_isr_lock();
+
+    /* Delete the old connected route.*/
+    for(i = 0; i < fnet_netif_ip4_route_number; i++)
+    {
+        if((fnet_netif_ip4_route_table[i].netif == netif) 
+            && (fnet_netif_ip4_route_table[i].type == FNET_NETIF_IP4_ROUTE_TYPE_CONNECTED))
+        {
+            fnet_netif_ip4_route_remove(i);
+            break;
+        }
+    }
+
+    /* The interface without address has no subnet.*/
+    if(netif->ip4_addr.address != INADDR_ANY)
+    {
+        route.net = netif->ip4_addr.address & netif->ip4_addr.subnetmask;
+        route.netmask = netif->ip4_addr.subnetmask;
+        route.gateway = INADDR_ANY;
+        route.netif = netif;
+        route.mtu = 0;
+        route.metric = 0;
+        route.prefix_length = fnet_netif_ip4_prefix_length(route.netmask);
+        route.type = FNET_NETIF_IP4_ROUTE_TYPE_CONNECTED;
+        
+        fnet_netif_ip4_route_insert(&route);
+    }
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_release
+*
+* DESCRIPTION: Deletes all routes through the interface.
+*************************************************************************/
+static void fnet_netif_ip4_route_release( fnet_netif_t *netif )
+{
+    unsigned int i = 0;
+
+    fnet_isr_lock();
+
+    while(i < fnet_netif_ip4_route_number)
+    {
+        if(fnet_netif_ip4_route_table[i].netif == netif)
+            fnet_netif_ip4_route_remove(i);
+        else
+            i++;
+    }
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_netif_ip4_route_lookup
+*
+* DESCRIPTION: Looks for the route to the destination, 
+*              by the longest-prefix match.
+*              Entries with the same netmask are adjacent and sorted by 
+*              the network address, so each netmask group is searched 
+*              by the binary search.
+*              If there is no matching route, the default interface 
+*              and its gateway are used.
+*
+* RETURNS: Outgoing interface or FNET_NULL if there is no route.
+*          next_hop and mtu are optional.
+*************************************************************************/
+fnet_netif_t *fnet_netif_ip4_route_lookup( fnet_ip4_addr_t dest_ip, fnet_ip4_addr_t *next_hop, unsigned long *mtu )
+{
+    fnet_netif_ip4_route_t  *route = FNET_NULL;
+    fnet_netif_t            *netif;
+    fnet_ip4_addr_t         gateway;
+    fnet_ip4_addr_t         net;
+    unsigned int            first;
+    unsigned int            last;
+    unsigned int            low;
+    unsigned int            high;
+    unsigned int            middle;
+
+    for(first = 0; first < fnet_netif_ip4_route_number; first = last)
+    {
+        /* Find the end of the netmask group.*/
+        low = first + 1;
+        high = fnet_netif_ip4_route_number;
+
+        while(low < high)
+        {
+            middle = (low + high) >> 1;
+
+            if(fnet_netif_ip4_route_mask_cmp(fnet_netif_ip4_route_table[first].prefix_length, 
+                                             fnet_netif_ip4_route_table[first].netmask, 
+                                             &fnet_netif_ip4_route_table[middle]) == 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        last = low;
+
+        /* Find the first route to the network, it has the lowest metric.*/
+        net = dest_ip & fnet_netif_ip4_route_table[first].netmask;
+        low = first;
+        high = last;
+
+        while(low < high)
+        {
+            middle = (low + high) >> 1;
+
+            if(fnet_netif_ip4_route_table[middle].net < net)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        if((low < last) && (fnet_netif_ip4_route_table[low].net == net))
+        {
+            route = &fnet_netif_ip4_route_table[low];
+            break;
+        }
+    }
+
+    if(route)
+    {
+        netif = route->netif;
+        gateway = route->gateway;
+    }
+    else /* Default interface and its gateway.*/
+    {
+        netif = fnet_netif_default;
+        gateway = netif ? netif->ip4_addr.gateway : INADDR_ANY;
+    }
+
+    if(netif)
+    {
+        if(next_hop)
+            *next_hop = (gateway == INADDR_ANY) ? dest_ip : gateway;
+
+        if(mtu)
+            *mtu = (route && route->mtu && (route->mtu < netif->mtu)) ? route->mtu : netif->mtu;
+    }
+
+    return netif;
+}
+
+/************************************************************************
+* NAME: fnet_netif_add_ip4_route
+*
+* DESCRIPTION: This function adds a static route to the routing table.
+*************************************************************************/
+int fnet_netif_add_ip4_route( fnet_netif_desc_t netif_desc, fnet_ip4_addr_t net, fnet_ip4_addr_t netmask, 
+                              fnet_ip4_addr_t gateway, unsigned long mtu, unsigned long metric )
+{
+    fnet_netif_t            *netif = (fnet_netif_t *)netif_desc;
+    fnet_netif_ip4_route_t  route;
+    int                     result = FNET_ERR;
+    unsigned int            i;
+
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+
+    /* Select the interface by the connected route to the gateway.*/
+    if((netif == FNET_NULL) && (gateway != INADDR_ANY))
+    {
+        for(i = 0; i < fnet_netif_ip4_route_number; i++)
+        {
+            if((fnet_netif_ip4_route_table[i].type == FNET_NETIF_IP4_ROUTE_TYPE_CONNECTED)
+                && ((gateway & fnet_netif_ip4_route_table[i].netmask) == fnet_netif_ip4_route_table[i].net))
+            {
+                netif = fnet_netif_ip4_route_table[i].netif;
+                break;
+            }
+        }
+    }
+
+    route.prefix_length = fnet_netif_ip4_prefix_length(netmask);
+
+    /* The netmask must be contiguous.*/
+    if(netif && ((route.prefix_length == 32) || ((fnet_ntohl(netmask) << route.prefix_length) == 0)))
+    {
+        route.net = net & netmask;
+        route.netmask = netmask;
+        route.gateway = gateway;
+        route.netif = netif;
+        route.mtu = mtu;
+        route.metric = metric;
+        route.type = FNET_NETIF_IP4_ROUTE_TYPE_STATIC;
+
+        /* Replace the existing route.*/
+        for(i = 0; i < fnet_netif_ip4_route_number; i++)
+        {
+            if((fnet_netif_ip4_route_table[i].type == FNET_NETIF_IP4_ROUTE_TYPE_STATIC)
+                && (fnet_netif_ip4_route_table[i].net == route.net)
+                && (fnet_netif_ip4_route_table[i].netmask == route.netmask)
+                && (fnet_netif_ip4_route_table[i].gateway == route.gateway))
+            {
+                fnet_netif_ip4_route_remove(i);
+                break;
+            }
+        }
+
+        if((fnet_netif_ip4_route_static_number < FNET_CFG_IP4_ROUTE_TABLE_SIZE)
+            && (fnet_netif_ip4_route_insert(&route) == FNET_OK))
+        {
+            fnet_netif_ip4_route_static_number++;
+            result = FNET_OK;
+        }
+    }
+
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_del_ip4_route
+*
+* DESCRIPTION: This function deletes a static route from the routing table.
+*************************************************************************/
+int fnet_netif_del_ip4_route( fnet_ip4_addr_t net, fnet_ip4_addr_t netmask, fnet_ip4_addr_t gateway )
+{
+    int             result = FNET_ERR;
+    unsigned int    i = 0;
+
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+
+    while(i < fnet_netif_ip4_route_number)
+    {
+        if((fnet_netif_ip4_route_table[i].type == FNET_NETIF_IP4_ROUTE_TYPE_STATIC)
+            && (fnet_netif_ip4_route_table[i].net == (net & netmask))
+            && (fnet_netif_ip4_route_table[i].netmask == netmask)
+            && ((gateway == INADDR_ANY) || (fnet_netif_ip4_route_table[i].gateway == gateway)))
+        {
+            fnet_netif_ip4_route_remove(i);
+            result = FNET_OK;
+        }
+        else
+            i++;
+    }
+
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_get_ip4_route
+*
+* DESCRIPTION: This function retrieves the n-th entry of the routing table.
+*************************************************************************/
+int fnet_netif_get_ip4_route( unsigned int n, fnet_netif_ip4_route_info_t *route_info )
+{
+    int                     result = FNET_FALSE;
+    fnet_netif_ip4_route_t  *route;
+
+    fnet_os_mutex_lock();
+
+    if(route_info && (n < fnet_netif_ip4_route_number))
+    {
+        route = &fnet_netif_ip4_route_table[n];
+
+        route_info->net = route->net;
+        route_info->netmask = route->netmask;
+        route_info->gateway = route->gateway;
+        route_info->netif = route->netif;
+        route_info->mtu = route->mtu;
+        route_info->metric = route->metric;
+        route_info->type = route->type;
+
+        result = FNET_TRUE;
+    }
+
+    fnet_os_mutex_unlock();
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_add_ip4_arp_entry
+*
+* DESCRIPTION: This function adds a static entry to the ARP cache.
+*************************************************************************/
+int fnet_netif_add_ip4_arp_entry( fnet_netif_desc_t netif_desc, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t hw_addr )
+{
+    int             result = FNET_ERR;
+#if FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1
+    fnet_netif_t    *netif = (fnet_netif_t *)netif_desc;
+
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+
+    if(netif && hw_addr && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
+        result = fnet_arp_add_static(netif, ipaddr, hw_addr);
+
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+#else
+    FNET_COMP_UNUSED_ARG(netif_desc);
+    FNET_COMP_UNUSED_ARG(ipaddr);
+    FNET_COMP_UNUSED_ARG(hw_addr);
+#endif
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_del_ip4_arp_entry
+*
+* DESCRIPTION: This function deletes an entry from the ARP cache.
+*************************************************************************/
+int fnet_netif_del_ip4_arp_entry( fnet_netif_desc_t netif_desc, fnet_ip4_addr_t ipaddr )
+{
+    int             result = FNET_ERR;
+#if FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1
+    fnet_netif_t    *netif = (fnet_netif_t *)netif_desc;
+
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+
+    if(netif && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
+        result = fnet_arp_del(netif, ipaddr);
+
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+#else
+    FNET_COMP_UNUSED_ARG(netif_desc);
+    FNET_COMP_UNUSED_ARG(ipaddr);
+#endif
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_netif_get_ip4_arp_entry
+*
+* DESCRIPTION: This function retrieves the n-th entry of the ARP cache.
+*************************************************************************/
+int fnet_netif_get_ip4_arp_entry( fnet_netif_desc_t netif_desc, unsigned int n, fnet_netif_ip4_arp_info_t *arp_info )
+{
+    int             result = FNET_FALSE;
+#if FNET_CFG_CPU_ETH0 ||FNET_CFG_CPU_ETH1
+    fnet_netif_t    *netif = (fnet_netif_t *)netif_desc;
+
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+
+    if(netif && arp_info && (netif->api->type == FNET_NETIF_TYPE_ETHERNET))
+        result = fnet_arp_get_entry(netif, n, arp_info);
+
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+#else
+    FNET_COMP_UNUSED_ARG(netif_desc);
+    FNET_COMP_UNUSED_ARG(n);
+    FNET_COMP_UNUSED_ARG(arp_info);
+#endif
+
+    return result;
+}
+#endif /* FNET_CFG_IP4 */
+
 /************************************************************************
 * NAME: fnet_netif_get_name
 *
@@ -1328,6 +1881,8 @@ int fnet_netif_bind_ip6_addr_prv(fnet_netif_t *netif, fnet_ip6_addr_t *addr, fne
                 if_addr_ptr->state = FNET_NETIF_IP6_ADDR_STATE_PREFERRED; 
             }           
             
+            FNET_NETIF_DST_INVALIDATE();
+            
             
 
         //Check by type
@@ -1375,6 +1930,7 @@ int fnet_netif_unbind_ip6_addr_prv ( fnet_netif_t *netif, fnet_netif_ip6_addr_t
         fnet_netif_leave_ip6_multicast( (fnet_netif_desc_t)netif, &if_addr->solicited_multicast_addr );
         /* Mark as Not Used.*/
         if_addr->state = FNET_NETIF_IP6_ADDR_STATE_NOT_USED; 
+        FNET_NETIF_DST_INVALIDATE();
         result = FNET_OK;
     }
     else    
@@ -1383,6 +1939,29 @@ int fnet_netif_unbind_ip6_addr_prv ( fnet_netif_t *netif, fnet_netif_ip6_addr_t
     return result;
 } 
 
+/************************************************************************
+* NAME: fnet_netif_get_ip6_neighbor_stats
+*
+* DESCRIPTION: Retrieves the neighbor cache statistics of the interface.
+*************************************************************************/
+int fnet_netif_get_ip6_neighbor_stats(fnet_netif_desc_t netif_desc, fnet_netif_ip6_neighbor_stats_t *stats)
+{
+    int             result = FNET_ERR;
+    fnet_netif_t    *netif = (fnet_netif_t *)netif_desc;
+
+    fnet_isr_lock();
+
+    if(netif && stats && netif->nd6_if_ptr)
+    {
+        *stats = netif->nd6_if_ptr->neighbor_stats;
+        result = FNET_OK;
+    }
+
+    fnet_isr_unlock();
+
+    return result;
+}
+
 /************************************************************************
 * NAME: ip6_if_addr_timer
 *
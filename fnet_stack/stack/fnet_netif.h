@@ -83,6 +83,18 @@ struct fnet_netif_statistics
                               */
     unsigned long rx_packet; /**< @brief Rx packet count.
                               */
+    unsigned long rx_irq;    /**< @brief Rx interrupt count.@n
+                              * It is updated by drivers supporting
+                              * budgeted Rx polling, otherwise it is zero.
+                              */
+    unsigned long rx_poll;   /**< @brief Rx poll pass count.@n
+                              * It is updated by drivers supporting
+                              * budgeted Rx polling, otherwise it is zero.
+                              */
+    unsigned long rx_budget_exhausted; /**< @brief Number of Rx poll passes 
+                              * stopped by @ref FNET_CFG_CPU_ETH_RX_BUDGET 
+                              * with frames left in the Rx ring.
+                              */
 };
 
 /**************************************************************************/ /*!
@@ -138,6 +150,66 @@ typedef struct fnet_netif_ip6_addr_info
     fnet_netif_ip6_addr_type_t  type;               /**< @brief How the address was acquired.*/
 } fnet_netif_ip6_addr_info_t;
 
+/**************************************************************************/ /*!
+ * @brief Neighbor cache statistics of an interface.
+ * @see fnet_netif_get_ip6_neighbor_stats()
+ ******************************************************************************/
+typedef struct fnet_netif_ip6_neighbor_stats
+{
+    unsigned long   resolved;           /**< @brief Number of address resolutions completed 
+                                         *   with packets waiting for them.*/
+    unsigned long   resolve_time_total; /**< @brief Sum of the resolution times, in milliseconds. 
+                                         *   The average is @c resolve_time_total/resolved.*/
+    unsigned long   resolve_time_max;   /**< @brief Maximum resolution time, in milliseconds.*/
+    unsigned long   failed;             /**< @brief Number of failed address resolutions.*/
+    unsigned long   evicted;            /**< @brief Number of entries replaced, because the cache was full.*/
+    unsigned long   queue_drops;        /**< @brief Number of waiting packets discarded, 
+                                         *   because the queue of the neighbor was full.*/
+    unsigned long   entry_drops;        /**< @brief Number of waiting packets discarded, 
+                                         *   because the neighbor entry was deleted.*/
+} fnet_netif_ip6_neighbor_stats_t;
+
+/**************************************************************************/ /*!
+ * @brief Possible IPv4 route types.
+ * @see fnet_netif_get_ip4_route(), fnet_netif_ip4_route_info
+ ******************************************************************************/
+typedef enum
+{
+    FNET_NETIF_IP4_ROUTE_TYPE_CONNECTED = 0,    /**< @brief The route to the subnet of an interface. 
+                                                 * It is maintained automatically.*/
+    FNET_NETIF_IP4_ROUTE_TYPE_STATIC = 1        /**< @brief The route is added by @ref fnet_netif_add_ip4_route().*/
+} fnet_netif_ip4_route_type_t;
+
+/**************************************************************************/ /*!
+ * @brief IPv4 route information structure.
+ * @see fnet_netif_get_ip4_route()
+ ******************************************************************************/
+typedef struct fnet_netif_ip4_route_info
+{
+    fnet_ip4_addr_t             net;        /**< @brief Destination network address.*/
+    fnet_ip4_addr_t             netmask;    /**< @brief Destination network mask.*/
+    fnet_ip4_addr_t             gateway;    /**< @brief Next-hop gateway address. 
+                                             *   @c INADDR_ANY if the network is on-link.*/
+    fnet_netif_desc_t           netif;      /**< @brief Outgoing network interface.*/
+    unsigned long               mtu;        /**< @brief Route MTU. @c 0 means the interface MTU.*/
+    unsigned long               metric;     /**< @brief Route metric. Lower value is preferred.*/
+    fnet_netif_ip4_route_type_t type;       /**< @brief How the route was created.*/
+} fnet_netif_ip4_route_info_t;
+
+/**************************************************************************/ /*!
+ * @brief ARP cache entry information structure.
+ * @see fnet_netif_get_ip4_arp_entry()
+ ******************************************************************************/
+typedef struct fnet_netif_ip4_arp_info
+{
+    fnet_ip4_addr_t     ip4_addr;   /**< @brief IPv4 address.*/
+    fnet_mac_addr_t     hw_addr;    /**< @brief Hardware address. 
+                                     *   It is zero, if the entry is not resolved yet.*/
+    int                 is_static;  /**< @brief @c FNET_TRUE if the entry is added by 
+                                     *   @ref fnet_netif_add_ip4_arp_entry().@n
+                                     *   @c FNET_FALSE if the entry is learned by ARP.*/
+} fnet_netif_ip4_arp_info_t;
+
 /***************************************************************************/ /*!
  *
  * @brief    Looks for a network interface according to the specified name.
@@ -415,6 +487,174 @@ fnet_ip4_addr_t fnet_netif_get_ip4_dns( fnet_netif_desc_t netif );
 
 #endif /*FNET_CFG_DNS*/
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Adds a static route to the IPv4 routing table.
+ *
+ * @param netif     Outgoing network interface descriptor. @n
+ *                  If it is @ref FNET_NULL, the interface is selected 
+ *                  by the connected route to the @c gateway.
+ *
+ * @param net       Destination network address.
+ *
+ * @param netmask   Destination network mask. It must be contiguous. @n
+ *                  The @c 0.0.0.0 mask defines a default route.
+ *
+ * @param gateway   Next-hop gateway address. @n
+ *                  @c INADDR_ANY means the network is directly reachable 
+ *                  through the @c netif interface.
+ *
+ * @param mtu       Route MTU. @n
+ *                  @c 0 means the MTU of the @c netif interface.
+ *
+ * @param metric    Route metric. Lower value is preferred between routes 
+ *                  with the same prefix.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the parameters are wrong or the table is full.
+ *
+ * @see fnet_netif_del_ip4_route(), fnet_netif_get_ip4_route(), 
+ *      FNET_CFG_IP4_ROUTE_TABLE_SIZE
+ *
+ ******************************************************************************
+ *
+ * This function adds the route to the @c net/netmask network into 
+ * the IPv4 routing table. If a static route to the same network through 
+ * the same gateway exists, it is updated. @n
+ * Outgoing IPv4 packets are routed by the longest-prefix match. 
+ * If no route matches, the packet is sent through the default 
+ * interface and its gateway.@n
+ * The routes of an interface are removed when the interface is released.
+ *
+ ******************************************************************************/
+int fnet_netif_add_ip4_route( fnet_netif_desc_t netif, fnet_ip4_addr_t net, fnet_ip4_addr_t netmask, 
+                              fnet_ip4_addr_t gateway, unsigned long mtu, unsigned long metric );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Deletes a static route from the IPv4 routing table.
+ *
+ * @param net       Destination network address.
+ *
+ * @param netmask   Destination network mask.
+ *
+ * @param gateway   Next-hop gateway address. @n
+ *                  @c INADDR_ANY deletes all static routes 
+ *                  to the @c net/netmask network.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if the route is deleted.
+ *   - @ref FNET_ERR if there is no such static route.
+ *
+ * @see fnet_netif_add_ip4_route()
+ *
+ ******************************************************************************
+ *
+ * This function deletes the static route to the @c net/netmask network.@n
+ * Connected routes can not be deleted.
+ *
+ ******************************************************************************/
+int fnet_netif_del_ip4_route( fnet_ip4_addr_t net, fnet_ip4_addr_t netmask, fnet_ip4_addr_t gateway );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves an entry of the IPv4 routing table.
+ *
+ * @param n           Sequence number of the route to retrieve (from @c 0).
+ *
+ * @param route_info  Pointer to route information structure will contain the result.
+ *
+ * @return This function returns:
+ *   - @ref FNET_TRUE if no error occurs and data structure is filled.
+ *   - @ref FNET_FALSE in case of error or @c n-th route is not available.
+ *
+ * @see fnet_netif_add_ip4_route()
+ *
+ ******************************************************************************
+ *
+ * This function is used to retrieve all entries of the IPv4 routing table,
+ * in the order they are matched.
+ *
+ ******************************************************************************/
+int fnet_netif_get_ip4_route( unsigned int n, fnet_netif_ip4_route_info_t *route_info );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Adds a static entry to the ARP cache.
+ *
+ * @param netif     Network interface descriptor. It must be an Ethernet interface.
+ *
+ * @param ipaddr    IPv4 address.
+ *
+ * @param hw_addr   Hardware address of the @c ipaddr host.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the parameters are wrong or all cache entries are static.
+ *
+ * @see fnet_netif_del_ip4_arp_entry(), fnet_netif_get_ip4_arp_entry(), 
+ *      FNET_CFG_ARP_TABLE_SIZE
+ *
+ ******************************************************************************
+ *
+ * This function adds the permanent entry to the ARP cache of 
+ * the @c netif interface. If a dynamic entry for @c ipaddr exists, 
+ * it becomes static. @n
+ * A static entry never expires, it is not replaced when the cache is full, 
+ * and it is not changed by received ARP packets. 
+ * It is removed only by @ref fnet_netif_del_ip4_arp_entry().
+ *
+ ******************************************************************************/
+int fnet_netif_add_ip4_arp_entry( fnet_netif_desc_t netif, fnet_ip4_addr_t ipaddr, const fnet_mac_addr_t hw_addr );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Deletes an entry from the ARP cache.
+ *
+ * @param netif     Network interface descriptor.
+ *
+ * @param ipaddr    IPv4 address.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if the entry is deleted.
+ *   - @ref FNET_ERR if there is no such entry.
+ *
+ * @see fnet_netif_add_ip4_arp_entry()
+ *
+ ******************************************************************************
+ *
+ * This function deletes the static or dynamic entry of @c ipaddr 
+ * from the ARP cache of the @c netif interface. 
+ * Packets waiting for its resolution are discarded.
+ *
+ ******************************************************************************/
+int fnet_netif_del_ip4_arp_entry( fnet_netif_desc_t netif, fnet_ip4_addr_t ipaddr );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves an entry of the ARP cache.
+ *
+ * @param netif       Network interface descriptor.
+ *
+ * @param n           Sequence number of the entry to retrieve (from @c 0).
+ *
+ * @param arp_info    Pointer to entry information structure will contain the result.
+ *
+ * @return This function returns:
+ *   - @ref FNET_TRUE if no error occurs and data structure is filled.
+ *   - @ref FNET_FALSE in case of error or @c n-th entry is not available.
+ *
+ * @see fnet_netif_add_ip4_arp_entry()
+ *
+ ******************************************************************************
+ *
+ * This function is used to retrieve all entries of the ARP cache
+ * of the @c netif interface, from the most recently used.
+ *
+ ******************************************************************************/
+int fnet_netif_get_ip4_arp_entry( fnet_netif_desc_t netif, unsigned int n, fnet_netif_ip4_arp_info_t *arp_info );
+
 
 /***************************************************************************/ /*!
  *
@@ -761,6 +1001,29 @@ int fnet_netif_bind_ip6_addr(fnet_netif_desc_t netif_desc, fnet_ip6_addr_t *addr
  ******************************************************************************/
 int fnet_netif_unbind_ip6_addr(fnet_netif_desc_t netif_desc, fnet_ip6_addr_t *addr);
 
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the neighbor cache statistics of the specified 
+ *           network interface.
+ *
+ * @param netif_desc  Network interface descriptor.
+ *
+ * @param stats       Pointer to the statistics structure will contain the result.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the interface has no neighbor cache.
+ *
+ * @see FNET_CFG_ND6_NEIGHBOR_CACHE_SIZE, FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE
+ *
+ ******************************************************************************
+ *
+ * This function returns the address resolution latency and 
+ * the drop counters of the IPv6 neighbor cache of the @c netif interface.
+ *
+ ******************************************************************************/
+int fnet_netif_get_ip6_neighbor_stats(fnet_netif_desc_t netif_desc, fnet_netif_ip6_neighbor_stats_t *stats);
+
 #endif /* FNET_CFG_IP6 */
 
 /***************************************************************************/ /*!
@@ -190,11 +190,65 @@ typedef struct fnet_netif
 #endif    
  } fnet_netif_t;
 
+/**************************************************************************/ /*!
+ * @internal
+ * @brief    Destination cache entry.
+ *           A connected socket keeps one, so the route, the source address,
+ *           the MTU and the next-hop link-layer address are not looked up 
+ *           for every packet. The entry is valid while @c netif is set and 
+ *           @c generation is equal to @ref fnet_netif_dst_generation.
+ ******************************************************************************/
+typedef struct fnet_netif_dst
+{
+    unsigned long           generation;     /* Value of fnet_netif_dst_generation, when the entry was filled.*/
+    fnet_netif_t            *netif;         /* Outgoing interface.*/
+    unsigned long           mtu;            /* MTU of the path.*/
+#if FNET_CFG_IP4
+    fnet_ip4_addr_t         ip4_next_hop;   /* IPv4 next-hop address of the route.*/
+#endif
+    int                     ll_addr_valid;  /* FNET_TRUE if ll_addr contains the next-hop address.*/
+    fnet_mac_addr_t         ll_addr;        /* Link-layer address of the next hop.*/
+#if FNET_CFG_IP6
+    fnet_ip6_addr_t         ip6_src;        /* Selected IPv6 source address.*/
+#endif
+} fnet_netif_dst_t;
+
+/* Checks if the destination cache entry is still valid.*/
+#define FNET_NETIF_DST_IS_VALID(dst)    (((dst)->netif != FNET_NULL) && ((dst)->generation == fnet_netif_dst_generation))
+
+/* Invalidates the destination cache entry of one socket.*/
+#define FNET_NETIF_DST_RESET(dst)       ((dst)->netif = FNET_NULL)
+
+/* Invalidates all destination cache entries. 
+ * Called on any address, route, ARP or ND change.*/
+#define FNET_NETIF_DST_INVALIDATE()     (fnet_netif_dst_generation++)
+
+#if FNET_CFG_IP4
+/**************************************************************************/ /*!
+ * @internal
+ * @brief    IPv4 routing table entry.
+ *           The table is kept sorted by prefix length (longest first),
+ *           then by network address and by metric, so the longest-prefix
+ *           match is done by a binary search inside each prefix length.
+ ******************************************************************************/
+typedef struct fnet_netif_ip4_route
+{
+    fnet_ip4_addr_t                 net;            /* Destination network address.*/
+    fnet_ip4_addr_t                 netmask;        /* Destination network mask.*/
+    fnet_ip4_addr_t                 gateway;        /* Next-hop address. INADDR_ANY for on-link.*/
+    fnet_netif_t                    *netif;         /* Outgoing interface.*/
+    unsigned long                   mtu;            /* Route MTU. 0 means the interface MTU.*/
+    unsigned long                   metric;         /* Route metric. Lower is preferred.*/
+    unsigned char                   prefix_length;  /* Number of bits set in netmask.*/
+    fnet_netif_ip4_route_type_t     type;           /* Connected or static.*/
+} fnet_netif_ip4_route_t;
+#endif /* FNET_CFG_IP4 */
 
 /************************************************************************
 *     Global Data Structures
 *************************************************************************/
 extern fnet_netif_t *fnet_netif_list;   /* The list of network interfaces.*/
+extern unsigned long fnet_netif_dst_generation; /* Generation of the destination caches.*/
 
 
 /************************************************************************
@@ -205,9 +259,14 @@ void fnet_netif_release_all( void );
 int fnet_netif_init(fnet_netif_t *netif, unsigned char *hw_addr, unsigned int hw_addr_size);
 void fnet_netif_release( fnet_netif_t *netif );
 void fnet_netif_drain( void );
+int fnet_netif_output_busy( fnet_netif_t *netif );
 void fnet_netif_set_ip4_addr_automatic( fnet_netif_desc_t netif );
 void fnet_netif_dupip_handler_signal( fnet_netif_desc_t netif );
 
+#if FNET_CFG_IP4
+    fnet_netif_t *fnet_netif_ip4_route_lookup( fnet_ip4_addr_t dest_ip, fnet_ip4_addr_t *next_hop, unsigned long *mtu );
+#endif
+
 
 #if FNET_CFG_IP6
     fnet_netif_ip6_addr_t *fnet_netif_get_ip6_addr_info(fnet_netif_t *netif, fnet_ip6_addr_t *ip_addr);
@@ -224,3 +224,19 @@ void fnet_prot_drain( void )
     
     fnet_netif_drain();
 }
+
+/************************************************************************
+* NAME: fnet_prot_output_resume
+*
+* DESCRIPTION: Called by the network interface, when it can take 
+*              outgoing packets again, after it has reported 
+*              the busy state (see fnet_netif_output_busy()).
+*************************************************************************/
+void fnet_prot_output_resume( fnet_netif_t *netif )
+{
+#if FNET_CFG_TCP
+    fnet_tcp_output_resume(netif);
+#else
+    FNET_COMP_UNUSED_ARG(netif);
+#endif
+}
@@ -97,6 +97,7 @@ typedef struct fnet_prot_if
     
 #if FNET_CFG_IP6    
     void                    (*prot_input_ip6)(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t *nb, fnet_netbuf_t *ip6_nb); /* Protocol IPv6 input function.*/
+    void                    (*prot_control_input_ip6)(fnet_prot_notify_t command, fnet_ip6_header_t *ip6_hdr);  /* (Optional) Protocol IPv6 input control function.*/ 
 #endif /* FNET_CFG_IP6 */
     
     const fnet_socket_prot_if_t *socket_api;    /* Pointer to Transport Protocol API structure.*/
@@ -111,5 +112,6 @@ int fnet_prot_init( void );
 void fnet_prot_release( void );
 fnet_prot_if_t *fnet_prot_find( fnet_address_family_t family, fnet_socket_type_t type, int protocol );
 void fnet_prot_drain( void );
+void fnet_prot_output_resume( fnet_netif_t *netif );
 
 #endif
@@ -86,6 +86,9 @@ static const fnet_socket_prot_if_t fnet_raw_socket_api =
     fnet_ip_setsockopt,     /* Protocol "setsockopt" function.*/
     fnet_ip_getsockopt,     /* Protocol "getsockopt" function.*/
     0,                      /* Protocol "listen" function.*/
+    0,                      /* Protocol "send without copying" function.*/
+    0,                      /* Protocol "send datagrams" function.*/
+    0                       /* Protocol "receive datagrams" function.*/
 };
 
 fnet_prot_if_t fnet_raw_prot_if =
@@ -103,6 +106,7 @@ fnet_prot_if_t fnet_raw_prot_if =
     0,                      /* protocol drain function.*/
 #if FNET_CFG_IP6    
     fnet_raw_input_ip6,      /* Protocol input function, from IPv6.*/
+    0,                      /* Protocol input control function, from IPv6.*/
 #endif /* FNET_CFG_IP6 */      
     &fnet_raw_socket_api    /* Socket API */
 };
@@ -145,7 +149,7 @@ static int fnet_raw_output(  struct sockaddr *src_addr, const struct sockaddr *d
                                     sockoption->ip_opt.ttl, 
                                 #endif /* FNET_CFG_MULTICAST */                               
                                    nb, 0, ((sockoption->flags & SO_DONTROUTE) > 0),
-                                   0
+                                   0, FNET_NULL
                                    );
     }
 #endif
@@ -160,7 +164,7 @@ static int fnet_raw_output(  struct sockaddr *src_addr, const struct sockaddr *d
                                 fnet_socket_addr_is_unspecified(src_addr)? FNET_NULL : &((struct sockaddr_in6 *)(src_addr))->sin6_addr.s6_addr, 
                                 &((struct sockaddr_in6 *)(dest_addr))->sin6_addr.s6_addr, 
                                 protocol_number, 
-                                sockoption->ip6_opt.unicast_hops, nb,0);
+                                sockoption->ip6_opt.unicast_hops, nb, 0, FNET_NULL);
     }
 #endif                               
 
@@ -51,6 +51,7 @@
 #include "fnet_isr.h"
 #include "fnet_stdlib.h"
 #include "fnet_prot.h"
+#include "fnet_latency_prv.h"
 #include "fnet_debug.h"
 #include "fnet.h"
 #include "fnet_stdlib.h"
@@ -376,6 +377,7 @@ fnet_socket_t *fnet_socket_copy( fnet_socket_t *sock )
         sock_cp->send_buffer.net_buf_chain = 0;
         sock_cp->options.error = FNET_OK;
         sock_cp->options.local_error = FNET_OK;
+        FNET_NETIF_DST_RESET(&sock_cp->dst_cache);
         return (sock_cp);
     }
     else
@@ -572,6 +574,9 @@ int connect( SOCKET s, struct sockaddr *name, int namelen )
 
         sock->local_addr = local_addr_tmp;
         
+        /* The cached destination belongs to the previous peer.*/
+        FNET_NETIF_DST_RESET(&sock->dst_cache);
+        
         /* Start the appropriate protocol connection.*/
         if(sock->protocol_interface->socket_api->prot_connect)
             result = sock->protocol_interface->socket_api->prot_connect(sock, &foreign_addr);
@@ -930,6 +935,9 @@ int sendto( SOCKET s, char *buf, int len, int flags, const struct sockaddr *to,
     fnet_socket_t   *sock;
     int             error;
     int             result = FNET_OK;
+#if FNET_CFG_LATENCY
+    unsigned long   latency_stamp;
+#endif
 
     fnet_os_mutex_lock();
 
@@ -972,7 +980,13 @@ int sendto( SOCKET s, char *buf, int len, int flags, const struct sockaddr *to,
 
             if(sock->protocol_interface->socket_api->prot_snd)
             {
+            #if FNET_CFG_LATENCY
+                latency_stamp = FNET_LATENCY_STAMP();
+            #endif
                 result = sock->protocol_interface->socket_api->prot_snd(sock, buf, len, flags, to);
+            #if FNET_CFG_LATENCY
+                FNET_LATENCY_SINCE(FNET_LATENCY_TX_SEND, latency_stamp);
+            #endif
             }
             else
             {
@@ -1004,6 +1018,127 @@ ERROR:
 }
 
 
+/************************************************************************
+* NAME: fnet_send_ref
+*
+* DESCRIPTION: This function sends the application-owned data 
+*              on a connected socket without copying. 
+*************************************************************************/
+int fnet_send_ref( SOCKET s, const char *buf, int len, int flags, fnet_send_ref_handler_t handler, void *cookie )
+{
+    fnet_socket_t   *sock;
+    int             error;
+    int             result;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        if(fnet_socket_addr_is_unspecified(&sock->foreign_addr))
+        {
+            error = FNET_ERR_NOTCONN; /* Socket is not connected.*/
+            goto ERROR_SOCK;
+        }
+
+        if(buf && (len >= 0))
+        {
+            /* If the socket is shutdowned, return.*/
+            if(sock->send_buffer.is_shutdown)
+            {
+                error = FNET_ERR_SHUTDOWN;
+                goto ERROR_SOCK;
+            }
+
+            if(sock->protocol_interface->socket_api->prot_snd_ref)
+            {
+                result = sock->protocol_interface->socket_api->prot_snd_ref(sock, buf, len, flags, handler, cookie);
+            }
+            else
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+        }
+        else
+        {
+            error = FNET_ERR_INVAL; /* Invalid argument.*/
+            goto ERROR_SOCK;
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (result);
+
+ERROR_SOCK:
+    fnet_socket_set_error(sock, error);
+
+ERROR:
+    fnet_os_mutex_unlock();
+    return (SOCKET_ERROR);
+}
+
+/************************************************************************
+* NAME: fnet_sendmmsg
+*
+* DESCRIPTION: This function sends several datagrams in one call. 
+*************************************************************************/
+int fnet_sendmmsg( SOCKET s, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags )
+{
+    fnet_socket_t   *sock;
+    int             error;
+    int             result;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        if(msgvec && vlen)
+        {
+            /* If the socket is shutdowned, return.*/
+            if(sock->send_buffer.is_shutdown)
+            {
+                error = FNET_ERR_SHUTDOWN;
+                goto ERROR_SOCK;
+            }
+
+            if(sock->protocol_interface->socket_api->prot_sndmmsg)
+            {
+                result = sock->protocol_interface->socket_api->prot_sndmmsg(sock, msgvec, vlen, flags);
+            }
+            else
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+        }
+        else
+        {
+            error = FNET_ERR_INVAL; /* Invalid argument.*/
+            goto ERROR_SOCK;
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (result);
+
+ERROR_SOCK:
+    fnet_socket_set_error(sock, error);
+
+ERROR:
+    fnet_os_mutex_unlock();
+    return (SOCKET_ERROR);
+}
+
 /************************************************************************
 * NAME: recv
 *
@@ -1088,6 +1223,70 @@ ERROR:
     return (SOCKET_ERROR);
 }
 
+/************************************************************************
+* NAME: fnet_recvmmsg
+*
+* DESCRIPTION: This function receives several datagrams in one call. 
+*************************************************************************/
+int fnet_recvmmsg( SOCKET s, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags )
+{
+    fnet_socket_t   *sock;
+    int             error;
+    int             result;
+
+    fnet_os_mutex_lock();
+
+    if((sock = fnet_socket_desc_find(s)) != 0)
+    {
+        if(msgvec && vlen && ((flags & MSG_PEEK) == 0))
+        {
+            /* The sockets must be bound before calling recv.*/
+            if(sock->local_addr.sa_port == 0)
+            {
+                error = FNET_ERR_BOUNDREQ; /* The socket has not been bound with bind().*/
+                goto ERROR_SOCK;
+            }
+
+            /* If the socket is shutdowned, return.*/
+            if(sock->receive_buffer.is_shutdown)
+            {
+                error = FNET_ERR_SHUTDOWN;
+                goto ERROR_SOCK;
+            }
+
+            if(sock->protocol_interface->socket_api->prot_rcvmmsg)
+            {
+                result = sock->protocol_interface->socket_api->prot_rcvmmsg(sock, msgvec, vlen, flags);
+            }
+            else
+            {
+                error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+                goto ERROR_SOCK;
+            }
+        }
+        else
+        {
+            error = FNET_ERR_INVAL; /* Invalid argument.*/
+            goto ERROR_SOCK;
+        }
+    }
+    else
+    {
+        fnet_error_set(FNET_ERR_BAD_DESC);/* Bad descriptor.*/
+        goto ERROR;
+    }
+
+    fnet_os_mutex_unlock();
+    return (result);
+
+ERROR_SOCK:
+    fnet_socket_set_error(sock, error);
+
+ERROR:
+    fnet_os_mutex_unlock();
+    return (SOCKET_ERROR);
+}
+
 /************************************************************************
 * NAME: getsockname
 *
@@ -1549,6 +1748,8 @@ int fnet_socket_buffer_append_address( fnet_socket_buffer_t *sb, fnet_netbuf_t *
 
     sb->count += nb->total_length;
 
+    FNET_LATENCY_RX(FNET_LATENCY_RX_SOCKET, nb);
+
     nb = fnet_netbuf_concat(nb_addr, nb);
     fnet_netbuf_add_chain(&sb->net_buf_chain, nb);
     fnet_isr_unlock();
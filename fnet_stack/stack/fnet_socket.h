@@ -104,6 +104,18 @@
 * address.</td><td>X</td><td>X</td><td>@n</td><td>X</td>
 * </tr>
 * <tr>
+* <td>input</td><td>@ref fnet_recvmmsg()</td><td>Receives several datagrams 
+* in one call.</td><td>X</td><td>X</td><td>@n</td><td>X</td>
+* </tr>
+* <tr>
+* <td>output</td><td>@ref fnet_sendmmsg()</td><td>Sends several datagrams 
+* in one call.</td><td>X</td><td>X</td><td>@n</td><td>X</td>
+* </tr>
+* <tr>
+* <td>output</td><td>@ref fnet_send_ref()</td><td>Sends the application-owned 
+* data without copying.</td><td>X</td><td>X</td><td>X</td><td>@n</td>
+* </tr>
+* <tr>
 * <td>termination</td><td>@ref shutdown()</td><td>Terminates a connection 
 * in one or both directions.</td><td>X</td><td>X</td><td>X</td><td>X</td>
 * </tr>
@@ -532,6 +544,9 @@ typedef enum
  *<tr>
  *<td>@ref TCP_KEEPCNT</td><td>int</td><td>8</td><td>RW</td>
  *</tr>  
+ *<tr>
+ *<td>@ref TCP_INFO</td><td>@ref tcp_info</td><td>N/A</td><td>R</td>
+ *</tr>  
  *</table>
  ******************************************************************************/
 typedef enum
@@ -612,7 +627,7 @@ typedef enum
                              *   a given socket, and specifies the number of seconds to wait before
                              *   retransmitting a keepalive probe.  
                              */                           
-    TCP_KEEPCNT = (0x80)    /**< @brief When the @ref SO_KEEPALIVE option is enabled, TCP probes a connection that
+    TCP_KEEPCNT = (0x80),   /**< @brief When the @ref SO_KEEPALIVE option is enabled, TCP probes a connection that
                              *   has been idle for some amount of time.  If the remote system does not
                              *   respond to a keepalive probe, TCP retransmits the probe a certain
                              *   number of times before a connection is considered to be broken.  The
@@ -620,6 +635,11 @@ typedef enum
                              *   @ref TCP_KEEPCNT option can be used to affect this value for a given socket,
                              *   and specifies the maximum number of keepalive probes to be sent.
                              */                            
+    TCP_INFO = (0x100)      /**< @brief This option returns the current state of the 
+                             *   connection, defined by the @ref tcp_info structure. @n
+                             *   It is used to find out why a connection is slow.@n
+                             *   This is the read-only option.
+                             */
 } fnet_tcp_options_t;
 
 /**************************************************************************/ /*!
@@ -717,6 +737,82 @@ struct linger
                               */
 };
 
+/**************************************************************************/ /*!
+ * @brief This structure is used for the @ref TCP_INFO option.
+ ******************************************************************************/
+struct tcp_info
+{
+    unsigned long tcpi_state;           /**< @brief Connection state (RFC793):@n
+                                         * @c 0 = CLOSED, @c 1 = SYN-SENT, @c 2 = SYN-RECEIVED, 
+                                         * @c 3 = LISTEN, @c 4 = ESTABLISHED, @c 5 = FIN-WAIT-1, 
+                                         * @c 6 = FIN-WAIT-2, @c 7 = CLOSE-WAIT, @c 8 = CLOSING, 
+                                         * @c 9 = LAST-ACK, @c 10 = TIME-WAIT.
+                                         */
+    unsigned long tcpi_rto;             /**< @brief Retransmission timeout, in milliseconds.
+                                         */
+    unsigned long tcpi_srtt;            /**< @brief Smoothed round trip time, in milliseconds.@n
+                                         * It is @c 0, if no round trip time is measured yet.
+                                         */
+    unsigned long tcpi_rttvar;          /**< @brief Round trip time variance, in milliseconds.
+                                         */
+    unsigned long tcpi_snd_mss;         /**< @brief Maximal size of the sent segments.
+                                         */
+    unsigned long tcpi_rcv_mss;         /**< @brief Maximal size of the received segments.
+                                         */
+    unsigned long tcpi_snd_cwnd;        /**< @brief Congestion window, in bytes.
+                                         */
+    unsigned long tcpi_snd_ssthresh;    /**< @brief Slow start threshold, in bytes.
+                                         */
+    unsigned long tcpi_snd_wnd;         /**< @brief Send window advertised by the peer, in bytes.
+                                         */
+    unsigned long tcpi_rcv_wnd;         /**< @brief Receive window advertised to the peer, in bytes.
+                                         */
+    unsigned long tcpi_unacked;         /**< @brief Sent bytes not acknowledged yet (in flight).
+                                         */
+    unsigned long tcpi_retransmits;     /**< @brief Retransmissions on the retransmission timeout.
+                                         */
+    unsigned long tcpi_fast_retransmits;/**< @brief Fast retransmissions.
+                                         */
+    unsigned long tcpi_dupacks;         /**< @brief Received duplicate acknowledgments.
+                                         */
+    unsigned long tcpi_rcv_ooo;         /**< @brief Out-of-order received bytes, waiting for 
+                                         * the missing data.@n
+                                         * It is always @c 0 if the 
+                                         * @ref FNET_CFG_TCP_DISCARD_OUT_OF_ORDER is set.
+                                         */
+    unsigned long tcpi_snd_buf;         /**< @brief Bytes in the socket output buffer.
+                                         */
+    unsigned long tcpi_snd_buf_size;    /**< @brief Size of the socket output buffer.
+                                         */
+    unsigned long tcpi_rcv_buf;         /**< @brief Bytes in the socket input buffer.
+                                         */
+    unsigned long tcpi_rcv_buf_size;    /**< @brief Size of the socket input buffer.
+                                         */
+};
+
+/**************************************************************************/ /*!
+ * @brief This structure describes one datagram of the @ref fnet_sendmmsg() 
+ *        and @ref fnet_recvmmsg() functions.
+ ******************************************************************************/
+struct fnet_mmsghdr
+{
+    char            *msg_buf;   /**< @brief Buffer containing the datagram data.*/
+    int             msg_len;    /**< @brief Length of the data in @c msg_buf to send, 
+                                 *   or the size of the @c msg_buf to receive to.
+                                 */
+    struct sockaddr *msg_name;  /**< @brief Optional pointer to the destination address 
+                                 *   of the datagram to send, or to the buffer for 
+                                 *   the source address of the received datagram. @n
+                                 *   If it is @c 0 for sending, the datagram is sent 
+                                 *   to the connected peer.
+                                 */
+    int             msg_result; /**< @brief Set by the stack to the number of bytes 
+                                 *   sent or received for this datagram, or 
+                                 *   to @ref SOCKET_ERROR if the received datagram 
+                                 *   was truncated.
+                                 */
+};
+
 /**************************************************************************/ /*!
  * @brief Socket descriptor.
  ******************************************************************************/
@@ -1198,6 +1294,141 @@ int send( SOCKET s, char *buf, int len, int flags );
  ******************************************************************************/
 int sendto( SOCKET s, char *buf, int len, int flags, const struct sockaddr *to, int tolen );
 
+/**************************************************************************/ /*!
+ * @brief Completion handler of the @ref fnet_send_ref().
+ *
+ * @param cookie    Handler-specific parameter, passed to the @ref fnet_send_ref().
+ *
+ * @see fnet_send_ref()
+ ******************************************************************************/
+typedef void(*fnet_send_ref_handler_t)(void *cookie);
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Sends the application-owned data on a connected socket 
+ *           without copying.
+ *
+ *
+ * @param s         Descriptor, identifying a connected socket.
+ *
+ * @param buf       Buffer containing the data to be transmitted. @n
+ *                  It may be placed in ROM (e.g. a @ref fnet_fs_rom image).
+ *
+ * @param len       Length of the data in @c buf.
+ *
+ * @param flags     Optional flag specifying the way in which the call is made. 
+ *                  It can be constructed by using the bitwise OR operator with
+ *                  any of the values defined by the @ref fnet_flags_t.
+ *
+ * @param handler   Optional completion handler. It is called when the queued 
+ *                  part of @c buf is acknowledged by the peer (or discarded)
+ *                  and not referenced by the stack anymore. @n
+ *                  It can be @c 0.
+ *
+ * @param cookie    Handler-specific parameter, passed to the @c handler.
+ *
+ *
+ * @return This function returns:
+ *   - The total number of bytes queued for sending, if no error occurs. 
+ *     It can be less than the number indicated by @c len.
+ *   - @ref SOCKET_ERROR if an error occurs. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see send(), fnet_sendfile()
+ *
+ ******************************************************************************
+ *
+ * This function works like @ref send(), but the socket send buffer 
+ * references the @c buf memory instead of copying its content. 
+ * It is supported only by stream-oriented sockets (@ref SOCK_STREAM).@n
+ * Every call queues one chunk: the first bytes of @c buf that fit into 
+ * the free space of the socket send buffer, their number is returned. 
+ * The @c handler is called once per queued chunk, in the context of the 
+ * stack. If only a part of @c buf is queued, the rest is sent by 
+ * the next calls, and every call that queues a chunk gets its own 
+ * @c handler call. The application must not modify or release a chunk 
+ * till its @c handler is called. If no data were queued (the function 
+ * returned @c 0 or @ref SOCKET_ERROR), the @c handler is not called.
+ *
+ ******************************************************************************/
+int fnet_send_ref( SOCKET s, const char *buf, int len, int flags, fnet_send_ref_handler_t handler, void *cookie );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Sends several datagrams in one call.
+ *
+ *
+ * @param s         Descriptor, identifying a socket.
+ *
+ * @param msgvec    Array of the datagram descriptors.
+ *
+ * @param vlen      Number of elements in @c msgvec.
+ *
+ * @param flags     Optional flag specifying the way in which the call is made. 
+ *                  It can be constructed by using the bitwise OR operator with
+ *                  any of the values defined by the @ref fnet_flags_t.
+ *
+ *
+ * @return This function returns:
+ *   - The number of datagrams sent, if no error occurs. 
+ *     It can be less than @c vlen, if an error occurs after the first 
+ *     datagram has been sent.
+ *   - @ref SOCKET_ERROR if no datagram has been sent. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see sendto(), fnet_recvmmsg()
+ *
+ ******************************************************************************
+ *
+ * This function is the equivalent of calling @ref sendto() for every 
+ * element of @c msgvec, but the socket lookup and the locking are done once 
+ * per batch, and the routing and the source address selection are done once 
+ * for consecutive datagrams to the same destination. 
+ * The checksum is still calculated for every datagram. @n
+ * It is supported only by message-oriented sockets (@ref SOCK_DGRAM).@n
+ * The @c msg_result field of each sent element is set to its length.
+ *
+ ******************************************************************************/
+int fnet_sendmmsg( SOCKET s, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Receives several datagrams in one call.
+ *
+ *
+ * @param s         Descriptor, identifying a bound socket.
+ *
+ * @param msgvec    Array of the datagram descriptors.
+ *
+ * @param vlen      Number of elements in @c msgvec.
+ *
+ * @param flags     Optional flag specifying the way in which the call is made. 
+ *                  It can be constructed by using the bitwise OR operator with
+ *                  any of the values defined by the @ref fnet_flags_t.
+ *                  The @ref MSG_PEEK flag is not supported.
+ *
+ *
+ * @return This function returns:
+ *   - The number of datagrams received, if no error occurs. 
+ *     It can be less than @c vlen, or @c 0 if no datagram is available.
+ *   - @ref SOCKET_ERROR if an error occurs. @n 
+ *     The specific error code can be retrieved using the @ref fnet_error_get().
+ *
+ * @see recvfrom(), fnet_sendmmsg()
+ *
+ ******************************************************************************
+ *
+ * This function is the equivalent of calling @ref recvfrom() for every 
+ * element of @c msgvec, but all available datagrams are pulled from 
+ * the socket receive buffer in one pass. @n
+ * It is supported only by message-oriented sockets (@ref SOCK_DGRAM).@n
+ * The @c msg_result field of each received element is set to the length 
+ * of the datagram, or to @ref SOCKET_ERROR if the datagram was larger than 
+ * @c msg_len and was truncated.
+ *
+ ******************************************************************************/
+int fnet_recvmmsg( SOCKET s, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags );
+
 /***************************************************************************/ /*!
  *
  * @brief    Terminates the connection in one or both directions.
@@ -148,6 +148,7 @@ typedef struct _socket
     struct sockaddr         foreign_addr;           /**< Foreign socket address.*/
     struct sockaddr         local_addr;             /**< Lockal socket address.*/
     fnet_socket_option_t    options;                /**< Collection of socket options.*/
+    fnet_netif_dst_t        dst_cache;              /**< Destination cache of the connected socket.*/
     
 #if FNET_CFG_MULTICAST
     /* Multicast params.*/
@@ -173,6 +174,10 @@ typedef struct fnet_socket_prot_if
     int  (*prot_setsockopt)(fnet_socket_t *sk, int level, int optname, char *optval, int optlen);           /* Protocol "setsockopt" function. */
     int  (*prot_getsockopt)(fnet_socket_t *sk, int level, int optname, char *optval, int *optlen);          /* Protocol "getsockopt" function. */
     int  (*prot_listen)(fnet_socket_t *sk, int backlog);                                                    /* Protocol "listen" function.*/
+    int  (*prot_snd_ref)(fnet_socket_t *sk, const char *buf, int len, int flags, 
+                         void (*handler)(void *cookie), void *cookie);                                      /* Protocol "send without copying" function (optional).*/
+    int  (*prot_sndmmsg)(fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags);     /* Protocol "send datagrams" function (optional).*/
+    int  (*prot_rcvmmsg)(fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags);     /* Protocol "receive datagrams" function (optional).*/
                                                                            
 } fnet_socket_prot_if_t;
 
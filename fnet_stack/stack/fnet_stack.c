@@ -44,6 +44,8 @@
 #include "fnet.h"
 #include "fnet_socket_prv.h"
 #include "fnet_prot.h"
+#include "fnet_latency_prv.h"
+#include "fnet_lock_profile_prv.h"
 
 /************************************************************************
 *     Function Prototypes
@@ -63,7 +65,8 @@ int fnet_init( struct fnet_init_params *init_params )
 
     if(init_params 
         && (fnet_os_mutex_init() == FNET_OK)
-        && (fnet_os_event_init() == FNET_OK))
+        && (fnet_os_event_init() == FNET_OK)
+        && (fnet_os_thread_init() == FNET_OK))
     {
         fnet_os_mutex_lock();
 
@@ -113,6 +116,7 @@ void fnet_release()
 
     fnet_os_mutex_unlock();
 
+    fnet_os_thread_release();
     fnet_os_mutex_release();
 }
 
@@ -124,6 +128,12 @@ void fnet_release()
 static int fnet_stack_init( void )
 {
     fnet_isr_init();
+
+    fnet_lock_profile_init();
+
+    fnet_stats_clear();
+
+    fnet_latency_init();
    
     if (fnet_timer_init(FNET_TIMER_PERIOD_MS) == FNET_ERR)
         goto ERROR;
@@ -59,6 +59,13 @@
 #include "fnet_debug.h"
 #include "fnet_eth.h"
 #include "fnet_isr.h"
+#include "fnet_stats.h"
+#include "fnet_trace.h"
+#include "fnet_capture.h"
+#include "fnet_latency.h"
+#include "fnet_lock_profile.h"
+#include "fnet_heap_profile.h"
+#include "fnet_ubench.h"
 
 
 /*! @addtogroup fnet_stack_init
@@ -83,6 +83,29 @@
    #define FNET_CFG_ND6_NEIGHBOR_CACHE_SIZE     (5)
 #endif
 
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE
+ * @brief   Number of hash buckets used to look up the neighbor cache 
+ *          entries (per interface). @n
+ *          An entry is hashed on the interface identifier of its address.
+ * @showinitializer 
+ ******************************************************************************/ 
+#ifndef FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE
+   #define FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE (8)
+#endif
+
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE
+ * @brief   Maximum number of packets queued per neighbor, 
+ *          waiting for address resolution to complete. @n
+ *          When the queue overflows, the oldest packet is discarded.
+ * @note    RFC4861: The queue MUST hold at least one packet, and MAY contain more.
+ * @showinitializer 
+ ******************************************************************************/ 
+#ifndef FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE
+   #define FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE     (3)
+#endif
+
 /**************************************************************************/ /*!
  * @def     FNET_CFG_ND6_PREFIX_LIST_SIZE
  * @brief   Maximum number of entries in the Prefix list (per interface).
@@ -129,6 +152,12 @@
 #if FNET_CFG_ND6_PREFIX_LIST_SIZE < 1 
     #error FNET_CFG_ND6_PREFIX_LIST_SIZE must be > 0
 #endif
+#if FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE < 1 
+    #error FNET_CFG_ND6_NEIGHBOR_CACHE_HASH_SIZE must be > 0
+#endif
+#if FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE < 1 
+    #error FNET_CFG_ND6_NEIGHBOR_QUEUE_SIZE must be > 0
+#endif
 
 /**************************************************************************/ /*!
  * @def      FNET_CFG_IP6_FRAGMENTATION
@@ -144,6 +173,34 @@
     #define FNET_CFG_IP6_FRAGMENTATION      (1)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP6_FRAG_HASH_SIZE
+ * @brief    Number of hash buckets used to look up the IPv6 packets 
+ *           awaiting reassembly. @n
+ *           A packet is hashed on its source and destination addresses,
+ *           identification and next header.@n
+ *           Used only if @ref FNET_CFG_IP6_FRAGMENTATION is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP6_FRAG_HASH_SIZE
+    #define FNET_CFG_IP6_FRAG_HASH_SIZE     (8)
+#endif
+#if FNET_CFG_IP6_FRAG_HASH_SIZE < 1 
+    #error FNET_CFG_IP6_FRAG_HASH_SIZE must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP6_FRAG_MEMORY
+ * @brief    Maximum number of bytes held by all IPv6 fragments awaiting 
+ *           reassembly. @n
+ *           If it is exceeded, the oldest incomplete packets are discarded.@n
+ *           Used only if @ref FNET_CFG_IP6_FRAGMENTATION is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP6_FRAG_MEMORY
+    #define FNET_CFG_IP6_FRAG_MEMORY        (16 * 1024)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_IP6_PMTU_DISCOVERY
  * @brief    Path MTU Discovery for IPv6:
@@ -155,6 +212,39 @@
     #define FNET_CFG_IP6_PMTU_DISCOVERY     (1)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP6_DST_CACHE_SIZE
+ * @brief    Number of entries in the IPv6 destination cache. @n
+ *           The cache is keyed by the destination address and holds
+ *           the chosen interface, source address, MTU and next-hop
+ *           link-layer address of the packets sent without
+ *           a socket destination cache and without a specified source address.@n
+ *           Any address, ND or route change invalidates all entries.@n
+ *           If it is @c 0, the destination cache is disabled.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_IP6_DST_CACHE_SIZE
+    #define FNET_CFG_IP6_DST_CACHE_SIZE     (4)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP6_FORWARDING
+ * @brief    IPv6 forwarding between network interfaces:
+ *               - @c 1 = is enabled. @n The IPv6 datagrams, not addressed 
+ *                        to this host, are forwarded to the next hop. 
+ *                        The Hop Limit is decremented, and ICMPv6 
+ *                        Time Exceeded, Destination Unreachable and 
+ *                        Packet Too Big errors are generated.
+ *               - @b @c 0 = is disabled (Default value). @n The IPv6 will
+ *                        silently discard the datagrams, not addressed to 
+ *                        this host.
+ * @see FNET_CFG_IP4_FORWARDING
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP6_FORWARDING
+    #define FNET_CFG_IP6_FORWARDING         (0)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_NETIF_IP6_ADDR_MAX
  * @brief    Maximum number of IPv6 addresses that can be bound to an interface.
@@ -201,6 +291,124 @@
     #define FNET_CFG_IP4_FRAGMENTATION          (0)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP4_FRAG_HASH_SIZE
+ * @brief    Number of hash buckets used to look up the IPv4 datagrams 
+ *           awaiting reassembly. @n
+ *           A datagram is hashed on its source and destination addresses,
+ *           identification and protocol.@n
+ *           Used only if @ref FNET_CFG_IP4_FRAGMENTATION is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP4_FRAG_HASH_SIZE
+    #define FNET_CFG_IP4_FRAG_HASH_SIZE         (8)
+#endif
+#if FNET_CFG_IP4_FRAG_HASH_SIZE < 1 
+    #error FNET_CFG_IP4_FRAG_HASH_SIZE must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP4_FRAG_MEMORY
+ * @brief    Maximum number of bytes held by all IPv4 fragments awaiting 
+ *           reassembly. @n
+ *           If it is exceeded, the oldest incomplete datagrams are discarded.@n
+ *           Used only if @ref FNET_CFG_IP4_FRAGMENTATION is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP4_FRAG_MEMORY
+    #define FNET_CFG_IP4_FRAG_MEMORY            (16 * 1024)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP4_ROUTE_TABLE_SIZE
+ * @brief    Maximum number of static routes in the IPv4 routing table.@n
+ *           The connected routes of the network interfaces are kept 
+ *           in addition to it. @n
+ *           Static routes are added by @ref fnet_netif_add_ip4_route().
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP4_ROUTE_TABLE_SIZE
+    #define FNET_CFG_IP4_ROUTE_TABLE_SIZE       (4)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_IP4_FORWARDING
+ * @brief    IPv4 forwarding between network interfaces:
+ *               - @c 1 = is enabled. @n The IPv4 datagrams, not addressed 
+ *                        to this host, are forwarded to the next hop, 
+ *                        selected by the routing table. 
+ *                        The TTL is decremented, and ICMP Time Exceeded
+ *                        and Destination Unreachable errors are generated.
+ *                        A datagram bigger than the next-hop MTU is 
+ *                        fragmented (if @ref FNET_CFG_IP4_FRAGMENTATION is set), 
+ *                        or, if its DF flag is set, the next-hop MTU is 
+ *                        reported to the source by ICMP.
+ *               - @b @c 0 = is disabled (Default value). @n The IP will
+ *                        silently discard the datagrams, not addressed to 
+ *                        this host.
+ * @see FNET_CFG_IP6_FORWARDING, fnet_netif_add_ip4_route()
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_IP4_FORWARDING
+    #define FNET_CFG_IP4_FORWARDING             (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ARP_TABLE_SIZE
+ * @brief   Maximum number of entries in the ARP cache (per interface).@n
+ *          If the cache is full, the least recently used dynamic entry
+ *          is replaced. Static entries are never replaced.
+ * @see fnet_netif_add_ip4_arp_entry()
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_ARP_TABLE_SIZE
+    #define FNET_CFG_ARP_TABLE_SIZE             (10)
+#endif
+#if FNET_CFG_ARP_TABLE_SIZE < 1
+    #error FNET_CFG_ARP_TABLE_SIZE must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ARP_HASH_SIZE
+ * @brief   Number of hash buckets used to look up the ARP cache entries
+ *          (per interface). @n
+ *          An entry is hashed on its IPv4 address.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_ARP_HASH_SIZE
+    #define FNET_CFG_ARP_HASH_SIZE              (8)
+#endif
+#if FNET_CFG_ARP_HASH_SIZE < 1
+    #error FNET_CFG_ARP_HASH_SIZE must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ARP_HOLD_QUEUE
+ * @brief   Maximum number of packets queued for an unresolved ARP entry.@n
+ *          If the queue is full, the oldest packet is discarded.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_ARP_HOLD_QUEUE
+    #define FNET_CFG_ARP_HOLD_QUEUE             (3)
+#endif
+#if FNET_CFG_ARP_HOLD_QUEUE < 1
+    #error FNET_CFG_ARP_HOLD_QUEUE must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def     FNET_CFG_ARP_EXPIRE_TIMEOUT
+ * @brief   Lifetime of a dynamic ARP cache entry, in seconds.@n
+ *          An entry in use is refreshed by a unicast ARP request
+ *          shortly before it expires.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_ARP_EXPIRE_TIMEOUT
+    #define FNET_CFG_ARP_EXPIRE_TIMEOUT         (1200)
+#endif
+#if FNET_CFG_ARP_EXPIRE_TIMEOUT < 60
+    #error FNET_CFG_ARP_EXPIRE_TIMEOUT must be >= 60
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_ETH0_IP4_ADDR
  * @brief    Defines the default IP address for the Ethernet-0 interface.
@@ -281,6 +489,82 @@
     #define FNET_CFG_ETH1_IP4_DNS        (FNET_IP4_ADDR_INIT(0, 0, 0, 0))
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_ETH_GRO
+ * @brief    Receive-side coalescing of TCP segments on Ethernet interfaces:
+ *               - @c 1 = is enabled. @n Consecutive in-order TCP segments 
+ *                        of the same flow, received in one batch
+ *                        of an Ethernet driver, are merged into one 
+ *                        IPv4/IPv6 packet before passing it to the IP layer.
+ *                        So the TCP input, the socket lookup and the ACK 
+ *                        are done once per merged packet. @n
+ *                        The merged packet is passed on a PSH, SYN, FIN, 
+ *                        RST or URG segment, on an out-of-order segment, 
+ *                        on a segment of other flow and at the end of the batch.
+ *               - @b @c 0 = is disabled (Default value).
+ * @see FNET_CFG_ETH_GRO_MAX_SIZE
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_ETH_GRO
+    #define FNET_CFG_ETH_GRO             (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_ETH_GRO_MAX_SIZE
+ * @brief    Maximum size, in bytes, of the IP packet merged by 
+ *           @ref FNET_CFG_ETH_GRO.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_ETH_GRO_MAX_SIZE
+    #define FNET_CFG_ETH_GRO_MAX_SIZE    (8 * 1024)
+#endif
+#if FNET_CFG_ETH_GRO_MAX_SIZE > 65535
+    #error FNET_CFG_ETH_GRO_MAX_SIZE must be <= 65535
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_ETH_TX_QUEUE
+ * @brief    Software transmit queue of Ethernet interfaces:
+ *               - @c 1 = is enabled. @n If the Ethernet driver has no free 
+ *                        transmit buffer, the frame is queued instead of 
+ *                        waiting for the hardware. The queue is sent when 
+ *                        the driver reports a transmit completion.
+ *                        When the queue is full, TCP defers sending 
+ *                        new segments, instead of having them dropped, 
+ *                        until the queue is half empty.@n
+ *                        It is used by drivers, which report their transmit 
+ *                        buffer state (the FEC/ENET driver).
+ *               - @b @c 0 = is disabled (Default value).
+ * @see FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS, FNET_CFG_ETH_TX_QUEUE_MAX_BYTES
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_ETH_TX_QUEUE
+    #define FNET_CFG_ETH_TX_QUEUE               (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS
+ * @brief    Maximum number of frames in the software transmit queue 
+ *           of an Ethernet interface (@ref FNET_CFG_ETH_TX_QUEUE).
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS
+    #define FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS   (16)
+#endif
+#if FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS < 1
+    #error FNET_CFG_ETH_TX_QUEUE_MAX_PACKETS must be > 0
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_ETH_TX_QUEUE_MAX_BYTES
+ * @brief    Maximum number of bytes in the software transmit queue 
+ *           of an Ethernet interface (@ref FNET_CFG_ETH_TX_QUEUE).
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_ETH_TX_QUEUE_MAX_BYTES
+    #define FNET_CFG_ETH_TX_QUEUE_MAX_BYTES     (8 * 1024)
+#endif
+
 
 
 /**************************************************************************/ /*!
@@ -499,6 +783,35 @@
     #define FNET_CFG_TCP_URGENT                 (0)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_PLPMTUD
+ * @brief    TCP Packetization Layer Path MTU Discovery (RFC4821),
+ *           used to detect PMTU "black holes":
+ *               - @c 1 = is enabled. @n The TCP starts with the minimum 
+ *                        segment size of the protocol family, and sends 
+ *                        one larger probe segment at a time, up to the 
+ *                        size allowed by the path MTU. The segment size is
+ *                        raised when a probe is acknowledged. A lost probe
+ *                        does not change the segment size, but its size is 
+ *                        not probed again until @ref FNET_CFG_TCP_PLPMTUD_TIMEOUT.
+ *                        The loss of a probe is also handled as congestion. 
+ *               - @b @c 0 = is disabled (Default value).
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_PLPMTUD
+    #define FNET_CFG_TCP_PLPMTUD                (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TCP_PLPMTUD_TIMEOUT
+ * @brief    Time, in seconds, after which the TCP probes again the segment
+ *           sizes, that have been lost by @ref FNET_CFG_TCP_PLPMTUD probing.
+ * @showinitializer
+ ******************************************************************************/
+#ifndef FNET_CFG_TCP_PLPMTUD_TIMEOUT
+    #define FNET_CFG_TCP_PLPMTUD_TIMEOUT        (600)
+#endif
+
 /**************************************************************************/ /*!
  * @def      FNET_CFG_UDP
  * @brief    UDP protocol support:
@@ -540,6 +853,242 @@
     #define FNET_CFG_RAW                        (0)
 #endif
 
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_STATS
+ * @brief    Protocol statistics (MIB-II style counters), returned by
+ *           the @ref fnet_stats_get():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           The counters are incremented without locking, so a snapshot
+ *           is not atomic across the counters.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_STATS
+    #define FNET_CFG_STATS                      (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TRACE
+ * @brief    Binary packet/event trace ring, read by the @ref fnet_trace_get():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           Unlike the @c FNET_CFG_DEBUG_TRACE_* header printing, 
+ *           a record costs a few stores, so it can be left on in production.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TRACE
+    #define FNET_CFG_TRACE                      (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TRACE_SIZE
+ * @brief    Number of records in the trace ring. It must be a power of two.@n
+ *           One record takes 24 bytes.@n
+ *           Used only if @ref FNET_CFG_TRACE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TRACE_SIZE
+    #define FNET_CFG_TRACE_SIZE                 (128)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TRACE_LAYERS
+ * @brief    Compile-time mask of the traced layers, 
+ *           defined by @ref FNET_TRACE_MASK() of the @ref fnet_trace_layer_t values.@n
+ *           Trace points of the other layers are removed by the compiler.
+ *           The run-time mask is set by the @ref fnet_trace_set_mask().@n
+ *           Used only if @ref FNET_CFG_TRACE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TRACE_LAYERS
+    #define FNET_CFG_TRACE_LAYERS               (0xFFFFFFFFUL)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TRACE_TIMESTAMP
+ * @brief    Time stamp of the trace records. 
+ *           It may be redefined to a free-running cycle counter.@n
+ *           Used only if @ref FNET_CFG_TRACE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TRACE_TIMESTAMP
+    #define FNET_CFG_TRACE_TIMESTAMP()          fnet_timer_ms()
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_TRACE_TIMESTAMP_RES
+ * @brief    Resolution of the @ref FNET_CFG_TRACE_TIMESTAMP, 
+ *           as a negative power of ten (@c 3 = milliseconds, @c 6 = microseconds).@n
+ *           It is written to the pcap-ng interface description.@n
+ *           Used only if @ref FNET_CFG_TRACE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_TRACE_TIMESTAMP_RES
+    #define FNET_CFG_TRACE_TIMESTAMP_RES        (3)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CAPTURE
+ * @brief    In-memory pcap capture of the Ethernet frames, 
+ *           read by the @ref fnet_capture_read():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CAPTURE
+    #define FNET_CFG_CAPTURE                    (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CAPTURE_SIZE
+ * @brief    Size of the capture buffer, in bytes. 
+ *           It must be a power of two. It is allocated statically.@n
+ *           A frame takes 16 bytes of the pcap record header, 
+ *           plus its captured part.@n
+ *           Used only if @ref FNET_CFG_CAPTURE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CAPTURE_SIZE
+    #define FNET_CFG_CAPTURE_SIZE               (8*1024)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_CAPTURE_SNAPLEN
+ * @brief    Maximum number of bytes captured from a frame, 
+ *           including its Ethernet header. 
+ *           It bounds the copying cost of a frame.@n
+ *           Used only if @ref FNET_CFG_CAPTURE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_CAPTURE_SNAPLEN
+    #define FNET_CFG_CAPTURE_SNAPLEN            (128)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LATENCY
+ * @brief    Latency histograms of the Rx and Tx path stages, 
+ *           read by the @ref fnet_latency_get():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           It adds a time stamp to every net_buf.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LATENCY
+    #define FNET_CFG_LATENCY                    (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LATENCY_CYCLES
+ * @brief    Free-running 32-bit high-resolution counter, 
+ *           used by the latency histograms.@n
+ *           By default, it is the @ref fnet_cpu_cycles(), implemented 
+ *           for the Cortex-M platforms. Other platforms, 
+ *           or a host build, define their own counter, 
+ *           for example the @c clock_gettime() nanoseconds.@n
+ *           Used only if @ref FNET_CFG_LATENCY or 
+ *           @ref FNET_CFG_LOCK_PROFILE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LATENCY_CYCLES
+    #define FNET_CFG_LATENCY_CYCLES()           fnet_cpu_cycles()
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LATENCY_CYCLES_INIT
+ * @brief    Starts the @ref FNET_CFG_LATENCY_CYCLES counter. 
+ *           It is called by the stack initialization.@n
+ *           Used only if @ref FNET_CFG_LATENCY or 
+ *           @ref FNET_CFG_LOCK_PROFILE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LATENCY_CYCLES_INIT
+    #define FNET_CFG_LATENCY_CYCLES_INIT()      fnet_cpu_cycles_init()
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LATENCY_CYCLES_PER_US
+ * @brief    Number of the @ref FNET_CFG_LATENCY_CYCLES counts 
+ *           in one microsecond.@n
+ *           Used only if @ref FNET_CFG_LATENCY or 
+ *           @ref FNET_CFG_LOCK_PROFILE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LATENCY_CYCLES_PER_US
+    #define FNET_CFG_LATENCY_CYCLES_PER_US      (FNET_CPU_CLOCK_MHZ)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LOCK_PROFILE
+ * @brief    Profiler of the stack lock and of the OS mutex, 
+ *           read by the @ref fnet_lock_profile_get():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           It is an instrumented build. The lock functions record 
+ *           their call sites, so all code using them must be recompiled.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LOCK_PROFILE
+    #define FNET_CFG_LOCK_PROFILE               (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_LOCK_PROFILE_SITES
+ * @brief    Maximum number of the profiled lock call sites. 
+ *           It must be a power of two. 
+ *           The call sites beyond it share one record.@n
+ *           Used only if @ref FNET_CFG_LOCK_PROFILE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_LOCK_PROFILE_SITES
+    #define FNET_CFG_LOCK_PROFILE_SITES         (64)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_PROFILE
+ * @brief    Allocation profiler of the @c fnet_malloc() and 
+ *           @c fnet_malloc_netbuf() call sites, 
+ *           read by the @ref fnet_heap_profile_get():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           It is an instrumented build. The allocation functions record 
+ *           their call sites, so all code using them must be recompiled.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_PROFILE
+    #define FNET_CFG_HEAP_PROFILE               (0)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_HEAP_PROFILE_SITES
+ * @brief    Maximum number of the profiled allocation call sites. 
+ *           It must be a power of two. 
+ *           The call sites beyond it share one record.@n
+ *           Used only if @ref FNET_CFG_HEAP_PROFILE is @c 1.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_HEAP_PROFILE_SITES
+    #define FNET_CFG_HEAP_PROFILE_SITES         (64)
+#endif
+
+/**************************************************************************/ /*!
+ * @def      FNET_CFG_UBENCH
+ * @brief    Micro-benchmarks of the stack primitives, 
+ *           run by the @ref fnet_ubench_run():
+ *               - @c 1 = is enabled.
+ *               - @b @c 0 = is disabled (Default value).@n
+ *           @n
+ *           They are timed by @ref FNET_CFG_LATENCY_CYCLES.
+ * @showinitializer 
+ ******************************************************************************/
+#ifndef FNET_CFG_UBENCH
+    #define FNET_CFG_UBENCH                     (0)
+#endif
+
 
 /*****************************************************************************
 * 	TCP/IP stack parameters.
@@ -0,0 +1,140 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_stats.c
+*
+* @author Andrey Butok
+*
+* @brief FNET protocol statistics.
+*
+***************************************************************************/
+
+#include "fnet.h"
+#include "fnet_stats_prv.h"
+#include "fnet_ip_prv.h"
+#include "fnet_ip6_prv.h"
+#include "fnet_netbuf.h"
+
+/************************************************************************
+*     Global Data Structures
+*************************************************************************/
+#if FNET_CFG_STATS
+    struct fnet_stats fnet_stats;
+#endif
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+#if FNET_CFG_STATS
+static void fnet_stats_frag_get( struct fnet_stats_ip *ip, const fnet_ip_frag_stats_t *frag_stats );
+#endif
+
+/************************************************************************
+* NAME: fnet_stats_get
+*
+* DESCRIPTION: Returns a snapshot of the protocol counters.
+*************************************************************************/
+int fnet_stats_get( struct fnet_stats *stats )
+{
+#if FNET_CFG_STATS
+    int result;
+
+    if(stats)
+    {
+        fnet_memcpy(stats, &fnet_stats, sizeof(*stats));
+
+        /* The reassembly is counted by the IP layers.*/
+    #if FNET_CFG_IP4 && FNET_CFG_IP4_FRAGMENTATION
+        fnet_stats_frag_get(&stats->ip, &fnet_ip_frag_stats);
+    #endif
+    #if FNET_CFG_IP6 && FNET_CFG_IP6_FRAGMENTATION
+        fnet_stats_frag_get(&stats->ip6, &fnet_ip6_frag_stats);
+    #endif
+
+        stats->mem.netbuf_free = fnet_free_mem_status_netbuf();
+        stats->mem.heap_free = fnet_free_mem_status();
+        stats->mem.netbuf_high_water = fnet_mem_high_water_netbuf();
+        stats->mem.heap_high_water = fnet_mem_high_water();
+
+        result = FNET_OK;
+    }
+    else
+    {
+        result = FNET_ERR;
+    }
+
+    return result;
+#else
+    FNET_COMP_UNUSED_ARG(stats);
+
+    return FNET_ERR;
+#endif
+}
+
+/************************************************************************
+* NAME: fnet_stats_clear
+*
+* DESCRIPTION: Resets the protocol counters.
+*************************************************************************/
+void fnet_stats_clear( void )
+{
+#if FNET_CFG_STATS
+    fnet_isr_lock();
+
+    fnet_memset_zero(&fnet_stats, sizeof(fnet_stats));
+  #if FNET_CFG_IP4 && FNET_CFG_IP4_FRAGMENTATION
+    fnet_memset_zero(&fnet_ip_frag_stats, sizeof(fnet_ip_frag_stats));
+  #endif
+  #if FNET_CFG_IP6 && FNET_CFG_IP6_FRAGMENTATION
+    fnet_memset_zero(&fnet_ip6_frag_stats, sizeof(fnet_ip6_frag_stats));
+  #endif
+
+    fnet_isr_unlock();
+#endif
+}
+
+#if FNET_CFG_STATS
+/************************************************************************
+* NAME: fnet_stats_frag_get
+*
+* DESCRIPTION: Fills the reassembly counters from the IP reassembly
+*              statistics.
+*************************************************************************/
+static void fnet_stats_frag_get( struct fnet_stats_ip *ip, const fnet_ip_frag_stats_t *frag_stats )
+{
+    ip->reasm_reqds = frag_stats->reqds;
+    ip->reasm_oks = frag_stats->oks;
+    ip->reasm_fails = frag_stats->drops + frag_stats->timeouts + frag_stats->evictions;
+    ip->reasm_timeouts = frag_stats->timeouts;
+}
+#endif
+
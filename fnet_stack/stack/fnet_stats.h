@@ -0,0 +1,299 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_stats.h
+*
+* @author Andrey Butok
+*
+* @brief FNET protocol statistics API.
+*
+***************************************************************************/
+
+#ifndef _FNET_STATS_H_
+
+#define _FNET_STATS_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_stats
+* The Statistics API provides the MIB-II style counters (RFC1213, RFC4293)
+* of the FNET stack protocol layers. @n
+* It is available only if @ref FNET_CFG_STATS is set to @c 1. @n
+* The counters are incremented by the stack without locking, so they are
+* not synchronized with each other. They wrap around on overflow.
+*/
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Ethernet layer counters.
+ ******************************************************************************/
+struct fnet_stats_eth
+{
+    unsigned long in_frames;        /**< @brief Received frames, passed to the Ethernet layer.
+                                     */
+    unsigned long in_discards;      /**< @brief Received frames discarded as invalid
+                                     * or of an unsupported type.
+                                     */
+    unsigned long out_frames;       /**< @brief Frames passed to the drivers for transmission.
+                                     */
+    unsigned long out_discards;     /**< @brief Outgoing frames discarded because of
+                                     * a missing buffer or the full Tx queue.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief ARP counters.
+ ******************************************************************************/
+struct fnet_stats_arp
+{
+    unsigned long in_requests;      /**< @brief Received ARP requests.
+                                     */
+    unsigned long in_replies;       /**< @brief Received ARP replies.
+                                     */
+    unsigned long out_requests;     /**< @brief Sent ARP requests.
+                                     */
+    unsigned long out_replies;      /**< @brief Sent ARP replies.
+                                     */
+    unsigned long misses;           /**< @brief Outgoing datagrams, which did not
+                                     * find the destination in the ARP cache.
+                                     */
+    unsigned long drops;            /**< @brief Outgoing datagrams discarded while
+                                     * waiting for the address resolution.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief IPv4 and IPv6 counters (RFC4293 ipSystemStatsTable).
+ ******************************************************************************/
+struct fnet_stats_ip
+{
+    unsigned long in_receives;      /**< @brief Received datagrams, including erroneous.
+                                     */
+    unsigned long in_hdr_errors;    /**< @brief Datagrams discarded because of a header error
+                                     * (version, length, checksum, TTL/Hop Limit).
+                                     */
+    unsigned long in_addr_errors;   /**< @brief Datagrams discarded because they are not
+                                     * addressed to this host.
+                                     */
+    unsigned long in_unknown_protos;/**< @brief Datagrams discarded because of an unknown
+                                     * or unsupported protocol.
+                                     */
+    unsigned long in_discards;      /**< @brief Datagrams discarded because of lack of
+                                     * resources (input queue overflow, no memory).
+                                     */
+    unsigned long in_delivers;      /**< @brief Datagrams delivered to the upper-layer protocols.
+                                     */
+    unsigned long forw_datagrams;   /**< @brief Datagrams forwarded to the next hop.
+                                     */
+    unsigned long out_requests;     /**< @brief Datagrams supplied by the upper-layer
+                                     * protocols for transmission.
+                                     */
+    unsigned long out_discards;     /**< @brief Outgoing datagrams discarded because of
+                                     * lack of resources or of an invalid size.
+                                     */
+    unsigned long out_no_routes;    /**< @brief Outgoing datagrams discarded because no
+                                     * route was found.
+                                     */
+    unsigned long reasm_reqds;      /**< @brief Received fragments needing the reassembly.
+                                     */
+    unsigned long reasm_oks;        /**< @brief Datagrams successfully reassembled.
+                                     */
+    unsigned long reasm_fails;      /**< @brief Reassembly failures (invalid fragments,
+                                     * no memory, timeouts, evictions).
+                                     */
+    unsigned long reasm_timeouts;   /**< @brief Datagrams discarded on the reassembly timeout.
+                                     */
+    unsigned long frag_oks;         /**< @brief Datagrams successfully fragmented.
+                                     */
+    unsigned long frag_fails;       /**< @brief Datagrams discarded because they needed
+                                     * the fragmentation, which was not possible.
+                                     */
+    unsigned long frag_creates;     /**< @brief Fragments generated.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief ICMPv4 and ICMPv6 counters.
+ ******************************************************************************/
+struct fnet_stats_icmp
+{
+    unsigned long in_msgs;          /**< @brief Received messages, including erroneous.
+                                     */
+    unsigned long in_errors;        /**< @brief Received messages discarded because of a
+                                     * checksum, length or other error.
+                                     */
+    unsigned long in_dest_unreachs; /**< @brief Received Destination Unreachable messages.
+                                     */
+    unsigned long in_echos;         /**< @brief Received Echo Request messages.
+                                     */
+    unsigned long out_msgs;         /**< @brief Sent messages.
+                                     */
+    unsigned long out_dest_unreachs;/**< @brief Sent Destination Unreachable messages.
+                                     */
+    unsigned long out_echo_reps;    /**< @brief Sent Echo Reply messages.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief UDP counters.
+ ******************************************************************************/
+struct fnet_stats_udp
+{
+    unsigned long in_datagrams;     /**< @brief Datagrams delivered to the sockets.
+                                     */
+    unsigned long no_ports;         /**< @brief Received datagrams without a socket
+                                     * at the destination port.
+                                     */
+    unsigned long in_errors;        /**< @brief Received datagrams discarded because of a
+                                     * checksum or length error, or a full socket buffer.
+                                     */
+    unsigned long out_datagrams;    /**< @brief Sent datagrams.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief TCP counters.
+ ******************************************************************************/
+struct fnet_stats_tcp
+{
+    unsigned long active_opens;     /**< @brief Connections initiated by @ref connect().
+                                     */
+    unsigned long passive_opens;    /**< @brief Connections accepted by listening sockets.
+                                     */
+    unsigned long attempt_fails;    /**< @brief Connection attempts failed in the SYN-SENT
+                                     * or SYN-RCVD state.
+                                     */
+    unsigned long estab_resets;     /**< @brief Connections reset in the ESTABLISHED
+                                     * or CLOSE-WAIT state.
+                                     */
+    unsigned long in_segs;          /**< @brief Received segments, including erroneous.
+                                     */
+    unsigned long in_errs;          /**< @brief Received segments discarded because of a
+                                     * checksum or header error.
+                                     */
+    unsigned long out_segs;         /**< @brief Sent segments, including the retransmitted.
+                                     */
+    unsigned long retrans_segs;     /**< @brief Retransmitted segments.
+                                     */
+    unsigned long out_rsts;         /**< @brief Sent segments with the RST flag.
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief Memory counters.
+ ******************************************************************************/
+struct fnet_stats_mem
+{
+    unsigned long netbuf_fails;     /**< @brief Failed net buffer allocations.
+                                     */
+    unsigned long heap_fails;       /**< @brief Failed heap allocations.
+                                     */
+    unsigned long netbuf_free;      /**< @brief Free memory in the net buffer heap, in bytes.@n
+                                     * It is sampled by @ref fnet_stats_get().
+                                     */
+    unsigned long heap_free;        /**< @brief Free memory in the main heap, in bytes.@n
+                                     * It is sampled by @ref fnet_stats_get().
+                                     */
+    unsigned long netbuf_high_water;/**< @brief High-water mark of the allocated memory 
+                                     * in the net buffer heap, in bytes.@n
+                                     * It is sampled by @ref fnet_stats_get().
+                                     */
+    unsigned long heap_high_water;  /**< @brief High-water mark of the allocated memory 
+                                     * in the main heap, in bytes.@n
+                                     * It is sampled by @ref fnet_stats_get().
+                                     */
+};
+
+/**************************************************************************/ /*!
+ * @brief  Protocol statistics, used by the @ref fnet_stats_get().
+ ******************************************************************************/
+struct fnet_stats
+{
+    struct fnet_stats_eth   eth;    /**< @brief Ethernet counters.
+                                     */
+    struct fnet_stats_arp   arp;    /**< @brief ARP counters.
+                                     */
+    struct fnet_stats_ip    ip;     /**< @brief IPv4 counters.
+                                     */
+    struct fnet_stats_icmp  icmp;   /**< @brief ICMPv4 counters.
+                                     */
+    struct fnet_stats_ip    ip6;    /**< @brief IPv6 counters.
+                                     */
+    struct fnet_stats_icmp  icmp6;  /**< @brief ICMPv6 counters.
+                                     */
+    struct fnet_stats_udp   udp;    /**< @brief UDP counters.
+                                     */
+    struct fnet_stats_tcp   tcp;    /**< @brief TCP counters.
+                                     */
+    struct fnet_stats_mem   mem;    /**< @brief Memory counters.
+                                     */
+};
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves the protocol statistics.
+ *
+ * @param stats  Structure that receives the protocol statistics 
+ *               defined by the @ref fnet_stats structure.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the @c stats is @ref FNET_NULL or
+ *          the statistics is disabled by @ref FNET_CFG_STATS.
+ *
+ * @see fnet_stats_clear()
+ *
+ ******************************************************************************
+ *
+ * This function copies the current values of the protocol counters 
+ * into the @c stats structure.@n
+ * Counters of the layers disabled by the configuration stay zero.
+ *
+ ******************************************************************************/
+int fnet_stats_get( struct fnet_stats *stats );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Resets the protocol statistics.
+ *
+ * @see fnet_stats_get()
+ *
+ ******************************************************************************
+ *
+ * This function sets all protocol counters to zero.
+ *
+ ******************************************************************************/
+void fnet_stats_clear( void );
+
+/*! @} */
+
+#endif /* _FNET_STATS_H_ */
@@ -46,6 +46,9 @@
 #include "fnet_prot.h"
 #include "fnet_stdlib.h"
 #include "fnet_debug.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
+#include "fnet_latency_prv.h"
 
 /************************************************************************
 *     Definitions
@@ -53,6 +56,7 @@
 struct fnet_tcp_segment
 {
     fnet_socket_option_t    *sockoption; 
+    fnet_netif_dst_t        *dst;           /* Destination cache of the socket (optional).*/
     struct sockaddr         src_addr;
     struct sockaddr         dest_addr;
     unsigned long           seq;
@@ -93,7 +97,6 @@ static void fnet_tcp_ktimeo( fnet_socket_t *sk );
 static void fnet_tcp_ptimeo( fnet_socket_t *sk );
 static int fnet_tcp_hit( unsigned long startpos, unsigned long endpos, unsigned long pos );
 static int fnet_tcp_addinpbuf( fnet_socket_t *sk, fnet_netbuf_t *insegment, int *ackparam );
-static fnet_socket_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr );
 static void fnet_tcp_addpartialsk( fnet_socket_t *mainsk, fnet_socket_t *partialsk );
 static void fnet_tcp_movesk2incominglist( fnet_socket_t *sk );
 static void fnet_tcp_closesk( fnet_socket_t *sk );
@@ -115,17 +118,36 @@ static void fnet_tcp_input_ip4( fnet_netif_t *netif, fnet_ip4_addr_t src_ip, fne
 static void fnet_tcp_input_ip6(fnet_netif_t *netif, fnet_ip6_addr_t *src_ip, fnet_ip6_addr_t *dest_ip, fnet_netbuf_t *nb, fnet_netbuf_t *ip6_nb);
 static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  struct sockaddr *dest_addr, fnet_netbuf_t *nb, fnet_netbuf_t *ip_nb);
 static void fnet_tcp_ctrlinput( fnet_prot_notify_t command, fnet_ip_header_t *ip_hdr );
+#if FNET_CFG_IP6
+    static void fnet_tcp_ctrlinput_ip6( fnet_prot_notify_t command, fnet_ip6_header_t *ip6_header );
+#endif
+static unsigned long fnet_tcp_maximum_packet( fnet_socket_t *sk );
+static int fnet_tcp_output_busy( fnet_socket_t *sk );
+static void fnet_tcp_update_mss( fnet_socket_t *sk );
+#if FNET_CFG_TCP_PLPMTUD
+    static unsigned short fnet_tcp_plpmtud_probe_size( fnet_socket_t *sk );
+    static void fnet_tcp_plpmtud_retransmit( fnet_socket_t *sk );
+#endif
 static int fnet_tcp_attach( fnet_socket_t *sk );
 static int fnet_tcp_close( fnet_socket_t *sk );
 static int fnet_tcp_connect( fnet_socket_t *sk, struct sockaddr *foreign_addr);
 static fnet_socket_t *fnet_tcp_accept( fnet_socket_t *listensk );
 static int fnet_tcp_rcv( fnet_socket_t *sk, char *buf, int len, int flags, struct sockaddr *foreign_addr);
 static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const struct sockaddr *foreign_addr);
+static int fnet_tcp_snd_ref( fnet_socket_t *sk, const char *buf, int len, int flags, void (*handler)(void *cookie), void *cookie );
+static int fnet_tcp_snddata( fnet_socket_t *sk, const char *buf, int len, int flags, int ref, void (*handler)(void *cookie), void *cookie );
 static int fnet_tcp_shutdown( fnet_socket_t *sk, int how );
 static int fnet_tcp_setsockopt( fnet_socket_t *sk, int level, int optname, char *optval, int optlen );
 static int fnet_tcp_getsockopt( fnet_socket_t *sk, int level, int optname, char *optval, int *optlen );
 static int fnet_tcp_listen( fnet_socket_t *sk, int backlog );
 static void fnet_tcp_drain( void );
+static void fnet_tcp_getinfo( fnet_socket_t *sk, struct tcp_info *info );
+
+/* Binary trace of a TCP segment. The TCP header is at nb->data_ptr.*/
+#define FNET_TCP_TRACE(event, nb, flow) \
+    FNET_TRACE(FNET_TRACE_LAYER_TCP, (event), (flow), fnet_ntohl(FNET_TCP_SEQ(nb)), fnet_ntohl(FNET_TCP_ACK(nb)), \
+               ((unsigned long)(FNET_TCP_FLAGS(nb)) << 16) | fnet_ntohs(FNET_TCP_WND(nb)), \
+               (nb)->total_length - (unsigned long)FNET_TCP_LENGTH(nb))
 
 #if FNET_CFG_DEBUG_TRACE_TCP
     void fnet_tcp_trace(char *str, fnet_tcp_header_t *tcp_hdr);
@@ -167,7 +189,10 @@ static const fnet_socket_prot_if_t fnet_tcp_socket_api =
     fnet_tcp_shutdown,
     fnet_tcp_setsockopt, 
     fnet_tcp_getsockopt,
-    fnet_tcp_listen   
+    fnet_tcp_listen,
+    fnet_tcp_snd_ref,     /* Send without copying.*/
+    0,                    /* Send datagrams.*/
+    0                     /* Receive datagrams.*/
 };
 
 /* Protocol structure.*/
@@ -186,6 +211,7 @@ fnet_prot_if_t fnet_tcp_prot_if =
     fnet_tcp_drain, 
 #if FNET_CFG_IP6    
     fnet_tcp_input_ip6,     /* Protocol IPv6 input function.*/
+    fnet_tcp_ctrlinput_ip6, /* Protocol IPv6 control input function.*/
 #endif /* FNET_CFG_IP6 */                              
     &fnet_tcp_socket_api    /* Socket API */
 };
@@ -318,6 +344,9 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
     tcp_length = (unsigned long)FNET_TCP_LENGTH(nb);
     
     fnet_netbuf_free_chain(ip_nb);
+
+    FNET_STATS_INC(tcp.in_segs);
+    FNET_LATENCY_RX(FNET_LATENCY_RX_TCP, nb);
  
     /* The header must reside in contiguous area of the memory.*/
     buf = fnet_netbuf_pullup(nb, (int)tcp_length);
@@ -329,8 +358,8 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
     
     nb = buf;
     
-    /*Checksum.*/
-#if FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM || FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM
+    /*Checksum. It may be already checked by HW or by the receive-side coalescing.*/
+#if FNET_CFG_CPU_ETH_HW_RX_PROTOCOL_CHECKSUM || FNET_CFG_CPU_ETH_HW_TX_PROTOCOL_CHECKSUM || FNET_CFG_ETH_GRO
     if(nb->flags & FNET_NETBUF_FLAG_HW_PROTOCOL_CHECKSUM)
     {
         checksum = 0;
@@ -348,6 +377,8 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
         || fnet_socket_addr_is_multicast(src_addr))
         || (nb->total_length < tcp_length) /* Check the length.*/)
     {
+        FNET_STATS_INC(tcp.in_errs);
+        FNET_TCP_TRACE(FNET_TRACE_EVENT_DROP, nb, 0);
         goto DROP;
     }
 
@@ -363,6 +394,7 @@ static void fnet_tcp_input(fnet_netif_t *netif, struct sockaddr *src_addr,  stru
     }
     
     fnet_tcp_trace("RX", buf->data_ptr); /* TCP trace.*/        
+    FNET_TCP_TRACE(FNET_TRACE_EVENT_RX, nb, fnet_trace_flow(src_addr, dest_addr));
     
     sk = fnet_tcp_findsk(src_addr,  dest_addr);
 
@@ -475,6 +507,80 @@ static void fnet_tcp_ctrlinput( fnet_prot_notify_t command, fnet_ip_header_t *ip
     }
 }
 
+#if FNET_CFG_IP6
+/************************************************************************
+* NAME: fnet_tcp_ctrlinput_ip6
+*
+* DESCRIPTION: This function processes the ICMPv6 errors.
+*************************************************************************/
+static void fnet_tcp_ctrlinput_ip6( fnet_prot_notify_t command, fnet_ip6_header_t *ip6_header )
+{
+    fnet_tcp_header_t   *tcp_header;    /* Pointer to the TCP header.*/
+    fnet_socket_t       *sk;            /* Pointer to the socket.*/
+    fnet_tcp_control_t  *cb;
+    struct sockaddr     src_addr;
+    struct sockaddr     dest_addr;
+
+    if(ip6_header && (ip6_header->next_header == FNET_IP_PROTOCOL_TCP))
+    {
+        /* Find the corresponding socket.*/
+        tcp_header = (fnet_tcp_header_t *)((char *)ip6_header + sizeof(fnet_ip6_header_t));
+     
+        /* Foreign addr.*/
+        fnet_memset_zero(&src_addr, sizeof(struct sockaddr));
+        src_addr.sa_family = AF_INET6;
+        src_addr.sa_port = tcp_header->destination_port;
+        FNET_IP6_ADDR_COPY(&ip6_header->destination_addr, &((struct sockaddr_in6 *)(&src_addr))->sin6_addr.s6_addr);
+        
+        /* Local addr.*/
+        fnet_memset_zero(&dest_addr, sizeof(struct sockaddr));
+        dest_addr.sa_family = AF_INET6;
+        dest_addr.sa_port = tcp_header->source_port;
+        FNET_IP6_ADDR_COPY(&ip6_header->source_addr, &((struct sockaddr_in6 *)(&dest_addr))->sin6_addr.s6_addr);
+         
+        sk = fnet_tcp_findsk(&src_addr, &dest_addr);
+ 
+        if(sk)
+        {
+            /* Initialize the pointer of the control block.*/
+            cb = sk->protocol_control;
+
+            switch(command)
+            {
+                case FNET_PROT_NOTIFY_MSGSIZE: /* Packet Too Big.*/
+                  /* The PMTU is already reduced by ICMPv6.
+                   * It is not an error, shrink the segment size.*/
+                  fnet_tcp_update_mss(sk);
+                  
+                  /* Resend the dropped data in smaller segments, 
+                   * without waiting for the retransmission timeout.*/
+                  if((cb->tcpcb_connection_state >= FNET_TCP_CS_ESTABLISHED) 
+                     && (cb->tcpcb_rcvack != cb->tcpcb_sndseq))
+                  {
+                  #if FNET_CFG_TCP_PLPMTUD
+                      fnet_tcp_plpmtud_retransmit(sk);
+                  #endif
+                      cb->tcpcb_flags &= ~FNET_TCP_CBF_FIN_SENT;
+                      cb->tcpcb_sndseq = cb->tcpcb_rcvack;
+                      
+                      /* Round trip time can't be measured in this case.*/
+                      cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
+                      cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
+                      
+                      cb->tcpcb_flags |= FNET_TCP_CBF_FORCE_SEND;
+                      fnet_tcp_sendanydata(sk, 0);
+                      cb->tcpcb_flags &= ~FNET_TCP_CBF_FORCE_SEND;
+                  }
+                  break;
+
+                default:
+                  break;
+            }
+        }
+    }
+}
+#endif /* FNET_CFG_IP6 */
+
 /************************************************************************
 * NAME: fnet_tcp_attach
 *
@@ -690,6 +796,8 @@ static int fnet_tcp_connect( fnet_socket_t *sk, struct sockaddr *foreign_addr)
     cb->tcpcb_connection_state = FNET_TCP_CS_SYN_SENT;
     sk->state = SS_CONNECTING;
 
+    FNET_STATS_INC(tcp.active_opens);
+
     /* Increase Initial Sequence Number.*/
     fnet_tcp_isntime += FNET_TCP_STEPISN;
 
@@ -879,6 +987,37 @@ ERROR:
 *          Otherwise, it returns FNET_ERR.
 *************************************************************************/
 static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const struct sockaddr *foreign_addr)
+{
+    FNET_COMP_UNUSED_ARG(foreign_addr);
+
+    return fnet_tcp_snddata(sk, buf, len, flags, FNET_FALSE, 0, 0);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_snd_ref
+*
+* DESCRIPTION: This function sends the application-owned data 
+*              without copying it to the socket send buffer.
+*
+* RETURNS: If no error occurs, this function returns the length
+*          of the queued data. Otherwise it returns FNET_ERR. 
+*************************************************************************/
+static int fnet_tcp_snd_ref( fnet_socket_t *sk, const char *buf, int len, int flags, void (*handler)(void *cookie), void *cookie )
+{
+    return fnet_tcp_snddata(sk, buf, len, flags, FNET_TRUE, handler, cookie);
+}
+
+/************************************************************************
+* NAME: fnet_tcp_snddata
+*
+* DESCRIPTION: This function adds the data to the socket send buffer
+*              and tries to send it. If ref is FNET_TRUE, the send 
+*              buffer references the data instead of copying it.
+*
+* RETURNS: If no error occurs, this function returns the length
+*          of the queued data. Otherwise it returns FNET_ERR. 
+*************************************************************************/
+static int fnet_tcp_snddata( fnet_socket_t *sk, const char *buf, int len, int flags, int ref, void (*handler)(void *cookie), void *cookie )
 {
     fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control; 
     fnet_netbuf_t       *netbuf;                                             
@@ -890,8 +1029,6 @@ static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const
     unsigned long       malloc_max;
     int                 error_code;
 
-    FNET_COMP_UNUSED_ARG(foreign_addr);
-
     /* If the size of the data greater than the maximal size of the output buffer, return*/
     if(sendlength > FNET_TCP_MAX_BUFFER)
     {
@@ -921,7 +1058,7 @@ static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const
         {
             freespace = 0;     
         }
-        else if(freespace > malloc_max)
+        else if((freespace > malloc_max) && !ref) /* Referenced data do not need a data buffer.*/
         {
            freespace = (long)malloc_max;
         }
@@ -993,7 +1130,10 @@ static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const
             else
                 currentlen = sendlength;
 
-            netbuf = fnet_netbuf_from_buf(&buf[sentlength], currentlen, FNET_TRUE);
+            if(ref)
+                netbuf = fnet_netbuf_from_ref(&buf[sentlength], currentlen, handler, cookie, FNET_TRUE);
+            else
+                netbuf = fnet_netbuf_from_buf((void *)&buf[sentlength], currentlen, FNET_TRUE);
 
             /* Check the memory allocation.*/
             if(netbuf) 
@@ -1039,6 +1179,9 @@ static int fnet_tcp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const
                 }
                 else /* Not able to add to the socket send buffer.*/
                 {
+                    if(ref) /* No data are queued, so do not call the completion handler.*/
+                        ((fnet_netbuf_ref_t *)netbuf->data)->handler = 0;
+                        
                     fnet_netbuf_free( netbuf );
                     fnet_isr_unlock();
                     return 0;
@@ -1283,6 +1426,15 @@ static int fnet_tcp_getsockopt( fnet_socket_t *sk, int level, int optname, char
                 *((unsigned short *)(optval)) = sk->options.tcp_opt.mss;
                 *optlen = sizeof(unsigned short);
                 return FNET_OK;                
+            case TCP_INFO:
+                if((*optlen < 0) || ((unsigned int)*optlen < sizeof(struct tcp_info)))
+                {
+                    fnet_socket_set_error(sk, FNET_ERR_INVAL);
+                    return FNET_ERR;
+                }
+                fnet_tcp_getinfo(sk, (struct tcp_info *)optval);
+                *optlen = sizeof(struct tcp_info);
+                return FNET_OK;
             default:
                 fnet_socket_set_error(sk, FNET_ERR_NOPROTOOPT);
                 return FNET_ERR;
@@ -1299,6 +1451,54 @@ static int fnet_tcp_getsockopt( fnet_socket_t *sk, int level, int optname, char
     }
 }
 
+/************************************************************************
+* NAME: fnet_tcp_getinfo
+*
+* DESCRIPTION: This function fills the TCP_INFO structure
+*              from the control block. 
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_getinfo( fnet_socket_t *sk, struct tcp_info *info )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+
+    fnet_memset_zero(info, sizeof(struct tcp_info));
+
+    fnet_isr_lock();
+
+    info->tcpi_state = (unsigned long)cb->tcpcb_connection_state;
+    
+    /* The timers are in the slow timer periods.*/
+    info->tcpi_rto = (unsigned long)cb->tcpcb_rto * FNET_TCP_SLOWTIMO;
+    info->tcpi_srtt = ((unsigned long)cb->tcpcb_srtt * FNET_TCP_SLOWTIMO) >> FNET_TCP_RTT_SHIFT;
+    info->tcpi_rttvar = ((unsigned long)cb->tcpcb_rttvar * FNET_TCP_SLOWTIMO) >> FNET_TCP_RTTVAR_SHIFT;
+
+    info->tcpi_snd_mss = cb->tcpcb_sndmss;
+    info->tcpi_rcv_mss = cb->tcpcb_rcvmss;
+    info->tcpi_snd_cwnd = cb->tcpcb_cwnd;
+    info->tcpi_snd_ssthresh = cb->tcpcb_ssthresh;
+    info->tcpi_snd_wnd = cb->tcpcb_sndwnd;
+    info->tcpi_rcv_wnd = cb->tcpcb_rcvwnd;
+
+    if(cb->tcpcb_connection_state != FNET_TCP_CS_LISTENING)
+        info->tcpi_unacked = fnet_tcp_getsize(cb->tcpcb_rcvack, cb->tcpcb_maxrcvack);
+
+    info->tcpi_retransmits = cb->tcpcb_retrcounter;
+    info->tcpi_fast_retransmits = cb->tcpcb_fastretrnum;
+    info->tcpi_dupacks = cb->tcpcb_dupacks;
+#if !FNET_CFG_TCP_DISCARD_OUT_OF_ORDER
+    info->tcpi_rcv_ooo = cb->tcpcb_count;
+#endif
+
+    info->tcpi_snd_buf = sk->send_buffer.count;
+    info->tcpi_snd_buf_size = sk->send_buffer.count_max;
+    info->tcpi_rcv_buf = sk->receive_buffer.count;
+    info->tcpi_rcv_buf_size = sk->receive_buffer.count_max;
+
+    fnet_isr_unlock();
+}
+
 /************************************************************************
 * NAME: fnet_tcp_listen
 *
@@ -1414,6 +1614,7 @@ static void fnet_tcp_initconnection( fnet_socket_t *sk )
 
     /* Set the default maximal segment size value.*/
     cb->tcpcb_sndmss = FNET_TCP_DEFAULT_MSS;
+    cb->tcpcb_peermss = FNET_TCP_DEFAULT_MSS;
     cb->tcpcb_rcvmss = sk->options.tcp_opt.mss;
     
     /* Set the length of the socket buffers.*/
@@ -1837,6 +2038,8 @@ static int fnet_tcp_inputsk( fnet_socket_t *sk, fnet_netbuf_t *insegment, struct
             pcb->tcpcb_prev_connection_state = FNET_TCP_CS_LISTENING;
             pcb->tcpcb_connection_state = FNET_TCP_CS_SYN_RCVD;
 
+            FNET_STATS_INC(tcp.passive_opens);
+
             /* Receive the options.*/
             fnet_tcp_getopt(psk, insegment);
             fnet_tcp_getsynopt(psk);
@@ -1987,6 +2190,7 @@ static int fnet_tcp_dataprocess( fnet_socket_t *sk, fnet_netbuf_t *insegment, in
         {
             /* Increase the timer of rpeated acknowledgments.*/
             cb->tcpcb_fastretrcounter++;
+            cb->tcpcb_dupacks++;
 
             /* If the number of repeated acknowledgments is FNET_TCP_NUMBER_FOR_FAST_RET,
              * process the fast retransmission.*/
@@ -2006,9 +2210,15 @@ static int fnet_tcp_dataprocess( fnet_socket_t *sk, fnet_netbuf_t *insegment, in
 
                 cb->tcpcb_cwnd = cb->tcpcb_ssthresh;
 
+            #if FNET_CFG_TCP_PLPMTUD
+                fnet_tcp_plpmtud_retransmit(sk);
+            #endif
+
                 /* Retransmit the segment.*/
                 seq = cb->tcpcb_sndseq;
                 cb->tcpcb_sndseq = cb->tcpcb_rcvack;
+                FNET_STATS_INC(tcp.retrans_segs);
+                cb->tcpcb_fastretrnum++;
                 fnet_tcp_senddataseg(sk, 0, 0, cb->tcpcb_sndmss);
                 cb->tcpcb_sndseq = seq;
 
@@ -2070,6 +2280,17 @@ static int fnet_tcp_dataprocess( fnet_socket_t *sk, fnet_netbuf_t *insegment, in
         if(FNET_TCP_COMP_G(cb->tcpcb_rcvack, cb->tcpcb_sndseq))
             cb->tcpcb_sndseq = cb->tcpcb_rcvack;
 
+    #if FNET_CFG_TCP_PLPMTUD
+        /* The probe is acknowledged, so the path takes segments of its size.*/
+        if(cb->tcpcb_plpprobe 
+           && FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_plpseq + cb->tcpcb_plpprobe))
+        {
+            cb->tcpcb_plpmss = cb->tcpcb_plpprobe;
+            cb->tcpcb_plpprobe = 0;
+            fnet_tcp_update_mss(sk);
+        }
+    #endif /* FNET_CFG_TCP_PLPMTUD */
+
         /* Calculate the retransmission timeout ( using Jacobson method ).*/
         if(FNET_TCP_COMP_GE(cb->tcpcb_rcvack, cb->tcpcb_timingack) && cb->tcpcb_timing_state == TCP_TS_SEGMENT_SENT)
         {
@@ -2221,6 +2442,7 @@ static int fnet_tcp_addinpbuf( fnet_socket_t *sk, fnet_netbuf_t *insegment, int
         /* Add the data.*/
         if(insegment)
         {
+            FNET_LATENCY_RX(FNET_LATENCY_RX_SOCKET, insegment);
             cb->tcpcb_sndack += insegment->total_length;
             sk->receive_buffer.net_buf_chain = fnet_netbuf_concat(sk->receive_buffer.net_buf_chain,
                                                                   insegment);
@@ -2347,6 +2569,7 @@ static int fnet_tcp_addinpbuf( fnet_socket_t *sk, fnet_netbuf_t *insegment, int
                         /* Add the data.*/
                         if(buf)
                         {
+                            FNET_LATENCY_RX(FNET_LATENCY_RX_SOCKET, buf);
                             sk->receive_buffer.count += buf->total_length;
                             sk->receive_buffer.net_buf_chain =
                                 fnet_netbuf_concat(sk->receive_buffer.net_buf_chain,
@@ -2397,10 +2620,16 @@ static int fnet_tcp_sendanydata( fnet_socket_t *sk, int oneexec )
     long                wnd;        /* Windows */
     long                datasize;   /* Size of the data that can be sent from the output buffer.*/
     int                 result = 0;
+#if FNET_CFG_TCP_PLPMTUD
+    unsigned short      probesize;  /* Size of the PLPMTUD probe.*/
+#endif
     
     /* Reset the silly window avoidance flag.*/
     cb->tcpcb_flags &= ~FNET_TCP_CBF_SEND_TIMEOUT;
 
+    /* Follow the changes of the path MTU.*/
+    fnet_tcp_update_mss(sk);
+
     /* Receive the size of the data that is sent.*/
     sntdata = fnet_tcp_getsize(cb->tcpcb_rcvack, cb->tcpcb_sndseq);
 
@@ -2456,6 +2685,28 @@ static int fnet_tcp_sendanydata( fnet_socket_t *sk, int oneexec )
 
     while(sndwnd > 0)
     {
+        /* The outgoing interface can not take more packets now.
+         * Defer the sending, it is continued by fnet_tcp_output_resume().*/
+        if(fnet_tcp_output_busy(sk))
+        {
+            cb->tcpcb_flags |= FNET_TCP_CBF_DEV_BUSY;
+            break;
+        }
+
+    #if FNET_CFG_TCP_PLPMTUD
+        /* Sending of the probe, larger than the MSS (RFC4821).*/
+        if(((probesize = fnet_tcp_plpmtud_probe_size(sk)) != 0) && (probesize <= sndwnd))
+        {
+            cb->tcpcb_plpseq = cb->tcpcb_sndseq;
+            cb->tcpcb_plpprobe = probesize;
+            
+            fnet_tcp_senddataseg(sk, 0, 0, probesize);
+
+            sndwnd -= probesize;
+            sntdata += probesize;
+        }
+        else
+    #endif /* FNET_CFG_TCP_PLPMTUD */
         /* Sending of the maximal size segment.*/
         if(cb->tcpcb_sndmss <= sndwnd)
         {
@@ -2913,6 +3164,14 @@ static void fnet_tcp_fasttimosk( fnet_socket_t *sk )
    
     if(sk->state != SS_UNCONNECTED)
     {
+        /* Retry the sending, deferred by a busy interface 
+         * (if the resume notification has not done it).*/
+        if(cb->tcpcb_flags & FNET_TCP_CBF_DEV_BUSY)
+        {
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_DEV_BUSY;
+            fnet_tcp_sendanydata(sk, 0);
+        }
+
         /* Check the delayed acknowledgment timer.*/
         if(cb->tcpcb_timers.delayed_ack != FNET_TCP_TIMER_OFF)
         {
@@ -2952,6 +3211,8 @@ static void fnet_tcp_rtimeo( fnet_socket_t *sk )
           fnet_tcp_setsynopt(sk, options, &optionlen);
 
           /* Create and send the SYN segment.*/
+          FNET_STATS_INC(tcp.retrans_segs);
+          cb->tcpcb_retrcounter++;
           fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_SYN | FNET_TCP_SGT_ACK, options, optionlen);
 
           break;
@@ -2965,6 +3226,8 @@ static void fnet_tcp_rtimeo( fnet_socket_t *sk )
           fnet_tcp_setsynopt(sk, options, &optionlen);
 
           /* Send the SYN segment.*/
+          FNET_STATS_INC(tcp.retrans_segs);
+          cb->tcpcb_retrcounter++;
           fnet_tcp_sendheadseg(sk, FNET_TCP_SGT_SYN, options, optionlen);
 
           break;
@@ -2978,6 +3241,10 @@ static void fnet_tcp_rtimeo( fnet_socket_t *sk )
           if(cb->tcpcb_timers.abort == FNET_TCP_TIMER_OFF)
               cb->tcpcb_timers.abort = FNET_TCP_ABORT_INTERVAL;
 
+      #if FNET_CFG_TCP_PLPMTUD
+          fnet_tcp_plpmtud_retransmit(sk);
+      #endif
+
           /* Recalculate the sequence number.*/
           cb->tcpcb_sndseq = cb->tcpcb_rcvack;
 
@@ -2996,6 +3263,9 @@ static void fnet_tcp_rtimeo( fnet_socket_t *sk )
           cb->tcpcb_timers.round_trip = FNET_TCP_TIMER_OFF;
           cb->tcpcb_timing_state = TCP_TS_SEGMENT_LOST;
 
+          /* The congestion window is one segment.*/
+          FNET_STATS_INC(tcp.retrans_segs);
+          cb->tcpcb_retrcounter++;
           cb->tcpcb_flags |= FNET_TCP_CBF_FORCE_SEND;
           fnet_tcp_sendanydata(sk, 0);
           cb->tcpcb_flags &= ~FNET_TCP_CBF_FORCE_SEND;
@@ -3050,6 +3320,7 @@ static void fnet_tcp_ktimeo( fnet_socket_t *sk )
 
     /* Send the segment.*/
     segment.sockoption = &sk->options; 
+    segment.dst = &sk->dst_cache;
     segment.src_addr = sk->local_addr;
     segment.dest_addr = sk->foreign_addr;
     segment.seq = cb->tcpcb_rcvack - 1;
@@ -3186,9 +3457,16 @@ static int fnet_tcp_sendseg(struct fnet_tcp_segment *segment)
     FNET_TCP_SET_FLAGS(nb) = segment->flags;
     FNET_TCP_WND(nb) = fnet_htons(segment->wnd);
 
+    FNET_STATS_INC(tcp.out_segs);
+    if(segment->flags & FNET_TCP_SGT_RST)
+        FNET_STATS_INC(tcp.out_rsts);
+
     /* Add the data.*/
     nb = fnet_netbuf_concat(nb, segment->data);
 
+    FNET_TCP_TRACE(FNET_TRACE_EVENT_TX, nb, fnet_trace_flow(&segment->src_addr, &segment->dest_addr));
+    FNET_LATENCY_TX_STAMP(nb);
+
     /* Set the pointer to the urgent data.*/
     FNET_TCP_URG(nb) = fnet_htons(segment->urgpointer);
 
@@ -3201,13 +3479,13 @@ static int fnet_tcp_sendseg(struct fnet_tcp_segment *segment)
     if( 0 
 #if FNET_CFG_IP4
         ||( (segment->dest_addr.sa_family == AF_INET) 
-        && ((netif = fnet_ip_route(((struct sockaddr_in *)(&segment->dest_addr))->sin_addr.s_addr))!= FNET_NULL)
+        && ((netif = fnet_ip_dst_route(segment->dst, ((struct sockaddr_in *)(&segment->dest_addr))->sin_addr.s_addr))!= FNET_NULL)
         && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
-        && (fnet_ip_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
+        && (fnet_ip_will_fragment(netif, segment->dst, ((struct sockaddr_in *)(&segment->dest_addr))->sin_addr.s_addr, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
 #endif
 #if FNET_CFG_IP6
         ||( (segment->dest_addr.sa_family == AF_INET6) 
-        && (netif || ((netif = fnet_ip6_route(&((struct sockaddr_in6 *)(&segment->src_addr))->sin6_addr.s6_addr, &((struct sockaddr_in6 *)(&segment->dest_addr))->sin6_addr.s6_addr))!= FNET_NULL ) )
+        && (netif || ((netif = fnet_ip6_dst_route(segment->dst, &((struct sockaddr_in6 *)(&segment->src_addr))->sin6_addr.s6_addr, &((struct sockaddr_in6 *)(&segment->dest_addr))->sin6_addr.s6_addr))!= FNET_NULL ) )
         && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
         && (fnet_ip6_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
 #endif
@@ -3235,7 +3513,7 @@ static int fnet_tcp_sendseg(struct fnet_tcp_segment *segment)
                                 (unsigned char)(segment->sockoption ? segment->sockoption->ip_opt.ttl : FNET_TCP_TTL_DEFAULT),
                                 nb, 0, 
                                 segment->sockoption ? ((segment->sockoption->flags & SO_DONTROUTE) > 0) : 0,
-                                checksum_p);
+                                checksum_p, segment->dst);
     }
     else
 #endif    
@@ -3248,7 +3526,7 @@ static int fnet_tcp_sendseg(struct fnet_tcp_segment *segment)
                                 FNET_IP_PROTOCOL_TCP, 
                                 (unsigned char)(segment->sockoption ? segment->sockoption->ip6_opt.unicast_hops : 0 /*default*/),
                                 nb, 
-                                checksum_p );
+                                checksum_p, segment->dst );
     }
     else
 #endif    
@@ -3331,6 +3609,7 @@ static int fnet_tcp_sendheadseg( fnet_socket_t *sk, unsigned char flags, void *o
 
     /* Send the segment.*/ 
     segment.sockoption = &sk->options; 
+    segment.dst = &sk->dst_cache;
     segment.src_addr = sk->local_addr;
     segment.dest_addr = sk->foreign_addr;
     segment.seq = cb->tcpcb_sndseq;
@@ -3392,11 +3671,7 @@ static int fnet_tcp_senddataseg( fnet_socket_t *sk, void *options, char optlen,
     if(datasize > newdatasize)
         datasize = (unsigned long)newdatasize;
 
-#if FNET_CFG_IP4
-    tmp = fnet_ip_maximum_packet(((struct sockaddr_in *)(&sk->foreign_addr))->sin_addr.s_addr);
-#else //TBD
-    tmp = 0;
-#endif    
+    tmp = fnet_tcp_maximum_packet(sk);
 
     if((datasize + FNET_TCP_SIZE_HEADER) > tmp)
         datasize = (tmp - FNET_TCP_SIZE_HEADER);
@@ -3471,6 +3746,7 @@ static int fnet_tcp_senddataseg( fnet_socket_t *sk, void *options, char optlen,
 
     /* Send the segment.*/
     segment.sockoption = &sk->options; 
+    segment.dst = &sk->dst_cache;
     segment.src_addr = sk->local_addr;
     segment.dest_addr = sk->foreign_addr;    
     segment.seq = cb->tcpcb_sndseq;
@@ -3584,6 +3860,7 @@ static void fnet_tcp_sendrst( fnet_socket_option_t *sockoption, fnet_netbuf_t *i
     } 
     
     segment.sockoption = sockoption; 
+    segment.dst = FNET_NULL;
     segment.src_addr = *src_addr;
     segment.dest_addr = *dest_addr;
     segment.wnd = 0;
@@ -3629,6 +3906,7 @@ static void fnet_tcp_sendrstsk( fnet_socket_t *sk )
         } 
   
         segment.sockoption = &sk->options; 
+        segment.dst = &sk->dst_cache;
         segment.src_addr = sk->local_addr;
         segment.dest_addr = sk->foreign_addr;
         segment.wnd = 0;
@@ -3751,7 +4029,7 @@ static void fnet_tcp_getopt( fnet_socket_t *sk, fnet_netbuf_t *segment )
             switch(FNET_TCP_GETUCHAR(segment->data_ptr, i))
             {
                 case FNET_TCP_OTYPES_MSS:
-                  cb->tcpcb_sndmss = fnet_ntohs(FNET_TCP_GETUSHORT(segment->data_ptr, i + 2));
+                  cb->tcpcb_peermss = fnet_ntohs(FNET_TCP_GETUSHORT(segment->data_ptr, i + 2));
                   break;
 
                 case FNET_TCP_OTYPES_WINDOW:
@@ -3785,16 +4063,31 @@ static void fnet_tcp_setsynopt( fnet_socket_t *sk, char *options, char *optionle
     /* If 0, detect MSS based on interface MTU minus "TCP,IP header size".*/
     if(cb->tcpcb_rcvmss == 0)
     {
-    #if FNET_CFG_IP4 //TBD
         fnet_netif_t *netif;
         
-        if((netif = fnet_ip_route(((struct sockaddr_in *)(&sk->foreign_addr))->sin_addr.s_addr)) != 0) 
+    #if FNET_CFG_IP4
+        if(sk->foreign_addr.sa_family == AF_INET)
+        {
+            if((netif = fnet_ip_dst_route(&sk->dst_cache, ((struct sockaddr_in *)(&sk->foreign_addr))->sin_addr.s_addr)) != 0) 
+            {
+                cb->tcpcb_rcvmss = (unsigned short) (netif->mtu - 40); /* MTU - [TCP,IP header size].*/
+            }
+        }
+        else
+    #endif /* FNET_CFG_IP4 */
+    #if FNET_CFG_IP6
+        if(sk->foreign_addr.sa_family == AF_INET6)
         {
-            cb->tcpcb_rcvmss = (unsigned short) (netif->mtu - 40); /* MTU - [TCP,IP header size].*/
+            if((netif = fnet_ip6_dst_route(&sk->dst_cache, 
+                                            &((struct sockaddr_in6 *)(&sk->local_addr))->sin6_addr.s6_addr, 
+                                            &((struct sockaddr_in6 *)(&sk->foreign_addr))->sin6_addr.s6_addr)) != 0) 
+            {
+                cb->tcpcb_rcvmss = (unsigned short) (netif->mtu - 60); /* MTU - [TCP,IPv6 header size].*/
+            }
         }
-    #else
-        cb->tcpcb_rcvmss = 0; // TBD create FNET
-    #endif /* FNET_CFG_IP4 */ //TBD        
+        else
+    #endif /* FNET_CFG_IP6 */
+        {}
     }
     
 
@@ -3833,11 +4126,215 @@ static void fnet_tcp_getsynopt( fnet_socket_t *sk )
             cb->tcpcb_rcvcountmax = FNET_TCP_MAXWIN;
     }
 
+    /* Limit the MSS of another side by the path MTU.*/
+    fnet_tcp_update_mss(sk);
+
     /* Initialize the congestion window.*/
     cb->tcpcb_cwnd = cb->tcpcb_sndmss;
 
 }
 
+/************************************************************************
+* NAME: fnet_tcp_maximum_packet
+*
+* DESCRIPTION: This function returns the maximum size of the TCP segment
+*              (header included), that may be sent to the foreign address.
+*
+* RETURNS: The maximum size of the segment.
+*************************************************************************/
+static unsigned long fnet_tcp_maximum_packet( fnet_socket_t *sk )
+{
+    unsigned long result;
+
+#if FNET_CFG_IP4
+    if(sk->foreign_addr.sa_family == AF_INET)
+    {
+        result = fnet_ip_maximum_packet(&sk->dst_cache, ((struct sockaddr_in *)(&sk->foreign_addr))->sin_addr.s_addr);
+    }
+    else
+#endif
+#if FNET_CFG_IP6
+    if(sk->foreign_addr.sa_family == AF_INET6)
+    {
+        result = fnet_ip6_maximum_packet(&sk->dst_cache, &((struct sockaddr_in6 *)(&sk->foreign_addr))->sin6_addr.s6_addr);
+    }
+    else
+#endif
+    {
+        result = FNET_TCP_DEFAULT_MSS + FNET_TCP_SIZE_HEADER;
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_output_busy
+*
+* DESCRIPTION: Checks if the outgoing interface of the socket 
+*              can not take more packets now.
+*
+* RETURNS: FNET_TRUE if the interface is busy, otherwise FNET_FALSE.
+*************************************************************************/
+static int fnet_tcp_output_busy( fnet_socket_t *sk )
+{
+    int result;
+
+    if(FNET_NETIF_DST_IS_VALID(&sk->dst_cache))
+        result = fnet_netif_output_busy(sk->dst_cache.netif);
+    else
+        result = FNET_FALSE;
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_output_resume
+*
+* DESCRIPTION: This function is called when the interface can take 
+*              outgoing packets again. It continues the sending 
+*              deferred by FNET_TCP_CBF_DEV_BUSY.
+*
+* RETURNS: None.
+*************************************************************************/
+void fnet_tcp_output_resume( fnet_netif_t *netif )
+{
+    fnet_socket_t       *sk;
+    fnet_tcp_control_t  *cb;
+
+    fnet_isr_lock();
+
+    for(sk = fnet_tcp_prot_if.head; sk; sk = sk->next)
+    {
+        cb = (fnet_tcp_control_t *)sk->protocol_control;
+
+        if((cb->tcpcb_flags & FNET_TCP_CBF_DEV_BUSY) 
+            && ((sk->dst_cache.netif == netif) || (sk->dst_cache.netif == FNET_NULL)))
+        {
+            cb->tcpcb_flags &= ~FNET_TCP_CBF_DEV_BUSY;
+            fnet_tcp_sendanydata(sk, 0);
+
+            /* The interface is busy again, the rest waits for the next notification.*/
+            if(fnet_netif_output_busy(netif))
+                break;
+        }
+    }
+
+    fnet_isr_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_tcp_update_mss
+*
+* DESCRIPTION: This function sets the MSS, used for sending, to the 
+*              MSS of another side, limited by the path MTU.
+*              With PLPMTUD, it is limited also by the largest probe 
+*              acknowledged on the path.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_update_mss( fnet_socket_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    unsigned long       mss;
+#if FNET_CFG_TCP_PLPMTUD
+    unsigned long       base_mss;
+#endif
+    
+    mss = fnet_tcp_maximum_packet(sk) - FNET_TCP_SIZE_HEADER;
+
+    if(mss > cb->tcpcb_peermss)
+        mss = cb->tcpcb_peermss;
+
+#if FNET_CFG_TCP_PLPMTUD
+    /* RFC4821: Start from the size that is supported by any path.*/
+#if FNET_CFG_IP6
+    if(sk->foreign_addr.sa_family == AF_INET6)
+        base_mss = FNET_TCP_MIN_MSS_IP6;
+    else
+#endif
+        base_mss = FNET_TCP_DEFAULT_MSS;
+
+    /* The probes are searched up to the current MSS, 
+     * or up to the lost probe size, until the size is probed again.*/
+    if(cb->tcpcb_plpfail 
+       && (fnet_timer_get_interval(cb->tcpcb_plptime, fnet_timer_ms()) > (FNET_CFG_TCP_PLPMTUD_TIMEOUT * 1000UL)))
+        cb->tcpcb_plpfail = 0;
+
+    if(cb->tcpcb_plpfail && (mss >= cb->tcpcb_plpfail))
+        cb->tcpcb_plphigh = (unsigned short)(cb->tcpcb_plpfail - 1);
+    else
+        cb->tcpcb_plphigh = (unsigned short)mss;
+
+    /* The probe is dropped by the reduced path MTU.*/
+    if(cb->tcpcb_plpprobe > mss)
+        cb->tcpcb_plpprobe = 0;
+
+    if(cb->tcpcb_plpmss > base_mss)
+        base_mss = cb->tcpcb_plpmss;
+
+    if(mss > base_mss)
+        mss = base_mss;
+#endif /* FNET_CFG_TCP_PLPMTUD */
+
+    cb->tcpcb_sndmss = (unsigned short)mss;
+}
+
+#if FNET_CFG_TCP_PLPMTUD
+/************************************************************************
+* NAME: fnet_tcp_plpmtud_probe_size
+*
+* DESCRIPTION: This function returns the size of the next PLPMTUD probe
+*              (RFC4821), halfway between the MSS and the upper limit.
+*              Only one probe is in flight.
+*
+* RETURNS: Size of the probe, or 0 if no probe is sent.
+*************************************************************************/
+static unsigned short fnet_tcp_plpmtud_probe_size( fnet_socket_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+    unsigned short      result = 0;
+
+    if((cb->tcpcb_plpprobe == 0)
+       && (cb->tcpcb_plphigh >= (cb->tcpcb_sndmss + FNET_TCP_PLPMTUD_STEP)))
+    {
+        result = (unsigned short)((cb->tcpcb_sndmss + cb->tcpcb_plphigh + 1) >> 1);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_tcp_plpmtud_retransmit
+*
+* DESCRIPTION: This function is called, when the data is retransmitted
+*              from the first unacknowledged byte. If it is the probe, 
+*              the probe is lost and its size is not probed again until
+*              FNET_CFG_TCP_PLPMTUD_TIMEOUT. The MSS is not changed.
+*              Otherwise the probe result is unknown, as its data 
+*              is retransmitted in smaller segments.
+*
+* RETURNS: None.
+*************************************************************************/
+static void fnet_tcp_plpmtud_retransmit( fnet_socket_t *sk )
+{
+    fnet_tcp_control_t  *cb = (fnet_tcp_control_t *)sk->protocol_control;
+
+    if(cb->tcpcb_plpprobe)
+    {
+        if(cb->tcpcb_plpseq == cb->tcpcb_rcvack)
+        {
+            cb->tcpcb_plpfail = cb->tcpcb_plpprobe;
+            cb->tcpcb_plptime = fnet_timer_ms();
+            
+            if(cb->tcpcb_plphigh >= cb->tcpcb_plpfail)
+                cb->tcpcb_plphigh = (unsigned short)(cb->tcpcb_plpfail - 1);
+        }
+
+        cb->tcpcb_plpprobe = 0;
+    }
+}
+#endif /* FNET_CFG_TCP_PLPMTUD */
+
 /************************************************************************
 * NAME: fnet_tcp_findsk
 *
@@ -3847,7 +4344,7 @@ static void fnet_tcp_getsynopt( fnet_socket_t *sk )
 * RETURNS: If the socket is found this function returns the pointer to the
 *          socket. Otherwise, this function returns 0.
 *************************************************************************/
-static fnet_socket_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr )                                       
+fnet_socket_t *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr )                                       
 {
     fnet_socket_t   *listensk = 0;
     fnet_socket_t   *sk;
@@ -3962,6 +4459,16 @@ static void fnet_tcp_closesk( fnet_socket_t *sk )
     /* Initialize the pointer to the control block.*/
     fnet_tcp_control_t *cb = (fnet_tcp_control_t *)sk->protocol_control;
 
+#if FNET_CFG_STATS
+    /* RFC1213: Direct transitions to the CLOSED state.*/
+    if((cb->tcpcb_connection_state == FNET_TCP_CS_SYN_SENT) 
+        || (cb->tcpcb_connection_state == FNET_TCP_CS_SYN_RCVD))
+        FNET_STATS_INC(tcp.attempt_fails);
+    else if((cb->tcpcb_connection_state == FNET_TCP_CS_ESTABLISHED) 
+        || (cb->tcpcb_connection_state == FNET_TCP_CS_CLOSE_WAIT))
+        FNET_STATS_INC(tcp.estab_resets);
+#endif
+
     if(sk->head_con)
     {
         /* If the socket is partial or incoming.*/
@@ -52,6 +52,9 @@
 *************************************************************************/
 extern struct fnet_prot_if fnet_tcp_prot_if;
 
+void fnet_tcp_output_resume( fnet_netif_t *netif );
+struct _socket *fnet_tcp_findsk( struct sockaddr *src_addr,  struct sockaddr *dest_addr );
+
 /************************************************************************
 *    Size of urgent data
 *************************************************************************/
@@ -77,6 +80,8 @@ extern struct fnet_prot_if fnet_tcp_prot_if;
 *    Defaults values
 *************************************************************************/
 #define FNET_TCP_DEFAULT_MSS    (536)                      /* Default value of MSS.*/
+#define FNET_TCP_MIN_MSS_IP6    (1220)                     /* Minimum MSS over IPv6 (IPv6 minimum MTU - [TCP,IPv6 header size]).*/
+#define FNET_TCP_PLPMTUD_STEP   (32)                       /* PLPMTUD stops probing, when the searched range is smaller.*/
 #define FNET_TCP_TX_BUF_MAX     (FNET_CFG_SOCKET_TCP_TX_BUF_SIZE) /* Default maximum size for TCP send socket buffer.*/
 #define FNET_TCP_RX_BUF_MAX     (FNET_CFG_SOCKET_TCP_RX_BUF_SIZE) /* Default maximum size for TCP receive socket buffer.*/
 
@@ -286,6 +291,7 @@ FNET_COMP_PACKED_END
 #define FNET_TCP_CBF_RCVD_SCALE     (0x20)  /* Another side uses the scale option.*/
 #define FNET_TCP_CBF_SEND_TIMEOUT   (0x40)  /* Silly window avoidance flag.*/
 #define FNET_TCP_CBF_INSND          (0x80)  /* The fnet_tcp_snd function is executed now.*/
+#define FNET_TCP_CBF_DEV_BUSY       (0x100) /* Sending is deferred, the outgoing interface is busy.*/
 
 /************************************************************************
 *    Standart states for TCP ( described in RFC793)
@@ -366,7 +372,16 @@ typedef struct
     unsigned long tcpcb_cwnd;           /* Congestion window.*/
     unsigned long tcpcb_pcount;         /* Counter of the tcpcb_cwnd parts.*/
     unsigned long tcpcb_ssthresh;       /* Slow start threshold.*/
-    unsigned short tcpcb_sndmss;        /* Maximal segment size (MSS).*/    
+    unsigned short tcpcb_sndmss;        /* Maximal segment size (MSS), limited by the path MTU.*/    
+    unsigned short tcpcb_peermss;       /* MSS of another side.*/
+#if FNET_CFG_TCP_PLPMTUD
+    unsigned short tcpcb_plpmss;        /* Largest MSS confirmed by a probe (0 = the base MSS).*/
+    unsigned short tcpcb_plphigh;       /* Upper limit of the probed MSS.*/
+    unsigned short tcpcb_plpfail;       /* Smallest lost probe size (0 = no loss).*/
+    unsigned short tcpcb_plpprobe;      /* Size of the probe in flight (0 = no probe).*/
+    unsigned long tcpcb_plpseq;         /* First sequence number of the probe.*/
+    unsigned long tcpcb_plptime;        /* Time (ms) when a probe has been lost.*/
+#endif /* FNET_CFG_TCP_PLPMTUD */
     unsigned char tcpcb_sendscale;      /* Scale of the window.*/
 #if FNET_CFG_TCP_URGENT     
     unsigned long tcpcb_sndurgseq;      /* Sequence number of the urgent byte.*/
@@ -384,6 +399,9 @@ typedef struct
     unsigned short tcpcb_srtt;          /* Smoothed round trip time.*/
     unsigned short tcpcb_rttvar;        /* Round trip time variance.*/
     fnet_tcp_timing_state_t tcpcb_timing_state;   /* Timing state, defined by fnet_tcp_timing_state_t.*/
+    unsigned long tcpcb_retrcounter;    /* Number of retransmissions on timeout (TCP_INFO).*/
+    unsigned long tcpcb_fastretrnum;    /* Number of fast retransmissions (TCP_INFO).*/
+    unsigned long tcpcb_dupacks;        /* Number of repeated acknowledgments (TCP_INFO).*/
 
     /* Timers.*/
     fnet_tcp_timers_t tcpcb_timers;     /* Structure of the timers.*/
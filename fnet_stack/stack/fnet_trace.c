@@ -0,0 +1,349 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_trace.c
+*
+* @author Andrey Butok
+*
+* @brief FNET binary trace ring.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_TRACE
+
+#include "fnet_trace_prv.h"
+#include "fnet_cpu.h"
+
+#if (FNET_CFG_TRACE_SIZE & (FNET_CFG_TRACE_SIZE - 1)) || (FNET_CFG_TRACE_SIZE == 0)
+    #error "FNET_CFG_TRACE_SIZE must be a power of two."
+#endif
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_TRACE_RING_MASK        (FNET_CFG_TRACE_SIZE - 1)
+
+#define FNET_TRACE_PCAPNG_SHB       (0x0A0D0D0AUL)  /* Section Header Block.*/
+#define FNET_TRACE_PCAPNG_IDB       (0x00000001UL)  /* Interface Description Block.*/
+#define FNET_TRACE_PCAPNG_EPB       (0x00000006UL)  /* Enhanced Packet Block.*/
+#define FNET_TRACE_PCAPNG_MAGIC     (0x1A2B3C4DUL)  /* Byte-order magic.*/
+#define FNET_TRACE_PCAPNG_TSRESOL   (9)             /* if_tsresol option code.*/
+
+/* pcap-ng blocks. They are written in the byte order of the target.*/
+struct fnet_trace_pcapng_shb
+{
+    unsigned long   type;
+    unsigned long   length;
+    unsigned long   magic;
+    unsigned short  major;
+    unsigned short  minor;
+    unsigned long   section_length[2];
+    unsigned long   length_trailer;
+};
+
+struct fnet_trace_pcapng_idb
+{
+    unsigned long   type;
+    unsigned long   length;
+    unsigned short  linktype;
+    unsigned short  reserved;
+    unsigned long   snaplen;
+    unsigned short  tsresol_code;
+    unsigned short  tsresol_length;
+    unsigned char   tsresol[4];     /* Padded to 32 bits.*/
+    unsigned short  end_code;
+    unsigned short  end_length;
+    unsigned long   length_trailer;
+};
+
+struct fnet_trace_pcapng_epb
+{
+    unsigned long           type;
+    unsigned long           length;
+    unsigned long           interface_id;
+    unsigned long           timestamp_high;
+    unsigned long           timestamp_low;
+    unsigned long           captured_length;
+    unsigned long           packet_length;
+    struct fnet_trace_rec   rec;
+    unsigned long           length_trailer;
+};
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+unsigned long fnet_trace_mask = 0xFFFFFFFFUL;  /* Run-time mask.*/
+
+static struct fnet_trace_rec    fnet_trace_ring[FNET_CFG_TRACE_SIZE];
+static unsigned long            fnet_trace_head;    /* Number of the written records.*/
+static unsigned long            fnet_trace_first;   /* Number of the first record after clearing.*/
+
+static const struct fnet_trace_pcapng_shb fnet_trace_pcapng_shb =
+{
+    FNET_TRACE_PCAPNG_SHB, sizeof(struct fnet_trace_pcapng_shb), FNET_TRACE_PCAPNG_MAGIC,
+    1, 0,                               /* Version 1.0.*/
+    {0xFFFFFFFFUL, 0xFFFFFFFFUL},       /* Section length is not specified.*/
+    sizeof(struct fnet_trace_pcapng_shb)
+};
+
+static const struct fnet_trace_pcapng_idb fnet_trace_pcapng_idb =
+{
+    FNET_TRACE_PCAPNG_IDB, sizeof(struct fnet_trace_pcapng_idb),
+    FNET_TRACE_PCAPNG_LINKTYPE, 0,
+    sizeof(struct fnet_trace_rec),      /* Snap length.*/
+    FNET_TRACE_PCAPNG_TSRESOL, 1, {FNET_CFG_TRACE_TIMESTAMP_RES, 0, 0, 0},
+    0, 0,                               /* End of options.*/
+    sizeof(struct fnet_trace_pcapng_idb)
+};
+
+/************************************************************************
+* NAME: fnet_trace_record
+*
+* DESCRIPTION: Writes a record to the ring, overwriting the oldest one.
+*              The slot is reserved and filled with the interrupts 
+*              disabled for a few instructions, without the stack lock.
+*************************************************************************/
+void fnet_trace_record( fnet_trace_layer_t layer, fnet_trace_event_t event, unsigned long flow, 
+                        unsigned long seq, unsigned long ack, unsigned long info, unsigned long length )
+{
+    struct fnet_trace_rec   *rec;
+    unsigned long           timestamp = FNET_CFG_TRACE_TIMESTAMP();
+    fnet_cpu_irq_desc_t     irq_desc;
+
+    irq_desc = fnet_cpu_irq_disable();
+
+    rec = &fnet_trace_ring[fnet_trace_head & FNET_TRACE_RING_MASK];
+    fnet_trace_head++;
+
+    rec->timestamp = timestamp;
+    rec->layer = (unsigned char)layer;
+    rec->event = (unsigned char)event;
+    rec->length = (unsigned short)length;
+    rec->flow = flow;
+    rec->seq = seq;
+    rec->ack = ack;
+    rec->info = info;
+
+    fnet_cpu_irq_enable(irq_desc);
+}
+
+/************************************************************************
+* NAME: fnet_trace_hash
+*
+* DESCRIPTION: Returns the FNV-1a hash of the data.
+*************************************************************************/
+unsigned long fnet_trace_hash( const void *data, unsigned int size )
+{
+    const unsigned char *ptr = (const unsigned char *)data;
+    unsigned long       hash = 2166136261UL;
+
+    while(size--)
+    {
+        hash ^= *ptr++;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/************************************************************************
+* NAME: fnet_trace_flow
+*
+* DESCRIPTION: Returns the flow hash of two socket addresses.
+*              It does not depend on their order.
+*************************************************************************/
+unsigned long fnet_trace_flow( const struct sockaddr *addr1, const struct sockaddr *addr2 )
+{
+    unsigned int size = (addr1->sa_family == AF_INET6) ? 16 : 4;
+
+    return (fnet_trace_hash(addr1->sa_data, size) + addr1->sa_port)
+           ^ (fnet_trace_hash(addr2->sa_data, size) + addr2->sa_port);
+}
+
+/************************************************************************
+* NAME: fnet_trace_set_mask
+*
+* DESCRIPTION: Sets the run-time trace mask.
+*************************************************************************/
+void fnet_trace_set_mask( unsigned long mask )
+{
+    fnet_trace_mask = mask;
+}
+
+/************************************************************************
+* NAME: fnet_trace_get_mask
+*
+* DESCRIPTION: Returns the run-time trace mask.
+*************************************************************************/
+unsigned long fnet_trace_get_mask( void )
+{
+    return fnet_trace_mask;
+}
+
+/************************************************************************
+* NAME: fnet_trace_clear
+*
+* DESCRIPTION: Removes all records from the ring.
+*************************************************************************/
+void fnet_trace_clear( void )
+{
+    fnet_cpu_irq_desc_t irq_desc = fnet_cpu_irq_disable();
+
+    fnet_trace_first = fnet_trace_head;
+
+    fnet_cpu_irq_enable(irq_desc);
+}
+
+/************************************************************************
+* NAME: fnet_trace_get
+*
+* DESCRIPTION: Copies the n-th oldest record of the ring.
+*************************************************************************/
+int fnet_trace_get( unsigned long n, struct fnet_trace_rec *rec )
+{
+    int                 result = FNET_ERR;
+    unsigned long       first;
+    fnet_cpu_irq_desc_t irq_desc;
+
+    if(rec)
+    {
+        irq_desc = fnet_cpu_irq_disable();
+
+        first = fnet_trace_first;
+        if((fnet_trace_head - first) > FNET_CFG_TRACE_SIZE)
+            first = fnet_trace_head - FNET_CFG_TRACE_SIZE; /* Overwritten.*/
+
+        if(n < (fnet_trace_head - first))
+        {
+            *rec = fnet_trace_ring[(first + n) & FNET_TRACE_RING_MASK];
+            result = FNET_OK;
+        }
+
+        fnet_cpu_irq_enable(irq_desc);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fnet_trace_pcapng
+*
+* DESCRIPTION: Writes the ring as a pcap-ng file, one packet per record.
+*************************************************************************/
+int fnet_trace_pcapng( fnet_trace_write_t write, void *cookie )
+{
+    struct fnet_trace_pcapng_epb    epb;
+    unsigned long                   n;
+
+    if(write == 0)
+        return FNET_ERR;
+
+    write(cookie, &fnet_trace_pcapng_shb, sizeof(fnet_trace_pcapng_shb));
+    write(cookie, &fnet_trace_pcapng_idb, sizeof(fnet_trace_pcapng_idb));
+
+    epb.type = FNET_TRACE_PCAPNG_EPB;
+    epb.length = sizeof(epb);
+    epb.interface_id = 0;
+    epb.timestamp_high = 0;
+    epb.captured_length = sizeof(struct fnet_trace_rec);
+    epb.packet_length = sizeof(struct fnet_trace_rec);
+    epb.length_trailer = sizeof(epb);
+
+    for(n = 0; fnet_trace_get(n, &epb.rec) == FNET_OK; n++)
+    {
+        epb.timestamp_low = epb.rec.timestamp;
+        write(cookie, &epb, sizeof(epb));
+    }
+
+    return FNET_OK;
+}
+
+#else /* FNET_CFG_TRACE */
+
+/************************************************************************
+* NAME: fnet_trace_get
+*
+* DESCRIPTION: The trace is disabled.
+*************************************************************************/
+int fnet_trace_get( unsigned long n, struct fnet_trace_rec *rec )
+{
+    FNET_COMP_UNUSED_ARG(n);
+    FNET_COMP_UNUSED_ARG(rec);
+
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fnet_trace_pcapng
+*
+* DESCRIPTION: The trace is disabled.
+*************************************************************************/
+int fnet_trace_pcapng( fnet_trace_write_t write, void *cookie )
+{
+    FNET_COMP_UNUSED_ARG(write);
+    FNET_COMP_UNUSED_ARG(cookie);
+
+    return FNET_ERR;
+}
+
+/************************************************************************
+* NAME: fnet_trace_set_mask
+*
+* DESCRIPTION: The trace is disabled.
+*************************************************************************/
+void fnet_trace_set_mask( unsigned long mask )
+{
+    FNET_COMP_UNUSED_ARG(mask);
+}
+
+/************************************************************************
+* NAME: fnet_trace_get_mask
+*
+* DESCRIPTION: The trace is disabled.
+*************************************************************************/
+unsigned long fnet_trace_get_mask( void )
+{
+    return 0;
+}
+
+/************************************************************************
+* NAME: fnet_trace_clear
+*
+* DESCRIPTION: The trace is disabled.
+*************************************************************************/
+void fnet_trace_clear( void )
+{
+}
+
+#endif /* FNET_CFG_TRACE */
@@ -0,0 +1,224 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_trace.h
+*
+* @author Andrey Butok
+*
+* @brief FNET binary trace API.
+*
+***************************************************************************/
+
+#ifndef _FNET_TRACE_H_
+
+#define _FNET_TRACE_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_trace
+* The Trace API gives access to a ring of compact binary records, 
+* written by the protocol layers on the packet reception, transmission, 
+* forwarding and discarding. @n
+* It is available only if @ref FNET_CFG_TRACE is set to @c 1. @n
+* A record takes a few stores and no locks, so the trace can stay 
+* enabled without perturbing the timing. The oldest records are overwritten.
+* The records are decoded later, on the target or offline, for example 
+* from a pcap-ng file written by the @ref fnet_trace_pcapng(). @n
+* The traced layers are selected at compile time by @ref FNET_CFG_TRACE_LAYERS
+* and at run time by @ref fnet_trace_set_mask().
+*/
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Traced layers.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_TRACE_LAYER_ETH = 0,   /**< @brief Ethernet. @n
+                                 * @c info is the frame type, 
+                                 * @c flow is the destination MAC address hash (Tx only).*/
+    FNET_TRACE_LAYER_ARP = 1,   /**< @brief ARP. @n
+                                 * @c info is the operation code, 
+                                 * @c seq and @c ack are the sender and target IPv4 addresses.*/
+    FNET_TRACE_LAYER_IP = 2,    /**< @brief IPv4. @n
+                                 * @c info is the protocol number, @c seq is the identification.*/
+    FNET_TRACE_LAYER_IP6 = 3,   /**< @brief IPv6. @n
+                                 * @c info is the next header.*/
+    FNET_TRACE_LAYER_ICMP = 4,  /**< @brief ICMPv4. @n
+                                 * @c info is the type and code, as (type << 8) | code.*/
+    FNET_TRACE_LAYER_ICMP6 = 5, /**< @brief ICMPv6. @n
+                                 * @c info is the type and code, as (type << 8) | code.*/
+    FNET_TRACE_LAYER_IGMP = 6,  /**< @brief IGMP. @n
+                                 * @c info is the message type.*/
+    FNET_TRACE_LAYER_UDP = 7,   /**< @brief UDP. @n
+                                 * @c seq and @c ack are the source and destination ports.*/
+    FNET_TRACE_LAYER_TCP = 8    /**< @brief TCP. @n
+                                 * @c seq and @c ack are the sequence and acknowledgment 
+                                 * numbers, @c info is the flags and window, as (flags << 16) | window.*/
+} fnet_trace_layer_t;
+
+/**************************************************************************/ /*!
+ * @brief Traced events.
+ ******************************************************************************/
+typedef enum
+{
+    FNET_TRACE_EVENT_RX = 0,    /**< @brief Received.*/
+    FNET_TRACE_EVENT_TX = 1,    /**< @brief Sent.*/
+    FNET_TRACE_EVENT_FW = 2,    /**< @brief Forwarded.*/
+    FNET_TRACE_EVENT_DROP = 3   /**< @brief Discarded.*/
+} fnet_trace_event_t;
+
+/**************************************************************************/ /*!
+ * @def FNET_TRACE_MASK
+ * @param layer Layer, defined by @ref fnet_trace_layer_t.
+ * @brief Mask bit of the layer, used by @ref FNET_CFG_TRACE_LAYERS 
+ * and @ref fnet_trace_set_mask().
+ * @showinitializer
+ ******************************************************************************/
+#define FNET_TRACE_MASK(layer)      (1UL << (layer))
+
+/**************************************************************************/ /*!
+ * @brief Trace record. 
+ *
+ * Its layout has no padding, so it is written as is to the pcap-ng file.
+ ******************************************************************************/
+struct fnet_trace_rec
+{
+    unsigned long   timestamp;  /**< @brief Time stamp, defined by @ref FNET_CFG_TRACE_TIMESTAMP.*/
+    unsigned char   layer;      /**< @brief Layer, defined by @ref fnet_trace_layer_t.*/
+    unsigned char   event;      /**< @brief Event, defined by @ref fnet_trace_event_t.*/
+    unsigned short  length;     /**< @brief Length of the layer data, in bytes.*/
+    unsigned long   flow;       /**< @brief Flow hash of the addresses and ports. @n
+                                 * It is the same for both directions of a flow.*/
+    unsigned long   seq;        /**< @brief Layer-specific, see @ref fnet_trace_layer_t.*/
+    unsigned long   ack;        /**< @brief Layer-specific, see @ref fnet_trace_layer_t.*/
+    unsigned long   info;       /**< @brief Layer-specific, see @ref fnet_trace_layer_t.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Output function of the @ref fnet_trace_pcapng().
+ *
+ * @param cookie  Cookie, passed to the @ref fnet_trace_pcapng().
+ * @param data    Pointer to the file data.
+ * @param size    Size of the data.
+ ******************************************************************************/
+typedef void(*fnet_trace_write_t)(void *cookie, const void *data, unsigned long size);
+
+/**************************************************************************/ /*!
+ * @brief pcap-ng link type of the trace records (LINKTYPE_USER0). 
+ ******************************************************************************/
+#define FNET_TRACE_PCAPNG_LINKTYPE  (147)
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Sets the run-time trace mask.
+ *
+ * @param mask  Mask of the traced layers, 
+ *              defined by @ref FNET_TRACE_MASK() of the @ref fnet_trace_layer_t values.@n
+ *              @c 0 stops the trace.
+ *
+ * @see fnet_trace_get_mask()
+ *
+ ******************************************************************************
+ *
+ * Layers missing in the @ref FNET_CFG_TRACE_LAYERS are not traced,
+ * whatever the run-time mask is. @n
+ * By default, all layers are traced.
+ *
+ ******************************************************************************/
+void fnet_trace_set_mask( unsigned long mask );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Returns the run-time trace mask.
+ *
+ * @return This function returns the mask of the traced layers.
+ *
+ * @see fnet_trace_set_mask()
+ *
+ ******************************************************************************/
+unsigned long fnet_trace_get_mask( void );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Removes all records from the trace ring.
+ *
+ ******************************************************************************/
+void fnet_trace_clear( void );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Retrieves a trace record.
+ *
+ * @param n     Index of the record, @c 0 is the oldest record in the ring.
+ *
+ * @param rec   Structure that receives the record.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if the record is copied.
+ *   - @ref FNET_ERR if there is no record @c n, or the trace is disabled 
+ *          by @ref FNET_CFG_TRACE.
+ *
+ ******************************************************************************
+ *
+ * The trace continues while the records are read, so the oldest 
+ * records may be overwritten meanwhile. To get a consistent snapshot, 
+ * stop the trace by @ref fnet_trace_set_mask() first.
+ *
+ ******************************************************************************/
+int fnet_trace_get( unsigned long n, struct fnet_trace_rec *rec );
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Writes the trace ring as a pcap-ng file.
+ *
+ * @param write   Output function.
+ *
+ * @param cookie  Cookie, passed to the @c write.
+ *
+ * @return This function returns:
+ *   - @ref FNET_OK if no error occurs.
+ *   - @ref FNET_ERR if the trace is disabled by @ref FNET_CFG_TRACE.
+ *
+ ******************************************************************************
+ *
+ * The file has one interface of the @ref FNET_TRACE_PCAPNG_LINKTYPE type,
+ * and one packet per record, containing the @ref fnet_trace_rec structure
+ * in the byte order of the target. @n
+ * The time stamp resolution is set by @ref FNET_CFG_TRACE_TIMESTAMP_RES.
+ *
+ ******************************************************************************/
+int fnet_trace_pcapng( fnet_trace_write_t write, void *cookie );
+
+/*! @} */
+
+#endif /* _FNET_TRACE_H_ */
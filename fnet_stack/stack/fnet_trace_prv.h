@@ -0,0 +1,79 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_trace_prv.h
+*
+* @author Andrey Butok
+*
+* @brief Private. FNET binary trace.
+*
+***************************************************************************/
+
+#ifndef _FNET_TRACE_PRV_H_
+
+#define _FNET_TRACE_PRV_H_
+
+#include "fnet_config.h"
+#include "fnet_trace.h"
+#include "fnet_socket.h"
+
+#if FNET_CFG_TRACE
+
+/************************************************************************
+*     Global Data Structures
+*************************************************************************/
+extern unsigned long fnet_trace_mask;
+
+/* It is true if the layer is traced. 
+ * It is the constant false for the layers out of FNET_CFG_TRACE_LAYERS.*/
+#define FNET_TRACE_ON(layer)    ((FNET_TRACE_MASK(layer) & FNET_CFG_TRACE_LAYERS & fnet_trace_mask) != 0)
+
+/* Writes a trace record. The arguments are evaluated only if the layer is traced.*/
+#define FNET_TRACE(layer, event, flow, seq, ack, info, length) \
+    (FNET_TRACE_ON(layer) ? fnet_trace_record((layer), (event), (flow), (seq), (ack), (info), (length)) : (void)0)
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+void fnet_trace_record( fnet_trace_layer_t layer, fnet_trace_event_t event, unsigned long flow, 
+                        unsigned long seq, unsigned long ack, unsigned long info, unsigned long length );
+unsigned long fnet_trace_hash( const void *data, unsigned int size );
+unsigned long fnet_trace_flow( const struct sockaddr *addr1, const struct sockaddr *addr2 );
+
+#else
+
+#define FNET_TRACE_ON(layer)    (0)
+#define FNET_TRACE(layer, event, flow, seq, ack, info, length)  ((void)0)
+
+#endif /* FNET_CFG_TRACE */
+
+#endif /* _FNET_TRACE_PRV_H_ */
@@ -0,0 +1,1040 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_ubench.c
+*
+* @author Andrey Butok
+*
+* @brief FNET micro-benchmarks.
+*
+***************************************************************************/
+
+#include "fnet.h"
+
+#if FNET_CFG_UBENCH
+
+#include "fnet_checksum.h"
+#include "fnet_mempool.h"
+#include "fnet_socket_prv.h"
+#include "fnet_udp.h"
+#include "fnet_tcp.h"
+#include "fnet_arp.h"
+#include "fnet_nd6.h"
+#include "fnet_timer_prv.h"
+#include "fnet_isr.h"
+#include "fnet_os.h"
+
+/************************************************************************
+*     Definitions
+*************************************************************************/
+#define FNET_UBENCH_ITERATIONS_DEFAULT  (1000)
+#define FNET_UBENCH_N_DEFAULT           (8)
+#define FNET_UBENCH_SIZE_DEFAULT        (1460)
+#define FNET_UBENCH_SIZE_MIN            (64)
+#define FNET_UBENCH_CALIBRATE           (16)        /* Number of the counter overhead measurements.*/
+#define FNET_UBENCH_PORT                (49152)     /* Port of the first benchmark socket.*/
+#define FNET_UBENCH_MEMPOOL_BLOCK       (32)        /* Size of the fragmenting memory blocks.*/
+
+#if FNET_CFG_IP4
+    #define FNET_UBENCH_AF              AF_INET
+#else
+    #define FNET_UBENCH_AF              AF_INET6
+#endif
+
+#define FNET_UBENCH_START(m)            ((m)->stamp = FNET_CFG_LATENCY_CYCLES())
+#define FNET_UBENCH_STOP(m)             fnet_ubench_stop((m), FNET_CFG_LATENCY_CYCLES())
+
+/* Measurement of one operation.*/
+typedef struct
+{
+    struct fnet_ubench_result   result;
+    unsigned long               total;  /* Sum of the measured cycles.*/
+    unsigned long               stamp;  /* Start of the current measurement.*/
+} fnet_ubench_measure_t;
+
+/* Benchmark run.*/
+typedef struct
+{
+    struct fnet_ubench_params   params;
+    fnet_ubench_handler_t       handler;
+    void                        *cookie;
+    int                         results;    /* Number of the passed results.*/
+} fnet_ubench_run_t;
+
+/* Benchmark.*/
+typedef struct
+{
+    const char  *name;
+    void        (*run)( fnet_ubench_run_t *run );
+} fnet_ubench_t;
+
+/************************************************************************
+*     Function Prototypes
+*************************************************************************/
+static void fnet_ubench_calibrate( void );
+static void fnet_ubench_begin( fnet_ubench_measure_t *m, const char *name, const char *variant, unsigned long n );
+static void fnet_ubench_stop( fnet_ubench_measure_t *m, unsigned long stamp );
+static void fnet_ubench_end( fnet_ubench_run_t *run, fnet_ubench_measure_t *m );
+static void fnet_ubench_lock( void );
+static void fnet_ubench_unlock( void );
+static fnet_netbuf_t *fnet_ubench_chain( char *buf, unsigned long size );
+static unsigned long fnet_ubench_sockets_open( SOCKET *sockets, unsigned long n, fnet_socket_type_t type );
+static void fnet_ubench_sockets_close( SOCKET *sockets, unsigned long n );
+static void fnet_ubench_timer_handler( void *cookie );
+static void fnet_ubench_checksum( fnet_ubench_run_t *run );
+static void fnet_ubench_netbuf( fnet_ubench_run_t *run );
+static void fnet_ubench_mempool( fnet_ubench_run_t *run );
+static void fnet_ubench_socket( fnet_ubench_run_t *run );
+#if FNET_CFG_IP4 && (FNET_CFG_CPU_ETH0 || FNET_CFG_CPU_ETH1)
+static void fnet_ubench_arp( fnet_ubench_run_t *run );
+#endif
+#if FNET_CFG_IP6
+static void fnet_ubench_nd6( fnet_ubench_run_t *run );
+#endif
+static void fnet_ubench_timer( fnet_ubench_run_t *run );
+static void fnet_ubench_memcpy( fnet_ubench_run_t *run );
+static void fnet_ubench_memset( fnet_ubench_run_t *run );
+
+/************************************************************************
+*     Variables
+*************************************************************************/
+static const fnet_ubench_t fnet_ubench_table[] =
+{
+    {"checksum", fnet_ubench_checksum},
+    {"netbuf", fnet_ubench_netbuf},
+    {"mempool", fnet_ubench_mempool},
+    {"socket", fnet_ubench_socket},
+#if FNET_CFG_IP4 && (FNET_CFG_CPU_ETH0 || FNET_CFG_CPU_ETH1)
+    {"arp", fnet_ubench_arp},
+#endif
+#if FNET_CFG_IP6
+    {"nd6", fnet_ubench_nd6},
+#endif
+    {"timer", fnet_ubench_timer},
+    {"memcpy", fnet_ubench_memcpy},
+    {"memset", fnet_ubench_memset}
+};
+
+#define FNET_UBENCH_TABLE_SIZE  (sizeof(fnet_ubench_table)/sizeof(fnet_ubench_t))
+
+static unsigned long fnet_ubench_overhead;  /* Cycles of an empty measurement.*/
+
+/************************************************************************
+* NAME: fnet_ubench_run
+*
+* DESCRIPTION: Runs the named benchmark, or all of them.
+*************************************************************************/
+int fnet_ubench_run( const char *name, const struct fnet_ubench_params *params, fnet_ubench_handler_t handler, void *cookie )
+{
+    fnet_ubench_run_t   run;
+    unsigned int        i;
+    int                 found = FNET_FALSE;
+
+    if(handler == 0)
+        return FNET_ERR;
+
+    fnet_memset_zero(&run, sizeof(run));
+
+    if(params)
+        run.params = *params;
+
+    if(run.params.iterations == 0)
+        run.params.iterations = FNET_UBENCH_ITERATIONS_DEFAULT;
+    else if(run.params.iterations > FNET_UBENCH_ITERATIONS_MAX)
+        run.params.iterations = FNET_UBENCH_ITERATIONS_MAX;
+
+    if(run.params.n == 0)
+        run.params.n = FNET_UBENCH_N_DEFAULT;
+
+    if(run.params.size == 0)
+        run.params.size = FNET_UBENCH_SIZE_DEFAULT;
+    else if(run.params.size < FNET_UBENCH_SIZE_MIN)
+        run.params.size = FNET_UBENCH_SIZE_MIN;
+
+    run.handler = handler;
+    run.cookie = cookie;
+
+    FNET_CFG_LATENCY_CYCLES_INIT();
+    fnet_ubench_calibrate();
+
+    for(i = 0; i < FNET_UBENCH_TABLE_SIZE; i++)
+    {
+        if((name == 0) || (fnet_strcmp(name, fnet_ubench_table[i].name) == 0))
+        {
+            found = FNET_TRUE;
+            fnet_ubench_table[i].run(&run);
+        }
+    }
+
+    return (found ? run.results : FNET_ERR);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_calibrate
+*
+* DESCRIPTION: Measures the overhead of an empty measurement.
+*************************************************************************/
+static void fnet_ubench_calibrate( void )
+{
+    fnet_ubench_measure_t   m;
+    int                     i;
+
+    fnet_ubench_overhead = 0;
+    fnet_ubench_begin(&m, "", "", 0);
+
+    fnet_ubench_lock();
+
+    for(i = 0; i < FNET_UBENCH_CALIBRATE; i++)
+    {
+        FNET_UBENCH_START(&m);
+        FNET_UBENCH_STOP(&m);
+    }
+
+    fnet_ubench_unlock();
+
+    fnet_ubench_overhead = m.result.min;
+}
+
+/************************************************************************
+* NAME: fnet_ubench_begin
+*
+* DESCRIPTION: Starts the measurement of an operation.
+*************************************************************************/
+static void fnet_ubench_begin( fnet_ubench_measure_t *m, const char *name, const char *variant, unsigned long n )
+{
+    fnet_memset_zero(m, sizeof(*m));
+
+    m->result.name = name;
+    m->result.variant = variant;
+    m->result.n = n;
+    m->result.min = (unsigned long)(-1);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_stop
+*
+* DESCRIPTION: Adds one operation, which ended at the stamp.
+*************************************************************************/
+static void fnet_ubench_stop( fnet_ubench_measure_t *m, unsigned long stamp )
+{
+    unsigned long cycles = stamp - m->stamp;
+
+    if(cycles > fnet_ubench_overhead)
+        cycles -= fnet_ubench_overhead;
+    else
+        cycles = 0;
+
+    if(cycles < m->result.min)
+        m->result.min = cycles;
+
+    if(cycles > m->result.max)
+        m->result.max = cycles;
+
+    m->total += cycles;
+    m->result.iterations++;
+}
+
+/************************************************************************
+* NAME: fnet_ubench_end
+*
+* DESCRIPTION: Passes the result of the measured operation. 
+*              The stack must not be locked.
+*************************************************************************/
+static void fnet_ubench_end( fnet_ubench_run_t *run, fnet_ubench_measure_t *m )
+{
+    if(m->result.iterations)
+    {
+        m->result.avg = m->total / m->result.iterations;
+
+        run->handler(&m->result, run->cookie);
+        run->results++;
+    }
+}
+
+/************************************************************************
+* NAME: fnet_ubench_lock
+*
+* DESCRIPTION: Locks the stack, as its API functions do.
+*************************************************************************/
+static void fnet_ubench_lock( void )
+{
+    fnet_os_mutex_lock();
+    fnet_isr_lock();
+}
+
+/************************************************************************
+* NAME: fnet_ubench_unlock
+*
+* DESCRIPTION: Unlocks the stack.
+*************************************************************************/
+static void fnet_ubench_unlock( void )
+{
+    fnet_isr_unlock();
+    fnet_os_mutex_unlock();
+}
+
+/************************************************************************
+* NAME: fnet_ubench_chain
+*
+* DESCRIPTION: Copies the buffer to a chain of three net_bufs. 
+*              The fragments have odd lengths, so the two-byte words 
+*              of the checksum cross their boundaries.
+*************************************************************************/
+static fnet_netbuf_t *fnet_ubench_chain( char *buf, unsigned long size )
+{
+    unsigned long   frag = (size / 3) | 1;
+    fnet_netbuf_t   *nb;
+    fnet_netbuf_t   *nb_next;
+    fnet_netbuf_t   *nb_last;
+
+    nb = fnet_netbuf_from_buf(buf, (int)frag, FNET_FALSE);
+    nb_next = fnet_netbuf_from_buf(buf + frag, (int)frag, FNET_FALSE);
+    nb_last = fnet_netbuf_from_buf(buf + 2 * frag, (int)(size - 2 * frag), FNET_FALSE);
+
+    if(nb && nb_next && nb_last)
+    {
+        nb = fnet_netbuf_concat(nb, nb_next);
+        nb = fnet_netbuf_concat(nb, nb_last);
+    }
+    else
+    {
+        if(nb)
+            fnet_netbuf_free_chain(nb);
+        if(nb_next)
+            fnet_netbuf_free_chain(nb_next);
+        if(nb_last)
+            fnet_netbuf_free_chain(nb_last);
+
+        nb = 0;
+    }
+
+    return nb;
+}
+
+/************************************************************************
+* NAME: fnet_ubench_checksum
+*
+* DESCRIPTION: Internet checksum over an aligned, an unaligned 
+*              and a chained buffer.
+*************************************************************************/
+static void fnet_ubench_checksum( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m;
+    unsigned long           size = run->params.size;
+    unsigned long           i;
+    char                    *buf;
+    fnet_netbuf_t           *nb;
+
+    if((buf = fnet_malloc(size + 1)) == 0) /* One more byte, for the unaligned buffer.*/
+        return;
+
+    fnet_memset(buf, 0xA5, size + 1);
+
+    /* Aligned buffer.*/
+    fnet_ubench_begin(&m, "checksum", "aligned", size);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m);
+        (void)fnet_checksum_buf(buf, (int)size);
+        FNET_UBENCH_STOP(&m);
+    }
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m);
+
+    /* Unaligned buffer.*/
+    fnet_ubench_begin(&m, "checksum", "unaligned", size);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m);
+        (void)fnet_checksum_buf(buf + 1, (int)size);
+        FNET_UBENCH_STOP(&m);
+    }
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m);
+
+    /* Chained buffer.*/
+    if((nb = fnet_ubench_chain(buf, size)) != 0)
+    {
+        fnet_ubench_begin(&m, "checksum", "chain", size);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            (void)fnet_checksum(nb, (int)size);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+
+        fnet_netbuf_free_chain(nb);
+    }
+
+    fnet_free(buf);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_netbuf
+*
+* DESCRIPTION: net_buf allocation, release, copy, pull-up, trimming 
+*              and cutting. The changed chains are rebuilt, 
+*              outside of the measurement.
+*************************************************************************/
+static void fnet_ubench_netbuf( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m_new;
+    fnet_ubench_measure_t   m_free;
+    fnet_ubench_measure_t   m;
+    unsigned long           size = run->params.size;
+    unsigned long           frag = (size / 3) | 1; /* First fragment of the chain.*/
+    unsigned long           i;
+    char                    *buf;
+    fnet_netbuf_t           *nb;
+    fnet_netbuf_t           *nb_copy;
+
+    if((buf = fnet_malloc(size)) == 0)
+        return;
+
+    fnet_memset(buf, 0xA5, size);
+
+    /* Allocation and release.*/
+    fnet_ubench_begin(&m_new, "netbuf", "new", size);
+    fnet_ubench_begin(&m_free, "netbuf", "free", size);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m_new);
+        nb = fnet_netbuf_new((int)size, FNET_FALSE);
+        FNET_UBENCH_STOP(&m_new);
+
+        if(nb == 0)
+            break;
+
+        FNET_UBENCH_START(&m_free);
+        fnet_netbuf_free_chain(nb);
+        FNET_UBENCH_STOP(&m_free);
+    }
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m_new);
+    fnet_ubench_end(run, &m_free);
+
+    /* Copy of the chain. The data buffers are referenced.*/
+    if((nb = fnet_ubench_chain(buf, size)) != 0)
+    {
+        fnet_ubench_begin(&m, "netbuf", "copy", size);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            nb_copy = fnet_netbuf_copy(nb, 0, FNET_NETBUF_COPYALL, FNET_FALSE);
+            FNET_UBENCH_STOP(&m);
+
+            if(nb_copy == 0)
+                break;
+
+            fnet_netbuf_free_chain(nb_copy);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+
+        fnet_netbuf_free_chain(nb);
+    }
+
+    /* Pull-up of a header, crossing the first fragment.*/
+    fnet_ubench_begin(&m, "netbuf", "pullup", size);
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        if((nb = fnet_ubench_chain(buf, size)) == 0)
+            break;
+
+        fnet_ubench_lock();
+        FNET_UBENCH_START(&m);
+        nb_copy = fnet_netbuf_pullup(nb, (int)frag + 20);
+        FNET_UBENCH_STOP(&m);
+        fnet_ubench_unlock();
+
+        fnet_netbuf_free_chain(nb_copy ? nb_copy : nb);
+    }
+
+    fnet_ubench_end(run, &m);
+
+    /* Trimming of the first fragment and one byte more.*/
+    fnet_ubench_begin(&m, "netbuf", "trim", size);
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        if((nb = fnet_ubench_chain(buf, size)) == 0)
+            break;
+
+        fnet_ubench_lock();
+        FNET_UBENCH_START(&m);
+        fnet_netbuf_trim(&nb, (int)frag + 1);
+        FNET_UBENCH_STOP(&m);
+        fnet_ubench_unlock();
+
+        if(nb)
+            fnet_netbuf_free_chain(nb);
+    }
+
+    fnet_ubench_end(run, &m);
+
+    /* Cutting from the middle of the first fragment into the second one.*/
+    fnet_ubench_begin(&m, "netbuf", "cut_center", size);
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        if((nb = fnet_ubench_chain(buf, size)) == 0)
+            break;
+
+        fnet_ubench_lock();
+        FNET_UBENCH_START(&m);
+        (void)fnet_netbuf_cut_center(&nb, (int)(frag / 2), (int)frag);
+        FNET_UBENCH_STOP(&m);
+        fnet_ubench_unlock();
+
+        if(nb)
+            fnet_netbuf_free_chain(nb);
+    }
+
+    fnet_ubench_end(run, &m);
+
+    fnet_free(buf);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_mempool
+*
+* DESCRIPTION: Memory pool allocation and release. The free list of 
+*              a private pool has n fragments, too small for the 
+*              allocated block, in front of the free space.
+*************************************************************************/
+static void fnet_ubench_mempool( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m_malloc;
+    fnet_ubench_measure_t   m_free;
+    unsigned long           pool_size = (2 * run->params.n + 8) * (2 * FNET_UBENCH_MEMPOOL_BLOCK);
+    unsigned long           fragments = 0;
+    unsigned long           i;
+    void                    *pool_ptr;
+    fnet_mempool_desc_t     pool;
+    void                    *block;
+    void                    *prev = 0;
+
+    if((pool_ptr = fnet_malloc(pool_size)) == 0)
+        return;
+
+    if((pool = fnet_mempool_init(pool_ptr, pool_size, FNET_MEMPOOL_ALIGN_8)) != 0)
+    {
+        /* Fragment the free list. Every other block is released, 
+         * so the free blocks are not merged.*/
+        for(i = 0; i < 2 * run->params.n; i++)
+        {
+            if((block = fnet_mempool_malloc(pool, FNET_UBENCH_MEMPOOL_BLOCK)) == 0)
+                break;
+
+            if(i & 1)
+            {
+                fnet_mempool_free(pool, prev);
+                fragments++;
+            }
+
+            prev = block;
+        }
+
+        fnet_ubench_begin(&m_malloc, "mempool", "malloc", fragments);
+        fnet_ubench_begin(&m_free, "mempool", "free", fragments);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m_malloc);
+            block = fnet_mempool_malloc(pool, 2 * FNET_UBENCH_MEMPOOL_BLOCK);
+            FNET_UBENCH_STOP(&m_malloc);
+
+            if(block == 0)
+                break;
+
+            FNET_UBENCH_START(&m_free);
+            fnet_mempool_free(pool, block);
+            FNET_UBENCH_STOP(&m_free);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m_malloc);
+        fnet_ubench_end(run, &m_free);
+
+        fnet_mempool_release(pool);
+    }
+
+    fnet_free(pool_ptr);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_sockets_open
+*
+* DESCRIPTION: Opens up to n sockets, bound to the successive ports.
+*              The stream sockets are listening.
+*
+* RETURNS: Number of the opened sockets.
+*************************************************************************/
+static unsigned long fnet_ubench_sockets_open( SOCKET *sockets, unsigned long n, fnet_socket_type_t type )
+{
+    struct sockaddr addr;
+    unsigned long   i;
+
+    if(n > FNET_CFG_SOCKET_MAX)
+        n = FNET_CFG_SOCKET_MAX;
+
+    fnet_memset_zero(&addr, sizeof(addr));
+    addr.sa_family = FNET_UBENCH_AF;
+
+    for(i = 0; i < n; i++)
+    {
+        if((sockets[i] = socket(FNET_UBENCH_AF, type, 0)) == SOCKET_INVALID)
+            break;
+
+        addr.sa_port = fnet_htons((unsigned short)(FNET_UBENCH_PORT + i));
+
+        if((bind(sockets[i], &addr, sizeof(addr)) == SOCKET_ERROR)
+            || ((type == SOCK_STREAM) && (listen(sockets[i], 1) == SOCKET_ERROR)))
+        {
+            closesocket(sockets[i]);
+            break;
+        }
+    }
+
+    return i;
+}
+
+/************************************************************************
+* NAME: fnet_ubench_sockets_close
+*
+* DESCRIPTION: Closes the opened sockets.
+*************************************************************************/
+static void fnet_ubench_sockets_close( SOCKET *sockets, unsigned long n )
+{
+    unsigned long i;
+
+    for(i = 0; i < n; i++)
+        closesocket(sockets[i]);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_socket
+*
+* DESCRIPTION: UDP socket lookup and TCP socket search, with n sockets.
+*              The first opened socket is searched, 
+*              it is the last one in the list.
+*************************************************************************/
+static void fnet_ubench_socket( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m;
+    SOCKET                  sockets[FNET_CFG_SOCKET_MAX];
+    struct sockaddr         local_addr;
+    struct sockaddr         foreign_addr;
+    unsigned long           n;
+    unsigned long           i;
+
+    fnet_memset_zero(&local_addr, sizeof(local_addr));
+    local_addr.sa_family = FNET_UBENCH_AF;
+    local_addr.sa_port = fnet_htons(FNET_UBENCH_PORT);
+
+    fnet_memset_zero(&foreign_addr, sizeof(foreign_addr));
+    foreign_addr.sa_family = FNET_UBENCH_AF;
+    foreign_addr.sa_port = fnet_htons(FNET_UBENCH_PORT - 1);
+    foreign_addr.sa_data[sizeof(foreign_addr.sa_data) - 1] = 1; /* Not unspecified.*/
+
+#if FNET_CFG_UDP
+    if((n = fnet_ubench_sockets_open(sockets, run->params.n, SOCK_DGRAM)) != 0)
+    {
+        fnet_ubench_begin(&m, "socket", "udp_lookup", n);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            (void)fnet_socket_lookup(fnet_udp_prot_if.head, &local_addr, &foreign_addr, FNET_IP_PROTOCOL_UDP);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+    }
+
+    fnet_ubench_sockets_close(sockets, n);
+#endif
+
+#if FNET_CFG_TCP
+    if((n = fnet_ubench_sockets_open(sockets, run->params.n, SOCK_STREAM)) != 0)
+    {
+        fnet_ubench_begin(&m, "socket", "tcp_findsk", n);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            (void)fnet_tcp_findsk(&foreign_addr, &local_addr);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+    }
+
+    fnet_ubench_sockets_close(sockets, n);
+#endif
+}
+
+#if FNET_CFG_IP4 && (FNET_CFG_CPU_ETH0 || FNET_CFG_CPU_ETH1)
+/************************************************************************
+* NAME: fnet_ubench_arp
+*
+* DESCRIPTION: ARP cache lookup, with n static entries 
+*              of the benchmarking range 198.18.0.0/15 (RFC2544).
+*************************************************************************/
+static void fnet_ubench_arp( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m;
+    fnet_netif_t            *netif = (fnet_netif_t *)fnet_netif_get_default();
+    fnet_mac_addr_t         mac_addr = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00}; /* Locally administered.*/
+    unsigned long           n = 0;
+    unsigned long           i;
+
+    if((netif == 0) || (netif->api->type != FNET_NETIF_TYPE_ETHERNET))
+        return;
+
+    fnet_ubench_lock();
+
+    while((n < run->params.n) && (n < FNET_CFG_ARP_TABLE_SIZE))
+    {
+        mac_addr[5] = (unsigned char)(n + 1);
+
+        if(fnet_arp_add_static(netif, FNET_IP4_ADDR_INIT(198, 18, 0, n + 1), mac_addr) == FNET_ERR)
+            break;
+
+        n++;
+    }
+
+    fnet_ubench_unlock();
+
+    if(n)
+    {
+        fnet_ubench_begin(&m, "arp", "lookup", n);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            (void)fnet_arp_lookup(netif, FNET_IP4_ADDR_INIT(198, 18, 0, 1));
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+    }
+
+    fnet_ubench_lock();
+
+    for(i = 0; i < n; i++)
+        (void)fnet_arp_del(netif, FNET_IP4_ADDR_INIT(198, 18, 0, i + 1));
+
+    fnet_ubench_unlock();
+}
+#endif /* FNET_CFG_IP4 && (FNET_CFG_CPU_ETH0 || FNET_CFG_CPU_ETH1) */
+
+#if FNET_CFG_IP6
+/************************************************************************
+* NAME: fnet_ubench_nd6
+*
+* DESCRIPTION: Neighbor Cache lookup, with n entries 
+*              of the benchmarking range 2001:2::/48 (RFC5180).
+*************************************************************************/
+static void fnet_ubench_nd6( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t       m;
+    fnet_netif_t                *netif = (fnet_netif_t *)fnet_netif_get_default();
+    fnet_ip6_addr_t             ip_addr;
+    fnet_nd6_ll_addr_t          ll_addr;
+    fnet_nd6_neighbor_entry_t   *entry;
+    unsigned long               n = 0;
+    unsigned long               i;
+
+    if((netif == 0) || (netif->nd6_if_ptr == 0))
+        return;
+
+    fnet_memset_zero(&ip_addr, sizeof(ip_addr));
+    ip_addr.addr[0] = 0x20;
+    ip_addr.addr[1] = 0x01;
+    ip_addr.addr[3] = 0x02;
+
+    fnet_memset_zero(ll_addr, sizeof(ll_addr));
+    ll_addr[0] = 0x02; /* Locally administered.*/
+
+    fnet_ubench_lock();
+
+    while((n < run->params.n) && (n < FNET_CFG_ND6_NEIGHBOR_CACHE_SIZE))
+    {
+        ip_addr.addr[15] = (unsigned char)(n + 1);
+        ll_addr[5] = (unsigned char)(n + 1);
+
+        if(fnet_nd6_neighbor_cache_add(netif, &ip_addr, ll_addr, FNET_ND6_NEIGHBOR_STATE_STALE) == 0)
+            break;
+
+        n++;
+    }
+
+    fnet_ubench_unlock();
+
+    if(n)
+    {
+        ip_addr.addr[15] = 1;
+
+        fnet_ubench_begin(&m, "nd6", "cache_get", n);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            (void)fnet_nd6_neighbor_cache_get(netif, &ip_addr);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+    }
+
+    fnet_ubench_lock();
+
+    for(i = 0; i < n; i++)
+    {
+        ip_addr.addr[15] = (unsigned char)(i + 1);
+
+        if((entry = fnet_nd6_neighbor_cache_get(netif, &ip_addr)) != 0)
+            fnet_nd6_neighbor_cache_del(netif, entry);
+    }
+
+    fnet_ubench_unlock();
+}
+#endif /* FNET_CFG_IP6 */
+
+/************************************************************************
+* NAME: fnet_ubench_timer_handler
+*
+* DESCRIPTION: Handler of the benchmark timers. They never expire.
+*************************************************************************/
+static void fnet_ubench_timer_handler( void *cookie )
+{
+    FNET_COMP_UNUSED_ARG(cookie);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_timer
+*
+* DESCRIPTION: Timer creation and release, with n running timers.
+*************************************************************************/
+static void fnet_ubench_timer( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m_new;
+    fnet_ubench_measure_t   m_free;
+    fnet_timer_desc_t       *timers;
+    fnet_timer_desc_t       timer;
+    unsigned long           n;
+    unsigned long           i;
+
+    if((timers = fnet_malloc(run->params.n * sizeof(fnet_timer_desc_t))) == 0)
+        return;
+
+    fnet_ubench_lock();
+
+    for(n = 0; n < run->params.n; n++)
+    {
+        if((timers[n] = fnet_timer_new(FNET_TIMER_TICK_IN_HOUR, fnet_ubench_timer_handler, 0)) == 0)
+            break;
+    }
+
+    fnet_ubench_unlock();
+
+    fnet_ubench_begin(&m_new, "timer", "new", n);
+    fnet_ubench_begin(&m_free, "timer", "free", n);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m_new);
+        timer = fnet_timer_new(FNET_TIMER_TICK_IN_HOUR, fnet_ubench_timer_handler, 0);
+        FNET_UBENCH_STOP(&m_new);
+
+        if(timer == 0)
+            break;
+
+        FNET_UBENCH_START(&m_free);
+        fnet_timer_free(timer);
+        FNET_UBENCH_STOP(&m_free);
+    }
+
+    for(i = 0; i < n; i++)
+        fnet_timer_free(timers[i]);
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m_new);
+    fnet_ubench_end(run, &m_free);
+
+    fnet_free(timers);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_memcpy
+*
+* DESCRIPTION: fnet_memcpy() between aligned and unaligned buffers.
+*************************************************************************/
+static void fnet_ubench_memcpy( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m;
+    unsigned long           size = run->params.size;
+    unsigned long           i;
+    char                    *src;
+    char                    *dest;
+
+    src = fnet_malloc(size + 1);
+    dest = fnet_malloc(size + 1);
+
+    if(src && dest)
+    {
+        fnet_memset(src, 0xA5, size + 1);
+
+        fnet_ubench_begin(&m, "memcpy", "aligned", size);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            fnet_memcpy(dest, src, (unsigned)size);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+
+        fnet_ubench_begin(&m, "memcpy", "unaligned", size);
+        fnet_ubench_lock();
+
+        for(i = 0; i < run->params.iterations; i++)
+        {
+            FNET_UBENCH_START(&m);
+            fnet_memcpy(dest, src + 1, (unsigned)size);
+            FNET_UBENCH_STOP(&m);
+        }
+
+        fnet_ubench_unlock();
+        fnet_ubench_end(run, &m);
+    }
+
+    if(src)
+        fnet_free(src);
+    if(dest)
+        fnet_free(dest);
+}
+
+/************************************************************************
+* NAME: fnet_ubench_memset
+*
+* DESCRIPTION: fnet_memset() of an aligned and an unaligned buffer.
+*************************************************************************/
+static void fnet_ubench_memset( fnet_ubench_run_t *run )
+{
+    fnet_ubench_measure_t   m;
+    unsigned long           size = run->params.size;
+    unsigned long           i;
+    char                    *buf;
+
+    if((buf = fnet_malloc(size + 1)) == 0)
+        return;
+
+    fnet_ubench_begin(&m, "memset", "aligned", size);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m);
+        fnet_memset(buf, 0xA5, (unsigned)size);
+        FNET_UBENCH_STOP(&m);
+    }
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m);
+
+    fnet_ubench_begin(&m, "memset", "unaligned", size);
+    fnet_ubench_lock();
+
+    for(i = 0; i < run->params.iterations; i++)
+    {
+        FNET_UBENCH_START(&m);
+        fnet_memset(buf + 1, 0xA5, (unsigned)size);
+        FNET_UBENCH_STOP(&m);
+    }
+
+    fnet_ubench_unlock();
+    fnet_ubench_end(run, &m);
+
+    fnet_free(buf);
+}
+
+#else /* FNET_CFG_UBENCH */
+
+/************************************************************************
+* NAME: fnet_ubench_run
+*
+* DESCRIPTION: The benchmarks are disabled.
+*************************************************************************/
+int fnet_ubench_run( const char *name, const struct fnet_ubench_params *params, fnet_ubench_handler_t handler, void *cookie )
+{
+    FNET_COMP_UNUSED_ARG(name);
+    FNET_COMP_UNUSED_ARG(params);
+    FNET_COMP_UNUSED_ARG(handler);
+    FNET_COMP_UNUSED_ARG(cookie);
+
+    return FNET_ERR;
+}
+
+#endif /* FNET_CFG_UBENCH */
@@ -0,0 +1,156 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fnet_ubench.h
+*
+* @author Andrey Butok
+*
+* @brief FNET micro-benchmarks API.
+*
+***************************************************************************/
+
+#ifndef _FNET_UBENCH_H_
+
+#define _FNET_UBENCH_H_
+
+#include "fnet_config.h"
+
+/*! @addtogroup fnet_ubench
+* The Micro-benchmark API measures the core primitives of the stack, 
+* the ones all packet processing depends on:
+*   - @c checksum - the Internet checksum over an aligned, 
+*     an unaligned and a chained buffer.
+*   - @c netbuf - net_buf allocation, release, copy, pull-up, 
+*     trimming and cutting.
+*   - @c mempool - memory pool allocation and release, 
+*     with a fragmented free list.
+*   - @c socket - the UDP socket lookup and the TCP socket search, 
+*     with @c n open sockets.
+*   - @c arp and @c nd6 - the ARP cache and the Neighbor Cache lookup, 
+*     with @c n entries.
+*   - @c timer - timer creation and release, with @c n running timers.
+*   - @c memcpy and @c memset - over an aligned and an unaligned buffer.
+*
+* It is available only if @ref FNET_CFG_UBENCH is set to @c 1. @n
+* Every operation is measured separately by @ref FNET_CFG_LATENCY_CYCLES, 
+* with the stack locked, and the counter overhead is subtracted. 
+* The minimum is the repeatable figure, the maximum includes 
+* the interrupts. @n
+* The @c arp and @c nd6 benchmarks add their entries to the caches of 
+* the default interface, so they may replace the entries in use.
+* They are deleted afterwards.
+*/
+
+/*! @{ */
+
+/**************************************************************************/ /*!
+ * @brief Maximum number of the iterations of one benchmark.
+ ******************************************************************************/
+#define FNET_UBENCH_ITERATIONS_MAX      (10000)
+
+/**************************************************************************/ /*!
+ * @brief Benchmark parameters. 
+ * The zero fields are replaced by their default values.
+ ******************************************************************************/
+struct fnet_ubench_params
+{
+    unsigned long   iterations; /**< @brief Number of the measured operations, 
+                                 * up to @ref FNET_UBENCH_ITERATIONS_MAX. @n
+                                 * Default is @c 1000.*/
+    unsigned long   n;          /**< @brief Number of the sockets, cache entries, 
+                                 * timers or free fragments. @n 
+                                 * Default is @c 8.*/
+    unsigned long   size;       /**< @brief Buffer size in bytes. @n
+                                 * Default is @c 1460.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Benchmark result, passed to the @ref fnet_ubench_handler_t.
+ ******************************************************************************/
+struct fnet_ubench_result
+{
+    const char      *name;      /**< @brief Benchmark name, e.g. "checksum".*/
+    const char      *variant;   /**< @brief Measured variant or operation, e.g. "unaligned".*/
+    unsigned long   n;          /**< @brief Actual number of the sockets, entries, 
+                                 * timers or fragments. @n
+                                 * It is the buffer size for the benchmarks 
+                                 * without the @c n parameter.*/
+    unsigned long   iterations; /**< @brief Number of the measured operations.*/
+    unsigned long   min;        /**< @brief Fastest operation, in the @ref FNET_CFG_LATENCY_CYCLES counts.*/
+    unsigned long   avg;        /**< @brief Average operation, in the @ref FNET_CFG_LATENCY_CYCLES counts.*/
+    unsigned long   max;        /**< @brief Slowest operation, in the @ref FNET_CFG_LATENCY_CYCLES counts.*/
+};
+
+/**************************************************************************/ /*!
+ * @brief Benchmark result handler.
+ *
+ * @param result  Benchmark result.
+ *
+ * @param cookie  User-application specific parameter. 
+ *                It is set by the @ref fnet_ubench_run().
+ *
+ * It is called for every measured operation, 
+ * when the stack is not locked.
+ ******************************************************************************/
+typedef void(*fnet_ubench_handler_t)(const struct fnet_ubench_result *result, void *cookie);
+
+/***************************************************************************/ /*!
+ *
+ * @brief    Runs the micro-benchmarks.
+ *
+ * @param name    Name of the benchmark to run. @n
+ *                All benchmarks are run, if it is @c 0.
+ *
+ * @param params  Benchmark parameters. Default values are used, if it is @c 0.
+ *
+ * @param handler Result handler.
+ *
+ * @param cookie  User-application specific parameter, 
+ *                passed to the @c handler.
+ *
+ * @return This function returns:
+ *   - Number of the passed results.
+ *   - @ref FNET_ERR if the @c name is unknown or 
+ *     the benchmarks are disabled by @ref FNET_CFG_UBENCH.
+ *
+ ******************************************************************************
+ *
+ * This function is blocking, it returns after all benchmarks are done. @n
+ * A benchmark is skipped, if its resources are not available, 
+ * for example there is no Ethernet interface or not enough memory.
+ *
+ ******************************************************************************/
+int fnet_ubench_run( const char *name, const struct fnet_ubench_params *params, fnet_ubench_handler_t handler, void *cookie );
+
+/*! @} */
+
+#endif /* _FNET_UBENCH_H_ */
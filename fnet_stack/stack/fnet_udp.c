@@ -54,6 +54,9 @@
 #include "fnet_checksum.h"
 #include "fnet_prot.h"
 #include "fnet_icmp.h"
+#include "fnet_stats_prv.h"
+#include "fnet_trace_prv.h"
+#include "fnet_latency_prv.h"
 
 #if FNET_CFG_UDP
 
@@ -65,6 +68,8 @@ static int fnet_udp_detach( fnet_socket_t *sk );
 static int fnet_udp_connect( fnet_socket_t *sk, struct sockaddr *foreign_addr);
 static int fnet_udp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const struct sockaddr *foreign_addr);
 static int fnet_udp_rcv( fnet_socket_t *sk, char *buf, int len, int flags, struct sockaddr *foreign_addr);
+static int fnet_udp_sndmmsg( fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags );
+static int fnet_udp_rcvmmsg( fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags );
 static void fnet_udp_control_input( fnet_prot_notify_t command, fnet_ip_header_t *ip_hdr );
 static int fnet_udp_shutdown( fnet_socket_t *sk, int how );
 static void fnet_udp_input( fnet_netif_t *netif, struct sockaddr *foreign_addr,  struct sockaddr *local_addr, fnet_netbuf_t *nb, fnet_netbuf_t *ip_nb);
@@ -94,7 +99,10 @@ static const fnet_socket_prot_if_t fnet_udp_socket_api =
     fnet_udp_shutdown,      /* Protocol "shutdown" function.*/
     fnet_ip_setsockopt,     /* Protocol "setsockopt" function.*/
     fnet_ip_getsockopt,     /* Protocol "getsockopt" function.*/
-    0                       /* Protocol "listen" function.*/
+    0,                      /* Protocol "listen" function.*/
+    0,                      /* Protocol "send without copying" function.*/
+    fnet_udp_sndmmsg,       /* Protocol "send datagrams" function.*/
+    fnet_udp_rcvmmsg        /* Protocol "receive datagrams" function.*/
 };
 
 fnet_prot_if_t fnet_udp_prot_if =
@@ -112,6 +120,7 @@ fnet_prot_if_t fnet_udp_prot_if =
     0,                      /* protocol drain function.*/
 #if FNET_CFG_IP6    
     fnet_udp_input_ip6,     /* Protocol input function, from IPv6.*/
+    0,                      /* Protocol input control function, from IPv6.*/
 #endif /* FNET_CFG_IP6 */      
     &fnet_udp_socket_api    /* Socket API */
 };
@@ -128,29 +137,64 @@ static void fnet_udp_release( void )
       fnet_socket_release(&fnet_udp_prot_if.head, fnet_udp_prot_if.head);
 }
 
+/************************************************************************
+* NAME: fnet_udp_route
+*
+* DESCRIPTION: Returns the outgoing interface for the destination address,
+*              or FNET_NULL if there is no route.
+*************************************************************************/
+static fnet_netif_t *fnet_udp_route( const struct sockaddr *src_addr, const struct sockaddr *dest_addr )
+{
+    fnet_netif_t *netif = FNET_NULL;
+
+#if FNET_CFG_IP4
+    if(dest_addr->sa_family == AF_INET)
+    {
+        netif = fnet_ip_route(((struct sockaddr_in *)(dest_addr))->sin_addr.s_addr);
+    }
+#endif
+#if FNET_CFG_IP6
+    if(dest_addr->sa_family == AF_INET6)
+    {
+        /* Check Scope ID.*/
+        netif = fnet_netif_get_by_scope_id( ((struct sockaddr_in6 *)dest_addr)->sin6_scope_id );
+        
+        if(netif == FNET_NULL)
+        {
+            netif = fnet_ip6_route(fnet_socket_addr_is_unspecified(src_addr)? FNET_NULL : &((struct sockaddr_in6 *)(src_addr))->sin6_addr.s6_addr, 
+                                    &((struct sockaddr_in6 *)(dest_addr))->sin6_addr.s6_addr);
+        }
+    }
+#endif
+
+    return netif;
+}
+
 /************************************************************************
 * NAME: fnet_udp_output
 *
-* DESCRIPTION: UDP output function
+* DESCRIPTION: UDP output function. 
+*              The netif parameter is optional. It is used by the batched 
+*              send, to route several datagrams with one lookup.
+*              The dst parameter is the destination cache of 
+*              a connected socket, also optional.
 *************************************************************************/
 static int fnet_udp_output(  struct sockaddr *src_addr, const struct sockaddr *dest_addr,
-                             fnet_socket_option_t *sockoption, fnet_netbuf_t *nb )                            
+                             fnet_socket_option_t *sockoption, fnet_netbuf_t *nb, fnet_netif_t *netif /*optional*/,
+                             fnet_netif_dst_t *dst /*optional*/ )                            
 {
     fnet_netbuf_t                           *nb_header;
     fnet_udp_header_t                       *udp_header;
     int                                     error =  FNET_OK;
     FNET_COMP_PACKED_VAR unsigned short     *checksum_p;
-    fnet_netif_t                            *netif;
 
 #if FNET_CFG_IP6    
-    if(dest_addr->sa_family == AF_INET6)
+    if((netif == FNET_NULL) && (dest_addr->sa_family == AF_INET6))
     {
         /* Check Scope ID.*/
         netif = fnet_netif_get_by_scope_id( ((struct sockaddr_in6 *)dest_addr)->sin6_scope_id );
     }
-    else
 #endif
-        netif = FNET_NULL;  
 
     /* Construct UDP header.*/
     if((nb_header = fnet_netbuf_new(sizeof(fnet_udp_header_t), FNET_TRUE)) == 0)
@@ -166,6 +210,11 @@ static int fnet_udp_output(  struct sockaddr *src_addr, const struct sockaddr *d
     nb = fnet_netbuf_concat(nb_header, nb);
     udp_header->length = fnet_htons((unsigned short)nb->total_length);  /* Length.*/
 
+    FNET_STATS_INC(udp.out_datagrams);
+    FNET_TRACE(FNET_TRACE_LAYER_UDP, FNET_TRACE_EVENT_TX, fnet_trace_flow(src_addr, dest_addr), 
+               fnet_ntohs(src_addr->sa_port), fnet_ntohs(dest_addr->sa_port), 0, nb->total_length);
+    FNET_LATENCY_TX_STAMP(nb);
+
     /* Checksum calculation.*/
     udp_header->checksum = 0;  
 
@@ -175,13 +224,13 @@ static int fnet_udp_output(  struct sockaddr *src_addr, const struct sockaddr *d
     if( 0 
 #if FNET_CFG_IP4
         ||( (dest_addr->sa_family == AF_INET) 
-        && ((netif = fnet_ip_route(((struct sockaddr_in *)(dest_addr))->sin_addr.s_addr))!= FNET_NULL)
+        && (netif || ((netif = fnet_ip_dst_route(dst, ((struct sockaddr_in *)(dest_addr))->sin_addr.s_addr))!= FNET_NULL))
         && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
-        && (fnet_ip_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
+        && (fnet_ip_will_fragment(netif, dst, ((struct sockaddr_in *)(dest_addr))->sin_addr.s_addr, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
 #endif
 #if FNET_CFG_IP6
         ||( (dest_addr->sa_family == AF_INET6) 
-        && (netif || (((netif = fnet_ip6_route(&((struct sockaddr_in6 *)(src_addr))->sin6_addr.s6_addr, &((struct sockaddr_in6 *)(dest_addr))->sin6_addr.s6_addr)))!= FNET_NULL) )
+        && (netif || (((netif = fnet_ip6_dst_route(dst, &((struct sockaddr_in6 *)(src_addr))->sin6_addr.s6_addr, &((struct sockaddr_in6 *)(dest_addr))->sin6_addr.s6_addr)))!= FNET_NULL) )
         && (netif->features & FNET_NETIF_FEATURE_HW_TX_PROTOCOL_CHECKSUM)
         && (fnet_ip6_will_fragment(netif, nb->total_length) == FNET_FALSE) /* Fragmented packets are not inspected.*/  ) 
 #endif
@@ -211,7 +260,7 @@ static int fnet_udp_output(  struct sockaddr *src_addr, const struct sockaddr *d
                                 sockoption->ip_opt.ttl, 
                             #endif /* FNET_CFG_MULTICAST */                               
                                 nb, FNET_UDP_DF, ((sockoption->flags & SO_DONTROUTE) > 0),
-                                checksum_p
+                                checksum_p, dst
                                 );
     }
     else
@@ -223,7 +272,7 @@ static int fnet_udp_output(  struct sockaddr *src_addr, const struct sockaddr *d
                                 fnet_socket_addr_is_unspecified(src_addr)? FNET_NULL : &((struct sockaddr_in6 *)(src_addr))->sin6_addr.s6_addr, 
                                 &((struct sockaddr_in6 *)(dest_addr))->sin6_addr.s6_addr, 
                                 FNET_IP_PROTOCOL_UDP, sockoption->ip6_opt.unicast_hops, nb, 
-                                checksum_p
+                                checksum_p, dst
                                 );
     }
     else
@@ -298,6 +347,8 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
 
     if((netif != 0) && (nb != 0))
     {
+        FNET_LATENCY_RX(FNET_LATENCY_RX_UDP, nb);
+
         /* The header must reside in contiguous area of memory.*/
         if((nb_tmp = fnet_netbuf_pullup(nb, sizeof(fnet_udp_header_t))) == 0) 
         {
@@ -338,6 +389,9 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
             local_addr->sa_port = udp_header->destination_port;
             foreign_addr->sa_port = udp_header->source_port;
 
+            FNET_TRACE(FNET_TRACE_LAYER_UDP, FNET_TRACE_EVENT_RX, fnet_trace_flow(foreign_addr, local_addr), 
+                       fnet_ntohs(foreign_addr->sa_port), fnet_ntohs(local_addr->sa_port), 0, udp_length);
+
             fnet_netbuf_trim(&nb, sizeof(fnet_udp_header_t));
 
             /* Demultiplex broadcast & multicast datagrams.*/
@@ -403,7 +457,10 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                 }
 
                 if(last == 0)
-                    goto BAD;
+                {
+                    FNET_STATS_INC(udp.no_ports);
+                    goto DROP;
+                }
 
                 if(last->receive_buffer.is_shutdown) /* Is shutdown.*/
                     goto BAD;
@@ -411,6 +468,7 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                 if(fnet_socket_buffer_append_address(&(last->receive_buffer), nb, foreign_addr) == FNET_ERR)
                     goto BAD;
                 
+                FNET_STATS_INC(udp.in_datagrams);
                 fnet_netbuf_free_chain(ip_nb);                  
             }
             else /* For unicast datagram.*/
@@ -425,14 +483,16 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
                     if(fnet_socket_buffer_append_address(&(sock->receive_buffer), nb, foreign_addr) == FNET_ERR)
                         goto BAD;
                     
+                    FNET_STATS_INC(udp.in_datagrams);
                     fnet_netbuf_free_chain(ip_nb);
                 }
                 else
                 {
+                    FNET_STATS_INC(udp.no_ports);
                     fnet_netbuf_free_chain(nb); /* No match was found, send ICMP destination port unreachable.*/
                 #if FNET_CFG_IP4                    
                     if(local_addr->sa_family == AF_INET)
-                        fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_PORT, ip_nb);
+                        fnet_icmp_error(netif, FNET_ICMP_UNREACHABLE, FNET_ICMP_UNREACHABLE_PORT, 0, ip_nb);
                 #endif
                 #if FNET_CFG_IP6                        
                     if(local_addr->sa_family == AF_INET6)
@@ -447,6 +507,8 @@ static void fnet_udp_input(fnet_netif_t *netif, struct sockaddr *foreign_addr,
     else
     {
 BAD:
+        FNET_STATS_INC(udp.in_errors);
+DROP:
         fnet_netbuf_free_chain(ip_nb);
         fnet_netbuf_free_chain(nb);
     }
@@ -524,6 +586,7 @@ static int fnet_udp_connect( fnet_socket_t *sk, struct sockaddr *foreign_addr)
     fnet_isr_lock();
     
     sk->foreign_addr = *foreign_addr;
+    FNET_NETIF_DST_RESET(&sk->dst_cache);
     
     sk->state = SS_CONNECTED;
     fnet_socket_buffer_release(&sk->receive_buffer);
@@ -583,7 +646,7 @@ static int fnet_udp_snd( fnet_socket_t *sk, char *buf, int len, int flags, const
         sk->options.flags |= SO_DONTROUTE;
     }
 
-    error = fnet_udp_output(&sk->local_addr, foreign_addr, &(sk->options), nb);
+    error = fnet_udp_output(&sk->local_addr, foreign_addr, &(sk->options), nb, FNET_NULL, (addr ? FNET_NULL : &sk->dst_cache));
 
     if(flags & MSG_DONTROUTE) /* Restore.*/
     {
@@ -648,6 +711,179 @@ ERROR:
     return (SOCKET_ERROR);
 }
 
+/************************************************************************
+* NAME: fnet_udp_sndmmsg
+*
+* DESCRIPTION: UDP batched send function. 
+*              The route lookup is done once for every run of datagrams 
+*              sent to the same destination, and the transmit path is 
+*              locked once for the whole batch.
+*************************************************************************/
+static int fnet_udp_sndmmsg( fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags )
+{
+    fnet_netbuf_t           *nb;
+    int                     error = FNET_OK;
+    const struct sockaddr   *foreign_addr;
+    const struct sockaddr   *route_addr = FNET_NULL;
+    fnet_netif_t            *netif = FNET_NULL;
+    fnet_netif_dst_t        *dst;
+    int                     flags_save = 0;
+    unsigned int            i;
+
+#if FNET_CFG_TCP_URGENT
+    if(flags & MSG_OOB)
+    {
+        fnet_socket_set_error(sk, FNET_ERR_OPNOTSUPP); /* Operation not supported.*/
+        return (SOCKET_ERROR);
+    }
+#endif /* FNET_CFG_TCP_URGENT */
+
+    if(sk->local_addr.sa_port == 0)
+    {
+        sk->local_addr.sa_port = fnet_socket_get_uniqueport(sk->protocol_interface->head, &sk->local_addr); /* Get ephemeral port.*/
+    }
+
+    if(flags & MSG_DONTROUTE) /* Save */
+    {
+        flags_save = sk->options.flags;
+        sk->options.flags |= SO_DONTROUTE;
+    }
+
+    fnet_isr_lock();
+
+    for(i = 0; i < vlen; i++)
+    {
+        msgvec[i].msg_result = SOCKET_ERROR;
+        
+        if(msgvec[i].msg_name)
+        {
+            foreign_addr = msgvec[i].msg_name;
+            
+            if(fnet_socket_addr_is_unspecified(foreign_addr) || (foreign_addr->sa_port == 0))
+            {
+                error = FNET_ERR_DESTADDRREQ; /* Destination address required.*/
+                break;
+            }
+        }
+        else
+        {
+            foreign_addr = &sk->foreign_addr;
+            
+            if(fnet_socket_addr_is_unspecified(foreign_addr))
+            {
+                error = FNET_ERR_NOTCONN; /* Socket is not connected.*/
+                break;
+            }
+        }
+
+        if((msgvec[i].msg_len < 0) || ((unsigned long)msgvec[i].msg_len > sk->send_buffer.count_max))
+        {
+            error = FNET_ERR_MSGSIZE;   /* Message too long. */
+            break;
+        }
+
+        if(msgvec[i].msg_name == FNET_NULL)
+        {
+            /* The connected peer, use the socket destination cache.*/
+            dst = &sk->dst_cache;
+            netif = FNET_NULL;
+            route_addr = FNET_NULL;
+        }
+        else
+        {
+            dst = FNET_NULL;
+        
+            /* Route lookup, only when the destination changes.*/
+            if((route_addr == FNET_NULL) || (route_addr->sa_family != foreign_addr->sa_family)
+                || (fnet_socket_addr_are_equal(route_addr, foreign_addr) == FNET_FALSE))
+            {
+                route_addr = foreign_addr;
+                netif = fnet_udp_route(&sk->local_addr, foreign_addr);
+            }
+        }
+
+        if((nb = fnet_netbuf_from_buf(msgvec[i].msg_buf, msgvec[i].msg_len, FNET_FALSE)) == 0)
+        {
+            error = FNET_ERR_NOMEM;     /* Cannot allocate memory.*/
+            break;
+        }
+
+        error = fnet_udp_output(&sk->local_addr, foreign_addr, &(sk->options), nb, netif, dst);
+
+        if((error != FNET_OK) || (sk->options.local_error != FNET_OK)) /* We get UDP or ICMP error.*/
+        {
+            break;
+        }
+
+        msgvec[i].msg_result = msgvec[i].msg_len;
+    }
+
+    fnet_isr_unlock();
+
+    if(flags & MSG_DONTROUTE) /* Restore.*/
+    {
+        sk->options.flags = flags_save;
+    }
+
+    if(i > 0)
+    {
+        return ((int)i);
+    }
+
+    fnet_socket_set_error(sk, error);
+    return (SOCKET_ERROR);
+}
+
+/************************************************************************
+* NAME: fnet_udp_rcvmmsg
+*
+* DESCRIPTION: UDP batched receive function.
+*              It drains up to vlen queued datagrams.
+*************************************************************************/
+static int fnet_udp_rcvmmsg( fnet_socket_t *sk, struct fnet_mmsghdr *msgvec, unsigned int vlen, int flags )
+{
+    int             error = FNET_OK;
+    struct sockaddr foreign_addr;
+    unsigned int    i;
+
+#if FNET_CFG_TCP_URGENT
+    if(flags & MSG_OOB)
+    {
+        error = FNET_ERR_OPNOTSUPP; /* Operation not supported.*/
+        goto ERROR;
+    }
+#endif /* FNET_CFG_TCP_URGENT */
+
+    if(sk->options.local_error != FNET_OK) /* We get UDP or ICMP error.*/
+    {
+        error = sk->options.local_error;
+        goto ERROR;
+    }
+
+    fnet_isr_lock();
+
+    for(i = 0; (i < vlen) && (sk->receive_buffer.net_buf_chain); i++)
+    {
+        fnet_memset_zero ((void *)&foreign_addr, sizeof(foreign_addr));
+
+        /* FNET_ERR means the datagram was truncated.*/
+        msgvec[i].msg_result = fnet_socket_buffer_read_address(&(sk->receive_buffer), msgvec[i].msg_buf,
+                                                                msgvec[i].msg_len, &foreign_addr, FNET_TRUE);
+        if(msgvec[i].msg_name)
+        {
+            fnet_socket_addr_copy(&foreign_addr, msgvec[i].msg_name);
+        }
+    }
+
+    fnet_isr_unlock();
+
+    return ((int)i);
+
+ERROR:
+    fnet_socket_set_error(sk, error);
+    return (SOCKET_ERROR);
+}
+
 /************************************************************************
 * NAME: fnet_udp_control_input
 *
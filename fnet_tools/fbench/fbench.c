@@ -0,0 +1,1194 @@
+/**************************************************************************
+*
+* Copyright 2012-2013 by Andrey Butok. FNET Community.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the FNET project give you
+* permission to link the FNET sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the FNET sources, you may extend this exception
+* to your version of the FNET sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+**********************************************************************/ /*!
+*
+* @file fbench.c
+*
+* @author Andrey Butok
+*
+* @brief FNET Throughput Benchmark peer, for POSIX hosts.
+*
+*        It is the host side of the FNET "benchrx"/"benchtx" shell 
+*        commands (fapp_bench.c) and speaks the same protocol:
+*        - TCP bulk transfer, over one or more streams.
+*        - UDP bulk transfer, ended by the 1-byte end mark, 
+*          acknowledged by the number of received bytes.
+*        - TCP request/response (rr) and connect/request/response/close
+*          (crr) transactions. Every request starts with the 8-byte header, 
+*          containing the request size and the response size 
+*          (32-bit, network byte order).
+*
+*        Build: cc -O2 -o fbench fbench.c
+*
+***************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE     /* struct ip_mreq, on glibc.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/************************************************************************
+* Benchmark definitions, the same as in fapp_bench.h
+************************************************************************/
+#define FBENCH_PORT                     (7007)
+#define FBENCH_PACKET_SIZE_MAX          (8*1024)
+#define FBENCH_TX_PACKET_SIZE_DEFAULT   (1472)
+#define FBENCH_TX_PACKET_NUMBER_DEFAULT (10000)
+#define FBENCH_STREAMS_MAX              (4)
+#define FBENCH_RR_HEADER_SIZE           (8)
+#define FBENCH_RR_SIZE_DEFAULT          (64)
+#define FBENCH_RR_NUMBER_DEFAULT        (1000)
+#define FBENCH_RR_TIMEOUT_MS            (5000)
+#define FBENCH_UDP_END_BUFFER_LENGTH    (1)
+#define FBENCH_UDP_TIMEOUT_MS           (8000)
+#define FBENCH_TX_UDP_END_ITERATIONS    (10)
+#define FBENCH_UDP_END_TIMEOUT_MS       (100)
+#define FBENCH_POLL_MS                  (100)
+
+#define FBENCH_BUFFER_SIZE              (64*1024)
+
+/************************************************************************
+*    Benchmark modes.
+*************************************************************************/
+typedef enum
+{
+    FBENCH_MODE_TCP = 0,    /* TCP bulk transfer.*/
+    FBENCH_MODE_UDP = 1,    /* UDP bulk transfer.*/
+    FBENCH_MODE_RR = 2,     /* TCP request/response transactions, over one connection.*/
+    FBENCH_MODE_CRR = 3     /* TCP connect/request/response/close transactions.*/
+} fbench_mode_t;
+
+static const char *const fbench_mode_str[] = {"tcp", "udp", "rr", "crr"};
+
+/************************************************************************
+*    Benchmark parameters.
+*************************************************************************/
+struct fbench_params
+{
+    fbench_mode_t   mode;
+    int             tx;                 /* Transmitter (client) or receiver (server).*/
+    const char      *host;              /* TX only.*/
+    const char      *group;             /* UDP RX only, optional multicast group.*/
+    unsigned short  port;
+    long            packet_size;        /* Message or request size.*/
+    long            packet_number;      /* Number of messages or transactions.*/
+    long            iteration_number;
+    long            response_size;      /* RR and CRR only.*/
+    long            stream_number;      /* TCP TX only.*/
+    long            sndbuf;             /* 0 - system default.*/
+    long            rcvbuf;             /* 0 - system default.*/
+    int             json;               /* Print the results in JSON format.*/
+};
+
+/************************************************************************
+*    Benchmark results.
+*************************************************************************/
+struct fbench_results
+{
+    char                peer[INET6_ADDRSTRLEN];
+    long                streams;
+    struct timespec     first_time;
+    struct timespec     last_time;
+    unsigned long long  bytes;
+    unsigned long long  remote_bytes;       /* UDP TX only.*/
+    unsigned long       transactions;
+    unsigned long       *latency;           /* Latencies of the transactions, in us.*/
+    unsigned long       latency_number;     /* Size of the latency array.*/
+};
+
+static char fbench_buffer[FBENCH_BUFFER_SIZE];
+static volatile sig_atomic_t fbench_exit_flag;
+
+/************************************************************************
+* NAME: fbench_sigint
+*
+* DESCRIPTION: [Ctrl+C] handler. 
+************************************************************************/
+static void fbench_sigint (int sig)
+{
+    (void)sig;
+    fbench_exit_flag = 1;
+}
+
+/************************************************************************
+* NAME: fbench_stamp
+*
+* DESCRIPTION: Takes the time stamp. 
+************************************************************************/
+static void fbench_stamp (struct timespec *stamp)
+{
+    clock_gettime(CLOCK_MONOTONIC, stamp);
+}
+
+/************************************************************************
+* NAME: fbench_interval_us
+*
+* DESCRIPTION: Returns the time between the stamps, in microseconds. 
+************************************************************************/
+static unsigned long long fbench_interval_us (const struct timespec *start, const struct timespec *end)
+{
+    long long us = (long long)(end->tv_sec - start->tv_sec) * 1000000LL 
+                   + (end->tv_nsec - start->tv_nsec) / 1000;
+
+    return (us > 0) ? (unsigned long long)us : 0;
+}
+
+/************************************************************************
+* NAME: fbench_error
+*
+* DESCRIPTION: Prints the error of the last system call. 
+************************************************************************/
+static void fbench_error (const char *what)
+{
+    fprintf(stderr, "fbench: %s: %s\n", what, strerror(errno));
+}
+
+/************************************************************************
+* NAME: fbench_cmp
+*
+* DESCRIPTION: qsort() comparison of the latencies. 
+************************************************************************/
+static int fbench_cmp (const void *a, const void *b)
+{
+    unsigned long x = *(const unsigned long *)a;
+    unsigned long y = *(const unsigned long *)b;
+
+    return (x > y) - (x < y);
+}
+
+/************************************************************************
+* NAME: fbench_percentile
+*
+* DESCRIPTION: Returns the percentile of the n sorted latencies,
+*              the same way as fapp_bench.c does. 
+************************************************************************/
+static unsigned long fbench_percentile (const unsigned long *latency, unsigned long n, unsigned long percent)
+{
+    unsigned long i = (n * percent) / 100;
+
+    if(i >= n)
+        i = n - 1;
+
+    return latency[i];
+}
+
+/************************************************************************
+* NAME: fbench_print_results
+*
+* DESCRIPTION: Print Benchmark results. 
+************************************************************************/
+static void fbench_print_results (const struct fbench_params *params, struct fbench_results *results)
+{
+    unsigned long long  interval = fbench_interval_us(&results->first_time, &results->last_time);
+    double              seconds = (double)interval / 1000000.0;
+    double              kbps = 0.0;
+    double              remote_kbps = 0.0;
+    double              tps = 0.0;
+    unsigned long       min = 0, max = 0, p50 = 0, p90 = 0, p99 = 0;
+    unsigned long long  total = 0;
+    unsigned long       avg = 0;
+    unsigned long       i;
+
+    if(interval)
+    {
+        kbps = (double)results->bytes * 8.0 / 1000.0 / seconds;
+        remote_kbps = (double)results->remote_bytes * 8.0 / 1000.0 / seconds;
+        tps = (double)results->transactions / seconds;
+    }
+
+    if(results->transactions)
+    {
+        qsort(results->latency, results->transactions, sizeof(results->latency[0]), fbench_cmp);
+
+        for(i = 0; i < results->transactions; i++)
+            total += results->latency[i];
+
+        min = results->latency[0];
+        max = results->latency[results->transactions - 1];
+        avg = (unsigned long)(total / results->transactions);
+        p50 = fbench_percentile(results->latency, results->transactions, 50);
+        p90 = fbench_percentile(results->latency, results->transactions, 90);
+        p99 = fbench_percentile(results->latency, results->transactions, 99);
+    }
+
+    if(params->json)
+    {
+        printf("{\"tool\":\"fbench\",\"mode\":\"%s\",\"dir\":\"%s\",\"peer\":\"%s\",\"port\":%u,"
+               "\"streams\":%ld,\"size\":%ld,\"response_size\":%ld,\"sndbuf\":%ld,\"rcvbuf\":%ld,"
+               "\"transactions\":%lu,\"bytes\":%llu,\"remote_bytes\":%llu,\"time_us\":%llu,"
+               "\"kbit_s\":%.1f,\"remote_kbit_s\":%.1f,\"trans_s\":%.1f,"
+               "\"latency_us\":{\"min\":%lu,\"avg\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu}}\n",
+               fbench_mode_str[params->mode], params->tx ? "tx" : "rx", results->peer, (unsigned)params->port,
+               results->streams, params->packet_size, params->response_size, params->sndbuf, params->rcvbuf,
+               results->transactions, results->bytes, results->remote_bytes, interval,
+               kbps, remote_kbps, tps, min, avg, p50, p90, p99, max);
+    }
+    else
+    {
+        printf("Results:\n");
+
+        if(results->remote_bytes == 0)
+            printf("\t%llu bytes in %.3f seconds = %.1f Kbits/sec\n", results->bytes, seconds, kbps);
+        else /* UDP TX only */
+            printf("\t%llu [%llu] bytes in %.3f seconds = %.1f [%.1f] Kbits/sec\n", results->bytes, results->remote_bytes, seconds, kbps, remote_kbps);
+
+        if(results->transactions)
+        {
+            printf("\t%lu transactions = %.1f transactions/sec\n", results->transactions, tps);
+            printf("\tLatency, us: min %lu, avg %lu, p50 %lu, p90 %lu, p99 %lu, max %lu\n", min, avg, p50, p90, p99, max);
+        }
+
+        printf("\n");
+    }
+
+    fflush(stdout);
+}
+
+/************************************************************************
+* NAME: fbench_reset
+*
+* DESCRIPTION: Resets the results. 
+************************************************************************/
+static void fbench_reset (struct fbench_results *results)
+{
+    unsigned long   *latency = results->latency;
+    unsigned long   latency_number = results->latency_number;
+
+    memset(results, 0, sizeof(*results));
+    results->latency = latency;
+    results->latency_number = latency_number;
+}
+
+/************************************************************************
+* NAME: fbench_peer
+*
+* DESCRIPTION: Saves the peer address string. 
+************************************************************************/
+static void fbench_peer (struct fbench_results *results, const struct sockaddr_storage *addr)
+{
+    if(addr->ss_family == AF_INET6)
+        inet_ntop(AF_INET6, &((const struct sockaddr_in6 *)addr)->sin6_addr, results->peer, sizeof(results->peer));
+    else
+        inet_ntop(AF_INET, &((const struct sockaddr_in *)addr)->sin_addr, results->peer, sizeof(results->peer));
+}
+
+/************************************************************************
+* NAME: fbench_socket_options
+*
+* DESCRIPTION: Sets the benchmark socket options. 
+************************************************************************/
+static int fbench_socket_options (int s, const struct fbench_params *params, int type)
+{
+    int sndbuf = (int)params->sndbuf;
+    int rcvbuf = (int)params->rcvbuf;
+    int one = 1;
+
+    if((sndbuf && (setsockopt(s, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) < 0)) ||
+       (rcvbuf && (setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)))
+    {
+        fbench_error("setsockopt");
+        return -1;
+    }
+
+    /* The transactions are not delayed by Nagle.*/
+    if((type == SOCK_STREAM) && (params->mode != FBENCH_MODE_TCP))
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_listen
+*
+* DESCRIPTION: Creates the bound server socket, IPv6 and IPv4 if possible.
+************************************************************************/
+static int fbench_listen (const struct fbench_params *params, int type, int *family)
+{
+    struct sockaddr_in6 addr6;
+    struct sockaddr_in  addr4;
+    int                 zero = 0;
+    int                 one = 1;
+    int                 s;
+
+    /* The dual-stack IPv6 socket, or IPv4 only (UDP multicast).*/
+    if((params->group == NULL) && ((s = socket(AF_INET6, type, 0)) >= 0))
+    {
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(s, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+
+        memset(&addr6, 0, sizeof(addr6));
+        addr6.sin6_family = AF_INET6;
+        addr6.sin6_addr = in6addr_any;
+        addr6.sin6_port = htons(params->port);
+
+        if(bind(s, (struct sockaddr *)&addr6, sizeof(addr6)) == 0)
+        {
+            *family = AF_INET6;
+            goto BOUND;
+        }
+        close(s);
+    }
+
+    if((s = socket(AF_INET, type, 0)) < 0)
+    {
+        fbench_error("socket");
+        return -1;
+    }
+
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr4, 0, sizeof(addr4));
+    addr4.sin_family = AF_INET;
+    addr4.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr4.sin_port = htons(params->port);
+
+    if(bind(s, (struct sockaddr *)&addr4, sizeof(addr4)) < 0)
+    {
+        fbench_error("bind");
+        goto ERROR;
+    }
+    *family = AF_INET;
+
+BOUND:
+    if(fbench_socket_options(s, params, type) < 0)
+        goto ERROR;
+
+    if((type == SOCK_STREAM) && (listen(s, FBENCH_STREAMS_MAX) < 0))
+    {
+        fbench_error("listen");
+        goto ERROR;
+    }
+
+    return s;
+
+ERROR:
+    close(s);
+    return -1;
+}
+
+/************************************************************************
+* NAME: fbench_connect
+*
+* DESCRIPTION: Creates the socket, connected to the benchmark server.
+************************************************************************/
+static int fbench_connect (const struct fbench_params *params, int type, struct fbench_results *results)
+{
+    struct addrinfo     hints;
+    struct addrinfo     *ai;
+    struct addrinfo     *p;
+    char                port[8];
+    int                 s = -1;
+    int                 err;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    snprintf(port, sizeof(port), "%u", (unsigned)params->port);
+
+    if((err = getaddrinfo(params->host, port, &hints, &ai)) != 0)
+    {
+        fprintf(stderr, "fbench: %s: %s\n", params->host, gai_strerror(err));
+        return -1;
+    }
+
+    for(p = ai; p; p = p->ai_next)
+    {
+        if((s = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) < 0)
+            continue;
+
+        if((fbench_socket_options(s, params, type) == 0) && (connect(s, p->ai_addr, p->ai_addrlen) == 0))
+        {
+            if(results)
+                fbench_peer(results, (const struct sockaddr_storage *)p->ai_addr);
+            break;
+        }
+
+        close(s);
+        s = -1;
+    }
+
+    if(s < 0)
+        fbench_error("connect");
+
+    freeaddrinfo(ai);
+    return s;
+}
+
+/************************************************************************
+* NAME: fbench_send_all
+*
+* DESCRIPTION: Sends the whole buffer. 
+************************************************************************/
+static int fbench_send_all (int s, const char *buffer, size_t size)
+{
+    ssize_t result;
+
+    while(size)
+    {
+        if((result = send(s, buffer, size, 0)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+        buffer += result;
+        size -= (size_t)result;
+    }
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_recv_all
+*
+* DESCRIPTION: Receives size bytes, the data beyond the buffer are 
+*              discarded. Fails on close or after the timeout.
+************************************************************************/
+static int fbench_recv_all (int s, char *buffer, size_t size, int timeout_ms)
+{
+    struct pollfd   pfd;
+    ssize_t         result;
+    size_t          chunk;
+
+    pfd.fd = s;
+    pfd.events = POLLIN;
+
+    while(size)
+    {
+        if(poll(&pfd, 1, timeout_ms) <= 0)
+            return -1; /* Timeout or [Ctrl+C].*/
+
+        chunk = (size > FBENCH_BUFFER_SIZE) ? FBENCH_BUFFER_SIZE : size;
+
+        if((result = recv(s, buffer ? buffer : fbench_buffer, chunk, 0)) <= 0)
+            return -1;
+
+        if(buffer)
+            buffer += result;
+        size -= (size_t)result;
+    }
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_tcp_rx
+*
+* DESCRIPTION: Benchmark TCP server. 
+*              It receives up to FBENCH_STREAMS_MAX streams at once.
+*              The test ends, when all streams are closed.
+************************************************************************/
+static int fbench_tcp_rx (const struct fbench_params *params, struct fbench_results *results)
+{
+    struct pollfd           pfd[FBENCH_STREAMS_MAX + 1];
+    struct sockaddr_storage addr;
+    socklen_t               addr_len;
+    ssize_t                 received;
+    int                     family;
+    int                     active;
+    int                     i;
+
+    if((pfd[0].fd = fbench_listen(params, SOCK_STREAM, &family)) < 0)
+        return -1;
+    pfd[0].events = POLLIN;
+
+    if(!params->json)
+        printf("TCP RX Test, port %u, max. streams %d.\n", (unsigned)params->port, FBENCH_STREAMS_MAX);
+
+    while(!fbench_exit_flag)
+    {
+        if(!params->json)
+            printf("Waiting.\n");
+        fflush(stdout);
+
+        fbench_reset(results);
+        active = 0;
+
+        for(i = 1; i <= FBENCH_STREAMS_MAX; i++)
+        {
+            pfd[i].fd = -1;
+            pfd[i].events = POLLIN;
+        }
+
+        while(!fbench_exit_flag)
+        {
+            pfd[0].fd = (active < FBENCH_STREAMS_MAX) ? abs(pfd[0].fd) : -abs(pfd[0].fd);
+
+            if(poll(pfd, FBENCH_STREAMS_MAX + 1, FBENCH_POLL_MS) <= 0)
+                continue;
+
+            /* Accept new streams.*/
+            if((pfd[0].fd >= 0) && (pfd[0].revents & POLLIN))
+            {
+                addr_len = sizeof(addr);
+
+                for(i = 1; pfd[i].fd >= 0; i++)
+                {}
+
+                if((pfd[i].fd = accept(pfd[0].fd, (struct sockaddr *)&addr, &addr_len)) >= 0)
+                {
+                    fbench_peer(results, &addr);
+
+                    if(!params->json)
+                        printf("Receiving from %s:%u\n", results->peer, (unsigned)ntohs(((struct sockaddr_in *)&addr)->sin_port));
+
+                    if(results->streams == 0)
+                        fbench_stamp(&results->first_time);
+
+                    active++;
+                    results->streams++;
+                }
+            }
+
+            /* Receiving data.*/
+            for(i = 1; i <= FBENCH_STREAMS_MAX; i++)
+            {
+                if((pfd[i].fd >= 0) && pfd[i].revents)
+                {
+                    received = recv(pfd[i].fd, fbench_buffer, FBENCH_BUFFER_SIZE, 0);
+
+                    if(received > 0)
+                    {
+                        results->bytes += (unsigned long long)received;
+                    }
+                    else if((received == 0) || (errno != EINTR)) /* The stream is closed.*/
+                    {
+                        close(pfd[i].fd);
+                        pfd[i].fd = -1;
+                        active--;
+                        fbench_stamp(&results->last_time);
+                    }
+                }
+            }
+
+            if((results->streams) && (active == 0))
+                break;
+        }
+
+        if(results->streams)
+        {
+            if(fbench_exit_flag)
+                fbench_stamp(&results->last_time);
+            fbench_print_results(params, results);
+        }
+
+        for(i = 1; i <= FBENCH_STREAMS_MAX; i++)
+        {
+            if(pfd[i].fd >= 0)
+                close(pfd[i].fd);
+        }
+    }
+
+    close(abs(pfd[0].fd));
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_udp_rx
+*
+* DESCRIPTION: Benchmark UDP server. 
+************************************************************************/
+static int fbench_udp_rx (const struct fbench_params *params, struct fbench_results *results)
+{
+    struct pollfd           pfd;
+    struct sockaddr_storage addr;
+    socklen_t               addr_len;
+    ssize_t                 received;
+    struct timespec         now;
+    uint32_t                ack_bytes;
+    int                     is_first;
+    int                     family;
+    int                     i;
+
+    if((pfd.fd = fbench_listen(params, SOCK_DGRAM, &family)) < 0)
+        return -1;
+    pfd.events = POLLIN;
+
+    /* Join multicast group, if set. */
+    if(params->group)
+    {
+        struct ip_mreq mreq;
+
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+
+        if((inet_pton(AF_INET, params->group, &mreq.imr_multiaddr) != 1) || !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr)))
+        {
+            fprintf(stderr, "fbench: %s: wrong multicast group\n", params->group);
+            close(pfd.fd);
+            return -1;
+        }
+
+        if(setsockopt(pfd.fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+        {
+            fbench_error("IP_ADD_MEMBERSHIP");
+            close(pfd.fd);
+            return -1;
+        }
+    }
+
+    if(!params->json)
+        printf("UDP RX Test, port %u%s%s.\n", (unsigned)params->port, params->group ? ", multicast group " : "", params->group ? params->group : "");
+
+    while(!fbench_exit_flag) /* Main loop */
+    {
+        if(!params->json)
+            printf("Waiting.\n");
+        fflush(stdout);
+
+        fbench_reset(results);
+        is_first = 1;
+
+        while(!fbench_exit_flag) /* Test loop. */
+        {
+            if(poll(&pfd, 1, FBENCH_POLL_MS) <= 0)
+            {
+                /* Check timeout. */
+                fbench_stamp(&now);
+                if(!is_first && (fbench_interval_us(&results->last_time, &now) > FBENCH_UDP_TIMEOUT_MS * 1000ULL))
+                {
+                    if(!params->json)
+                        printf("Exit on timeout.\n");
+                    fbench_print_results(params, results);
+                    break;
+                }
+                continue;
+            }
+
+            addr_len = sizeof(addr);
+            received = recvfrom(pfd.fd, fbench_buffer, FBENCH_BUFFER_SIZE, 0, (struct sockaddr *)&addr, &addr_len);
+
+            if(received < FBENCH_UDP_END_BUFFER_LENGTH)
+                continue;
+
+            if(is_first)
+            {
+                if(received > FBENCH_UDP_END_BUFFER_LENGTH)
+                {
+                    fbench_peer(results, &addr);
+                    if(!params->json)
+                        printf("Receiving from %s:%u\n", results->peer, (unsigned)ntohs(((struct sockaddr_in *)&addr)->sin_port));
+
+                    fbench_stamp(&results->first_time);
+                    results->last_time = results->first_time;
+                    results->streams = 1;
+                    is_first = 0;
+                }
+            }
+            else if(received == FBENCH_UDP_END_BUFFER_LENGTH) /* End of transfer. */
+            {
+                /* Send ACK containing amount of received data, several times.*/
+                ack_bytes = htonl((uint32_t)results->bytes);
+
+                for(i = 0; i < 3; i++)
+                    sendto(pfd.fd, &ack_bytes, sizeof(ack_bytes), 0, (struct sockaddr *)&addr, addr_len);
+
+                fbench_print_results(params, results);
+                break;
+            }
+            else
+            {
+                results->bytes += (unsigned long long)received;
+                fbench_stamp(&results->last_time);
+            }
+        }
+    }
+
+    close(pfd.fd);
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_rr_rx
+*
+* DESCRIPTION: Benchmark TCP request/response server. 
+*              The connections are served one by one.
+************************************************************************/
+static int fbench_rr_rx (const struct fbench_params *params, struct fbench_results *results)
+{
+    uint32_t            header[FBENCH_RR_HEADER_SIZE / sizeof(uint32_t)];
+    unsigned long       request_size;
+    unsigned long       response_size;
+    unsigned long       connections = 0;
+    unsigned long       size;
+    int                 s_listen;
+    int                 s;
+    int                 family;
+
+    if((s_listen = fbench_listen(params, SOCK_STREAM, &family)) < 0)
+        return -1;
+
+    if(!params->json)
+        printf("TCP RR Server, port %u.\n", (unsigned)params->port);
+    fflush(stdout);
+
+    fbench_reset(results);
+
+    while(!fbench_exit_flag)
+    {
+        if((s = accept(s_listen, NULL, NULL)) < 0)
+            continue;
+
+        connections++;
+
+        while(!fbench_exit_flag) /* Transactions.*/
+        {
+            if(fbench_recv_all(s, (char *)header, FBENCH_RR_HEADER_SIZE, -1) < 0)
+                break;
+
+            request_size = ntohl(header[0]);
+            response_size = ntohl(header[1]);
+
+            if(request_size < FBENCH_RR_HEADER_SIZE)
+                break; /* Wrong request.*/
+
+            /* Rest of the request.*/
+            if(fbench_recv_all(s, NULL, request_size - FBENCH_RR_HEADER_SIZE, -1) < 0)
+                break;
+
+            /* Response.*/
+            for(; response_size; response_size -= size)
+            {
+                size = (response_size > FBENCH_BUFFER_SIZE) ? FBENCH_BUFFER_SIZE : response_size;
+
+                if(fbench_send_all(s, fbench_buffer, size) < 0)
+                    break;
+            }
+
+            if(response_size)
+                break;
+
+            results->transactions++;
+            results->bytes += (unsigned long long)request_size + ntohl(header[1]);
+        }
+
+        close(s);
+    }
+
+    if(params->json)
+        printf("{\"tool\":\"fbench\",\"mode\":\"rr\",\"dir\":\"rx\",\"port\":%u,\"connections\":%lu,\"transactions\":%lu,\"bytes\":%llu}\n",
+               (unsigned)params->port, connections, results->transactions, results->bytes);
+    else
+        printf("Served %lu connections, %lu transactions, %llu bytes.\n", connections, results->transactions, results->bytes);
+
+    close(s_listen);
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_tcp_tx
+*
+* DESCRIPTION: TX TCP Benchmark. 
+*              The messages are sent over the parallel streams, 
+*              in round-robin.
+************************************************************************/
+static int fbench_tcp_tx (const struct fbench_params *params, struct fbench_results *results)
+{
+    int     s[FBENCH_STREAMS_MAX];
+    long    messages;
+    long    iterations;
+    long    i;
+    long    streams = 0;
+    int     result = 0;
+
+    for(iterations = 0; (iterations < params->iteration_number) && !fbench_exit_flag && (result == 0); iterations++)
+    {
+        fbench_reset(results);
+
+        /* Connect the streams.*/
+        for(streams = 0; streams < params->stream_number; streams++)
+        {
+            if((s[streams] = fbench_connect(params, SOCK_STREAM, results)) < 0)
+            {
+                result = -1;
+                goto CLOSE;
+            }
+        }
+
+        results->streams = streams;
+
+        /* Sending.*/
+        if(!params->json)
+            printf("Sending.\n");
+        fbench_stamp(&results->first_time);
+
+        for(messages = 0; (messages < params->packet_number) && !fbench_exit_flag; messages++)
+        {
+            for(i = 0; i < streams; i++)
+            {
+                if(fbench_send_all(s[i], fbench_buffer, (size_t)params->packet_size) < 0)
+                {
+                    fbench_error("send");
+                    result = -1;
+                    goto CLOSE;
+                }
+                results->bytes += (unsigned long long)params->packet_size;
+            }
+        }
+
+        fbench_stamp(&results->last_time);
+        fbench_print_results(params, results);
+
+CLOSE:
+        for(i = 0; i < streams; i++)
+            close(s[i]);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fbench_udp_tx
+*
+* DESCRIPTION: TX UDP Benchmark. 
+************************************************************************/
+static int fbench_udp_tx (const struct fbench_params *params, struct fbench_results *results)
+{
+    struct pollfd   pfd;
+    uint32_t        ack_bytes;
+    long            messages;
+    long            iterations;
+    int             i;
+
+    for(iterations = 0; (iterations < params->iteration_number) && !fbench_exit_flag; iterations++)
+    {
+        fbench_reset(results);
+
+        if((pfd.fd = fbench_connect(params, SOCK_DGRAM, results)) < 0)
+            return -1;
+        pfd.events = POLLIN;
+        results->streams = 1;
+
+        /* Sending.*/
+        if(!params->json)
+            printf("Sending.\n");
+        fbench_stamp(&results->first_time);
+
+        for(messages = 0; (messages < params->packet_number) && !fbench_exit_flag; messages++)
+        {
+            if(send(pfd.fd, fbench_buffer, (size_t)params->packet_size, 0) < 0)
+            {
+                if((errno == ENOBUFS) || (errno == EINTR))
+                    continue; /* Lost, as on a wire.*/
+                if(errno == ECONNREFUSED) 
+                    continue; /* ICMP unreachable, for an earlier datagram.*/
+
+                fbench_error("send");
+                close(pfd.fd);
+                return -1;
+            }
+            results->bytes += (unsigned long long)params->packet_size;
+        }
+
+        fbench_stamp(&results->last_time);
+
+        /* Send End mark. The ACK contains amount of received data.*/
+        for(i = 0; i < FBENCH_TX_UDP_END_ITERATIONS; i++)
+        {
+            send(pfd.fd, fbench_buffer, FBENCH_UDP_END_BUFFER_LENGTH, 0);
+
+            if((poll(&pfd, 1, FBENCH_UDP_END_TIMEOUT_MS) > 0) 
+                && (recv(pfd.fd, &ack_bytes, sizeof(ack_bytes), 0) == sizeof(ack_bytes)))
+            {
+                results->remote_bytes = ntohl(ack_bytes);
+                break;
+            }
+        }
+
+        fbench_print_results(params, results);
+        close(pfd.fd);
+    }
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_rr_transaction
+*
+* DESCRIPTION: Sends a request and receives its response. 
+************************************************************************/
+static int fbench_rr_transaction (const struct fbench_params *params, int s)
+{
+    uint32_t header[FBENCH_RR_HEADER_SIZE / sizeof(uint32_t)];
+
+    header[0] = htonl((uint32_t)params->packet_size);
+    header[1] = htonl((uint32_t)params->response_size);
+    memcpy(fbench_buffer, header, FBENCH_RR_HEADER_SIZE);
+
+    if((fbench_send_all(s, fbench_buffer, (size_t)params->packet_size) < 0) ||
+       (fbench_recv_all(s, NULL, (size_t)params->response_size, FBENCH_RR_TIMEOUT_MS) < 0))
+        return -1;
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: fbench_rr_tx
+*
+* DESCRIPTION: TCP request/response Benchmark. 
+*              In the CRR mode, every transaction has its own connection.
+************************************************************************/
+static int fbench_rr_tx (const struct fbench_params *params, struct fbench_results *results)
+{
+    struct timespec start;
+    struct timespec end;
+    int             crr = (params->mode == FBENCH_MODE_CRR);
+    long            iterations;
+    int             s = -1;
+    int             result = 0;
+
+    for(iterations = 0; (iterations < params->iteration_number) && !fbench_exit_flag && (result == 0); iterations++)
+    {
+        fbench_reset(results);
+        results->streams = 1;
+
+        if(!crr && ((s = fbench_connect(params, SOCK_STREAM, results)) < 0))
+            return -1;
+
+        fbench_stamp(&results->first_time);
+
+        while((results->transactions < (unsigned long)params->packet_number) && !fbench_exit_flag)
+        {
+            fbench_stamp(&start);
+
+            if(crr && ((s = fbench_connect(params, SOCK_STREAM, results)) < 0))
+            {
+                result = -1;
+                break;
+            }
+
+            if(fbench_rr_transaction(params, s) < 0)
+            {
+                fprintf(stderr, "fbench: transaction failed\n");
+                result = -1;
+                break;
+            }
+
+            if(crr)
+            {
+                close(s);
+                s = -1;
+            }
+
+            fbench_stamp(&end);
+            results->latency[results->transactions++] = (unsigned long)fbench_interval_us(&start, &end);
+            results->bytes += (unsigned long long)(params->packet_size + params->response_size);
+        }
+
+        fbench_stamp(&results->last_time);
+
+        if(s >= 0)
+        {
+            close(s);
+            s = -1;
+        }
+
+        if(results->transactions)
+            fbench_print_results(params, results);
+    }
+
+    return result;
+}
+
+/************************************************************************
+* NAME: fbench_number
+*
+* DESCRIPTION: Converts the option value, in range [min, max]. 
+************************************************************************/
+static long fbench_number (const char *str, long min, long max)
+{
+    char    *p;
+    long    value = strtol(str, &p, 0);
+
+    if(*p || (*str == 0) || (value < min) || (value > max))
+    {
+        fprintf(stderr, "fbench: wrong parameter \"%s\"\n", str);
+        exit(EXIT_FAILURE);
+    }
+
+    return value;
+}
+
+/************************************************************************
+* NAME: fbench_usage
+*
+* DESCRIPTION: Prints the usage. 
+************************************************************************/
+static void fbench_usage (void)
+{
+    fprintf(stderr, 
+        "Usage: fbench [options] rx [tcp|udp|rr]\n"
+        "       fbench [options] tx <remote ip> [tcp|udp|rr|crr]\n"
+        "Options:\n"
+        "  -p <port>        Port (default %d).\n"
+        "  -s <size>        Message or request size (default %d, rr/crr %d).\n"
+        "  -n <number>      Number of messages or transactions (default %d, rr/crr %d).\n"
+        "  -i <number>      Number of iterations (default 1).\n"
+        "  -t <number>      Number of parallel TCP streams (default 1, max. %d).\n"
+        "  -r <size>        Response size, rr/crr only (default %d).\n"
+        "  -S <size>        Socket TX buffer size.\n"
+        "  -R <size>        Socket RX buffer size.\n"
+        "  -g <group>       UDP RX multicast group.\n"
+        "  -j               Print the results in JSON format, one object per line.\n",
+        FBENCH_PORT, FBENCH_TX_PACKET_SIZE_DEFAULT, FBENCH_RR_SIZE_DEFAULT, 
+        FBENCH_TX_PACKET_NUMBER_DEFAULT, FBENCH_RR_NUMBER_DEFAULT, FBENCH_STREAMS_MAX, FBENCH_RR_SIZE_DEFAULT);
+    exit(EXIT_FAILURE);
+}
+
+/************************************************************************
+* NAME: main
+*
+* DESCRIPTION: 
+************************************************************************/
+int main (int argc, char **argv)
+{
+    struct fbench_params    params;
+    struct fbench_results   results;
+    struct sigaction        sa;
+    long                    packet_size = 0;
+    long                    packet_number = 0;
+    int                     opt;
+    int                     i;
+    int                     result = -1;
+
+    memset(&params, 0, sizeof(params));
+    memset(&results, 0, sizeof(results));
+    params.port = FBENCH_PORT;
+    params.iteration_number = 1;
+    params.stream_number = 1;
+    params.response_size = FBENCH_RR_SIZE_DEFAULT;
+
+    while((opt = getopt(argc, argv, "p:s:n:i:t:r:S:R:g:j")) != -1)
+    {
+        switch(opt)
+        {
+            case 'p': params.port = (unsigned short)fbench_number(optarg, 1, 65535); break;
+            case 's': packet_size = fbench_number(optarg, 1, FBENCH_PACKET_SIZE_MAX); break;
+            case 'n': packet_number = fbench_number(optarg, 1, 0x7FFFFFFFL); break;
+            case 'i': params.iteration_number = fbench_number(optarg, 1, 10000); break;
+            case 't': params.stream_number = fbench_number(optarg, 1, FBENCH_STREAMS_MAX); break;
+            case 'r': params.response_size = fbench_number(optarg, 0, 0x7FFFFFFFL); break;
+            case 'S': params.sndbuf = fbench_number(optarg, 1, 0x7FFFFFFFL); break;
+            case 'R': params.rcvbuf = fbench_number(optarg, 1, 0x7FFFFFFFL); break;
+            case 'g': params.group = optarg; break;
+            case 'j': params.json = 1; break;
+            default: fbench_usage();
+        }
+    }
+
+    /* Direction.*/
+    if(optind >= argc)
+        fbench_usage();
+    else if(strcmp(argv[optind], "rx") == 0)
+        params.tx = 0;
+    else if((strcmp(argv[optind], "tx") == 0) && (optind + 1 < argc))
+        params.host = argv[++optind], params.tx = 1;
+    else
+        fbench_usage();
+    optind++;
+
+    /* Mode.*/
+    if(optind < argc)
+    {
+        for(i = 0; (i < (int)(sizeof(fbench_mode_str)/sizeof(fbench_mode_str[0]))) && strcmp(argv[optind], fbench_mode_str[i]); i++)
+        {}
+
+        if((i == (int)(sizeof(fbench_mode_str)/sizeof(fbench_mode_str[0]))) || (optind + 1 < argc) 
+            || ((params.tx == 0) && (i == FBENCH_MODE_CRR)))
+            fbench_usage();
+
+        params.mode = (fbench_mode_t)i;
+    }
+
+    if((params.mode == FBENCH_MODE_RR) || (params.mode == FBENCH_MODE_CRR))
+    {
+        params.packet_size = packet_size ? packet_size : FBENCH_RR_SIZE_DEFAULT;
+        params.packet_number = packet_number ? packet_number : FBENCH_RR_NUMBER_DEFAULT;
+
+        if(params.packet_size < FBENCH_RR_HEADER_SIZE)
+            params.packet_size = FBENCH_RR_HEADER_SIZE;
+
+        if(params.tx && ((results.latency = calloc((size_t)params.packet_number, sizeof(results.latency[0]))) == NULL))
+        {
+            fbench_error("calloc");
+            return EXIT_FAILURE;
+        }
+        results.latency_number = (unsigned long)params.packet_number;
+    }
+    else
+    {
+        params.packet_size = packet_size ? packet_size : FBENCH_TX_PACKET_SIZE_DEFAULT;
+        params.packet_number = packet_number ? packet_number : FBENCH_TX_PACKET_NUMBER_DEFAULT;
+        params.response_size = 0;
+    }
+
+    if(params.mode != FBENCH_MODE_TCP)
+        params.stream_number = 1;
+
+    /* [Ctrl+C] stops the test, without restart of the blocking calls.*/
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = fbench_sigint;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    switch(params.mode)
+    {
+        case FBENCH_MODE_UDP:
+            result = params.tx ? fbench_udp_tx(&params, &results) : fbench_udp_rx(&params, &results);
+            break;
+        case FBENCH_MODE_RR:
+        case FBENCH_MODE_CRR:
+            result = params.tx ? fbench_rr_tx(&params, &results) : fbench_rr_rx(&params, &results);
+            break;
+        default:
+            result = params.tx ? fbench_tcp_tx(&params, &results) : fbench_tcp_rx(&params, &results);
+            break;
+    }
+
+    free(results.latency);
+
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}